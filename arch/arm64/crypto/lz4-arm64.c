@@ -0,0 +1,248 @@
+/*
+ * lz4-arm64.c - LZ4 with a decompressor using 16 byte ldp/stp copies
+ *
+ * Module based on crypto/lz4.c
+ *
+ * The generic decoder moves literals and matches 8 bytes at a time. Here
+ * they are moved with pairs of 64-bit registers, 32 bytes per iteration
+ * for literal runs, which needs no FP/SIMD state to be saved: zram
+ * decompresses with preemption disabled, and for a 4KB page the
+ * kernel_neon_begin()/end() round trip would cost more than it saves.
+ *
+ * Compression is left to lib/lz4.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/unaligned/access_ok.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/string.h>
+#include <linux/crypto.h>
+#include <linux/vmalloc.h>
+#include <linux/lz4.h>
+
+MODULE_DESCRIPTION("LZ4 Compression Algorithm, arm64 decompressor");
+MODULE_LICENSE("GPL v2");
+MODULE_ALIAS_CRYPTO("lz4");
+
+#define ML_BITS		4
+#define ML_MASK		((1U << ML_BITS) - 1)
+#define RUN_MASK	((1U << (8 - ML_BITS)) - 1)
+#define MINMATCH	4
+
+/* how far a wild copy may read or write past the end of its run */
+#define WILDCOPY_SLACK	32
+
+static const u8 inc32table[8] = { 0, 1, 2, 1, 0, 4, 4, 4 };
+static const s8 dec64table[8] = { 0, 0, 0, -1, -4, 1, 2, 3 };
+
+static inline void lz4_copy16(u8 *d, const u8 *s)
+{
+	u64 a, b;
+
+	asm("ldp %0, %1, [%2]"
+	    : "=&r" (a), "=r" (b)
+	    : "r" (s), "m" (*(const u8 (*)[16])s));
+	asm("stp %1, %2, [%3]"
+	    : "=m" (*(u8 (*)[16])d)
+	    : "r" (a), "r" (b), "r" (d));
+}
+
+static inline int lz4_read_length(const u8 **ip, const u8 *iend, size_t *length)
+{
+	unsigned int s;
+
+	do {
+		if (unlikely(*ip >= iend))
+			return -1;
+		s = *(*ip)++;
+		*length += s;
+	} while (s == 255);
+
+	return 0;
+}
+
+static int lz4_arm64_decompress(const u8 *src, size_t slen, u8 *dst,
+				size_t *dlen)
+{
+	const u8 *ip = src;
+	const u8 *const iend = src + slen;
+	u8 *op = dst;
+	u8 *const oend = dst + *dlen;
+	const u8 *match;
+	size_t length, offset;
+	unsigned int token;
+	u8 *cpy;
+
+	while (ip < iend) {
+		token = *ip++;
+
+		/* literals */
+		length = token >> ML_BITS;
+		if (length == RUN_MASK && lz4_read_length(&ip, iend, &length))
+			return -1;
+		if (length > (size_t)(iend - ip) || length > (size_t)(oend - op))
+			return -1;
+
+		cpy = op + length;
+		if (likely((size_t)(iend - ip) >= length + WILDCOPY_SLACK &&
+			   (size_t)(oend - op) >= length + WILDCOPY_SLACK)) {
+			while (op < cpy) {
+				lz4_copy16(op, ip);
+				lz4_copy16(op + 16, ip + 16);
+				op += 32;
+				ip += 32;
+			}
+			ip -= op - cpy;
+			op = cpy;
+		} else {
+			memcpy(op, ip, length);
+			ip += length;
+			op = cpy;
+			/* the last sequence has literals only */
+			if (ip == iend)
+				break;
+		}
+
+		/* match */
+		if (unlikely(iend - ip < 2))
+			return -1;
+		offset = get_unaligned_le16(ip);
+		ip += 2;
+		if (unlikely(!offset || offset > (size_t)(op - dst)))
+			return -1;
+		match = op - offset;
+
+		length = token & ML_MASK;
+		if (length == ML_MASK && lz4_read_length(&ip, iend, &length))
+			return -1;
+		length += MINMATCH;
+		if (unlikely(length > (size_t)(oend - op)))
+			return -1;
+
+		cpy = op + length;
+		if (unlikely((size_t)(oend - op) < length + WILDCOPY_SLACK)) {
+			while (op < cpy)
+				*op++ = *match++;
+			continue;
+		}
+
+		if (likely(offset >= 16)) {
+			do {
+				lz4_copy16(op, match);
+				op += 16;
+				match += 16;
+			} while (op < cpy);
+		} else {
+			/* spread a short period until it is at least 8 apart */
+			if (offset < 8) {
+				op[0] = match[0];
+				op[1] = match[1];
+				op[2] = match[2];
+				op[3] = match[3];
+				match += inc32table[offset];
+				put_unaligned(get_unaligned((const u32 *)match),
+					      (u32 *)(op + 4));
+				match -= dec64table[offset];
+			} else {
+				put_unaligned(get_unaligned((const u64 *)match),
+					      (u64 *)op);
+				match += 8;
+			}
+			op += 8;
+			while (op < cpy) {
+				put_unaligned(get_unaligned((const u64 *)match),
+					      (u64 *)op);
+				op += 8;
+				match += 8;
+			}
+		}
+		op = cpy;
+	}
+
+	*dlen = op - dst;
+	return 0;
+}
+
+struct lz4_arm64_ctx {
+	void *lz4_comp_mem;
+};
+
+static int lz4_arm64_init(struct crypto_tfm *tfm)
+{
+	struct lz4_arm64_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	ctx->lz4_comp_mem = vmalloc(LZ4_MEM_COMPRESS);
+	if (!ctx->lz4_comp_mem)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void lz4_arm64_exit(struct crypto_tfm *tfm)
+{
+	struct lz4_arm64_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	vfree(ctx->lz4_comp_mem);
+}
+
+static int lz4_arm64_compress_crypto(struct crypto_tfm *tfm, const u8 *src,
+				     unsigned int slen, u8 *dst,
+				     unsigned int *dlen)
+{
+	struct lz4_arm64_ctx *ctx = crypto_tfm_ctx(tfm);
+	size_t tmp_len = *dlen;
+	int err;
+
+	err = lz4_compress(src, slen, dst, &tmp_len, ctx->lz4_comp_mem);
+	if (err < 0)
+		return -EINVAL;
+
+	*dlen = tmp_len;
+	return 0;
+}
+
+static int lz4_arm64_decompress_crypto(struct crypto_tfm *tfm, const u8 *src,
+				       unsigned int slen, u8 *dst,
+				       unsigned int *dlen)
+{
+	size_t tmp_len = *dlen;
+
+	if (lz4_arm64_decompress(src, slen, dst, &tmp_len))
+		return -EINVAL;
+
+	*dlen = tmp_len;
+	return 0;
+}
+
+static struct crypto_alg alg_lz4_arm64 = {
+	.cra_name		= "lz4",
+	.cra_driver_name	= "lz4-arm64",
+	.cra_priority		= 200,
+	.cra_flags		= CRYPTO_ALG_TYPE_COMPRESS,
+	.cra_ctxsize		= sizeof(struct lz4_arm64_ctx),
+	.cra_module		= THIS_MODULE,
+	.cra_list		= LIST_HEAD_INIT(alg_lz4_arm64.cra_list),
+	.cra_init		= lz4_arm64_init,
+	.cra_exit		= lz4_arm64_exit,
+	.cra_u			= { .compress = {
+	.coa_compress		= lz4_arm64_compress_crypto,
+	.coa_decompress		= lz4_arm64_decompress_crypto } }
+};
+
+static int __init lz4_arm64_mod_init(void)
+{
+	return crypto_register_alg(&alg_lz4_arm64);
+}
+
+static void __exit lz4_arm64_mod_fini(void)
+{
+	crypto_unregister_alg(&alg_lz4_arm64);
+}
+
+module_init(lz4_arm64_mod_init);
+module_exit(lz4_arm64_mod_fini);
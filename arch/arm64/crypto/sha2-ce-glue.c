@@ -37,6 +37,10 @@ static inline void __cfi_sha2_ce_transform(struct sha256_state *sst,
 #define sha2_ce_transform __cfi_sha2_ce_transform
 #endif
 
+asmlinkage void sha2_ce_transform2(u32 *state_a, u32 *state_b,
+				   u8 const *src_a, u8 const *src_b,
+				   int blocks);
+
 const u32 sha256_ce_offsetof_count = offsetof(struct sha256_ce_state,
 					      sst.count);
 const u32 sha256_ce_offsetof_finalize = offsetof(struct sha256_ce_state,
@@ -89,11 +93,98 @@ static int sha256_ce_final(struct shash_desc *desc, u8 *out)
 	return sha256_base_finish(desc, out);
 }
 
+/*
+ * Finish two messages of the same length from the common state in sst,
+ * interleaving their blocks through sha2_ce_transform2().
+ */
+static void sha256_ce_finup2x(const struct sha256_state *sst,
+			      const u8 *data_a, const u8 *data_b,
+			      unsigned int len, u8 *out_a, u8 *out_b,
+			      unsigned int digestsize)
+{
+	u32 state_a[SHA256_DIGEST_SIZE / 4], state_b[SHA256_DIGEST_SIZE / 4];
+	u8 buf_a[2 * SHA256_BLOCK_SIZE], buf_b[2 * SHA256_BLOCK_SIZE];
+	unsigned int partial = sst->count % SHA256_BLOCK_SIZE;
+	u64 bits = (sst->count + len) << 3;
+	unsigned int n, i;
+
+	memcpy(state_a, sst->state, sizeof(state_a));
+	memcpy(state_b, sst->state, sizeof(state_b));
+
+	if (partial) {
+		n = min(len, SHA256_BLOCK_SIZE - partial);
+		memcpy(buf_a, sst->buf, partial);
+		memcpy(buf_b, sst->buf, partial);
+		memcpy(buf_a + partial, data_a, n);
+		memcpy(buf_b + partial, data_b, n);
+		partial += n;
+		data_a += n;
+		data_b += n;
+		len -= n;
+
+		if (partial == SHA256_BLOCK_SIZE) {
+			sha2_ce_transform2(state_a, state_b, buf_a, buf_b, 1);
+			partial = 0;
+		}
+	}
+
+	n = len / SHA256_BLOCK_SIZE;
+	if (n) {
+		sha2_ce_transform2(state_a, state_b, data_a, data_b, n);
+		data_a += n * SHA256_BLOCK_SIZE;
+		data_b += n * SHA256_BLOCK_SIZE;
+		len -= n * SHA256_BLOCK_SIZE;
+	}
+
+	/* either the buffer or the tail of the data is left, not both */
+	if (len) {
+		memcpy(buf_a, data_a, len);
+		memcpy(buf_b, data_b, len);
+		partial = len;
+	}
+
+	buf_a[partial] = buf_b[partial] = 0x80;
+	partial++;
+	n = partial > SHA256_BLOCK_SIZE - sizeof(__be64) ?
+		2 * SHA256_BLOCK_SIZE : SHA256_BLOCK_SIZE;
+	memset(buf_a + partial, 0, n - sizeof(__be64) - partial);
+	memset(buf_b + partial, 0, n - sizeof(__be64) - partial);
+	put_unaligned_be64(bits, buf_a + n - sizeof(__be64));
+	put_unaligned_be64(bits, buf_b + n - sizeof(__be64));
+	sha2_ce_transform2(state_a, state_b, buf_a, buf_b,
+			   n / SHA256_BLOCK_SIZE);
+
+	for (i = 0; i < digestsize / sizeof(__be32); i++) {
+		put_unaligned_be32(state_a[i], out_a + i * sizeof(__be32));
+		put_unaligned_be32(state_b[i], out_b + i * sizeof(__be32));
+	}
+}
+
+static int sha256_ce_finup_mb(struct shash_desc *desc,
+			      const u8 * const data[], unsigned int len,
+			      u8 * const outs[], unsigned int num_msgs)
+{
+	struct sha256_ce_state *sctx = shash_desc_ctx(desc);
+
+	if (num_msgs != 2)
+		return -EINVAL;
+
+	/* the second lane uses the whole register file */
+	kernel_neon_begin();
+	sha256_ce_finup2x(&sctx->sst, data[0], data[1], len, outs[0], outs[1],
+			  crypto_shash_digestsize(desc->tfm));
+	kernel_neon_end();
+
+	return 0;
+}
+
 static struct shash_alg algs[] = { {
 	.init			= sha224_base_init,
 	.update			= sha256_ce_update,
 	.final			= sha256_ce_final,
 	.finup			= sha256_ce_finup,
+	.finup_mb		= sha256_ce_finup_mb,
+	.mb_max_msgs		= 2,
 	.descsize		= sizeof(struct sha256_ce_state),
 	.digestsize		= SHA224_DIGEST_SIZE,
 	.base			= {
@@ -109,6 +200,8 @@ static struct shash_alg algs[] = { {
 	.update			= sha256_ce_update,
 	.final			= sha256_ce_final,
 	.finup			= sha256_ce_finup,
+	.finup_mb		= sha256_ce_finup_mb,
+	.mb_max_msgs		= 2,
 	.descsize		= sizeof(struct sha256_ce_state),
 	.digestsize		= SHA256_DIGEST_SIZE,
 	.base			= {
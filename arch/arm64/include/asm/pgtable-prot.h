@@ -29,6 +29,7 @@
 #define PTE_DIRTY		(_AT(pteval_t, 1) << 55)
 #define PTE_SPECIAL		(_AT(pteval_t, 1) << 56)
 #define PTE_PROT_NONE		(_AT(pteval_t, 1) << 58) /* only when !PTE_VALID */
+#define PTE_CONT_FOLD		(_AT(pteval_t, 1) << 57) /* user PTE_CONT set by contpte_fold() */
 
 #ifndef __ASSEMBLY__
 
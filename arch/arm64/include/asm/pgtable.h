@@ -72,7 +72,11 @@ extern unsigned long empty_zero_page[PAGE_SIZE / sizeof(unsigned long)];
 #define pfn_pte(pfn,prot)	(__pte(((phys_addr_t)(pfn) << PAGE_SHIFT) | pgprot_val(prot)))
 
 #define pte_none(pte)		(!pte_val(pte))
-#define pte_clear(mm,addr,ptep)	set_pte(ptep, __pte(0))
+#define pte_clear(mm,addr,ptep)					\
+	do {							\
+		contpte_try_unfold(mm, addr, ptep);		\
+		set_pte(ptep, __pte(0));			\
+	} while (0)
 #define pte_page(pte)		(pfn_to_page(pte_pfn(pte)))
 
 /*
@@ -239,6 +243,51 @@ struct vm_area_struct;
 
 extern void __sync_icache_dcache(pte_t pteval, unsigned long addr);
 
+#ifdef CONFIG_ANON_CONTPTE
+/*
+ * Anonymous user memory may be mapped with PTE_CONT by contpte_fold(). Such
+ * entries also carry PTE_CONT_FOLD, and the whole CONT_PTES block has to be
+ * split back into plain entries before any one of them changes, otherwise
+ * the TLB could use a stale translation for the rest of the block.
+ */
+#define pte_cont_folded(pte)	\
+	((pte_val(pte) & (PTE_VALID | PTE_CONT_FOLD)) == (PTE_VALID | PTE_CONT_FOLD))
+
+extern bool contpte_fold(struct mm_struct *mm, unsigned long addr,
+			 pte_t *ptep);
+extern void contpte_unfold(struct mm_struct *mm, unsigned long addr,
+			   pte_t *ptep);
+extern int contpte_test_and_clear_young(struct vm_area_struct *vma,
+					unsigned long addr, pte_t *ptep);
+
+static inline void contpte_try_unfold(struct mm_struct *mm,
+				      unsigned long addr, pte_t *ptep)
+{
+	if (unlikely(pte_cont_folded(READ_ONCE(*ptep))))
+		contpte_unfold(mm, addr, ptep);
+}
+
+/* only contpte_fold() creates folded entries, never copy them around */
+static inline pte_t contpte_strip(pte_t pte)
+{
+	if (unlikely(pte_val(pte) & PTE_CONT_FOLD))
+		pte_val(pte) &= ~(PTE_CONT | PTE_CONT_FOLD);
+	return pte;
+}
+#else
+#define pte_cont_folded(pte)	false
+
+static inline void contpte_try_unfold(struct mm_struct *mm,
+				      unsigned long addr, pte_t *ptep)
+{
+}
+
+static inline pte_t contpte_strip(pte_t pte)
+{
+	return pte;
+}
+#endif
+
 /*
  * PTE bits configuration in the presence of hardware Dirty Bit Management
  * (PTE_WRITE == PTE_DBM):
@@ -257,6 +306,9 @@ extern void __sync_icache_dcache(pte_t pteval, unsigned long addr);
 static inline void set_pte_at(struct mm_struct *mm, unsigned long addr,
 			      pte_t *ptep, pte_t pte)
 {
+	contpte_try_unfold(mm, addr, ptep);
+	pte = contpte_strip(pte);
+
 	if (pte_present(pte)) {
 		if (pte_sw_dirty(pte) && pte_write(pte))
 			pte_val(pte) &= ~PTE_RDONLY;
@@ -682,6 +734,10 @@ static inline int ptep_test_and_clear_young(struct vm_area_struct *vma,
 					    unsigned long address,
 					    pte_t *ptep)
 {
+#ifdef CONFIG_ANON_CONTPTE
+	if (unlikely(pte_cont_folded(READ_ONCE(*ptep))))
+		return contpte_test_and_clear_young(vma, address, ptep);
+#endif
 	return __ptep_test_and_clear_young(ptep);
 }
 
@@ -702,6 +758,8 @@ static inline pte_t ptep_get_and_clear(struct mm_struct *mm,
 	pteval_t old_pteval;
 	unsigned int tmp;
 
+	contpte_try_unfold(mm, address, ptep);
+
 	asm volatile("//	ptep_get_and_clear\n"
 	"	prfm	pstl1strm, %2\n"
 	"1:	ldxr	%0, %2\n"
@@ -731,6 +789,8 @@ static inline void ptep_set_wrprotect(struct mm_struct *mm, unsigned long addres
 	pteval_t pteval;
 	unsigned long tmp;
 
+	contpte_try_unfold(mm, address, ptep);
+
 	asm volatile("//	ptep_set_wrprotect\n"
 	"	prfm	pstl1strm, %2\n"
 	"1:	ldxr	%0, %2\n"
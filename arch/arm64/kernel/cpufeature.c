@@ -792,6 +792,26 @@ static bool has_no_hw_prefetch(const struct arm64_cpu_capabilities *entry, int _
 	return MIDR_IS_CPU_MODEL_RANGE(midr, MIDR_THUNDERX, rv_min, rv_max);
 }
 
+/*
+ * The Samsung cores keep streaming stores of large copies out of their
+ * caches only when told to with stnp. The text is shared by all cpus, so
+ * the variant is chosen when any cpu seen so far is one of them.
+ */
+static bool has_nt_copy(const struct arm64_cpu_capabilities *entry, int __unused)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		u32 midr = per_cpu(cpu_data, cpu).reg_midr;
+
+		if (MIDR_IS_CPU_MODEL_RANGE(midr, MIDR_MONGOOSE, 0, ~0U) ||
+		    MIDR_IS_CPU_MODEL_RANGE(midr, MIDR_MEERKAT, 0, ~0U))
+			return true;
+	}
+
+	return false;
+}
+
 static bool runs_at_el2(const struct arm64_cpu_capabilities *entry, int __unused)
 {
 	return is_kernel_in_hyp_mode();
@@ -953,6 +973,12 @@ static const struct arm64_cpu_capabilities arm64_features[] = {
 		.def_scope = SCOPE_SYSTEM,
 		.matches = has_no_hw_prefetch,
 	},
+	{
+		.desc = "Non-temporal stores for large copies",
+		.capability = ARM64_HAS_NT_COPY,
+		.def_scope = SCOPE_SYSTEM,
+		.matches = has_nt_copy,
+	},
 #ifdef CONFIG_ARM64_UAO
 	{
 		.desc = "User Access Override",
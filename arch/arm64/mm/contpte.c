@@ -0,0 +1,138 @@
+/*
+ * arch/arm64/mm/contpte.c
+ *
+ * Contiguous hint for anonymous user mappings.
+ *
+ * mm/contpte.c moves the pages of an aligned CONT_PTES block of an
+ * MADV_CONTPTE vma into one physically contiguous chunk and then asks us to
+ * set PTE_CONT on the block, so that it takes a single TLB entry. The
+ * architecture requires all entries of such a block to be valid, to map
+ * consecutive pages and to carry the same attributes, and any change to one
+ * of them has to go through break-before-make of the whole block. The core
+ * mm knows nothing about this, so every pte accessor that changes a folded
+ * entry unfolds the block first, see contpte_try_unfold().
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/mm.h>
+#include <asm/pgtable.h>
+#include <asm/tlbflush.h>
+
+/* bits that may differ between the entries of a block before folding */
+#define CONTPTE_FOLD_IGNORE	(PTE_AF | PTE_RDONLY | PTE_DIRTY)
+
+static void contpte_flush(struct mm_struct *mm, unsigned long start)
+{
+	struct vm_area_struct vma = { .vm_mm = mm };
+
+	flush_tlb_range(&vma, start, start + CONT_PTE_SIZE);
+}
+
+/* clear all entries of the block at @ptep, returning the old values */
+static void contpte_clear_block(struct mm_struct *mm, unsigned long start,
+				pte_t *ptep, pte_t *orig)
+{
+	int i;
+
+	for (i = 0; i < CONT_PTES; i++)
+		orig[i] = __pte(xchg_relaxed(&pte_val(ptep[i]), 0));
+	contpte_flush(mm, start);
+}
+
+/*
+ * Set PTE_CONT on the CONT_PTES entries starting at @ptep, which maps the
+ * CONT_PTE_SIZE aligned @addr. Returns false, leaving the entries alone,
+ * unless they are all valid user entries with identical attributes mapping
+ * one naturally aligned physical chunk. Called with the pte lock held.
+ */
+bool contpte_fold(struct mm_struct *mm, unsigned long addr, pte_t *ptep)
+{
+	pte_t orig[CONT_PTES];
+	pteval_t attrs, extra = PTE_AF | PTE_CONT | PTE_CONT_FOLD;
+	unsigned long pfn;
+	bool dirty;
+	int i;
+
+	if (WARN_ON_ONCE(addr & ~CONT_PTE_MASK))
+		return false;
+
+	for (i = 0; i < CONT_PTES; i++)
+		orig[i] = READ_ONCE(ptep[i]);
+
+	pfn = pte_pfn(orig[0]);
+	attrs = pte_val(orig[0]) & ~PHYS_MASK & ~CONTPTE_FOLD_IGNORE;
+	if (!pte_valid_user(orig[0]) || pte_special(orig[0]) ||
+	    pte_cont(orig[0]) || (pfn & (CONT_PTES - 1)))
+		return false;
+
+	for (i = 1; i < CONT_PTES; i++) {
+		if (pte_pfn(orig[i]) != pfn + i)
+			return false;
+		if ((pte_val(orig[i]) & ~PHYS_MASK & ~CONTPTE_FOLD_IGNORE) !=
+		    attrs)
+			return false;
+	}
+
+	contpte_clear_block(mm, addr, ptep, orig);
+
+	/*
+	 * Hardware may have updated the access and dirty state until the
+	 * entries were cleared. Make them all young, and all dirty if any is
+	 * or if the block is writable anyway, so that hardware never has a
+	 * reason to update the permissions of a single entry.
+	 */
+	dirty = pte_write(orig[0]);
+	for (i = 0; i < CONT_PTES; i++)
+		dirty |= pte_dirty(orig[i]);
+	if (dirty)
+		extra |= PTE_DIRTY;
+
+	for (i = 0; i < CONT_PTES; i++) {
+		pteval_t val = pte_val(orig[i]) | extra;
+
+		if (dirty && pte_write(orig[i]))
+			val &= ~PTE_RDONLY;
+		set_pte(ptep + i, __pte(val));
+	}
+
+	return true;
+}
+
+/*
+ * Turn the folded block containing @addr back into plain entries, keeping
+ * the access and dirty state of each. Called with the pte lock held.
+ */
+void contpte_unfold(struct mm_struct *mm, unsigned long addr, pte_t *ptep)
+{
+	unsigned long start = addr & CONT_PTE_MASK;
+	pte_t orig[CONT_PTES];
+	int i;
+
+	ptep -= CONT_RANGE_OFFSET(addr);
+	contpte_clear_block(mm, start, ptep, orig);
+
+	for (i = 0; i < CONT_PTES; i++)
+		set_pte(ptep + i, __pte(pte_val(orig[i]) &
+					~(PTE_CONT | PTE_CONT_FOLD)));
+}
+
+#ifdef CONFIG_ARM64_HW_AFDBM
+/*
+ * The access flag of a folded block is aged as a whole: the TLB entry covers
+ * all of it, so clear every entry and report whether any was young.
+ */
+int contpte_test_and_clear_young(struct vm_area_struct *vma,
+				 unsigned long addr, pte_t *ptep)
+{
+	int i, young = 0;
+
+	ptep -= CONT_RANGE_OFFSET(addr);
+	for (i = 0; i < CONT_PTES; i++)
+		young |= __ptep_test_and_clear_young(ptep + i);
+
+	return young;
+}
+#endif
@@ -164,6 +164,8 @@ int ptep_set_access_flags(struct vm_area_struct *vma,
 	if (pte_same(*ptep, entry))
 		return 0;
 
+	contpte_try_unfold(vma->vm_mm, address, ptep);
+
 	/* only preserve the access flags and write permission */
 	pte_val(entry) &= PTE_AF | PTE_WRITE | PTE_DIRTY;
 
@@ -1665,6 +1665,7 @@ void init_request_from_bio(struct request *req, struct bio *bio)
 	req->__sector = bio->bi_iter.bi_sector;
 	req->ioprio = bio_prio(bio);
 	blk_rq_bio_prep(req->q, req, bio);
+	blk_rq_io_stamp(req, BLK_IO_SUBMIT);
 }
 
 static blk_qc_t blk_queue_bio(struct request_queue *q, struct bio *bio)
@@ -2546,6 +2547,7 @@ void blk_start_request(struct request *req)
 
 	BUG_ON(test_bit(REQ_ATOM_COMPLETE, &req->atomic_flags));
 	blk_add_timer(req);
+	blk_rq_io_stamp(req, BLK_IO_DISPATCH);
 }
 EXPORT_SYMBOL(blk_start_request);
 
@@ -2769,6 +2771,7 @@ void blk_finish_request(struct request *req, int error)
 		blk_unprep_request(req);
 
 	blk_account_io_done(req);
+	blk_rq_io_timeline_done(req);
 
 	if (req->end_io)
 		req->end_io(req, error);
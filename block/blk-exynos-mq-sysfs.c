@@ -241,6 +241,34 @@ static ssize_t blk_mq_hw_sysfs_active_show(struct blk_mq_hw_ctx *hctx, char *pag
 	return sprintf(page, "%u\n", atomic_read(&hctx->nr_active));
 }
 
+#ifdef CONFIG_BLK_MQ_FG_LANE
+static ssize_t blk_mq_hw_sysfs_bg_depth_show(struct blk_mq_hw_ctx *hctx,
+					     char *page)
+{
+	return sprintf(page, "%u\n", hctx->bg_depth);
+}
+
+static ssize_t blk_mq_hw_sysfs_bg_depth_store(struct blk_mq_hw_ctx *hctx,
+					      const char *page, size_t size)
+{
+	unsigned int depth;
+
+	if (kstrtouint(page, 10, &depth) || !depth)
+		return -EINVAL;
+
+	WRITE_ONCE(hctx->bg_depth, depth);
+	blk_mq_run_hw_queue(hctx, true);
+
+	return size;
+}
+
+static ssize_t blk_mq_hw_sysfs_bg_active_show(struct blk_mq_hw_ctx *hctx,
+					      char *page)
+{
+	return sprintf(page, "%u\n", atomic_read(&hctx->nr_bg_active));
+}
+#endif
+
 static ssize_t blk_mq_hw_sysfs_cpus_show(struct blk_mq_hw_ctx *hctx, char *page)
 {
 	unsigned int i, first = 1;
@@ -317,6 +345,17 @@ static struct blk_mq_hw_ctx_sysfs_entry blk_mq_hw_sysfs_poll = {
 	.show = blk_mq_hw_sysfs_poll_show,
 	.store = blk_mq_hw_sysfs_poll_store,
 };
+#ifdef CONFIG_BLK_MQ_FG_LANE
+static struct blk_mq_hw_ctx_sysfs_entry blk_mq_hw_sysfs_bg_depth = {
+	.attr = {.name = "bg_depth", .mode = S_IWUSR | S_IRUGO },
+	.show = blk_mq_hw_sysfs_bg_depth_show,
+	.store = blk_mq_hw_sysfs_bg_depth_store,
+};
+static struct blk_mq_hw_ctx_sysfs_entry blk_mq_hw_sysfs_bg_active = {
+	.attr = {.name = "bg_active", .mode = S_IRUGO },
+	.show = blk_mq_hw_sysfs_bg_active_show,
+};
+#endif
 
 static struct attribute *default_hw_ctx_attrs[] = {
 	&blk_mq_hw_sysfs_queued.attr,
@@ -327,6 +366,10 @@ static struct attribute *default_hw_ctx_attrs[] = {
 	&blk_mq_hw_sysfs_cpus.attr,
 	&blk_mq_hw_sysfs_active.attr,
 	&blk_mq_hw_sysfs_poll.attr,
+#ifdef CONFIG_BLK_MQ_FG_LANE
+	&blk_mq_hw_sysfs_bg_depth.attr,
+	&blk_mq_hw_sysfs_bg_active.attr,
+#endif
 	NULL,
 };
 
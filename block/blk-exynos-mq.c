@@ -23,6 +23,8 @@
 #include <linux/delay.h>
 #include <linux/crash_dump.h>
 #include <linux/prefetch.h>
+#include <linux/ioprio.h>
+#include <linux/iocontext.h>
 
 #include <trace/events/block.h>
 
@@ -154,6 +156,7 @@ static void blk_mq_rq_ctx_init(struct request_queue *q, struct blk_mq_ctx *ctx,
 	rq->rq_disk = NULL;
 	rq->part = NULL;
 	rq->start_time = jiffies;
+	blk_rq_io_timeline_init(rq);
 #ifdef CONFIG_BLK_CGROUP
 	rq->rl = NULL;
 	set_start_time_ns(rq);
@@ -289,6 +292,124 @@ struct request *blk_mq_alloc_request_hctx(struct request_queue *q, int rw,
 }
 EXPORT_SYMBOL_GPL(blk_mq_alloc_request_hctx);
 
+#ifdef CONFIG_BLK_MQ_FG_LANE
+/* best-effort levels from this one on, nice 5 and above, are background */
+#define BLK_MQ_BG_PRIO_LEVEL	5
+
+/* Requests without a priority of their own get the submitter's */
+static void blk_mq_rq_set_ioprio(struct request *rq)
+{
+	struct io_context *ioc = current->io_context;
+
+	if (ioprio_valid(rq->ioprio))
+		return;
+
+	if (ioc && ioprio_valid(ioc->ioprio))
+		rq->ioprio = ioc->ioprio;
+	else
+		rq->ioprio = IOPRIO_PRIO_VALUE(task_nice_ioclass(current),
+					       task_nice_ioprio(current));
+}
+
+static bool blk_mq_rq_is_background(struct request *rq)
+{
+	if (rq_data_dir(rq) == WRITE && !rq_is_sync(rq))
+		return true;
+
+	switch (IOPRIO_PRIO_CLASS(rq->ioprio)) {
+	case IOPRIO_CLASS_RT:
+		return false;
+	case IOPRIO_CLASS_IDLE:
+		return true;
+	default:
+		return IOPRIO_PRIO_DATA(rq->ioprio) >= BLK_MQ_BG_PRIO_LEVEL;
+	}
+}
+
+/*
+ * Put the foreground requests of a queue run ahead of the background ones
+ * and park the background requests beyond the hctx budget on
+ * hctx->dispatch, where the next run picks them up again.
+ */
+static void blk_mq_fg_lane_sort(struct blk_mq_hw_ctx *hctx,
+				struct list_head *list)
+{
+	struct request *rq, *next;
+	LIST_HEAD(bg_list);
+	int budget;
+
+	list_for_each_entry_safe(rq, next, list, queuelist) {
+		if (blk_mq_rq_is_background(rq))
+			list_move_tail(&rq->queuelist, &bg_list);
+	}
+
+	budget = READ_ONCE(hctx->bg_depth) - atomic_read(&hctx->nr_bg_active);
+	list_for_each_entry_safe(rq, next, &bg_list, queuelist) {
+		if (budget-- <= 0)
+			break;
+		list_move_tail(&rq->queuelist, list);
+	}
+
+	if (!list_empty(&bg_list)) {
+		spin_lock(&hctx->lock);
+		list_splice_tail_init(&bg_list, &hctx->dispatch);
+		spin_unlock(&hctx->lock);
+	}
+}
+
+/*
+ * Count a background request against the budget before it is issued, as
+ * it may complete before queue_rq returns. Returns true if it was counted
+ * by this call.
+ */
+static bool blk_mq_fg_lane_issue(struct blk_mq_hw_ctx *hctx,
+				 struct request *rq)
+{
+	if ((rq->cmd_flags & REQ_MQ_BG) || !blk_mq_rq_is_background(rq))
+		return false;
+
+	rq->cmd_flags |= REQ_MQ_BG;
+	atomic_inc(&hctx->nr_bg_active);
+	return true;
+}
+
+static void blk_mq_fg_lane_unissue(struct blk_mq_hw_ctx *hctx,
+				   struct request *rq)
+{
+	rq->cmd_flags &= ~REQ_MQ_BG;
+	atomic_dec(&hctx->nr_bg_active);
+}
+
+static void blk_mq_fg_lane_done(struct blk_mq_hw_ctx *hctx)
+{
+	if (atomic_dec_return(&hctx->nr_bg_active) <
+			READ_ONCE(hctx->bg_depth) &&
+	    !list_empty_careful(&hctx->dispatch))
+		blk_mq_run_hw_queue(hctx, true);
+}
+
+static void blk_mq_fg_lane_init(struct blk_mq_hw_ctx *hctx,
+				struct blk_mq_tag_set *set)
+{
+	atomic_set(&hctx->nr_bg_active, 0);
+	hctx->bg_depth = max(1U, set->queue_depth / 4);
+}
+#else
+static inline void blk_mq_rq_set_ioprio(struct request *rq) {}
+static inline void blk_mq_fg_lane_sort(struct blk_mq_hw_ctx *hctx,
+				       struct list_head *list) {}
+static inline bool blk_mq_fg_lane_issue(struct blk_mq_hw_ctx *hctx,
+					struct request *rq)
+{
+	return false;
+}
+static inline void blk_mq_fg_lane_unissue(struct blk_mq_hw_ctx *hctx,
+					  struct request *rq) {}
+static inline void blk_mq_fg_lane_done(struct blk_mq_hw_ctx *hctx) {}
+static inline void blk_mq_fg_lane_init(struct blk_mq_hw_ctx *hctx,
+				       struct blk_mq_tag_set *set) {}
+#endif
+
 static void __blk_mq_free_request(struct blk_mq_hw_ctx *hctx,
 				  struct blk_mq_ctx *ctx, struct request *rq)
 {
@@ -297,6 +418,8 @@ static void __blk_mq_free_request(struct blk_mq_hw_ctx *hctx,
 
 	if (rq->cmd_flags & REQ_MQ_INFLIGHT)
 		atomic_dec(&hctx->nr_active);
+	if (rq->cmd_flags & REQ_MQ_BG)
+		blk_mq_fg_lane_done(hctx);
 	rq->cmd_flags = 0;
 
 	clear_bit(REQ_ATOM_STARTED, &rq->atomic_flags);
@@ -323,6 +446,7 @@ EXPORT_SYMBOL_GPL(blk_mq_free_request);
 inline void __blk_mq_end_request(struct request *rq, int error)
 {
 	blk_account_io_done(rq);
+	blk_rq_io_timeline_done(rq);
 
 	if (rq->end_io) {
 		rq->end_io(rq, error);
@@ -417,6 +541,7 @@ void blk_mq_start_request(struct request *rq)
 	struct request_queue *q = rq->q;
 
 	trace_block_rq_issue(q, rq);
+	blk_rq_io_stamp(rq, BLK_IO_DISPATCH);
 
 	rq->resid_len = blk_rq_bytes(rq);
 	if (unlikely(blk_bidi_rq(rq)))
@@ -799,6 +924,8 @@ static void __blk_mq_run_hw_queue(struct blk_mq_hw_ctx *hctx)
 		spin_unlock(&hctx->lock);
 	}
 
+	blk_mq_fg_lane_sort(hctx, &rq_list);
+
 	/*
 	 * Start off with dptr being NULL, so we start the first request
 	 * immediately, even if we have more pending.
@@ -811,6 +938,7 @@ static void __blk_mq_run_hw_queue(struct blk_mq_hw_ctx *hctx)
 	queued = 0;
 	while (!list_empty(&rq_list)) {
 		struct blk_mq_queue_data bd;
+		bool bg;
 		int ret;
 
 		rq = list_first_entry(&rq_list, struct request, queuelist);
@@ -820,12 +948,15 @@ static void __blk_mq_run_hw_queue(struct blk_mq_hw_ctx *hctx)
 		bd.list = dptr;
 		bd.last = list_empty(&rq_list);
 
+		bg = blk_mq_fg_lane_issue(hctx, rq);
 		ret = q->mq_ops->queue_rq(hctx, &bd);
 		switch (ret) {
 		case BLK_MQ_RQ_QUEUE_OK:
 			queued++;
 			break;
 		case BLK_MQ_RQ_QUEUE_BUSY:
+			if (bg)
+				blk_mq_fg_lane_unissue(hctx, rq);
 			list_add(&rq->queuelist, &rq_list);
 			__blk_mq_requeue_request(rq);
 			break;
@@ -1140,6 +1271,7 @@ void blk_mq_flush_plug_list(struct blk_plug *plug, bool from_schedule)
 static void blk_mq_bio_to_request(struct request *rq, struct bio *bio)
 {
 	init_request_from_bio(rq, bio);
+	blk_mq_rq_set_ioprio(rq);
 
 	blk_account_io_start(rq, 1);
 }
@@ -1644,6 +1776,7 @@ static int blk_mq_init_hctx(struct request_queue *q,
 	INIT_LIST_HEAD(&hctx->dispatch);
 	hctx->queue = q;
 	hctx->queue_num = hctx_idx;
+	blk_mq_fg_lane_init(hctx, set);
 	hctx->flags = set->flags & ~BLK_MQ_F_TAG_SHARED;
 
 	cpuhp_state_add_instance_nocalls(CPUHP_BLK_MQ_DEAD, &hctx->cpuhp_dead);
@@ -0,0 +1,129 @@
+/*
+ * Per stage latency of block requests, from bio submission down to the
+ * host controller and back to bio completion.
+ *
+ * Requests carry a timestamp for each stage they pass, see enum
+ * blk_io_stage. On completion the time between consecutive stamps is
+ * added to a histogram per stage and data direction, shown in
+ * <debugfs>/blk_io_timeline, and reported through the block_rq_timeline
+ * tracepoint so that single slow requests can be followed as well.
+ *
+ * Like the IO svc time latency histograms, updates are lockless and may
+ * lose a count now and then.
+ */
+#include <linux/kernel.h>
+#include <linux/blkdev.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/init.h>
+
+#include <trace/events/block.h>
+
+static const char *blk_io_stage_name[BLK_IO_NR_STAGES] = {
+	[BLK_IO_SUBMIT]		= "total",
+	[BLK_IO_INSERT]		= "submit->insert",
+	[BLK_IO_DISPATCH]	= "insert->dispatch",
+	[BLK_IO_QUEUECMD]	= "dispatch->queuecmd",
+	[BLK_IO_CRYPT]		= "queuecmd->crypt",
+	[BLK_IO_DOORBELL]	= "crypt->doorbell",
+	[BLK_IO_IRQ]		= "doorbell->irq",
+	[BLK_IO_DONE]		= "irq->done",
+};
+
+/* BLK_IO_SUBMIT slot holds the submit to done total */
+static struct io_latency_state blk_io_timeline_lat[2][BLK_IO_NR_STAGES];
+
+void blk_rq_io_timeline_done(struct request *rq)
+{
+	struct io_latency_state *lat;
+	u64 prev;
+	int i;
+
+	if (rq->cmd_type != REQ_TYPE_FS || !rq->io_stamp[BLK_IO_SUBMIT])
+		return;
+
+	blk_rq_io_stamp(rq, BLK_IO_DONE);
+	trace_block_rq_timeline(rq);
+
+	lat = blk_io_timeline_lat[rq_data_dir(rq)];
+	prev = rq->io_stamp[BLK_IO_SUBMIT];
+	for (i = BLK_IO_SUBMIT + 1; i < BLK_IO_NR_STAGES; i++) {
+		if (!rq->io_stamp[i])
+			continue;
+
+		blk_update_latency_hist(&lat[i],
+				div_u64(rq->io_stamp[i] - prev, NSEC_PER_USEC));
+		prev = rq->io_stamp[i];
+	}
+	blk_update_latency_hist(&lat[BLK_IO_SUBMIT],
+			div_u64(prev - rq->io_stamp[BLK_IO_SUBMIT],
+				NSEC_PER_USEC));
+}
+
+static int blk_io_timeline_show(struct seq_file *s, void *unused)
+{
+	char name[32];
+	char *buf;
+	int dir, i;
+
+	buf = (char *)__get_free_page(GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	for (dir = READ; dir <= WRITE; dir++) {
+		for (i = 0; i < BLK_IO_NR_STAGES; i++) {
+			snprintf(name, sizeof(name), "%s %s",
+				 dir == READ ? "read" : "write",
+				 blk_io_stage_name[i]);
+			if (blk_latency_hist_show(name,
+					&blk_io_timeline_lat[dir][i],
+					buf, PAGE_SIZE))
+				seq_puts(s, buf);
+		}
+	}
+
+	free_page((unsigned long)buf);
+
+	return 0;
+}
+
+static int blk_io_timeline_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, blk_io_timeline_show, NULL);
+}
+
+/* writing BLK_IO_LAT_HIST_ZERO clears the histograms */
+static ssize_t blk_io_timeline_write(struct file *file,
+		const char __user *ubuf, size_t count, loff_t *ppos)
+{
+	int val, ret;
+
+	ret = kstrtoint_from_user(ubuf, count, 0, &val);
+	if (ret)
+		return ret;
+
+	if (val != BLK_IO_LAT_HIST_ZERO)
+		return -EINVAL;
+
+	memset(blk_io_timeline_lat, 0, sizeof(blk_io_timeline_lat));
+
+	return count;
+}
+
+static const struct file_operations blk_io_timeline_fops = {
+	.open		= blk_io_timeline_open,
+	.read		= seq_read,
+	.write		= blk_io_timeline_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init blk_io_timeline_init(void)
+{
+	debugfs_create_file("blk_io_timeline", 0644, NULL, NULL,
+			    &blk_io_timeline_fops);
+
+	return 0;
+}
+late_initcall(blk_io_timeline_init);
@@ -592,6 +592,7 @@ void elv_drain_elevator(struct request_queue *q)
 void __elv_add_request(struct request_queue *q, struct request *rq, int where)
 {
 	trace_block_rq_insert(q, rq);
+	blk_rq_io_stamp(rq, BLK_IO_INSERT);
 
 	blk_pm_add_request(q, rq);
 
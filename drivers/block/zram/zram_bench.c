@@ -0,0 +1,615 @@
+/*
+ * Replay benchmark of zram compression and zsmalloc storage
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * A corpus of page snapshots, e.g. anonymous pages of Android processes
+ * dumped through /proc/<pid>/pagemap and /proc/<pid>/mem, is written
+ * as raw concatenated pages to <debugfs>/zram_bench/corpus. Writing
+ * "<algorithm> [threads]" to run then stores every page the way zram
+ * does (same filled pages aside, compress, zs_malloc() and copy), loads
+ * them back (decompress and verify), and appends throughput, ratio and
+ * latency percentiles, overall and per compressed size band, to
+ * results.
+ */
+
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/kthread.h>
+#include <linux/completion.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/sort.h>
+#include <linux/zsmalloc.h>
+#include <linux/crypto.h>
+#include <linux/module.h>
+
+#include "zcomp.h"
+#include "zram_bench.h"
+
+#define ZRAM_BENCH_MAX_THREADS	8
+#define ZRAM_BENCH_MAX_RESULTS	16
+#define ZRAM_BENCH_BAND_SIZE	256
+#define ZRAM_BENCH_NR_BANDS	(PAGE_SIZE / ZRAM_BENCH_BAND_SIZE)
+
+static unsigned int corpus_max_mb = 256;
+module_param(corpus_max_mb, uint, 0644);
+MODULE_PARM_DESC(corpus_max_mb, "Largest zram_bench corpus in MiB");
+
+enum zram_bench_op {
+	ZRAM_BENCH_COMPRESS,
+	ZRAM_BENCH_ALLOC,
+	ZRAM_BENCH_DECOMPRESS,
+	ZRAM_BENCH_NR_OPS,
+};
+
+static const char * const op_name[ZRAM_BENCH_NR_OPS] = {
+	"compress", "zs_malloc", "decompress",
+};
+
+struct zram_bench_band {
+	unsigned int count;
+	u64 bytes;
+	u64 ns[ZRAM_BENCH_NR_OPS];
+};
+
+struct zram_bench_result {
+	char algo[CRYPTO_MAX_ALG_NAME];
+	unsigned int nr_threads;
+	unsigned int nr_pages;
+	unsigned int nr_same;
+	unsigned int nr_huge;
+	unsigned int nr_errors;
+	u64 compr_bytes;
+	unsigned long pool_pages;
+	u64 store_ns;
+	u64 load_ns;
+	u32 p50[ZRAM_BENCH_NR_OPS];
+	u32 p99[ZRAM_BENCH_NR_OPS];
+	u32 p999[ZRAM_BENCH_NR_OPS];
+	u32 max[ZRAM_BENCH_NR_OPS];
+	struct zram_bench_band band[ZRAM_BENCH_NR_BANDS];
+};
+
+struct zram_bench_run {
+	struct zcomp *comp;
+	struct zs_pool *pool;
+	size_t huge_class_size;
+	unsigned int nr_pages;
+	unsigned int nr_threads;
+	unsigned long *handle;
+	/* compressed size, 0 for a same filled page */
+	unsigned int *obj_size;
+	u32 *ns[ZRAM_BENCH_NR_OPS];
+	atomic_t nr_same;
+	atomic_t errors;
+};
+
+struct zram_bench_worker {
+	struct zram_bench_run *run;
+	unsigned int id;
+	bool load;
+	void *buf;
+	struct completion done;
+};
+
+static struct zram_bench {
+	struct mutex lock;
+	struct page **corpus;
+	unsigned int corpus_cap;
+	size_t corpus_bytes;
+	struct zram_bench_result *results[ZRAM_BENCH_MAX_RESULTS];
+	unsigned int nr_results;
+	struct dentry *root;
+} bench = {
+	.lock = __MUTEX_INITIALIZER(bench.lock),
+};
+
+static void zram_bench_free_corpus(void)
+{
+	unsigned int i;
+
+	if (!bench.corpus)
+		return;
+
+	for (i = 0; i < bench.corpus_cap; i++)
+		if (bench.corpus[i])
+			__free_page(bench.corpus[i]);
+	vfree(bench.corpus);
+	bench.corpus = NULL;
+	bench.corpus_cap = 0;
+	bench.corpus_bytes = 0;
+}
+
+/* writing at offset 0 starts a new corpus, later writes append to it */
+static ssize_t zram_bench_corpus_write(struct file *file,
+		const char __user *ubuf, size_t count, loff_t *ppos)
+{
+	size_t done = 0;
+	ssize_t ret;
+
+	mutex_lock(&bench.lock);
+	if (*ppos == 0) {
+		zram_bench_free_corpus();
+		bench.corpus_cap = ((size_t)corpus_max_mb << 20) >> PAGE_SHIFT;
+		bench.corpus = vzalloc(bench.corpus_cap * sizeof(*bench.corpus));
+		if (!bench.corpus) {
+			bench.corpus_cap = 0;
+			ret = -ENOMEM;
+			goto out;
+		}
+	}
+
+	while (done < count) {
+		loff_t pos = *ppos + done;
+		unsigned int idx = pos >> PAGE_SHIFT;
+		unsigned int off = offset_in_page(pos);
+		size_t len = min_t(size_t, count - done, PAGE_SIZE - off);
+
+		if (idx >= bench.corpus_cap) {
+			ret = done ? done : -ENOSPC;
+			goto advance;
+		}
+
+		if (!bench.corpus[idx]) {
+			bench.corpus[idx] = alloc_page(GFP_KERNEL | __GFP_ZERO);
+			if (!bench.corpus[idx]) {
+				ret = done ? done : -ENOMEM;
+				goto advance;
+			}
+		}
+
+		if (copy_from_user(page_address(bench.corpus[idx]) + off,
+					ubuf + done, len)) {
+			ret = done ? done : -EFAULT;
+			goto advance;
+		}
+		done += len;
+	}
+	ret = done;
+
+advance:
+	*ppos += done;
+	bench.corpus_bytes = max_t(size_t, bench.corpus_bytes, *ppos);
+out:
+	mutex_unlock(&bench.lock);
+
+	return ret;
+}
+
+static const struct file_operations zram_bench_corpus_fops = {
+	.open = simple_open,
+	.write = zram_bench_corpus_write,
+	.llseek = default_llseek,
+};
+
+static bool zram_bench_same_filled(void *ptr)
+{
+	unsigned long *page = ptr;
+	unsigned int pos;
+
+	for (pos = 1; pos < PAGE_SIZE / sizeof(*page); pos++)
+		if (page[pos] != page[0])
+			return false;
+
+	return true;
+}
+
+static void zram_bench_store(struct zram_bench_run *run, unsigned int idx,
+			     void *buf)
+{
+	void *src = page_address(bench.corpus[idx]);
+	struct zcomp_strm *zstrm;
+	unsigned int comp_len;
+	unsigned long handle;
+	u64 start, end;
+	void *dst;
+	int ret;
+
+	if (zram_bench_same_filled(src)) {
+		atomic_inc(&run->nr_same);
+		return;
+	}
+
+	start = ktime_get_ns();
+	zstrm = zcomp_stream_get(run->comp);
+	ret = zcomp_compress(zstrm, src, &comp_len);
+	if (!ret && comp_len < run->huge_class_size)
+		memcpy(buf, zstrm->buffer, comp_len);
+	zcomp_stream_put(run->comp);
+	end = ktime_get_ns();
+	run->ns[ZRAM_BENCH_COMPRESS][idx] = end - start;
+
+	if (ret) {
+		atomic_inc(&run->errors);
+		return;
+	}
+
+	/* zram keeps incompressible pages as they are */
+	if (comp_len >= run->huge_class_size) {
+		comp_len = PAGE_SIZE;
+		memcpy(buf, src, PAGE_SIZE);
+	}
+
+	start = ktime_get_ns();
+	handle = zs_malloc(run->pool, comp_len,
+			GFP_NOIO | __GFP_HIGHMEM | __GFP_MOVABLE);
+	end = ktime_get_ns();
+	run->ns[ZRAM_BENCH_ALLOC][idx] = end - start;
+
+	if (!handle) {
+		atomic_inc(&run->errors);
+		return;
+	}
+
+	dst = zs_map_object(run->pool, handle, ZS_MM_WO);
+	memcpy(dst, buf, comp_len);
+	zs_unmap_object(run->pool, handle);
+
+	run->handle[idx] = handle;
+	run->obj_size[idx] = comp_len;
+}
+
+static void zram_bench_load(struct zram_bench_run *run, unsigned int idx,
+			    void *buf)
+{
+	unsigned int size = run->obj_size[idx];
+	struct zcomp_strm *zstrm;
+	u64 start, end;
+	void *src;
+	int ret = 0;
+
+	if (!size)
+		return;
+
+	start = ktime_get_ns();
+	src = zs_map_object(run->pool, run->handle[idx], ZS_MM_RO);
+	if (size == PAGE_SIZE) {
+		memcpy(buf, src, PAGE_SIZE);
+	} else {
+		zstrm = zcomp_stream_get(run->comp);
+		ret = zcomp_decompress(zstrm, src, size, buf);
+		zcomp_stream_put(run->comp);
+	}
+	zs_unmap_object(run->pool, run->handle[idx]);
+	end = ktime_get_ns();
+	run->ns[ZRAM_BENCH_DECOMPRESS][idx] = end - start;
+
+	if (ret || memcmp(buf, page_address(bench.corpus[idx]), PAGE_SIZE))
+		atomic_inc(&run->errors);
+}
+
+static int zram_bench_thread(void *data)
+{
+	struct zram_bench_worker *worker = data;
+	struct zram_bench_run *run = worker->run;
+	unsigned int idx;
+
+	for (idx = worker->id; idx < run->nr_pages; idx += run->nr_threads) {
+		if (worker->load)
+			zram_bench_load(run, idx, worker->buf);
+		else
+			zram_bench_store(run, idx, worker->buf);
+		cond_resched();
+	}
+
+	complete(&worker->done);
+
+	return 0;
+}
+
+/* runs one pass over the corpus on all threads, returns its wall time */
+static u64 zram_bench_pass(struct zram_bench_run *run,
+			   struct zram_bench_worker *workers, bool load)
+{
+	struct task_struct *task;
+	unsigned int i;
+	u64 start;
+
+	start = ktime_get_ns();
+	for (i = 0; i < run->nr_threads; i++) {
+		workers[i].load = load;
+		init_completion(&workers[i].done);
+		task = kthread_run(zram_bench_thread, &workers[i],
+				   "zram_bench/%u", i);
+		/* do its share here rather than skip it */
+		if (IS_ERR(task))
+			zram_bench_thread(&workers[i]);
+	}
+
+	for (i = 0; i < run->nr_threads; i++)
+		wait_for_completion(&workers[i].done);
+
+	return ktime_get_ns() - start;
+}
+
+static int zram_bench_cmp_u32(const void *a, const void *b)
+{
+	u32 x = *(const u32 *)a, y = *(const u32 *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void zram_bench_summarize(struct zram_bench_run *run,
+				 struct zram_bench_result *res)
+{
+	unsigned int nr_stored, i, op;
+	unsigned int size, band;
+	u32 *lat;
+
+	for (i = 0; i < run->nr_pages; i++) {
+		size = run->obj_size[i];
+		if (!size)
+			continue;
+
+		if (size == PAGE_SIZE)
+			res->nr_huge++;
+		res->compr_bytes += size;
+
+		band = (size - 1) / ZRAM_BENCH_BAND_SIZE;
+		res->band[band].count++;
+		res->band[band].bytes += size;
+		for (op = 0; op < ZRAM_BENCH_NR_OPS; op++)
+			res->band[band].ns[op] += run->ns[op][i];
+	}
+
+	/* sort the latencies of stored pages in place, they are not needed after */
+	for (op = 0; op < ZRAM_BENCH_NR_OPS; op++) {
+		lat = run->ns[op];
+		nr_stored = 0;
+		for (i = 0; i < run->nr_pages; i++)
+			if (run->obj_size[i])
+				lat[nr_stored++] = lat[i];
+		if (!nr_stored)
+			continue;
+
+		sort(lat, nr_stored, sizeof(*lat), zram_bench_cmp_u32, NULL);
+		res->p50[op] = lat[nr_stored / 2];
+		res->p99[op] = lat[(u64)nr_stored * 99 / 100];
+		res->p999[op] = lat[(u64)nr_stored * 999 / 1000];
+		res->max[op] = lat[nr_stored - 1];
+	}
+}
+
+static void zram_bench_free_run(struct zram_bench_run *run)
+{
+	unsigned int i;
+
+	if (run->pool) {
+		for (i = 0; i < run->nr_pages; i++)
+			if (run->obj_size[i])
+				zs_free(run->pool, run->handle[i]);
+		zs_destroy_pool(run->pool);
+	}
+	if (!IS_ERR_OR_NULL(run->comp))
+		zcomp_destroy(run->comp);
+	for (i = 0; i < ZRAM_BENCH_NR_OPS; i++)
+		vfree(run->ns[i]);
+	vfree(run->obj_size);
+	vfree(run->handle);
+}
+
+static int zram_bench_run(const char *algo, unsigned int nr_threads)
+{
+	struct zram_bench_worker workers[ZRAM_BENCH_MAX_THREADS] = { };
+	struct zram_bench_run run = { };
+	struct zram_bench_result *res;
+	unsigned int i;
+	int ret = -ENOMEM;
+
+	if (!bench.corpus_bytes)
+		return -ENODATA;
+
+	/* a corpus written with holes in it can not be replayed */
+	for (i = 0; i < DIV_ROUND_UP(bench.corpus_bytes, PAGE_SIZE); i++)
+		if (!bench.corpus[i])
+			return -EINVAL;
+
+	res = kzalloc(sizeof(*res), GFP_KERNEL);
+	if (!res)
+		return -ENOMEM;
+
+	run.nr_pages = DIV_ROUND_UP(bench.corpus_bytes, PAGE_SIZE);
+	run.nr_threads = nr_threads;
+	atomic_set(&run.nr_same, 0);
+	atomic_set(&run.errors, 0);
+
+	run.handle = vzalloc(run.nr_pages * sizeof(*run.handle));
+	run.obj_size = vzalloc(run.nr_pages * sizeof(*run.obj_size));
+	if (!run.handle || !run.obj_size)
+		goto out;
+	for (i = 0; i < ZRAM_BENCH_NR_OPS; i++) {
+		run.ns[i] = vzalloc(run.nr_pages * sizeof(u32));
+		if (!run.ns[i])
+			goto out;
+	}
+
+	run.comp = zcomp_create(algo);
+	if (IS_ERR(run.comp)) {
+		ret = PTR_ERR(run.comp);
+		goto out;
+	}
+	run.pool = zs_create_pool("zram_bench");
+	if (!run.pool)
+		goto out;
+	run.huge_class_size = zs_huge_class_size(run.pool);
+
+	for (i = 0; i < nr_threads; i++) {
+		workers[i].run = &run;
+		workers[i].id = i;
+		workers[i].buf = kmalloc(PAGE_SIZE, GFP_KERNEL);
+		if (!workers[i].buf)
+			goto out_workers;
+	}
+
+	res->store_ns = zram_bench_pass(&run, workers, false);
+	res->pool_pages = zs_get_total_pages(run.pool);
+	res->load_ns = zram_bench_pass(&run, workers, true);
+
+	strlcpy(res->algo, algo, sizeof(res->algo));
+	res->nr_threads = nr_threads;
+	res->nr_pages = run.nr_pages;
+	res->nr_same = atomic_read(&run.nr_same);
+	res->nr_errors = atomic_read(&run.errors);
+	zram_bench_summarize(&run, res);
+
+	if (bench.nr_results == ZRAM_BENCH_MAX_RESULTS) {
+		kfree(bench.results[0]);
+		memmove(bench.results, bench.results + 1,
+			(ZRAM_BENCH_MAX_RESULTS - 1) * sizeof(*bench.results));
+		bench.nr_results--;
+	}
+	bench.results[bench.nr_results++] = res;
+	res = NULL;
+	ret = 0;
+
+out_workers:
+	for (i = 0; i < nr_threads; i++)
+		kfree(workers[i].buf);
+out:
+	zram_bench_free_run(&run);
+	kfree(res);
+
+	return ret;
+}
+
+static ssize_t zram_bench_run_write(struct file *file,
+		const char __user *ubuf, size_t count, loff_t *ppos)
+{
+	char buf[CRYPTO_MAX_ALG_NAME + 16];
+	char algo[CRYPTO_MAX_ALG_NAME];
+	unsigned int nr_threads = 1;
+	int ret;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	if (sscanf(buf, "%63s %u", algo, &nr_threads) < 1)
+		return -EINVAL;
+	if (!nr_threads || nr_threads > ZRAM_BENCH_MAX_THREADS)
+		return -EINVAL;
+
+	mutex_lock(&bench.lock);
+	ret = zram_bench_run(algo, nr_threads);
+	mutex_unlock(&bench.lock);
+
+	return ret ? ret : count;
+}
+
+static const struct file_operations zram_bench_run_fops = {
+	.open = simple_open,
+	.write = zram_bench_run_write,
+	.llseek = default_llseek,
+};
+
+static u64 zram_bench_mbps(u64 bytes, u64 ns)
+{
+	return ns ? div64_u64((bytes * NSEC_PER_SEC) >> 20, ns) : 0;
+}
+
+static void zram_bench_show_result(struct seq_file *s,
+				   struct zram_bench_result *res)
+{
+	u64 orig = (u64)res->nr_pages * PAGE_SIZE;
+	u64 stored = (u64)(res->nr_pages - res->nr_same - res->nr_errors) *
+			PAGE_SIZE;
+	unsigned int op, band;
+
+	seq_printf(s, "[%s] threads %u pages %u same %u huge %u errors %u\n",
+			res->algo, res->nr_threads, res->nr_pages,
+			res->nr_same, res->nr_huge, res->nr_errors);
+	seq_printf(s, "  store %llu MB/s load %llu MB/s\n",
+			zram_bench_mbps(orig, res->store_ns),
+			zram_bench_mbps(orig, res->load_ns));
+	seq_printf(s, "  compr_data %llu bytes (ratio %llu%%) pool %lu pages (ratio %llu%%)\n",
+			res->compr_bytes,
+			res->compr_bytes ?
+				div64_u64(stored * 100, res->compr_bytes) : 0,
+			res->pool_pages,
+			res->pool_pages ?
+				div64_u64(orig * 100,
+					  (u64)res->pool_pages * PAGE_SIZE) : 0);
+
+	for (op = 0; op < ZRAM_BENCH_NR_OPS; op++)
+		seq_printf(s, "  %-10s p50 %u p99 %u p99.9 %u max %u (ns)\n",
+				op_name[op], res->p50[op], res->p99[op],
+				res->p999[op], res->max[op]);
+
+	seq_puts(s, "  size band     count  avg compress  avg zs_malloc  avg decompress (ns)\n");
+	for (band = 0; band < ZRAM_BENCH_NR_BANDS; band++) {
+		struct zram_bench_band *b = &res->band[band];
+
+		if (!b->count)
+			continue;
+
+		seq_printf(s, "  %4lu-%4lu %9u %13llu %14llu %15llu\n",
+				band * ZRAM_BENCH_BAND_SIZE + 1,
+				(band + 1) * ZRAM_BENCH_BAND_SIZE,
+				b->count,
+				div_u64(b->ns[ZRAM_BENCH_COMPRESS], b->count),
+				div_u64(b->ns[ZRAM_BENCH_ALLOC], b->count),
+				div_u64(b->ns[ZRAM_BENCH_DECOMPRESS], b->count));
+	}
+}
+
+static int zram_bench_results_show(struct seq_file *s, void *unused)
+{
+	unsigned int i;
+
+	mutex_lock(&bench.lock);
+	seq_printf(s, "corpus %zu bytes\n", bench.corpus_bytes);
+	for (i = 0; i < bench.nr_results; i++)
+		zram_bench_show_result(s, bench.results[i]);
+	mutex_unlock(&bench.lock);
+
+	return 0;
+}
+
+static int zram_bench_results_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, zram_bench_results_show, NULL);
+}
+
+static const struct file_operations zram_bench_results_fops = {
+	.open = zram_bench_results_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void zram_bench_init(void)
+{
+	bench.root = debugfs_create_dir("zram_bench", NULL);
+	if (!bench.root)
+		return;
+
+	debugfs_create_file("corpus", 0200, bench.root, NULL,
+			    &zram_bench_corpus_fops);
+	debugfs_create_file("run", 0200, bench.root, NULL,
+			    &zram_bench_run_fops);
+	debugfs_create_file("results", 0444, bench.root, NULL,
+			    &zram_bench_results_fops);
+}
+
+void zram_bench_exit(void)
+{
+	unsigned int i;
+
+	debugfs_remove_recursive(bench.root);
+
+	mutex_lock(&bench.lock);
+	zram_bench_free_corpus();
+	for (i = 0; i < bench.nr_results; i++)
+		kfree(bench.results[i]);
+	bench.nr_results = 0;
+	mutex_unlock(&bench.lock);
+}
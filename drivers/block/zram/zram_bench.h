@@ -0,0 +1,21 @@
+/*
+ * Replay benchmark of zram compression and zsmalloc storage
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef _ZRAM_BENCH_H_
+#define _ZRAM_BENCH_H_
+
+#ifdef CONFIG_ZRAM_BENCH
+void zram_bench_init(void);
+void zram_bench_exit(void);
+#else
+static inline void zram_bench_init(void) { }
+static inline void zram_bench_exit(void) { }
+#endif
+
+#endif /* _ZRAM_BENCH_H_ */
@@ -0,0 +1,239 @@
+/*
+ * Content based deduplication of zram objects
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#define KMSG_COMPONENT "zram"
+#define pr_fmt(fmt) KMSG_COMPONENT ": " fmt
+
+#include <linux/vmalloc.h>
+#include <linux/slab.h>
+#include <linux/rbtree.h>
+#include <linux/xxhash.h>
+
+#include "zram_drv.h"
+
+/* One bucket for every ZRAM_HASH_PERBUCKET pages of disksize */
+#define ZRAM_HASH_PERBUCKET	8
+#define ZRAM_HASH_SIZE_MIN	(1 << 10)
+#define ZRAM_HASH_SIZE_MAX	(1 << 20)
+
+/*
+ * A zsmalloc object that may be shared by several slots. Each bucket
+ * holds at most one entry per checksum; a page whose checksum collides
+ * with a different page is simply stored without deduplication.
+ */
+struct zram_dedup_entry {
+	struct rb_node rb_node;
+	unsigned long handle;
+	unsigned long refcount;
+	unsigned int len;
+	u32 checksum;
+};
+
+u64 zram_dedup_dup_size(struct zram *zram)
+{
+	return (u64)atomic64_read(&zram->stats.dup_data_size);
+}
+
+u64 zram_dedup_meta_size(struct zram *zram)
+{
+	return (u64)atomic64_read(&zram->stats.meta_data_size);
+}
+
+u32 zram_dedup_checksum(const void *mem)
+{
+	return xxh32(mem, PAGE_SIZE, 0);
+}
+
+static struct zram_hash *zram_dedup_bucket(struct zram *zram, u32 checksum)
+{
+	return &zram->hash[checksum % zram->hash_size];
+}
+
+static struct zram_dedup_entry *__zram_dedup_lookup(struct zram_hash *hash,
+						u32 checksum)
+{
+	struct rb_node *rb_node = hash->rb_root.rb_node;
+
+	while (rb_node) {
+		struct zram_dedup_entry *entry = rb_entry(rb_node,
+					struct zram_dedup_entry, rb_node);
+
+		if (checksum == entry->checksum)
+			return entry;
+		if (checksum < entry->checksum)
+			rb_node = rb_node->rb_left;
+		else
+			rb_node = rb_node->rb_right;
+	}
+
+	return NULL;
+}
+
+static bool zram_dedup_match(struct zram *zram, unsigned long handle,
+				unsigned int len, const void *mem)
+{
+	struct zcomp_strm *zstrm;
+	bool match = false;
+	void *cmem;
+
+	cmem = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
+	if (len == PAGE_SIZE) {
+		match = !memcmp(mem, cmem, PAGE_SIZE);
+	} else {
+		zstrm = zcomp_stream_get(zram->comp);
+		if (!zcomp_decompress(zstrm, cmem, len, zstrm->buffer))
+			match = !memcmp(mem, zstrm->buffer, PAGE_SIZE);
+		zcomp_stream_put(zram->comp);
+	}
+	zs_unmap_object(zram->mem_pool, handle);
+
+	return match;
+}
+
+/*
+ * Look up an object holding the same data as @mem. On success a
+ * reference is taken on it for the caller and its handle and
+ * compressed length are returned; 0 is returned otherwise.
+ */
+unsigned long zram_dedup_find(struct zram *zram, const void *mem,
+				u32 checksum, unsigned int *len)
+{
+	struct zram_hash *hash = zram_dedup_bucket(zram, checksum);
+	struct zram_dedup_entry *entry;
+	unsigned long handle;
+
+	spin_lock(&hash->lock);
+	entry = __zram_dedup_lookup(hash, checksum);
+	if (!entry) {
+		spin_unlock(&hash->lock);
+		return 0;
+	}
+	entry->refcount++;
+	handle = entry->handle;
+	*len = entry->len;
+	spin_unlock(&hash->lock);
+
+	/* The reference keeps the object alive while we compare */
+	if (!zram_dedup_match(zram, handle, *len, mem)) {
+		if (zram_dedup_put(zram, handle, checksum)) {
+			zs_free(zram->mem_pool, handle);
+			atomic64_sub(*len, &zram->stats.compr_data_size);
+		}
+		return 0;
+	}
+
+	atomic64_add(*len, &zram->stats.dup_data_size);
+	return handle;
+}
+
+/*
+ * Make a freshly stored object available for sharing. Returns false if
+ * the object could not be recorded, in which case it stays private to
+ * the slot.
+ */
+bool zram_dedup_insert(struct zram *zram, unsigned long handle,
+			unsigned int len, u32 checksum)
+{
+	struct zram_hash *hash = zram_dedup_bucket(zram, checksum);
+	struct zram_dedup_entry *entry, *cur;
+	struct rb_node **rb_node, *parent = NULL;
+
+	entry = kmalloc(sizeof(*entry), GFP_NOIO | __GFP_NOWARN);
+	if (!entry)
+		return false;
+
+	entry->handle = handle;
+	entry->refcount = 1;
+	entry->len = len;
+	entry->checksum = checksum;
+
+	spin_lock(&hash->lock);
+	rb_node = &hash->rb_root.rb_node;
+	while (*rb_node) {
+		parent = *rb_node;
+		cur = rb_entry(parent, struct zram_dedup_entry, rb_node);
+		if (checksum == cur->checksum) {
+			spin_unlock(&hash->lock);
+			kfree(entry);
+			return false;
+		}
+		if (checksum < cur->checksum)
+			rb_node = &parent->rb_left;
+		else
+			rb_node = &parent->rb_right;
+	}
+	rb_link_node(&entry->rb_node, parent, rb_node);
+	rb_insert_color(&entry->rb_node, &hash->rb_root);
+	spin_unlock(&hash->lock);
+
+	atomic64_add(sizeof(*entry), &zram->stats.meta_data_size);
+	return true;
+}
+
+/*
+ * Drop a reference on a shared object. Returns true if it was the last
+ * one, in which case the caller must free the zsmalloc object.
+ */
+bool zram_dedup_put(struct zram *zram, unsigned long handle, u32 checksum)
+{
+	struct zram_hash *hash = zram_dedup_bucket(zram, checksum);
+	struct zram_dedup_entry *entry;
+	bool last = false;
+
+	spin_lock(&hash->lock);
+	entry = __zram_dedup_lookup(hash, checksum);
+	if (WARN_ON_ONCE(!entry || entry->handle != handle)) {
+		spin_unlock(&hash->lock);
+		return false;
+	}
+
+	if (!--entry->refcount) {
+		rb_erase(&entry->rb_node, &hash->rb_root);
+		last = true;
+	}
+	spin_unlock(&hash->lock);
+
+	if (last) {
+		kfree(entry);
+		atomic64_sub(sizeof(*entry), &zram->stats.meta_data_size);
+	}
+
+	return last;
+}
+
+int zram_dedup_init(struct zram *zram, size_t num_pages)
+{
+	size_t i;
+
+	if (!zram->use_dedup)
+		return 0;
+
+	zram->hash_size = num_pages / ZRAM_HASH_PERBUCKET;
+	zram->hash_size = clamp_t(size_t, zram->hash_size,
+				ZRAM_HASH_SIZE_MIN, ZRAM_HASH_SIZE_MAX);
+	zram->hash = vzalloc(zram->hash_size * sizeof(struct zram_hash));
+	if (!zram->hash) {
+		pr_err("Error allocating zram entry hash\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < zram->hash_size; i++) {
+		spin_lock_init(&zram->hash[i].lock);
+		zram->hash[i].rb_root = RB_ROOT;
+	}
+
+	return 0;
+}
+
+void zram_dedup_fini(struct zram *zram)
+{
+	vfree(zram->hash);
+	zram->hash = NULL;
+	zram->hash_size = 0;
+}
@@ -34,6 +34,7 @@
 #include <linux/debugfs.h>
 
 #include "zram_drv.h"
+#include "zram_bench.h"
 
 static DEFINE_IDR(zram_index_idr);
 /* idr index must be protected */
@@ -561,22 +562,6 @@ static ssize_t backing_dev_store(struct device *dev,
 	return err;
 }
 
-static unsigned long alloc_block_bdev(struct zram *zram)
-{
-	unsigned long blk_idx = 1;
-retry:
-	/* skip 0 bit to confuse zram.handle = 0 */
-	blk_idx = find_next_zero_bit(zram->bitmap, zram->nr_pages, blk_idx);
-	if (blk_idx == zram->nr_pages)
-		return 0;
-
-	if (test_and_set_bit(blk_idx, zram->bitmap))
-		goto retry;
-
-	atomic64_inc(&zram->stats.bd_count);
-	return blk_idx;
-}
-
 static void free_block_bdev(struct zram *zram, unsigned long blk_idx)
 {
 	int was_set;
@@ -628,18 +613,255 @@ static int read_from_bdev_async(struct zram *zram, struct bio_vec *bvec,
 #define HUGE_WRITEBACK 1
 #define IDLE_WRITEBACK 2
 
+/* pages per writeback bio and writeback bios kept in flight */
+#define ZRAM_WB_BATCH		32
+#define ZRAM_WB_MAX_INFLIGHT	8
+
+struct zram_wb_ctx {
+	struct work_struct work;
+	struct zram *zram;
+	struct bio *bio;
+	unsigned long blk_idx;
+	unsigned int nr;
+	u32 index[ZRAM_WB_BATCH];
+};
+
+/*
+ * Allocate up to *nr contiguous blocks on the backing device, shrinking
+ * the run if no free area of that length is left. Returns the first
+ * block and updates *nr, or returns 0 if the device is full.
+ */
+static unsigned long alloc_block_bdev_range(struct zram *zram,
+					unsigned int *nr)
+{
+	unsigned int want = *nr;
+	unsigned long blk_idx, i;
+
+	while (want) {
+		/* skip 0 bit to confuse zram.handle = 0 */
+		blk_idx = bitmap_find_next_zero_area(zram->bitmap,
+					zram->nr_pages, 1, want, 0);
+		if (blk_idx >= zram->nr_pages) {
+			want >>= 1;
+			continue;
+		}
+
+		for (i = 0; i < want; i++) {
+			if (test_and_set_bit(blk_idx + i, zram->bitmap))
+				break;
+		}
+		if (i < want) {
+			/* raced with another allocator, retry */
+			while (i--)
+				clear_bit(blk_idx + i, zram->bitmap);
+			continue;
+		}
+
+		atomic64_add(want, &zram->stats.bd_count);
+		*nr = want;
+		return blk_idx;
+	}
+
+	return 0;
+}
+
+/*
+ * The writeback limit is charged when a slot is picked and refunded if
+ * the slot does not end up on the backing device.
+ */
+static bool zram_wb_limit_get(struct zram *zram)
+{
+	bool ret = true;
+
+	spin_lock(&zram->wb_limit_lock);
+	if (zram->wb_limit_enable) {
+		if (zram->bd_wb_limit < (1UL << (PAGE_SHIFT - 12)))
+			ret = false;
+		else
+			zram->bd_wb_limit -= 1UL << (PAGE_SHIFT - 12);
+	}
+	spin_unlock(&zram->wb_limit_lock);
+
+	return ret;
+}
+
+static void zram_wb_limit_put(struct zram *zram)
+{
+	spin_lock(&zram->wb_limit_lock);
+	if (zram->wb_limit_enable)
+		zram->bd_wb_limit += 1UL << (PAGE_SHIFT - 12);
+	spin_unlock(&zram->wb_limit_lock);
+}
+
+static void zram_wb_cancel(struct zram *zram, u32 index)
+{
+	zram_slot_lock(zram, index);
+	zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+	zram_slot_unlock(zram, index);
+	zram_wb_limit_put(zram);
+}
+
+static void zram_wb_finish(struct work_struct *work)
+{
+	struct zram_wb_ctx *ctx = container_of(work, struct zram_wb_ctx,
+						work);
+	struct zram *zram = ctx->zram;
+	int err = ctx->bio->bi_error;
+	unsigned int i;
+
+	for (i = 0; i < ctx->nr; i++) {
+		u32 index = ctx->index[i];
+		unsigned long blk_idx = ctx->blk_idx + i;
+
+		__free_page(ctx->bio->bi_io_vec[i].bv_page);
+
+		if (err) {
+			zram_wb_cancel(zram, index);
+			free_block_bdev(zram, blk_idx);
+			continue;
+		}
+
+		atomic64_inc(&zram->stats.bd_writes);
+		/*
+		 * We released zram_slot_lock so need to check if the slot was
+		 * changed. If there is freeing for the slot, we can catch it
+		 * easily by zram_allocated.
+		 * A subtle case is the slot is freed/reallocated/marked as
+		 * ZRAM_IDLE again. To close the race, idle_store doesn't
+		 * mark ZRAM_IDLE once it found the slot was ZRAM_UNDER_WB.
+		 * Thus, we could close the race by checking ZRAM_IDLE bit.
+		 */
+		zram_slot_lock(zram, index);
+		if (!zram_allocated(zram, index) ||
+			  !zram_test_flag(zram, index, ZRAM_IDLE)) {
+			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+			zram_clear_flag(zram, index, ZRAM_IDLE);
+			zram_slot_unlock(zram, index);
+			zram_wb_limit_put(zram);
+			free_block_bdev(zram, blk_idx);
+			continue;
+		}
+
+		zram_free_page(zram, index);
+		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+		zram_set_flag(zram, index, ZRAM_WB);
+		zram_set_element(zram, index, blk_idx);
+		atomic64_inc(&zram->stats.pages_stored);
+		zram_slot_unlock(zram, index);
+	}
+
+	bio_put(ctx->bio);
+	kfree(ctx);
+
+	if (atomic_dec_and_test(&zram->wb_inflight))
+		wake_up(&zram->wb_wait);
+}
+
+static void zram_wb_end_io(struct bio *bio)
+{
+	struct zram_wb_ctx *ctx = bio->bi_private;
+
+	/* slot locks are not irq safe, finish the slots in process context */
+	queue_work(ctx->zram->wq, &ctx->work);
+}
+
+/*
+ * Write the pages of @count picked slots to the backing device using
+ * as few bios as the free space allows. Slots that could not be
+ * submitted are given back.
+ */
+static int zram_wb_submit(struct zram *zram, u32 *index,
+			struct page **pages, unsigned int count)
+{
+	unsigned int done = 0;
+	int ret = 0;
+
+	while (done < count) {
+		unsigned int i, nr = count - done;
+		struct zram_wb_ctx *ctx;
+		unsigned long blk_idx;
+		struct bio *bio;
+
+		blk_idx = alloc_block_bdev_range(zram, &nr);
+		if (!blk_idx) {
+			ret = -ENOSPC;
+			break;
+		}
+
+		ctx = kmalloc(sizeof(*ctx), GFP_KERNEL);
+		bio = bio_alloc(GFP_KERNEL, nr);
+		if (!ctx || !bio) {
+			kfree(ctx);
+			if (bio)
+				bio_put(bio);
+			for (i = 0; i < nr; i++)
+				free_block_bdev(zram, blk_idx + i);
+			ret = -ENOMEM;
+			break;
+		}
+
+		bio->bi_bdev = zram->bdev;
+		bio->bi_iter.bi_sector = blk_idx * (PAGE_SIZE >> 9);
+		bio_set_op_attrs(bio, REQ_OP_WRITE, 0);
+		bio->bi_end_io = zram_wb_end_io;
+		bio->bi_private = ctx;
+
+		for (i = 0; i < nr; i++) {
+			if (!bio_add_page(bio, pages[done + i], PAGE_SIZE, 0))
+				break;
+		}
+		if (i < nr) {
+			/* hit the queue limits, give back the tail blocks */
+			unsigned int j;
+
+			for (j = i; j < nr; j++)
+				free_block_bdev(zram, blk_idx + j);
+			nr = i;
+		}
+		if (!nr) {
+			bio_put(bio);
+			kfree(ctx);
+			ret = -EIO;
+			break;
+		}
+
+		INIT_WORK(&ctx->work, zram_wb_finish);
+		ctx->zram = zram;
+		ctx->bio = bio;
+		ctx->blk_idx = blk_idx;
+		ctx->nr = nr;
+		memcpy(ctx->index, index + done, nr * sizeof(*index));
+
+		wait_event(zram->wb_wait, atomic_read(&zram->wb_inflight) <
+						ZRAM_WB_MAX_INFLIGHT);
+		atomic_inc(&zram->wb_inflight);
+		submit_bio(bio);
+		done += nr;
+	}
+
+	for (; done < count; done++) {
+		zram_wb_cancel(zram, index[done]);
+		__free_page(pages[done]);
+	}
+
+	return ret;
+}
+
 static ssize_t writeback_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
 	struct zram *zram = dev_to_zram(dev);
 	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
 	unsigned long index;
-	struct bio bio;
+	u32 batch_index[ZRAM_WB_BATCH];
+	struct page *batch_pages[ZRAM_WB_BATCH];
+	unsigned int count = 0;
+	struct blk_plug plug;
 	struct page *page;
 	ssize_t ret, sz;
 	char mode_buf[8];
 	int mode = -1;
-	unsigned long blk_idx = 0;
 
 	sz = strscpy(mode_buf, buf, sizeof(mode_buf));
 	if (sz <= 0)
@@ -668,35 +890,10 @@ static ssize_t writeback_store(struct device *dev,
 		goto release_init_lock;
 	}
 
-	page = alloc_page(GFP_KERNEL);
-	if (!page) {
-		ret = -ENOMEM;
-		goto release_init_lock;
-	}
-
+	blk_start_plug(&plug);
 	for (index = 0; index < nr_pages; index++) {
 		struct bio_vec bvec;
 
-		bvec.bv_page = page;
-		bvec.bv_len = PAGE_SIZE;
-		bvec.bv_offset = 0;
-
-		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && !zram->bd_wb_limit) {
-			spin_unlock(&zram->wb_limit_lock);
-			ret = -EIO;
-			break;
-		}
-		spin_unlock(&zram->wb_limit_lock);
-
-		if (!blk_idx) {
-			blk_idx = alloc_block_bdev(zram);
-			if (!blk_idx) {
-				ret = -ENOSPC;
-				break;
-			}
-		}
-
 		zram_slot_lock(zram, index);
 		if (!zram_allocated(zram, index))
 			goto next;
@@ -712,6 +909,12 @@ static ssize_t writeback_store(struct device *dev,
 		if (mode == HUGE_WRITEBACK &&
 			  !zram_test_flag(zram, index, ZRAM_HUGE))
 			goto next;
+
+		if (!zram_wb_limit_get(zram)) {
+			zram_slot_unlock(zram, index);
+			ret = -EIO;
+			break;
+		}
 		/*
 		 * Clearing ZRAM_UNDER_WB is duty of caller.
 		 * IOW, zram_free_page never clear it.
@@ -720,73 +923,44 @@ static ssize_t writeback_store(struct device *dev,
 		/* Need for hugepage writeback racing */
 		zram_set_flag(zram, index, ZRAM_IDLE);
 		zram_slot_unlock(zram, index);
-		if (zram_bvec_read(zram, &bvec, index, 0, NULL)) {
-			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			zram_slot_unlock(zram, index);
-			continue;
-		}
-
-		bio_init(&bio);
 
-		bio.bi_max_vecs = 1;
-		bio.bi_io_vec = &bvec;
-		bio.bi_bdev = zram->bdev;
+		page = alloc_page(GFP_KERNEL);
+		if (!page) {
+			zram_wb_cancel(zram, index);
+			ret = -ENOMEM;
+			break;
+		}
 
-		bio.bi_iter.bi_sector = blk_idx * (PAGE_SIZE >> 9);
-		bio_set_op_attrs(&bio, REQ_OP_WRITE, REQ_SYNC);
-		bio_add_page(&bio, bvec.bv_page, bvec.bv_len,
-				bvec.bv_offset);
-		/*
-		 * XXX: A single page IO would be inefficient for write
-		 * but it would be not bad as starter.
-		 */
-		ret = submit_bio_wait(&bio);
-		if (ret) {
-			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			zram_slot_unlock(zram, index);
+		bvec.bv_page = page;
+		bvec.bv_len = PAGE_SIZE;
+		bvec.bv_offset = 0;
+		if (zram_bvec_read(zram, &bvec, index, 0, NULL)) {
+			zram_wb_cancel(zram, index);
+			__free_page(page);
 			continue;
 		}
 
-		atomic64_inc(&zram->stats.bd_writes);
-		/*
-		 * We released zram_slot_lock so need to check if the slot was
-		 * changed. If there is freeing for the slot, we can catch it
-		 * easily by zram_allocated.
-		 * A subtle case is the slot is freed/reallocated/marked as
-		 * ZRAM_IDLE again. To close the race, idle_store doesn't
-		 * mark ZRAM_IDLE once it found the slot was ZRAM_UNDER_WB.
-		 * Thus, we could close the race by checking ZRAM_IDLE bit.
-		 */
-		zram_slot_lock(zram, index);
-		if (!zram_allocated(zram, index) ||
-			  !zram_test_flag(zram, index, ZRAM_IDLE)) {
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			goto next;
+		batch_index[count] = index;
+		batch_pages[count] = page;
+		if (++count == ZRAM_WB_BATCH) {
+			ret = zram_wb_submit(zram, batch_index, batch_pages,
+						count);
+			count = 0;
+			if (ret)
+				break;
 		}
-
-		zram_free_page(zram, index);
-		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-		zram_set_flag(zram, index, ZRAM_WB);
-		zram_set_element(zram, index, blk_idx);
-		blk_idx = 0;
-		atomic64_inc(&zram->stats.pages_stored);
-		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && zram->bd_wb_limit > 0)
-			zram->bd_wb_limit -=  1UL << (PAGE_SHIFT - 12);
-		spin_unlock(&zram->wb_limit_lock);
+		continue;
 next:
 		zram_slot_unlock(zram, index);
 	}
 
-	if (blk_idx)
-		free_block_bdev(zram, blk_idx);
+	if (count)
+		zram_wb_submit(zram, batch_index, batch_pages, count);
+	blk_finish_plug(&plug);
+
+	/* slots are settled by zram_wb_finish() before we drop init_lock */
+	wait_event(zram->wb_wait, !atomic_read(&zram->wb_inflight));
 	ret = len;
-	__free_page(page);
 release_init_lock:
 	up_read(&zram->init_lock);
 
@@ -999,6 +1173,27 @@ static ssize_t max_comp_streams_store(struct device *dev,
 	return len;
 }
 
+static ssize_t parallel_write_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", READ_ONCE(zram->parallel_write));
+}
+
+static ssize_t parallel_write_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	if (kstrtobool(buf, &val))
+		return -EINVAL;
+
+	WRITE_ONCE(zram->parallel_write, val);
+	return len;
+}
+
 static ssize_t comp_algorithm_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
@@ -1040,6 +1235,210 @@ static ssize_t comp_algorithm_store(struct device *dev,
 	return len;
 }
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static ssize_t recomp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t sz;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	sz = zcomp_available_show(zram->recomp_compressor, buf);
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+static ssize_t recomp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	char compressor[ARRAY_SIZE(zram->recomp_compressor)];
+	size_t sz;
+
+	strlcpy(compressor, buf, sizeof(compressor));
+	/* ignore trailing newline */
+	sz = strlen(compressor);
+	if (sz > 0 && compressor[sz - 1] == '\n')
+		compressor[sz - 1] = 0x00;
+
+	/* empty string disables recompression */
+	if (compressor[0] && !zcomp_available_algorithm(compressor))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+
+	strcpy(zram->recomp_compressor, compressor);
+	up_write(&zram->init_lock);
+	return len;
+}
+
+/*
+ * Recompress one slot with the secondary algorithm. Called with the
+ * slot locked, so nothing here may sleep. Returns 0 if the slot was
+ * replaced or skipped, -ENOMEM if the new object could not be allocated.
+ */
+static int zram_recompress_slot(struct zram *zram, u32 index,
+				struct page *page)
+{
+	unsigned long handle_old, handle_new;
+	unsigned int size_old, comp_len;
+	struct zcomp_strm *zstrm;
+	void *src, *dst;
+	int ret;
+
+	handle_old = zram_get_handle(zram, index);
+	size_old = zram_get_obj_size(zram, index);
+
+	src = zs_map_object(zram->mem_pool, handle_old, ZS_MM_RO);
+	dst = kmap_atomic(page);
+	if (size_old == PAGE_SIZE) {
+		memcpy(dst, src, PAGE_SIZE);
+		ret = 0;
+	} else {
+		zstrm = zcomp_stream_get(zram->comp);
+		ret = zcomp_decompress(zstrm, src, size_old, dst);
+		zcomp_stream_put(zram->comp);
+	}
+	kunmap_atomic(dst);
+	zs_unmap_object(zram->mem_pool, handle_old);
+	if (unlikely(ret))
+		return 0;
+
+	zstrm = zcomp_stream_get(zram->recomp);
+	src = kmap_atomic(page);
+	ret = zcomp_compress(zstrm, src, &comp_len);
+	kunmap_atomic(src);
+
+	/* Only keep the new object if it actually saves memory */
+	if (ret || comp_len >= huge_class_size || comp_len >= size_old) {
+		zcomp_stream_put(zram->recomp);
+		return 0;
+	}
+
+	handle_new = zs_malloc(zram->mem_pool, comp_len,
+			__GFP_KSWAPD_RECLAIM |
+			__GFP_NOWARN |
+			__GFP_HIGHMEM |
+			__GFP_MOVABLE);
+	if (!handle_new) {
+		zcomp_stream_put(zram->recomp);
+		return -ENOMEM;
+	}
+
+	dst = zs_map_object(zram->mem_pool, handle_new, ZS_MM_WO);
+	memcpy(dst, zstrm->buffer, comp_len);
+	zs_unmap_object(zram->mem_pool, handle_new);
+	zcomp_stream_put(zram->recomp);
+
+	zram_free_page(zram, index);
+	zram_set_handle(zram, index, handle_new);
+	zram_set_obj_size(zram, index, comp_len);
+	zram_set_flag(zram, index, ZRAM_RECOMP);
+
+	atomic64_add(comp_len, &zram->stats.compr_data_size);
+	atomic64_inc(&zram->stats.pages_stored);
+	return 0;
+}
+
+static void zram_recompress_work(struct work_struct *work)
+{
+	struct zram *zram = container_of(work, struct zram, recomp_work);
+	unsigned long nr_pages, index;
+	struct page *page;
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page)
+		return;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram->recomp)
+		goto out;
+
+	nr_pages = zram->disksize >> PAGE_SHIFT;
+	for (index = 0; index < nr_pages; index++) {
+		int ret = 0;
+
+		zram_slot_lock(zram, index);
+		if (zram_allocated(zram, index) &&
+		    zram_test_flag(zram, index, ZRAM_IDLE) &&
+		    !zram_test_flag(zram, index, ZRAM_WB) &&
+		    !zram_test_flag(zram, index, ZRAM_UNDER_WB) &&
+		    !zram_test_flag(zram, index, ZRAM_SAME) &&
+		    !zram_test_flag(zram, index, ZRAM_DEDUP) &&
+		    !zram_test_flag(zram, index, ZRAM_RECOMP))
+			ret = zram_recompress_slot(zram, index, page);
+		zram_slot_unlock(zram, index);
+
+		if (ret)
+			break;
+		cond_resched();
+	}
+out:
+	up_read(&zram->init_lock);
+	__free_page(page);
+}
+
+static ssize_t recompress_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	ssize_t ret = len;
+
+	if (!sysfs_streq(buf, "idle"))
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram->recomp)
+		ret = -EINVAL;
+	else
+		queue_work(zram->wq, &zram->recomp_work);
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+#endif
+
+#ifdef CONFIG_ZRAM_DEDUP
+static ssize_t use_dedup_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	bool val;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	val = zram->use_dedup;
+	up_read(&zram->init_lock);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", (int)val);
+}
+
+static ssize_t use_dedup_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	int val;
+	struct zram *zram = dev_to_zram(dev);
+
+	if (kstrtoint(buf, 10, &val) || (val != 0 && val != 1))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change dedup usage for initialized device\n");
+		return -EBUSY;
+	}
+	zram->use_dedup = val;
+	up_write(&zram->init_lock);
+	return len;
+}
+#endif
+
 static ssize_t compact_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
@@ -1096,7 +1495,7 @@ static ssize_t mm_stat_show(struct device *dev,
 	max_used = atomic_long_read(&zram->stats.max_used_pages);
 
 	ret = scnprintf(buf, PAGE_SIZE,
-			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu\n",
+			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu %8llu %8llu\n",
 			orig_size << PAGE_SHIFT,
 			(u64)atomic64_read(&zram->stats.compr_data_size),
 			mem_used << PAGE_SHIFT,
@@ -1104,7 +1503,9 @@ static ssize_t mm_stat_show(struct device *dev,
 			max_used << PAGE_SHIFT,
 			(u64)atomic64_read(&zram->stats.same_pages),
 			pool_stats.pages_compacted,
-			(u64)atomic64_read(&zram->stats.huge_pages));
+			(u64)atomic64_read(&zram->stats.huge_pages),
+			zram_dedup_dup_size(zram),
+			zram_dedup_meta_size(zram));
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -1164,6 +1565,7 @@ static void zram_meta_free(struct zram *zram, u64 disksize)
 	for (index = 0; index < num_pages; index++)
 		zram_free_page(zram, index);
 
+	zram_dedup_fini(zram);
 	zs_destroy_pool(zram->mem_pool);
 	vfree(zram->table);
 }
@@ -1183,6 +1585,12 @@ static bool zram_meta_alloc(struct zram *zram, u64 disksize)
 		return false;
 	}
 
+	if (zram_dedup_init(zram, num_pages)) {
+		zs_destroy_pool(zram->mem_pool);
+		vfree(zram->table);
+		return false;
+	}
+
 	if (!huge_class_size)
 		huge_class_size = zs_huge_class_size(zram->mem_pool);
 	return true;
@@ -1208,6 +1616,9 @@ static void zram_free_page(struct zram *zram, size_t index)
 		atomic64_dec(&zram->stats.huge_pages);
 	}
 
+	if (zram_test_flag(zram, index, ZRAM_RECOMP))
+		zram_clear_flag(zram, index, ZRAM_RECOMP);
+
 	if (zram_test_flag(zram, index, ZRAM_WB)) {
 		zram_clear_flag(zram, index, ZRAM_WB);
 		free_block_bdev(zram, zram_get_element(zram, index));
@@ -1228,6 +1639,19 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (!handle)
 		return;
 
+#ifdef CONFIG_ZRAM_DEDUP
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		zram_clear_flag(zram, index, ZRAM_DEDUP);
+		/* Other slots still share the object */
+		if (!zram_dedup_put(zram, handle,
+				zram->table[index].checksum)) {
+			atomic64_sub(zram_get_obj_size(zram, index),
+					&zram->stats.dup_data_size);
+			goto out;
+		}
+	}
+#endif
+
 	zs_free(zram->mem_pool, handle);
 
 	atomic64_sub(zram_get_obj_size(zram, index),
@@ -1284,12 +1708,18 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		kunmap_atomic(dst);
 		ret = 0;
 	} else {
-		struct zcomp_strm *zstrm = zcomp_stream_get(zram->comp);
+		struct zcomp *comp = zram->comp;
+		struct zcomp_strm *zstrm;
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+		if (zram_test_flag(zram, index, ZRAM_RECOMP))
+			comp = zram->recomp;
+#endif
+		zstrm = zcomp_stream_get(comp);
 		dst = kmap_atomic(page);
 		ret = zcomp_decompress(zstrm, src, size, dst);
 		kunmap_atomic(dst);
-		zcomp_stream_put(zram->comp);
+		zcomp_stream_put(comp);
 	}
 	zs_unmap_object(zram->mem_pool, handle);
 	zram_slot_unlock(zram, index);
@@ -1346,6 +1776,10 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	struct page *page = bvec->bv_page;
 	unsigned long element = 0;
 	enum zram_pageflags flags = 0;
+#ifdef CONFIG_ZRAM_DEDUP
+	bool dedup = false;
+	u32 checksum = 0;
+#endif
 
 	mem = kmap_atomic(page);
 	if (page_same_filled(mem, &element)) {
@@ -1355,6 +1789,17 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 		atomic64_inc(&zram->stats.same_pages);
 		goto out;
 	}
+#ifdef CONFIG_ZRAM_DEDUP
+	if (zram->use_dedup) {
+		checksum = zram_dedup_checksum(mem);
+		handle = zram_dedup_find(zram, mem, checksum, &comp_len);
+		if (handle) {
+			kunmap_atomic(mem);
+			dedup = true;
+			goto out;
+		}
+	}
+#endif
 	kunmap_atomic(mem);
 
 compress_again:
@@ -1423,6 +1868,10 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	zcomp_stream_put(zram->comp);
 	zs_unmap_object(zram->mem_pool, handle);
 	atomic64_add(comp_len, &zram->stats.compr_data_size);
+#ifdef CONFIG_ZRAM_DEDUP
+	if (zram->use_dedup)
+		dedup = zram_dedup_insert(zram, handle, comp_len, checksum);
+#endif
 out:
 	/*
 	 * Free memory associated with this sector
@@ -1443,6 +1892,12 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 		zram_set_handle(zram, index, handle);
 		zram_set_obj_size(zram, index, comp_len);
 	}
+#ifdef CONFIG_ZRAM_DEDUP
+	if (dedup) {
+		zram_set_flag(zram, index, ZRAM_DEDUP);
+		zram->table[index].checksum = checksum;
+	}
+#endif
 	zram_slot_unlock(zram, index);
 
 	/* Update stats */
@@ -1569,6 +2024,95 @@ static int zram_bvec_rw(struct zram *zram, struct bio_vec *bvec, u32 index,
 	return ret;
 }
 
+/*
+ * Multi-page write bios are split into one work per page and handed to
+ * the per-device unbound workqueue, so each page is compressed on the
+ * per-cpu stream of whichever CPU picks the work up. The bio is
+ * completed by the last work to finish.
+ */
+struct zram_pwrite_ctx;
+
+struct zram_pwrite_work {
+	struct work_struct work;
+	struct zram_pwrite_ctx *ctx;
+	struct bio_vec bvec;
+	u32 index;
+};
+
+struct zram_pwrite_ctx {
+	struct zram *zram;
+	struct bio *bio;
+	atomic_t pending;
+	bool error;
+	struct zram_pwrite_work works[0];
+};
+
+static void zram_pwrite_fn(struct work_struct *work)
+{
+	struct zram_pwrite_work *pw = container_of(work,
+					struct zram_pwrite_work, work);
+	struct zram_pwrite_ctx *ctx = pw->ctx;
+
+	if (zram_bvec_rw(ctx->zram, &pw->bvec, pw->index, 0, true,
+				ctx->bio) < 0)
+		WRITE_ONCE(ctx->error, true);
+
+	if (!atomic_dec_and_test(&ctx->pending))
+		return;
+
+	if (ctx->error)
+		bio_io_error(ctx->bio);
+	else
+		bio_endio(ctx->bio);
+	kfree(ctx);
+}
+
+/*
+ * Returns true if the bio was taken over by the parallel write path,
+ * false if the caller should process it synchronously.
+ */
+static bool zram_parallel_write(struct zram *zram, struct bio *bio,
+				u32 index, int offset)
+{
+	struct zram_pwrite_ctx *ctx;
+	struct bio_vec bvec;
+	struct bvec_iter iter;
+	unsigned int nr_pages = 0;
+	unsigned int i = 0;
+
+	if (offset || bio->bi_iter.bi_size <= PAGE_SIZE)
+		return false;
+
+	/* Only whole pages; partial IO needs read-modify-write */
+	bio_for_each_segment(bvec, bio, iter) {
+		if (bvec.bv_offset || bvec.bv_len != PAGE_SIZE)
+			return false;
+		nr_pages++;
+	}
+
+	ctx = kmalloc(sizeof(*ctx) + nr_pages * sizeof(ctx->works[0]),
+			GFP_NOIO | __GFP_NOWARN);
+	if (!ctx)
+		return false;
+
+	ctx->zram = zram;
+	ctx->bio = bio;
+	ctx->error = false;
+	atomic_set(&ctx->pending, nr_pages);
+
+	bio_for_each_segment(bvec, bio, iter) {
+		struct zram_pwrite_work *pw = &ctx->works[i++];
+
+		INIT_WORK(&pw->work, zram_pwrite_fn);
+		pw->ctx = ctx;
+		pw->bvec = bvec;
+		pw->index = index++;
+		queue_work(zram->wq, &pw->work);
+	}
+
+	return true;
+}
+
 static void __zram_make_request(struct zram *zram, struct bio *bio)
 {
 	int offset;
@@ -1586,6 +2130,10 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 		return;
 	}
 
+	if (op_is_write(bio_op(bio)) && READ_ONCE(zram->parallel_write) &&
+			zram_parallel_write(zram, bio, index, offset))
+		return;
+
 	bio_for_each_segment(bvec, bio, iter) {
 		struct bio_vec bv = bvec;
 		unsigned int unwritten = bvec.bv_len;
@@ -1703,6 +2251,9 @@ static void zram_reset_device(struct zram *zram)
 	struct zcomp *comp;
 	u64 disksize;
 
+	/* Wait for split write bios still being compressed */
+	flush_workqueue(zram->wq);
+
 	down_write(&zram->init_lock);
 
 	zram->limit_pages = 0;
@@ -1724,6 +2275,12 @@ static void zram_reset_device(struct zram *zram)
 	zram_meta_free(zram, disksize);
 	memset(&zram->stats, 0, sizeof(zram->stats));
 	zcomp_destroy(comp);
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram->recomp) {
+		zcomp_destroy(zram->recomp);
+		zram->recomp = NULL;
+	}
+#endif
 	reset_bdev(zram);
 }
 
@@ -1760,6 +2317,20 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_free_meta;
 	}
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram->recomp_compressor[0]) {
+		zram->recomp = zcomp_create(zram->recomp_compressor);
+		if (IS_ERR(zram->recomp)) {
+			pr_err("Cannot initialise %s recompressing backend\n",
+					zram->recomp_compressor);
+			err = PTR_ERR(zram->recomp);
+			zram->recomp = NULL;
+			zcomp_destroy(comp);
+			goto out_free_meta;
+		}
+	}
+#endif
+
 	zram->comp = comp;
 	zram->disksize = disksize;
 	set_capacity(zram->disk, zram->disksize >> SECTOR_SHIFT);
@@ -1851,6 +2422,14 @@ static DEVICE_ATTR_WO(mem_limit);
 static DEVICE_ATTR_WO(mem_used_max);
 static DEVICE_ATTR_WO(idle);
 static DEVICE_ATTR_RW(max_comp_streams);
+static DEVICE_ATTR_RW(parallel_write);
+#ifdef CONFIG_ZRAM_DEDUP
+static DEVICE_ATTR_RW(use_dedup);
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static DEVICE_ATTR_RW(recomp_algorithm);
+static DEVICE_ATTR_WO(recompress);
+#endif
 static DEVICE_ATTR_RW(comp_algorithm);
 #ifdef CONFIG_ZRAM_WRITEBACK
 static DEVICE_ATTR_RW(backing_dev);
@@ -1868,6 +2447,14 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_mem_used_max.attr,
 	&dev_attr_idle.attr,
 	&dev_attr_max_comp_streams.attr,
+	&dev_attr_parallel_write.attr,
+#ifdef CONFIG_ZRAM_DEDUP
+	&dev_attr_use_dedup.attr,
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	&dev_attr_recomp_algorithm.attr,
+	&dev_attr_recompress.attr,
+#endif
 	&dev_attr_comp_algorithm.attr,
 #ifdef CONFIG_ZRAM_WRITEBACK
 	&dev_attr_backing_dev.attr,
@@ -1915,6 +2502,11 @@ static int zram_add(void)
 	init_rwsem(&zram->init_lock);
 #ifdef CONFIG_ZRAM_WRITEBACK
 	spin_lock_init(&zram->wb_limit_lock);
+	atomic_set(&zram->wb_inflight, 0);
+	init_waitqueue_head(&zram->wb_wait);
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	INIT_WORK(&zram->recomp_work, zram_recompress_work);
 #endif
 	queue = blk_alloc_queue(GFP_KERNEL);
 	if (!queue) {
@@ -1926,13 +2518,22 @@ static int zram_add(void)
 
 	blk_queue_make_request(queue, zram_make_request);
 
+	zram->wq = alloc_workqueue("zram%d_wq",
+			WQ_UNBOUND | WQ_HIGHPRI | WQ_MEM_RECLAIM, 0, device_id);
+	if (!zram->wq) {
+		pr_err("Error allocating workqueue for device %d\n",
+			device_id);
+		ret = -ENOMEM;
+		goto out_free_queue;
+	}
+
 	/* gendisk structure */
 	zram->disk = alloc_disk(1);
 	if (!zram->disk) {
 		pr_err("Error allocating disk structure for device %d\n",
 			device_id);
 		ret = -ENOMEM;
-		goto out_free_queue;
+		goto out_free_wq;
 	}
 
 	zram->disk->major = zram_major;
@@ -1986,6 +2587,8 @@ static int zram_add(void)
 	pr_info("Added device: %s\n", zram->disk->disk_name);
 	return device_id;
 
+out_free_wq:
+	destroy_workqueue(zram->wq);
 out_free_queue:
 	blk_cleanup_queue(queue);
 out_free_idr:
@@ -2025,6 +2628,7 @@ static int zram_remove(struct zram *zram)
 	del_gendisk(zram->disk);
 	blk_cleanup_queue(zram->disk->queue);
 	put_disk(zram->disk);
+	destroy_workqueue(zram->wq);
 	kfree(zram);
 	return 0;
 }
@@ -2103,6 +2707,7 @@ static void destroy_devices(void)
 {
 	class_unregister(&zram_control_class);
 	idr_for_each(&zram_index_idr, &zram_remove_cb, NULL);
+	zram_bench_exit();
 	zram_debugfs_destroy();
 	idr_destroy(&zram_index_idr);
 	unregister_blkdev(zram_major, "zram");
@@ -2119,9 +2724,11 @@ static int __init zram_init(void)
 	}
 
 	zram_debugfs_create();
+	zram_bench_init();
 	zram_major = register_blkdev(0, "zram");
 	if (zram_major <= 0) {
 		pr_err("Unable to get major number\n");
+		zram_bench_exit();
 		class_unregister(&zram_control_class);
 		return -EBUSY;
 	}
@@ -51,6 +51,7 @@ static unsigned int exynos_nqmax_r;
 static unsigned int *exynos_qmax_w;
 static unsigned int exynos_nqmax_w;
 static unsigned int exynos_mif_freq = INITIAL_MIF_FREQ;
+static unsigned int exynos_mif_bw_freq;
 
 #if defined(CONFIG_EXYNOS_ITMON)
 struct bts_itmon {
@@ -1685,6 +1686,11 @@ unsigned int bts_calc_bw(enum bts_bw_type type, void *data)
 	return bw;
 }
 
+unsigned long bts_get_mif_bw_freq(void)
+{
+	return READ_ONCE(exynos_mif_bw_freq);
+}
+
 void bts_update_bw(enum bts_bw_type type, struct bts_bw bw)
 {
 	static struct bts_bw ip_bw[BTS_BW_MAX];
@@ -1721,6 +1727,7 @@ void bts_update_bw(enum bts_bw_type type, struct bts_bw bw)
 	mif_freq = total_bw * 100 / BUS_WIDTH / exynos_mif_util;
 	int_freq = int_bw * 100 / BUS_WIDTH / exynos_int_util;
 
+	WRITE_ONCE(exynos_mif_bw_freq, mif_freq);
 	pm_qos_update_request(&exynos_mif_bts_qos, mif_freq);
 	pm_qos_update_request(&exynos_int_bts_qos, int_freq);
 
@@ -20,10 +20,12 @@
 #include <linux/exynos-ss.h>
 #include <linux/cpu_cooling.h>
 #include <linux/suspend.h>
+#include <linux/sched_energy.h>
 
 #include <soc/samsung/cal-if.h>
 #include <soc/samsung/ect_parser.h>
 #include <soc/samsung/exynos-cpu_hotplug.h>
+#include <soc/samsung/exynos-dvfs-bench.h>
 
 #include "exynos-acme.h"
 
@@ -169,7 +171,8 @@ static int set_freq(struct exynos_cpufreq_domain *domain,
 	exynos_ss_printk("ID %d: %d -> %d (%d)\n",
 		domain->id, domain->old, target_freq, ESS_FLAG_IN);
 
-	err = cal_dfs_set_rate(domain->cal_id, target_freq);
+	/* queued if exynos-dm has a DVFS batch open, see scaling_callback() */
+	err = cal_dfs_set_rate_batched(domain->cal_id, target_freq);
 	if (err < 0)
 		pr_err("failed to scale frequency of domain%d (%d -> %d)\n",
 			domain->id, domain->old, target_freq);
@@ -227,6 +230,7 @@ static int scale(struct exynos_cpufreq_domain *domain,
 		.new		= target_freq,
 		.flags		= 0,
 	};
+	u64 bench_start = exynos_dvfs_bench_clock();
 
 	cpufreq_freq_transition_begin(policy, &freqs);
 	exynos_ss_freq(domain->id, domain->old, target_freq, ESS_FLAG_IN);
@@ -253,6 +257,9 @@ static int scale(struct exynos_cpufreq_domain *domain,
 					ret < 0 ? ret : ESS_FLAG_OUT);
 	cpufreq_freq_transition_end(policy, &freqs, ret);
 
+	exynos_dvfs_bench_record(DVFS_BENCH_CPU_SCALE, bench_start,
+				 exynos_dvfs_bench_clock());
+
 	return ret;
 }
 
@@ -855,6 +862,23 @@ static __init int init_table(struct exynos_cpufreq_domain *domain)
 	domain->freq_table[index].driver_data = index;
 	domain->freq_table[index].frequency = CPUFREQ_TABLE_END;
 
+	/*
+	 * Rebuild the energy model of this domain from the voltages of the
+	 * running chip. Only OPPs usable by cpufreq take part, so that the
+	 * top OPP matches the top capacity state from DT.
+	 */
+	if (IS_ENABLED(CONFIG_SCHED_ENERGY_CALIBRATION)) {
+		for (index = 0; index < domain->table_size; index++)
+			if (domain->freq_table[index].frequency ==
+						CPUFREQ_ENTRY_INVALID)
+				table[index] = 0;
+
+		if (sched_energy_calibrate(&domain->cpus, table, volt_table,
+					   domain->table_size))
+			pr_warn("failed to calibrate energy model of domain%d\n",
+								domain->id);
+	}
+
 	kfree(volt_table);
 
 free_table:
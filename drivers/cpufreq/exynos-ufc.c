@@ -17,6 +17,7 @@
 #include <linux/cpumask.h>
 #include <linux/cpufreq.h>
 #include <linux/pm_opp.h>
+#include <linux/mutex.h>
 #include <linux/ehmp.h>
 
 #include <soc/samsung/exynos-cpu_hotplug.h>
@@ -32,6 +33,7 @@
  */
 #define SCALE_SIZE	2
 
+static int last_min_limit = -1;
 static int last_max_limit = -1;
 static int sse_mode;
 
@@ -118,13 +120,11 @@ static inline void control_boost(bool enable)
 	}
 }
 
-static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
-				struct kobj_attribute *attr, const char *buf,
-				size_t count)
+static void cpufreq_min_limit_update(int input)
 {
 	struct list_head *domains = get_domain_list();
 	struct exynos_cpufreq_domain *domain;
-	int input, scale = -1;
+	int scale = -1;
 	unsigned int freq;
 	unsigned int req_limit_freq;
 	bool set_max = false;
@@ -132,14 +132,6 @@ static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
 	int index = 0;
 	struct cpumask mask;
 
-	if (!sscanf(buf, "%8d", &input))
-		return -EINVAL;
-
-	if (!domains) {
-		pr_err("failed to get domains!\n");
-		return -ENXIO;
-	}
-
 	list_for_each_entry_reverse(domain, domains, list) {
 		struct exynos_ufc *ufc, *r_ufc = NULL, *r_ufc_32 = NULL;
 		struct cpufreq_policy *policy = NULL;
@@ -221,6 +213,24 @@ static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
 
 		set_max = true;
 	}
+}
+
+static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
+				struct kobj_attribute *attr, const char *buf,
+				size_t count)
+{
+	int input;
+
+	if (!sscanf(buf, "%8d", &input))
+		return -EINVAL;
+
+	if (!get_domain_list()) {
+		pr_err("failed to get domains!\n");
+		return -ENXIO;
+	}
+
+	last_min_limit = input;
+	cpufreq_min_limit_update(input);
 
 	return count;
 }
@@ -532,6 +542,155 @@ static ssize_t store_execution_mode_change(struct kobject *kobj, struct kobj_att
 	return count;
 }
 
+/*********************************************************************
+ *                         EXECUTION PROFILES                        *
+ *********************************************************************/
+/*
+ * A profile bundles the knobs userspace used to write one by one on each
+ * foreground app change. Profiles are preloaded through ufc_profiles and
+ * applied with a single write of their id to ufc_profile. Only the knobs
+ * that differ from the current state are touched.
+ */
+#define UFC_MAX_PROFILES	16
+
+struct ufc_profile {
+	bool valid;
+	int min_limit;		/* as written to cpufreq_min_limit */
+	int max_limit;		/* as written to cpufreq_max_limit */
+	int exe_mode;		/* as written to execution_mode_change */
+	int boost;		/* EHMP global boost */
+	int mif_min;		/* MIF minimum frequency in kHz */
+};
+
+static struct ufc_profile ufc_profiles[UFC_MAX_PROFILES];
+static int ufc_profile_id = -1;
+static int ufc_boost;
+static int ufc_mif_min;
+static DEFINE_MUTEX(ufc_profile_lock);
+
+static struct pm_qos_request ufc_mif_qos_req;
+static struct gb_qos_request ufc_gb_req = {
+	.name = "ufc_profile",
+};
+
+static void ufc_apply_profile(const struct ufc_profile *p)
+{
+	bool mode_changed = sse_mode != !!p->exe_mode;
+	bool raise = p->max_limit < 0 ||
+		(last_max_limit >= 0 && p->max_limit > last_max_limit);
+
+	sse_mode = !!p->exe_mode;
+
+	/* Order min/max so that the limits never cross on the way */
+	if (!raise && p->min_limit != last_min_limit) {
+		last_min_limit = p->min_limit;
+		cpufreq_min_limit_update(p->min_limit);
+	}
+
+	if (p->max_limit != last_max_limit || mode_changed) {
+		last_max_limit = p->max_limit;
+		cpufreq_max_limit_update(p->max_limit);
+	}
+
+	if (raise && p->min_limit != last_min_limit) {
+		last_min_limit = p->min_limit;
+		cpufreq_min_limit_update(p->min_limit);
+	}
+
+	if (p->boost != ufc_boost) {
+		ufc_boost = p->boost;
+		gb_qos_update_request(&ufc_gb_req, ufc_boost);
+	}
+
+	if (p->mif_min != ufc_mif_min) {
+		ufc_mif_min = p->mif_min;
+		pm_qos_update_request(&ufc_mif_qos_req, ufc_mif_min);
+	}
+}
+
+static ssize_t show_ufc_profiles(struct kobject *kobj,
+				struct kobj_attribute *attr, char *buf)
+{
+	struct ufc_profile *p;
+	ssize_t count = 0;
+	int id;
+
+	mutex_lock(&ufc_profile_lock);
+	for (id = 0; id < UFC_MAX_PROFILES; id++) {
+		p = &ufc_profiles[id];
+		if (!p->valid)
+			continue;
+
+		count += snprintf(buf + count, PAGE_SIZE - count,
+				"%d %d %d %d %d %d\n", id, p->min_limit,
+				p->max_limit, p->exe_mode, p->boost, p->mif_min);
+	}
+	mutex_unlock(&ufc_profile_lock);
+
+	return count;
+}
+
+/* "<id> <min_limit> <max_limit> <exe_mode> <boost> <mif_min>" */
+static ssize_t store_ufc_profiles(struct kobject *kobj,
+				struct kobj_attribute *attr, const char *buf,
+				size_t count)
+{
+	struct ufc_profile p = { .valid = true, };
+	int id;
+
+	if (sscanf(buf, "%d %d %d %d %d %d", &id, &p.min_limit, &p.max_limit,
+			&p.exe_mode, &p.boost, &p.mif_min) != 6)
+		return -EINVAL;
+
+	if (id < 0 || id >= UFC_MAX_PROFILES ||
+	    p.boost < 0 || p.boost > 100 || p.mif_min < 0)
+		return -EINVAL;
+
+	mutex_lock(&ufc_profile_lock);
+	ufc_profiles[id] = p;
+	if (ufc_profile_id == id)
+		ufc_apply_profile(&p);
+	mutex_unlock(&ufc_profile_lock);
+
+	return count;
+}
+
+static ssize_t show_ufc_profile(struct kobject *kobj,
+				struct kobj_attribute *attr, char *buf)
+{
+	return snprintf(buf, 10, "%d\n", ufc_profile_id);
+}
+
+static ssize_t store_ufc_profile(struct kobject *kobj,
+				struct kobj_attribute *attr, const char *buf,
+				size_t count)
+{
+	static const struct ufc_profile none = {
+		.min_limit = -1,
+		.max_limit = -1,
+	};
+	int id;
+
+	if (!sscanf(buf, "%8d", &id))
+		return -EINVAL;
+
+	if (id >= UFC_MAX_PROFILES)
+		return -EINVAL;
+
+	mutex_lock(&ufc_profile_lock);
+	if (id >= 0 && !ufc_profiles[id].valid) {
+		mutex_unlock(&ufc_profile_lock);
+		return -ENOENT;
+	}
+
+	/* A negative id drops every constraint set by profiles */
+	ufc_apply_profile(id < 0 ? &none : &ufc_profiles[id]);
+	ufc_profile_id = id < 0 ? -1 : id;
+	mutex_unlock(&ufc_profile_lock);
+
+	return count;
+}
+
 static struct kobj_attribute cpufreq_table =
 __ATTR(cpufreq_table, 0444 , show_cpufreq_table, NULL);
 static struct kobj_attribute cpufreq_min_limit =
@@ -546,6 +705,10 @@ __ATTR(cpufreq_max_limit, 0644,
 static struct kobj_attribute execution_mode_change =
 __ATTR(execution_mode_change, 0644,
 		show_execution_mode_change, store_execution_mode_change);
+static struct kobj_attribute ufc_profiles_attr =
+__ATTR(ufc_profiles, 0644, show_ufc_profiles, store_ufc_profiles);
+static struct kobj_attribute ufc_profile_attr =
+__ATTR(ufc_profile, 0644, show_ufc_profile, store_ufc_profile);
 
 static __init void init_sysfs(void)
 {
@@ -564,6 +727,12 @@ static __init void init_sysfs(void)
 	if (sysfs_create_file(power_kobj, &execution_mode_change.attr))
 		pr_err("failed to create cpufreq_max_limit node\n");
 
+	if (sysfs_create_file(power_kobj, &ufc_profiles_attr.attr))
+		pr_err("failed to create ufc_profiles node\n");
+
+	if (sysfs_create_file(power_kobj, &ufc_profile_attr.attr))
+		pr_err("failed to create ufc_profile node\n");
+
 }
 
 static int parse_ufc_ctrl_info(struct exynos_cpufreq_domain *domain,
@@ -695,6 +864,7 @@ static int __init exynos_ufc_init(void)
 
 	pm_qos_add_request(&cpu_online_max_qos_req, PM_QOS_CPU_ONLINE_MAX,
 					PM_QOS_CPU_ONLINE_MAX_DEFAULT_VALUE);
+	pm_qos_add_request(&ufc_mif_qos_req, PM_QOS_BUS_THROUGHPUT, 0);
 
 	while((dn = of_find_node_by_type(dn, "cpufreq-userctrl"))) {
 		struct cpumask shared_mask;
@@ -0,0 +1,267 @@
+/*
+ * exynos.c - idle governor for Exynos cpus
+ *
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * The menu governor corrects the next timer event with a single factor per
+ * bucket, so a cpu woken by an irregular mix of timers, IPIs and device
+ * interrupts ends up either in shallow states for long idle periods or in
+ * C2 and cluster power down for short ones.
+ *
+ * This governor classifies every wakeup by its source and keeps a short
+ * history of idle durations per source. A source that woke the cpu often
+ * enough and at a regular interval bounds the predicted idle time, which
+ * is otherwise the next timer event. The prediction is also published to
+ * exynos-powermode, which decides cluster power down and SICD from the
+ * predicted idle time of every cpu instead of the local next timer only.
+ */
+
+#include <linux/kernel.h>
+#include <linux/cpuidle.h>
+#include <linux/pm_qos.h>
+#include <linux/ktime.h>
+#include <linux/tick.h>
+#include <linux/kernel_stat.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+
+#include <soc/samsung/exynos-powermode.h>
+
+#define EXYNOS_IDLE_INTERVALS	8
+#define EXYNOS_IDLE_MIN_SAMPLES	6
+
+/* wakeup share, scaled to 1024, above which a source bounds the prediction */
+#define EXYNOS_IDLE_HIT_SCALE	1024
+#define EXYNOS_IDLE_HIT_DECAY	3
+#define EXYNOS_IDLE_HIT_THRESH	(EXYNOS_IDLE_HIT_SCALE / 4)
+
+enum exynos_wake_src {
+	WAKE_TIMER,
+	WAKE_IPI,
+	WAKE_IRQ,
+	NR_WAKE_SRC,
+};
+
+struct exynos_idle_src {
+	unsigned int intervals[EXYNOS_IDLE_INTERVALS];
+	unsigned int nr_samples;
+	unsigned int ptr;
+	unsigned int hits;
+};
+
+struct exynos_idle_device {
+	struct exynos_idle_src src[NR_WAKE_SRC];
+
+	int last_state_idx;
+	bool needs_update;
+
+	unsigned int next_timer_us;
+	unsigned int predicted_us;
+	s64 predicted_end_ns;
+
+	u64 ipi_count;
+};
+
+static DEFINE_PER_CPU(struct exynos_idle_device, exynos_idle_devices);
+
+/*
+ * Average of the recorded intervals if they are regular enough, which is
+ * when the standard deviation is within a quarter of the average or below
+ * 20us. Otherwise, UINT_MAX.
+ */
+static unsigned int typical_interval(struct exynos_idle_src *src)
+{
+	u64 sum = 0, variance = 0;
+	unsigned int avg, i;
+	int n = min_t(unsigned int, src->nr_samples, EXYNOS_IDLE_INTERVALS);
+
+	if (n < EXYNOS_IDLE_MIN_SAMPLES)
+		return UINT_MAX;
+
+	for (i = 0; i < n; i++)
+		sum += src->intervals[i];
+	avg = div_u64(sum, n);
+
+	for (i = 0; i < n; i++) {
+		s64 diff = (s64)src->intervals[i] - avg;
+
+		variance += diff * diff;
+	}
+	variance = div_u64(variance, n);
+
+	if ((u64)avg * avg > variance * 16 || variance <= 400)
+		return avg;
+
+	return UINT_MAX;
+}
+
+static enum exynos_wake_src classify_wakeup(struct exynos_idle_device *data,
+					    unsigned int cpu,
+					    unsigned int measured_us)
+{
+	u64 ipi_count = arch_irq_stat_cpu(cpu);
+
+	/* the timer we armed for fired, give or take the wakeup slack */
+	if (measured_us + data->next_timer_us / 32 + 20 >= data->next_timer_us)
+		return WAKE_TIMER;
+
+	if (ipi_count != data->ipi_count)
+		return WAKE_IPI;
+
+	return WAKE_IRQ;
+}
+
+static void exynos_idle_update(struct cpuidle_driver *drv,
+			       struct cpuidle_device *dev)
+{
+	struct exynos_idle_device *data = this_cpu_ptr(&exynos_idle_devices);
+	struct cpuidle_state *target = &drv->states[data->last_state_idx];
+	struct exynos_idle_src *src;
+	enum exynos_wake_src type;
+	unsigned int measured_us;
+	int i;
+
+	measured_us = cpuidle_get_last_residency(dev);
+
+	/* Deduct exit latency, as the menu governor does */
+	if (measured_us > 2 * target->exit_latency)
+		measured_us -= target->exit_latency;
+	else
+		measured_us /= 2;
+
+	if (measured_us > data->next_timer_us)
+		measured_us = data->next_timer_us;
+
+	type = classify_wakeup(data, dev->cpu, measured_us);
+
+	for (i = 0; i < NR_WAKE_SRC; i++) {
+		src = &data->src[i];
+		src->hits -= src->hits >> EXYNOS_IDLE_HIT_DECAY;
+		if (i == type)
+			src->hits += EXYNOS_IDLE_HIT_SCALE >> EXYNOS_IDLE_HIT_DECAY;
+	}
+
+	src = &data->src[type];
+	src->intervals[src->ptr++] = measured_us;
+	if (src->ptr >= EXYNOS_IDLE_INTERVALS)
+		src->ptr = 0;
+	src->nr_samples++;
+}
+
+static int exynos_idle_select(struct cpuidle_driver *drv,
+			      struct cpuidle_device *dev)
+{
+	struct exynos_idle_device *data = this_cpu_ptr(&exynos_idle_devices);
+	int latency_req = pm_qos_request(PM_QOS_CPU_DMA_LATENCY);
+	unsigned int predicted_us;
+	int i;
+
+	if (data->needs_update) {
+		exynos_idle_update(drv, dev);
+		data->needs_update = false;
+	}
+
+	data->last_state_idx = 0;
+
+	/* Special case when user has set very strict latency requirement */
+	if (unlikely(latency_req == 0))
+		return 0;
+
+	data->next_timer_us = ktime_to_us(tick_nohz_get_sleep_length());
+	predicted_us = data->next_timer_us;
+
+	/* Non-timer sources that keep waking this cpu regularly */
+	for (i = WAKE_IPI; i < NR_WAKE_SRC; i++) {
+		struct exynos_idle_src *src = &data->src[i];
+
+		if (src->hits < EXYNOS_IDLE_HIT_THRESH)
+			continue;
+
+		predicted_us = min(predicted_us, typical_interval(src));
+	}
+
+	data->predicted_us = predicted_us;
+	data->ipi_count = arch_irq_stat_cpu(dev->cpu);
+	WRITE_ONCE(data->predicted_end_ns,
+		   ktime_to_ns(ktime_add_us(ktime_get(), predicted_us)));
+
+	for (i = 1; i < drv->state_count; i++) {
+		struct cpuidle_state *s = &drv->states[i];
+		struct cpuidle_state_usage *su = &dev->states_usage[i];
+
+		if (s->disabled || su->disable)
+			continue;
+		if (s->target_residency > predicted_us)
+			continue;
+		if (s->exit_latency > latency_req)
+			continue;
+
+		data->last_state_idx = i;
+	}
+
+	return data->last_state_idx;
+}
+
+static void exynos_idle_reflect(struct cpuidle_device *dev, int index)
+{
+	struct exynos_idle_device *data = this_cpu_ptr(&exynos_idle_devices);
+
+	WRITE_ONCE(data->predicted_end_ns, 0);
+	data->last_state_idx = index;
+	data->needs_update = true;
+}
+
+/**
+ * exynos_idle_predicted_us - remaining predicted idle time of an idle cpu
+ * @cpu: the cpu
+ *
+ * Returns -1 if the cpu is not idle under this governor.
+ */
+s64 exynos_idle_predicted_us(unsigned int cpu)
+{
+	struct exynos_idle_device *data = &per_cpu(exynos_idle_devices, cpu);
+	s64 end = READ_ONCE(data->predicted_end_ns);
+	s64 now;
+
+	if (!end)
+		return -1;
+
+	now = ktime_to_ns(ktime_get());
+	if (end <= now)
+		return 0;
+
+	return div_s64(end - now, NSEC_PER_USEC);
+}
+
+static int exynos_idle_enable_device(struct cpuidle_driver *drv,
+				     struct cpuidle_device *dev)
+{
+	struct exynos_idle_device *data = &per_cpu(exynos_idle_devices, dev->cpu);
+
+	memset(data, 0, sizeof(struct exynos_idle_device));
+
+	/* Until proven otherwise, the timer is what wakes us up */
+	data->src[WAKE_TIMER].hits = EXYNOS_IDLE_HIT_SCALE;
+
+	return 0;
+}
+
+static struct cpuidle_governor exynos_idle_governor = {
+	.name =		"exynos",
+	.rating =	25,
+	.enable =	exynos_idle_enable_device,
+	.select =	exynos_idle_select,
+	.reflect =	exynos_idle_reflect,
+	.owner =	THIS_MODULE,
+};
+
+static int __init init_exynos_idle_governor(void)
+{
+	return cpuidle_register_governor(&exynos_idle_governor);
+}
+postcore_initcall(init_exynos_idle_governor);
@@ -144,7 +144,8 @@
 #define FLAGS_AES_CTR                   _SBF(1, 0x02)
 
 #define AES_KEY_LEN         16
-#define CRYPTO_QUEUE_LEN    1
+/* large requests queue up and are fed to the SSS back to back */
+#define CRYPTO_QUEUE_LEN    16
 
 /**
  * struct samsung_aes_variant - platform specific SSS driver data
@@ -160,10 +161,12 @@ struct samsung_aes_variant {
 
 struct s5p_aes_reqctx {
 	unsigned long			mode;
+	struct ablkcipher_request	fallback_req;	/* keep at the end */
 };
 
 struct s5p_aes_ctx {
 	struct s5p_aes_dev		*dev;
+	struct crypto_ablkcipher	*fallback;
 
 	uint8_t				aes_key[AES_MAX_KEY_SIZE];
 	uint8_t				nonce[CTR_RFC3686_NONCE_SIZE];
@@ -196,6 +199,14 @@ struct s5p_aes_dev {
 
 static struct s5p_aes_dev *s5p_dev;
 
+/*
+ * Requests smaller than this are done on the cpu: for them setting up the
+ * DMA and waiting for the interrupt costs more than the cipher itself.
+ */
+static unsigned int hw_threshold = 4096;
+module_param(hw_threshold, uint, 0644);
+MODULE_PARM_DESC(hw_threshold, "Smallest request in bytes sent to the SSS");
+
 static const struct samsung_aes_variant s5p_aes_data = {
 	.aes_offset	= 0x4000,
 };
@@ -657,6 +668,26 @@ static int s5p_aes_handle_req(struct s5p_aes_dev *dev,
 	return err;
 }
 
+static int s5p_aes_crypt_fallback(struct ablkcipher_request *req,
+				  unsigned long mode)
+{
+	struct crypto_ablkcipher *tfm = crypto_ablkcipher_reqtfm(req);
+	struct s5p_aes_reqctx *reqctx = ablkcipher_request_ctx(req);
+	struct s5p_aes_ctx *ctx = crypto_ablkcipher_ctx(tfm);
+	struct ablkcipher_request *subreq = &reqctx->fallback_req;
+
+	/* the fallback is synchronous, no completion to forward */
+	ablkcipher_request_set_tfm(subreq, ctx->fallback);
+	ablkcipher_request_set_callback(subreq, req->base.flags, NULL, NULL);
+	ablkcipher_request_set_crypt(subreq, req->src, req->dst, req->nbytes,
+				     req->info);
+
+	if (mode & FLAGS_AES_DECRYPT)
+		return crypto_ablkcipher_decrypt(subreq);
+
+	return crypto_ablkcipher_encrypt(subreq);
+}
+
 static int s5p_aes_crypt(struct ablkcipher_request *req, unsigned long mode)
 {
 	struct crypto_ablkcipher *tfm = crypto_ablkcipher_reqtfm(req);
@@ -671,6 +702,9 @@ static int s5p_aes_crypt(struct ablkcipher_request *req, unsigned long mode)
 
 	reqctx->mode = mode;
 
+	if (ctx->fallback && req->nbytes < READ_ONCE(hw_threshold))
+		return s5p_aes_crypt_fallback(req, mode);
+
 	return s5p_aes_handle_req(dev, req);
 }
 
@@ -688,6 +722,17 @@ static int s5p_aes_setkey(struct crypto_ablkcipher *cipher,
 	memcpy(ctx->aes_key, key, keylen);
 	ctx->keylen = keylen;
 
+	if (ctx->fallback) {
+		int err;
+
+		crypto_ablkcipher_clear_flags(ctx->fallback, CRYPTO_TFM_REQ_MASK);
+		crypto_ablkcipher_set_flags(ctx->fallback,
+			crypto_ablkcipher_get_flags(cipher) & CRYPTO_TFM_REQ_MASK);
+		err = crypto_ablkcipher_setkey(ctx->fallback, key, keylen);
+		if (err)
+			return err;
+	}
+
 	return 0;
 }
 
@@ -714,13 +759,32 @@ static int s5p_aes_cbc_decrypt(struct ablkcipher_request *req)
 static int s5p_aes_cra_init(struct crypto_tfm *tfm)
 {
 	struct s5p_aes_ctx *ctx = crypto_tfm_ctx(tfm);
+	struct crypto_ablkcipher *fallback;
 
 	ctx->dev = s5p_dev;
 	tfm->crt_ablkcipher.reqsize = sizeof(struct s5p_aes_reqctx);
 
+	/* without a cpu implementation everything goes to the SSS */
+	fallback = crypto_alloc_ablkcipher(crypto_tfm_alg_name(tfm), 0,
+					   CRYPTO_ALG_ASYNC |
+					   CRYPTO_ALG_NEED_FALLBACK);
+	if (IS_ERR(fallback))
+		return 0;
+
+	ctx->fallback = fallback;
+	tfm->crt_ablkcipher.reqsize += crypto_ablkcipher_reqsize(fallback);
+
 	return 0;
 }
 
+static void s5p_aes_cra_exit(struct crypto_tfm *tfm)
+{
+	struct s5p_aes_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	if (ctx->fallback)
+		crypto_free_ablkcipher(ctx->fallback);
+}
+
 static struct crypto_alg algs[] = {
 	{
 		.cra_name		= "ecb(aes)",
@@ -728,6 +792,7 @@ static struct crypto_alg algs[] = {
 		.cra_priority		= 100,
 		.cra_flags		= CRYPTO_ALG_TYPE_ABLKCIPHER |
 					  CRYPTO_ALG_ASYNC |
+					  CRYPTO_ALG_NEED_FALLBACK |
 					  CRYPTO_ALG_KERN_DRIVER_ONLY,
 		.cra_blocksize		= AES_BLOCK_SIZE,
 		.cra_ctxsize		= sizeof(struct s5p_aes_ctx),
@@ -735,6 +800,7 @@ static struct crypto_alg algs[] = {
 		.cra_type		= &crypto_ablkcipher_type,
 		.cra_module		= THIS_MODULE,
 		.cra_init		= s5p_aes_cra_init,
+		.cra_exit		= s5p_aes_cra_exit,
 		.cra_u.ablkcipher = {
 			.min_keysize	= AES_MIN_KEY_SIZE,
 			.max_keysize	= AES_MAX_KEY_SIZE,
@@ -749,6 +815,7 @@ static struct crypto_alg algs[] = {
 		.cra_priority		= 100,
 		.cra_flags		= CRYPTO_ALG_TYPE_ABLKCIPHER |
 					  CRYPTO_ALG_ASYNC |
+					  CRYPTO_ALG_NEED_FALLBACK |
 					  CRYPTO_ALG_KERN_DRIVER_ONLY,
 		.cra_blocksize		= AES_BLOCK_SIZE,
 		.cra_ctxsize		= sizeof(struct s5p_aes_ctx),
@@ -756,6 +823,7 @@ static struct crypto_alg algs[] = {
 		.cra_type		= &crypto_ablkcipher_type,
 		.cra_module		= THIS_MODULE,
 		.cra_init		= s5p_aes_cra_init,
+		.cra_exit		= s5p_aes_cra_exit,
 		.cra_u.ablkcipher = {
 			.min_keysize	= AES_MIN_KEY_SIZE,
 			.max_keysize	= AES_MAX_KEY_SIZE,
@@ -32,6 +32,7 @@
 #include <soc/samsung/tmu.h>
 #include <soc/samsung/ect_parser.h>
 #include <soc/samsung/exynos-dm.h>
+#include <soc/samsung/exynos-dvfs-bench.h>
 #include "../../soc/samsung/acpm/acpm.h"
 #include "../../soc/samsung/acpm/acpm_ipc.h"
 
@@ -1637,6 +1638,7 @@ static int exynos_devfreq_target(struct device *dev, unsigned long *target_freq,
 	u32 target_volt;
 	s32 target_idx;
 	s32 target_time = 0, setfreq_time = 0;
+	u64 bench_ts;
 	int ret = 0;
 	enum volt_order_type volt_order;
 
@@ -1731,14 +1733,18 @@ static int exynos_devfreq_target(struct device *dev, unsigned long *target_freq,
 		}
 
 		if (data->ops.set_freq_prepare) {
+			bench_ts = exynos_dvfs_bench_clock();
 			ret = data->ops.set_freq_prepare(data);
 			if (ret) {
 				dev_err(dev, "failed set frequency prepare\n");
 				goto out;
 			}
+			exynos_dvfs_bench_record(DVFS_BENCH_DEVFREQ_PREPARE, bench_ts,
+						 exynos_dvfs_bench_clock());
 		}
 
 		do_gettimeofday(&before_setfreq);
+		bench_ts = exynos_dvfs_bench_clock();
 
 		if (switch_volt > data->old_volt) {
 			ret = exynos_devfreq_set_voltage(&switch_volt, data);
@@ -1801,16 +1807,21 @@ static int exynos_devfreq_target(struct device *dev, unsigned long *target_freq,
 		}
 
 		do_gettimeofday(&after_setfreq);
+		exynos_dvfs_bench_record(DVFS_BENCH_DEVFREQ_SET, bench_ts,
+					 exynos_dvfs_bench_clock());
 
 		setfreq_time = (after_setfreq.tv_sec - before_setfreq.tv_sec) * USEC_PER_SEC +
 		    (after_setfreq.tv_usec - before_setfreq.tv_usec);
 
 		if (data->ops.set_freq_post) {
+			bench_ts = exynos_dvfs_bench_clock();
 			ret = data->ops.set_freq_post(data);
 			if (ret) {
 				dev_err(dev, "failed set frequency post\n");
 				goto out;
 			}
+			exynos_dvfs_bench_record(DVFS_BENCH_DEVFREQ_POST, bench_ts,
+						 exynos_dvfs_bench_clock());
 		}
 	} else {
 		if (volt_order == PRE_SET_VOLT) {
@@ -1824,14 +1835,18 @@ static int exynos_devfreq_target(struct device *dev, unsigned long *target_freq,
 		}
 
 		if (data->ops.set_freq_prepare) {
+			bench_ts = exynos_dvfs_bench_clock();
 			ret = data->ops.set_freq_prepare(data);
 			if (ret) {
 				dev_err(dev, "failed set frequency prepare\n");
 				goto out;
 			}
+			exynos_dvfs_bench_record(DVFS_BENCH_DEVFREQ_PREPARE, bench_ts,
+						 exynos_dvfs_bench_clock());
 		}
 
 		do_gettimeofday(&before_setfreq);
+		bench_ts = exynos_dvfs_bench_clock();
 		if (data->ops.set_freq) {
 			ret = data->ops.set_freq(dev, data->new_freq, data->clk, data);
 			if (ret) {
@@ -1841,16 +1856,21 @@ static int exynos_devfreq_target(struct device *dev, unsigned long *target_freq,
 			}
 		}
 		do_gettimeofday(&after_setfreq);
+		exynos_dvfs_bench_record(DVFS_BENCH_DEVFREQ_SET, bench_ts,
+					 exynos_dvfs_bench_clock());
 
 		setfreq_time = (after_setfreq.tv_sec - before_setfreq.tv_sec) * USEC_PER_SEC +
 		    (after_setfreq.tv_usec - before_setfreq.tv_usec);
 
 		if (data->ops.set_freq_post) {
+			bench_ts = exynos_dvfs_bench_clock();
 			ret = data->ops.set_freq_post(data);
 			if (ret) {
 				dev_err(dev, "failed set frequency post\n");
 				goto out;
 			}
+			exynos_dvfs_bench_record(DVFS_BENCH_DEVFREQ_POST, bench_ts,
+						 exynos_dvfs_bench_clock());
 		}
 
 		if (volt_order == POST_SET_VOLT) {
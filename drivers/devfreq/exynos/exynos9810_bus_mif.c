@@ -396,6 +396,9 @@ static int __init exynos9810_devfreq_mif_init_prepare(struct exynos_devfreq_data
 	data->ops.cmu_dump = exynos9810_devfreq_mif_cmu_dump;
 	data->ops.set_freq_prepare = exynos9810_devfreq_mif_set_freq_prepare;
 	data->ops.set_freq_post = exynos9810_devfreq_mif_set_freq_post;
+#ifdef CONFIG_EXYNOS_WD_DVFS
+	data->simple_interactive_data.get_bw_freq = bts_get_mif_bw_freq;
+#endif
 
 	return 0;
 }
@@ -140,6 +140,27 @@ static unsigned long update_load(struct devfreq_dev_status *stat,
 
 	return freq;
 }
+
+/*
+ * Combine the bandwidth declared in advance with the measured load. The
+ * measured load covers declared and undeclared traffic alike, so the part
+ * above the declared frequency is tracked as an average and added on top
+ * of the current declaration. A new declaration then moves the frequency
+ * before the traffic shows up in the PPMU counters.
+ */
+static unsigned long predict_bw_freq(struct devfreq_simple_interactive_data *data,
+				     unsigned long load_freq)
+{
+	unsigned long bw_freq = data->get_bw_freq();
+	long residual = (long)load_freq - (long)bw_freq;
+
+	data->bw_residual += (residual - data->bw_residual) / 4;
+
+	if (!bw_freq)
+		return load_freq;
+
+	return max(load_freq, bw_freq + max(data->bw_residual, 0L));
+}
 #endif
 
 static int devfreq_simple_interactive_func(struct devfreq *df,
@@ -186,7 +207,11 @@ static int devfreq_simple_interactive_func(struct devfreq *df,
 		err = devfreq_update_stats(df);
 		if (err)
 			return err;
-		*freq = max(*freq, update_load(stat, data));
+		if (data->get_bw_freq)
+			*freq = max(*freq, predict_bw_freq(data,
+						update_load(stat, data)));
+		else
+			*freq = max(*freq, update_load(stat, data));
 	}
 #endif
 	if (!data->use_delay_time)
@@ -21,6 +21,7 @@
 #include <linux/poll.h>
 #include <linux/sched.h>
 #include <linux/slab.h>
+#include <linux/sort.h>
 #include <linux/uaccess.h>
 #include <linux/anon_inodes.h>
 #include <linux/sync_file.h>
@@ -149,22 +150,16 @@ static int sync_file_set_fence(struct sync_file *sync_file,
 	struct fence_array *array;
 
 	/*
-	 * The reference for the fences in the new sync_file and held
-	 * in add_fence() during the merge procedure, so for num_fences == 1
-	 * we already own a new reference to the fence. For num_fence > 1
-	 * we own the reference of the fence_array creation.
+	 * The references for the fences in the new sync_file are taken
+	 * by merge_fences(), so for num_fences > 1 we hand them over to
+	 * the fence_array.
 	 */
-	if (num_fences == 1) {
-		sync_file->fence = fences[0];
-		kfree(fences);
-	} else {
-		array = fence_array_create(num_fences, fences,
-					   fence_context_alloc(1), 1, false);
-		if (!array)
-			return -ENOMEM;
+	array = fence_array_create(num_fences, fences,
+				   fence_context_alloc(1), 1, false);
+	if (!array)
+		return -ENOMEM;
 
-		sync_file->fence = &array->base;
-	}
+	sync_file->fence = &array->base;
 
 	return 0;
 }
@@ -182,14 +177,130 @@ static struct fence **get_fences(struct sync_file *sync_file, int *num_fences)
 	return &sync_file->fence;
 }
 
-static void add_fence(struct fence **fences, int *i, struct fence *fence)
+/*
+ * Merges of up to this many fences are put together on the stack, so that
+ * only the array of the resulting fence_array gets allocated.
+ */
+#define SYNC_FILE_MERGE_STACK	16
+
+static int count_fences(struct fence *fence)
+{
+	struct fence_array *array;
+	int i, num_fences = 0;
+
+	if (!fence_is_array(fence))
+		return 1;
+
+	array = to_fence_array(fence);
+	for (i = 0; i < array->num_fences; i++) {
+		int n = count_fences(array->fences[i]);
+
+		if (num_fences > INT_MAX - n)
+			return -EOVERFLOW;
+		num_fences += n;
+	}
+
+	return num_fences;
+}
+
+/*
+ * Stores the unsignaled fences behind @fence from @fences[@i] on, looking
+ * through nested fence arrays, so that a merge always yields a flat array.
+ */
+static int gather_fences(struct fence **fences, int i, struct fence *fence)
+{
+	if (fence_is_array(fence)) {
+		struct fence_array *array = to_fence_array(fence);
+		int j;
+
+		for (j = 0; j < array->num_fences; j++)
+			i = gather_fences(fences, i, array->fences[j]);
+	} else if (!fence_is_signaled(fence)) {
+		fences[i++] = fence;
+	}
+
+	return i;
+}
+
+/* by context, and the latest fence of a context first */
+static int fence_cmp(const void *_a, const void *_b)
+{
+	struct fence *a = *(struct fence **)_a;
+	struct fence *b = *(struct fence **)_b;
+
+	if (a->context != b->context)
+		return a->context < b->context ? -1 : 1;
+
+	if (a->seqno == b->seqno)
+		return 0;
+
+	return fence_is_later(a, b) ? -1 : 1;
+}
+
+/*
+ * Sorts @fences and only keeps the latest fence of every context, as it
+ * signals after all the earlier ones of its timeline.
+ */
+static int dedup_fences(struct fence **fences, int num_fences)
+{
+	int i, j;
+
+	if (num_fences < 2)
+		return num_fences;
+
+	sort(fences, num_fences, sizeof(*fences), fence_cmp, NULL);
+
+	for (i = 1, j = 0; i < num_fences; i++) {
+		if (fences[i]->context != fences[j]->context)
+			fences[++j] = fences[i];
+	}
+
+	return j + 1;
+}
+
+/*
+ * Merges the sorted and deduplicated @a and @b into @out, taking a reference
+ * on every fence stored, or only counts them when @out is NULL. @from_a and
+ * @from_b tell whether any of the fences kept come from @a and @b.
+ */
+static int merge_fences(struct fence **out, struct fence **a, int a_num_fences,
+			struct fence **b, int b_num_fences,
+			bool *from_a, bool *from_b)
 {
-	fences[*i] = fence;
+	int i, i_a, i_b;
+
+	*from_a = *from_b = false;
+
+	for (i = i_a = i_b = 0; i_a < a_num_fences || i_b < b_num_fences; i++) {
+		struct fence *pt;
+
+		if (i_b == b_num_fences ||
+		    (i_a < a_num_fences &&
+		     a[i_a]->context < b[i_b]->context)) {
+			pt = a[i_a++];
+			*from_a = true;
+		} else if (i_a == a_num_fences ||
+			   a[i_a]->context > b[i_b]->context) {
+			pt = b[i_b++];
+			*from_b = true;
+		} else {
+			if (fence_is_later(b[i_b], a[i_a])) {
+				pt = b[i_b];
+				*from_b = true;
+			} else {
+				pt = a[i_a];
+				*from_a = true;
+			}
 
-	if (!fence_is_signaled(fence)) {
-		fence_get(fence);
-		(*i)++;
+			i_a++;
+			i_b++;
+		}
+
+		if (out)
+			out[i] = fence_get(pt);
 	}
+
+	return i;
 }
 
 /**
@@ -201,81 +312,73 @@ static void add_fence(struct fence **fences, int *i, struct fence *fence)
  * Creates a new sync_file which contains copies of all the fences in both
  * @a and @b.  @a and @b remain valid, independent sync_file. Returns the
  * new merged sync_file or NULL in case of error.
+ *
+ * Signaled fences are dropped and only the latest fence of every context is
+ * kept. When what is left is covered by @a or @b alone, the new sync_file
+ * shares its fence instead of allocating another fence_array.
  */
 static struct sync_file *sync_file_merge(const char *name, struct sync_file *a,
 					 struct sync_file *b)
 {
+	struct fence *stack[SYNC_FILE_MERGE_STACK];
+	struct fence **scratch = stack, **b_fences, **fences;
+	int num_fences, a_num_fences, b_num_fences;
 	struct sync_file *sync_file;
-	struct fence **fences, **nfences, **a_fences, **b_fences;
-	int i, i_a, i_b, num_fences, a_num_fences, b_num_fences;
+	bool from_a, from_b;
 
 	sync_file = sync_file_alloc();
 	if (!sync_file)
 		return NULL;
 
-	a_fences = get_fences(a, &a_num_fences);
-	b_fences = get_fences(b, &b_num_fences);
-	if (a_num_fences > INT_MAX - b_num_fences)
+	a_num_fences = count_fences(a->fence);
+	b_num_fences = count_fences(b->fence);
+	if (a_num_fences < 0 || b_num_fences < 0 ||
+	    a_num_fences > INT_MAX - b_num_fences)
 		goto err;
 
 	num_fences = a_num_fences + b_num_fences;
-
-	fences = kcalloc(num_fences, sizeof(*fences), GFP_KERNEL);
-	if (!fences)
-		goto err;
-
-	/*
-	 * Assume sync_file a and b are both ordered and have no
-	 * duplicates with the same context.
-	 *
-	 * If a sync_file can only be created with sync_file_merge
-	 * and sync_file_create, this is a reasonable assumption.
-	 */
-	for (i = i_a = i_b = 0; i_a < a_num_fences && i_b < b_num_fences; ) {
-		struct fence *pt_a = a_fences[i_a];
-		struct fence *pt_b = b_fences[i_b];
-
-		if (pt_a->context < pt_b->context) {
-			add_fence(fences, &i, pt_a);
-
-			i_a++;
-		} else if (pt_a->context > pt_b->context) {
-			add_fence(fences, &i, pt_b);
-
-			i_b++;
-		} else {
-			if (pt_a->seqno - pt_b->seqno <= INT_MAX)
-				add_fence(fences, &i, pt_a);
-			else
-				add_fence(fences, &i, pt_b);
-
-			i_a++;
-			i_b++;
-		}
+	if (num_fences > ARRAY_SIZE(stack)) {
+		scratch = kmalloc_array(num_fences, sizeof(*scratch),
+					GFP_KERNEL);
+		if (!scratch)
+			goto err;
 	}
 
-	for (; i_a < a_num_fences; i_a++)
-		add_fence(fences, &i, a_fences[i_a]);
-
-	for (; i_b < b_num_fences; i_b++)
-		add_fence(fences, &i, b_fences[i_b]);
+	a_num_fences = gather_fences(scratch, 0, a->fence);
+	b_fences = scratch + a_num_fences;
+	b_num_fences = gather_fences(scratch, a_num_fences, b->fence) -
+		       a_num_fences;
+	a_num_fences = dedup_fences(scratch, a_num_fences);
+	b_num_fences = dedup_fences(b_fences, b_num_fences);
 
-	if (i == 0)
-		fences[i++] = fence_get(a_fences[0]);
-
-	if (num_fences > i) {
-		nfences = krealloc(fences, i * sizeof(*fences),
-				  GFP_KERNEL);
-		if (!nfences)
-			goto err;
-
-		fences = nfences;
+	num_fences = merge_fences(NULL, scratch, a_num_fences,
+				  b_fences, b_num_fences, &from_a, &from_b);
+	if (num_fences == 1) {
+		merge_fences(&sync_file->fence, scratch, a_num_fences,
+			     b_fences, b_num_fences, &from_a, &from_b);
+	} else if (!from_b) {
+		/* nothing left to wait for in b, or all of it signaled */
+		sync_file->fence = fence_get(a->fence);
+	} else if (!from_a) {
+		sync_file->fence = fence_get(b->fence);
+	} else {
+		fences = kmalloc_array(num_fences, sizeof(*fences),
+				       GFP_KERNEL);
+		if (!fences)
+			goto err_scratch;
+
+		merge_fences(fences, scratch, a_num_fences,
+			     b_fences, b_num_fences, &from_a, &from_b);
+		if (sync_file_set_fence(sync_file, fences, num_fences) < 0) {
+			while (num_fences--)
+				fence_put(fences[num_fences]);
+			kfree(fences);
+			goto err_scratch;
+		}
 	}
 
-	if (sync_file_set_fence(sync_file, fences, i) < 0) {
-		kfree(fences);
-		goto err;
-	}
+	if (scratch != stack)
+		kfree(scratch);
 
 	fence_add_callback(sync_file->fence, &sync_file->cb,
 			   fence_check_cb_func);
@@ -284,10 +387,12 @@ static struct sync_file *sync_file_merge(const char *name, struct sync_file *a,
 	sync_file_debug_add(sync_file);
 	return sync_file;
 
+err_scratch:
+	if (scratch != stack)
+		kfree(scratch);
 err:
 	fput(sync_file->file);
 	return NULL;
-
 }
 
 static void sync_file_free(struct kref *kref)
@@ -175,6 +175,12 @@ kbase_create_context(struct kbase_device *kbdev, bool is_compat,
 	spin_unlock_irqrestore(&kctx->kbdev->hwaccess_lock, irq_flags);
 	mutex_unlock(&js_kctx_info->ctx.jsctx_mutex);
 
+	mutex_lock(&kbdev->kctx_list_lock);
+	spin_lock_irqsave(&kbdev->hwaccess_lock, irq_flags);
+	kbase_js_update_ctx_foreground(kctx);
+	spin_unlock_irqrestore(&kbdev->hwaccess_lock, irq_flags);
+	mutex_unlock(&kbdev->kctx_list_lock);
+
 	/* MALI_SEC_INTEGRATION */
 	if (kbdev->vendor_callbacks->create_context)
 		kbdev->vendor_callbacks->create_context(kctx);
@@ -104,6 +104,7 @@
 #include <mali_kbase_timeline.h>
 
 #include <mali_kbase_as_fault_debugfs.h>
+#include <mali_kbase_hwcnt_sampler.h>
 /* MALI_SEC_INTEGRATION */
 #include <backend/gpu/mali_kbase_pm_internal.h>
 
@@ -3118,6 +3119,122 @@ static DEVICE_ATTR(js_ctx_scheduling_mode, S_IRUGO | S_IWUSR,
 		show_js_ctx_scheduling_mode,
 		set_js_ctx_scheduling_mode);
 
+/**
+ * show_js_foreground - Show callback for js_foreground sysfs entry.
+ * @dev:  The device this sysfs file is for.
+ * @attr: The attributes of the sysfs file.
+ * @buf:  The output buffer to receive the list of foreground processes.
+ *
+ * This function is called to get the processes whose contexts are currently
+ * scheduled as foreground contexts by JS.
+ *
+ * Return: The number of bytes output to @buf.
+ */
+static ssize_t show_js_foreground(struct device *dev,
+		struct device_attribute *attr, char * const buf)
+{
+	struct kbase_device *kbdev;
+	ssize_t ret = 0;
+	unsigned int i;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	mutex_lock(&kbdev->kctx_list_lock);
+	for (i = 0; i < kbdev->nr_js_foreground_tgids; i++)
+		ret += scnprintf(buf + ret, PAGE_SIZE - ret, "%d ",
+				kbdev->js_foreground_tgids[i]);
+	mutex_unlock(&kbdev->kctx_list_lock);
+
+	if (ret)
+		ret--;
+	ret += scnprintf(buf + ret, PAGE_SIZE - ret, "\n");
+
+	return ret;
+}
+
+/**
+ * set_js_foreground - Set callback for js_foreground sysfs entry.
+ * @dev:   The device this sysfs file is for.
+ * @attr:  The attributes of the sysfs file.
+ * @buf:   The value written to the sysfs file.
+ * @count: The number of bytes written to the sysfs file.
+ *
+ * This function is called when the js_foreground sysfs file is written to,
+ * typically by the compositor or the top-app cgroup manager. It replaces the
+ * list of foreground processes with the space separated tgids written, and
+ * updates the foreground state of all the contexts. An empty write clears
+ * the list.
+ *
+ * Return: @count if the function succeeded. An error code on failure.
+ */
+static ssize_t set_js_foreground(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	pid_t tgids[KBASE_JS_MAX_FOREGROUND_TGIDS];
+	struct kbase_context *kctx;
+	struct kbase_device *kbdev;
+	unsigned int nr_tgids = 0;
+	unsigned long flags;
+	char *str, *tok, *p;
+	int ret = 0;
+
+	kbdev = to_kbase_device(dev);
+	if (!kbdev)
+		return -ENODEV;
+
+	str = kstrndup(buf, count, GFP_KERNEL);
+	if (!str)
+		return -ENOMEM;
+
+	p = strim(str);
+	while ((tok = strsep(&p, " ")) != NULL) {
+		if (!*tok)
+			continue;
+
+		if (nr_tgids == KBASE_JS_MAX_FOREGROUND_TGIDS) {
+			ret = -E2BIG;
+			break;
+		}
+
+		ret = kstrtoint(tok, 0, &tgids[nr_tgids]);
+		if (ret || tgids[nr_tgids] <= 0) {
+			ret = -EINVAL;
+			break;
+		}
+		nr_tgids++;
+	}
+	kfree(str);
+
+	if (ret) {
+		dev_err(kbdev->dev, "Couldn't process js_foreground write operation.\n"
+				"Use format <tgid> [<tgid> ...], up to %d tgids\n",
+				KBASE_JS_MAX_FOREGROUND_TGIDS);
+		return ret;
+	}
+
+	mutex_lock(&kbdev->kctx_list_lock);
+	spin_lock_irqsave(&kbdev->hwaccess_lock, flags);
+
+	memcpy(kbdev->js_foreground_tgids, tgids, nr_tgids * sizeof(tgids[0]));
+	kbdev->nr_js_foreground_tgids = nr_tgids;
+
+	list_for_each_entry(kctx, &kbdev->kctx_list, kctx_list_link)
+		kbase_js_update_ctx_foreground(kctx);
+
+	spin_unlock_irqrestore(&kbdev->hwaccess_lock, flags);
+	mutex_unlock(&kbdev->kctx_list_lock);
+
+	/* Contexts may have moved to a higher priority list */
+	kbase_js_sched_all(kbdev);
+
+	return count;
+}
+
+static DEVICE_ATTR(js_foreground, S_IRUGO | S_IWUSR, show_js_foreground,
+		set_js_foreground);
+
 #ifdef MALI_KBASE_BUILD
 #ifdef CONFIG_DEBUG_FS
 
@@ -3804,6 +3921,7 @@ static int kbase_device_debugfs_init(struct kbase_device *kbdev)
 	kbase_debug_job_fault_debugfs_init(kbdev);
 	kbasep_gpu_memory_debugfs_init(kbdev);
 	kbase_as_fault_debugfs_init(kbdev);
+	kbase_hwcnt_sampler_debugfs_init(kbdev);
 	/* fops_* variables created by invocations of macro
 	 * MAKE_QUIRK_ACCESSORS() above. */
 	debugfs_create_file("quirks_sc", 0644,
@@ -3833,6 +3951,8 @@ static int kbase_device_debugfs_init(struct kbase_device *kbdev)
 			&kbdev->mem_pool_defaults.large,
 			&kbase_device_debugfs_mem_pool_max_size_fops);
 
+	kbase_mem_pool_zero_debugfs_init(kbdev->mali_debugfs_directory, kbdev);
+
 	if (kbase_hw_has_feature(kbdev, BASE_HW_FEATURE_PROTECTED_DEBUG_MODE)) {
 		debugfs_create_file("protected_debug_mode", S_IRUGO,
 				kbdev->mali_debugfs_directory, kbdev,
@@ -3967,6 +4087,7 @@ static struct attribute *kbase_attrs[] = {
 	&dev_attr_lp_mem_pool_size.attr,
 	&dev_attr_lp_mem_pool_max_size.attr,
 	&dev_attr_js_ctx_scheduling_mode.attr,
+	&dev_attr_js_foreground.attr,
 	NULL
 };
 
@@ -4031,6 +4152,8 @@ static int kbase_platform_device_remove(struct platform_device *pdev)
 		kbdev->inited_subsys &= ~inited_backend_late;
 	}
 
+	kbase_hwcnt_sampler_term(kbdev);
+
 	if (kbdev->inited_subsys & inited_vinstr) {
 		kbase_vinstr_term(kbdev->vinstr_ctx);
 		kbdev->inited_subsys &= ~inited_vinstr;
@@ -4337,6 +4460,14 @@ static int kbase_platform_device_probe(struct platform_device *pdev)
 	}
 	kbdev->inited_subsys |= inited_vinstr;
 
+	err = kbase_hwcnt_sampler_init(kbdev);
+	if (err) {
+		dev_err(kbdev->dev,
+			"Hwcnt sampler initialization failed\n");
+		kbase_platform_device_remove(pdev);
+		return err;
+	}
+
 	/* The initialization of the devfreq is now embedded inside the
 	 * kbase_backend_late_init(), calling the kbase_backend_devfreq_init()
 	 * before the first trigger of pm_context_idle(). */
@@ -4718,6 +4849,7 @@ EXPORT_TRACEPOINT_SYMBOL_GPL(mali_job_slots_event);
 EXPORT_TRACEPOINT_SYMBOL_GPL(mali_pm_status);
 EXPORT_TRACEPOINT_SYMBOL_GPL(mali_page_fault_insert_pages);
 EXPORT_TRACEPOINT_SYMBOL_GPL(mali_total_alloc_pages_change);
+EXPORT_TRACEPOINT_SYMBOL_GPL(mali_hwcnt_sample);
 
 void kbase_trace_mali_pm_status(u32 dev_id, u32 event, u64 value)
 {
@@ -4741,6 +4873,14 @@ void kbase_trace_mali_total_alloc_pages_change(u32 dev_id, long long int event)
 {
 	trace_mali_total_alloc_pages_change(dev_id, event);
 }
+
+void kbase_trace_mali_hwcnt_sample(u32 dev_id, u32 gpu_active,
+		u32 tiler_active, u32 sc_active, u32 l2_ext_read, u32 clock,
+		u32 utilization)
+{
+	trace_mali_hwcnt_sample(dev_id, gpu_active, tiler_active, sc_active,
+		l2_ext_read, clock, utilization);
+}
 #endif /* CONFIG_MALI_GATOR_SUPPORT */
 #ifdef CONFIG_MALI_SYSTEM_TRACE
 #include "mali_linux_kbase_trace.h"
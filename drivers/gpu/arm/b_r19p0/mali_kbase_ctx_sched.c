@@ -82,6 +82,21 @@ static int kbasep_ctx_sched_find_as_for_ctx(struct kbase_context *kctx)
 			(kbdev->as_free & (1u << kctx->as_nr)))
 		return kctx->as_nr;
 
+	/* Then prefer a free AS that does not still hold the page tables of
+	 * a foreground context, so that it can come back without having to
+	 * reprogram the MMU.
+	 */
+	for (free_as = 0; free_as < kbdev->nr_hw_address_spaces; free_as++) {
+		struct kbase_context *const prev_kctx =
+			kbdev->as_to_kctx[free_as];
+
+		if (!(kbdev->as_free & (1u << free_as)))
+			continue;
+
+		if (!prev_kctx || !kbase_ctx_flag(prev_kctx, KCTX_FOREGROUND))
+			return free_as;
+	}
+
 	/* The previously assigned AS was taken, we'll be returning any free
 	 * AS at this point.
 	 */
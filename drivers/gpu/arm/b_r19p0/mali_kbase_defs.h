@@ -1109,6 +1109,22 @@ struct kbase_pm_device_data {
 	struct kbase_pm_backend_data backend;
 };
 
+#define KBASE_MEM_POOL_PCP_SIZE		16
+#define KBASE_MEM_POOL_PCP_BATCH	(KBASE_MEM_POOL_PCP_SIZE / 2)
+
+/**
+ * struct kbase_mem_pool_pcp - Per-CPU cache of free pages of a device pool
+ * @lock:  Lock protecting @count and @pages. Taken before the pool lock
+ *         when both are needed.
+ * @count: Number of pages currently held in @pages
+ * @pages: Free pages, taken and returned from the end
+ */
+struct kbase_mem_pool_pcp {
+	spinlock_t   lock;
+	unsigned int count;
+	struct page  *pages[KBASE_MEM_POOL_PCP_SIZE];
+};
+
 /**
  * struct kbase_mem_pool - Page based memory pool for kctx/kbdev
  * @kbdev:        Kbase device where memory is used
@@ -1131,6 +1147,14 @@ struct kbase_pm_device_data {
  *                operations should be abandoned
  * @dont_reclaim: true if the shrinker is forbidden from reclaiming memory from
  *                this pool, eg during a grow operation
+ * @pcp:          Per-CPU page caches in front of @page_list, or NULL. Only
+ *                set up for the small page pools of the device. The pages
+ *                they hold are not counted in @cur_size.
+ * @zero_list:    Pages spilled from context pools that still have to be
+ *                zeroed before they can join @page_list. Protected by
+ *                @pool_lock.
+ * @nr_to_zero:   Number of pages on @zero_list or being zeroed by @zero_work
+ * @zero_work:    Work item zeroing the pages of @zero_list
  */
 struct kbase_mem_pool {
 	struct kbase_device *kbdev;
@@ -1146,6 +1170,12 @@ struct kbase_mem_pool {
 
 	bool dying;
 	bool dont_reclaim;
+
+	struct kbase_mem_pool_pcp __percpu *pcp;
+
+	struct list_head   zero_list;
+	size_t             nr_to_zero;
+	struct work_struct zero_work;
 };
 
 /**
@@ -1381,6 +1411,7 @@ struct kbase_devfreq_queue_info {
  *                         kbase_hwcnt_context_enable() with @hwcnt_gpu_ctx.
  * @hwcnt_gpu_virt:        Virtualizer for GPU hardware counters.
  * @vinstr_ctx:            vinstr context created per device.
+ * @hwcnt_sampler:         Periodic hardware counter sampler of the device.
  * @timeline_is_enabled:   Non zero, if there is at least one timeline client,
  *                         zero otherwise.
  * @timeline:              Timeline context created per device.
@@ -1525,6 +1556,10 @@ struct kbase_devfreq_queue_info {
  *                          on disabling of GWT.
  * @js_ctx_scheduling_mode: Context scheduling mode currently being used by
  *                          Job Scheduler
+ * @js_foreground_tgids:    Processes whose contexts are flagged as
+ *                          KCTX_FOREGROUND, set through the js_foreground
+ *                          sysfs file. Protected by @kctx_list_lock.
+ * @nr_js_foreground_tgids: Number of valid entries in @js_foreground_tgids.
  * @l2_size_override:       Used to set L2 cache size via device tree blob
  * @l2_hash_override:       Used to set L2 cache hash via device tree blob
  * @policy_list:            A filtered list of policies available in the system.
@@ -1612,6 +1647,9 @@ struct kbase_device {
 	struct kbase_hwcnt_context *hwcnt_gpu_ctx;
 	struct kbase_hwcnt_virtualizer *hwcnt_gpu_virt;
 	struct kbase_vinstr_context *vinstr_ctx;
+#ifdef CONFIG_MALI_HWCNT_SAMPLER
+	struct kbase_hwcnt_sampler *hwcnt_sampler;
+#endif
 
 	atomic_t               timeline_is_enabled;
 	struct kbase_timeline *timeline;
@@ -1775,6 +1813,9 @@ struct kbase_device {
 	/* See KBASE_JS_*_PRIORITY_MODE for details. */
 	u32 js_ctx_scheduling_mode;
 
+	pid_t js_foreground_tgids[KBASE_JS_MAX_FOREGROUND_TGIDS];
+	unsigned int nr_js_foreground_tgids;
+
 
 	const struct kbase_pm_policy *policy_list[KBASE_PM_MAX_NUM_POLICIES];
 	int policy_count;
@@ -1904,6 +1945,12 @@ struct kbase_file {
  * from it for job slot 2. This is reset when the context first goes active or
  * is re-activated on that slot.
  *
+ * @KCTX_FOREGROUND: Set when the context belongs to one of the processes listed
+ * in the js_foreground sysfs file. Such contexts are scheduled at the highest
+ * priority, soft-stop the compute atoms of the other contexts and keep their
+ * address space for longest. Updated with both kctx_list_lock and
+ * hwaccess_lock held.
+ *
  * All members need to be separate bits. This enum is intended for use in a
  * bitmask where multiple values get OR-ed together.
  */
@@ -1923,6 +1970,7 @@ enum kbase_context_flags {
 	KCTX_PULLED_SINCE_ACTIVE_JS0 = 1U << 12,
 	KCTX_PULLED_SINCE_ACTIVE_JS1 = 1U << 13,
 	KCTX_PULLED_SINCE_ACTIVE_JS2 = 1U << 14,
+	KCTX_FOREGROUND = 1U << 15,
 };
 
 struct kbase_sub_alloc {
@@ -26,6 +26,11 @@
 #include <mali_kbase_fence_defs.h>
 #include <mali_kbase_fence.h>
 #include <mali_kbase.h>
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 10, 0))
+#include <linux/fence-array.h>
+#else
+#include <linux/dma-fence-array.h>
+#endif
 
 /* Spin lock protecting all Mali fences as fence->lock. */
 static DEFINE_SPINLOCK(kbase_fence_lock);
@@ -210,3 +215,64 @@ kbase_fence_add_callback(struct kbase_jd_atom *katom,
 
 	return err;
 }
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 10, 0))
+static pid_t kbase_fence_ctx_tgid(struct kbase_device *kbdev,
+				  struct fence *fence)
+#else
+static pid_t kbase_fence_ctx_tgid(struct kbase_device *kbdev,
+				  struct dma_fence *fence)
+#endif
+{
+	struct kbase_context *kctx;
+	int i;
+
+	lockdep_assert_held(&kbdev->kctx_list_lock);
+
+	if (fence->ops != &kbase_fence_ops)
+		return 0;
+
+	/* Every atom slot has a fence context of its own */
+	list_for_each_entry(kctx, &kbdev->kctx_list, kctx_list_link) {
+		for (i = 0; i < BASE_JD_ATOM_COUNT; i++) {
+			if (kctx->jctx.atoms[i].dma_fence.context ==
+					fence->context)
+				return kctx->tgid;
+		}
+	}
+
+	return 0;
+}
+
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 10, 0))
+pid_t kbase_fence_owner_tgid(struct kbase_device *kbdev, struct fence *fence)
+#else
+pid_t kbase_fence_owner_tgid(struct kbase_device *kbdev,
+			     struct dma_fence *fence)
+#endif
+{
+	pid_t tgid = 0;
+
+	mutex_lock(&kbdev->kctx_list_lock);
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 10, 0))
+	if (fence_is_array(fence)) {
+		struct fence_array *array = to_fence_array(fence);
+#else
+	if (dma_fence_is_array(fence)) {
+		struct dma_fence_array *array = to_dma_fence_array(fence);
+#endif
+		unsigned int i;
+
+		/* First unsignaled Mali fence of a merged sync file */
+		for (i = 0; i < array->num_fences && !tgid; i++) {
+			if (!dma_fence_is_signaled(array->fences[i]))
+				tgid = kbase_fence_ctx_tgid(kbdev,
+						array->fences[i]);
+		}
+	} else {
+		tgid = kbase_fence_ctx_tgid(kbdev, fence);
+	}
+	mutex_unlock(&kbdev->kctx_list_lock);
+
+	return tgid;
+}
@@ -246,6 +246,23 @@ static inline int kbase_fence_dep_count_read(struct kbase_jd_atom *katom)
  */
 bool kbase_fence_free_callbacks(struct kbase_jd_atom *katom);
 
+/**
+ * kbase_fence_owner_tgid() - Find the process that owns a Mali fence
+ * @kbdev: Device the fence may belong to
+ * @fence: Fence to look up, a fence array is looked through
+ *
+ * Locking: takes kbdev->kctx_list_lock, so may sleep.
+ *
+ * Return: tgid of the context whose atom will signal @fence, or 0 if @fence
+ *         is not a fence of @kbdev
+ */
+#if (LINUX_VERSION_CODE < KERNEL_VERSION(4, 10, 0))
+pid_t kbase_fence_owner_tgid(struct kbase_device *kbdev, struct fence *fence);
+#else
+pid_t kbase_fence_owner_tgid(struct kbase_device *kbdev,
+			     struct dma_fence *fence);
+#endif
+
 #if defined(CONFIG_SYNC_FILE)
 /**
  * kbase_fence_in_get() - Retrieve input fence for atom.
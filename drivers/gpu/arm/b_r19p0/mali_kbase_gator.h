@@ -47,6 +47,9 @@ void kbase_trace_mali_job_slots_event(u32 dev_id, u32 event, const struct kbase_
 void kbase_trace_mali_pm_status(u32 dev_id, u32 event, u64 value);
 void kbase_trace_mali_page_fault_insert_pages(u32 dev_id, int event, u32 value);
 void kbase_trace_mali_total_alloc_pages_change(u32 dev_id, long long int event);
+void kbase_trace_mali_hwcnt_sample(u32 dev_id, u32 gpu_active,
+		u32 tiler_active, u32 sc_active, u32 l2_ext_read, u32 clock,
+		u32 utilization);
 
 #endif /* CONFIG_MALI_GATOR_SUPPORT */
 
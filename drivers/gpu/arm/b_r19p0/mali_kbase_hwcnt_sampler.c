@@ -0,0 +1,417 @@
+/*
+ *
+ * (C) COPYRIGHT 2019 ARM Limited. All rights reserved.
+ *
+ * This program is free software and is provided to you under the terms of the
+ * GNU General Public License version 2 as published by the Free Software
+ * Foundation, and any use by you of this program is subject to the terms
+ * of such GNU licence.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * SPDX-License-Identifier: GPL-2.0
+ *
+ */
+
+#include <mali_kbase.h>
+#include <mali_kbase_gator.h>
+#include <gpu_integration_defs.h>
+#include "mali_kbase_hwcnt_sampler.h"
+#include "mali_kbase_hwcnt_virtualizer.h"
+#include "mali_kbase_hwcnt_types.h"
+#include "mali_kbase_hwcnt_gpu.h"
+
+#include <linux/debugfs.h>
+#include <linux/hrtimer.h>
+#include <linux/mutex.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+#include <linux/vmalloc.h>
+#include <linux/workqueue.h>
+
+/* The shortest sample period that can be set */
+#define SAMPLER_PERIOD_MIN_US 1000
+
+/* Counter indices within the v5 blocks, as laid out on Bifrost */
+#define SAMPLER_JM_GPU_ACTIVE          6
+#define SAMPLER_TILER_ACTIVE          45
+#define SAMPLER_SC_EXEC_CORE_ACTIVE   26
+#define SAMPLER_MEMSYS_L2_EXT_READ    29
+
+/**
+ * struct kbase_hwcnt_sampler - Periodic kernel side hwcnt client.
+ * @kbdev:      Kbase device the sampler belongs to.
+ * @hvirt:      Hardware counter virtualizer the client is attached to.
+ * @metadata:   Hardware counter metadata provided by the virtualizer.
+ * @ctrl_lock:  Lock serializing the starts and stops of the sampler.
+ * @lock:       Lock protecting @hvcli, @dump_buf and @period_us.
+ * @hvcli:      Virtualizer client, only present while sampling.
+ * @dump_buf:   Dump buffer of @hvcli.
+ * @period_us:  Sample period, 0 when the sampler is stopped.
+ * @timer:      Timer that enqueues @work at the end of each period.
+ * @work:       Worker dumping the counters and recording a sample.
+ * @ring_lock:  Lock protecting @ring, @head and @count.
+ * @head:       Index in @ring the next sample is written to.
+ * @count:      Number of valid samples in @ring.
+ * @ring:       The samples, overwritten oldest first once full.
+ */
+struct kbase_hwcnt_sampler {
+	struct kbase_device *kbdev;
+	struct kbase_hwcnt_virtualizer *hvirt;
+	const struct kbase_hwcnt_metadata *metadata;
+	struct mutex ctrl_lock;
+	struct mutex lock;
+	struct kbase_hwcnt_virtualizer_client *hvcli;
+	struct kbase_hwcnt_dump_buffer dump_buf;
+	u32 period_us;
+	struct hrtimer timer;
+	struct work_struct work;
+	spinlock_t ring_lock;
+	unsigned int head;
+	unsigned int count;
+	struct kbase_hwcnt_sample ring[KBASE_HWCNT_SAMPLER_RING_SIZE];
+};
+
+/**
+ * kbasep_hwcnt_sampler_counter() - Get the counter sampled in a block type.
+ * @blk_type: Type of the block, from the v5 group.
+ *
+ * Return: Index of the value sampled in blocks of @blk_type, or -1 if none.
+ */
+static int kbasep_hwcnt_sampler_counter(u64 blk_type)
+{
+	switch (blk_type) {
+	case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_JM:
+		return SAMPLER_JM_GPU_ACTIVE;
+	case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_TILER:
+		return SAMPLER_TILER_ACTIVE;
+	case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_SC:
+		return SAMPLER_SC_EXEC_CORE_ACTIVE;
+	case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_MEMSYS:
+		return SAMPLER_MEMSYS_L2_EXT_READ;
+	default:
+		return -1;
+	}
+}
+
+static void kbasep_hwcnt_sampler_record(struct kbase_hwcnt_sampler *sampler,
+	u64 ts_end_ns)
+{
+	const struct kbase_hwcnt_metadata *md = sampler->metadata;
+	struct kbase_device *kbdev = sampler->kbdev;
+	struct kbase_hwcnt_sample s = { .timestamp_ns = ts_end_ns };
+	size_t grp, blk, blk_inst;
+
+	kbase_hwcnt_metadata_for_each_block(md, grp, blk, blk_inst) {
+		const u64 blk_type =
+			kbase_hwcnt_metadata_block_type(md, grp, blk);
+		const int idx = kbasep_hwcnt_sampler_counter(blk_type);
+		const u32 *blk_buf;
+
+		if (idx < 0 || !kbase_hwcnt_metadata_block_instance_avail(
+				md, grp, blk, blk_inst))
+			continue;
+
+		blk_buf = kbase_hwcnt_dump_buffer_block_instance(
+			&sampler->dump_buf, grp, blk, blk_inst);
+
+		switch (blk_type) {
+		case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_JM:
+			s.gpu_active += blk_buf[idx];
+			break;
+		case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_TILER:
+			s.tiler_active += blk_buf[idx];
+			break;
+		case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_SC:
+			s.sc_active += blk_buf[idx];
+			break;
+		case KBASE_HWCNT_GPU_V5_BLOCK_TYPE_PERF_MEMSYS:
+			s.l2_ext_read += blk_buf[idx];
+			break;
+		}
+	}
+
+	if (kbdev->vendor_callbacks->get_dvfs_status)
+		kbdev->vendor_callbacks->get_dvfs_status(kbdev, &s.clock,
+			&s.utilization);
+
+	spin_lock(&sampler->ring_lock);
+	sampler->ring[sampler->head] = s;
+	sampler->head = (sampler->head + 1) % KBASE_HWCNT_SAMPLER_RING_SIZE;
+	if (sampler->count < KBASE_HWCNT_SAMPLER_RING_SIZE)
+		sampler->count++;
+	spin_unlock(&sampler->ring_lock);
+
+#ifdef CONFIG_MALI_GATOR_SUPPORT
+	kbase_trace_mali_hwcnt_sample(kbdev->id, s.gpu_active, s.tiler_active,
+		s.sc_active, s.l2_ext_read, s.clock, s.utilization);
+#endif
+}
+
+static void kbasep_hwcnt_sampler_worker(struct work_struct *work)
+{
+	struct kbase_hwcnt_sampler *sampler =
+		container_of(work, struct kbase_hwcnt_sampler, work);
+	u64 ts_start_ns;
+	u64 ts_end_ns;
+	int errcode;
+
+	mutex_lock(&sampler->lock);
+
+	if (!sampler->period_us) {
+		mutex_unlock(&sampler->lock);
+		return;
+	}
+
+	errcode = kbase_hwcnt_virtualizer_client_dump(sampler->hvcli,
+		&ts_start_ns, &ts_end_ns, &sampler->dump_buf);
+	if (!errcode)
+		kbasep_hwcnt_sampler_record(sampler, ts_end_ns);
+
+	hrtimer_start(&sampler->timer,
+		ns_to_ktime((u64)sampler->period_us * NSEC_PER_USEC),
+		HRTIMER_MODE_REL);
+
+	mutex_unlock(&sampler->lock);
+}
+
+static enum hrtimer_restart kbasep_hwcnt_sampler_timer(struct hrtimer *timer)
+{
+	struct kbase_hwcnt_sampler *sampler =
+		container_of(timer, struct kbase_hwcnt_sampler, timer);
+
+	queue_work(system_highpri_wq, &sampler->work);
+	return HRTIMER_NORESTART;
+}
+
+static int kbasep_hwcnt_sampler_start(struct kbase_hwcnt_sampler *sampler)
+{
+	const struct kbase_hwcnt_metadata *md = sampler->metadata;
+	struct kbase_hwcnt_enable_map enable_map;
+	size_t grp, blk, blk_inst;
+	int errcode;
+
+	lockdep_assert_held(&sampler->lock);
+
+	errcode = kbase_hwcnt_enable_map_alloc(md, &enable_map);
+	if (errcode)
+		return errcode;
+
+	kbase_hwcnt_metadata_for_each_block(md, grp, blk, blk_inst) {
+		const int idx = kbasep_hwcnt_sampler_counter(
+			kbase_hwcnt_metadata_block_type(md, grp, blk));
+
+		if (idx >= 0)
+			kbase_hwcnt_enable_map_block_enable_value(
+				kbase_hwcnt_enable_map_block_instance(
+					&enable_map, grp, blk, blk_inst),
+				idx);
+	}
+
+	errcode = kbase_hwcnt_dump_buffer_alloc(md, &sampler->dump_buf);
+	if (errcode)
+		goto out;
+
+	errcode = kbase_hwcnt_virtualizer_client_create(sampler->hvirt,
+		&enable_map, &sampler->hvcli);
+	if (errcode) {
+		kbase_hwcnt_dump_buffer_free(&sampler->dump_buf);
+		sampler->hvcli = NULL;
+	}
+
+out:
+	kbase_hwcnt_enable_map_free(&enable_map);
+	return errcode;
+}
+
+static void kbasep_hwcnt_sampler_stop(struct kbase_hwcnt_sampler *sampler)
+{
+	/* Cancel the timer first, as it unconditionally enqueues the worker,
+	 * while the worker does not rearm it once the period is 0.
+	 */
+	hrtimer_cancel(&sampler->timer);
+	cancel_work_sync(&sampler->work);
+
+	mutex_lock(&sampler->lock);
+	if (sampler->hvcli) {
+		kbase_hwcnt_virtualizer_client_destroy(sampler->hvcli);
+		kbase_hwcnt_dump_buffer_free(&sampler->dump_buf);
+		sampler->hvcli = NULL;
+	}
+	mutex_unlock(&sampler->lock);
+}
+
+static int kbasep_hwcnt_sampler_set_period(
+	struct kbase_hwcnt_sampler *sampler, u32 period_us)
+{
+	int errcode = 0;
+
+	if (period_us && period_us < SAMPLER_PERIOD_MIN_US)
+		period_us = SAMPLER_PERIOD_MIN_US;
+
+	mutex_lock(&sampler->ctrl_lock);
+	mutex_lock(&sampler->lock);
+
+	if (!period_us) {
+		sampler->period_us = 0;
+		mutex_unlock(&sampler->lock);
+		kbasep_hwcnt_sampler_stop(sampler);
+		mutex_unlock(&sampler->ctrl_lock);
+		return 0;
+	}
+
+	if (!sampler->hvcli)
+		errcode = kbasep_hwcnt_sampler_start(sampler);
+
+	if (!errcode) {
+		bool start = !sampler->period_us;
+
+		sampler->period_us = period_us;
+		if (start)
+			hrtimer_start(&sampler->timer,
+				ns_to_ktime((u64)period_us * NSEC_PER_USEC),
+				HRTIMER_MODE_REL);
+	}
+
+	mutex_unlock(&sampler->lock);
+	mutex_unlock(&sampler->ctrl_lock);
+
+	return errcode;
+}
+
+int kbase_hwcnt_sampler_init(struct kbase_device *kbdev)
+{
+	struct kbase_hwcnt_sampler *sampler;
+	const struct kbase_hwcnt_metadata *metadata;
+
+	metadata = kbase_hwcnt_virtualizer_metadata(kbdev->hwcnt_gpu_virt);
+	if (!metadata)
+		return -EINVAL;
+
+	/* Only the v5 counter layout is known to the sampler */
+	if (kbase_hwcnt_metadata_group_count(metadata) != 1 ||
+		kbase_hwcnt_metadata_group_type(metadata, 0) !=
+			KBASE_HWCNT_GPU_GROUP_TYPE_V5)
+		return 0;
+
+	sampler = vzalloc(sizeof(*sampler));
+	if (!sampler)
+		return -ENOMEM;
+
+	sampler->kbdev = kbdev;
+	sampler->hvirt = kbdev->hwcnt_gpu_virt;
+	sampler->metadata = metadata;
+
+	mutex_init(&sampler->ctrl_lock);
+	mutex_init(&sampler->lock);
+	spin_lock_init(&sampler->ring_lock);
+	hrtimer_init(&sampler->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	sampler->timer.function = kbasep_hwcnt_sampler_timer;
+	INIT_WORK(&sampler->work, kbasep_hwcnt_sampler_worker);
+
+	kbdev->hwcnt_sampler = sampler;
+	return 0;
+}
+
+void kbase_hwcnt_sampler_term(struct kbase_device *kbdev)
+{
+	struct kbase_hwcnt_sampler *sampler = kbdev->hwcnt_sampler;
+
+	if (!sampler)
+		return;
+
+	kbasep_hwcnt_sampler_set_period(sampler, 0);
+
+	kbdev->hwcnt_sampler = NULL;
+	vfree(sampler);
+}
+
+#ifdef CONFIG_DEBUG_FS
+
+static int kbasep_hwcnt_sampler_period_get(void *data, u64 *val)
+{
+	struct kbase_hwcnt_sampler *sampler = data;
+
+	*val = READ_ONCE(sampler->period_us);
+	return 0;
+}
+
+static int kbasep_hwcnt_sampler_period_set(void *data, u64 val)
+{
+	return kbasep_hwcnt_sampler_set_period(data, min_t(u64, val, U32_MAX));
+}
+
+DEFINE_SIMPLE_ATTRIBUTE(kbasep_hwcnt_sampler_period_fops,
+	kbasep_hwcnt_sampler_period_get, kbasep_hwcnt_sampler_period_set,
+	"%llu\n");
+
+static int kbasep_hwcnt_sampler_samples_show(struct seq_file *sfile,
+	void *data)
+{
+	struct kbase_hwcnt_sampler *sampler = sfile->private;
+	unsigned int i, idx;
+
+	CSTD_UNUSED(data);
+
+	seq_puts(sfile, "timestamp_ns gpu_active tiler_active sc_active l2_ext_read clock utilization\n");
+
+	spin_lock(&sampler->ring_lock);
+	idx = (sampler->head + KBASE_HWCNT_SAMPLER_RING_SIZE - sampler->count) %
+		KBASE_HWCNT_SAMPLER_RING_SIZE;
+	for (i = 0; i < sampler->count; i++) {
+		const struct kbase_hwcnt_sample *s = &sampler->ring[idx];
+
+		seq_printf(sfile, "%llu %u %u %u %u %u %u\n",
+			s->timestamp_ns, s->gpu_active, s->tiler_active,
+			s->sc_active, s->l2_ext_read, s->clock,
+			s->utilization);
+		idx = (idx + 1) % KBASE_HWCNT_SAMPLER_RING_SIZE;
+	}
+	spin_unlock(&sampler->ring_lock);
+
+	return 0;
+}
+
+static int kbasep_hwcnt_sampler_samples_open(struct inode *in,
+	struct file *file)
+{
+	return single_open(file, kbasep_hwcnt_sampler_samples_show,
+		in->i_private);
+}
+
+static const struct file_operations kbasep_hwcnt_sampler_samples_fops = {
+	.owner = THIS_MODULE,
+	.open = kbasep_hwcnt_sampler_samples_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void kbase_hwcnt_sampler_debugfs_init(struct kbase_device *kbdev)
+{
+	if (!kbdev->hwcnt_sampler)
+		return;
+
+	debugfs_create_file("hwcnt_sampler_period_us", 0644,
+		kbdev->mali_debugfs_directory, kbdev->hwcnt_sampler,
+		&kbasep_hwcnt_sampler_period_fops);
+
+	debugfs_create_file("hwcnt_samples", 0444,
+		kbdev->mali_debugfs_directory, kbdev->hwcnt_sampler,
+		&kbasep_hwcnt_sampler_samples_fops);
+}
+
+#else /* CONFIG_DEBUG_FS */
+
+void kbase_hwcnt_sampler_debugfs_init(struct kbase_device *kbdev)
+{
+}
+
+#endif /* CONFIG_DEBUG_FS */
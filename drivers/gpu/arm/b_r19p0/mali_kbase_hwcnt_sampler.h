@@ -0,0 +1,106 @@
+/*
+ *
+ * (C) COPYRIGHT 2019 ARM Limited. All rights reserved.
+ *
+ * This program is free software and is provided to you under the terms of the
+ * GNU General Public License version 2 as published by the Free Software
+ * Foundation, and any use by you of this program is subject to the terms
+ * of such GNU licence.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ * SPDX-License-Identifier: GPL-2.0
+ *
+ */
+
+/*
+ * Hwcnt sampler, a kernel side client of the hardware counter virtualizer
+ * that periodically records a handful of counters together with the DVFS
+ * state into a per-device ring buffer.
+ */
+
+#ifndef _KBASE_HWCNT_SAMPLER_H_
+#define _KBASE_HWCNT_SAMPLER_H_
+
+#include <linux/types.h>
+
+struct kbase_device;
+
+/* Number of samples kept in the ring buffer of a device */
+#define KBASE_HWCNT_SAMPLER_RING_SIZE 1024
+
+/**
+ * struct kbase_hwcnt_sample - One record of the hwcnt sampler.
+ * @timestamp_ns: End of the sample period, in raw monotonic ns.
+ * @gpu_active:   JM GPU_ACTIVE cycles over the period.
+ * @tiler_active: Tiler TILER_ACTIVE cycles over the period.
+ * @sc_active:    Shader core EXEC_CORE_ACTIVE cycles, summed over all cores.
+ * @l2_ext_read:  L2 external reads, ie misses, summed over all slices.
+ * @clock:        GPU clock in MHz, as last set by the platform DVFS.
+ * @utilization:  GPU utilization in percent, as last seen by the DVFS.
+ */
+struct kbase_hwcnt_sample {
+	u64 timestamp_ns;
+	u32 gpu_active;
+	u32 tiler_active;
+	u32 sc_active;
+	u32 l2_ext_read;
+	u32 clock;
+	u32 utilization;
+};
+
+#ifdef CONFIG_MALI_HWCNT_SAMPLER
+
+/**
+ * kbase_hwcnt_sampler_init() - Initialise the hwcnt sampler of a device.
+ * @kbdev: Non-NULL pointer to the kbase device, whose hwcnt virtualizer
+ *         must already be initialised.
+ *
+ * The sampler is created stopped, it only attaches to the virtualizer while
+ * a sample period is set.
+ *
+ * Return: 0 on success, else error code.
+ */
+int kbase_hwcnt_sampler_init(struct kbase_device *kbdev);
+
+/**
+ * kbase_hwcnt_sampler_term() - Stop and terminate the hwcnt sampler.
+ * @kbdev: Pointer to the kbase device.
+ */
+void kbase_hwcnt_sampler_term(struct kbase_device *kbdev);
+
+/**
+ * kbase_hwcnt_sampler_debugfs_init() - Add the debugfs files of the sampler.
+ * @kbdev: Pointer to the kbase device.
+ *
+ * Adds two files to the mali debugfs directory:
+ * - hwcnt_sampler_period_us: get/set the sample period, 0 stops sampling
+ * - hwcnt_samples: the samples currently in the ring buffer, oldest first
+ */
+void kbase_hwcnt_sampler_debugfs_init(struct kbase_device *kbdev);
+
+#else /* CONFIG_MALI_HWCNT_SAMPLER */
+
+static inline int kbase_hwcnt_sampler_init(struct kbase_device *kbdev)
+{
+	return 0;
+}
+
+static inline void kbase_hwcnt_sampler_term(struct kbase_device *kbdev)
+{
+}
+
+static inline void kbase_hwcnt_sampler_debugfs_init(struct kbase_device *kbdev)
+{
+}
+
+#endif /* CONFIG_MALI_HWCNT_SAMPLER */
+
+#endif /* _KBASE_HWCNT_SAMPLER_H_ */
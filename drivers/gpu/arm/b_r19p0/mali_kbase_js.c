@@ -1104,7 +1104,11 @@ void kbase_js_update_ctx_priority(struct kbase_context *kctx)
 
 	lockdep_assert_held(&kbdev->hwaccess_lock);
 
-	if (kbdev->js_ctx_scheduling_mode == KBASE_JS_SYSTEM_PRIORITY_MODE) {
+	if (kbase_ctx_flag(kctx, KCTX_FOREGROUND)) {
+		/* Foreground contexts are pulled from before any other */
+		new_priority = KBASE_JS_ATOM_SCHED_PRIO_HIGH;
+	} else if (kbdev->js_ctx_scheduling_mode ==
+			KBASE_JS_SYSTEM_PRIORITY_MODE) {
 		/* Determine the new priority for context, as per the priority
 		 * of currently in-use atoms.
 		 */
@@ -1119,6 +1123,55 @@ void kbase_js_update_ctx_priority(struct kbase_context *kctx)
 	kbase_js_set_ctx_priority(kctx, new_priority);
 }
 
+void kbase_js_update_ctx_foreground(struct kbase_context *kctx)
+{
+	struct kbase_device *kbdev = kctx->kbdev;
+	unsigned int i;
+
+	lockdep_assert_held(&kbdev->kctx_list_lock);
+	lockdep_assert_held(&kbdev->hwaccess_lock);
+
+	kbase_ctx_flag_clear(kctx, KCTX_FOREGROUND);
+	for (i = 0; i < kbdev->nr_js_foreground_tgids; i++) {
+		if (kbdev->js_foreground_tgids[i] == kctx->tgid) {
+			kbase_ctx_flag_set(kctx, KCTX_FOREGROUND);
+			break;
+		}
+	}
+
+	kbase_js_update_ctx_priority(kctx);
+}
+
+/**
+ * kbase_js_foreground_preempt_locked - Soft-stop background compute atoms
+ * @kbdev: Device pointer
+ *
+ * Called when an atom of a foreground context becomes runnable. Compute atoms
+ * of other contexts that sit at the tail of a slot are soft-stopped, so that
+ * they give the shader cores back to the foreground work. They are put back
+ * in their queue and only get pulled again after the foreground context, as
+ * it has the highest priority.
+ *
+ * The hwaccess_lock must be held when calling this function.
+ */
+static void kbase_js_foreground_preempt_locked(struct kbase_device *kbdev)
+{
+	int js;
+
+	lockdep_assert_held(&kbdev->hwaccess_lock);
+
+	for (js = 0; js < kbdev->gpu_props.num_job_slots; js++) {
+		struct kbase_jd_atom *katom = kbase_backend_inspect_tail(kbdev,
+				js);
+
+		if (!katom || kbase_ctx_flag(katom->kctx, KCTX_FOREGROUND))
+			continue;
+
+		if (katom->core_req & BASE_JD_REQ_CS)
+			kbase_job_slot_softstop(kbdev, js, katom);
+	}
+}
+
 bool kbasep_js_add_job(struct kbase_context *kctx,
 		struct kbase_jd_atom *atom)
 {
@@ -2081,6 +2134,8 @@ bool kbase_js_dep_resolved_submit(struct kbase_context *kctx,
 	} else {
 		/* Check if there are lower priority jobs to soft stop */
 		kbase_job_slot_ctx_priority_check_locked(kctx, katom);
+		if (kbase_ctx_flag(kctx, KCTX_FOREGROUND))
+			kbase_js_foreground_preempt_locked(kctx->kbdev);
 
 		/* Add atom to ring buffer. */
 		jsctx_tree_add(kctx, katom);
@@ -2513,6 +2568,10 @@ struct kbase_jd_atom *kbase_js_complete_atom(struct kbase_jd_atom *katom,
     }
 #endif
 
+	/* MALI_SEC_INTEGRATION */
+	if (end_timestamp != NULL && kbdev->vendor_callbacks->frame_pacing_job_done)
+		kbdev->vendor_callbacks->frame_pacing_job_done(kbdev, katom, end_timestamp);
+
 	kbase_jd_done(katom, katom->slot_nr, end_timestamp, 0);
 
 	/* Unblock cross dependency if present */
@@ -617,6 +617,18 @@ void kbase_js_set_ctx_priority(struct kbase_context *kctx, int new_priority);
  */
 void kbase_js_update_ctx_priority(struct kbase_context *kctx);
 
+/**
+ * kbase_js_update_ctx_foreground - update the foreground state of a context
+ * @kctx: Context pointer
+ *
+ * KCTX_FOREGROUND is set on the context if its process is listed in the
+ * js_foreground sysfs file and cleared otherwise, then the context priority
+ * gets updated accordingly.
+ *
+ * The kctx_list_lock and hwaccess_lock must be held when calling this function.
+ */
+void kbase_js_update_ctx_foreground(struct kbase_context *kctx);
+
 /*
  * Helpers follow
  */
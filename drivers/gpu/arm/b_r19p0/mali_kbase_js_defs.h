@@ -189,6 +189,11 @@ enum {
  */
 #define KBASE_JS_ATOM_SCHED_PRIO_DEFAULT KBASE_JS_ATOM_SCHED_PRIO_MED
 
+/* Maximum number of processes that can be listed in the js_foreground
+ * sysfs file at once.
+ */
+#define KBASE_JS_MAX_FOREGROUND_TGIDS 8
+
 /**
  * @brief KBase Device Data Job Scheduler sub-structure
  *
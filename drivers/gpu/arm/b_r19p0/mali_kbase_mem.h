@@ -851,6 +851,18 @@ static inline size_t kbase_mem_pool_max_size(struct kbase_mem_pool *pool)
 	return pool->max_size;
 }
 
+/**
+ * kbase_mem_pool_zero_pending - Get number of pages waiting to be zeroed
+ * @pool:  Memory pool to inspect
+ *
+ * Return: Number of pages queued for zeroing in the background before they
+ *         join the free pages of the pool
+ */
+static inline size_t kbase_mem_pool_zero_pending(struct kbase_mem_pool *pool)
+{
+	return READ_ONCE(pool->nr_to_zero);
+}
+
 
 /**
  * kbase_mem_pool_set_max_size - Set maximum number of free pages in memory pool
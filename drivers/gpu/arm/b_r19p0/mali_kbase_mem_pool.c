@@ -27,6 +27,7 @@
 #include <linux/spinlock.h>
 #include <linux/shrinker.h>
 #include <linux/atomic.h>
+#include <linux/percpu.h>
 #include <linux/version.h>
 
 #define pool_dbg(pool, format, ...) \
@@ -39,17 +40,40 @@
 #define NOT_DIRTY false
 #define NOT_RECLAIMED false
 
+/*
+ * Module parameter to put per-CPU page caches in front of the small page
+ * pools of the device, so that single page allocations and frees from
+ * several threads do not all serialize on the pool lock.
+ *
+ * It must be set on insmod to take effect.
+ */
+static bool mem_pool_pcp;
+module_param(mem_pool_pcp, bool, 0444);
+MODULE_PARM_DESC(mem_pool_pcp, "Cache free pages of the device pools per CPU");
+
+/*
+ * Module parameter to zero the pages that context pools spill to the device
+ * pools from a work item, instead of on the freeing thread.
+ */
+static bool mem_pool_bg_zero;
+module_param(mem_pool_bg_zero, bool, 0644);
+MODULE_PARM_DESC(mem_pool_bg_zero, "Zero pages spilled to the device pools in the background");
+
+#define KBASE_MEM_POOL_ZERO_BATCH 16
+
 static size_t kbase_mem_pool_capacity(struct kbase_mem_pool *pool)
 {
 	ssize_t max_size = kbase_mem_pool_max_size(pool);
-	ssize_t cur_size = kbase_mem_pool_size(pool);
+	ssize_t cur_size = kbase_mem_pool_size(pool) +
+			   kbase_mem_pool_zero_pending(pool);
 
 	return max(max_size - cur_size, (ssize_t)0);
 }
 
 static bool kbase_mem_pool_is_full(struct kbase_mem_pool *pool)
 {
-	return kbase_mem_pool_size(pool) >= kbase_mem_pool_max_size(pool);
+	return kbase_mem_pool_size(pool) + kbase_mem_pool_zero_pending(pool) >=
+		kbase_mem_pool_max_size(pool);
 }
 
 static bool kbase_mem_pool_is_empty(struct kbase_mem_pool *pool)
@@ -68,8 +92,36 @@ static void kbase_mem_pool_add_locked(struct kbase_mem_pool *pool,
 	pool_dbg(pool, "added page\n");
 }
 
+/*
+ * Put a page in the cache of the current CPU. When it is full, move a batch
+ * of pages back to the pool under a single hold of the pool lock.
+ */
+static void kbase_mem_pool_pcp_add(struct kbase_mem_pool *pool,
+		struct page *p)
+{
+	struct kbase_mem_pool_pcp *pcp = get_cpu_ptr(pool->pcp);
+
+	spin_lock(&pcp->lock);
+	if (pcp->count == KBASE_MEM_POOL_PCP_SIZE) {
+		kbase_mem_pool_lock(pool);
+		while (pcp->count > KBASE_MEM_POOL_PCP_SIZE -
+				KBASE_MEM_POOL_PCP_BATCH)
+			kbase_mem_pool_add_locked(pool,
+					pcp->pages[--pcp->count]);
+		kbase_mem_pool_unlock(pool);
+	}
+	pcp->pages[pcp->count++] = p;
+	spin_unlock(&pcp->lock);
+	put_cpu_ptr(pool->pcp);
+}
+
 static void kbase_mem_pool_add(struct kbase_mem_pool *pool, struct page *p)
 {
+	if (pool->pcp) {
+		kbase_mem_pool_pcp_add(pool, p);
+		return;
+	}
+
 	kbase_mem_pool_lock(pool);
 	kbase_mem_pool_add_locked(pool, p);
 	kbase_mem_pool_unlock(pool);
@@ -112,10 +164,39 @@ static struct page *kbase_mem_pool_remove_locked(struct kbase_mem_pool *pool)
 	return p;
 }
 
+/*
+ * Take a page from the cache of the current CPU, refilling it with a batch
+ * of pages from the pool when it is empty.
+ */
+static struct page *kbase_mem_pool_pcp_remove(struct kbase_mem_pool *pool)
+{
+	struct kbase_mem_pool_pcp *pcp = get_cpu_ptr(pool->pcp);
+	struct page *p = NULL;
+
+	spin_lock(&pcp->lock);
+	if (!pcp->count) {
+		kbase_mem_pool_lock(pool);
+		while (pcp->count < KBASE_MEM_POOL_PCP_BATCH &&
+				!kbase_mem_pool_is_empty(pool))
+			pcp->pages[pcp->count++] =
+				kbase_mem_pool_remove_locked(pool);
+		kbase_mem_pool_unlock(pool);
+	}
+	if (pcp->count)
+		p = pcp->pages[--pcp->count];
+	spin_unlock(&pcp->lock);
+	put_cpu_ptr(pool->pcp);
+
+	return p;
+}
+
 static struct page *kbase_mem_pool_remove(struct kbase_mem_pool *pool)
 {
 	struct page *p;
 
+	if (pool->pcp)
+		return kbase_mem_pool_pcp_remove(pool);
+
 	kbase_mem_pool_lock(pool);
 	p = kbase_mem_pool_remove_locked(pool);
 	kbase_mem_pool_unlock(pool);
@@ -142,9 +223,63 @@ static void kbase_mem_pool_zero_page(struct kbase_mem_pool *pool,
 	kbase_mem_pool_sync_page(pool, p);
 }
 
+/*
+ * Hand pages over to the zero worker of @pool, they join the pool once they
+ * have been cleared and synced.
+ */
+static void kbase_mem_pool_queue_zero(struct kbase_mem_pool *pool,
+		struct list_head *page_list, size_t nr_pages)
+{
+	kbase_mem_pool_lock(pool);
+	list_splice(page_list, &pool->zero_list);
+	pool->nr_to_zero += nr_pages;
+	kbase_mem_pool_unlock(pool);
+
+	queue_work(system_unbound_wq, &pool->zero_work);
+
+	pool_dbg(pool, "queued %zu pages for zeroing\n", nr_pages);
+}
+
+static void kbase_mem_pool_zero_worker(struct work_struct *work)
+{
+	struct kbase_mem_pool *pool = container_of(work,
+			struct kbase_mem_pool, zero_work);
+	LIST_HEAD(page_list);
+	struct page *p;
+	size_t nr_pages;
+
+	kbase_mem_pool_lock(pool);
+	while (!list_empty(&pool->zero_list) && !pool->dying) {
+		for (nr_pages = 0; nr_pages < KBASE_MEM_POOL_ZERO_BATCH &&
+				!list_empty(&pool->zero_list); nr_pages++) {
+			p = list_first_entry(&pool->zero_list, struct page,
+					lru);
+			list_move(&p->lru, &page_list);
+		}
+		kbase_mem_pool_unlock(pool);
+
+		list_for_each_entry(p, &page_list, lru)
+			kbase_mem_pool_zero_page(pool, p);
+
+		kbase_mem_pool_lock(pool);
+		pool->nr_to_zero -= nr_pages;
+		kbase_mem_pool_add_list_locked(pool, &page_list, nr_pages);
+		INIT_LIST_HEAD(&page_list);
+	}
+	kbase_mem_pool_unlock(pool);
+}
+
 static void kbase_mem_pool_spill(struct kbase_mem_pool *next_pool,
 		struct page *p)
 {
+	if (READ_ONCE(mem_pool_bg_zero)) {
+		LIST_HEAD(page_list);
+
+		list_add(&p->lru, &page_list);
+		kbase_mem_pool_queue_zero(next_pool, &page_list, 1);
+		return;
+	}
+
 	/* Zero page before spilling */
 	kbase_mem_pool_zero_page(next_pool, p);
 
@@ -228,6 +363,25 @@ static size_t kbase_mem_pool_shrink_locked(struct kbase_mem_pool *pool,
 	return i;
 }
 
+/* Free pages that are still waiting to be zeroed, no point clearing them */
+static size_t kbase_mem_pool_shrink_zero_list_locked(
+		struct kbase_mem_pool *pool, size_t nr_to_shrink)
+{
+	struct page *p;
+	size_t i;
+
+	lockdep_assert_held(&pool->pool_lock);
+
+	for (i = 0; i < nr_to_shrink && !list_empty(&pool->zero_list); i++) {
+		p = list_first_entry(&pool->zero_list, struct page, lru);
+		list_del_init(&p->lru);
+		pool->nr_to_zero--;
+		kbase_mem_pool_free_page(pool, p);
+	}
+
+	return i;
+}
+
 static size_t kbase_mem_pool_shrink(struct kbase_mem_pool *pool,
 		size_t nr_to_shrink)
 {
@@ -240,6 +394,66 @@ static size_t kbase_mem_pool_shrink(struct kbase_mem_pool *pool,
 	return nr_freed;
 }
 
+static size_t kbase_mem_pool_pcp_size(struct kbase_mem_pool *pool)
+{
+	size_t nr_pages = 0;
+	int cpu;
+
+	if (!pool->pcp)
+		return 0;
+
+	for_each_possible_cpu(cpu)
+		nr_pages += READ_ONCE(per_cpu_ptr(pool->pcp, cpu)->count);
+
+	return nr_pages;
+}
+
+/* Free up to @nr_to_shrink pages from the per-CPU caches to the kernel */
+static size_t kbase_mem_pool_pcp_shrink(struct kbase_mem_pool *pool,
+		size_t nr_to_shrink)
+{
+	size_t nr_freed = 0;
+	int cpu;
+
+	if (!pool->pcp)
+		return 0;
+
+	for_each_possible_cpu(cpu) {
+		struct kbase_mem_pool_pcp *pcp = per_cpu_ptr(pool->pcp, cpu);
+
+		spin_lock(&pcp->lock);
+		while (pcp->count && nr_freed < nr_to_shrink) {
+			kbase_mem_pool_free_page(pool,
+					pcp->pages[--pcp->count]);
+			nr_freed++;
+		}
+		spin_unlock(&pcp->lock);
+
+		if (nr_freed == nr_to_shrink)
+			break;
+	}
+
+	return nr_freed;
+}
+
+/* Move all the pages of the per-CPU caches back to the pool */
+static void kbase_mem_pool_pcp_flush(struct kbase_mem_pool *pool)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct kbase_mem_pool_pcp *pcp = per_cpu_ptr(pool->pcp, cpu);
+
+		spin_lock(&pcp->lock);
+		kbase_mem_pool_lock(pool);
+		while (pcp->count)
+			kbase_mem_pool_add_locked(pool,
+					pcp->pages[--pcp->count]);
+		kbase_mem_pool_unlock(pool);
+		spin_unlock(&pcp->lock);
+	}
+}
+
 int kbase_mem_pool_grow(struct kbase_mem_pool *pool,
 		size_t nr_to_grow)
 {
@@ -333,10 +547,10 @@ static unsigned long kbase_mem_pool_reclaim_count_objects(struct shrinker *s,
 		kbase_mem_pool_unlock(pool);
 		return 0;
 	}
-	pool_size = kbase_mem_pool_size(pool);
+	pool_size = kbase_mem_pool_size(pool) + pool->nr_to_zero;
 	kbase_mem_pool_unlock(pool);
 
-	return pool_size;
+	return pool_size + kbase_mem_pool_pcp_size(pool);
 }
 
 static unsigned long kbase_mem_pool_reclaim_scan_objects(struct shrinker *s,
@@ -356,9 +570,17 @@ static unsigned long kbase_mem_pool_reclaim_scan_objects(struct shrinker *s,
 	pool_dbg(pool, "reclaim scan %ld:\n", sc->nr_to_scan);
 
 	freed = kbase_mem_pool_shrink_locked(pool, sc->nr_to_scan);
+	if (freed < sc->nr_to_scan)
+		freed += kbase_mem_pool_shrink_zero_list_locked(pool,
+				sc->nr_to_scan - freed);
 
 	kbase_mem_pool_unlock(pool);
 
+	/* Only then empty the per-CPU caches, which keep the fast path fast */
+	if (freed < sc->nr_to_scan)
+		freed += kbase_mem_pool_pcp_shrink(pool,
+				sc->nr_to_scan - freed);
+
 	pool_dbg(pool, "reclaim freed %ld pages\n", freed);
 
 	return freed;
@@ -394,9 +616,25 @@ int kbase_mem_pool_init(struct kbase_mem_pool *pool,
 	pool->kbdev = kbdev;
 	pool->next_pool = next_pool;
 	pool->dying = false;
+	pool->pcp = NULL;
+	pool->nr_to_zero = 0;
 
 	spin_lock_init(&pool->pool_lock);
 	INIT_LIST_HEAD(&pool->page_list);
+	INIT_LIST_HEAD(&pool->zero_list);
+	INIT_WORK(&pool->zero_work, kbase_mem_pool_zero_worker);
+
+	/* The context pools are private, only the device ones are shared */
+	if (mem_pool_pcp && !next_pool && !order) {
+		pool->pcp = alloc_percpu(struct kbase_mem_pool_pcp);
+		if (pool->pcp) {
+			int cpu;
+
+			for_each_possible_cpu(cpu)
+				spin_lock_init(&per_cpu_ptr(pool->pcp,
+							cpu)->lock);
+		}
+	}
 
 	/* Register shrinker */
 #if LINUX_VERSION_CODE < KERNEL_VERSION(3, 12, 0)
@@ -437,10 +675,21 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 	pool_dbg(pool, "terminate()\n");
 
 	unregister_shrinker(&pool->reclaim);
+	cancel_work_sync(&pool->zero_work);
+
+	if (pool->pcp) {
+		kbase_mem_pool_pcp_flush(pool);
+		free_percpu(pool->pcp);
+		pool->pcp = NULL;
+	}
 
 	kbase_mem_pool_lock(pool);
 	pool->max_size = 0;
 
+	/* Pages nobody got around to zeroing go straight back to the kernel */
+	list_splice_init(&pool->zero_list, &free_list);
+	pool->nr_to_zero = 0;
+
 	if (next_pool && !kbase_mem_pool_is_full(next_pool)) {
 		/* Spill to next pool (may overspill) */
 		nr_to_spill = kbase_mem_pool_capacity(next_pool);
@@ -461,7 +710,11 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 
 	kbase_mem_pool_unlock(pool);
 
-	if (next_pool && nr_to_spill) {
+	if (next_pool && nr_to_spill && READ_ONCE(mem_pool_bg_zero)) {
+		kbase_mem_pool_queue_zero(next_pool, &spill_list, nr_to_spill);
+
+		pool_dbg(pool, "terminate() spilled %zu pages\n", nr_to_spill);
+	} else if (next_pool && nr_to_spill) {
 		list_for_each_entry(p, &spill_list, lru)
 			kbase_mem_pool_zero_page(pool, p);
 
@@ -686,6 +939,7 @@ static void kbase_mem_pool_add_array(struct kbase_mem_pool *pool,
 	struct page *p;
 	size_t nr_to_pool = 0;
 	LIST_HEAD(new_page_list);
+	bool defer = zero && READ_ONCE(mem_pool_bg_zero);
 	size_t i;
 
 	if (!nr_pages)
@@ -701,10 +955,12 @@ static void kbase_mem_pool_add_array(struct kbase_mem_pool *pool,
 
 		if (is_huge_head(pages[i]) || !is_huge(pages[i])) {
 			p = as_page(pages[i]);
-			if (zero)
-				kbase_mem_pool_zero_page(pool, p);
-			else if (sync)
+			if (zero) {
+				if (!defer)
+					kbase_mem_pool_zero_page(pool, p);
+			} else if (sync) {
 				kbase_mem_pool_sync_page(pool, p);
+			}
 
 			list_add(&p->lru, &new_page_list);
 			nr_to_pool++;
@@ -712,8 +968,11 @@ static void kbase_mem_pool_add_array(struct kbase_mem_pool *pool,
 		pages[i] = as_tagged(0);
 	}
 
-	/* Add new page list to pool */
-	kbase_mem_pool_add_list(pool, &new_page_list, nr_to_pool);
+	/* Add new page list to pool, or have it zeroed first */
+	if (defer && nr_to_pool)
+		kbase_mem_pool_queue_zero(pool, &new_page_list, nr_to_pool);
+	else
+		kbase_mem_pool_add_list(pool, &new_page_list, nr_to_pool);
 
 	pool_dbg(pool, "add_array(%zu) added %zu pages\n",
 			nr_pages, nr_to_pool);
@@ -74,6 +74,18 @@ size_t kbase_mem_pool_debugfs_max_size(void *const array, size_t const index)
 	return kbase_mem_pool_max_size(&mem_pools[index]);
 }
 
+size_t kbase_mem_pool_debugfs_zero_pending(void *const array,
+	size_t const index)
+{
+	struct kbase_mem_pool *const mem_pools = array;
+
+	if (WARN_ON(!mem_pools) ||
+		WARN_ON(index >= MEMORY_GROUP_MANAGER_NR_GROUPS))
+		return 0;
+
+	return kbase_mem_pool_zero_pending(&mem_pools[index]);
+}
+
 void kbase_mem_pool_config_debugfs_set_max_size(void *const array,
 	size_t const index, size_t const value)
 {
@@ -168,6 +180,42 @@ static const struct file_operations kbase_mem_pool_debugfs_max_size_fops = {
 	.release = single_release,
 };
 
+static int kbase_mem_pool_debugfs_zero_pending_show(struct seq_file *sfile,
+	void *data)
+{
+	CSTD_UNUSED(data);
+	return kbase_debugfs_helper_seq_read(sfile,
+		MEMORY_GROUP_MANAGER_NR_GROUPS,
+		kbase_mem_pool_debugfs_zero_pending);
+}
+
+static int kbase_mem_pool_debugfs_zero_pending_open(struct inode *in,
+	struct file *file)
+{
+	return single_open(file, kbase_mem_pool_debugfs_zero_pending_show,
+		in->i_private);
+}
+
+static const struct file_operations kbase_mem_pool_debugfs_zero_pending_fops = {
+	.owner = THIS_MODULE,
+	.open = kbase_mem_pool_debugfs_zero_pending_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void kbase_mem_pool_zero_debugfs_init(struct dentry *parent,
+		struct kbase_device *kbdev)
+{
+	debugfs_create_file("mem_pool_zero_pending", S_IRUGO, parent,
+		&kbdev->mem_pools.small,
+		&kbase_mem_pool_debugfs_zero_pending_fops);
+
+	debugfs_create_file("lp_mem_pool_zero_pending", S_IRUGO, parent,
+		&kbdev->mem_pools.large,
+		&kbase_mem_pool_debugfs_zero_pending_fops);
+}
+
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_context *kctx)
 {
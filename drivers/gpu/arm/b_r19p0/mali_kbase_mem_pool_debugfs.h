@@ -39,6 +39,19 @@
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_context *kctx);
 
+/**
+ * kbase_mem_pool_zero_debugfs_init - add debugfs files for background zeroing
+ * @parent:  Parent debugfs dentry
+ * @kbdev:   The kbase device
+ *
+ * Adds two read-only debugfs files under @parent:
+ * - mem_pool_zero_pending: pages of @kbdev: mem_pools waiting to be zeroed
+ * - lp_mem_pool_zero_pending: pages of @kbdev: lp_mem_pool waiting to be
+ *   zeroed
+ */
+void kbase_mem_pool_zero_debugfs_init(struct dentry *parent,
+		struct kbase_device *kbdev);
+
 /**
  * kbase_mem_pool_debugfs_trim - Grow or shrink a memory pool to a new size
  *
@@ -93,6 +106,18 @@ size_t kbase_mem_pool_debugfs_size(void *array, size_t index);
  */
 size_t kbase_mem_pool_debugfs_max_size(void *array, size_t index);
 
+/**
+ * kbase_mem_pool_debugfs_zero_pending - Get number of pages waiting to be
+ *                                       zeroed for a memory pool
+ *
+ * @array: Address of the first in an array of physical memory pools.
+ * @index: A memory group ID to be used as an index into the array of memory
+ *         pools. Valid range is 0..(MEMORY_GROUP_MANAGER_NR_GROUPS-1).
+ *
+ * Return: Number of pages queued for zeroing in the background
+ */
+size_t kbase_mem_pool_debugfs_zero_pending(void *array, size_t index);
+
 /**
  * kbase_mem_pool_config_debugfs_set_max_size - Set maximum number of free pages
  *                                              in initial configuration of pool
@@ -128,6 +128,45 @@ TRACE_EVENT(mali_total_alloc_pages_change,
 	TP_printk("gpu=%u event=%lld", __entry->gpu_id, __entry->event_id)
 );
 
+/**
+ * mali_hwcnt_sample - Reports one period of the hwcnt sampler.
+ * @gpu_id:       Kbase device id
+ * @gpu_active:   Cycles the GPU was active
+ * @tiler_active: Cycles the tiler was active
+ * @sc_active:    Cycles the shader cores were executing, over all cores
+ * @l2_ext_read:  L2 external reads, over all slices
+ * @clock:        GPU clock in MHz
+ * @utilization:  GPU utilization in percent
+ */
+TRACE_EVENT(mali_hwcnt_sample,
+	TP_PROTO(u32 gpu_id, u32 gpu_active, u32 tiler_active, u32 sc_active,
+		u32 l2_ext_read, u32 clock, u32 utilization),
+	TP_ARGS(gpu_id, gpu_active, tiler_active, sc_active, l2_ext_read,
+		clock, utilization),
+	TP_STRUCT__entry(
+		__field(u32, gpu_id)
+		__field(u32, gpu_active)
+		__field(u32, tiler_active)
+		__field(u32, sc_active)
+		__field(u32, l2_ext_read)
+		__field(u32, clock)
+		__field(u32, utilization)
+	),
+	TP_fast_assign(
+		__entry->gpu_id       = gpu_id;
+		__entry->gpu_active   = gpu_active;
+		__entry->tiler_active = tiler_active;
+		__entry->sc_active    = sc_active;
+		__entry->l2_ext_read  = l2_ext_read;
+		__entry->clock        = clock;
+		__entry->utilization  = utilization;
+	),
+	TP_printk("gpu=%u gpu_active=%u tiler_active=%u sc_active=%u l2_ext_read=%u clock=%u util=%u",
+		__entry->gpu_id, __entry->gpu_active, __entry->tiler_active,
+		__entry->sc_active, __entry->l2_ext_read, __entry->clock,
+		__entry->utilization)
+);
+
 #endif /* _TRACE_MALI_H */
 
 #undef TRACE_INCLUDE_PATH
@@ -900,6 +900,167 @@ static ssize_t set_highspeed_delay(struct device *dev, struct device_attribute *
 	return count;
 }
 
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+static ssize_t show_frame_period(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	ssize_t ret = 0;
+	unsigned long flags;
+	int frame_period = -1;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	spin_lock_irqsave(&platform->frame_pacing.lock, flags);
+	frame_period = platform->frame_pacing.period_us;
+	spin_unlock_irqrestore(&platform->frame_pacing.lock, flags);
+
+	ret += snprintf(buf+ret, PAGE_SIZE-ret, "%d", frame_period);
+
+	if (ret < PAGE_SIZE - 1) {
+		ret += snprintf(buf+ret, PAGE_SIZE-ret, "\n");
+	} else {
+		buf[PAGE_SIZE-2] = '\n';
+		buf[PAGE_SIZE-1] = '\0';
+		ret = PAGE_SIZE-1;
+	}
+
+	return ret;
+}
+
+static ssize_t set_frame_period(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+	ssize_t ret = 0;
+	unsigned long flags;
+	int frame_period = -1;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	ret = kstrtoint(buf, 0, &frame_period);
+	if (ret) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid value\n", __func__);
+		return -ENOENT;
+	}
+
+	if ((frame_period < 1000) || (frame_period > 100000)) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid period value (%d)\n", __func__, frame_period);
+		return -ENOENT;
+	}
+
+	spin_lock_irqsave(&platform->frame_pacing.lock, flags);
+	platform->frame_pacing.period_us = frame_period;
+	spin_unlock_irqrestore(&platform->frame_pacing.lock, flags);
+
+	return count;
+}
+
+static ssize_t show_frame_headroom(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	ssize_t ret = 0;
+	unsigned long flags;
+	int frame_headroom = -1;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	spin_lock_irqsave(&platform->frame_pacing.lock, flags);
+	frame_headroom = platform->frame_pacing.headroom;
+	spin_unlock_irqrestore(&platform->frame_pacing.lock, flags);
+
+	ret += snprintf(buf+ret, PAGE_SIZE-ret, "%d", frame_headroom);
+
+	if (ret < PAGE_SIZE - 1) {
+		ret += snprintf(buf+ret, PAGE_SIZE-ret, "\n");
+	} else {
+		buf[PAGE_SIZE-2] = '\n';
+		buf[PAGE_SIZE-1] = '\0';
+		ret = PAGE_SIZE-1;
+	}
+
+	return ret;
+}
+
+static ssize_t set_frame_headroom(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+	ssize_t ret = 0;
+	unsigned long flags;
+	int frame_headroom = -1;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	ret = kstrtoint(buf, 0, &frame_headroom);
+	if (ret) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid value\n", __func__);
+		return -ENOENT;
+	}
+
+	if ((frame_headroom < 10) || (frame_headroom > 100)) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid headroom value (%d)\n", __func__, frame_headroom);
+		return -ENOENT;
+	}
+
+	spin_lock_irqsave(&platform->frame_pacing.lock, flags);
+	platform->frame_pacing.headroom = frame_headroom;
+	spin_unlock_irqrestore(&platform->frame_pacing.lock, flags);
+
+	return count;
+}
+#endif /* CONFIG_MALI_DVFS_FRAME_PACING */
+
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+static ssize_t show_fence_boost_clock(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	ssize_t ret = 0;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	ret += snprintf(buf+ret, PAGE_SIZE-ret, "%d (boosts %d)", platform->fence_boost.clock,
+			platform->fence_boost.nr_boosts);
+
+	if (ret < PAGE_SIZE - 1) {
+		ret += snprintf(buf+ret, PAGE_SIZE-ret, "\n");
+	} else {
+		buf[PAGE_SIZE-2] = '\n';
+		buf[PAGE_SIZE-1] = '\0';
+		ret = PAGE_SIZE-1;
+	}
+
+	return ret;
+}
+
+static ssize_t set_fence_boost_clock(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+	ssize_t ret = 0;
+	int clock = -1;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	ret = kstrtoint(buf, 0, &clock);
+	if (ret) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid value\n", __func__);
+		return -ENOENT;
+	}
+
+	if (clock && gpu_dvfs_get_level(clock) < 0) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid clock value (%d)\n", __func__, clock);
+		return -ENOENT;
+	}
+
+	WRITE_ONCE(platform->fence_boost.clock, clock);
+
+	return count;
+}
+#endif /* CONFIG_MALI_DVFS_FENCE_BOOST */
+
 static ssize_t show_wakeup_lock(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	ssize_t ret = 0;
@@ -1384,6 +1545,13 @@ DEVICE_ATTR(down_staycount, S_IRUGO|S_IWUSR, show_down_staycount, set_down_stayc
 DEVICE_ATTR(highspeed_clock, S_IRUGO|S_IWUSR, show_highspeed_clock, set_highspeed_clock);
 DEVICE_ATTR(highspeed_load, S_IRUGO|S_IWUSR, show_highspeed_load, set_highspeed_load);
 DEVICE_ATTR(highspeed_delay, S_IRUGO|S_IWUSR, show_highspeed_delay, set_highspeed_delay);
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+DEVICE_ATTR(frame_period, S_IRUGO|S_IWUSR, show_frame_period, set_frame_period);
+DEVICE_ATTR(frame_headroom, S_IRUGO|S_IWUSR, show_frame_headroom, set_frame_headroom);
+#endif
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+DEVICE_ATTR(fence_boost_clock, S_IRUGO|S_IWUSR, show_fence_boost_clock, set_fence_boost_clock);
+#endif
 DEVICE_ATTR(wakeup_lock, S_IRUGO|S_IWUSR, show_wakeup_lock, set_wakeup_lock);
 DEVICE_ATTR(polling_speed, S_IRUGO|S_IWUSR, show_polling_speed, set_polling_speed);
 DEVICE_ATTR(tmu, S_IRUGO|S_IWUSR, show_tmu, set_tmu_control);
@@ -2010,6 +2178,25 @@ int gpu_create_sysfs_file(struct device *dev)
 		goto out;
 	}
 
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	if (device_create_file(dev, &dev_attr_frame_period)) {
+		GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "couldn't create sysfs file [frame_period]\n");
+		goto out;
+	}
+
+	if (device_create_file(dev, &dev_attr_frame_headroom)) {
+		GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "couldn't create sysfs file [frame_headroom]\n");
+		goto out;
+	}
+#endif
+
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	if (device_create_file(dev, &dev_attr_fence_boost_clock)) {
+		GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "couldn't create sysfs file [fence_boost_clock]\n");
+		goto out;
+	}
+#endif
+
 	if (device_create_file(dev, &dev_attr_wakeup_lock)) {
 		GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "couldn't create sysfs file [wakeup_lock]\n");
 		goto out;
@@ -2125,6 +2312,13 @@ void gpu_remove_sysfs_file(struct device *dev)
 	device_remove_file(dev, &dev_attr_highspeed_clock);
 	device_remove_file(dev, &dev_attr_highspeed_load);
 	device_remove_file(dev, &dev_attr_highspeed_delay);
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	device_remove_file(dev, &dev_attr_frame_period);
+	device_remove_file(dev, &dev_attr_frame_headroom);
+#endif
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	device_remove_file(dev, &dev_attr_fence_boost_clock);
+#endif
 	device_remove_file(dev, &dev_attr_wakeup_lock);
 	device_remove_file(dev, &dev_attr_polling_speed);
 	device_remove_file(dev, &dev_attr_tmu);
@@ -21,6 +21,10 @@
 #include <soc/samsung/asv-exynos.h>
 #endif
 #include <linux/version.h>
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+#include <linux/sync_file.h>
+#include <mali_kbase_fence.h>
+#endif
 
 #include "mali_kbase_platform.h"
 #include "gpu_control.h"
@@ -253,6 +257,76 @@ int gpu_dvfs_boost_lock(gpu_dvfs_boost_command boost_command)
 	return 0;
 }
 
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+static void gpu_dvfs_fence_boost_release(struct work_struct *work)
+{
+	gpu_dvfs_clock_lock(GPU_DVFS_MIN_UNLOCK, FENCE_BOOST_LOCK, 0);
+	GPU_LOG(DVFS_DEBUG, DUMMY, 0u, 0u, "%s: fence boost released\n", __func__);
+}
+
+/**
+ * gpu_dvfs_fence_boost() - Boost the GPU for a late display fence
+ * @sync_file: Acquire fence the display has been waiting on for too long
+ *
+ * Called by the display driver from process context. If @sync_file will be
+ * signaled by a Mali job, the GPU is min locked at fence_boost_clock and MIF
+ * is raised to the matching level of the DVFS table for
+ * G3D_FENCE_BOOST_DURATION_MS. Calling it again while boosted extends the
+ * boost. The baseline clock chosen by the governor is left alone.
+ *
+ * Return: 0 if the GPU got boosted, -ENOENT if @sync_file is not a GPU fence
+ * or boosting is disabled.
+ */
+int gpu_dvfs_fence_boost(struct sync_file *sync_file)
+{
+	struct kbase_device *kbdev = pkbdev;
+	struct exynos_context *platform;
+	pid_t tgid;
+	int clock;
+
+	if (!kbdev || !sync_file)
+		return -ENOENT;
+
+	platform = (struct exynos_context *) kbdev->platform_context;
+	if (!platform || !platform->dvfs_status)
+		return -ENOENT;
+
+	clock = READ_ONCE(platform->fence_boost.clock);
+	if (!clock)
+		return -ENOENT;
+
+	tgid = kbase_fence_owner_tgid(kbdev, sync_file->fence);
+	if (!tgid)
+		return -ENOENT;
+
+	if (gpu_dvfs_clock_lock(GPU_DVFS_MIN_LOCK, FENCE_BOOST_LOCK, clock))
+		return -ENOENT;
+#ifdef CONFIG_MALI_PM_QOS
+	gpu_pm_qos_command(platform, GPU_CONTROL_PM_QOS_FENCE_BOOST_SET);
+#endif /* CONFIG_MALI_PM_QOS */
+	mod_delayed_work(system_freezable_wq, &platform->fence_boost.release_work,
+			msecs_to_jiffies(G3D_FENCE_BOOST_DURATION_MS));
+	platform->fence_boost.nr_boosts++;
+
+	GPU_LOG(DVFS_DEBUG, DUMMY, 0u, 0u, "%s: display waits on a fence of tgid %d, boost to %d\n",
+			__func__, tgid, clock);
+
+	return 0;
+}
+EXPORT_SYMBOL(gpu_dvfs_fence_boost);
+
+void gpu_dvfs_fence_boost_init(struct exynos_context *platform)
+{
+	INIT_DELAYED_WORK(&platform->fence_boost.release_work, gpu_dvfs_fence_boost_release);
+}
+
+void gpu_dvfs_fence_boost_term(struct exynos_context *platform)
+{
+	if (cancel_delayed_work_sync(&platform->fence_boost.release_work))
+		gpu_dvfs_fence_boost_release(&platform->fence_boost.release_work.work);
+}
+#endif /* CONFIG_MALI_DVFS_FENCE_BOOST */
+
 int gpu_dvfs_clock_lock(gpu_dvfs_lock_command lock_command, gpu_dvfs_lock_type lock_type, int clock)
 {
 	struct kbase_device *kbdev = pkbdev;
@@ -33,6 +33,9 @@ static int gpu_dvfs_governor_interactive(struct exynos_context *platform, int ut
 static int gpu_dvfs_governor_static(struct exynos_context *platform, int utilization);
 static int gpu_dvfs_governor_booster(struct exynos_context *platform, int utilization);
 static int gpu_dvfs_governor_dynamic(struct exynos_context *platform, int utilization);
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+static int gpu_dvfs_governor_frame_pacing(struct exynos_context *platform, int utilization);
+#endif
 
 static gpu_dvfs_governor_info governor_info[G3D_MAX_GOVERNOR_NUM] = {
 	{
@@ -65,6 +68,14 @@ static gpu_dvfs_governor_info governor_info[G3D_MAX_GOVERNOR_NUM] = {
 		gpu_dvfs_governor_dynamic,
 		NULL
 	},
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	{
+		G3D_DVFS_GOVERNOR_FRAME_PACING,
+		"FramePacing",
+		gpu_dvfs_governor_frame_pacing,
+		NULL
+	},
+#endif
 };
 
 void gpu_dvfs_update_start_clk(int governor_type, int clk)
@@ -275,6 +286,128 @@ static int gpu_dvfs_governor_dynamic(struct exynos_context *platform, int utiliz
 	return 0;
 }
 
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+#define G3D_FRAME_PACING_PERIOD_US	16667
+#define G3D_FRAME_PACING_HEADROOM	90
+#define G3D_FRAME_PACING_BOOST_COUNT	3
+
+void gpu_dvfs_frame_pacing_init(struct exynos_context *platform)
+{
+	spin_lock_init(&platform->frame_pacing.lock);
+	platform->frame_pacing.period_us = G3D_FRAME_PACING_PERIOD_US;
+	platform->frame_pacing.headroom = G3D_FRAME_PACING_HEADROOM;
+}
+
+/*
+ * Called from the job scheduler with hwaccess_lock held for every atom
+ * that ran on the GPU. A frame is taken to end when a fragment atom
+ * completes. Its GPU time runs from the first job start after the
+ * previous frame ended, or from the previous frame end if the GPU was
+ * still busy, so vertex work overlapping the fragment work of the
+ * previous frame is not counted twice. The work is kept as an average of
+ * busy time times clock, which stays valid across clock changes.
+ */
+void gpu_dvfs_frame_pacing_job_done(void *dev, void *atom, ktime_t *end_timestamp)
+{
+	struct kbase_device *kbdev = (struct kbase_device *)dev;
+	struct kbase_jd_atom *katom = (struct kbase_jd_atom *)atom;
+	struct exynos_context *platform = (struct exynos_context *)kbdev->platform_context;
+	ktime_t begin;
+	u64 busy_ns, work;
+	unsigned long flags;
+
+	if (!platform || platform->governor_type != G3D_DVFS_GOVERNOR_FRAME_PACING)
+		return;
+
+	spin_lock_irqsave(&platform->frame_pacing.lock, flags);
+
+	if (!ktime_to_ns(platform->frame_pacing.frame_start) ||
+			ktime_before(katom->start_timestamp, platform->frame_pacing.frame_start))
+		platform->frame_pacing.frame_start = katom->start_timestamp;
+
+	if (!(katom->core_req & BASE_JD_REQ_FS))
+		goto out;
+
+	begin = platform->frame_pacing.frame_start;
+	if (ktime_before(begin, platform->frame_pacing.last_frame_end))
+		begin = platform->frame_pacing.last_frame_end;
+
+	busy_ns = ktime_after(*end_timestamp, begin) ?
+		ktime_to_ns(ktime_sub(*end_timestamp, begin)) : 0;
+	work = busy_ns * platform->cur_clock;
+
+	if (platform->frame_pacing.work)
+		platform->frame_pacing.work = (platform->frame_pacing.work * 3 + work) >> 2;
+	else
+		platform->frame_pacing.work = work;
+
+	if (busy_ns > (u64)platform->frame_pacing.period_us * NSEC_PER_USEC)
+		platform->frame_pacing.nr_missed++;
+	platform->frame_pacing.nr_frames++;
+
+	platform->frame_pacing.last_frame_end = *end_timestamp;
+	platform->frame_pacing.frame_start = ktime_set(0, 0);
+out:
+	spin_unlock_irqrestore(&platform->frame_pacing.lock, flags);
+}
+
+/*
+ * Pick the lowest clock that fits the average frame work into headroom
+ * percent of the frame period. A missed deadline steps two levels up at
+ * once and forbids stepping down for the next few windows. Without any
+ * frame in the last window, e.g. compute only work, fall back to the
+ * interactive governor.
+ */
+static int gpu_dvfs_governor_frame_pacing(struct exynos_context *platform, int utilization)
+{
+	int max_clock_lev = gpu_dvfs_get_level(platform->gpu_max_clock);
+	int min_clock_lev = gpu_dvfs_get_level(platform->gpu_min_clock);
+	int nr_frames, nr_missed, level;
+	u64 work, budget, required;
+
+	DVFS_ASSERT(platform);
+
+	spin_lock(&platform->frame_pacing.lock);
+	work = platform->frame_pacing.work;
+	nr_frames = platform->frame_pacing.nr_frames;
+	nr_missed = platform->frame_pacing.nr_missed;
+	platform->frame_pacing.nr_frames = 0;
+	platform->frame_pacing.nr_missed = 0;
+	spin_unlock(&platform->frame_pacing.lock);
+
+	if (!nr_frames) {
+		platform->frame_pacing.boost_count = 0;
+		return gpu_dvfs_governor_interactive(platform, utilization);
+	}
+
+	if (platform->table[max_clock_lev].clock > platform->gpu_max_clock_limit)
+		max_clock_lev = gpu_dvfs_get_level(platform->gpu_max_clock_limit);
+
+	budget = (u64)platform->frame_pacing.period_us * NSEC_PER_USEC *
+		platform->frame_pacing.headroom / 100;
+	required = div64_u64(work, max_t(u64, budget, 1));
+
+	for (level = min_clock_lev; level > max_clock_lev; level--)
+		if (platform->table[level].clock >= required)
+			break;
+
+	if (nr_missed) {
+		level = min(level, platform->step - 2);
+		platform->frame_pacing.boost_count = G3D_FRAME_PACING_BOOST_COUNT;
+	} else if (platform->frame_pacing.boost_count) {
+		level = min(level, platform->step);
+		platform->frame_pacing.boost_count--;
+	}
+
+	platform->step = clamp(level, max_clock_lev, min_clock_lev);
+	platform->down_requirement = platform->table[platform->step].down_staycount;
+
+	DVFS_ASSERT((platform->step >= max_clock_lev) && (platform->step <= min_clock_lev));
+
+	return 0;
+}
+#endif /* CONFIG_MALI_DVFS_FRAME_PACING */
+
 static int gpu_dvfs_decide_next_governor(struct exynos_context *platform)
 {
 	return 0;
@@ -24,6 +24,9 @@ typedef enum {
 	G3D_DVFS_GOVERNOR_STATIC,
 	G3D_DVFS_GOVERNOR_BOOSTER,
 	G3D_DVFS_GOVERNOR_DYNAMIC,
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	G3D_DVFS_GOVERNOR_FRAME_PACING,
+#endif
 	G3D_MAX_GOVERNOR_NUM,
 } gpu_governor_type;
 
@@ -34,5 +37,9 @@ void *gpu_dvfs_get_governor_info(void);
 int gpu_dvfs_decide_next_freq(struct kbase_device *kbdev, int utilization);
 int gpu_dvfs_governor_setting(struct exynos_context *platform, int governor_type);
 int gpu_dvfs_governor_init(struct kbase_device *kbdev);
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+void gpu_dvfs_frame_pacing_init(struct exynos_context *platform);
+void gpu_dvfs_frame_pacing_job_done(void *dev, void *atom, ktime_t *end_timestamp);
+#endif
 
 #endif /* _GPU_DVFS_GOVERNOR_H_ */
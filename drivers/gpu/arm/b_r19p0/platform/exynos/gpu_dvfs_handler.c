@@ -63,6 +63,9 @@ int gpu_dvfs_handler_init(struct kbase_device *kbdev)
 	if (!platform->dvfs_status)
 		platform->dvfs_status = true;
 
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	gpu_dvfs_fence_boost_init(platform);
+#endif
 
 #ifdef CONFIG_MALI_PM_QOS
 	gpu_pm_qos_command(platform, GPU_CONTROL_PM_QOS_INIT);
@@ -80,6 +83,10 @@ int gpu_dvfs_handler_deinit(struct kbase_device *kbdev)
 
 	DVFS_ASSERT(platform);
 
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	gpu_dvfs_fence_boost_term(platform);
+#endif
+
 	if (platform->dvfs_status)
 		platform->dvfs_status = false;
 
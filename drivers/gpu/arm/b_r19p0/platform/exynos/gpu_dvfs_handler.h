@@ -45,6 +45,12 @@ int gpu_dvfs_handler_deinit(struct kbase_device *kbdev);
 int gpu_set_target_clk_vol(int clk, bool pending_is_allowed);
 int gpu_set_target_clk_vol_pending(int clk);
 int gpu_dvfs_boost_lock(gpu_dvfs_boost_command boost_command);
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+struct sync_file;
+int gpu_dvfs_fence_boost(struct sync_file *sync_file);
+void gpu_dvfs_fence_boost_init(struct exynos_context *platform);
+void gpu_dvfs_fence_boost_term(struct exynos_context *platform);
+#endif
 int gpu_dvfs_clock_lock(gpu_dvfs_lock_command lock_command, gpu_dvfs_lock_type lock_type, int clock);
 void gpu_dvfs_timer_control(bool enable);
 int gpu_dvfs_on_off(bool enable);
@@ -72,6 +78,11 @@ int gpu_dvfs_calculate_env_data_ppmu(struct kbase_device *kbdev);
 int gpu_dvfs_utilization_init(struct kbase_device *kbdev);
 int gpu_dvfs_utilization_deinit(struct kbase_device *kbdev);
 
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+/* How long a late display fence keeps the GPU and MIF boosted */
+#define G3D_FENCE_BOOST_DURATION_MS	32
+#endif
+
 /* gpu_pmqos.c */
 typedef enum {
 	GPU_CONTROL_PM_QOS_INIT = 0,
@@ -80,6 +91,9 @@ typedef enum {
 	GPU_CONTROL_PM_QOS_RESET,
 	GPU_CONTROL_PM_QOS_EGL_SET,
 	GPU_CONTROL_PM_QOS_EGL_RESET,
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	GPU_CONTROL_PM_QOS_FENCE_BOOST_SET,
+#endif
 } gpu_pmqos_state;
 
 int gpu_pm_qos_command(struct exynos_context *platform, gpu_pmqos_state state);
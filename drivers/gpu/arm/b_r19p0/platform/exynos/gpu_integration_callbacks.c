@@ -80,6 +80,10 @@ extern int sec_therm_get_ap_temperature(void);
 extern struct pm_qos_request exynos5_g3d_mif_min_qos;
 #endif
 
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+#include "gpu_dvfs_governor.h"
+#endif
+
 extern int gpu_register_dump(void);
 
 void gpu_create_context(void *ctx)
@@ -659,6 +663,20 @@ int gpu_pm_get_dvfs_utilisation(struct kbase_device *kbdev, int *util_gl_share,
 }
 #endif /* CONFIG_MALI_DVFS */
 
+#ifdef CONFIG_MALI_HWCNT_SAMPLER
+static void gpu_get_dvfs_status(void *dev, u32 *clock, u32 *utilization)
+{
+	struct kbase_device *kbdev = (struct kbase_device *)dev;
+	struct exynos_context *platform = (struct exynos_context *)kbdev->platform_context;
+
+	if (!platform)
+		return;
+
+	*clock = platform->cur_clock;
+	*utilization = platform->env_data.utilization;
+}
+#endif
+
 /* MALI_SEC_INTEGRATION */
 static bool gpu_mem_profile_check_kctx(void *ctx)
 {
@@ -711,6 +729,16 @@ struct kbase_vendor_callbacks exynos_callbacks = {
 	.register_dump = NULL,
 	.update_status = NULL,
 #endif
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	.frame_pacing_job_done = gpu_dvfs_frame_pacing_job_done,
+#else
+	.frame_pacing_job_done = NULL,
+#endif
+#ifdef CONFIG_MALI_HWCNT_SAMPLER
+	.get_dvfs_status = gpu_get_dvfs_status,
+#else
+	.get_dvfs_status = NULL,
+#endif
 };
 
 uintptr_t gpu_get_callbacks(void)
@@ -60,6 +60,8 @@ struct kbase_vendor_callbacks {
 	void (*update_status)(void *dev, char *str, u32 val);
 	bool (*mem_profile_check_kctx)(void *ctx);
 	int (*register_dump)(void);
+	void (*frame_pacing_job_done)(void *dev, void *atom, ktime_t *end_timestamp);
+	void (*get_dvfs_status)(void *dev, u32 *clock, u32 *utilization);
 };
 
 #endif /* _SEC_INTEGRATION_H_ */
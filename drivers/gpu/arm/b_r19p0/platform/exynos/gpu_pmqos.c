@@ -45,6 +45,10 @@ struct pm_qos_request exynos5_g3d_cpu_cluster2_min_qos;
 struct pm_qos_request exynos5_g3d_cpu_cluster0_max_qos;
 #endif
 
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+struct pm_qos_request exynos5_g3d_mif_fence_boost_qos;
+#endif
+
 extern struct kbase_device *pkbdev;
 
 #ifdef CONFIG_MALI_PM_QOS
@@ -78,6 +82,9 @@ int gpu_pm_qos_command(struct exynos_context *platform, gpu_pmqos_state state)
 #ifdef CONFIG_MALI_SUSTAINABLE_OPT
 		pm_qos_add_request(&exynos5_g3d_cpu_cluster0_max_qos, PM_QOS_CLUSTER0_FREQ_MAX, PM_QOS_CLUSTER0_FREQ_MAX_DEFAULT_VALUE);
 #endif
+#endif
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+		pm_qos_add_request(&exynos5_g3d_mif_fence_boost_qos, PM_QOS_BUS_THROUGHPUT, 0);
 #endif
 		for (idx = 0; idx < platform->table_size; idx++)
 			platform->save_cpu_max_freq[idx] = platform->table[idx].cpu_big_max_freq;
@@ -101,6 +108,9 @@ int gpu_pm_qos_command(struct exynos_context *platform, gpu_pmqos_state state)
 #ifdef CONFIG_MALI_SUSTAINABLE_OPT
 		pm_qos_remove_request(&exynos5_g3d_cpu_cluster0_max_qos);
 #endif
+#endif
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+		pm_qos_remove_request(&exynos5_g3d_mif_fence_boost_qos);
 #endif
 		platform->is_pm_qos_init = false;
 		break;
@@ -197,6 +207,20 @@ int gpu_pm_qos_command(struct exynos_context *platform, gpu_pmqos_state state)
 		for (idx = 0; idx < platform->table_size; idx++)
 			platform->table[idx].cpu_big_max_freq = platform->save_cpu_max_freq[idx];
 		break;
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	case GPU_CONTROL_PM_QOS_FENCE_BOOST_SET:
+		if (!platform->is_pm_qos_init) {
+			GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "%s: PM QOS ERROR : pm_qos deinit -> fence_boost_set\n", __func__);
+			return -ENOENT;
+		}
+		idx = gpu_dvfs_get_level(platform->fence_boost.clock);
+		if (idx < 0)
+			return -EINVAL;
+		/* The request drops by itself together with the GPU lock */
+		pm_qos_update_request_timeout(&exynos5_g3d_mif_fence_boost_qos, platform->table[idx].mem_freq,
+				G3D_FENCE_BOOST_DURATION_MS * USEC_PER_MSEC);
+		break;
+#endif
 	default:
 		break;
 	}
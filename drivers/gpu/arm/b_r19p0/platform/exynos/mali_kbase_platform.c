@@ -266,6 +266,10 @@ static int gpu_dvfs_update_config_data_from_dt(struct kbase_device *kbdev)
 		platform->governor_type = G3D_DVFS_GOVERNOR_BOOSTER;
 	} else if (!strncmp("dynamic", of_string, strlen("dynamic"))) {
 		platform->governor_type = G3D_DVFS_GOVERNOR_DYNAMIC;
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	} else if (!strncmp("frame_pacing", of_string, strlen("frame_pacing"))) {
+		platform->governor_type = G3D_DVFS_GOVERNOR_FRAME_PACING;
+#endif
 	} else {
 		platform->governor_type = G3D_DVFS_GOVERNOR_DEFAULT;
 	}
@@ -447,6 +451,9 @@ static int gpu_context_init(struct kbase_device *kbdev)
 	mutex_init(&platform->gpu_clock_lock);
 	mutex_init(&platform->gpu_dvfs_handler_lock);
 	spin_lock_init(&platform->gpu_dvfs_spinlock);
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	gpu_dvfs_frame_pacing_init(platform);
+#endif
 
 #if (defined(CONFIG_SCHED_EMS) || defined(CONFIG_SCHED_EHMP) || defined(CONFIG_SCHED_HMP))
 	mutex_init(&platform->gpu_sched_hmp_lock);
@@ -92,6 +92,9 @@ typedef enum {
 	PMQOS_LOCK,
 #ifdef CONFIG_MALI_ASV_CALIBRATION_SUPPORT
 	ASV_CALI_LOCK,
+#endif
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	FENCE_BOOST_LOCK,
 #endif
 	NUMBER_LOCK
 } gpu_dvfs_lock_type;
@@ -210,6 +213,28 @@ struct exynos_context {
 		int highspeed_delay;
 		int delay_count;
 	} interactive;
+#ifdef CONFIG_MALI_DVFS_FRAME_PACING
+	/* For the frame pacing governor */
+	struct {
+		spinlock_t lock;
+		int period_us;
+		int headroom;
+		int boost_count;
+		ktime_t frame_start;
+		ktime_t last_frame_end;
+		u64 work;
+		int nr_frames;
+		int nr_missed;
+	} frame_pacing;
+#endif
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+	/* For the boost on late display fences */
+	struct {
+		int clock;
+		int nr_boosts;
+		struct delayed_work release_work;
+	} fence_boost;
+#endif
 #ifdef CONFIG_CPU_THERMAL_IPA
 	int norm_utilisation;
 	int freq_for_normalisation;
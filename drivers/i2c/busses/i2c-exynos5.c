@@ -728,7 +728,9 @@ static int exynos5_i2c_xfer_msg(struct exynos5_i2c *i2c,
 
 		i2c_auto_conf &= ~HSI2C_READ_WRITE;
 
-		i2c_int_en |= HSI2C_INT_TX_ALMOSTEMPTY_EN;
+		/* a write that fits the prefilled FIFO needs no refill */
+		if (msgs->len > EXYNOS5_FIFO_SIZE)
+			i2c_int_en |= HSI2C_INT_TX_ALMOSTEMPTY_EN;
 	}
 
 	if (operation_mode == HSI2C_INTERRUPT)
@@ -750,10 +752,28 @@ static int exynos5_i2c_xfer_msg(struct exynos5_i2c *i2c,
 
 	if (operation_mode == HSI2C_INTERRUPT) {
 		unsigned int cpu = raw_smp_processor_id();
+
+		/*
+		 * Fill the TX FIFO before the master runs instead of from
+		 * the first TX_ALMOSTEMPTY interrupt, so that short writes,
+		 * like the register address of a touch or sensor read, take
+		 * a single TRANSFER_DONE interrupt.
+		 */
+		if (!(msgs->flags & I2C_M_RD)) {
+			while (i2c->msg_ptr < msgs->len &&
+			       i2c->msg_ptr < EXYNOS5_FIFO_SIZE)
+				writel(msgs->buf[i2c->msg_ptr++],
+				       i2c->regs + HSI2C_TX_DATA);
+		}
+
 		i2c_int_en |= HSI2C_INT_CHK_TRANS_STATE | HSI2C_INT_TRANSFER_DONE;
 		writel(i2c_int_en, i2c->regs + HSI2C_INT_ENABLE);
 
-		irq_force_affinity(i2c->irq, cpumask_of(cpu));
+		/* moving the irq takes the desc lock, only do it on a change */
+		if (cpu != i2c->irq_cpu) {
+			irq_force_affinity(i2c->irq, cpumask_of(cpu));
+			i2c->irq_cpu = cpu;
+		}
 		enable_irq(i2c->irq);
 	} else {
 		writel(HSI2C_INT_TRANSFER_DONE, i2c->regs + HSI2C_INT_ENABLE);
@@ -1171,6 +1191,7 @@ static int exynos5_i2c_probe(struct platform_device *pdev)
 			ret = -EINVAL;
 			goto err_clk1;
 		}
+		i2c->irq_cpu = -1;
 
 		ret = devm_request_irq(&pdev->dev, i2c->irq,
 					exynos5_i2c_irq, 0, dev_name(&pdev->dev), i2c);
@@ -23,6 +23,7 @@ struct exynos5_i2c {
 	unsigned int		msg_len;
 
 	unsigned int		irq;
+	int			irq_cpu;	/* last cpu the irq was forced to */
 
 	void __iomem		*regs;
 	struct clk		*clk;
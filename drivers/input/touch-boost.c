@@ -0,0 +1,172 @@
+/*
+ * Boost the CPUs from the input core when a touch starts
+ *
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * The boost is raised from the event path of the touch device itself,
+ * before the event reaches evdev, so that the frame the touch causes is
+ * not rendered at idle frequencies while userspace reacts to it.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/slab.h>
+#include <linux/input.h>
+#include <linux/workqueue.h>
+#include <linux/pm_qos.h>
+#include <linux/ehmp.h>
+
+/* EHMP global boost, in percent, and its hold and linear decay times */
+static unsigned int gb_boost = 50;
+module_param(gb_boost, uint, 0644);
+static unsigned int gb_hold_ms = 100;
+module_param(gb_hold_ms, uint, 0644);
+static unsigned int gb_decay_ms = 200;
+module_param(gb_decay_ms, uint, 0644);
+
+/* Minimum frequencies in kHz of the two clusters, 0 leaves one alone */
+static unsigned int little_min_freq;
+module_param(little_min_freq, uint, 0644);
+static unsigned int big_min_freq;
+module_param(big_min_freq, uint, 0644);
+static unsigned int freq_ms = 300;
+module_param(freq_ms, uint, 0644);
+
+static struct gb_qos_request touch_gb_req = {
+	.name = "touch_boost",
+};
+
+static struct pm_qos_request little_min_qos;
+static struct pm_qos_request big_min_qos;
+
+/*
+ * PM QoS updates run the cpufreq notifiers and may sleep, so they can not
+ * be done under the event lock of the input device.
+ */
+static void touch_boost_freq_work_func(struct work_struct *work)
+{
+	if (little_min_freq)
+		pm_qos_update_request_timeout(&little_min_qos, little_min_freq,
+				freq_ms * USEC_PER_MSEC);
+	if (big_min_freq)
+		pm_qos_update_request_timeout(&big_min_qos, big_min_freq,
+				freq_ms * USEC_PER_MSEC);
+}
+static DECLARE_WORK(touch_boost_freq_work, touch_boost_freq_work_func);
+
+static void touch_boost_kick(void)
+{
+	if (gb_boost)
+		gb_qos_update_request_timeout(&touch_gb_req, gb_boost,
+				gb_hold_ms, gb_decay_ms);
+
+	if (little_min_freq || big_min_freq)
+		queue_work(system_highpri_wq, &touch_boost_freq_work);
+}
+
+static void touch_boost_event(struct input_handle *handle,
+		unsigned int type, unsigned int code, int value)
+{
+	/* only a new contact boosts, the decay covers the rest of it */
+	if (type == EV_ABS && code == ABS_MT_TRACKING_ID && value >= 0)
+		touch_boost_kick();
+	else if (type == EV_KEY && code == BTN_TOUCH && value)
+		touch_boost_kick();
+}
+
+static int touch_boost_connect(struct input_handler *handler,
+		struct input_dev *dev, const struct input_device_id *id)
+{
+	struct input_handle *handle;
+	int ret;
+
+	handle = kzalloc(sizeof(*handle), GFP_KERNEL);
+	if (!handle)
+		return -ENOMEM;
+
+	handle->dev = dev;
+	handle->handler = handler;
+	handle->name = "touch_boost";
+
+	ret = input_register_handle(handle);
+	if (ret)
+		goto err_free;
+
+	ret = input_open_device(handle);
+	if (ret)
+		goto err_unregister;
+
+	return 0;
+
+err_unregister:
+	input_unregister_handle(handle);
+err_free:
+	kfree(handle);
+	return ret;
+}
+
+static void touch_boost_disconnect(struct input_handle *handle)
+{
+	input_close_device(handle);
+	input_unregister_handle(handle);
+	kfree(handle);
+}
+
+static const struct input_device_id touch_boost_ids[] = {
+	/* multi-touch screens */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT |
+			 INPUT_DEVICE_ID_MATCH_ABSBIT,
+		.evbit = { BIT_MASK(EV_ABS) },
+		.absbit = { [BIT_WORD(ABS_MT_POSITION_X)] =
+			    BIT_MASK(ABS_MT_POSITION_X) |
+			    BIT_MASK(ABS_MT_POSITION_Y) },
+	},
+	/* single touch screens and touchpads */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_KEYBIT |
+			 INPUT_DEVICE_ID_MATCH_ABSBIT,
+		.keybit = { [BIT_WORD(BTN_TOUCH)] = BIT_MASK(BTN_TOUCH) },
+		.absbit = { [BIT_WORD(ABS_X)] =
+			    BIT_MASK(ABS_X) | BIT_MASK(ABS_Y) },
+	},
+	{ },
+};
+MODULE_DEVICE_TABLE(input, touch_boost_ids);
+
+static struct input_handler touch_boost_handler = {
+	.event		= touch_boost_event,
+	.connect	= touch_boost_connect,
+	.disconnect	= touch_boost_disconnect,
+	.name		= "touch_boost",
+	.id_table	= touch_boost_ids,
+};
+
+static int __init touch_boost_init(void)
+{
+	pm_qos_add_request(&little_min_qos, PM_QOS_CLUSTER0_FREQ_MIN, 0);
+	pm_qos_add_request(&big_min_qos, PM_QOS_CLUSTER1_FREQ_MIN, 0);
+
+	return input_register_handler(&touch_boost_handler);
+}
+
+static void __exit touch_boost_exit(void)
+{
+	input_unregister_handler(&touch_boost_handler);
+	cancel_work_sync(&touch_boost_freq_work);
+	gb_qos_update_request(&touch_gb_req, 0);
+	pm_qos_remove_request(&little_min_qos);
+	pm_qos_remove_request(&big_min_qos);
+}
+
+module_init(touch_boost_init);
+module_exit(touch_boost_exit);
+
+MODULE_DESCRIPTION("Touch input CPU boost");
+MODULE_LICENSE("GPL");
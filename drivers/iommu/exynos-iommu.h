@@ -359,6 +359,9 @@ struct exynos_vm_region {
 	u32 dummy_size;
 };
 
+#define IOVM_CACHE_ORDERS	14	/* regions up to 32MB */
+#define IOVM_CACHE_DEPTH	8
+
 struct exynos_iovmm {
 	struct iommu_domain *domain;	/* iommu domain for this iovmm */
 	size_t iovm_size;		/* iovm bitmap size per plane */
@@ -375,6 +378,11 @@ struct exynos_iovmm {
 	const char *domain_name;
 	struct iommu_group *group;
 	struct exynos_iommu_event_log log;
+	spinlock_t cache_lock;		/* lock for the region cache */
+	struct exynos_vm_region *cache[IOVM_CACHE_ORDERS][IOVM_CACHE_DEPTH];
+	unsigned int cache_count[IOVM_CACHE_ORDERS];
+	unsigned long cache_hit;
+	unsigned long cache_miss;
 };
 
 void exynos_sysmmu_tlb_invalidate(struct iommu_domain *domain, dma_addr_t start,
@@ -26,6 +26,91 @@
 
 #define sg_physically_continuous(sg) (sg_next(sg) == NULL)
 
+/*
+ * Freed regions without section offset are kept in a small cache bucketed by
+ * the order of their size instead of being returned to the bitmap. Media IPs
+ * map and unmap buffers of the same sizes every frame and a region of the
+ * exact size is reused without searching the bitmap or allocating a new
+ * exynos_vm_region. The cache is drained when the bitmap runs out of space.
+ */
+static struct exynos_vm_region *iovm_cache_get(struct exynos_iovmm *vmm,
+					       u32 size)
+{
+	unsigned int order = get_order(size);
+	struct exynos_vm_region *region;
+	unsigned int i;
+
+	if (order >= IOVM_CACHE_ORDERS)
+		return NULL;
+
+	spin_lock(&vmm->cache_lock);
+	for (i = 0; i < vmm->cache_count[order]; i++) {
+		region = vmm->cache[order][i];
+		if (region->size == size) {
+			vmm->cache[order][i] =
+				vmm->cache[order][--vmm->cache_count[order]];
+			vmm->cache_hit++;
+			spin_unlock(&vmm->cache_lock);
+			return region;
+		}
+	}
+	vmm->cache_miss++;
+	spin_unlock(&vmm->cache_lock);
+
+	return NULL;
+}
+
+static bool iovm_cache_put(struct exynos_iovmm *vmm,
+			   struct exynos_vm_region *region)
+{
+	unsigned int order = get_order(region->size);
+	bool cached = false;
+
+	if (region->section_off || order >= IOVM_CACHE_ORDERS)
+		return false;
+
+	spin_lock(&vmm->cache_lock);
+	if (vmm->cache_count[order] < IOVM_CACHE_DEPTH) {
+		vmm->cache[order][vmm->cache_count[order]++] = region;
+		cached = true;
+	}
+	spin_unlock(&vmm->cache_lock);
+
+	return cached;
+}
+
+/* returns true if any region is returned to the bitmap */
+static bool iovm_cache_drain(struct exynos_iovmm *vmm)
+{
+	struct exynos_vm_region *region, *tmp;
+	unsigned int order;
+	LIST_HEAD(drain);
+
+	spin_lock(&vmm->cache_lock);
+	for (order = 0; order < IOVM_CACHE_ORDERS; order++) {
+		while (vmm->cache_count[order] > 0) {
+			region = vmm->cache[order][--vmm->cache_count[order]];
+			list_add(&region->node, &drain);
+		}
+	}
+	spin_unlock(&vmm->cache_lock);
+
+	if (list_empty(&drain))
+		return false;
+
+	spin_lock(&vmm->bitmap_lock);
+	list_for_each_entry(region, &drain, node)
+		bitmap_clear(vmm->vm_map,
+			(region->start - vmm->iova_start) >> PAGE_SHIFT,
+				region->size >> PAGE_SHIFT);
+	spin_unlock(&vmm->bitmap_lock);
+
+	list_for_each_entry_safe(region, tmp, &drain, node)
+		kfree(region);
+
+	return true;
+}
+
 /* alloc_iovm_region - Allocate IO virtual memory region
  * vmm: virtual memory allocator
  * size: total size to allocate vm region from @vmm.
@@ -49,7 +134,7 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 			size_t section_offset,
 			off_t page_offset)
 {
-	u32 index = 0;
+	u32 index;
 	u32 vstart;
 	u32 vsize;
 	unsigned long end, i;
@@ -63,6 +148,15 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 	align >>= PAGE_SHIFT;
 	section_offset >>= PAGE_SHIFT;
 
+	if (!section_offset) {
+		region = iovm_cache_get(vmm, vsize << PAGE_SHIFT);
+		if (region) {
+			vstart = (region->start & PAGE_MASK) + page_offset;
+			goto init_region;
+		}
+	}
+retry:
+	index = 0;
 	spin_lock(&vmm->bitmap_lock);
 again:
 	index = find_next_zero_bit(vmm->vm_map,
@@ -72,6 +166,8 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 		index = ALIGN(index, align);
 		if (index >= IOVM_NUM_PAGES(vmm->iovm_size)) {
 			spin_unlock(&vmm->bitmap_lock);
+			if (iovm_cache_drain(vmm))
+				goto retry;
 			return 0;
 		}
 
@@ -83,6 +179,8 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 
 	if (end >= IOVM_NUM_PAGES(vmm->iovm_size)) {
 		spin_unlock(&vmm->bitmap_lock);
+		if (iovm_cache_drain(vmm))
+			goto retry;
 		return 0;
 	}
 
@@ -106,6 +204,7 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 		return 0;
 	}
 
+init_region:
 	INIT_LIST_HEAD(&region->node);
 	region->start = vstart;
 	region->size = vsize << PAGE_SHIFT;
@@ -171,15 +270,18 @@ static void free_iovm_region(struct exynos_iovmm *vmm,
 	if (!region)
 		return;
 
+	SYSMMU_EVENT_LOG_IOVMM_UNMAP(IOVMM_TO_LOG(vmm),
+			region->start, region->start + region->size);
+
+	if (iovm_cache_put(vmm, region))
+		return;
+
 	spin_lock(&vmm->bitmap_lock);
 	bitmap_clear(vmm->vm_map,
 		(region->start - vmm->iova_start) >> PAGE_SHIFT,
 			region->size >> PAGE_SHIFT);
 	spin_unlock(&vmm->bitmap_lock);
 
-	SYSMMU_EVENT_LOG_IOVMM_UNMAP(IOVMM_TO_LOG(vmm),
-			region->start, region->start + region->size);
-
 	kfree(region);
 }
 
@@ -445,6 +547,113 @@ dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
 	return (dma_addr_t)ret;
 }
 
+static int iovmm_map_sg(struct exynos_iovmm *vmm, dma_addr_t addr,
+			struct scatterlist *sg, size_t size, int prot)
+{
+	size_t mapped_size = 0;
+	int ret;
+
+	do {
+		phys_addr_t phys = sg_phys(sg);
+		size_t len = sg->length;
+
+		/* if back to back sg entries are contiguous consolidate them */
+		while (sg_next(sg) &&
+		       sg_phys(sg) + sg->length == sg_phys(sg_next(sg))) {
+			len += sg_next(sg)->length;
+			sg = sg_next(sg);
+		}
+
+		len = PAGE_ALIGN(len);
+		if (len > (size - mapped_size))
+			len = size - mapped_size;
+
+		ret = iommu_map(vmm->domain, addr + mapped_size, phys, len, prot);
+		if (ret) {
+			iommu_unmap(vmm->domain, addr, mapped_size);
+			return ret;
+		}
+
+		mapped_size += len;
+	} while ((sg = sg_next(sg)) && (mapped_size < size));
+
+	if (mapped_size < size) {
+		iommu_unmap(vmm->domain, addr, mapped_size);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* iovmm_map_multi - map several buffers into a single IO virtual region
+ * dev: device that has IO virtual address space managed by IOVMM
+ * sgl: list of the first chunk of each buffer
+ * sizes: size in bytes of each buffer
+ * count: number of buffers in @sgl and @sizes
+ *
+ * Each buffer is placed at the page aligned address that follows the end of
+ * the previous buffer. The page table entries of all buffers are written
+ * before a single TLB invalidation of the whole region instead of one per
+ * buffer. The region is released with iovmm_unmap() of the returned address.
+ * Returns the start address of the region or minus error number.
+ */
+dma_addr_t iovmm_map_multi(struct device *dev, struct scatterlist **sgl,
+			   size_t *sizes, int count, int prot)
+{
+	struct exynos_iovmm *vmm = exynos_get_iovmm(dev);
+	struct exynos_vm_region *region;
+	dma_addr_t start, addr;
+	size_t size = 0;
+	int ret = 0;
+	int i;
+
+	if (vmm == NULL) {
+		dev_err(dev, "%s: IOVMM not found\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < count; i++)
+		size += PAGE_ALIGN(sizes[i]);
+
+	start = alloc_iovm_region(vmm, size, 0, 0);
+	if (!start) {
+		dev_err(dev, "%s: Not enough IOVM space to allocate %#zx\n",
+			__func__, size);
+		return -ENOMEM;
+	}
+
+	for (i = 0, addr = start; i < count; i++) {
+		ret = iovmm_map_sg(vmm, addr, sgl[i], PAGE_ALIGN(sizes[i]),
+				   prot);
+		if (ret) {
+			dev_err(dev, "%s: failed to map buffer %d (%d)\n",
+				__func__, i, ret);
+			break;
+		}
+		addr += PAGE_ALIGN(sizes[i]);
+	}
+
+	if (ret) {
+		iommu_unmap(vmm->domain, start, addr - start);
+		free_iovm_region(vmm, remove_iovm_region(vmm, start));
+		return (dma_addr_t)ret;
+	}
+
+	region = find_iovm_region(vmm, start);
+	BUG_ON(!region);
+
+	/* see iovmm_map() for the reason of the invalidation */
+	exynos_sysmmu_tlb_invalidate(vmm->domain, region->start, region->size);
+
+	dev_dbg(dev, "IOVMM: Allocated VM region @ %#x/%#x bytes for %d buffers\n",
+		(unsigned int)start, (unsigned int)size, count);
+
+	SYSMMU_EVENT_LOG_IOVMM_MAP(IOVMM_TO_LOG(vmm), start, start + size,
+						region->size - size);
+
+	return start;
+}
+
 void iovmm_unmap(struct device *dev, dma_addr_t iova)
 {
 	struct exynos_iovmm *vmm = exynos_get_iovmm(dev);
@@ -637,6 +846,7 @@ core_initcall(exynos_iovmm_create_debugfs);
 static int iovmm_debug_show(struct seq_file *s, void *unused)
 {
 	struct exynos_iovmm *vmm = s->private;
+	int i;
 
 	seq_printf(s, "%10.s  %10.s  %10.s  %6.s\n",
 			"VASTART", "SIZE", "FREE", "CHUNKS");
@@ -652,6 +862,15 @@ static int iovmm_debug_show(struct seq_file *s, void *unused)
 	seq_printf(s, "Total number of unmappings: %d\n", vmm->num_unmap);
 	spin_unlock(&vmm->vmlist_lock);
 
+	spin_lock(&vmm->cache_lock);
+	seq_printf(s, "Region cache hit/miss     : %lu/%lu\n",
+		   vmm->cache_hit, vmm->cache_miss);
+	seq_puts(s, "Region cache (order:count):");
+	for (i = 0; i < IOVM_CACHE_ORDERS; i++)
+		seq_printf(s, " %d:%u", i, vmm->cache_count[i]);
+	seq_puts(s, "\n");
+	spin_unlock(&vmm->cache_lock);
+
 	return 0;
 }
 
@@ -670,6 +889,10 @@ static ssize_t iovmm_debug_write(struct file *filp, const char __user *p,
 	vmm->num_map = 0;
 	vmm->num_unmap = 0;
 	spin_unlock(&vmm->vmlist_lock);
+	spin_lock(&vmm->cache_lock);
+	vmm->cache_hit = 0;
+	vmm->cache_miss = 0;
+	spin_unlock(&vmm->cache_lock);
 	return len;
 }
 
@@ -728,6 +951,7 @@ struct exynos_iovmm *exynos_create_single_iovmm(const char *name,
 
 	spin_lock_init(&vmm->vmlist_lock);
 	spin_lock_init(&vmm->bitmap_lock);
+	spin_lock_init(&vmm->cache_lock);
 
 	INIT_LIST_HEAD(&vmm->regions_list);
 
@@ -531,11 +531,9 @@ static int lv1set_section(struct exynos_iommu_domain *domain,
 	}
 
 	if (lv1ent_page(sent)) {
-		if (WARN_ON(atomic_read(pgcnt) != NUM_LV2ENTRIES)) {
-			WARN(1, "Trying mapping on 1MiB@%#09llx that is mapped",
-				iova);
-			return -EADDRINUSE;
-		}
+		/* some small pages are live, the caller falls back to them */
+		if (atomic_read(pgcnt) != NUM_LV2ENTRIES)
+			return -EBUSY;
 		/* TODO: for v7, free lv2 page table */
 	}
 
@@ -571,11 +569,11 @@ static int lv2set_page(sysmmu_pte_t *pent, phys_addr_t paddr, size_t size,
 	} else { /* size == LPAGE_SIZE */
 		int i;
 
-		pr_err("Allocate LPAGE_SIZE!!!\n");
 		for (i = 0; i < SPAGES_PER_LPAGE; i++, pent++) {
-			if (WARN_ON(!lv2ent_fault(pent))) {
+			/* as above, map the block with small pages instead */
+			if (!lv2ent_fault(pent)) {
 				clear_lv2_page_table(pent - i, i);
-				return -EADDRINUSE;
+				return -EBUSY;
 			}
 
 			*pent = mk_lv2ent_lpage(paddr);
@@ -722,7 +720,7 @@ static int exynos_iommu_map(unsigned long l_iova, phys_addr_t paddr,
 				       &domain->lv2entcnt[lv1ent_offset(iova)]);
 	}
 
-	if (ret)
+	if (ret && ret != -EBUSY)
 		pr_err("%s: Failed(%d) to map %#zx bytes @ %#llx\n",
 			__func__, ret, size, iova);
 
@@ -787,9 +785,18 @@ static size_t exynos_iommu_unmap(unsigned long l_iova, size_t size)
 	}
 
 	/* lv1ent_large(pent) == true here */
-	if (WARN_ON(size < LPAGE_SIZE)) {
-		err_pgsize = LPAGE_SIZE;
-		goto err;
+	if (size < LPAGE_SIZE) {
+		/* small page mapped again inside a large one, see lv2set_page */
+		sysmmu_pte_t *refcnt_buf = pent + NUM_LV2ENTRIES;
+
+		if (WARN_ON(*refcnt_buf == 0)) {
+			err_pgsize = LPAGE_SIZE;
+			goto err;
+		}
+		*refcnt_buf = *refcnt_buf - 1;
+		atomic_inc(lv2entcnt);
+		size = SPAGE_SIZE;
+		goto done;
 	}
 
 	clear_lv2_page_table(pent, SPAGES_PER_LPAGE);
@@ -933,7 +940,15 @@ int pcie_iommu_map(unsigned long iova, phys_addr_t paddr, size_t size, int prot)
 		if (alloc_counter > max_req_cnt)
 			max_req_cnt = alloc_counter;
 		ret = exynos_iommu_map(iova, paddr, pgsize, prot);
-		exynos_sysmmu_tlb_invalidate(iova, pgsize);
+		while (ret == -EBUSY && pgsize > SPAGE_SIZE) {
+			/*
+			 * Part of the block is still mapped with smaller pages
+			 * by another buffer; the mapping is an identity one,
+			 * so map this block with the next smaller page size.
+			 */
+			pgsize = (pgsize == SECT_SIZE) ? LPAGE_SIZE : SPAGE_SIZE;
+			ret = exynos_iommu_map(iova, paddr, pgsize, prot);
+		}
 #ifdef CONFIG_PCIE_IOMMU_HISTORY_LOG
 		add_history_buff(&pcie_map_history, paddr, orig_paddr,
 				changed_size, orig_size);
@@ -945,8 +960,9 @@ int pcie_iommu_map(unsigned long iova, phys_addr_t paddr, size_t size, int prot)
 		paddr += pgsize;
 		size -= pgsize;
 	}
-	/* TLB invalidation is performed by IOVMM */
-	exynos_sysmmu_tlb_invalidate(iova, size);
+	/* one range invalidation covers all the blocks mapped above */
+	if (iova != changed_iova)
+		exynos_sysmmu_tlb_invalidate(changed_iova, iova - changed_iova);
 	spin_unlock_irqrestore(&domain->pgtablelock, flags);
 
 	/* unroll mapping in case something went wrong */
@@ -968,7 +984,7 @@ size_t pcie_iommu_unmap(unsigned long iova, size_t size)
 	size_t unmapped_page, unmapped = 0;
 	unsigned int min_pagesz;
 	unsigned long __maybe_unused orig_iova = iova;
-	unsigned long __maybe_unused changed_iova;
+	unsigned long changed_iova;
 	size_t __maybe_unused orig_size = size;
 	unsigned long flags;
 
@@ -1025,8 +1041,8 @@ size_t pcie_iommu_unmap(unsigned long iova, size_t size)
 		unmapped += unmapped_page;
 	}
 
-	/* TLB invalidation is performed by IOVMM */
-	exynos_sysmmu_tlb_invalidate(iova, size);
+	if (unmapped)
+		exynos_sysmmu_tlb_invalidate(changed_iova, unmapped);
 	spin_unlock_irqrestore(&domain->pgtablelock, flags);
 
 	pr_debug("UNMAPPED : req 0x%lx(0x%lx) size 0x%zx(0x%zx)\n",
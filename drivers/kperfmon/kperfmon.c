@@ -15,6 +15,8 @@
 #include <linux/slab.h>
 #if !defined(KPERFMON_KMALLOC)
 #include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/sched.h>
 #endif
 #include <asm/uaccess.h>
 
@@ -27,6 +29,7 @@
 typedef unsigned char byte;
 
 #define	PROC_NAME	"kperfmon"
+#define	PROC_RING_NAME	"kperfmon_ring"
 #if defined(KPERFMON_KMALLOC)
 #define BUFFER_SIZE	5 * 1024
 #else
@@ -55,6 +58,49 @@ struct tRingBuffer
 struct tRingBuffer buffer = {0, };
 struct file_operations;
 
+/*
+ * Binary ring for user-space markers
+ *
+ * /proc/kperfmon_ring is mapped by the framework. The first page holds
+ * struct tPerfRingHeader, the records follow it. A writer takes a slot
+ * with an atomic fetch-add on head, clears seq, fills the record and
+ * then stores seq = index + 1 with release semantics, so logging a
+ * marker needs no system call. timestamp is CLOCK_MONOTONIC in ns.
+ * Reading the file formats one committed record per read() and adds
+ * the scheduler state of the writing thread at that time.
+ */
+#define PERF_RING_MAGIC		0x4b50524e	/* "KPRN" */
+#define PERF_RING_VERSION	1
+#define PERF_RING_RECORDS	4096
+#define PERF_RING_PAYLOAD_SIZE	40
+
+struct tPerfRingHeader
+{
+	u32 magic;
+	u32 version;
+	u32 record_size;
+	u32 nr_records;
+	u32 head;
+};
+
+struct tPerfRingRecord
+{
+	u64 timestamp;
+	u32 seq;
+	s32 id;
+	s32 tid;
+	u32 length;
+	byte payload[PERF_RING_PAYLOAD_SIZE];
+};
+
+#define PERF_RING_SIZE	(PAGE_SIZE + \
+		PAGE_ALIGN(PERF_RING_RECORDS * sizeof(struct tPerfRingRecord)))
+
+static struct tPerfRingHeader *perf_ring;
+static struct tPerfRingRecord *perf_ring_records;
+static u32 perf_ring_tail;
+static DEFINE_MUTEX(perf_ring_mutex);
+
 #if defined(USE_WORKQUEUE)
 //static struct workqueue_struct *ologk_wq = 0;
 
@@ -415,6 +461,144 @@ ssize_t kperfmon_read(struct file *filp, char __user *data, size_t count, loff_t
 #endif
 }
 
+static int kperfmon_ring_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	if (!perf_ring)
+		return -ENOMEM;
+
+	if (vma->vm_end - vma->vm_start > PERF_RING_SIZE)
+		return -EINVAL;
+
+	return remap_vmalloc_range(vma, perf_ring, vma->vm_pgoff);
+}
+
+static char kperfmon_task_state(struct task_struct *task)
+{
+	if (task->state == TASK_RUNNING)
+		return task->on_rq ? 'R' : 'W';
+	if (task->state & TASK_UNINTERRUPTIBLE)
+		return 'D';
+	return 'S';
+}
+
+/* Copy the oldest committed record, records lapped by writers are skipped */
+static bool kperfmon_ring_next(struct tPerfRingRecord *record)
+{
+	struct tPerfRingRecord *slot;
+	u32 head;
+
+	for (;;) {
+		head = READ_ONCE(perf_ring->head);
+
+		if (head - perf_ring_tail > PERF_RING_RECORDS)
+			perf_ring_tail = head - PERF_RING_RECORDS;
+		if (perf_ring_tail == head)
+			return false;
+
+		slot = &perf_ring_records[perf_ring_tail % PERF_RING_RECORDS];
+		if (smp_load_acquire(&slot->seq) != perf_ring_tail + 1) {
+			/* not committed yet, try again on the next read */
+			if (head - perf_ring_tail < PERF_RING_RECORDS)
+				return false;
+			perf_ring_tail++;
+			continue;
+		}
+
+		memcpy(record, slot, sizeof(*record));
+		smp_rmb();
+		if (READ_ONCE(slot->seq) == perf_ring_tail + 1) {
+			perf_ring_tail++;
+			return true;
+		}
+		perf_ring_tail++;
+	}
+}
+
+static ssize_t kperfmon_ring_read(struct file *filp, char __user *data, size_t count, loff_t *loff_data)
+{
+	byte readbuffer[PERF_RING_PAYLOAD_SIZE + 160] = {0, };
+	struct tPerfRingRecord record;
+	struct task_struct *task;
+	char comm[TASK_COMM_LEN] = "-";
+	char state = '-';
+	int cpu = -1, prio = -1;
+	unsigned long rem_nsec;
+	u64 ts;
+	ssize_t length;
+	bool found;
+
+	if (!perf_ring)
+		return 0;
+
+	mutex_lock(&perf_ring_mutex);
+	found = kperfmon_ring_next(&record);
+	mutex_unlock(&perf_ring_mutex);
+
+	if (!found)
+		return 0;
+
+	rcu_read_lock();
+	task = find_task_by_vpid(record.tid);
+	if (task) {
+		get_task_comm(comm, task);
+		cpu = task_cpu(task);
+		prio = task->prio - MAX_RT_PRIO;
+		state = kperfmon_task_state(task);
+	}
+	rcu_read_unlock();
+
+	if (record.id >= OlogTestEnum_ID_maxnum || record.id < 0)
+		record.id = PERFLOG_UNKNOWN;
+
+	if (record.length > PERF_RING_PAYLOAD_SIZE)
+		record.length = PERF_RING_PAYLOAD_SIZE;
+
+	ts = record.timestamp;
+	rem_nsec = do_div(ts, NSEC_PER_SEC);
+
+	length = snprintf(readbuffer, sizeof(readbuffer), "[%5lu.%06lu %5d %-16s cpu%d prio%d %c][%s] %.*s\n",
+							(unsigned long)ts, rem_nsec / NSEC_PER_USEC,
+							record.tid, comm, cpu, prio, state,
+							OlogTestEnum_ID_strings[record.id],
+							(int)record.length, record.payload);
+	if (length >= sizeof(readbuffer))
+		length = sizeof(readbuffer) - 1;
+
+	if (length > count)
+		length = count;
+
+	if (copy_to_user(data, readbuffer, length))
+		return -EFAULT;
+
+	return length;
+}
+
+static const struct file_operations kperfmon_ring_fops = {
+	.read = kperfmon_ring_read,
+	.mmap = kperfmon_ring_mmap,
+};
+
+static void kperfmon_ring_init(void)
+{
+	perf_ring = vmalloc_user(PERF_RING_SIZE);
+	if (!perf_ring) {
+		printk(KERN_INFO "kperfmon_ring_init() - Error ring allocation is failed!!!\n");
+		return;
+	}
+
+	perf_ring->magic = PERF_RING_MAGIC;
+	perf_ring->version = PERF_RING_VERSION;
+	perf_ring->record_size = sizeof(struct tPerfRingRecord);
+	perf_ring->nr_records = PERF_RING_RECORDS;
+	perf_ring_records = (void *)perf_ring + PAGE_SIZE;
+
+	if (!proc_create(PROC_RING_NAME, 0664, NULL, &kperfmon_ring_fops)) {
+		printk(KERN_ERR "kperfmon_ring_init() - Error creating entry in proc failed!!!\n");
+		vfree(perf_ring);
+		perf_ring = NULL;
+	}
+}
+
 static int __init kperfmon_init(void)
 {
 	struct proc_dir_entry* entry;
@@ -434,6 +618,8 @@ static int __init kperfmon_init(void)
 		return -EBUSY;
 	}
 
+	kperfmon_ring_init();
+
 	printk(KERN_INFO "kperfmon_init()\n");
 
 	return 0;
@@ -441,6 +627,11 @@ static int __init kperfmon_init(void)
 
 static void __exit kperfmon_exit(void)
 {
+	if (perf_ring) {
+		remove_proc_entry(PROC_RING_NAME, NULL);
+		vfree(perf_ring);
+		perf_ring = NULL;
+	}
 	DestroyBuffer(&buffer);
 	printk(KERN_INFO "kperfmon_exit()\n");
 }
@@ -1282,6 +1282,15 @@ static void clone_init(struct dm_crypt_io *io, struct bio *clone)
 #endif
 }
 
+/* the key goes down with the bio, FMP encrypts it inline */
+static void crypt_fmp_set_ci(struct crypt_config *cc, struct bio *bio)
+{
+	bio->fmp_ci.private_enc_mode = EXYNOS_FMP_DISK_ENC;
+	bio->fmp_ci.private_algo_mode = EXYNOS_FMP_ALGO_MODE_AES_XTS;
+	bio->fmp_ci.key = cc->key;
+	bio->fmp_ci.key_length = cc->key_size;
+}
+
 static int kcryptd_io_rw(struct dm_crypt_io *io, gfp_t gfp)
 {
 	struct crypt_config *cc = io->cc;
@@ -1299,10 +1308,7 @@ static int kcryptd_io_rw(struct dm_crypt_io *io, gfp_t gfp)
 	crypt_inc_pending(io);
 
 	clone_init(io, clone);
-	clone->fmp_ci.private_enc_mode = EXYNOS_FMP_DISK_ENC;
-	clone->fmp_ci.private_algo_mode = EXYNOS_FMP_ALGO_MODE_AES_XTS;
-	clone->fmp_ci.key = cc->key;
-	clone->fmp_ci.key_length = cc->key_size;
+	crypt_fmp_set_ci(cc, clone);
 	clone->bi_iter.bi_sector = cc->start + io->sector;
 
 	dm_crypt_bio_trace_start(cc, clone);
@@ -2320,6 +2326,20 @@ static int crypt_map(struct dm_target *ti, struct bio *bio)
 	    bio_data_dir(bio) == WRITE)
 		dm_accept_partial_bio(bio, ((BIO_MAX_PAGES << PAGE_SHIFT) >> SECTOR_SHIFT));
 
+	/*
+	 * With FMP there is nothing to do but to remap the bio dm core
+	 * already cloned for us and to tag it with the key, so hand it back
+	 * instead of cloning it once more and completing it through
+	 * crypt_endio(). Only traced bios still take the long way.
+	 */
+	if (cc->hw_fmp && !dm_crypt_need_bio_trace(cc, bio, __func__)) {
+		bio->bi_bdev = cc->dev->bdev;
+		bio->bi_iter.bi_sector = cc->start +
+			dm_target_offset(ti, bio->bi_iter.bi_sector);
+		crypt_fmp_set_ci(cc, bio);
+		return DM_MAPIO_REMAPPED;
+	}
+
 	io = dm_per_bio_data(bio, cc->per_bio_data_size);
 	crypt_io_init(io, cc, bio, dm_target_offset(ti, bio->bi_iter.bi_sector));
 	io->ctx.req = (struct skcipher_request *)(io + 1);
@@ -39,6 +39,18 @@ long long get_total_blks(void){
 	return 0;
 }
 
+long long get_prefetch_blks(void){
+	if(!empty_b_info())
+		return atomic64_read(&b_info->prefetch_blks);
+	return 0;
+}
+
+long long get_prefetch_seq_ios(void){
+	if(!empty_b_info())
+		return atomic64_read(&b_info->prefetch_seq_ios);
+	return 0;
+}
+
 long long get_skipped_blks(void){
 	if(!empty_b_info())
 		return atomic64_read(&b_info->skipped_blks);
@@ -124,6 +136,14 @@ void add_fec_correct_blks(void){
 	if(!empty_b_info())
 		atomic64_inc(&b_info->fec_correct_blks);
 }
+void add_prefetch_blks(long long val){
+	if(!empty_b_info())
+		atomic64_add(val, &b_info->prefetch_blks);
+}
+void add_prefetch_seq_ios(void){
+	if(!empty_b_info())
+		atomic64_inc(&b_info->prefetch_seq_ios);
+}
 void add_corrupted_blks(void){
 	if(!empty_b_info())
 		atomic64_inc(&b_info->corrupted_blks);
@@ -157,6 +177,7 @@ void print_blks_cnt(char* dev_name){
     }
 
 	pr_err("dev_name = %s,total_blks = %llu,skipped_blks = %llu,corrupted_blks = %llu,fec_correct_blks = %llu",dev_name,get_total_blks(),get_skipped_blks(),get_corrupted_blks(),get_fec_correct_blks());
+	pr_err("prefetch_blks = %llu,prefetch_seq_ios = %llu",get_prefetch_blks(),get_prefetch_seq_ios());
 
 	if(foc > 0){
 		pr_err("fec_off_cnt = %d",foc);
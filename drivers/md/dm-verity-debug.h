@@ -21,6 +21,9 @@ struct blks_info{
     atomic64_t fec_correct_blks; 
     atomic64_t corrupted_blks; 
     atomic64_t prev_total_blks;
+    /* hash prefetch */
+    atomic64_t prefetch_blks;
+    atomic64_t prefetch_seq_ios;
 
     /* fec corrected blocks list */
     sector_t fc_blks_list[MAX_FC_BLKS_LIST + FOR_SAFE]; 
@@ -46,6 +49,8 @@ extern long long get_skipped_blks(void);
 extern long long get_fec_correct_blks(void);
 extern long long get_corrupted_blks(void);
 extern long long get_prev_total_blks(void);
+extern long long get_prefetch_blks(void);
+extern long long get_prefetch_seq_ios(void);
 extern int get_fec_off_cnt(void);
 extern int get_dmv_ctr_cnt(void);
 extern struct blks_info * get_b_info(char* dev_name);
@@ -58,6 +63,8 @@ extern void add_fec_correct_blks(void);
 extern void add_corrupted_blks(void);
 extern void add_fc_blks_entry(sector_t cur_blk, char* dev_name);
 extern void add_fec_off_cnt(char* dev_name);
+extern void add_prefetch_blks(long long val);
+extern void add_prefetch_seq_ios(void);
 
 #endif
 
@@ -12,6 +12,18 @@
  * hash device. Setting this greatly improves performance when data and hash
  * are on the same disk on different partitions on devices with poor random
  * access behavior.
+ *
+ * With "prefetch_adaptive" set (the default), "prefetch_cluster" is only the
+ * upper bound: the cluster is scaled to the length of the current run of
+ * sequential reads on the target, so random reads only fetch the hash
+ * blocks they need.
+ *
+ * "validated_cache_kb" bounds the memory check_at_most_once may use to
+ * remember verified blocks, 0 means no limit.
+ *
+ * With CONFIG_DM_VERITY_PARALLEL, "parallel_blocks" is the minimum number of
+ * data blocks per chunk a large bio is split into for verification on
+ * several CPUs. 0 verifies every bio in a single worker.
  */
 
 #include "dm-verity.h"
@@ -21,6 +33,7 @@
 #include <linux/module.h>
 #include <linux/reboot.h>
 #include <linux/vmalloc.h>
+#include <crypto/sha.h>
 
 #include <linux/ctype.h>
 #if defined(CONFIG_TZ_ICCC)
@@ -48,6 +61,22 @@ static unsigned dm_verity_prefetch_cluster = DM_VERITY_DEFAULT_PREFETCH_SIZE;
 
 module_param_named(prefetch_cluster, dm_verity_prefetch_cluster, uint, S_IRUGO | S_IWUSR);
 
+static bool dm_verity_prefetch_adaptive = true;
+
+module_param_named(prefetch_adaptive, dm_verity_prefetch_adaptive, bool, S_IRUGO | S_IWUSR);
+
+static unsigned dm_verity_validated_cache_kb;
+
+module_param_named(validated_cache_kb, dm_verity_validated_cache_kb, uint, S_IRUGO | S_IWUSR);
+
+#ifdef CONFIG_DM_VERITY_PARALLEL
+#define DM_VERITY_DEFAULT_PARALLEL_BLOCKS	32
+
+static unsigned dm_verity_parallel_blocks = DM_VERITY_DEFAULT_PARALLEL_BLOCKS;
+
+module_param_named(parallel_blocks, dm_verity_parallel_blocks, uint, S_IRUGO | S_IWUSR);
+#endif
+
 extern int ignore_fs_panic;
 
 #ifdef DMV_ALTA
@@ -69,6 +98,7 @@ struct dm_verity_prefetch_work {
 	struct dm_verity *v;
 	sector_t block;
 	unsigned n_blocks;
+	unsigned cluster;	/* level 0 cluster in hash blocks */
 };
 
 /*
@@ -461,22 +491,244 @@ static inline void verity_bv_skip_block(struct dm_verity *v,
 }
 
 /*
- * Verify one "dm_verity_io" structure.
+ * check_at_most_once bookkeeping. The bitmap of validated data blocks is
+ * split into chunks that are only allocated once a block in their range
+ * has been verified, so that only the parts of the device actually read
+ * cost memory. When validated_cache_kb is set, chunks beyond it are
+ * reclaimed in clock order: a chunk that had a hit since the last pass
+ * gets another round. A chunk always covers the same range of blocks and
+ * is freed after a grace period, so a lookup can never see bits from
+ * another range; losing a chunk only means verifying its blocks again.
  */
-static int verity_verify_io(struct dm_verity_io *io)
+#define DM_VERITY_VB_CHUNK_BITS		12
+#define DM_VERITY_VB_CHUNK_BLOCKS	(1U << DM_VERITY_VB_CHUNK_BITS)
+
+struct dm_verity_vb_chunk {
+	struct rcu_head rcu;
+	struct list_head lru;
+	unsigned idx;
+	bool referenced;
+	unsigned long bits[BITS_TO_LONGS(DM_VERITY_VB_CHUNK_BLOCKS)];
+};
+
+struct dm_verity_vb {
+	spinlock_t lock;	/* protects lru, nr_chunks and slot updates */
+	struct list_head lru;
+	unsigned nr_chunks;
+	unsigned nr_slots;
+	struct dm_verity_vb_chunk __rcu *slots[0];
+};
+
+static bool verity_is_validated(struct dm_verity *v, sector_t block)
+{
+	struct dm_verity_vb *vb = v->validated_blocks;
+	struct dm_verity_vb_chunk *c;
+	bool ret = false;
+
+	rcu_read_lock();
+	c = rcu_dereference(vb->slots[block >> DM_VERITY_VB_CHUNK_BITS]);
+	if (c && test_bit(block & (DM_VERITY_VB_CHUNK_BLOCKS - 1), c->bits)) {
+		if (!READ_ONCE(c->referenced))
+			WRITE_ONCE(c->referenced, true);
+		ret = true;
+	}
+	rcu_read_unlock();
+
+	return ret;
+}
+
+/* called with vb->lock held */
+static struct dm_verity_vb_chunk *verity_vb_evict(struct dm_verity_vb *vb)
+{
+	unsigned limit = dm_verity_validated_cache_kb * 1024 /
+			sizeof(struct dm_verity_vb_chunk);
+	struct dm_verity_vb_chunk *c;
+	unsigned scan;
+
+	if (!dm_verity_validated_cache_kb || vb->nr_chunks < max(limit, 1U))
+		return NULL;
+
+	for (scan = 0; scan <= vb->nr_chunks; scan++) {
+		c = list_last_entry(&vb->lru, struct dm_verity_vb_chunk, lru);
+		if (!c->referenced || scan == vb->nr_chunks)
+			break;
+		c->referenced = false;
+		list_move(&c->lru, &vb->lru);
+	}
+
+	list_del(&c->lru);
+	vb->nr_chunks--;
+	RCU_INIT_POINTER(vb->slots[c->idx], NULL);
+	return c;
+}
+
+static void verity_set_validated(struct dm_verity *v, sector_t block)
+{
+	struct dm_verity_vb *vb = v->validated_blocks;
+	unsigned idx = block >> DM_VERITY_VB_CHUNK_BITS;
+	unsigned bit = block & (DM_VERITY_VB_CHUNK_BLOCKS - 1);
+	struct dm_verity_vb_chunk *c, *victim;
+
+	rcu_read_lock();
+	c = rcu_dereference(vb->slots[idx]);
+	if (likely(c))
+		set_bit(bit, c->bits);
+	rcu_read_unlock();
+	if (likely(c))
+		return;
+
+	/* on failure the block is just verified again next time */
+	c = kzalloc(sizeof(*c), GFP_NOIO | __GFP_NOWARN);
+	if (!c)
+		return;
+	c->idx = idx;
+	set_bit(bit, c->bits);
+
+	spin_lock(&vb->lock);
+	if (rcu_access_pointer(vb->slots[idx])) {
+		/* lost the race, the other chunk simply misses this block */
+		spin_unlock(&vb->lock);
+		kfree(c);
+		return;
+	}
+	victim = verity_vb_evict(vb);
+	list_add(&c->lru, &vb->lru);
+	vb->nr_chunks++;
+	rcu_assign_pointer(vb->slots[idx], c);
+	spin_unlock(&vb->lock);
+
+	if (victim)
+		kfree_rcu(victim, rcu);
+}
+
+static void verity_free_validated(struct dm_verity *v)
+{
+	struct dm_verity_vb *vb = v->validated_blocks;
+	unsigned i;
+
+	if (!vb)
+		return;
+
+	for (i = 0; i < vb->nr_slots; i++)
+		kfree(rcu_dereference_protected(vb->slots[i], 1));
+	vfree(vb);
+}
+
+#define DM_VERITY_MB_MAX_DIGEST		SHA512_DIGEST_SIZE
+
+/*
+ * Pairs of data blocks can be hashed in one interleaved pass when the
+ * hash supports it and the salt is a prefix, so both blocks start from
+ * the same salted state.
+ */
+static bool verity_use_mb(struct dm_verity *v)
+{
+	return v->version >= 1 && v->digest_size <= DM_VERITY_MB_MAX_DIGEST &&
+	       crypto_shash_mb_max_msgs(v->tfm) >= 2;
+}
+
+/*
+ * Verify blocks b and b + 1 together. Only the plain case is handled:
+ * both blocks unverified, not zero, each in one bio_vec and hashing
+ * correctly. Returns 1 if both were verified and io->iter advanced past
+ * them, 0 to verify block b on its own instead, or a negative error.
+ */
+static int verity_verify_block_pair(struct dm_verity_io *io, unsigned b)
+{
+	struct dm_verity *v = io->v;
+	struct bio *bio = dm_bio_from_per_bio_data(io, v->ti->per_io_data_size);
+	struct shash_desc *desc = verity_io_hash_desc(v, io);
+	unsigned block_size = 1 << v->data_dev_block_bits;
+	u8 want_digest[2][DM_VERITY_MB_MAX_DIGEST];
+	u8 real_digest[2][DM_VERITY_MB_MAX_DIGEST];
+	struct bvec_iter iter = io->iter;
+	struct bio_vec bv[2];
+	const u8 *data[2];
+	u8 *outs[2];
+	u8 *page[2];
+	bool is_zero;
+	int i, r;
+
+	for (i = 0; i < 2; i++) {
+		sector_t cur_block = io->block + b + i;
+
+		if (v->validated_blocks && verity_is_validated(v, cur_block))
+			return 0;
+		if (verity_hash_for_block(v, io, cur_block, want_digest[i],
+					  &is_zero) || is_zero)
+			return 0;
+
+		bv[i] = bio_iter_iovec(bio, iter);
+		if (bv[i].bv_len < block_size)
+			return 0;
+		bio_advance_iter(bio, &iter, block_size);
+	}
+
+	r = verity_hash_init(v, desc);
+	if (unlikely(r < 0))
+		return r;
+
+	page[0] = kmap_atomic(bv[0].bv_page);
+	page[1] = kmap_atomic(bv[1].bv_page);
+	for (i = 0; i < 2; i++) {
+		data[i] = page[i] + bv[i].bv_offset;
+		outs[i] = real_digest[i];
+	}
+	r = crypto_shash_finup_mb(desc, data, block_size, outs, 2);
+	kunmap_atomic(page[1]);
+	kunmap_atomic(page[0]);
+
+	if (unlikely(r < 0)) {
+		DMERR("crypto_shash_finup_mb failed: %d", r);
+		return r;
+	}
+
+	/* mismatches go through FEC and error handling one at a time */
+	for (i = 0; i < 2; i++)
+		if (memcmp(real_digest[i], want_digest[i], v->digest_size))
+			return 0;
+
+	for (i = 0; i < 2; i++) {
+		if (v->validated_blocks)
+			verity_set_validated(v, io->block + b + i);
+#ifdef DMV_ALTA
+		set_bit(io->block + b + i, (volatile unsigned long *)v->verity_bitmap);
+#endif
+	}
+
+	io->iter = iter;
+	return 1;
+}
+
+/*
+ * Verify blocks [b, end) of one "dm_verity_io" structure, io->iter must
+ * point at block b.
+ */
+static int verity_verify_blocks(struct dm_verity_io *io, unsigned b,
+				unsigned end)
 {
 	bool is_zero;
 	struct dm_verity *v = io->v;
 	struct bvec_iter start;
-	unsigned b;
+	bool use_mb = verity_use_mb(v);
 
-	for (b = 0; b < io->n_blocks; b++) {
+	for (; b < end; b++) {
 		int r;
 		sector_t cur_block = io->block + b;
 		struct shash_desc *desc = verity_io_hash_desc(v, io);
 
+		if (use_mb && b + 1 < end) {
+			r = verity_verify_block_pair(io, b);
+			if (unlikely(r < 0))
+				return r;
+			if (r) {
+				b++;
+				continue;
+			}
+		}
+
 		if (v->validated_blocks &&
-		    likely(test_bit(cur_block, v->validated_blocks))) {
+		    likely(verity_is_validated(v, cur_block))) {
 			verity_bv_skip_block(v, io, &io->iter);
 #ifdef SEC_HEX_DEBUG
 			add_skipped_blks();
@@ -519,7 +771,7 @@ static int verity_verify_io(struct dm_verity_io *io)
 		if (likely(memcmp(verity_io_real_digest(v, io),
 				  verity_io_want_digest(v, io), v->digest_size) == 0)) {
 			if (v->validated_blocks)
-				set_bit(cur_block, v->validated_blocks);
+				verity_set_validated(v, cur_block);
 
 #ifdef DMV_ALTA
 			set_bit(io->block + b, (volatile unsigned long *)io->v->verity_bitmap);
@@ -552,6 +804,280 @@ static int verity_verify_io(struct dm_verity_io *io)
 	return 0;
 }
 
+#ifdef CONFIG_DM_VERITY_PARALLEL
+#define DM_VERITY_PAR_MAX_DIGEST	SHA512_DIGEST_SIZE
+
+struct dm_verity_par {
+	atomic_t pending;
+	struct completion done;
+};
+
+struct dm_verity_chunk {
+	struct work_struct work;
+	struct dm_verity_io *io;
+	struct dm_verity_par *par;
+	struct bvec_iter iter;	/* points at block b */
+	unsigned b;		/* first block, relative to io->block */
+	unsigned n;		/* number of blocks */
+	unsigned done;		/* blocks verified before stopping */
+};
+
+/*
+ * Hash one data block with this cpu's descriptor and compare it against
+ * want_digest. Returns 0 on match, 1 on mismatch, or a negative error.
+ */
+static int verity_par_hash_block(struct dm_verity *v, struct bio *bio,
+				 struct bvec_iter *iter, const u8 *want_digest)
+{
+	unsigned todo = 1 << v->data_dev_block_bits;
+	u8 *ctx = get_cpu_ptr(v->par_ctx);
+	struct shash_desc *desc = (struct shash_desc *)ctx;
+	u8 *real_digest = ctx + v->shash_descsize;
+	int r;
+
+	r = verity_hash_init(v, desc);
+	/* we own this cpu's descriptor until put_cpu_ptr() */
+	desc->flags &= ~CRYPTO_TFM_REQ_MAY_SLEEP;
+
+	while (!r && todo) {
+		struct bio_vec bv = bio_iter_iovec(bio, *iter);
+		unsigned len = min(bv.bv_len, todo);
+		u8 *page = kmap_atomic(bv.bv_page);
+
+		r = verity_hash_update(v, desc, page + bv.bv_offset, len);
+		kunmap_atomic(page);
+
+		bio_advance_iter(bio, iter, len);
+		todo -= len;
+	}
+
+	if (!r)
+		r = verity_hash_final(v, desc, real_digest);
+	if (!r && memcmp(real_digest, want_digest, v->digest_size))
+		r = 1;
+
+	put_cpu_ptr(v->par_ctx);
+	return r;
+}
+
+/*
+ * The fast path only: data blocks whose level 0 hash block is already
+ * verified and which hash correctly. Anything else (unverified or evicted
+ * hash blocks, zero blocks, mismatches, errors) stops the chunk and is
+ * left to verity_verify_blocks(), which handles FEC and corruption.
+ */
+static void verity_par_verify_chunk(struct dm_verity_chunk *chunk)
+{
+	struct dm_verity_io *io = chunk->io;
+	struct dm_verity *v = io->v;
+	struct bio *bio = dm_bio_from_per_bio_data(io, v->ti->per_io_data_size);
+	struct bvec_iter iter = chunk->iter;
+	u8 want_digest[DM_VERITY_PAR_MAX_DIGEST];
+	unsigned i;
+
+	for (i = 0; i < chunk->n; i++) {
+		sector_t cur_block = io->block + chunk->b + i;
+
+		if (v->validated_blocks &&
+		    likely(verity_is_validated(v, cur_block))) {
+			verity_bv_skip_block(v, io, &iter);
+			continue;
+		}
+
+		/* with skip_unverified set, io is not touched */
+		if (verity_verify_level(v, io, cur_block, 0, true, want_digest))
+			break;
+		if (v->zero_digest &&
+		    !memcmp(v->zero_digest, want_digest, v->digest_size))
+			break;
+
+		if (verity_par_hash_block(v, bio, &iter, want_digest))
+			break;
+
+		if (v->validated_blocks)
+			verity_set_validated(v, cur_block);
+#ifdef DMV_ALTA
+		set_bit(cur_block, (volatile unsigned long *)v->verity_bitmap);
+#endif
+	}
+
+	chunk->done = i;
+}
+
+static void verity_par_work(struct work_struct *w)
+{
+	struct dm_verity_chunk *chunk = container_of(w, struct dm_verity_chunk,
+						     work);
+	struct dm_verity_par *par = chunk->par;
+
+	verity_par_verify_chunk(chunk);
+	if (atomic_dec_and_test(&par->pending))
+		complete(&par->done);
+}
+
+/*
+ * Verify the hash chain of every level 0 hash block the io spans once, in
+ * this worker, so that the chunks find them verified.
+ */
+static bool verity_par_prepare(struct dm_verity_io *io)
+{
+	struct dm_verity *v = io->v;
+	sector_t last = -1;
+	bool is_zero;
+	unsigned b;
+
+	for (b = 0; b < io->n_blocks; b++) {
+		sector_t cur = (io->block + b) >> v->hash_per_block_bits;
+
+		if (cur == last)
+			continue;
+		last = cur;
+		if (verity_hash_for_block(v, io, io->block + b,
+					  verity_io_want_digest(v, io),
+					  &is_zero))
+			return false;
+	}
+
+	return true;
+}
+
+static unsigned verity_par_nr_chunks(struct dm_verity_io *io)
+{
+	struct dm_verity *v = io->v;
+	unsigned min_blocks = READ_ONCE(dm_verity_parallel_blocks);
+
+	if (!v->par_ctx || !min_blocks || !v->levels ||
+	    verity_fec_is_enabled(v))
+		return 1;
+
+	return clamp(io->n_blocks / min_blocks, 1U, num_online_cpus());
+}
+
+/*
+ * Verify a large io in chunks, one of them in this worker and the rest on
+ * par_wq, then finish whatever the chunks left over sequentially.
+ * Returns 1 when the io is too small or resources are short.
+ */
+static int verity_par_verify_io(struct dm_verity_io *io)
+{
+	struct dm_verity *v = io->v;
+	struct bio *bio = dm_bio_from_per_bio_data(io, v->ti->per_io_data_size);
+	unsigned nr = verity_par_nr_chunks(io);
+	struct dm_verity_chunk *chunks;
+	struct dm_verity_par par;
+	struct bvec_iter start;
+	unsigned i, b = 0;
+	int r = 0;
+
+	if (nr < 2)
+		return 1;
+
+	chunks = kmalloc_array(nr, sizeof(*chunks), GFP_NOIO | __GFP_NOWARN);
+	if (!chunks)
+		return 1;
+
+	if (!verity_par_prepare(io)) {
+		kfree(chunks);
+		return 1;
+	}
+
+	atomic_set(&par.pending, nr);
+	init_completion(&par.done);
+
+	start = io->iter;
+	for (i = 0; i < nr; i++) {
+		struct dm_verity_chunk *chunk = &chunks[i];
+
+		chunk->io = io;
+		chunk->par = &par;
+		chunk->iter = io->iter;
+		chunk->b = b;
+		chunk->n = i == nr - 1 ? io->n_blocks - b : io->n_blocks / nr;
+		chunk->done = 0;
+		b += chunk->n;
+		bio_advance_iter(bio, &io->iter,
+				 chunk->n << v->data_dev_block_bits);
+
+		if (i) {
+			INIT_WORK(&chunk->work, verity_par_work);
+			queue_work(v->par_wq, &chunk->work);
+		}
+	}
+
+	verity_par_verify_chunk(&chunks[0]);
+	if (!atomic_dec_and_test(&par.pending))
+		wait_for_completion(&par.done);
+
+	for (i = 0; i < nr && !r; i++) {
+		struct dm_verity_chunk *chunk = &chunks[i];
+
+		if (chunk->done == chunk->n)
+			continue;
+
+		io->iter = start;
+		bio_advance_iter(bio, &io->iter,
+				 (chunk->b + chunk->done) << v->data_dev_block_bits);
+		r = verity_verify_blocks(io, chunk->b + chunk->done,
+					 chunk->b + chunk->n);
+	}
+
+	kfree(chunks);
+	return r;
+}
+
+static int verity_parallel_ctr(struct dm_verity *v)
+{
+	if (v->digest_size > DM_VERITY_PAR_MAX_DIGEST)
+		return 0;
+
+	v->par_wq = alloc_workqueue("kverityd_par", WQ_CPU_INTENSIVE |
+				    WQ_MEM_RECLAIM | WQ_UNBOUND, 0);
+	if (!v->par_wq)
+		return -ENOMEM;
+
+	v->par_ctx = __alloc_percpu(v->shash_descsize + v->digest_size,
+				    __alignof__(struct shash_desc));
+	if (!v->par_ctx)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void verity_parallel_dtr(struct dm_verity *v)
+{
+	if (v->par_wq)
+		destroy_workqueue(v->par_wq);
+	free_percpu(v->par_ctx);
+}
+#else
+static inline int verity_par_verify_io(struct dm_verity_io *io)
+{
+	return 1;
+}
+
+static inline int verity_parallel_ctr(struct dm_verity *v)
+{
+	return 0;
+}
+
+static inline void verity_parallel_dtr(struct dm_verity *v)
+{
+}
+#endif
+
+/*
+ * Verify one "dm_verity_io" structure.
+ */
+static int verity_verify_io(struct dm_verity_io *io)
+{
+	int r = verity_par_verify_io(io);
+
+	if (r <= 0)
+		return r;
+
+	return verity_verify_blocks(io, 0, io->n_blocks);
+}
+
 /*
  * End one "io" structure with a given error.
  */
@@ -630,15 +1156,11 @@ static void verity_prefetch_io(struct work_struct *work)
 		verity_hash_at_level(v, pw->block, i, &hash_block_start, NULL);
 		verity_hash_at_level(v, pw->block + pw->n_blocks - 1, i, &hash_block_end, NULL);
 		if (!i) {
-			unsigned cluster = ACCESS_ONCE(dm_verity_prefetch_cluster);
+			unsigned cluster = pw->cluster;
 
-			cluster >>= v->data_dev_block_bits;
-			if (unlikely(!cluster))
+			if (unlikely(cluster <= 1))
 				goto no_prefetch_cluster;
 
-			if (unlikely(cluster & (cluster - 1)))
-				cluster = 1 << __fls(cluster);
-
 			hash_block_start &= ~(sector_t)(cluster - 1);
 			hash_block_end |= cluster - 1;
 			if (unlikely(hash_block_end >= v->hash_blocks))
@@ -647,14 +1169,61 @@ static void verity_prefetch_io(struct work_struct *work)
 no_prefetch_cluster:
 		dm_bufio_prefetch(v->bufio, hash_block_start,
 				  hash_block_end - hash_block_start + 1);
+#ifdef SEC_HEX_DEBUG
+		add_prefetch_blks(hash_block_end - hash_block_start + 1);
+#endif
 	}
 
 	kfree(pw);
 }
 
+/*
+ * Level 0 prefetch cluster, in hash blocks and a power of two. The static
+ * prefetch_cluster is the upper bound; in adaptive mode it is scaled to
+ * cover the hash blocks of twice the current sequential run, which is
+ * just the blocks needed by the io itself for random reads.
+ */
+static unsigned verity_prefetch_cluster(struct dm_verity *v,
+					struct dm_verity_io *io)
+{
+	unsigned cluster = ACCESS_ONCE(dm_verity_prefetch_cluster);
+	unsigned run, want;
+
+	cluster >>= v->data_dev_block_bits;
+	if (unlikely(!cluster))
+		return 0;
+
+	if (unlikely(cluster & (cluster - 1)))
+		cluster = 1 << __fls(cluster);
+
+	/* racy on purpose, this is only a heuristic */
+	run = READ_ONCE(v->prefetch_run);
+	if (io->block == READ_ONCE(v->prefetch_next_block))
+		run = min_t(unsigned, run + io->n_blocks, UINT_MAX >> 1);
+	else
+		run = io->n_blocks;
+	WRITE_ONCE(v->prefetch_run, run);
+	WRITE_ONCE(v->prefetch_next_block, io->block + io->n_blocks);
+
+	if (!ACCESS_ONCE(dm_verity_prefetch_adaptive))
+		return cluster;
+
+	if (run == io->n_blocks)
+		return 0;
+
+#ifdef SEC_HEX_DEBUG
+	add_prefetch_seq_ios();
+#endif
+	want = DIV_ROUND_UP(run * 2, 1U << v->hash_per_block_bits);
+	want = roundup_pow_of_two(max(want, 1U));
+
+	return min(cluster, want);
+}
+
 static void verity_submit_prefetch(struct dm_verity *v, struct dm_verity_io *io)
 {
 	struct dm_verity_prefetch_work *pw;
+	unsigned cluster = verity_prefetch_cluster(v, io);
 
 	pw = kmalloc(sizeof(struct dm_verity_prefetch_work),
 		GFP_NOIO | __GFP_NORETRY | __GFP_NOMEMALLOC | __GFP_NOWARN);
@@ -666,6 +1235,7 @@ static void verity_submit_prefetch(struct dm_verity *v, struct dm_verity_io *io)
 	pw->v = v;
 	pw->block = io->block;
 	pw->n_blocks = io->n_blocks;
+	pw->cluster = cluster;
 	queue_work(v->verify_wq, &pw->work);
 }
 
@@ -880,10 +1450,12 @@ void verity_dtr(struct dm_target *ti)
 	if (v->verify_wq)
 		destroy_workqueue(v->verify_wq);
 
+	verity_parallel_dtr(v);
+
 	if (v->bufio)
 		dm_bufio_client_destroy(v->bufio);
 
-	vfree(v->validated_blocks);
+	verity_free_validated(v);
 	kfree(v->salt);
 	kfree(v->root_digest);
 	kfree(v->zero_digest);
@@ -908,6 +1480,8 @@ EXPORT_SYMBOL_GPL(verity_dtr);
 static int verity_alloc_most_once(struct dm_verity *v)
 {
 	struct dm_target *ti = v->ti;
+	struct dm_verity_vb *vb;
+	unsigned nr_slots;
 
 	/* the bitset can only handle INT_MAX blocks */
 	if (v->data_blocks > INT_MAX) {
@@ -915,13 +1489,19 @@ static int verity_alloc_most_once(struct dm_verity *v)
 		return -E2BIG;
 	}
 
-	v->validated_blocks = vzalloc(BITS_TO_LONGS(v->data_blocks) *
-				       sizeof(unsigned long));
-	if (!v->validated_blocks) {
+	nr_slots = (v->data_blocks + DM_VERITY_VB_CHUNK_BLOCKS - 1) >>
+			DM_VERITY_VB_CHUNK_BITS;
+	vb = vzalloc(sizeof(*vb) + nr_slots * sizeof(vb->slots[0]));
+	if (!vb) {
 		ti->error = "failed to allocate bitset for check_at_most_once";
 		return -ENOMEM;
 	}
 
+	spin_lock_init(&vb->lock);
+	INIT_LIST_HEAD(&vb->lru);
+	vb->nr_slots = nr_slots;
+	v->validated_blocks = vb;
+
 	return 0;
 }
 
@@ -1268,6 +1848,12 @@ int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 		goto bad;
 	}
 
+	r = verity_parallel_ctr(v);
+	if (r) {
+		ti->error = "Cannot allocate parallel verification context";
+		goto bad;
+	}
+
 	ti->per_io_data_size = sizeof(struct dm_verity_io) +
 				v->shash_descsize + v->digest_size * 2;
 
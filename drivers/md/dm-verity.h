@@ -32,6 +32,7 @@ enum verity_block_type {
 };
 
 struct dm_verity_fec;
+struct dm_verity_vb;
 
 struct dm_verity {
 	struct dm_dev *data_dev;
@@ -61,11 +62,19 @@ struct dm_verity {
 
 	struct workqueue_struct *verify_wq;
 
+	/* sequential run of data blocks seen by verity_map() */
+	sector_t prefetch_next_block;
+	unsigned prefetch_run;
+#ifdef CONFIG_DM_VERITY_PARALLEL
+	struct workqueue_struct *par_wq;	/* chunks of large ios */
+	void __percpu *par_ctx;	/* hash_desc + real_digest per cpu */
+#endif
+
 	/* starting blocks for each tree level. 0 is the lowest level. */
 	sector_t hash_level_block[DM_VERITY_MAX_LEVELS];
 
 	struct dm_verity_fec *fec;	/* forward error correction */
-	unsigned long *validated_blocks; /* bitset blocks validated */
+	struct dm_verity_vb *validated_blocks; /* blocks validated */
 #ifdef DMV_ALTA
 	u8 *verity_bitmap; /* bitmap for skipping verification on blocks */
 #endif
@@ -536,6 +536,63 @@ static int m2m1shot_process(struct m2m1shot_context *ctx,
 	return (task->state == M2M1SHOT_BUFSTATE_DONE) ? 0 : -EINVAL;
 }
 
+static int m2m1shot_process_batch(struct m2m1shot_context *ctx,
+				struct m2m1shot_batch __user *ubatch)
+{
+	struct m2m1shot_device *m21dev = ctx->m21dev;
+	struct m2m1shot __user *utasks;
+	struct m2m1shot_batch batch;
+	struct m2m1shot_task data;
+	int ret = 0;
+
+	if (copy_from_user(&batch, ubatch, sizeof(batch))) {
+		dev_err(m21dev->dev,
+			"%s: Failed to read userdata\n", __func__);
+		return -EFAULT;
+	}
+
+	if (!batch.count || batch.count > M2M1SHOT_BATCH_MAX) {
+		dev_err(m21dev->dev, "%s: invalid number of tasks %u\n",
+			__func__, batch.count);
+		return -EINVAL;
+	}
+
+	utasks = u64_to_user_ptr(batch.tasks);
+
+	if (m21dev->ops->begin_batch) {
+		ret = m21dev->ops->begin_batch(ctx, batch.count);
+		if (ret)
+			return ret;
+	}
+
+	for (batch.done = 0; batch.done < batch.count; batch.done++) {
+		memset(&data, 0, sizeof(data));
+
+		if (copy_from_user(&data.task, &utasks[batch.done],
+					sizeof(data.task))) {
+			ret = -EFAULT;
+			break;
+		}
+
+		ret = m2m1shot_process(ctx, &data);
+
+		if (copy_to_user(&utasks[batch.done], &data.task,
+					sizeof(data.task)))
+			ret = -EFAULT;
+
+		if (ret)
+			break;
+	}
+
+	if (m21dev->ops->end_batch)
+		m21dev->ops->end_batch(ctx);
+
+	if (put_user(batch.done, &ubatch->done))
+		return -EFAULT;
+
+	return ret;
+}
+
 static int m2m1shot_open(struct inode *inode, struct file *filp)
 {
 	struct m2m1shot_device *m21dev = container_of(filp->private_data,
@@ -611,6 +668,8 @@ static long m2m1shot_ioctl(struct file *filp,
 
 		return ret;
 	}
+	case M2M1SHOT_IOC_PROCESS_BATCH:
+		return m2m1shot_process_batch(ctx, (void __user *)arg);
 	case M2M1SHOT_IOC_CUSTOM:
 	{
 		struct m2m1shot_custom_data data;
@@ -55,6 +55,10 @@
 /* The name of the gate clock. This is set in the device-tree entry */
 static const char *clk_producer_name = "gate";
 
+static int map_cache;
+module_param(map_cache, int, 0644);
+MODULE_PARM_DESC(map_cache, "Keep the mappings of dmabufs across tasks");
+
 #ifdef HWASTC_PROFILE_ENABLE
 static struct timeval global_time_start;
 static struct timeval global_time_end;
@@ -1104,6 +1108,12 @@ static void astc_buffer_teardown(struct astc_dev *astc_device,
 {
 	dev_dbg(astc_device->dev, "%s: BEGIN\n", __func__);
 
+	/* the mapping stays with the context */
+	if (dma_buffer->cached) {
+		dma_buffer->cached = false;
+		return;
+	}
+
 	astc_buffer_unmap(ctx, dma_buffer, dir);
 
 	astc_buffer_put_and_detach(dma_buffer);
@@ -1111,6 +1121,155 @@ static void astc_buffer_teardown(struct astc_dev *astc_device,
 	dev_dbg(astc_device->dev, "%s: END\n", __func__);
 }
 
+/**
+ * astc_map_entry_release() - Dismantle a mapping kept by a context
+ * @astc_device: the astc device struct
+ * @entry: the mapping, which is freed
+ *
+ * This does for @entry what astc_buffer_teardown() does for the buffer of
+ * a task.
+ */
+static void astc_map_entry_release(struct astc_dev *astc_device,
+				   struct astc_map_entry *entry)
+{
+	struct astc_buffer_dma dma_buffer = {
+		.plane = {
+			.dmabuf = entry->dmabuf,
+			.attachment = entry->attachment,
+			.sgt = entry->sgt,
+			.dma_addr = entry->dma_addr,
+		},
+	};
+
+	dev_dbg(astc_device->dev, "%s: releasing mapping of dmabuf %pK\n",
+		__func__, entry->dmabuf);
+
+	astc_unmap_buf_from_device(astc_device->dev, &dma_buffer);
+	astc_unmap_dma_attachment(astc_device->dev, &dma_buffer.plane,
+				  entry->dir);
+	dma_buf_detach(entry->dmabuf, entry->attachment);
+	dma_buf_put(entry->dmabuf);
+	kfree(entry);
+}
+
+static void astc_map_cache_release(struct astc_ctx *ctx)
+{
+	struct astc_map_entry *entry, *tmp;
+
+	list_for_each_entry_safe(entry, tmp, &ctx->map_cache, node) {
+		list_del(&entry->node);
+		astc_map_entry_release(ctx->astc_dev, entry);
+	}
+	ctx->map_cache_count = 0;
+}
+
+/**
+ * astc_buffer_setup_cached() - astc_buffer_setup() for a kept dmabuf mapping
+ * @ctx: the context of the task that is being setup
+ * @task: the task that is being setup
+ * @buffer: the userspace API struct representing the buffer
+ * @dma_buffer: the internal struct representing the buffer
+ * @dir: the direction of the DMA transfer this buffer will be used for.
+ *
+ * Look for a mapping of the dmabuf of @buffer kept by @ctx and large enough
+ * for the task. If there is none, set the buffer up as usual and keep its
+ * mapping in @ctx, dropping the least recently used one if there are too
+ * many. Either way the buffer is not unmapped at the end of the task.
+ *
+ * Return:
+ *	 0 on success,
+ *	<0 error code on failure
+ */
+static int astc_buffer_setup_cached(struct astc_ctx *ctx,
+				    struct astc_task *task,
+				    struct hwASTC_buffer *buffer,
+				    struct astc_buffer_dma *dma_buffer,
+				    enum dma_data_direction dir)
+{
+	struct astc_dev *astc_device = ctx->astc_dev;
+	struct astc_buffer_plane_dma *plane = &dma_buffer->plane;
+	struct astc_map_entry *entry;
+	struct dma_buf *dmabuf;
+	int ret;
+
+	dmabuf = dma_buf_get(buffer->fd);
+	if (IS_ERR(dmabuf)) {
+		dev_err(astc_device->dev,
+			"%s: failed to get dmabuf, err %ld\n", __func__,
+			PTR_ERR(dmabuf));
+		return PTR_ERR(dmabuf);
+	}
+
+	list_for_each_entry(entry, &ctx->map_cache, node) {
+		if (entry->dmabuf == dmabuf && entry->dir == dir &&
+		    entry->size >= plane->bytes_used) {
+			/* the entry holds a reference of its own */
+			dma_buf_put(dmabuf);
+			list_move(&entry->node, &ctx->map_cache);
+			goto found;
+		}
+	}
+	dma_buf_put(dmabuf);
+
+	entry = kzalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		return -ENOMEM;
+
+	ret = astc_buffer_get_and_attach(astc_device, buffer, dma_buffer);
+	if (ret) {
+		kfree(entry);
+		return ret;
+	}
+
+	dma_buffer->buffer = buffer;
+
+	ret = astc_buffer_map(ctx, task, dma_buffer, dir == DMA_TO_DEVICE);
+	if (ret) {
+		dev_err(astc_device->dev, "%s: Failed to prepare plane\n"
+			, __func__);
+		astc_buffer_put_and_detach(dma_buffer);
+		kfree(entry);
+		return ret;
+	}
+
+	entry->dmabuf = plane->dmabuf;
+	entry->attachment = plane->attachment;
+	entry->sgt = plane->sgt;
+	entry->dma_addr = plane->dma_addr;
+	entry->size = plane->bytes_used;
+	/* the same direction astc_buffer_map() mapped the attachment with */
+	entry->dir = dir == DMA_TO_DEVICE;
+
+	if (ctx->map_cache_count == ASTC_MAP_CACHE_SIZE) {
+		struct astc_map_entry *lru = list_last_entry(&ctx->map_cache,
+						struct astc_map_entry, node);
+
+		list_del(&lru->node);
+		astc_map_entry_release(astc_device, lru);
+		ctx->map_cache_count--;
+	}
+
+	list_add(&entry->node, &ctx->map_cache);
+	ctx->map_cache_count++;
+
+	dma_buffer->cached = true;
+
+	return 0;
+found:
+	dev_dbg(astc_device->dev, "%s: reusing mapping of dmabuf %pK at %pad\n",
+		__func__, entry->dmabuf, &entry->dma_addr);
+
+	plane->dmabuf = entry->dmabuf;
+	plane->attachment = entry->attachment;
+	plane->sgt = entry->sgt;
+	plane->dma_addr = entry->dma_addr;
+	plane->offset = 0;
+	dma_buffer->buffer = buffer;
+	dma_buffer->cached = true;
+
+	return 0;
+}
+
 /**
  * astc_buffer_setup() - Procedure that takes care of the complete buffer setup
  * @ctx: the context of the task that is being setup
@@ -1171,6 +1330,10 @@ static int astc_buffer_setup(struct astc_ctx *ctx,
 		return -EINVAL;
 	}
 
+	if (map_cache && buffer->type == HWASTC_BUFFER_DMABUF)
+		return astc_buffer_setup_cached(ctx, task, buffer,
+						dma_buffer, dir);
+
 	ret = astc_buffer_get_and_attach(astc_device, buffer, dma_buffer);
 
 	if (ret)
@@ -1966,6 +2129,7 @@ static void astc_destroy_context(struct kref *kreference)
 	list_del(&ctx->node);
 	spin_unlock_irqrestore(&astc_device->lock_ctx, flags);
 
+	astc_map_cache_release(ctx);
 	kfree(ctx);
 
 	dev_dbg(astc_device->dev, "%s: END\n", __func__);
@@ -2139,6 +2303,7 @@ static int astc_open(struct inode *inode, struct file *filp)
 		return -ENOMEM;
 
 	INIT_LIST_HEAD(&ctx->node);
+	INIT_LIST_HEAD(&ctx->map_cache);
 	kref_init(&ctx->kref);
 	mutex_init(&ctx->mutex);
 
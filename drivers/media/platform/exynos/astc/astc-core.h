@@ -81,6 +81,9 @@
  */
 #define ASTC_SUSPEND_TIMEOUT HZ/5
 
+/* max number of dmabuf mappings kept by a context, see astc_map_entry */
+#define ASTC_MAP_CACHE_SIZE 8
+
 #ifdef CONFIG_SOC_EXYNOS9810
 /*
  * use a separate define from the generic soc_exynos9810, as it's more convenient
@@ -150,6 +153,9 @@ struct astc_dev {
  * @mutex	: lock to prevent racing between tasks of the same context
  * @kref	: usage count of the context not to release the context while a
  *              : task being processed.
+ * @map_cache	: the dmabuf mappings kept for the next tasks, most recently
+ *                used first. Protected by @mutex.
+ * @map_cache_count: number of entries in @map_cache
  *
  * A context is used to serialize tasks of the same client (with a mutex) and
  * to provide a task with a place to store intermediate computations needed
@@ -176,6 +182,35 @@ struct astc_ctx {
 	struct list_head         node;
 	struct mutex             mutex;
 	struct kref              kref;
+
+	struct list_head         map_cache;
+	unsigned int             map_cache_count;
+};
+
+/**
+ * struct astc_map_entry - a dmabuf mapping kept across tasks
+ *
+ * @node	: node entry to astc_ctx.map_cache
+ * @dmabuf	: the dmabuf, the entry holds a reference to it
+ * @attachment	: the attachment of the device to @dmabuf
+ * @sgt		: the mapped attachment
+ * @dma_addr	: the address of @dmabuf in H/W address space
+ * @size	: the number of bytes mapped at @dma_addr
+ * @dir		: the direction of the DMA transfers the mapping is used for
+ *
+ * Clients transcoding many textures in a row tend to reuse the same few
+ * dmabufs. Attaching and mapping them again for each task showed up as a
+ * large share of the task setup time, so the mappings of HWASTC_BUFFER_DMABUF
+ * buffers can be kept by the context until it is destroyed.
+ */
+struct astc_map_entry {
+	struct list_head           node;
+	struct dma_buf            *dmabuf;
+	struct dma_buf_attachment *attachment;
+	struct sg_table           *sgt;
+	dma_addr_t                 dma_addr;
+	size_t                     size;
+	enum dma_data_direction    dir;
 };
 
 
@@ -243,10 +278,13 @@ struct astc_buffer_plane_dma {
  *
  * @buffer	: pointer to the userspace API buffer struct
  * @plane	: the corresponding internal buffer structure
+ * @cached	: @plane is borrowed from an astc_map_entry of the context and
+ *                must not be unmapped by the task
  */
 struct astc_buffer_dma {
 	const struct hwASTC_buffer  *buffer;
 	struct astc_buffer_plane_dma plane;
+	bool                         cached;
 };
 
 /**
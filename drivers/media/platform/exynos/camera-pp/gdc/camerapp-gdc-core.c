@@ -43,6 +43,17 @@ module_param_named(gdc_log_level, gdc_log_level, uint, S_IRUGO | S_IWUSR);
 int __gdc_measure_hw_latency;
 module_param_named(gdc_measure_hw_latency, __gdc_measure_hw_latency, int, 0644);
 
+/*
+ * If true, V4L2_BUF_FLAG_USE_SYNC is honored: the fence given in
+ * v4l2_buffer.reserved is waited for before the buffer is given to the H/W,
+ * and a fence signaled on buffer done is returned in its place. Then the
+ * frames from ISP can go through GDC to MFC without the userspace waiting
+ * for each of them, and GDC runs the next job as soon as the current is
+ * finished.
+ */
+static int gdc_use_sync;
+module_param(gdc_use_sync, int, 0644);
+
 #ifdef ENABLE_USE_INTERNAL_BUFFER
 dma_addr_t tpu_grid_x_addr;
 dma_addr_t tpu_grid_y_addr;
@@ -543,7 +554,8 @@ static int gdc_v4l2_qbuf(struct file *file, void *fh,
 	struct gdc_ctx *ctx = fh_to_gdc_ctx(fh);
 	gdc_dbg("v4l2_qbuf\n");
 
-	buf->flags &= ~V4L2_BUF_FLAG_USE_SYNC;
+	if (!gdc_use_sync)
+		buf->flags &= ~V4L2_BUF_FLAG_USE_SYNC;
 
 	return v4l2_m2m_qbuf(file, ctx->m2m_ctx, buf);
 }
@@ -806,6 +818,9 @@ static void gdc_vb2_stop_streaming(struct vb2_queue *vq)
 	struct gdc_ctx *ctx = vb2_get_drv_priv(vq);
 	int ret;
 
+	/* buffers still waiting for their fences must reach m2m_ctx first */
+	flush_workqueue(ctx->gdc_dev->fence_wq);
+
 	ret = gdc_ctx_stop_req(ctx);
 	if (ret < 0)
 		dev_err(ctx->gdc_dev->dev, "wait timeout\n");
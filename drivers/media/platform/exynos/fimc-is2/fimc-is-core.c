@@ -552,6 +552,33 @@ static ssize_t store_en_dvfs(struct device *dev,
 	return count;
 }
 
+static ssize_t show_dvfs_margin(struct device *dev, struct device_attribute *attr,
+				  char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%u\n", sysfs_debug.dvfs_margin);
+}
+
+static ssize_t store_dvfs_margin(struct device *dev,
+				 struct device_attribute *attr,
+				 const char *buf, size_t count)
+{
+	int ret = 0;
+	unsigned int cmd;
+
+	ret = kstrtouint(buf, 0, &cmd);
+	if (ret)
+		return ret;
+
+	if (cmd >= 100) {
+		pr_warn("%s: invalid paramter (%u)\n", __func__, cmd);
+		return -EINVAL;
+	}
+
+	sysfs_debug.dvfs_margin = cmd;
+
+	return count;
+}
+
 static ssize_t show_pattern_en(struct device *dev, struct device_attribute *attr,
 				  char *buf)
 {
@@ -903,6 +930,7 @@ static ssize_t store_en_fixed_sensor(struct device *dev,
 static DEVICE_ATTR(en_clk_gate, 0644, show_en_clk_gate, store_en_clk_gate);
 static DEVICE_ATTR(clk_gate_mode, 0644, show_clk_gate_mode, store_clk_gate_mode);
 static DEVICE_ATTR(en_dvfs, 0644, show_en_dvfs, store_en_dvfs);
+static DEVICE_ATTR(dvfs_margin, 0644, show_dvfs_margin, store_dvfs_margin);
 static DEVICE_ATTR(pattern_en, 0644, show_pattern_en, store_pattern_en);
 static DEVICE_ATTR(pattern_fps, 0644, show_pattern_fps, store_pattern_fps);
 static DEVICE_ATTR(hal_debug_mode, 0644, show_hal_debug_mode, store_hal_debug_mode);
@@ -929,6 +957,7 @@ static struct attribute *fimc_is_debug_entries[] = {
 	&dev_attr_en_clk_gate.attr,
 	&dev_attr_clk_gate_mode.attr,
 	&dev_attr_en_dvfs.attr,
+	&dev_attr_dvfs_margin.attr,
 	&dev_attr_pattern_en.attr,
 	&dev_attr_pattern_fps.attr,
 	&dev_attr_hal_debug_mode.attr,
@@ -1327,6 +1356,7 @@ static int __init fimc_is_probe(struct platform_device *pdev)
 	/* set sysfs for debuging */
 	sysfs_debug.en_clk_gate = 0;
 	sysfs_debug.en_dvfs = 1;
+	sysfs_debug.dvfs_margin = 0;
 	sysfs_debug.hal_debug_mode = 0;
 	sysfs_debug.hal_debug_delay = DBG_HAL_DEAD_PANIC_DELAY;
 #ifdef ENABLE_CLOCK_GATE
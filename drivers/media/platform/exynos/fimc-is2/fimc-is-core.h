@@ -232,6 +232,7 @@ struct fimc_is_sysfs_debug {
 	unsigned long pattern_fps;
 	unsigned long hal_debug_mode;
 	unsigned int hal_debug_delay;
+	unsigned int dvfs_margin;
 };
 
 #ifndef ENABLE_IS_CORE
@@ -550,12 +550,18 @@ static void csi_dma_tag(struct v4l2_subdev *subdev,
 	struct fimc_is_subdev *f_subdev;
 	struct fimc_is_framemgr *ldr_framemgr;
 	struct fimc_is_video_ctx *vctx = NULL;
-	struct fimc_is_frame *ldr_frame;
+	struct fimc_is_frame *ldr_frame = NULL;
 	struct fimc_is_frame *frame = NULL;
 	struct fimc_is_frame *frame_done = NULL;
 	int i = 0;
 
 	if (!test_bit(FIMC_IS_SUBDEV_INTERNAL_USE, &csi->dma_subdev[vc]->state)) {
+		/*
+		 * Only the queue transition needs the framemgr lock. Once the
+		 * frame is in COMPLETE nobody moves it again before it is
+		 * dequeued, so give it back to vb2 after dropping the lock
+		 * instead of keeping irqs off for the vb2 done and prints.
+		 */
 		framemgr_e_barrier_irqs(framemgr, 0, flags);
 
 		frame = peek_frame(framemgr, FS_PROCESS);
@@ -577,7 +583,11 @@ static void csi_dma_tag(struct v4l2_subdev *subdev,
 			findex = frame->stream->findex;
 			ldr_frame = &ldr_framemgr->frames[findex];
 			clear_bit(f_subdev->id, &ldr_frame->out_flag);
+		}
 
+		framemgr_x_barrier_irqr(framemgr, 0, flags);
+
+		if (frame) {
 			/* for debug */
 			for (i = 0; i < frame->num_buffers; i++)
 				DBG_DIGIT_TAG(GROUP_SLOT_MAX, 0, GET_QUEUE(vctx), frame,
@@ -593,8 +603,6 @@ static void csi_dma_tag(struct v4l2_subdev *subdev,
 			CALL_VOPS(vctx, done, frame->index, done_state);
 		}
 
-		framemgr_x_barrier_irqr(framemgr, 0, flags);
-
 		/* cache invalidate */
 		CALL_CACHE_BUFS_FINISH(vctx);
 
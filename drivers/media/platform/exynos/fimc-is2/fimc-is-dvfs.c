@@ -105,6 +105,10 @@ int fimc_is_dvfs_init(struct fimc_is_resourcemgr *resourcemgr)
 	/* init spin_lock for clock gating */
 	mutex_init(&dvfs_ctrl->lock);
 
+	spin_lock_init(&dvfs_ctrl->margin_slock);
+	dvfs_ctrl->margin_level = 0;
+	dvfs_ctrl->margin_samples = 0;
+
 	if (!(dvfs_ctrl->static_ctrl))
 		dvfs_ctrl->static_ctrl =
 			kzalloc(sizeof(struct fimc_is_dvfs_scenario_ctrl), GFP_KERNEL);
@@ -581,6 +585,9 @@ int fimc_is_set_dvfs(struct fimc_is_core *core, struct fimc_is_device_ischain *d
 	}
 #endif
 
+	/* a new scenario level, the closed loop starts over from it */
+	dvfs_ctrl->margin_level = 0;
+
 #if defined(QOS_INTCAM)
 	info("[RSC:%d]: New QoS [INT_CAM(%d), INT(%d), MIF(%d), CAM(%d), DISP(%d), I2C(%d), HPG(%d, %d)]\n",
 			device ? device->instance : 0, int_cam_qos, int_qos, mif_qos,
@@ -728,4 +735,174 @@ void fimc_is_dual_dvfs_update(struct fimc_is_device_ischain *device,
 	/* Update current mode to pre_mode. */
 	dual_info->pre_mode = dual_info->mode;
 }
+
+/*
+ * Closed-loop DVFS
+ *
+ * The static scenario tables pick CAM/INT_CAM for the worst case of a
+ * resolution and sensor mode. When sysfs debug/dvfs_margin is set, every
+ * m2m group done reports how much of the frame interval was left after
+ * its shot, and while the lowest margin over FIMC_IS_DVFS_MARGIN_SAMPLES
+ * stays above dvfs_margin percent, CAM/INT_CAM are stepped down to the
+ * next lower level found in the dvfs table. Below half of it they are
+ * stepped back up, and a frame that overran its interval restores the
+ * scenario level at once.
+ */
+void fimc_is_dvfs_margin_update(struct fimc_is_device_ischain *device,
+	struct fimc_is_group *group,
+	struct fimc_is_frame *frame)
+{
+	struct fimc_is_dvfs_ctrl *dvfs_ctrl = &device->resourcemgr->dvfs_ctrl;
+	u64 interval, elapsed;
+	u32 margin;
+	ulong flags;
+	int fps;
+
+	if (!sysfs_debug.dvfs_margin || !frame->shot_time)
+		return;
+
+	elapsed = ktime_get_ns() - frame->shot_time;
+	frame->shot_time = 0;
+
+	/* an otf group waits for the sensor, only m2m groups show the load */
+	if (test_bit(FIMC_IS_GROUP_OTF_INPUT, &group->state) ||
+		test_bit(FIMC_IS_ISCHAIN_REPROCESSING, &device->state) ||
+		!device->sensor)
+		return;
+
+	fps = fimc_is_sensor_g_framerate(device->sensor);
+	if (fps <= 0)
+		return;
+
+	interval = NSEC_PER_SEC / fps;
+	if (elapsed < interval)
+		margin = div64_u64((interval - elapsed) * 100, interval);
+	else
+		margin = 0;
+
+	spin_lock_irqsave(&dvfs_ctrl->margin_slock, flags);
+	if (!dvfs_ctrl->margin_samples || margin < dvfs_ctrl->margin_min)
+		dvfs_ctrl->margin_min = margin;
+	dvfs_ctrl->margin_samples++;
+	spin_unlock_irqrestore(&dvfs_ctrl->margin_slock, flags);
+}
+
+/* the level-th distinct dvfs table value of type below qos */
+static int fimc_is_dvfs_margin_step(struct fimc_is_core *core, u32 type,
+	int qos, int level)
+{
+	u32 dvfs_idx = core->resourcemgr.dvfs_ctrl.dvfs_table_idx;
+	int i, next, val;
+
+	if (dvfs_idx >= FIMC_IS_DVFS_TABLE_IDX_MAX)
+		dvfs_idx = 0;
+
+	while (level-- > 0) {
+		next = 0;
+		for (i = 0; i < FIMC_IS_SN_END; i++) {
+			val = core->pdata->dvfs_data[dvfs_idx][i][type];
+			if (val > 0 && val < qos && val > next)
+				next = val;
+		}
+
+		if (!next)
+			break;
+		qos = next;
+	}
+
+	return qos;
+}
+
+static void fimc_is_dvfs_margin_apply(struct fimc_is_core *core,
+	struct fimc_is_device_ischain *device, int level)
+{
+	struct fimc_is_dvfs_ctrl *dvfs_ctrl = &core->resourcemgr.dvfs_ctrl;
+	u32 scenario_id = dvfs_ctrl->static_ctrl->cur_scenario_id;
+	int cam_qos;
+#if defined(QOS_INTCAM)
+	int int_cam_qos, i2c_qos;
+#endif
+
+	cam_qos = fimc_is_get_qos(core, FIMC_IS_DVFS_CAM, scenario_id);
+	if (cam_qos > 0)
+		cam_qos = fimc_is_dvfs_margin_step(core, FIMC_IS_DVFS_CAM, cam_qos, level);
+#if defined(QOS_INTCAM)
+	int_cam_qos = fimc_is_get_qos(core, FIMC_IS_DVFS_INT_CAM, scenario_id);
+	if (int_cam_qos > 0)
+		int_cam_qos = fimc_is_dvfs_margin_step(core, FIMC_IS_DVFS_INT_CAM,
+					int_cam_qos, level);
+
+	/* nothing lower left in the table */
+	if (level > dvfs_ctrl->margin_level &&
+		cam_qos == dvfs_ctrl->cur_cam_qos &&
+		int_cam_qos == dvfs_ctrl->cur_int_cam_qos)
+		return;
+
+	if (int_cam_qos > 0 && dvfs_ctrl->cur_int_cam_qos != int_cam_qos) {
+		i2c_qos = fimc_is_get_qos(core, FIMC_IS_DVFS_I2C, scenario_id);
+		if (i2c_qos > 0 && fimc_is_itf_i2c_lock(device, i2c_qos, true)) {
+			err("fimc_is_itf_i2_clock fail\n");
+			return;
+		}
+
+		pm_qos_update_request(&exynos_isp_qos_int_cam, int_cam_qos);
+		dvfs_ctrl->cur_int_cam_qos = int_cam_qos;
+
+		if (i2c_qos > 0 && fimc_is_itf_i2c_lock(device, i2c_qos, false))
+			err("fimc_is_itf_i2c_unlock fail\n");
+	}
+#else
+	if (level > dvfs_ctrl->margin_level && cam_qos == dvfs_ctrl->cur_cam_qos)
+		return;
+#endif
+
+	if (cam_qos > 0 && dvfs_ctrl->cur_cam_qos != cam_qos) {
+		pm_qos_update_request(&exynos_isp_qos_cam, cam_qos);
+		dvfs_ctrl->cur_cam_qos = cam_qos;
+	}
+
+	dvfs_ctrl->margin_level = level;
+
+#if defined(QOS_INTCAM)
+	info("[RSC:%d]: Margin QoS [level(%d), INT_CAM(%d), CAM(%d)]\n",
+			device->instance, level, int_cam_qos, cam_qos);
+#else
+	info("[RSC:%d]: Margin QoS [level(%d), CAM(%d)]\n",
+			device->instance, level, cam_qos);
+#endif
+}
+
+/* called from the group shot with dvfs_ctrl lock held */
+void fimc_is_dvfs_margin_adjust(struct fimc_is_device_ischain *device)
+{
+	struct fimc_is_core *core = (struct fimc_is_core *)device->interface->core;
+	struct fimc_is_dvfs_ctrl *dvfs_ctrl = &device->resourcemgr->dvfs_ctrl;
+	u32 samples, margin;
+	ulong flags;
+	int level;
+
+	spin_lock_irqsave(&dvfs_ctrl->margin_slock, flags);
+	samples = dvfs_ctrl->margin_samples;
+	margin = dvfs_ctrl->margin_min;
+	if (samples >= FIMC_IS_DVFS_MARGIN_SAMPLES || (samples && !margin))
+		dvfs_ctrl->margin_samples = 0;
+	else
+		samples = 0;
+	spin_unlock_irqrestore(&dvfs_ctrl->margin_slock, flags);
+
+	level = dvfs_ctrl->margin_level;
+	if (!sysfs_debug.dvfs_margin)
+		level = 0;
+	else if (!samples)
+		return;
+	else if (!margin)
+		level = 0;
+	else if (margin >= sysfs_debug.dvfs_margin)
+		level++;
+	else if (margin < sysfs_debug.dvfs_margin / 2 && level > 0)
+		level--;
+
+	if (level != dvfs_ctrl->margin_level)
+		fimc_is_dvfs_margin_apply(core, device, level);
+}
 #endif
@@ -30,6 +30,7 @@
 #define	DVFS_SKIP		2 /* matched, but do not anything. skip changing dvfs */
 
 #define KEEP_FRAME_TICK_DEFAULT (5)
+#define FIMC_IS_DVFS_MARGIN_SAMPLES (30)
 #define FIMC_IS_DVFS_DUAL_TICK (4)
 #define DVFS_SN_STR(__SCENARIO) #__SCENARIO
 #define GET_DVFS_CHK_FUNC(__SCENARIO) check_ ## __SCENARIO
@@ -97,4 +98,8 @@ void fimc_is_dual_mode_update(struct fimc_is_device_ischain *device,
 void fimc_is_dual_dvfs_update(struct fimc_is_device_ischain *device,
 	struct fimc_is_group *group,
 	struct fimc_is_frame *frame);
+void fimc_is_dvfs_margin_update(struct fimc_is_device_ischain *device,
+	struct fimc_is_group *group,
+	struct fimc_is_frame *frame);
+void fimc_is_dvfs_margin_adjust(struct fimc_is_device_ischain *device);
 #endif
@@ -206,6 +206,7 @@ struct fimc_is_frame {
 	u32			result;
 	unsigned long		out_flag;
 	unsigned long		bak_flag;
+	u64			shot_time; /* for closed-loop dvfs */
 
 #ifndef ENABLE_IS_CORE
 	struct fimc_is_frame_info frame_info[MAX_FRAME_INFO];
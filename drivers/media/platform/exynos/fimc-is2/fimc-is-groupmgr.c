@@ -50,6 +50,10 @@
 /* sysfs variable for debug */
 extern struct fimc_is_sysfs_debug sysfs_debug;
 
+/* cpu list the group tasks may run on, e.g. "4-7" for the big cluster */
+static char gtask_cpus[32];
+module_param_string(gtask_cpus, gtask_cpus, sizeof(gtask_cpus), 0644);
+
 static inline void smp_shot_init(struct fimc_is_group *group, u32 value)
 {
 	atomic_set(&group->smp_shot_count, value);
@@ -961,6 +965,37 @@ static int fimc_is_group_task_probe(struct fimc_is_group_task *gtask,
 	return ret;
 }
 
+static void fimc_is_group_task_affinity(struct fimc_is_group_task *gtask)
+{
+	cpumask_var_t mask;
+	int ret;
+
+	if (!gtask_cpus[0]) {
+#if !defined(ENABLE_IS_CORE) && defined(SET_CPU_AFFINITY)
+		set_cpus_allowed_ptr(gtask->task, cpumask_of(2));
+#endif
+		return;
+	}
+
+	if (!alloc_cpumask_var(&mask, GFP_KERNEL))
+		return;
+
+	ret = cpulist_parse(gtask_cpus, mask);
+	if (!ret) {
+		cpumask_and(mask, mask, cpu_possible_mask);
+		if (cpumask_empty(mask))
+			ret = -EINVAL;
+		else
+			ret = set_cpus_allowed_ptr(gtask->task, mask);
+	}
+
+	if (ret)
+		err("failed to set group_task%d affinity(%s), err(%d)\n",
+			gtask->id, gtask_cpus, ret);
+
+	free_cpumask_var(mask);
+}
+
 static int fimc_is_group_task_start(struct fimc_is_groupmgr *groupmgr,
 	struct fimc_is_group_task *gtask,
 	struct fimc_is_framemgr *framemgr,
@@ -1000,10 +1035,8 @@ static int fimc_is_group_task_start(struct fimc_is_groupmgr *groupmgr,
 #ifdef ENABLE_FPSIMD_FOR_USER
 	fpsimd_set_task_using(gtask->task);
 #endif
-#ifdef SET_CPU_AFFINITY
-	ret = set_cpus_allowed_ptr(gtask->task, cpumask_of(2));
-#endif
 #endif
+	fimc_is_group_task_affinity(gtask);
 
 #ifdef ENABLE_SYNC_REPROCESSING
 	atomic_set(&gtask->rep_tick, 0);
@@ -3079,6 +3112,10 @@ int fimc_is_group_shot(struct fimc_is_groupmgr *groupmgr,
 	fimc_is_hw_shared_meta_update(device, group, frame, SHARED_META_SHOT);
 #endif
 
+#ifdef ENABLE_DVFS
+	frame->shot_time = ktime_get_ns();
+#endif
+
 	ret = group->shot_callback(device, frame);
 	if (unlikely(ret)) {
 		mgerr(" shot_callback is fail(%d)", group, group, ret);
@@ -3115,6 +3152,11 @@ int fimc_is_group_shot(struct fimc_is_groupmgr *groupmgr,
 			fimc_is_set_dvfs((struct fimc_is_core *)device->interface->core, device, static_ctrl->cur_scenario_id);
 		}
 
+		/* step below the static scenario only while no dynamic one holds */
+		if (!test_bit(FIMC_IS_ISCHAIN_REPROCESSING, &device->state) &&
+			(resourcemgr->dvfs_ctrl.dynamic_ctrl->cur_frame_tick < 0))
+			fimc_is_dvfs_margin_adjust(device);
+
 		mutex_unlock(&resourcemgr->dvfs_ctrl.lock);
 	}
 #endif
@@ -3255,6 +3297,11 @@ int fimc_is_group_done(struct fimc_is_groupmgr *groupmgr,
 	if (test_bit(FIMC_IS_GROUP_OTF_INPUT, &group->state))
 		fimc_is_sensor_dm_tag(device->sensor, frame);
 
+#ifdef ENABLE_DVFS
+	if (done_state == VB2_BUF_STATE_DONE)
+		fimc_is_dvfs_margin_update(device, group, frame);
+#endif
+
 #ifdef ENABLE_SHARED_METADATA
 	fimc_is_hw_shared_meta_update(device, group, frame, SHARED_META_SHOT_DONE);
 #else
@@ -63,6 +63,12 @@ struct fimc_is_dvfs_ctrl {
 	u32 dvfs_table_max;
 	ulong state;
 
+	/* closed-loop steps below the static scenario's CAM/INT_CAM level */
+	spinlock_t margin_slock;
+	int margin_level;
+	u32 margin_samples;	/* shot-to-done samples in the current window */
+	u32 margin_min;		/* lowest margin of the window, in percent */
+
 	struct fimc_is_dvfs_scenario_ctrl *static_ctrl;
 	struct fimc_is_dvfs_scenario_ctrl *dynamic_ctrl;
 	struct fimc_is_dvfs_scenario_ctrl *external_ctrl;
@@ -35,6 +35,9 @@
 #define I2C_MODE_BURST_DATA	(2 + I2C_MODE_BASE)
 #define I2C_MODE_DELAY	(3 + I2C_MODE_BASE)
 
+/* max data bytes of a sequential write, see fimc_is_sensor_write_seq() */
+#define I2C_SEQ_MAX	32
+
 int fimc_is_i2c_transfer(struct i2c_adapter *adapter, struct i2c_msg *msg, u32 size);
 int fimc_is_sensor_addr8_read8(struct i2c_client *client,
 	u8 addr, u8 *val);
@@ -56,4 +59,6 @@ int fimc_is_sensor_write16_array(struct i2c_client *client,
 	u16 addr, u16 *val, u32 num);
 int fimc_is_sensor_write16_burst(struct i2c_client *client,
 	u16 addr, u16 *val, u32 num);
+int fimc_is_sensor_write_seq(struct i2c_client *client,
+	u16 addr, const u32 *regs, u32 num, u32 width);
 #endif
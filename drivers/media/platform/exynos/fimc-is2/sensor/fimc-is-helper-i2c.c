@@ -474,3 +474,56 @@ int fimc_is_sensor_write16_burst(struct i2c_client *client,
 p_err:
 	return ret;
 }
+
+/*
+ * Write @num registers of @width bytes at consecutive addresses from @addr
+ * in a single transaction. The sensor auto increments the register index
+ * after each byte, so this is the same as writing them one by one, minus
+ * the start condition, slave and register address of each write.
+ * @regs points to the I2C_DATA of the first entry of a setfile table.
+ */
+int fimc_is_sensor_write_seq(struct i2c_client *client,
+	u16 addr, const u32 *regs, u32 num, u32 width)
+{
+	int ret = 0;
+	struct i2c_msg msg[1];
+	int i = 0;
+	u8 wbuf[2 + I2C_SEQ_MAX];
+	u8 *data = &wbuf[2];
+
+	if (num * width > I2C_SEQ_MAX || (width != 1 && width != 2)) {
+		pr_err("invalid sequential write, num(%d) width(%d)\n", num, width);
+		ret = -EINVAL;
+		goto p_err;
+	}
+
+	if (!client->adapter) {
+		pr_err("Could not find adapter!\n");
+		ret = -ENODEV;
+		goto p_err;
+	}
+
+	msg->addr = client->addr;
+	msg->flags = 0;
+	msg->len = 2 + (num * width);
+	msg->buf = wbuf;
+	wbuf[0] = (addr & 0xFF00) >> 8;
+	wbuf[1] = (addr & 0xFF);
+	for (i = 0; i < num; i++) {
+		if (width == 2)
+			*data++ = (regs[i * I2C_NEXT] & 0xFF00) >> 8;
+		*data++ = (regs[i * I2C_NEXT] & 0xFF);
+	}
+
+	ret = fimc_is_i2c_transfer(client->adapter, msg, 1);
+	if (ret < 0) {
+		pr_err("i2c treansfer fail(%d)", ret);
+		goto p_err;
+	}
+
+	i2c_info("I2CWSEQ(%d) [0x%04x] : %d regs\n", client->addr, addr, num);
+
+	return 0;
+p_err:
+	return ret;
+}
@@ -55,6 +55,28 @@ u32 sensor_cis_do_div64(u64 num, u32 den) {
 	return (u32)res;
 }
 
+/*
+ * Number of setfile entries from @i on that write registers of the same
+ * width at consecutive addresses, and so can go in one I2C transaction.
+ */
+static u32 sensor_cis_seq_num(const u32 *regs, u32 i, const u32 size)
+{
+	u32 width = regs[i + I2C_BYTE];
+	u32 num = 1;
+
+	if (width != 0x1 && width != 0x2)
+		return 1;
+
+	while (i + I2C_NEXT < size && (num + 1) * width <= I2C_SEQ_MAX &&
+	       regs[i + I2C_NEXT + I2C_BYTE] == width &&
+	       regs[i + I2C_NEXT + I2C_ADDR] == regs[i + I2C_ADDR] + width) {
+		i += I2C_NEXT;
+		num++;
+	}
+
+	return num;
+}
+
 int sensor_cis_set_registers(struct v4l2_subdev *subdev, const u32 *regs, const u32 size)
 {
 	int ret = 0;
@@ -63,6 +85,7 @@ int sensor_cis_set_registers(struct v4l2_subdev *subdev, const u32 *regs, const
 	struct i2c_client *client;
 	int index_str = 0, index_next = 0;
 	int burst_num = 1;
+	u32 seq_num;
 	u16 *addr_str = NULL;
 
 	FIMC_BUG(!subdev);
@@ -109,7 +132,17 @@ int sensor_cis_set_registers(struct v4l2_subdev *subdev, const u32 *regs, const
 			usleep_range(regs[i + I2C_DATA], regs[i + I2C_DATA]);
 			break;
 		default:
-			if (regs[i + I2C_BYTE] == 0x1) {
+			/* pack runs of consecutive registers into one write */
+			seq_num = sensor_cis_seq_num(regs, i, size);
+			if (seq_num > 1) {
+				ret = fimc_is_sensor_write_seq(client, regs[i + I2C_ADDR],
+						&regs[i + I2C_DATA], seq_num, regs[i + I2C_BYTE]);
+				if (ret < 0) {
+					err("fimc_is_sensor_write_seq fail, ret(%d), addr(%#x), num(%d)",
+							ret, regs[i + I2C_ADDR], seq_num);
+				}
+				i += (seq_num - 1) * I2C_NEXT;
+			} else if (regs[i + I2C_BYTE] == 0x1) {
 				ret = fimc_is_sensor_write8(client, regs[i + I2C_ADDR], regs[i + I2C_DATA]);
 				if (ret < 0) {
 					err("fimc_is_sensor_write8 fail, ret(%d), addr(%#x), data(%#x)",
@@ -136,6 +136,34 @@ struct g2d_qos_reqs {
 	struct pm_qos_request cluster0_req;
 };
 
+/*
+ * Register image of the last composition of a context. HWC sends the same
+ * layer setup frame after frame with only the buffers changed, so the writes
+ * done by g2d_hw_set_*() are recorded once and replayed on the following
+ * frames; only the buffer addresses are programmed again every time.
+ */
+#define G2D_CMDLIST_MAX_REGS	512
+
+struct g2d_cmdlist_layer {
+	u32 flags;
+	struct m2m1shot2_context_format fmt;
+	struct m2m1shot2_extra ext;
+};
+
+struct g2d_cmdlist {
+	bool valid;
+	unsigned int flags;
+	unsigned int num_sources;
+	/* the sources, then the target */
+	struct g2d_cmdlist_layer layer[G2D_MAX_SOURCES + 1];
+
+	unsigned int count;
+	struct {
+		u32 offset;
+		u32 val;
+	} regs[G2D_CMDLIST_MAX_REGS];
+};
+
 struct g2d1shot_dev {
 	struct m2m1shot2_device *oneshot2_dev;
 	struct device *dev;
@@ -170,6 +198,9 @@ struct g2d1shot_dev {
 	struct list_head		qos_contexts;
 
 	struct notifier_block pm_notifier;
+
+	/* the command list being recorded by g2d_reg_write() */
+	struct g2d_cmdlist *rec;
 };
 
 struct g2d1shot_ctx {
@@ -186,6 +217,8 @@ struct g2d1shot_ctx {
 	u64	w_bw;
 
 	struct g2d_qos_reqs pm_qos_reqs;
+
+	struct g2d_cmdlist *cmdlist;
 };
 
 /**
@@ -270,6 +303,24 @@ static inline void g2d_hw_init(struct g2d1shot_dev *g2d_dev)
 			g2d_dev->reg + G2D_SOFT_RESET_REG);
 }
 
+static inline void g2d_reg_write(struct g2d1shot_dev *g2d_dev,
+						u32 val, u32 offset)
+{
+	struct g2d_cmdlist *rec = g2d_dev->rec;
+
+	__raw_writel(val, g2d_dev->reg + offset);
+
+	if (!rec)
+		return;
+
+	/* an overflowed list is never marked valid */
+	if (rec->count < G2D_CMDLIST_MAX_REGS) {
+		rec->regs[rec->count].offset = offset;
+		rec->regs[rec->count].val = val;
+	}
+	rec->count++;
+}
+
 static inline u32 g2d_int_status(struct g2d1shot_dev *g2d_dev)
 {
 	return readl_relaxed(g2d_dev->reg + G2D_INTC_PEND_REG);
@@ -292,13 +343,13 @@ static inline void g2d_hw_set_source_color(struct g2d1shot_dev *g2d_dev,
 							int n, u32 color)
 {
 	/* set constant color */
-	__raw_writel(color, g2d_dev->reg + G2D_LAYERn_COLOR_REG(n));
+	g2d_reg_write(g2d_dev, color, G2D_LAYERn_COLOR_REG(n));
 }
 
 static inline void g2d_hw_set_source_type(struct g2d1shot_dev *g2d_dev,
 							int n, u32 select)
 {
-	__raw_writel(select, g2d_dev->reg + G2D_LAYERn_SELECT_REG(n));
+	g2d_reg_write(g2d_dev, select, G2D_LAYERn_SELECT_REG(n));
 }
 
 static inline void g2d_hw_set_dither(struct g2d1shot_dev *g2d_dev)
@@ -309,7 +360,7 @@ static inline void g2d_hw_set_dither(struct g2d1shot_dev *g2d_dev)
 	cfg = __raw_readl(g2d_dev->reg + G2D_BITBLT_COMMAND_REG);
 	cfg |= G2D_ENABLE_DITHER;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_BITBLT_COMMAND_REG);
+	g2d_reg_write(g2d_dev, cfg, G2D_BITBLT_COMMAND_REG);
 }
 
 const struct g2d_csc_fmt *find_colorspace(u32 v4l2_colorspace);
@@ -36,6 +36,9 @@ module_param(g2d_debug, int, S_IRUGO | S_IWUSR);
 int g2d_dump;
 module_param(g2d_dump, int, S_IRUGO | S_IWUSR);
 
+static int g2d_cmdlist;
+module_param(g2d_cmdlist, int, S_IRUGO | S_IWUSR);
+
 static void g2d_pm_qos_update_cpufreq(struct g2d_qos_reqs *reqs,
 				u32 freq_c1, u32 freq_c0)
 {
@@ -262,6 +265,12 @@ static int m2m1shot2_g2d_init_context(struct m2m1shot2_context *ctx)
 	if (!g2d_ctx)
 		return -ENOMEM;
 
+	g2d_ctx->cmdlist = kzalloc(sizeof(*g2d_ctx->cmdlist), GFP_KERNEL);
+	if (!g2d_ctx->cmdlist) {
+		ret = -ENOMEM;
+		goto err_cmdlist;
+	}
+
 	ctx->priv = g2d_ctx;
 
 	g2d_ctx->g2d_dev = g2d_dev;
@@ -278,6 +287,8 @@ static int m2m1shot2_g2d_init_context(struct m2m1shot2_context *ctx)
 
 	return 0;
 err_clk:
+	kfree(g2d_ctx->cmdlist);
+err_cmdlist:
 	kfree(g2d_ctx);
 
 	g2d_dbg_end_err();
@@ -296,6 +307,7 @@ static int m2m1shot2_g2d_free_context(struct m2m1shot2_context *ctx)
 	g2d_pm_qos_remove_all(g2d_ctx);
 
 	clk_unprepare(g2d_dev->clock);
+	kfree(g2d_ctx->cmdlist);
 	kfree(g2d_ctx);
 
 	g2d_dbg_end();
@@ -988,6 +1000,89 @@ static void clear_flipflop_for_nv12(struct m2m1shot2_context *ctx)
 		; /* polling the completion of execution of a bitblt */
 }
 
+/* flags that do not change what is programmed to the layer registers */
+#define G2D_CMDLIST_IGNORED_IMGFLAGS	(M2M1SHOT2_IMGFLAG_ACQUIRE_FENCE |	\
+					 M2M1SHOT2_IMGFLAG_RELEASE_FENCE |	\
+					 M2M1SHOT2_IMGFLAG_NO_CACHECLEAN |	\
+					 M2M1SHOT2_IMGFLAG_NO_CACHEINV)
+
+static void g2d_cmdlist_layer_get(struct g2d_cmdlist_layer *layer,
+		struct m2m1shot2_context_image *img,
+		struct m2m1shot2_extra *ext)
+{
+	memset(layer, 0, sizeof(*layer));
+	layer->flags = img->flags & ~G2D_CMDLIST_IGNORED_IMGFLAGS;
+	layer->fmt = img->fmt;
+	if (ext)
+		layer->ext = *ext;
+}
+
+/*
+ * Returns true if @cl was recorded for the layer setup of @ctx. Otherwise
+ * @cl is changed to describe the setup of @ctx and it has to be recorded.
+ */
+static bool g2d_cmdlist_match(struct m2m1shot2_context *ctx,
+			      struct g2d_cmdlist *cl)
+{
+	struct g2d_cmdlist_layer layer;
+	unsigned int flags = ctx->flags & M2M1SHOT2_FLAG_DITHER;
+	bool match;
+	int i;
+
+	match = cl->valid && cl->flags == flags &&
+		cl->num_sources == ctx->num_sources;
+
+	cl->flags = flags;
+	cl->num_sources = ctx->num_sources;
+
+	for (i = 0; i < ctx->num_sources; i++) {
+		g2d_cmdlist_layer_get(&layer, &ctx->source[i].img,
+				      &ctx->source[i].ext);
+		if (memcmp(&layer, &cl->layer[i], sizeof(layer))) {
+			cl->layer[i] = layer;
+			match = false;
+		}
+	}
+
+	g2d_cmdlist_layer_get(&layer, &ctx->target, NULL);
+	if (memcmp(&layer, &cl->layer[G2D_MAX_SOURCES], sizeof(layer))) {
+		cl->layer[G2D_MAX_SOURCES] = layer;
+		match = false;
+	}
+
+	if (!match) {
+		cl->valid = false;
+		cl->count = 0;
+	}
+
+	return match;
+}
+
+static void g2d_cmdlist_replay(struct g2d1shot_dev *g2d_dev,
+			       struct m2m1shot2_context *ctx,
+			       struct g2d_cmdlist *cl)
+{
+	struct m2m1shot2_context_image *target = &ctx->target;
+	unsigned int i;
+
+	for (i = 0; i < cl->count; i++)
+		__raw_writel(cl->regs[i].val, g2d_dev->reg + cl->regs[i].offset);
+
+	/* the buffers are the only thing that differs from the last frame */
+	for (i = 0; i < ctx->num_sources; i++) {
+		u32 img_flags = ctx->source[i].img.flags;
+
+		if (img_flags & M2M1SHOT2_IMGFLAG_COLORFILL)
+			continue;
+
+		g2d_hw_set_source_address(ctx, m2m1shot2_src_format(ctx, i),
+				g2d_dev, i, img_flags & M2M1SHOT2_IMGFLAG_COMPRESSED);
+	}
+
+	g2d_hw_set_dest_addr(ctx, m2m1shot2_dst_format(ctx), g2d_dev,
+			target->flags & M2M1SHOT2_IMGFLAG_COMPRESSED);
+}
+
 static int m2m1shot2_g2d_device_run(struct m2m1shot2_context *ctx)
 {
 	struct g2d1shot_ctx *g2d_ctx = ctx->priv;
@@ -1022,6 +1117,15 @@ static int m2m1shot2_g2d_device_run(struct m2m1shot2_context *ctx)
 	/* H/W initialization */
 	g2d_hw_init(g2d_dev);
 
+	if (g2d_cmdlist && g2d_cmdlist_match(ctx, g2d_ctx->cmdlist)) {
+		g2d_cmdlist_replay(g2d_dev, ctx, g2d_ctx->cmdlist);
+		goto programmed;
+	}
+
+	/* record the layer setup if it is to be replayed */
+	if (g2d_cmdlist)
+		g2d_dev->rec = g2d_ctx->cmdlist;
+
 	/* setting for user csc coeff */
 	g2d_hw_set_csc_coeff(g2d_ctx);
 
@@ -1034,6 +1138,12 @@ static int m2m1shot2_g2d_device_run(struct m2m1shot2_context *ctx)
 
 	g2d_hw_set_tile_direction(g2d_dev, ctx);
 
+	if (g2d_dev->rec) {
+		g2d_dev->rec->valid = g2d_dev->rec->count <= G2D_CMDLIST_MAX_REGS;
+		g2d_dev->rec = NULL;
+	}
+programmed:
+
 	/* setting for secure */
 	g2d_enable_secure(g2d_dev, ctx);
 
@@ -139,7 +139,7 @@ void g2d_hw_set_alpha_composite(struct g2d1shot_dev *g2d_dev,
 
 		if (galpha < 0xff)
 			cfg |= G2D_PREMULT_GLOBAL_ALPHA;
-		__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_COMMAND_REG(n));
+		g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_COMMAND_REG(n));
 		return;
 	}
 
@@ -180,11 +180,11 @@ void g2d_hw_set_alpha_composite(struct g2d1shot_dev *g2d_dev,
 		break;
 	}
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_BLEND_FUNCTION_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_BLEND_FUNCTION_REG(n));
 
 	cfg = __raw_readl(g2d_dev->reg + G2D_LAYERn_COMMAND_REG(n));
 	cfg |= G2D_ALPHA_BLEND_MODE;
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_COMMAND_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_COMMAND_REG(n));
 }
 
 void g2d_hw_set_source_blending(struct g2d1shot_dev *g2d_dev,
@@ -197,7 +197,7 @@ void g2d_hw_set_source_blending(struct g2d1shot_dev *g2d_dev,
 	cfg |= ext->galpha << 16;
 	cfg |= ext->galpha << 24;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_ALPHA_COLOR_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_ALPHA_COLOR_REG(n));
 
 	/* No more operations are needed for layer 0 */
 	if (n == 0)
@@ -218,7 +218,7 @@ void g2d_hw_set_source_premult(struct g2d1shot_dev *g2d_dev, int n, u32 flags)
 	else
 		cfg |= G2D_PREMULT_PER_PIXEL_MUL_GALPHA;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_COMMAND_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_COMMAND_REG(n));
 }
 
 void g2d_hw_set_source_format(struct g2d1shot_dev *g2d_dev, int n,
@@ -230,20 +230,20 @@ void g2d_hw_set_source_format(struct g2d1shot_dev *g2d_dev, int n,
 	u32 cfg;
 
 	/* set source rect */
-	__raw_writel(s->left, g2d_dev->reg + G2D_LAYERn_LEFT_REG(n));
-	__raw_writel(s->top, g2d_dev->reg + G2D_LAYERn_TOP_REG(n));
-	__raw_writel(s->left + s->width,
-			g2d_dev->reg + G2D_LAYERn_RIGHT_REG(n));
-	__raw_writel(s->top + s->height,
-			g2d_dev->reg + G2D_LAYERn_BOTTOM_REG(n));
+	g2d_reg_write(g2d_dev, s->left, G2D_LAYERn_LEFT_REG(n));
+	g2d_reg_write(g2d_dev, s->top, G2D_LAYERn_TOP_REG(n));
+	g2d_reg_write(g2d_dev, s->left + s->width,
+			G2D_LAYERn_RIGHT_REG(n));
+	g2d_reg_write(g2d_dev, s->top + s->height,
+			G2D_LAYERn_BOTTOM_REG(n));
 
 	/* set dest clip */
-	__raw_writel(d->left, g2d_dev->reg + G2D_LAYERn_DST_LEFT_REG(n));
-	__raw_writel(d->top, g2d_dev->reg + G2D_LAYERn_DST_TOP_REG(n));
-	__raw_writel(d->left + d->width,
-			g2d_dev->reg + G2D_LAYERn_DST_RIGHT_REG(n));
-	__raw_writel(d->top + d->height,
-			g2d_dev->reg + G2D_LAYERn_DST_BOTTOM_REG(n));
+	g2d_reg_write(g2d_dev, d->left, G2D_LAYERn_DST_LEFT_REG(n));
+	g2d_reg_write(g2d_dev, d->top, G2D_LAYERn_DST_TOP_REG(n));
+	g2d_reg_write(g2d_dev, d->left + d->width,
+			G2D_LAYERn_DST_RIGHT_REG(n));
+	g2d_reg_write(g2d_dev, d->top + d->height,
+			G2D_LAYERn_DST_BOTTOM_REG(n));
 
 	/* set pixel format and cbcr order */
 	cfg = fmt->value;
@@ -259,31 +259,31 @@ void g2d_hw_set_source_format(struct g2d1shot_dev *g2d_dev, int n,
 			cfg |= G2D_SWIZZLING_BGR;
 		}
 	}
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_COLOR_MODE_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_COLOR_MODE_REG(n));
 
 	/* image width and height */
 	if (compressed) {
 		/* set the width - 1 and height -1 on destination only */
 		cfg = ctx_fmt->fmt.width;
 		cfg = G2D_COMP_SET_WH(cfg);
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_LAYERn_IMAGE_WIDTH_REG(n));
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_LAYERn_IMAGE_WIDTH_REG(n));
 
 		cfg = ctx_fmt->fmt.height;
 		cfg = G2D_COMP_SET_WH(cfg);
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_LAYERn_IMAGE_HEIGHT_REG(n));
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_LAYERn_IMAGE_HEIGHT_REG(n));
 	} else if (is_yuv(fmt->value)) {
 		cfg = ctx_fmt->fmt.width;
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_LAYERn_IMAGE_WIDTH_REG(n));
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_LAYERn_IMAGE_WIDTH_REG(n));
 
 		cfg = ctx_fmt->fmt.height;
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_LAYERn_IMAGE_HEIGHT_REG(n));
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_LAYERn_IMAGE_HEIGHT_REG(n));
 	} else if (is_rgb(fmt->value)) { /* only RGB format */
 		cfg = (fmt->bpp[0] * ctx_fmt->fmt.width / 8);
-		__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_STRIDE_REG(n));
+		g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_STRIDE_REG(n));
 	}
 }
 
@@ -338,13 +338,13 @@ void g2d_hw_set_source_repeat(struct g2d1shot_dev *g2d_dev, int n,
 	else if (ext->yrepeat == M2M1SHOT2_REPEAT_NONE)
 		cfg |= G2D_LAYER_REPEAT_Y_CLAMP;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_REPEAT_MODE_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_REPEAT_MODE_REG(n));
 
 	/* repeat pad color */
 	if (ext->xrepeat == M2M1SHOT2_REPEAT_PAD ||
 			ext->yrepeat == M2M1SHOT2_REPEAT_PAD)
-		__raw_writel(ext->fillcolor,
-				g2d_dev->reg + G2D_LAYERn_PAD_VALUE_REG(n));
+		g2d_reg_write(g2d_dev, ext->fillcolor,
+				G2D_LAYERn_PAD_VALUE_REG(n));
 }
 
 #define MAX_PRECISION		16
@@ -404,8 +404,8 @@ void g2d_hw_set_source_scale(struct g2d1shot_dev *g2d_dev, int n,
 	if (wcfg == DEFAULT_SCALE_RATIO && hcfg == DEFAULT_SCALE_RATIO)
 		return;
 
-	__raw_writel(wcfg, g2d_dev->reg + G2D_LAYERn_XSCALE_REG(n));
-	__raw_writel(hcfg, g2d_dev->reg + G2D_LAYERn_YSCALE_REG(n));
+	g2d_reg_write(g2d_dev, wcfg, G2D_LAYERn_XSCALE_REG(n));
+	g2d_reg_write(g2d_dev, hcfg, G2D_LAYERn_YSCALE_REG(n));
 
 	/* scaling algorithm */
 	if (ext->scaler_filter == M2M1SHOT2_SCFILTER_BILINEAR)
@@ -415,7 +415,7 @@ void g2d_hw_set_source_scale(struct g2d1shot_dev *g2d_dev, int n,
 	else
 		mode = 0x0;
 
-	__raw_writel(mode, g2d_dev->reg + G2D_LAYERn_SCALE_CTRL_REG(n));
+	g2d_reg_write(g2d_dev, mode, G2D_LAYERn_SCALE_CTRL_REG(n));
 }
 
 void g2d_hw_set_source_rotate(struct g2d1shot_dev *g2d_dev, int n,
@@ -455,7 +455,7 @@ void g2d_hw_set_source_rotate(struct g2d1shot_dev *g2d_dev, int n,
 		}
 	}
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_DIRECT_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_DIRECT_REG(n));
 }
 
 void g2d_hw_set_tile_direction(struct g2d1shot_dev *g2d_dev,
@@ -480,7 +480,7 @@ void g2d_hw_set_tile_direction(struct g2d1shot_dev *g2d_dev,
 	}
 
 	if (rotate > non_rotate)
-		__raw_writel(0x1, g2d_dev->reg + G2D_TILE_DIRECTION_ORDER_REG);
+		g2d_reg_write(g2d_dev, 0x1, G2D_TILE_DIRECTION_ORDER_REG);
 }
 
 void g2d_hw_set_source_valid(struct g2d1shot_dev *g2d_dev, int n)
@@ -491,13 +491,13 @@ void g2d_hw_set_source_valid(struct g2d1shot_dev *g2d_dev, int n)
 	cfg = __raw_readl(g2d_dev->reg + G2D_LAYERn_COMMAND_REG(n));
 	cfg |= G2D_LAYER_VALID;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_COMMAND_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_COMMAND_REG(n));
 
 	/* set update layer flag */
 	cfg = __raw_readl(g2d_dev->reg + G2D_LAYER_UPDATE_REG);
 	cfg |= (1 << n);
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYER_UPDATE_REG);
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYER_UPDATE_REG);
 }
 
 void g2d_hw_set_dest_addr(struct m2m1shot2_context *ctx,
@@ -551,10 +551,10 @@ void g2d_hw_set_dest_format(struct g2d1shot_dev *g2d_dev,
 	bool compressed = flags & M2M1SHOT2_IMGFLAG_COMPRESSED;
 
 	/* set dest rect */
-	__raw_writel(d->left, g2d_dev->reg + G2D_DST_LEFT_REG);
-	__raw_writel(d->top, g2d_dev->reg + G2D_DST_TOP_REG);
-	__raw_writel(d->left + d->width, g2d_dev->reg + G2D_DST_RIGHT_REG);
-	__raw_writel(d->top + d->height, g2d_dev->reg + G2D_DST_BOTTOM_REG);
+	g2d_reg_write(g2d_dev, d->left, G2D_DST_LEFT_REG);
+	g2d_reg_write(g2d_dev, d->top, G2D_DST_TOP_REG);
+	g2d_reg_write(g2d_dev, d->left + d->width, G2D_DST_RIGHT_REG);
+	g2d_reg_write(g2d_dev, d->top + d->height, G2D_DST_BOTTOM_REG);
 
 	/* set dest pixelformat */
 	cfg = fmt->value;
@@ -572,33 +572,33 @@ void g2d_hw_set_dest_format(struct g2d1shot_dev *g2d_dev,
 	if (u_order)
 		cfg |= G2D_LAYER_UORDER_ADDR;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_DST_COLOR_MODE_REG);
+	g2d_reg_write(g2d_dev, cfg, G2D_DST_COLOR_MODE_REG);
 
 	if (compressed) {
 		cfg = ctx_fmt->fmt.width;
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_DST_IMAGE_WIDTH_REG);
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_DST_IMAGE_WIDTH_REG);
 
 		cfg = ctx_fmt->fmt.height;
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_DST_IMAGE_HEIGHT_REG);
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_DST_IMAGE_HEIGHT_REG);
 	} else if (is_yuv(fmt->value)) {
 		cfg = ctx_fmt->fmt.width;
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_DST_IMAGE_WIDTH_REG);
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_DST_IMAGE_WIDTH_REG);
 
 		cfg = ctx_fmt->fmt.height;
-		__raw_writel(cfg,
-			g2d_dev->reg + G2D_DST_IMAGE_HEIGHT_REG);
+		g2d_reg_write(g2d_dev, cfg,
+			G2D_DST_IMAGE_HEIGHT_REG);
 	} else if (is_rgb(fmt->value)) {
 		cfg = (fmt->bpp[0] * ctx_fmt->fmt.width / 8);
-		__raw_writel(cfg, g2d_dev->reg + G2D_DST_STRIDE_REG);
+		g2d_reg_write(g2d_dev, cfg, G2D_DST_STRIDE_REG);
 	}
 
 	/* set the [13:4] of the half of image for parallel processing */
 	cfg = ((int)(d->width / 2)) >> 4;
 	cfg |= G2D_DST_SPLIT_TILE_IDX_VFLAG;
-	__raw_writel(cfg, g2d_dev->reg + G2D_DST_SPLIT_TILE_IDX_REG);
+	g2d_reg_write(g2d_dev, cfg, G2D_DST_SPLIT_TILE_IDX_REG);
 }
 
 void g2d_hw_set_dest_premult(struct g2d1shot_dev *g2d_dev, u32 flags)
@@ -611,7 +611,7 @@ void g2d_hw_set_dest_premult(struct g2d1shot_dev *g2d_dev, u32 flags)
 	if (!(flags & M2M1SHOT2_IMGFLAG_PREMUL_ALPHA))
 		cfg |= G2D_DST_DE_PREMULT;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_BITBLT_COMMAND_REG);
+	g2d_reg_write(g2d_dev, cfg, G2D_BITBLT_COMMAND_REG);
 }
 
 static unsigned short csc_y2r[G2D_MAX_CSC_FMT][9] = {
@@ -682,7 +682,7 @@ void g2d_hw_set_csc_coeff(struct g2d1shot_ctx *g2d_ctx)
 			continue;
 
 		for (i = 0, j = 0; i < ARRAY_SIZE(csc_y2r[0]); i++, j += offset) {
-			writel_relaxed(csc_y2r[m][i], g2d_dev->reg +
+			g2d_reg_write(g2d_dev, csc_y2r[m][i],
 				G2D_LAYER_CSCn_COEFF00_REG(idx) + j);
 		}
 	}
@@ -703,7 +703,7 @@ void g2d_hw_set_source_ycbcr(struct g2d1shot_ctx *g2d_ctx, int n,
 	cfg = g2d_csc_fmt->range << G2D_LAYER_YCBCR_RANGE_SHIFT |
 			g2d_ctx->src_csc_value[n];
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_LAYERn_YCBCR_MODE_REG(n));
+	g2d_reg_write(g2d_dev, cfg, G2D_LAYERn_YCBCR_MODE_REG(n));
 }
 
 void g2d_hw_set_dest_ycbcr(struct g2d1shot_dev *g2d_dev,
@@ -728,5 +728,5 @@ void g2d_hw_set_dest_ycbcr(struct g2d1shot_dev *g2d_dev,
 	cfg |= G2D_CBCROFFSET_0_50 << G2D_LAYER_YCBCR_RANGE_OFFSET_X;
 	cfg |= G2D_CBCROFFSET_0_50 << G2D_LAYER_YCBCR_RANGE_OFFSET_Y;
 
-	__raw_writel(cfg, g2d_dev->reg + G2D_DST_YCBCR_MODE_REG);
+	g2d_reg_write(g2d_dev, cfg, G2D_DST_YCBCR_MODE_REG);
 }
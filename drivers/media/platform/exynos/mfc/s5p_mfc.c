@@ -374,6 +374,7 @@ static int mfc_init_instance(struct s5p_mfc_dev *dev, struct s5p_mfc_ctx *ctx)
 
 	dev->curr_ctx = ctx->num;
 	dev->preempt_ctx = MFC_NO_INSTANCE_SET;
+	dev->sched_last_ctx = MFC_NO_INSTANCE_SET;
 	dev->curr_ctx_is_drm = ctx->is_drm;
 
 	ret = s5p_mfc_init_hw(dev);
@@ -343,7 +343,10 @@ struct s5p_mfc_debugfs {
 	struct dentry *nal_q_dump;
 	struct dentry *nal_q_disable;
 	struct dentry *nal_q_parallel_disable;
+	struct dentry *nal_q_multi_ctx;
 	struct dentry *otf_dump;
+	struct dentry *sched_batch;
+	struct dentry *qos_target_util;
 };
 
 /**
@@ -712,6 +715,11 @@ struct s5p_mfc_dev {
 	int curr_ctx;
 	int preempt_ctx;
 
+	/* deadline scheduler, see mfc_sched_pick_ctx() */
+	int sched_last_ctx;
+	unsigned int sched_batch_cnt;
+	unsigned long sched_switch;
+
 	struct s5p_mfc_bits work_bits;
 
 	struct s5p_mfc_hwlock hwlock;
@@ -743,6 +751,7 @@ struct s5p_mfc_dev {
 #endif
 	int qos_has_enc_ctx;
 	struct mutex qos_mutex;
+	unsigned long qos_feedback_next;
 #endif
 	int id;
 	atomic_t clk_ref;
@@ -1368,6 +1377,17 @@ struct s5p_mfc_ctx {
 	unsigned long framerate;
 	unsigned long last_framerate;
 
+	/* deadline scheduler, in ns */
+	u64 sched_deadline;
+	u64 sched_start;
+	u64 sched_frame_ns;
+	unsigned long sched_sample;
+	unsigned long sched_late;
+
+	/* input stream size averages for the QoS feedback */
+	unsigned int qos_strm_fast;
+	unsigned int qos_strm_slow;
+
 	struct mfc_timestamp ts_array[MFC_TIME_INDEX];
 	struct list_head ts_list;
 	int ts_count;
@@ -23,7 +23,10 @@ extern unsigned int dbg_enable;
 extern unsigned int nal_q_dump;
 extern unsigned int nal_q_disable;
 extern unsigned int nal_q_parallel_disable;
+extern unsigned int nal_q_multi_ctx;
 extern unsigned int otf_dump;
+extern unsigned int sched_batch;
+extern unsigned int qos_target_util;
 
 #define mfc_debug(level, fmt, args...)				\
 	do {							\
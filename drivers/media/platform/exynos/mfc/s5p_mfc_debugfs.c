@@ -26,7 +26,10 @@ unsigned int dbg_enable;
 unsigned int nal_q_dump;
 unsigned int nal_q_disable;
 unsigned int nal_q_parallel_disable;
+unsigned int nal_q_multi_ctx;
 unsigned int otf_dump;
+unsigned int sched_batch;
+unsigned int qos_target_util;
 
 static int mfc_info_show(struct seq_file *s, void *unused)
 {
@@ -48,6 +51,8 @@ static int mfc_info_show(struct seq_file *s, void *unused)
 			dev->hwlock.owned_by_irq, dev->hwlock.wl_count);
 	if (dev->nal_q_handle)
 		seq_printf(s, "[NAL-Q] state: %d\n", dev->nal_q_handle->nal_q_state);
+	seq_printf(s, "[SCHED] batch: %u, switches: %lu\n",
+			sched_batch, dev->sched_switch);
 
 	seq_puts(s, ">> MFC device information(instance)\n");
 	for (i = 0; i < MFC_NUM_CONTEXTS; i++) {
@@ -67,6 +72,9 @@ static int mfc_info_show(struct seq_file *s, void *unused)
 				s5p_mfc_get_queue_count(&ctx->buf_queue_lock, &ctx->src_buf_nal_queue),
 				s5p_mfc_get_queue_count(&ctx->buf_queue_lock, &ctx->dst_buf_nal_queue),
 				s5p_mfc_get_queue_count(&ctx->buf_queue_lock, &ctx->ref_buf_queue));
+			seq_printf(s, "        sched(fps: %ld, frame_us: %llu, late: %lu)\n",
+				ctx->framerate / 1000, ctx->sched_frame_ns / NSEC_PER_USEC,
+				ctx->sched_late);
 		}
 	}
 
@@ -129,6 +137,12 @@ void s5p_mfc_init_debugfs(struct s5p_mfc_dev *dev)
 			0644, debugfs->root, &nal_q_disable);
 	debugfs->nal_q_parallel_disable = debugfs_create_u32("nal_q_parallel_disable",
 			0644, debugfs->root, &nal_q_parallel_disable);
+	debugfs->nal_q_multi_ctx = debugfs_create_u32("nal_q_multi_ctx",
+			0644, debugfs->root, &nal_q_multi_ctx);
 	debugfs->otf_dump = debugfs_create_u32("otf_dump",
 			0644, debugfs->root, &otf_dump);
+	debugfs->sched_batch = debugfs_create_u32("sched_batch",
+			0644, debugfs->root, &sched_batch);
+	debugfs->qos_target_util = debugfs_create_u32("qos_target_util",
+			0644, debugfs->root, &qos_target_util);
 }
@@ -744,6 +744,7 @@ static int vidioc_qbuf(struct file *file, void *priv, struct v4l2_buffer *buf)
 					buf->m.planes[0].bytesused);
 		} else {
 			mfc_debug(2, "Src input size = %d\n", buf->m.planes[0].bytesused);
+			s5p_mfc_qos_update_strm_size(ctx, buf->m.planes[0].bytesused);
 		}
 		ret = vb2_qbuf(&ctx->vq_src, buf);
 	} else {
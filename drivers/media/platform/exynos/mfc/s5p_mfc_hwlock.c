@@ -599,7 +599,7 @@ static int mfc_nal_q_just_run(struct s5p_mfc_ctx *ctx, int need_cache_flush)
 	case NAL_Q_STATE_CREATED:
 		s5p_mfc_nal_q_init(dev, nal_q_handle);
 	case NAL_Q_STATE_INITIALIZED:
-		if (s5p_mfc_nal_q_check_enable(dev) == 0) {
+		if (s5p_mfc_nal_q_check_enable(dev, ctx) == 0) {
 			/* NAL START */
 			ret = 1;
 		} else {
@@ -628,7 +628,7 @@ static int mfc_nal_q_just_run(struct s5p_mfc_ctx *ctx, int need_cache_flush)
 		}
 		break;
 	case NAL_Q_STATE_STARTED:
-		if (s5p_mfc_nal_q_check_enable(dev) == 0 ||
+		if (s5p_mfc_nal_q_check_enable(dev, ctx) == 0 ||
 				nal_q_handle->nal_q_exception) {
 			/* disable NAL QUEUE */
 			s5p_mfc_nal_q_stop(dev, nal_q_handle);
@@ -825,6 +825,8 @@ int s5p_mfc_just_run(struct s5p_mfc_dev *dev, int new_ctx_index)
 	if (need_cache_flush)
 		s5p_mfc_cache_flush(dev, ctx->is_drm);
 
+	s5p_mfc_sched_frame_start(ctx);
+
 	if (ctx->type == MFCINST_DECODER) {
 		ret = mfc_just_run_dec(ctx);
 	} else if (ctx->type == MFCINST_ENCODER) {
@@ -835,6 +837,8 @@ int s5p_mfc_just_run(struct s5p_mfc_dev *dev, int new_ctx_index)
 	}
 
 	if (ret) {
+		ctx->sched_start = 0;
+
 		/* Check again the ctx condition and clear work bits
 		 * if ctx is not available. */
 		if (s5p_mfc_ctx_ready(ctx) == 0 || ctx->clear_work_bit) {
@@ -865,6 +869,8 @@ void s5p_mfc_hwlock_handler_irq(struct s5p_mfc_dev *dev, struct s5p_mfc_ctx *cur
 		return;
 	}
 
+	s5p_mfc_sched_frame_done(curr_ctx);
+
 	spin_lock_irqsave(&dev->hwlock.lock, flags);
 	mfc_print_hwlock(dev);
 
@@ -28,12 +28,95 @@
 
 #ifdef NAL_Q_ENABLE
 #define CBR_I_LIMIT_MAX			5
-int s5p_mfc_nal_q_check_enable(struct s5p_mfc_dev *dev)
+static int mfc_nal_q_check_ctx(struct s5p_mfc_ctx *temp_ctx)
 {
-	struct s5p_mfc_ctx *temp_ctx;
 	struct s5p_mfc_dec *dec = NULL;
 	struct s5p_mfc_enc *enc = NULL;
 	struct s5p_mfc_enc_params *p = NULL;
+	int i = temp_ctx->num;
+
+	/* NAL-Q doesn't support drm */
+	if (temp_ctx->is_drm) {
+		mfc_debug(2, "There is a drm ctx. Can't start NAL-Q\n");
+		return 0;
+	}
+	/* NAL-Q can be enabled when all ctx are in running state */
+	if (temp_ctx->state != MFCINST_RUNNING &&
+			temp_ctx->state != MFCINST_RUNNING_NO_OUTPUT) {
+		mfc_debug(2, "There is a ctx which is not in running state. "
+				"index: %d, state: %d\n", i, temp_ctx->state);
+		return 0;
+	}
+	/* NAL-Q can't use the command about last frame */
+	if (s5p_mfc_is_last_frame(temp_ctx) == 1) {
+		mfc_debug(2, "There is a last frame. index: %d\n", i);
+		return 0;
+	}
+	/* NAL-Q doesn't support OTF mode */
+	if (temp_ctx->otf_handle) {
+		mfc_debug(2, "There is a OTF node.\n");
+		return 0;
+	}
+	/* NAL-Q doesn't support BPG */
+	if (IS_BPG_DEC(temp_ctx) || IS_BPG_ENC(temp_ctx)) {
+		mfc_debug(2, "BPG codec type\n");
+		return 0;
+	}
+	/* NAL-Q doesn't support multi-frame, interlaced, black bar */
+	if (temp_ctx->type == MFCINST_DECODER) {
+		dec = temp_ctx->dec_priv;
+		if (!dec) {
+			mfc_debug(2, "There is no dec\n");
+			return 0;
+		}
+		if ((dec->has_multiframe && CODEC_MULTIFRAME(temp_ctx)) || dec->consumed) {
+			mfc_debug(2, "There is a multi frame or consumed header.\n");
+			return 0;
+		}
+		if (dec->is_dpb_full) {
+			mfc_debug(2, "All buffers are referenced\n");
+			return 0;
+		}
+		if (dec->is_interlaced) {
+			mfc_debug(2, "There is a interlaced stream\n");
+			return 0;
+		}
+		if (dec->detect_black_bar) {
+			mfc_debug(2, "black bar detection is enabled\n");
+			return 0;
+		}
+	/* NAL-Q doesn't support fixed byte(slice mode), CBR_VT(rc mode) */
+	} else if (temp_ctx->type == MFCINST_ENCODER) {
+		enc = temp_ctx->enc_priv;
+		if (!enc) {
+			mfc_debug(2, "There is no enc\n");
+			return 0;
+		}
+		if (enc->slice_mode == V4L2_MPEG_VIDEO_MULTI_SLICE_MODE_MAX_FIXED_BYTES) {
+			mfc_debug(2, "There is fixed bytes option(slice mode)\n");
+			return 0;
+		}
+		p = &enc->params;
+		if (p->rc_reaction_coeff <= CBR_I_LIMIT_MAX) {
+			mfc_debug(2, "There is CBR_VT option(rc mode)\n");
+			return 0;
+		}
+	}
+	mfc_debug(2, "There is a ctx in running state. index: %d\n", i);
+
+	return 1;
+}
+
+/*
+ * Every queue entry carries the instance id of its context, so with
+ * nal_q_multi_ctx only @ctx, the context that is about to run, has to
+ * qualify. The others keep the queue going until they need a command
+ * NAL-Q can't carry, at which point they get here themselves and the
+ * queue is stopped for them.
+ */
+int s5p_mfc_nal_q_check_enable(struct s5p_mfc_dev *dev, struct s5p_mfc_ctx *ctx)
+{
+	struct s5p_mfc_ctx *temp_ctx;
 	int i;
 
 	mfc_debug_enter();
@@ -41,78 +124,18 @@ int s5p_mfc_nal_q_check_enable(struct s5p_mfc_dev *dev)
 	if (nal_q_disable)
 		return 0;
 
+	if (nal_q_multi_ctx) {
+		if (!mfc_nal_q_check_ctx(ctx))
+			return 0;
+		mfc_debug(2, "ctx %d can be run in NAL-Q!\n", ctx->num);
+		mfc_debug_leave();
+		return 1;
+	}
+
 	for (i = 0; i < MFC_NUM_CONTEXTS; i++) {
 		temp_ctx = dev->ctx[i];
-		if (temp_ctx) {
-			/* NAL-Q doesn't support drm */
-			if (temp_ctx->is_drm) {
-				mfc_debug(2, "There is a drm ctx. Can't start NAL-Q\n");
-				return 0;
-			}
-			/* NAL-Q can be enabled when all ctx are in running state */
-			if (temp_ctx->state != MFCINST_RUNNING &&
-					temp_ctx->state != MFCINST_RUNNING_NO_OUTPUT) {
-				mfc_debug(2, "There is a ctx which is not in running state. "
-						"index: %d, state: %d\n", i, temp_ctx->state);
-				return 0;
-			}
-			/* NAL-Q can't use the command about last frame */
-			if (s5p_mfc_is_last_frame(temp_ctx) == 1) {
-				mfc_debug(2, "There is a last frame. index: %d\n", i);
-				return 0;
-			}
-			/* NAL-Q doesn't support OTF mode */
-			if (temp_ctx->otf_handle) {
-				mfc_debug(2, "There is a OTF node.\n");
-				return 0;
-			}
-			/* NAL-Q doesn't support BPG */
-			if (IS_BPG_DEC(temp_ctx) || IS_BPG_ENC(temp_ctx)) {
-				mfc_debug(2, "BPG codec type\n");
-				return 0;
-			}
-			/* NAL-Q doesn't support multi-frame, interlaced, black bar */
-			if (temp_ctx->type == MFCINST_DECODER) {
-				dec = temp_ctx->dec_priv;
-				if (!dec) {
-					mfc_debug(2, "There is no dec\n");
-					return 0;
-				}
-				if ((dec->has_multiframe && CODEC_MULTIFRAME(temp_ctx)) || dec->consumed) {
-					mfc_debug(2, "There is a multi frame or consumed header.\n");
-					return 0;
-				}
-				if (dec->is_dpb_full) {
-					mfc_debug(2, "All buffers are referenced\n");
-					return 0;
-				}
-				if (dec->is_interlaced) {
-					mfc_debug(2, "There is a interlaced stream\n");
-					return 0;
-				}
-				if (dec->detect_black_bar) {
-					mfc_debug(2, "black bar detection is enabled\n");
-					return 0;
-				}
-			/* NAL-Q doesn't support fixed byte(slice mode), CBR_VT(rc mode) */
-			} else if (temp_ctx->type == MFCINST_ENCODER) {
-				enc = temp_ctx->enc_priv;
-				if (!enc) {
-					mfc_debug(2, "There is no enc\n");
-					return 0;
-				}
-				if (enc->slice_mode == V4L2_MPEG_VIDEO_MULTI_SLICE_MODE_MAX_FIXED_BYTES) {
-					mfc_debug(2, "There is fixed bytes option(slice mode)\n");
-					return 0;
-				}
-				p = &enc->params;
-				if (p->rc_reaction_coeff <= CBR_I_LIMIT_MAX) {
-					mfc_debug(2, "There is CBR_VT option(rc mode)\n");
-					return 0;
-				}
-			}
-			mfc_debug(2, "There is a ctx in running state. index: %d\n", i);
-		}
+		if (temp_ctx && !mfc_nal_q_check_ctx(temp_ctx))
+			return 0;
 	}
 
 	mfc_debug(2, "All working ctx are in running state!\n");
@@ -15,7 +15,7 @@
 
 #include "s5p_mfc_common.h"
 
-int s5p_mfc_nal_q_check_enable(struct s5p_mfc_dev *dev);
+int s5p_mfc_nal_q_check_enable(struct s5p_mfc_dev *dev, struct s5p_mfc_ctx *ctx);
 
 nal_queue_handle *s5p_mfc_nal_q_create(struct s5p_mfc_dev *dev);
 void s5p_mfc_nal_q_destroy(struct s5p_mfc_dev *dev, nal_queue_handle *nal_q_handle);
@@ -525,6 +525,76 @@ void s5p_mfc_qos_off(struct s5p_mfc_ctx *ctx)
 		mfc_qos_set(ctx, &mfc_bw, i);
 	}
 }
+
+/*
+ * Hardware time per frame of a context. A bitrate that goes up shows in
+ * the input stream sizes before it shows in the averaged frame times.
+ */
+static u64 mfc_qos_get_frame_ns(struct s5p_mfc_ctx *ctx)
+{
+	u64 frame_ns = ctx->sched_frame_ns;
+
+	if (ctx->qos_strm_slow && ctx->qos_strm_fast > ctx->qos_strm_slow)
+		frame_ns = div_u64(frame_ns * min(ctx->qos_strm_fast,
+					2 * ctx->qos_strm_slow), ctx->qos_strm_slow);
+
+	return frame_ns;
+}
+
+/*
+ * With qos_target_util set, move the QoS table index picked by the
+ * macroblock count to hold the hardware busy at that percentage: one step
+ * up when the measured utilization is above it, one step down when the
+ * utilization scaled by the MFC clock ratio of the lower step still is
+ * below it. Contexts without a recent frame time sample, like the ones
+ * running in NAL-Q, leave the index alone.
+ */
+void s5p_mfc_qos_feedback(struct s5p_mfc_ctx *ctx)
+{
+	struct s5p_mfc_dev *dev = ctx->dev;
+	struct s5p_mfc_platdata *pdata = dev->pdata;
+	struct s5p_mfc_qos *qos_table = pdata->qos_table;
+	struct s5p_mfc_ctx *qos_ctx;
+	u64 busy_ns = 0;
+	unsigned long util, util_down;
+	int cur, max_step, enc_found = 0;
+
+	if (!qos_target_util || time_before(jiffies, dev->qos_feedback_next))
+		return;
+	dev->qos_feedback_next = jiffies + msecs_to_jiffies(MFC_QOS_FEEDBACK_MS);
+
+	mutex_lock(&dev->qos_mutex);
+	cur = atomic_read(&dev->qos_req_cur) - 1;
+	if (cur < 0)
+		goto out;
+
+	list_for_each_entry(qos_ctx, &dev->qos_queue, qos_list) {
+		if (!qos_ctx->sched_frame_ns || time_after(jiffies,
+				qos_ctx->sched_sample + msecs_to_jiffies(MFC_QOS_SAMPLE_MS)))
+			goto out;
+		if (OVER_UHD_ENC60(qos_ctx))
+			enc_found = 1;
+		busy_ns += mfc_qos_get_frame_ns(qos_ctx) * (qos_ctx->framerate / 1000);
+	}
+
+	max_step = enc_found ? pdata->max_qos_steps : pdata->num_qos_steps;
+	util = (unsigned long)div_u64(busy_ns, NSEC_PER_SEC / 100);
+
+	if (util > qos_target_util && cur < max_step - 1) {
+		mfc_debug(2, "QoS feedback: util %ld%%, step %d -> %d\n",
+				util, cur, cur + 1);
+		mfc_qos_operate(ctx, MFC_QOS_UPDATE, cur + 1);
+	} else if (cur > 0 && qos_table[cur - 1].freq_mfc) {
+		util_down = (util * qos_table[cur].freq_mfc) / qos_table[cur - 1].freq_mfc;
+		if (util_down < qos_target_util) {
+			mfc_debug(2, "QoS feedback: util %ld%% (%ld%% below), step %d -> %d\n",
+					util, util_down, cur, cur - 1);
+			mfc_qos_operate(ctx, MFC_QOS_UPDATE, cur - 1);
+		}
+	}
+out:
+	mutex_unlock(&dev->qos_mutex);
+}
 #endif
 
 #define COL_FRAME_RATE		0
@@ -705,6 +775,8 @@ void s5p_mfc_qos_update_framerate(struct s5p_mfc_ctx *ctx)
 		ctx->framerate = ctx->last_framerate;
 		s5p_mfc_qos_on(ctx);
 	}
+
+	s5p_mfc_qos_feedback(ctx);
 }
 
 void s5p_mfc_qos_update_last_framerate(struct s5p_mfc_ctx *ctx, u64 timestamp)
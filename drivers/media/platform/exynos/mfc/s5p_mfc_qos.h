@@ -25,6 +25,9 @@
 
 #define MFC_DRV_TIME		500
 
+#define MFC_QOS_FEEDBACK_MS	100
+#define MFC_QOS_SAMPLE_MS	1000
+
 #define MFC_QOS_WEIGHT_3PLANE		80
 #define MFC_QOS_WEIGHT_OTHER_CODEC	25
 #define MFC_QOS_WEIGHT_10BIT		75
@@ -37,9 +40,11 @@
 #ifdef CONFIG_MFC_USE_BUS_DEVFREQ
 void s5p_mfc_qos_on(struct s5p_mfc_ctx *ctx);
 void s5p_mfc_qos_off(struct s5p_mfc_ctx *ctx);
+void s5p_mfc_qos_feedback(struct s5p_mfc_ctx *ctx);
 #else
 #define s5p_mfc_qos_on(ctx)	do {} while (0)
 #define s5p_mfc_qos_off(ctx)	do {} while (0)
+#define s5p_mfc_qos_feedback(ctx)	do {} while (0)
 #endif
 
 void s5p_mfc_qos_update_framerate(struct s5p_mfc_ctx *ctx);
@@ -53,6 +58,19 @@ static inline void s5p_mfc_qos_reset_framerate(struct s5p_mfc_ctx *ctx)
 		ctx->framerate = ENC_DEFAULT_FPS;
 }
 
+static inline void s5p_mfc_qos_update_strm_size(struct s5p_mfc_ctx *ctx,
+						unsigned int size)
+{
+	if (!ctx->qos_strm_slow) {
+		ctx->qos_strm_fast = size;
+		ctx->qos_strm_slow = size;
+		return;
+	}
+
+	ctx->qos_strm_fast = (ctx->qos_strm_fast + size) >> 1;
+	ctx->qos_strm_slow = (ctx->qos_strm_slow * 15 + size) >> 4;
+}
+
 static inline void s5p_mfc_qos_reset_last_framerate(struct s5p_mfc_ctx *ctx)
 {
 	ctx->last_framerate = 0;
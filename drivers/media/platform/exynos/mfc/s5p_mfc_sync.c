@@ -12,6 +12,7 @@
 
 #include "s5p_mfc_sync.h"
 
+#include "s5p_mfc_qos.h"
 #include "s5p_mfc_queue.h"
 
 #define R2H_BIT(x)	(((x) > 0) ? (1 << ((x) - 1)) : 0)
@@ -125,6 +126,115 @@ void s5p_mfc_wake_up_ctx(struct s5p_mfc_ctx *ctx, unsigned int reason,
 	wake_up(&ctx->cmd_wq);
 }
 
+static u64 mfc_sched_period_ns(struct s5p_mfc_ctx *ctx)
+{
+	unsigned long fps = ctx->framerate ? ctx->framerate : DEC_DEFAULT_FPS;
+
+	return div_u64(NSEC_PER_SEC * 1000ULL, fps);
+}
+
+/*
+ * The frame a context starts next is due one frame period after the
+ * previous one was, or after now if the context has been idle for longer
+ * than that.
+ */
+static u64 mfc_sched_next_deadline(struct s5p_mfc_ctx *ctx, u64 now)
+{
+	u64 period = mfc_sched_period_ns(ctx);
+
+	if (ctx->sched_deadline && now <= ctx->sched_deadline + period)
+		return ctx->sched_deadline + period;
+	return now + period;
+}
+
+/*
+ * Should be called with work_bits.lock
+ *
+ * Earliest deadline first among the ready contexts. The context that ran
+ * last keeps the hardware for up to sched_batch frames in a row as long as
+ * one more of its frames still lets the most urgent other context meet its
+ * deadline, which saves the firmware a context restore per frame.
+ */
+static int mfc_sched_pick_ctx(struct s5p_mfc_dev *dev)
+{
+	struct s5p_mfc_ctx *ctx, *curr = NULL, *best = NULL;
+	u64 now = ktime_get_ns();
+	u64 deadline, best_deadline = 0;
+	int i;
+
+	for (i = 0; i < MFC_NUM_CONTEXTS; i++) {
+		ctx = dev->ctx[i];
+		if (!ctx || !test_bit(i, &dev->work_bits.bits))
+			continue;
+
+		if (i == dev->sched_last_ctx) {
+			curr = ctx;
+			continue;
+		}
+
+		deadline = mfc_sched_next_deadline(ctx, now);
+		if (!best || deadline < best_deadline) {
+			best = ctx;
+			best_deadline = deadline;
+		}
+	}
+
+	if (!best)
+		return curr ? curr->num : -EAGAIN;
+
+	if (curr) {
+		if (mfc_sched_next_deadline(curr, now) <= best_deadline)
+			return curr->num;
+		if (dev->sched_batch_cnt < sched_batch &&
+		    now + curr->sched_frame_ns + best->sched_frame_ns <= best_deadline) {
+			mfc_debug(2, "keep ctx %d, ctx %d can wait\n",
+					curr->num, best->num);
+			return curr->num;
+		}
+	}
+
+	return best->num;
+}
+
+/* Called right before a frame of @ctx is started on the hardware */
+void s5p_mfc_sched_frame_start(struct s5p_mfc_ctx *ctx)
+{
+	struct s5p_mfc_dev *dev = ctx->dev;
+	u64 now = ktime_get_ns();
+
+	ctx->sched_deadline = mfc_sched_next_deadline(ctx, now);
+	ctx->sched_start = now;
+
+	if (dev->sched_last_ctx == ctx->num) {
+		dev->sched_batch_cnt++;
+	} else {
+		dev->sched_last_ctx = ctx->num;
+		dev->sched_batch_cnt = 1;
+		dev->sched_switch++;
+	}
+}
+
+/* Called from the interrupt that ends the frame of @ctx */
+void s5p_mfc_sched_frame_done(struct s5p_mfc_ctx *ctx)
+{
+	u64 now = ktime_get_ns();
+	u64 elapsed;
+
+	if (!ctx->sched_start)
+		return;
+
+	elapsed = now - ctx->sched_start;
+	ctx->sched_start = 0;
+	ctx->sched_sample = jiffies;
+	if (ctx->sched_frame_ns)
+		ctx->sched_frame_ns = (ctx->sched_frame_ns * 7 + elapsed) >> 3;
+	else
+		ctx->sched_frame_ns = elapsed;
+
+	if (now > ctx->sched_deadline)
+		ctx->sched_late++;
+}
+
 int s5p_mfc_get_new_ctx(struct s5p_mfc_dev *dev)
 {
 	unsigned long wflags;
@@ -156,6 +266,12 @@ int s5p_mfc_get_new_ctx(struct s5p_mfc_dev *dev)
 			}
 		}
 
+		if (sched_batch) {
+			new_ctx_index = mfc_sched_pick_ctx(dev);
+			spin_unlock_irqrestore(&dev->work_bits.lock, wflags);
+			return new_ctx_index;
+		}
+
 		new_ctx_index = (dev->curr_ctx + 1) % MFC_NUM_CONTEXTS;
 		while (!test_bit(new_ctx_index, &dev->work_bits.bits)) {
 			new_ctx_index = (new_ctx_index + 1) % MFC_NUM_CONTEXTS;
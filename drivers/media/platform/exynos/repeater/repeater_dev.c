@@ -256,6 +256,8 @@ void encoding_work_handler(struct work_struct *work)
 	int64_t required_delay;
 	unsigned long flags;
 	struct delayed_work *enc_work;
+	struct encoding_param enc_param;
+	bool encode = false;
 
 	print_repeater_debug(RPT_INT_INFO, "%s++\n", __func__);
 
@@ -327,12 +329,8 @@ void encoding_work_handler(struct work_struct *work)
 		ctx->buf_idx_dump = buf_idx;
 		wake_up_interruptible(&ctx->wait_queue_dump);
 		set_encoding_start(shr_bufs, buf_idx);
-		ret = s5p_mfc_hwfc_encode(buf_idx, buf_idx, &ctx->enc_param);
-		if (ret != HWFC_ERR_NONE) {
-			print_repeater_debug(RPT_ERROR,
-				"s5p_mfc_hwfc_encode failed %d\n", ret);
-			ret = set_encoding_done(shr_bufs);
-		}
+		enc_param = ctx->enc_param;
+		encode = true;
 	}
 
 	do {
@@ -358,6 +356,23 @@ void encoding_work_handler(struct work_struct *work)
 
 	spin_unlock_irqrestore(&repeater_spinlock, flags);
 
+	/*
+	 * The buffer is owned by the encoder from SHARED_BUF_ENCODE on, so
+	 * kick MFC without the lock that DECON takes from its frame done
+	 * interrupt. stop and pause cancel this work synchronously before
+	 * the buffers or the context go away.
+	 */
+	if (encode) {
+		ret = s5p_mfc_hwfc_encode(buf_idx, buf_idx, &enc_param);
+		if (ret != HWFC_ERR_NONE) {
+			print_repeater_debug(RPT_ERROR,
+				"s5p_mfc_hwfc_encode failed %d\n", ret);
+			spin_lock_irqsave(&repeater_spinlock, flags);
+			set_encoding_done(shr_bufs);
+			spin_unlock_irqrestore(&repeater_spinlock, flags);
+		}
+	}
+
 	print_repeater_debug(RPT_INT_INFO, "%s--\n", __func__);
 }
 
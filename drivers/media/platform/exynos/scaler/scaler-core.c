@@ -3552,6 +3552,31 @@ static void sc_m2m1shot_timeout_task(struct m2m1shot_context *m21ctx,
 	sc_run_next_job(sc);
 }
 
+/*
+ * Without a frame rate from the user, run the whole batch at the highest
+ * QoS level and drop it afterwards instead of ramping up for every task.
+ */
+static int sc_m2m1shot_begin_batch(struct m2m1shot_context *m21ctx,
+				unsigned int count)
+{
+	struct sc_ctx *ctx = m21ctx->priv;
+	struct sc_dev *sc = ctx->sc_dev;
+
+	if (sc->qos_table && !ctx->framerate && count > 1)
+		sc_request_devfreq(&ctx->pm_qos, sc->qos_table, 0);
+
+	return 0;
+}
+
+static void sc_m2m1shot_end_batch(struct m2m1shot_context *m21ctx)
+{
+	struct sc_ctx *ctx = m21ctx->priv;
+	struct sc_dev *sc = ctx->sc_dev;
+
+	if (sc->qos_table && !ctx->framerate)
+		sc_remove_devfreq(&ctx->pm_qos, sc->qos_table);
+}
+
 static const struct m2m1shot_devops sc_m2m1shot_ops = {
 	.init_context = sc_m2m1shot_init_context,
 	.free_context = sc_m2m1shot_free_context,
@@ -3561,6 +3586,8 @@ static const struct m2m1shot_devops sc_m2m1shot_ops = {
 	.finish_buffer = sc_m2m1shot_finish_buffer,
 	.device_run = sc_m2m1shot_device_run,
 	.timeout_task = sc_m2m1shot_timeout_task,
+	.begin_batch = sc_m2m1shot_begin_batch,
+	.end_batch = sc_m2m1shot_end_batch,
 };
 
 static int __attribute__((unused)) sc_sysmmu_fault_handler(struct iommu_domain *domain,
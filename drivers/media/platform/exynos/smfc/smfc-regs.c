@@ -123,13 +123,40 @@ static inline u32 smfc_calc_quantizers(unsigned int idx, unsigned int factor,
 }
 #pragma GCC diagnostic pop
 
-static void smfc_hwconfigure_qtable(void __iomem *reg, unsigned int factor,
-				    const u8 table[])
+static void smfc_calc_qtable(u32 quants[], unsigned int factor,
+			     const u8 table[])
 {
 	size_t i;
 
 	for (i = 0; i < SMFC_MCU_SIZE; i += 4)
-		__raw_writel(smfc_calc_quantizers(i, factor, table), reg + i);
+		quants[i / 4] = smfc_calc_quantizers(i, factor, table);
+}
+
+/*
+ * Scaling the default tables costs 128 divisions for every image. Keep the
+ * result for @qfactor in @ctx and only write it to H/W in the following jobs.
+ * @idx 0 is for the main image and 1 is for the secondary image.
+ */
+static void smfc_hwconfigure_qtables(struct smfc_ctx *ctx, void __iomem *reg,
+				     unsigned int qfactor, unsigned int idx)
+{
+	u32 *luma = ctx->qtbl_cache[idx * 2];
+	u32 *chroma = ctx->qtbl_cache[idx * 2 + 1];
+	size_t i;
+
+	if (ctx->qtbl_qfactor[idx] != qfactor) {
+		unsigned int factor;
+
+		factor = (qfactor < 50) ? 5000 / qfactor : 200 - qfactor * 2;
+		smfc_calc_qtable(luma, factor, default_luma_qtbl);
+		smfc_calc_qtable(chroma, factor, default_chroma_qtbl);
+		ctx->qtbl_qfactor[idx] = qfactor;
+	}
+
+	for (i = 0; i < SMFC_MCU_SIZE / 4; i++) {
+		__raw_writel(luma[i], reg + i * sizeof(u32));
+		__raw_writel(chroma[i], reg + SMFC_MCU_SIZE + i * sizeof(u32));
+	}
 }
 
 static void smfc_hwconfigure_custom_qtable(void __iomem *reg, const u8 table[])
@@ -154,11 +181,7 @@ void smfc_hwconfigure_tables(struct smfc_ctx *ctx,
 	void __iomem *base = ctx->smfc->reg;
 
 	if (qfactor > 0) {
-		qfactor = (qfactor < 50) ? 5000 / qfactor : 200 - qfactor * 2;
-		smfc_hwconfigure_qtable(base + REG_QTBL_BASE,
-					qfactor, default_luma_qtbl);
-		smfc_hwconfigure_qtable(base + REG_QTBL_BASE + SMFC_MCU_SIZE,
-					qfactor, default_chroma_qtbl);
+		smfc_hwconfigure_qtables(ctx, base + REG_QTBL_BASE, qfactor, 0);
 	} else {
 		smfc_hwconfigure_custom_qtable(base + REG_QTBL_BASE, qtbl);
 		smfc_hwconfigure_custom_qtable(
@@ -199,11 +222,8 @@ void smfc_hwconfigure_2nd_tables(struct smfc_ctx *ctx, unsigned int qfactor)
 	/* Qunatiazation table 2 and 3 will be used by the secondary image */
 	void __iomem *base = ctx->smfc->reg;
 	void __iomem *qtblbase = base + REG_QTBL_BASE + SMFC_MCU_SIZE * 2;
-	qfactor = (qfactor < 50) ? 5000 / qfactor : 200 - qfactor * 2;
 
-	smfc_hwconfigure_qtable(qtblbase, qfactor, default_luma_qtbl);
-	smfc_hwconfigure_qtable(qtblbase + SMFC_MCU_SIZE,
-				qfactor, default_chroma_qtbl);
+	smfc_hwconfigure_qtables(ctx, qtblbase, qfactor, 1);
 	/* Huffman table for the secondary image is the same as the main image */
 	__raw_writel(VAL_SEC_TABLE_SELECT, base + REG_SEC_TABLE_SELECT);
 	__raw_writel(SMFC_DHT_LEN, base + REG_SEC_DHT_LEN);
@@ -190,6 +190,14 @@ struct smfc_ctx {
 	__u32 thumb_height;
 	unsigned char thumb_quality_factor;
 	unsigned char enable_hwfc;
+	/*
+	 * quantizers of the main ([0], [1]) and the secondary ([2], [3])
+	 * images scaled for qtbl_qfactor[0] and [1], 0 if not computed yet.
+	 * The quality factors rarely change during the burst of frames of a
+	 * streaming session.
+	 */
+	unsigned char qtbl_qfactor[2];
+	u32 qtbl_cache[4][SMFC_MCU_SIZE / 4];
 
 	/* Decompression settings */
 	struct smfc_decomp_qtable *quantizer_tables;
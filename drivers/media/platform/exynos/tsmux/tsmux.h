@@ -187,6 +187,8 @@ struct tsmux_rtp_ts_info {
 	_IOW('A', 0x16, int32_t)
 #define TSMUX_IOCTL_OTF_SET_CONFIG		\
 	_IOW('A', 0x17, struct tsmux_otf_config)
+#define TSMUX_IOCTL_OTF_SET_SOCK		\
+	_IOW('A', 0x18, int32_t)
 
 #define TSMUX_IOCTL_SET_RTP_TS_INFO		\
 	_IOW('A', 0x20, struct tsmux_rtp_ts_info)
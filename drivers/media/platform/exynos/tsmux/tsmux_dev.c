@@ -17,6 +17,9 @@
 #include <linux/clk.h>
 #include <linux/pm_runtime.h>
 #include <linux/exynos_iovmm.h>
+#include <linux/file.h>
+#include <linux/in.h>
+#include <net/sock.h>
 
 #include "tsmux_dev.h"
 #include "tsmux_reg.h"
@@ -31,8 +34,10 @@
 
 #ifdef ADD_NULL_TS_PACKET
 #define TS_PKT_COUNT_PER_RTP    6
+#define NULL_TS_PACKET_SIZE     188
 #else
 #define TS_PKT_COUNT_PER_RTP    7
+#define NULL_TS_PACKET_SIZE     0
 #endif
 
 #define RTP_HEADER_SIZE     12
@@ -423,6 +428,7 @@ static int tsmux_open(struct inode *inode, struct file *filp)
 
 	init_waitqueue_head(&ctx->m2m_wait_queue);
 	init_waitqueue_head(&ctx->otf_wait_queue);
+	mutex_init(&ctx->otf_sock_lock);
 
 	ctx->otf_buf_mapped = false;
 
@@ -460,6 +466,9 @@ static int tsmux_release(struct inode *inode, struct file *filp)
 
 	tsmux_clear_hex_ctrl();
 
+	if (ctx->otf_sock)
+		sockfd_put(ctx->otf_sock);
+
 #ifdef CLK_ENABLE
 	clk_disable(tsmux_dev->tsmux_clock);
 #endif
@@ -1195,6 +1204,8 @@ void tsmux_print_context_info(struct tsmux_context *ctx)
 			ctx->rtp_ts_info.ts_video_cc, ctx->rtp_ts_info.ts_audio_cc);
 	print_tsmux(TSMUX_ERR, "audio_frame_cnt: %lld, video_frame_cnt: %lld\n",
 			ctx->audio_frame_count, ctx->video_frame_count);
+	print_tsmux(TSMUX_ERR, "otf_sock: %pK, otf_sent_cnt: %lld, otf_drop_cnt: %lld\n",
+			ctx->otf_sock, ctx->otf_sent_count, ctx->otf_drop_count);
 }
 
 void tsmux_sfr_dump(void)
@@ -1629,6 +1640,88 @@ static bool tsmux_ioctl_otf_q_buf(struct tsmux_context *ctx)
 	return true;
 }
 
+/*
+ * Send the RTP packets of a dequeued OTF buffer to the socket set with
+ * TSMUX_IOCTL_OTF_SET_SOCK, one datagram each, instead of having the user
+ * issue a sendto() per packet. The null ts packet appended at the end of
+ * the frame goes out with the last RTP packet. The buffer stays dequeued
+ * until the user queues it back as before.
+ */
+static void tsmux_otf_send_buf(struct tsmux_context *ctx, int index)
+{
+	struct msghdr msg = { .msg_flags = MSG_DONTWAIT };
+	struct kvec iov;
+	char *data;
+	int rtp_len, remain, len, ret;
+	int sent = 0, dropped = 0;
+
+	if (index < 0 || index >= TSMUX_OUT_BUF_CNT)
+		return;
+
+	data = ctx->otf_outbuf_info[index].vaddr;
+	if (!data)
+		return;
+
+	rtp_len = TS_PACKET_SIZE * ctx->otf_cmd_queue.config.pkt_ctrl.rtp_size +
+		RTP_HEADER_SIZE;
+	remain = ctx->otf_cmd_queue.out_buf[index].actual_size;
+
+	while (remain > 0) {
+		len = remain <= rtp_len + NULL_TS_PACKET_SIZE ? remain : rtp_len;
+		iov.iov_base = data;
+		iov.iov_len = len;
+
+		ret = kernel_sendmsg(ctx->otf_sock, &msg, &iov, 1, len);
+		if (ret < 0) {
+			/* late packets are useless, don't wait for room */
+			dropped++;
+		} else {
+			sent++;
+		}
+
+		data += len;
+		remain -= len;
+	}
+
+	ctx->otf_sent_count += sent;
+	ctx->otf_drop_count += dropped;
+	if (dropped)
+		print_tsmux(TSMUX_ERR, "otf send buf %d, sent %d, dropped %d\n",
+			index, sent, dropped);
+	else
+		print_tsmux(TSMUX_OTF, "otf send buf %d, sent %d\n", index, sent);
+}
+
+static int tsmux_ioctl_otf_set_sock(struct tsmux_context *ctx, int fd)
+{
+	struct socket *sock = NULL;
+	int err;
+
+	if (fd >= 0) {
+		sock = sockfd_lookup(fd, &err);
+		if (!sock)
+			return err;
+
+		if (sock->type != SOCK_DGRAM || !sock->sk ||
+				sock->sk->sk_protocol != IPPROTO_UDP ||
+				sock->sk->sk_state != TCP_ESTABLISHED) {
+			print_tsmux(TSMUX_ERR, "otf sock %d is not a connected udp socket\n", fd);
+			sockfd_put(sock);
+			return -EINVAL;
+		}
+	}
+
+	mutex_lock(&ctx->otf_sock_lock);
+	if (ctx->otf_sock)
+		sockfd_put(ctx->otf_sock);
+	ctx->otf_sock = sock;
+	mutex_unlock(&ctx->otf_sock_lock);
+
+	print_tsmux(TSMUX_OTF, "otf sock %d %s\n", fd, sock ? "set" : "cleared");
+
+	return 0;
+}
+
 static int tsmux_ioctl_otf_map_buf(struct tsmux_context *ctx)
 {
 	int i = 0;
@@ -1809,6 +1902,7 @@ static long tsmux_ioctl(struct file *filp,
 	struct tsmux_m2m_cmd_queue temp_m2m_cmd_queue;
 	struct tsmux_otf_cmd_queue temp_otf_cmd_queue;
 	int32_t temp_cur_buf_num;
+	int32_t temp_sock_fd;
 	struct tsmux_rtp_ts_info temp_rtp_ts_info;
 
 	print_tsmux(TSMUX_COMMON, "%s++\n", __func__);
@@ -1965,6 +2059,11 @@ static long tsmux_ioctl(struct file *filp,
 			break;
 		}
 
+		mutex_lock(&ctx->otf_sock_lock);
+		if (ctx->otf_sock)
+			tsmux_otf_send_buf(ctx, ctx->otf_cmd_queue.cur_buf_num);
+		mutex_unlock(&ctx->otf_sock_lock);
+
 		if (copy_to_user((struct tsmux_otf_cmd_queue __user *) arg,
 					&ctx->otf_cmd_queue, sizeof(struct tsmux_otf_cmd_queue))) {
 			print_tsmux(TSMUX_ERR, "TSMUX_IOCTL_OTF_DQ_BUF: fail to copy_to_user\n");
@@ -2005,6 +2104,18 @@ static long tsmux_ioctl(struct file *filp,
 		spin_unlock_irqrestore(&tsmux_dev->device_spinlock, flags);
 	break;
 
+	case TSMUX_IOCTL_OTF_SET_SOCK:
+		print_tsmux(TSMUX_OTF, "TSMUX_IOCTL_OTF_SET_SOCK\n");
+		if (copy_from_user(&temp_sock_fd,
+					(int32_t *)arg,
+					sizeof(int32_t))) {
+			ret = -EFAULT;
+			break;
+		}
+
+		ret = tsmux_ioctl_otf_set_sock(ctx, temp_sock_fd);
+	break;
+
 	case TSMUX_IOCTL_SET_RTP_TS_INFO:
 		if (copy_from_user(&temp_rtp_ts_info,
 			(struct tsmux_rtp_ts_info __user *)arg,
@@ -23,6 +23,8 @@
 #include <linux/ion.h>
 #include <linux/exynos_ion.h>
 #include <linux/wait.h>
+#include <linux/mutex.h>
+#include <linux/net.h>
 #include <media/exynos_tsmux.h>
 #ifdef CONFIG_EXYNOS_ITMON
 #include <soc/samsung/exynos-itmon.h>
@@ -116,6 +118,12 @@ struct tsmux_context {
 	uint64_t mfc_end_stamp;
 	uint64_t tsmux_start_stamp;
 	uint64_t tsmux_end_stamp;
+
+	/* connected UDP socket the OTF RTP packets are sent to */
+	struct socket *otf_sock;
+	struct mutex otf_sock_lock;
+	uint64_t otf_sent_count;
+	uint64_t otf_drop_count;
 };
 
 #define NODE_NAME		"tsmux"
@@ -22,13 +22,12 @@
 #include <linux/kobject.h>
 #include <linux/memory-state-time.h>
 #include <linux/module.h>
-#include <linux/mutex.h>
 #include <linux/of_platform.h>
 #include <linux/slab.h>
+#include <linux/spinlock.h>
 #include <linux/sysfs.h>
 #include <linux/time.h>
 #include <linux/timekeeping.h>
-#include <linux/workqueue.h>
 
 #define KERNEL_ATTR_RO(_name) \
 static struct kobj_attribute _name##_attr = __ATTR_RO(_name)
@@ -40,7 +39,11 @@ static struct kobj_attribute _name##_attr = \
 #define FREQ_HASH_BITS 4
 DECLARE_HASHTABLE(freq_hash_table, FREQ_HASH_BITS);
 
-static DEFINE_MUTEX(mem_lock);
+/*
+ * Frequency and bandwidth changes are accounted right in the notifier,
+ * which is a few additions, instead of waking a worker for each one.
+ */
+static DEFINE_SPINLOCK(mem_lock);
 
 #define TAG "memory_state_time"
 #define BW_NODE "/soc/memory-state-time"
@@ -59,7 +62,6 @@ static int num_buckets;
 static int registered_bw_sources;
 static u64 last_update;
 static bool init_success;
-static struct workqueue_struct *memory_wq;
 static u32 num_sources = 10;
 static int *bandwidths;
 
@@ -69,14 +71,6 @@ struct freq_entry {
 	struct hlist_node hash;
 };
 
-struct queue_container {
-	struct work_struct update_state;
-	int value;
-	u64 time_now;
-	int id;
-	struct mutex *lock;
-};
-
 static int find_bucket(int bw)
 {
 	int i;
@@ -103,12 +97,32 @@ static u64 get_time_diff(u64 time_now)
 	return ms;
 }
 
+static void update_table(u64 time_now)
+{
+	struct freq_entry *freq_entry;
+
+	pr_debug("Last known bw %d freq %d\n", curr_bw, curr_freq);
+	hash_for_each_possible(freq_hash_table, freq_entry, hash, curr_freq) {
+		if (curr_freq == freq_entry->freq) {
+			freq_entry->buckets[find_bucket(curr_bw)]
+					+= get_time_diff(time_now);
+			break;
+		}
+	}
+}
+
 static ssize_t show_stat_show(struct kobject *kobj,
 		struct kobj_attribute *attr, char *buf)
 {
 	int i, j;
 	int len = 0;
 	struct freq_entry *freq_entry;
+	unsigned long flags;
+
+	spin_lock_irqsave(&mem_lock, flags);
+	/* fold the time spent in the current state so far */
+	if (init_success)
+		update_table(ktime_get_boot_ns());
 
 	for (i = 0; i < num_freqs; i++) {
 		hash_for_each_possible(freq_hash_table, freq_entry, hash,
@@ -129,25 +143,13 @@ static ssize_t show_stat_show(struct kobject *kobj,
 			}
 		}
 	}
+	spin_unlock_irqrestore(&mem_lock, flags);
+
 	pr_debug("Current Time: %llu\n", ktime_get_boot_ns());
 	return len;
 }
 KERNEL_ATTR_RO(show_stat);
 
-static void update_table(u64 time_now)
-{
-	struct freq_entry *freq_entry;
-
-	pr_debug("Last known bw %d freq %d\n", curr_bw, curr_freq);
-	hash_for_each_possible(freq_hash_table, freq_entry, hash, curr_freq) {
-		if (curr_freq == freq_entry->freq) {
-			freq_entry->buckets[find_bucket(curr_bw)]
-					+= get_time_diff(time_now);
-			break;
-		}
-	}
-}
-
 static bool freq_exists(int freq)
 {
 	int i;
@@ -171,51 +173,17 @@ static int calculate_total_bw(int bw, int index)
 	return total_bw;
 }
 
-static void freq_update_do_work(struct work_struct *work)
-{
-	struct queue_container *freq_state_update
-			= container_of(work, struct queue_container,
-			update_state);
-	if (freq_state_update) {
-		mutex_lock(&mem_lock);
-		update_table(freq_state_update->time_now);
-		curr_freq = freq_state_update->value;
-		mutex_unlock(&mem_lock);
-		kfree(freq_state_update);
-	}
-}
-
-static void bw_update_do_work(struct work_struct *work)
-{
-	struct queue_container *bw_state_update
-			= container_of(work, struct queue_container,
-			update_state);
-	if (bw_state_update) {
-		mutex_lock(&mem_lock);
-		update_table(bw_state_update->time_now);
-		curr_bw = calculate_total_bw(bw_state_update->value,
-				bw_state_update->id);
-		mutex_unlock(&mem_lock);
-		kfree(bw_state_update);
-	}
-}
-
 static void memory_state_freq_update(struct memory_state_update_block *ub,
 		int value)
 {
+	unsigned long flags;
+
 	if (IS_ENABLED(CONFIG_MEMORY_STATE_TIME)) {
 		if (freq_exists(value) && init_success) {
-			struct queue_container *freq_container
-				= kmalloc(sizeof(struct queue_container),
-				GFP_KERNEL);
-			if (!freq_container)
-				return;
-			INIT_WORK(&freq_container->update_state,
-					freq_update_do_work);
-			freq_container->time_now = ktime_get_boot_ns();
-			freq_container->value = value;
-			pr_debug("Scheduling freq update in work queue\n");
-			queue_work(memory_wq, &freq_container->update_state);
+			spin_lock_irqsave(&mem_lock, flags);
+			update_table(ktime_get_boot_ns());
+			curr_freq = value;
+			spin_unlock_irqrestore(&mem_lock, flags);
 		} else {
 			pr_debug("Freq does not exist.\n");
 		}
@@ -225,20 +193,14 @@ static void memory_state_freq_update(struct memory_state_update_block *ub,
 static void memory_state_bw_update(struct memory_state_update_block *ub,
 		int value)
 {
+	unsigned long flags;
+
 	if (IS_ENABLED(CONFIG_MEMORY_STATE_TIME)) {
 		if (init_success) {
-			struct queue_container *bw_container
-				= kmalloc(sizeof(struct queue_container),
-				GFP_KERNEL);
-			if (!bw_container)
-				return;
-			INIT_WORK(&bw_container->update_state,
-					bw_update_do_work);
-			bw_container->time_now = ktime_get_boot_ns();
-			bw_container->value = value;
-			bw_container->id = ub->id;
-			pr_debug("Scheduling bandwidth update in work queue\n");
-			queue_work(memory_wq, &bw_container->update_state);
+			spin_lock_irqsave(&mem_lock, flags);
+			update_table(ktime_get_boot_ns());
+			curr_bw = calculate_total_bw(value, ub->id);
+			spin_unlock_irqrestore(&mem_lock, flags);
 		}
 	}
 }
@@ -427,19 +389,13 @@ static int __init memory_state_time_init(void)
 	int error;
 
 	hash_init(freq_hash_table);
-	memory_wq = create_singlethread_workqueue("memory_wq");
-	if (!memory_wq) {
-		pr_err("Unable to create workqueue.\n");
-		return -EINVAL;
-	}
 	/*
 	 * Create sys/kernel directory for memory_state_time.
 	 */
 	memory_kobj = kobject_create_and_add(TAG, kernel_kobj);
 	if (!memory_kobj) {
 		pr_err("Unable to allocate memory_kobj for sysfs directory.\n");
-		error = -ENOMEM;
-		goto wq;
+		return -ENOMEM;
 	}
 	error = sysfs_create_group(memory_kobj, &memory_attr_group);
 	if (error) {
@@ -456,7 +412,6 @@ static int __init memory_state_time_init(void)
 
 group:	sysfs_remove_group(memory_kobj, &memory_attr_group);
 kobj:	kobject_put(memory_kobj);
-wq:	destroy_workqueue(memory_wq);
 	return error;
 }
 module_init(memory_state_time_init);
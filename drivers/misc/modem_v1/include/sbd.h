@@ -517,6 +517,15 @@ static inline struct sbd_ring_buffer *sbd_ch2rb_with_skb(struct sbd_link_device
 	return (id < MAX_LINK_CHANNELS) ? &sl->ipc_dev[id].rb[dir] : NULL;
 }
 
+/*
+The netdev TX queue that feeds a PS TX ring, the reverse of the mapping done
+by sbd_ch2rb_with_skb()
+*/
+static inline u16 sbd_rb2txq(struct sbd_ring_buffer *rb)
+{
+	return (rb->ch == QOS_HIPRIO) ? 1 : 0;
+}
+
 static inline struct sbd_ring_buffer *sbd_id2rb(struct sbd_link_device *sl,
 						unsigned int id,
 						enum direction dir)
@@ -519,6 +519,10 @@ struct mem_link_device {
 	unsigned int rx_int_count;
 	unsigned int rx_poll_count;
 	unsigned long long rx_int_disabled_time;
+	struct hrtimer rx_int_coalesce_timer;
+	unsigned long rx_db_window_start;	/* jiffies */
+	unsigned int rx_db_events;
+	bool rx_int_coalescing;
 #endif /* CONFIG_LINK_DEVICE_NAPI */
 #ifdef CONFIG_MODEM_IF_NET_GRO
 	struct timespec flush_time;
@@ -31,8 +31,64 @@
 
 #ifdef GROUP_MEM_FLOW_CONTROL
 
+#ifdef CONFIG_MODEM_IF_QOS
+/*
+Each PS TX ring is fed by its own netdev TX queue (see sbd_ch2rb_with_skb()),
+so a full ring only stops the queue of its own traffic class on every rmnet.
+A bulk upload filling the normal ring must not hold back the high-priority
+queue, and vice versa.
+*/
+static void sbd_txq_stop_qos(struct sbd_ring_buffer *rb)
+{
+	struct link_device *ld = rb->ld;
+	unsigned long flags;
+
+	spin_lock_irqsave(&rb->lock, flags);
+
+	if (atomic_read(&rb->busy) == 0) {
+		atomic_set(&rb->busy, 1);
+		if (ld->msd)
+			netif_tx_flowctl_queue(ld->msd, sbd_rb2txq(rb), true);
+
+		mif_err_limited("%s: TXQ %d stopped\n",
+			rb->iod->name, sbd_rb2txq(rb));
+	}
+
+	spin_unlock_irqrestore(&rb->lock, flags);
+}
+
+static void sbd_txq_start_qos(struct sbd_ring_buffer *rb)
+{
+	struct link_device *ld = rb->ld;
+	unsigned long flags;
+
+	spin_lock_irqsave(&rb->lock, flags);
+
+	if (atomic_read(&rb->busy) > 0) {
+		atomic_set(&rb->busy, 0);
+
+		/* A link-wide stop is still in force, leave the wake to it */
+		if (ld->msd && ld->tx_flowctrl_mask == 0 &&
+		    !atomic_read(&ld->netif_stopped)) {
+			netif_tx_flowctl_queue(ld->msd, sbd_rb2txq(rb), false);
+			mif_err_limited("%s: TXQ %d resumed\n",
+				rb->iod->name, sbd_rb2txq(rb));
+		}
+	}
+
+	spin_unlock_irqrestore(&rb->lock, flags);
+}
+#endif
+
 void sbd_txq_stop(struct sbd_ring_buffer *rb)
 {
+#ifdef CONFIG_MODEM_IF_QOS
+	if (sipc_ps_ch(rb->ch)) {
+		sbd_txq_stop_qos(rb);
+		return;
+	}
+#endif
+
 	if (sipc_ps_ch(rb->ch) && atomic_read(&rb->busy) == 0) {
 		struct link_device *ld = rb->ld;
 
@@ -60,6 +116,13 @@ void sbd_txq_stop(struct sbd_ring_buffer *rb)
 
 void sbd_txq_start(struct sbd_ring_buffer *rb)
 {
+#ifdef CONFIG_MODEM_IF_QOS
+	if (sipc_ps_ch(rb->ch)) {
+		sbd_txq_start_qos(rb);
+		return;
+	}
+#endif
+
 	if (sipc_ps_ch(rb->ch) && atomic_read(&rb->busy) > 0) {
 		struct link_device *ld = rb->ld;
 
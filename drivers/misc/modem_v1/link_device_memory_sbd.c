@@ -21,6 +21,7 @@
 
 #include <soc/samsung/exynos-modem-ctrl.h>
 #include <linux/mcu_ipc.h>
+#include <net/rx_prof.h>
 #include "modem_prj.h"
 #include "modem_utils.h"
 #include "link_device_memory.h"
@@ -1102,6 +1103,41 @@ int sbd_pio_tx(struct sbd_ring_buffer *rb, struct sk_buff *skb)
 @{
 */
 
+/*
+ * RX runs from the NAPI poll or the RX tasklet most of the time. There,
+ * take the skb head from the per-cpu NAPI cache that napi_consume_skb()
+ * refills and the data from the NAPI page frag cache, so that neither needs
+ * the slab nor an IRQ save/restore per frame.
+ */
+static inline bool sbd_rx_in_softirq(void)
+{
+	return in_serving_softirq() && !in_irq();
+}
+
+static struct sk_buff *sbd_alloc_skb(unsigned int len)
+{
+	unsigned int size = SKB_DATA_ALIGN(NET_SKB_PAD + len) +
+			    SKB_DATA_ALIGN(sizeof(struct skb_shared_info));
+	struct sk_buff *skb;
+	void *data;
+
+	if (!sbd_rx_in_softirq() || size > PAGE_SIZE)
+		return dev_alloc_skb(len);
+
+	data = napi_alloc_frag(size);
+	if (unlikely(!data))
+		return NULL;
+
+	skb = napi_build_skb(data, size);
+	if (unlikely(!skb)) {
+		skb_free_frag(data);
+		return NULL;
+	}
+
+	skb_reserve(skb, NET_SKB_PAD);
+	return skb;
+}
+
 static inline struct sk_buff *recv_data(struct sbd_ring_buffer *rb, u16 out)
 {
 	struct sk_buff *skb;
@@ -1115,7 +1151,7 @@ static inline struct sk_buff *recv_data(struct sbd_ring_buffer *rb, u16 out)
 		return NULL;
 	}
 
-	skb = dev_alloc_skb(len);
+	skb = sbd_alloc_skb(len);
 	if (unlikely(!skb)) {
 		mif_err("ERR! {id:%d ch:%d} alloc_skb(%d) fail\n",
 			rb->id, rb->ch, len);
@@ -1202,6 +1238,7 @@ struct sk_buff *sbd_pio_rx(struct sbd_ring_buffer *rb)
 	set_lnk_hdr(rb, skb);
 
 	set_skb_priv(rb, skb);
+	rx_prof_start(skb, RX_PROF_MODEM);
 
 	check_more(rb, skb);
 
@@ -1212,15 +1249,15 @@ struct sk_buff *sbd_pio_rx(struct sbd_ring_buffer *rb)
 
 struct sk_buff *zerocopy_alloc_skb(u8* buf, unsigned int data_len, struct sbd_link_device *sl)
 {
+	unsigned int size = SKB_DATA_ALIGN(data_len + NET_HEADROOM) +
+			    SKB_DATA_ALIGN(sizeof(struct skb_shared_info));
+	bool napi = sbd_rx_in_softirq();
 	struct sk_buff *skb;
 
-	if (smapper_active(sl)) {
-		skb = build_skb(buf, SKB_DATA_ALIGN(data_len + NET_HEADROOM)
-			+ SKB_DATA_ALIGN(sizeof(struct skb_shared_info)));
-	} else {
-		skb = __build_skb(buf, SKB_DATA_ALIGN(data_len + NET_HEADROOM)
-			+ SKB_DATA_ALIGN(sizeof(struct skb_shared_info)));
-	}
+	if (smapper_active(sl))
+		skb = napi ? napi_build_skb(buf, size) : build_skb(buf, size);
+	else
+		skb = napi ? __napi_build_skb(buf, size) : __build_skb(buf, size);
 
 	if (unlikely(!skb)) {
 		mif_err("build_skb error\n");
@@ -1238,7 +1275,7 @@ struct sk_buff *zerocopy_alloc_skb_with_memcpy(u8* buf, unsigned int data_len)
 	struct sk_buff *skb;
 	u8 *src;
 
-	skb = dev_alloc_skb(data_len);
+	skb = sbd_alloc_skb(data_len);
 	if (unlikely(!skb))
 		return NULL;
 
@@ -1291,6 +1328,7 @@ struct sk_buff *sbd_pio_rx_zerocopy_adaptor(struct sbd_ring_buffer *rb, int use_
 	set_lnk_hdr(rb, skb);
 
 	set_skb_priv_zerocopy_adaptor(rb, skb);
+	rx_prof_start(skb, RX_PROF_MODEM);
 
 	check_more(rb, skb);
 
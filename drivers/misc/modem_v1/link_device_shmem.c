@@ -251,6 +251,32 @@ static inline bool ipc_active(struct mem_link_device *mld)
 	return true;
 }
 
+/*
+PS frames stay accounted to the BQL state of the rmnet TX queue they came
+from until they are copied into the SBD ring, so the qdisc, not @rb->skb_q,
+holds the backlog and can keep the traffic classes apart.
+*/
+static void sbd_tx_bql_sent(struct sk_buff *skb)
+{
+	struct net_device *ndev = skbpriv(skb)->iod->ndev;
+
+	skbpriv(skb)->bql = 0;
+	if (!ndev || skb->queue_mapping >= ndev->real_num_tx_queues)
+		return;
+
+	netdev_tx_sent_queue(skb_get_tx_queue(ndev, skb), skb->len);
+	skbpriv(skb)->bql = 1;
+}
+
+static void sbd_tx_bql_completed(struct sk_buff *skb)
+{
+	struct net_device *ndev = skbpriv(skb)->iod->ndev;
+
+	if (sipc_ps_ch(skbpriv(skb)->sipc_ch) && skbpriv(skb)->bql)
+		netdev_tx_completed_queue(skb_get_tx_queue(ndev, skb), 1,
+					  skb->len);
+}
+
 static inline void purge_txq(struct mem_link_device *mld)
 {
 	struct link_device *ld = &mld->link_dev;
@@ -262,7 +288,12 @@ static inline void purge_txq(struct mem_link_device *mld)
 
 		for (i = 0; i < sl->num_channels; i++) {
 			struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, TX);
-			skb_queue_purge(&rb->skb_q);
+			struct sk_buff *skb;
+
+			while ((skb = skb_dequeue(&rb->skb_q)) != NULL) {
+				sbd_tx_bql_completed(skb);
+				dev_kfree_skb_any(skb);
+			}
 		}
 	}
 
@@ -1004,6 +1035,7 @@ static int tx_frames_to_rb(struct sbd_ring_buffer *rb)
 #ifdef DEBUG_MODEM_IF_LINK_TX
 		mif_pkt(rb->ch, "LNK-TX", skb);
 #endif
+		sbd_tx_bql_completed(skb);
 		dev_kfree_skb_any(skb);
 	}
 
@@ -1179,6 +1211,8 @@ static int xmit_ipc_to_rb(struct mem_link_device *mld, enum sipc_ch_id ch,
 		skb->len = min_t(int, skb->len, rb->buff_size);
 
 		ret = skb->len;
+		if (sipc_ps_ch(ch))
+			sbd_tx_bql_sent(skb);
 		skb_queue_tail(skb_txq, skb);
 		start_tx_timer(mld, &mld->sbd_tx_timer);
 	}
@@ -2319,6 +2353,76 @@ static void gro_flush_timer(struct link_device *ld)
 #ifdef CONFIG_LINK_DEVICE_NAPI
 static int shmem_enqueue_snapshot(struct mem_link_device *mld);
 
+/*
+ * Keep the CP2AP mailbox interrupt masked for this long after a poll that
+ * found frames, then poll its status bit again instead of waiting for the
+ * next interrupt. Under sustained downlink all doorbells rung in the window
+ * are served by a single poll. 0 unmasks the interrupt right away.
+ */
+static unsigned int rx_int_coalesce_us;
+module_param(rx_int_coalesce_us, uint, 0644);
+
+/*
+ * Only coalesce while CP rings the doorbell at least this many times per
+ * second, measured over RX_DB_WINDOW. Below half of it every doorbell is
+ * an interrupt again, so a lone FMT message is not delayed. 0 coalesces
+ * at any rate.
+ */
+static unsigned int rx_int_coalesce_rate;
+module_param(rx_int_coalesce_rate, uint, 0644);
+
+#define RX_DB_WINDOW	(HZ / 10)
+
+/* count a CP2AP doorbell, seen as an interrupt or while polling */
+static void mld_rx_count_doorbell(struct mem_link_device *mld)
+{
+	unsigned int rate = READ_ONCE(rx_int_coalesce_rate);
+	unsigned long now = jiffies;
+	unsigned long elapsed = now - mld->rx_db_window_start;
+	unsigned int events;
+
+	mld->rx_db_events++;
+	if (elapsed < RX_DB_WINDOW)
+		return;
+
+	events = mld->rx_db_events * HZ / elapsed;
+	if (events >= rate)
+		mld->rx_int_coalescing = true;
+	else if (events < rate / 2)
+		mld->rx_int_coalescing = false;
+
+	mld->rx_db_window_start = now;
+	mld->rx_db_events = 0;
+}
+
+static enum hrtimer_restart rx_int_coalesce_timer_func(struct hrtimer *timer)
+{
+	struct mem_link_device *mld = container_of(timer,
+			struct mem_link_device, rx_int_coalesce_timer);
+
+	napi_schedule(&mld->mld_napi);
+	return HRTIMER_NORESTART;
+}
+
+/* finish a poll that received @work frames, see rx_int_coalesce_us */
+static void mld_rx_int_poll_done(struct mem_link_device *mld, int work)
+{
+	struct link_device *ld = &mld->link_dev;
+	unsigned int coalesce_us = READ_ONCE(rx_int_coalesce_us);
+
+	napi_complete_done(&mld->mld_napi, work);
+
+	if (work && coalesce_us &&
+	    (!READ_ONCE(rx_int_coalesce_rate) || mld->rx_int_coalescing)) {
+		hrtimer_start(&mld->rx_int_coalesce_timer,
+			ns_to_ktime((u64)coalesce_us * NSEC_PER_USEC),
+			HRTIMER_MODE_REL);
+		return;
+	}
+
+	ld->enable_rx_int(ld);
+}
+
 /*
  * mld_rx_int_poll
  *
@@ -2340,7 +2444,7 @@ static int mld_rx_int_poll(struct napi_struct *napi, int budget)
 	struct sbd_link_device *sl = &mld->sbd_link_dev;
 	int total_ps_rcvd = 0;
 	int ps_rcvd = 0;
-	int i;
+	int i, pass, nr_busy, quota;
 	int ret;
 	int total_budget;
 
@@ -2351,6 +2455,8 @@ static int mld_rx_int_poll(struct napi_struct *napi, int budget)
 	mld->rx_poll_count++;
 
 	if (ret) {
+		mld_rx_count_doorbell(mld);
+
 		/* If there was a new interrupt, do what irq_handler would have done. */
 		if (shmem_enqueue_snapshot(mld))
 			goto dummy_poll_complete;
@@ -2361,35 +2467,47 @@ static int mld_rx_int_poll(struct napi_struct *napi, int budget)
 			queue_delayed_work(ld->rx_wq, &mld->udl_rx_dwork, 0);
 
 		if (total_ps_rcvd) {
-			if (total_ps_rcvd < budget) {
-				napi_complete_done(napi, total_ps_rcvd);
-				ld->enable_rx_int(ld);
-			}
+			if (total_ps_rcvd < budget)
+				mld_rx_int_poll_done(mld, total_ps_rcvd);
 			return total_ps_rcvd;
 		} else
 			goto dummy_poll_complete;
 	} else {
 		/* Leave interrupt disabled and poll if NET polling is not finished. */
 		total_budget = budget;
+
+		/*
+		 * First give every busy PS ring an equal share so that one bulk
+		 * download cannot starve the other PDNs, then let whoever still
+		 * has frames use what is left of the budget.
+		 */
+		nr_busy = 0;
 		for (i = 0; i < sl->num_channels; i++) {
 			struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, RX);
-			if (likely(sipc_ps_ch(rb->ch))) {
-				ps_rcvd = shmem_poll_recv_on_iod(ld, rb->iod, budget);
-				budget -= ps_rcvd;
-				total_ps_rcvd += ps_rcvd;
-			}
+
+			if (sipc_ps_ch(rb->ch) && !rb_empty(rb))
+				nr_busy++;
 		}
+		quota = nr_busy > 1 ? max(budget / nr_busy, 1) : budget;
 
-		if (total_ps_rcvd) {
-			if (total_ps_rcvd < total_budget) {
-				napi_complete_done(napi, total_ps_rcvd);
-				ld->enable_rx_int(ld);
+		for (pass = 0; pass < 2 && budget > 0; pass++) {
+			for (i = 0; i < sl->num_channels && budget > 0; i++) {
+				struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, RX);
+
+				if (likely(sipc_ps_ch(rb->ch))) {
+					ps_rcvd = shmem_poll_recv_on_iod(ld, rb->iod,
+							pass ? budget : min(quota, budget));
+					budget -= ps_rcvd;
+					total_ps_rcvd += ps_rcvd;
+				}
 			}
-		} else {
-			napi_complete(napi);
-			ld->enable_rx_int(ld);
+			if (nr_busy <= 1)
+				break;
 		}
 
+		if (total_ps_rcvd < total_budget)
+			mld_rx_int_poll_done(mld, total_ps_rcvd);
+
 		return total_ps_rcvd;
 	}
 
@@ -2404,6 +2522,9 @@ static void sync_net_dev(struct link_device *ld)
 {
 	struct mem_link_device *mld = to_mem_link_device(ld);
 
+	/* a pending coalescing timer still owns the masked interrupt */
+	if (hrtimer_cancel(&mld->rx_int_coalesce_timer))
+		ld->enable_rx_int(ld);
 	napi_synchronize(&mld->mld_napi);
 	mif_info("%s\n", netdev_name(&mld->dummy_net));
 }
@@ -2762,6 +2883,7 @@ static void shmem_irq_handler(void *data)
 
 #ifdef CONFIG_LINK_DEVICE_NAPI
 	mld->rx_int_count++;
+	mld_rx_count_doorbell(mld);
 	if (napi_schedule_prep(&mld->mld_napi)) {
 		struct link_device *ld = &mld->link_dev;
 
@@ -3581,6 +3703,10 @@ struct link_device *shmem_create_link_device(struct platform_device *pdev)
 	init_dummy_netdev(&mld->dummy_net);
 	netif_napi_add(&mld->dummy_net, &mld->mld_napi, mld_rx_int_poll, 64);
 	napi_enable(&mld->mld_napi);
+
+	hrtimer_init(&mld->rx_int_coalesce_timer, CLOCK_MONOTONIC,
+			HRTIMER_MODE_REL);
+	mld->rx_int_coalesce_timer.function = rx_int_coalesce_timer_func;
 #endif /* CONFIG_LINK_DEVICE_NAPI */
 
 	INIT_LIST_HEAD(&ld->list);
@@ -29,6 +29,7 @@
 #include <linux/icmpv6.h>
 #include <linux/time.h>
 #include <linux/timer.h>
+#include <linux/hash.h>
 #include "modem_prj.h"
 #include "modem_utils.h"
 #include "modem_klat.h"
@@ -49,7 +50,9 @@
 	 && (((const uint32_t *) (a))[2] == ((const uint32_t *) (b))[2])      \
 	 && (((const uint32_t *) (a))[3] == ((const uint32_t *) (b))[3]))
 
-struct klat klat_obj;
+struct klat klat_obj = {
+	.flow_gen = 1,
+};
 
 static uint16_t ip_checksum_fold(uint32_t temp_sum)
 {
@@ -633,6 +636,85 @@ static int ipv4_packet(struct sk_buff *skb, int ndev_index)
 	return iov_len;
 }
 
+/* drop all cached flows, called whenever an address or the prefix changes */
+static void klat_flow_flush(void)
+{
+	WRITE_ONCE(klat_obj.flow_gen, klat_obj.flow_gen + 1);
+}
+
+/*
+ * The translation of a received packet only depends on its address pair:
+ * the local end is fixed per rmnet and the IPv4 address of the remote is
+ * embedded in its IPv6 one. Keep the IPv4 header template and the
+ * pseudo-header address sums of recent remotes, so that neither the header
+ * is rebuilt nor 32 bytes of IPv6 addresses are summed for every packet.
+ * Only called from the rx path, which runs in the link device's NAPI poll.
+ */
+static struct klat_flow *klat_flow_get(struct ipv6hdr *ip6, int ndev_index)
+{
+	u32 hash = hash_32((__force u32)ip6->saddr.s6_addr32[3],
+				KLAT_FLOW_HASH_BITS);
+	struct klat_flow *flow = &klat_obj.flows[ndev_index][hash];
+	unsigned int gen = READ_ONCE(klat_obj.flow_gen);
+
+	if (flow->gen == gen && ipv6_addr_equal(&flow->saddr, &ip6->saddr))
+		return flow;
+
+	if (!is_in_plat_subnet(&ip6->saddr))
+		return NULL;
+
+	flow->saddr = ip6->saddr;
+	fill_ip_header(&flow->iph, 0, 0, ip6, ndev_index);
+	/* saddr and daddr are adjacent in both headers */
+	flow->v6_addr_sum = ip_checksum_add(0, &ip6->saddr,
+					2 * sizeof(struct in6_addr));
+	flow->v4_addr_sum = ip_checksum_add(0, &flow->iph.saddr,
+					2 * sizeof(uint32_t));
+	flow->gen = gen;
+
+	return flow;
+}
+
+/* unfragmented TCP or UDP from a cached remote */
+static int ipv6_packet_flow(struct sk_buff *skb, struct klat_flow *flow)
+{
+	struct ipv6hdr *ip6 = (struct ipv6hdr *)skb->data;
+	unsigned char *next_header = skb->data + sizeof(struct ipv6hdr);
+	size_t len_left = skb->len - sizeof(struct ipv6hdr);
+	uint8_t protocol = ip6->nexthdr;
+	uint8_t ttl = ip6->hop_limit;
+	uint32_t len_proto, old_sum, new_sum;
+	struct iphdr *ip;
+	int iov_len;
+
+	/*
+	 * Both pseudo-headers carry the same length and protocol words, only
+	 * the addresses differ.
+	 */
+	len_proto = htons((uint16_t)len_left) + htons(protocol);
+	old_sum = flow->v6_addr_sum + len_proto;
+	new_sum = flow->v4_addr_sum + len_proto;
+
+	if (protocol == IPPROTO_TCP)
+		iov_len = tcp_packet((struct tcphdr *)next_header, old_sum,
+					new_sum, len_left);
+	else
+		iov_len = udp_packet((struct udphdr *)next_header, old_sum,
+					new_sum, len_left);
+	if (!iov_len)
+		return 0;
+
+	ip = (struct iphdr *)(next_header - sizeof(struct iphdr));
+	memcpy(ip, &flow->iph, sizeof(struct iphdr));
+	ip->ttl = ttl;
+	ip->protocol = protocol;
+	ip->tot_len = htons(len_left + sizeof(struct iphdr));
+	ip->check = ip_checksum(ip, sizeof(struct iphdr));
+	skb_pull(skb, sizeof(struct ipv6hdr) - sizeof(struct iphdr));
+
+	return iov_len;
+}
+
 static int ipv6_packet(struct sk_buff *skb, int ndev_index)
 {
 	struct ipv6hdr *ip6 = (struct ipv6hdr *)skb->data;
@@ -643,6 +725,7 @@ static int ipv6_packet(struct sk_buff *skb, int ndev_index)
 	size_t len_left;
 	uint32_t old_sum, new_sum;
 	struct in6_addr	*xlat_addr = &klat_obj.xlat_addrs[ndev_index];
+	struct klat_flow *flow;
 	int iov_len = 0;
 
 	if (skb->len < sizeof(struct ipv6hdr)) {
@@ -664,6 +747,12 @@ static int ipv6_packet(struct sk_buff *skb, int ndev_index)
 		return 0;
 	}
 
+	if (ip6->nexthdr == IPPROTO_TCP || ip6->nexthdr == IPPROTO_UDP) {
+		flow = klat_flow_get(ip6, ndev_index);
+		if (flow)
+			return ipv6_packet_flow(skb, flow);
+	}
+
 	next_header = skb->data + sizeof(struct ipv6hdr);
 	len_left = skb->len - sizeof(struct ipv6hdr);
 
@@ -904,6 +993,7 @@ ssize_t klat_plat_store(struct kobject *kobj,
 	rmnet_idx = get_rmnet_index(ptr);
 	if (rmnet_idx >= 0) {
 		klat_obj.plat_subnet = val;
+		klat_flow_flush();
 		klat_obj.use[rmnet_idx] = 1;
 
 		mif_err("plat prefix: %pI6, klat(%d) enabled\n",
@@ -943,6 +1033,7 @@ ssize_t klat_addrs_store(struct kobject *kobj,
 
 	sprintf(v4_rmnet, "v4-rmnet%d", dev_index);
 	klat_obj.xlat_addrs[dev_index] = val;
+	klat_flow_flush();
 	klat_obj.tun_device[dev_index] = klat_dev_get_by_name(v4_rmnet);
 	klat_obj.rmnet_device[dev_index] = klat_dev_get_by_name(ptr);
 #ifdef CONFIG_MODEM_IF_NET_GRO
@@ -986,6 +1077,7 @@ ssize_t klat_v4_addrs_store(struct kobject *kobj,
 	}
 
 	klat_obj.xlat_v4_addrs[dev_index].s_addr = val.s_addr;
+	klat_flow_flush();
 	mif_err("v4_rmnet%d: %pI4\n", dev_index, &val.s_addr);
 
 	return count;
@@ -17,12 +17,25 @@
 
 #include <linux/types.h>
 #include <linux/inet.h>
+#include <linux/ip.h>
 #include "modem_prj.h"
 
 #ifdef CONFIG_KLAT
 /* for supporting max 4 rmnets (rmnet0, rmnet1 ...) */
 #define KLAT_MAX_NDEV	4
 
+#define KLAT_FLOW_HASH_BITS	4
+#define KLAT_FLOW_HASH_SIZE	(1 << KLAT_FLOW_HASH_BITS)
+
+/* translation state of one remote peer, see klat_flow_get() */
+struct klat_flow {
+	struct in6_addr	saddr;		/* remote, in the plat subnet */
+	struct iphdr	iph;		/* IPv4 header template */
+	uint32_t	v6_addr_sum;	/* IPv6 pseudo-header address sum */
+	uint32_t	v4_addr_sum;	/* IPv4 pseudo-header address sum */
+	unsigned int	gen;		/* valid if == klat.flow_gen */
+};
+
 struct klat {
 	int	use[KLAT_MAX_NDEV];
 
@@ -32,6 +45,9 @@ struct klat {
 
 	struct net_device *tun_device[KLAT_MAX_NDEV];
 	struct net_device *rmnet_device[KLAT_MAX_NDEV];
+
+	struct klat_flow flows[KLAT_MAX_NDEV][KLAT_FLOW_HASH_SIZE];
+	unsigned int	flow_gen;
 };
 
 extern struct klat klat_obj;
@@ -19,6 +19,9 @@
 #include <linux/skbuff.h>
 #include <linux/interrupt.h>
 #include <linux/netdevice.h>
+#include <linux/vmalloc.h>
+#include <linux/log2.h>
+#include <linux/mm.h>
 
 #include "modem_pktlog.h"
 
@@ -54,12 +57,105 @@ void pktlog_copy_buf(struct pktlog_data *pktlog, int type, void *buf)
 }
 #endif
 
+static inline bool pktlog_ring_empty(struct pktlog_data *pktlog)
+{
+	return READ_ONCE(pktlog->ring->tail) == pktlog->ring_head;
+}
+
+/*
+ * Write @skb into the mmap ring, if there is one. The ring indices in the
+ * shared page may be scribbled on by the reader, so bounds only ever come
+ * from the kernel's own copies.
+ */
+static bool pktlog_ring_skb(struct pktlog_data *pktlog, unsigned char dir,
+		struct sk_buff *skb)
+{
+	struct pktlog_ring_hdr *ring;
+	struct pktlog_rec *rec;
+	struct pktdump_hdr *hdr;
+	struct timespec ts;
+	unsigned cook_hdr_len = sizeof(struct pktdump_hdr)
+			- sizeof(struct pcap_hdr);
+	unsigned size, head, tail, pos, pad, rec_len, payload_len = 0;
+	unsigned long flags;
+	bool was_empty;
+
+	spin_lock_irqsave(&pktlog->ring_lock, flags);
+
+	ring = pktlog->ring;
+	if (!ring) {
+		spin_unlock_irqrestore(&pktlog->ring_lock, flags);
+		return false;
+	}
+
+	if (pktlog->snaplen > cook_hdr_len)
+		payload_len = min(skb->len, pktlog->snaplen - cook_hdr_len);
+	rec_len = ALIGN(sizeof(*rec) + sizeof(*hdr) + payload_len,
+			PKTLOG_REC_ALIGN);
+
+	size = pktlog->ring_size;
+	head = pktlog->ring_head;
+	tail = READ_ONCE(ring->tail);
+	/* the reader is done with everything up to @tail */
+	smp_mb();
+
+	pos = head & (size - 1);
+	pad = (size - pos < rec_len) ? size - pos : 0;
+
+	if (unlikely(head - tail > size ||
+		     size - (head - tail) < pad + rec_len)) {
+		WRITE_ONCE(ring->drops, ++pktlog->ring_drops);
+		spin_unlock_irqrestore(&pktlog->ring_lock, flags);
+		return true;
+	}
+	was_empty = (head == tail);
+
+	if (pad) {
+		rec = pktlog->ring_data + pos;
+		rec->len = pad;
+		rec->flags = PKTLOG_REC_PAD;
+		head += pad;
+		pos = 0;
+	}
+
+	rec = pktlog->ring_data + pos;
+	rec->len = rec_len;
+	rec->flags = 0;
+
+	hdr = (struct pktdump_hdr *)(rec + 1);
+	ts = current_kernel_time();
+	hdr->pcap.tv_sec = ts.tv_sec;
+	hdr->pcap.tv_usec = ts.tv_nsec / NSEC_PER_USEC;
+	hdr->pcap.len = cook_hdr_len + skb->len;
+	hdr->pcap.caplen = cook_hdr_len + payload_len;
+	hdr->sd.dir = dir;
+	skb_copy_bits(skb, 0, hdr + 1, payload_len);
+
+	head += rec_len;
+	pktlog->ring_head = head;
+	/* publish the record before the new head */
+	smp_wmb();
+	WRITE_ONCE(ring->head, head);
+
+	spin_unlock_irqrestore(&pktlog->ring_lock, flags);
+
+	if (was_empty)
+		wake_up(&pktlog->wq);
+	return true;
+}
+
 void pktlog_queue_skb(struct pktlog_data *pktlog, unsigned char dir,
 		struct sk_buff *skb)
 {
 	struct sk_buff *pkt;
 
-	if (!pktlog || !pktlog->qmax)
+	if (!pktlog)
+		return;
+
+	if (pktlog->ring && pktlog_ring_skb(pktlog, dir, skb))
+		return;
+
+	if (!pktlog->qmax)
 		return;
 
 	pkt = skb_clone(skb, in_interrupt() ? GFP_ATOMIC : GFP_KERNEL);
@@ -107,6 +203,16 @@ static int pktlog_open(struct inode *inode, struct file *filp)
 static int pktlog_release(struct inode *inode, struct file *filp)
 {
 	struct pktlog_data *pktlog = filp->private_data;
+	struct pktlog_ring_hdr *ring;
+	unsigned long flags;
+
+	/* the mapping holds a reference to @filp, so it is gone by now */
+	spin_lock_irqsave(&pktlog->ring_lock, flags);
+	ring = pktlog->ring;
+	pktlog->ring = NULL;
+	pktlog->ring_data = NULL;
+	spin_unlock_irqrestore(&pktlog->ring_lock, flags);
+	vfree(ring);
 
 	pr_info("%s: qmax = %d close by %s- %d\n", __func__, pktlog->qmax,
 			current->comm, atomic_dec_return(&pktlog->opened));
@@ -122,12 +228,75 @@ static unsigned int pktlog_poll(struct file *filp, struct poll_table_struct *wai
 		return POLLERR;
 	}
 
+	if (pktlog->ring) {
+		poll_wait(filp, &pktlog->wq, wait);
+		return pktlog_ring_empty(pktlog) ? 0 : POLLIN | POLLRDNORM;
+	}
+
 	if (skb_queue_empty(&pktlog->logq))
 		poll_wait(filp, &pktlog->wq, wait);
 
 	return POLLIN;
 }
 
+/*
+ * Map the packet ring: one header page and a power-of-two data area,
+ * sized by the length of the mapping.
+ */
+static int pktlog_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	struct pktlog_data *pktlog = filp->private_data;
+	struct pktlog_ring_hdr *ring;
+	unsigned long len = vma->vm_end - vma->vm_start;
+	unsigned long size = len - PAGE_SIZE;
+	unsigned long flags;
+	int ret;
+
+	if (!pktlog) {
+		pr_err("%s: Invalid pktlog data\n", __func__);
+		return -EINVAL;
+	}
+
+	if (vma->vm_pgoff || len <= PAGE_SIZE || !is_power_of_2(size) ||
+			size > PKTLOG_RING_MAX)
+		return -EINVAL;
+
+	if (pktlog->ring)
+		return -EBUSY;
+
+	ring = vmalloc_user(len);
+	if (!ring)
+		return -ENOMEM;
+
+	ring->version = PKTLOG_RING_VERSION;
+	ring->data_offset = PAGE_SIZE;
+	ring->data_size = size;
+
+	ret = remap_vmalloc_range(vma, ring, 0);
+	if (ret < 0) {
+		vfree(ring);
+		return ret;
+	}
+
+	spin_lock_irqsave(&pktlog->ring_lock, flags);
+	if (pktlog->ring) {
+		spin_unlock_irqrestore(&pktlog->ring_lock, flags);
+		/* @vma keeps its own references to the pages */
+		vfree(ring);
+		return -EBUSY;
+	}
+	pktlog->ring_data = (void *)ring + PAGE_SIZE;
+	pktlog->ring_size = size;
+	pktlog->ring_head = 0;
+	pktlog->ring_drops = 0;
+	pktlog->ring = ring;
+	spin_unlock_irqrestore(&pktlog->ring_lock, flags);
+
+	pr_info("%s: %lu bytes ring mapped by %s\n", __func__, size,
+			current->comm);
+	return 0;
+}
+
 static ssize_t pktlog_read(struct file *filp, char *buf, size_t count,
 			loff_t *fpos)
 {
@@ -258,6 +427,7 @@ static const struct file_operations pktlog_fops = {
 	.release = pktlog_release,
 	.poll = pktlog_poll,
 	.read = pktlog_read,
+	.mmap = pktlog_mmap,
 };
 
 static void init_pcap_fileheader(struct pktlog_data *pktlog)
@@ -292,6 +462,7 @@ struct pktlog_data *create_pktlog(char *name)
 
 	init_waitqueue_head(&pktlog->wq);
 	skb_queue_head_init(&pktlog->logq);
+	spin_lock_init(&pktlog->ring_lock);
 	pktlog->qmax = 0;
 	pktlog->snaplen = 256;
 	atomic_set(&pktlog->opened, 0);
@@ -52,6 +52,36 @@ struct pktdump_hdr {
 	struct sipc_debug sd;
 } __packed;
 
+/*
+ * mmap ring shared with the logging daemon
+ *
+ * The daemon maps one header page followed by a power-of-two data area.
+ * Each packet is written once as a pktlog_rec followed by a pktdump_hdr and
+ * at most snaplen bytes, so everything after the pktlog_rec can go to the
+ * pcap file unchanged. @head and @tail are free-running byte counters: the
+ * kernel only advances @head and the daemon only advances @tail. Packets
+ * that do not fit are counted in @drops rather than overwriting unread
+ * records.
+ */
+#define PKTLOG_RING_VERSION	1
+#define PKTLOG_RING_MAX		(16 << 20)
+#define PKTLOG_REC_ALIGN	8
+#define PKTLOG_REC_PAD		0x1	/* skip to the start of the data area */
+
+struct pktlog_ring_hdr {
+	__u32 version;
+	__u32 data_offset;
+	__u32 data_size;
+	__u32 drops;
+	__u32 head __aligned(64);
+	__u32 tail __aligned(64);
+};
+
+struct pktlog_rec {
+	__u32 len;	/* whole record, PKTLOG_REC_ALIGN aligned */
+	__u32 flags;
+};
+
 struct pktlog_data {
 	struct miscdevice misc;
 	atomic_t opened;
@@ -65,6 +95,13 @@ struct pktlog_data {
 	bool copy_file_header;
 	struct pcap_file_header file_hdr;
 	struct pktdump_hdr hdr;
+
+	spinlock_t ring_lock;
+	struct pktlog_ring_hdr *ring;
+	void *ring_data;
+	unsigned ring_size;
+	unsigned ring_head;
+	unsigned ring_drops;
 };
 
 enum {
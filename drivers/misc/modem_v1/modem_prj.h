@@ -265,7 +265,8 @@ struct skbuff_private {
 
 	u32 sipc_ch:8,	/* SIPC Channel Number			*/
 	    frm_ctrl:8,	/* Multi-framing control		*/
-	    reserved:15,
+	    reserved:14,
+	    bql:1,	/* Bytes accounted to the ndev TX queue	*/
 	    lnk_hdr:1;	/* Existence of a link-layer header	*/
 } __packed;
 
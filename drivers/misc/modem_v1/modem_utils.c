@@ -459,21 +459,24 @@ void iodev_netif_stop(struct io_device *iod, void *args)
 	}
 }
 
-void netif_tx_flowctl(struct modem_shared *msd, bool tx_stop)
+void netif_tx_flowctl_queue(struct modem_shared *msd, u16 queue, bool tx_stop)
 {
 	struct io_device *iod;
 
 	spin_lock(&msd->active_list_lock);
 	list_for_each_entry(iod, &msd->activated_ndev_list, node_ndev) {
+		if (unlikely(queue >= iod->ndev->real_num_tx_queues))
+			continue;
+
 		if (tx_stop) {
-			netif_stop_subqueue(iod->ndev, 0);
+			netif_stop_subqueue(iod->ndev, queue);
 #ifdef DEBUG_MODEM_IF_FLOW_CTRL
 			mif_err("tx_stop:%s, iod->ndev->name:%s\n",
 				tx_stop ? "suspend" : "resume",
 				iod->ndev->name);
 #endif
 		} else {
-			netif_wake_subqueue(iod->ndev, 0);
+			netif_wake_subqueue(iod->ndev, queue);
 #ifdef DEBUG_MODEM_IF_FLOW_CTRL
 			mif_err("tx_stop:%s, iod->ndev->name:%s\n",
 				tx_stop ? "suspend" : "resume",
@@ -486,6 +489,11 @@ void netif_tx_flowctl(struct modem_shared *msd, bool tx_stop)
 	return;
 }
 
+void netif_tx_flowctl(struct modem_shared *msd, bool tx_stop)
+{
+	netif_tx_flowctl_queue(msd, 0, tx_stop);
+}
+
 static void iodev_set_tx_link(struct io_device *iod, void *args)
 {
 	struct link_device *ld = (struct link_device *)args;
@@ -392,6 +392,7 @@ void iodev_netif_stop(struct io_device *iod, void *args);
 
 /* netif wake/stop queue of iod having activated ndev */
 void netif_tx_flowctl(struct modem_shared *msd, bool tx_stop);
+void netif_tx_flowctl_queue(struct modem_shared *msd, u16 queue, bool tx_stop);
 
 /* change tx_link of raw devices */
 void rawdevs_set_tx_link(struct modem_shared *msd, enum modem_link link_type);
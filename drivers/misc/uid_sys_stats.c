@@ -14,6 +14,7 @@
  */
 
 #include <linux/atomic.h>
+#include <linux/cred.h>
 #include <linux/cpufreq_times.h>
 #include <linux/err.h>
 #include <linux/hashtable.h>
@@ -67,8 +68,7 @@ struct task_entry {
 
 struct uid_entry {
 	uid_t uid;
-	cputime_t utime;
-	cputime_t stime;
+	struct user_struct *user;
 	cputime_t active_utime;
 	cputime_t active_stime;
 	int state;
@@ -81,14 +81,6 @@ struct uid_entry {
 #endif
 };
 
-static u64 compute_write_bytes(struct task_struct *task)
-{
-	if (task->ioac.write_bytes <= task->ioac.cancelled_write_bytes)
-		return 0;
-
-	return task->ioac.write_bytes - task->ioac.cancelled_write_bytes;
-}
-
 static void compute_io_bucket_stats(struct io_stats *io_bucket,
 					struct io_stats *io_curr,
 					struct io_stats *io_last,
@@ -123,6 +115,14 @@ static void compute_io_bucket_stats(struct io_stats *io_bucket,
 }
 
 #ifdef CONFIG_UID_SYS_STATS_DEBUG
+static u64 compute_write_bytes(struct task_struct *task)
+{
+	if (task->ioac.write_bytes <= task->ioac.cancelled_write_bytes)
+		return 0;
+
+	return task->ioac.write_bytes - task->ioac.cancelled_write_bytes;
+}
+
 static void get_full_task_comm(struct task_entry *task_entry,
 		struct task_struct *task)
 {
@@ -420,6 +420,29 @@ static struct uid_entry *find_or_register_uid_of_task(struct task_struct *task)
 	return uid_entry;
 }
 
+/*
+ * The cpu time and I/O of a uid are accumulated in its user_struct while
+ * they are accounted, so a read only looks at the users and not at every
+ * thread. The uid_entry keeps a reference on the user so that the time
+ * of exited tasks is not lost when the last one goes away.
+ */
+static void register_user(struct user_struct *up, void *data)
+{
+	struct user_namespace *user_ns = data;
+	struct uid_entry *uid_entry;
+
+	uid_entry = find_or_register_uid(from_kuid_munged(user_ns, up->uid));
+	if (uid_entry && !uid_entry->user)
+		uid_entry->user = get_uid(up);
+}
+
+static void pin_uid_user(struct uid_entry *uid_entry)
+{
+	if (!uid_entry->user)
+		uid_entry->user = find_user(make_kuid(current_user_ns(),
+						      uid_entry->uid));
+}
+
 static void *uid_start(struct seq_file *seq, loff_t *pos)
 {
 	rt_mutex_lock(&uid_lock);
@@ -442,10 +465,8 @@ static int uid_show(struct seq_file *m, void *v)
 	struct uid_entry *uid_entry;
 
 	hlist_for_each_entry(uid_entry, (struct hlist_head *)v, hash) {
-		cputime_t total_utime = uid_entry->utime +
-							uid_entry->active_utime;
-		cputime_t total_stime = uid_entry->stime +
-							uid_entry->active_stime;
+		cputime_t total_utime = uid_entry->active_utime;
+		cputime_t total_stime = uid_entry->active_stime;
 		debug_seq_printf(m, "%d: %llu %llu\n", uid_entry->uid,
 			(unsigned long long)jiffies_to_msecs(
 				cputime_to_jiffies(total_utime)) * USEC_PER_MSEC,
@@ -466,40 +487,27 @@ static const struct seq_operations uid_seqops = {
 static int uid_cputime_open(struct inode *inode, struct file *file)
 {
 	struct uid_entry *uid_entry = NULL;
-	struct task_struct *task, *temp;
-	struct user_namespace *user_ns = current_user_ns();
-	cputime_t utime;
-	cputime_t stime;
+	struct uid_sys_acct acct;
 	unsigned long bkt;
-	uid_t uid;
 
 	rt_mutex_lock(&uid_lock);
 
-	hash_for_each(hash_table, bkt, uid_entry, hash) {
-		uid_entry->active_stime = 0;
-		uid_entry->active_utime = 0;
-	}
 #ifdef CONFIG_DEBUG_UID_CPUTIME
 	record_uid_idx = 0;
 #endif
 
-	rcu_read_lock();
-	do_each_thread(temp, task) {
-		uid = from_kuid_munged(user_ns, task_uid(task));
-		if (!uid_entry || uid_entry->uid != uid)
-			uid_entry = find_or_register_uid_of_task(task);
-		if (!uid_entry) {
-			rcu_read_unlock();
-			rt_mutex_unlock(&uid_lock);
-			pr_err("%s: failed to find the uid_entry for uid %d\n",
-				__func__, uid);
-			return -ENOMEM;
-		}
-		task_cputime_adjusted(task, &utime, &stime);
-		uid_entry->active_utime += utime;
-		uid_entry->active_stime += stime;
-	} while_each_thread(temp, task);
-	rcu_read_unlock();
+	for_each_user_struct(register_user, current_user_ns());
+
+	hash_for_each(hash_table, bkt, uid_entry, hash) {
+		uid_entry->active_stime = 0;
+		uid_entry->active_utime = 0;
+		if (!uid_entry->user)
+			continue;
+
+		uid_sys_acct_read(uid_entry->user, &acct);
+		uid_entry->active_utime = acct.val[UID_ACCT_UTIME];
+		uid_entry->active_stime = acct.val[UID_ACCT_STIME];
+	}
 
 	rt_mutex_unlock(&uid_lock);
 	return seq_open(file, &uid_seqops);
@@ -559,6 +567,7 @@ static ssize_t uid_remove_write(struct file *file,
 						--uid_count);
 				remove_uid_tasks(uid_entry);
 				hash_del(&uid_entry->hash);
+				free_uid(uid_entry->user);
 				kfree(uid_entry);
 			}
 		}
@@ -575,44 +584,69 @@ static const struct file_operations uid_remove_fops = {
 };
 
 
-static void add_uid_io_stats(struct uid_entry *uid_entry,
-			struct task_struct *task, int slot)
+static void set_uid_io_stats(struct uid_entry *uid_entry)
 {
-	struct io_stats *io_slot = &uid_entry->io[slot];
+	struct io_stats *io_slot = &uid_entry->io[UID_STATE_TOTAL_CURR];
+	struct uid_sys_acct acct;
+	u64 write_bytes, cancelled;
+
+	if (!uid_entry->user)
+		return;
 
-	io_slot->read_bytes += task->ioac.read_bytes;
-	io_slot->write_bytes += compute_write_bytes(task);
-	io_slot->rchar += task->ioac.rchar;
-	io_slot->wchar += task->ioac.wchar;
-	io_slot->fsync += task->ioac.syscfs;
+	uid_sys_acct_read(uid_entry->user, &acct);
 
-	add_uid_tasks_io_stats(uid_entry, task, slot);
+	write_bytes = acct.val[UID_ACCT_WRITE_BYTES];
+	cancelled = acct.val[UID_ACCT_CANCELLED_WRITE_BYTES];
+
+	io_slot->read_bytes = acct.val[UID_ACCT_READ_BYTES];
+	io_slot->write_bytes = write_bytes > cancelled ?
+				write_bytes - cancelled : 0;
+	io_slot->rchar = acct.val[UID_ACCT_RCHAR];
+	io_slot->wchar = acct.val[UID_ACCT_WCHAR];
+	io_slot->fsync = acct.val[UID_ACCT_FSYNC];
 }
 
-static void update_io_stats_all_locked(void)
+#ifdef CONFIG_UID_SYS_STATS_DEBUG
+/* The per-task breakdown still needs the live threads */
+static void add_tasks_io_stats_locked(struct uid_entry *only)
 {
 	struct uid_entry *uid_entry = NULL;
 	struct task_struct *task, *temp;
 	struct user_namespace *user_ns = current_user_ns();
-	unsigned long bkt;
 	uid_t uid;
 
-	hash_for_each(hash_table, bkt, uid_entry, hash) {
-		memset(&uid_entry->io[UID_STATE_TOTAL_CURR], 0,
-			sizeof(struct io_stats));
-		set_io_uid_tasks_zero(uid_entry);
-	}
-
 	rcu_read_lock();
 	do_each_thread(temp, task) {
 		uid = from_kuid_munged(user_ns, task_uid(task));
+		if (only && only->uid != uid)
+			continue;
 		if (!uid_entry || uid_entry->uid != uid)
 			uid_entry = find_or_register_uid_of_task(task);
 		if (!uid_entry)
 			continue;
-		add_uid_io_stats(uid_entry, task, UID_STATE_TOTAL_CURR);
+		add_uid_tasks_io_stats(uid_entry, task, UID_STATE_TOTAL_CURR);
 	} while_each_thread(temp, task);
 	rcu_read_unlock();
+}
+#else
+static void add_tasks_io_stats_locked(struct uid_entry *only) {};
+#endif
+
+static void update_io_stats_all_locked(void)
+{
+	struct uid_entry *uid_entry = NULL;
+	unsigned long bkt;
+
+	for_each_user_struct(register_user, current_user_ns());
+
+	hash_for_each(hash_table, bkt, uid_entry, hash) {
+		memset(&uid_entry->io[UID_STATE_TOTAL_CURR], 0,
+			sizeof(struct io_stats));
+		set_io_uid_tasks_zero(uid_entry);
+		set_uid_io_stats(uid_entry);
+	}
+
+	add_tasks_io_stats_locked(NULL);
 
 	hash_for_each(hash_table, bkt, uid_entry, hash) {
 		compute_io_bucket_stats(&uid_entry->io[uid_entry->state],
@@ -625,20 +659,13 @@ static void update_io_stats_all_locked(void)
 
 static void update_io_stats_uid_locked(struct uid_entry *uid_entry)
 {
-	struct task_struct *task, *temp;
-	struct user_namespace *user_ns = current_user_ns();
-
 	memset(&uid_entry->io[UID_STATE_TOTAL_CURR], 0,
 		sizeof(struct io_stats));
 	set_io_uid_tasks_zero(uid_entry);
 
-	rcu_read_lock();
-	do_each_thread(temp, task) {
-		if (from_kuid_munged(user_ns, task_uid(task)) != uid_entry->uid)
-			continue;
-		add_uid_io_stats(uid_entry, task, UID_STATE_TOTAL_CURR);
-	} while_each_thread(temp, task);
-	rcu_read_unlock();
+	pin_uid_user(uid_entry);
+	set_uid_io_stats(uid_entry);
+	add_tasks_io_stats_locked(uid_entry);
 
 	compute_io_bucket_stats(&uid_entry->io[uid_entry->state],
 				&uid_entry->io[UID_STATE_TOTAL_CURR],
@@ -751,7 +778,6 @@ static int process_notifier(struct notifier_block *self,
 {
 	struct task_struct *task = v;
 	struct uid_entry *uid_entry;
-	cputime_t utime, stime;
 	uid_t uid;
 
 	if (!task)
@@ -765,11 +791,11 @@ static int process_notifier(struct notifier_block *self,
 		goto exit;
 	}
 
-	task_cputime_adjusted(task, &utime, &stime);
-	uid_entry->utime += utime;
-	uid_entry->stime += stime;
+	/* the user keeps the time and I/O of the task once it is gone */
+	if (!uid_entry->user)
+		uid_entry->user = get_uid(task_cred_xxx(task, user));
 
-	add_uid_io_stats(uid_entry, task, UID_STATE_DEAD_TASKS);
+	add_uid_tasks_io_stats(uid_entry, task, UID_STATE_DEAD_TASKS);
 
 exit:
 	rt_mutex_unlock(&uid_lock);
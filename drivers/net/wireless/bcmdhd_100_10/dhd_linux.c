@@ -58,6 +58,7 @@
 #include <linux/notifier.h>
 #include <linux/irq.h>
 #include <net/addrconf.h>
+#include <net/rx_prof.h>
 #ifdef ENABLE_ADAPTIVE_SCHED
 #include <linux/cpufreq.h>
 #endif /* ENABLE_ADAPTIVE_SCHED */
@@ -2617,6 +2618,7 @@ dhd_lb_rx_pkt_enqueue(dhd_pub_t *dhdp, void *pkt, int ifidx)
 	DHD_INFO(("%s enqueue pkt<%p> ifidx<%d> pend_queue<%d>\n", __FUNCTION__,
 		pkt, ifidx, skb_queue_len(&dhd->rx_pend_queue)));
 	DHD_PKTTAG_SET_IFID((dhd_pkttag_fr_t *)PKTTAG(pkt), ifidx);
+	rx_prof_start((struct sk_buff *)pkt, RX_PROF_WIFI);
 	__skb_queue_tail(&dhd->rx_pend_queue, pkt);
 }
 #endif /* DHD_LB_RXP */
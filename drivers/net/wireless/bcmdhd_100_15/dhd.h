@@ -2980,6 +2980,7 @@ extern void dhd_lb_stats_update_txc_histo(dhd_pub_t *dhdp, uint32 count);
 extern void dhd_lb_stats_update_rxc_histo(dhd_pub_t *dhdp, uint32 count);
 extern void dhd_lb_stats_txc_percpu_cnt_incr(dhd_pub_t *dhdp);
 extern void dhd_lb_stats_rxc_percpu_cnt_incr(dhd_pub_t *dhdp);
+extern void dhd_lb_stats_update_rx_flow_histo(dhd_pub_t *dhdp, uint32 count);
 #define DHD_LB_STATS_INIT(dhdp)	dhd_lb_stats_init(dhdp)
 #define DHD_LB_STATS_DEINIT(dhdp) dhd_lb_stats_deinit(dhdp)
 /* Reset is called from common layer so it takes dhd_pub_t as argument */
@@ -2997,6 +2998,8 @@ extern void dhd_lb_stats_rxc_percpu_cnt_incr(dhd_pub_t *dhdp);
 #define DHD_LB_STATS_UPDATE_RXC_HISTO(dhdp, x)	dhd_lb_stats_update_rxc_histo(dhdp, x)
 #define DHD_LB_STATS_TXC_PERCPU_CNT_INCR(dhdp)	dhd_lb_stats_txc_percpu_cnt_incr(dhdp)
 #define DHD_LB_STATS_RXC_PERCPU_CNT_INCR(dhdp)	dhd_lb_stats_rxc_percpu_cnt_incr(dhdp)
+#define DHD_LB_STATS_UPDATE_RX_FLOW_HISTO(dhdp, x) \
+	dhd_lb_stats_update_rx_flow_histo(dhdp, x)
 #else /* !DHD_LB_STATS */
 #define DHD_LB_STATS_INIT(dhdp)	 DHD_LB_STATS_NOOP
 #define DHD_LB_STATS_DEINIT(dhdp) DHD_LB_STATS_NOOP
@@ -3010,6 +3013,7 @@ extern void dhd_lb_stats_rxc_percpu_cnt_incr(dhd_pub_t *dhdp);
 #define DHD_LB_STATS_UPDATE_RXC_HISTO(dhd, x) DHD_LB_STATS_NOOP
 #define DHD_LB_STATS_TXC_PERCPU_CNT_INCR(dhdp) DHD_LB_STATS_NOOP
 #define DHD_LB_STATS_RXC_PERCPU_CNT_INCR(dhdp) DHD_LB_STATS_NOOP
+#define DHD_LB_STATS_UPDATE_RX_FLOW_HISTO(dhdp, x) DHD_LB_STATS_NOOP
 #endif /* !DHD_LB_STATS */
 
 #ifdef DHD_SSSR_DUMP
@@ -94,6 +94,10 @@ extern int dhd_bus_console_in(dhd_pub_t *dhd, uchar *msg, uint msglen);
 
 /* Deferred processing for the bus, return TRUE requests reschedule */
 extern bool dhd_bus_dpc(struct dhd_bus *bus);
+#ifdef DHD_LB_BUSY_POLL
+/* Busy poll the RX completions, the caller keeps the dpc from running */
+extern bool dhd_bus_rx_busy_poll(struct dhd_bus *bus, uint bound);
+#endif /* DHD_LB_BUSY_POLL */
 extern void dhd_bus_isr(bool * InterruptRecognized, bool * QueueMiniportHandleInterrupt, void *arg);
 
 /* Check for and handle local prot-specific iovar commands */
@@ -5448,6 +5448,9 @@ dhd_dpc_kill(dhd_pub_t *dhdp)
 #ifdef DHD_LB_RXP
 	cancel_work_sync(&dhd->rx_napi_dispatcher_work);
 	__skb_queue_purge(&dhd->rx_pend_queue);
+#ifdef DHD_LB_RXP_FLOW
+	dhd_lb_rx_flow_cancel(dhd);
+#endif /* DHD_LB_RXP_FLOW */
 #endif /* DHD_LB_RXP */
 #ifdef DHD_LB_TXP
 	cancel_work_sync(&dhd->tx_dispatcher_work);
@@ -6840,6 +6843,9 @@ dhd_stop(struct net_device *net)
 			skb_queue_purge(&dhd->rx_napi_queue);
 			napi_disable(&dhd->rx_napi_struct);
 			netif_napi_del(&dhd->rx_napi_struct);
+#ifdef DHD_LB_RXP_FLOW
+			dhd_lb_rx_flow_napi_del(dhd);
+#endif /* DHD_LB_RXP_FLOW */
 			dhd->rx_napi_netdev = NULL;
 		}
 #endif /* DHD_LB_RXP */
@@ -7198,6 +7204,10 @@ dhd_open(struct net_device *net)
 			DHD_INFO(("%s load balance init rx_napi_struct\n", __FUNCTION__));
 			skb_queue_head_init(&dhd->rx_napi_queue);
 			__skb_queue_head_init(&dhd->rx_process_queue);
+#ifdef DHD_LB_RXP_FLOW
+			dhd_lb_rx_flow_napi_add(dhd, dhd->rx_napi_netdev,
+				dhd_napi_weight);
+#endif /* DHD_LB_RXP_FLOW */
 		} /* rx_napi_netdev == NULL */
 #endif /* DHD_LB_RXP */
 
@@ -7878,6 +7888,9 @@ dhd_allocate_if(dhd_pub_t *dhdpub, int ifidx, const char *name,
 				napi_disable(&dhdinfo->rx_napi_struct);
 				netif_napi_del(&dhdinfo->rx_napi_struct);
 				skb_queue_purge(&dhdinfo->rx_napi_queue);
+#ifdef DHD_LB_RXP_FLOW
+				dhd_lb_rx_flow_napi_del(dhdinfo);
+#endif /* DHD_LB_RXP_FLOW */
 				dhdinfo->rx_napi_netdev = NULL;
 			}
 #endif /* DHD_LB_RXP && PCIE_FULL_DONGLE */
@@ -8030,6 +8043,15 @@ dhd_remove_if(dhd_pub_t *dhdpub, int ifidx, bool need_rtnl_lock)
 	return BCME_OK;
 }
 
+#ifdef DHD_LB_BUSY_POLL
+/* napi->dev is always the primary interface, see rx_napi_netdev */
+static int
+dhd_busy_poll(struct napi_struct *napi)
+{
+	return dhd_lb_busy_poll(DHD_DEV_INFO(napi->dev), napi);
+}
+#endif /* DHD_LB_BUSY_POLL */
+
 static struct net_device_ops dhd_ops_pri = {
 	.ndo_open = dhd_pri_open,
 	.ndo_stop = dhd_pri_stop,
@@ -8047,6 +8069,9 @@ static struct net_device_ops dhd_ops_pri = {
 #else
 	.ndo_set_multicast_list = dhd_set_multicast_list,
 #endif // endif
+#ifdef DHD_LB_BUSY_POLL
+	.ndo_busy_poll = dhd_busy_poll,
+#endif /* DHD_LB_BUSY_POLL */
 };
 
 static struct net_device_ops dhd_ops_virt = {
@@ -8887,6 +8912,9 @@ dhd_attach(osl_t *osh, struct dhd_bus *bus, uint bus_hdrlen)
 	__skb_queue_head_init(&dhd->rx_process_queue);
 	/* Initialize the work that dispatches NAPI job to a given core */
 	INIT_WORK(&dhd->rx_napi_dispatcher_work, dhd_rx_napi_dispatcher_fn);
+#ifdef DHD_LB_RXP_FLOW
+	dhd_lb_rx_flow_init(dhd);
+#endif /* DHD_LB_RXP_FLOW */
 	DHD_INFO(("%s load balance init rx_napi_queue\n", __FUNCTION__));
 #endif /* DHD_LB_RXP */
 
@@ -12346,6 +12374,9 @@ void dhd_detach(dhd_pub_t *dhdp)
 #ifdef DHD_LB_RXP
 		cancel_work_sync(&dhd->rx_napi_dispatcher_work);
 		__skb_queue_purge(&dhd->rx_pend_queue);
+#ifdef DHD_LB_RXP_FLOW
+		dhd_lb_rx_flow_cancel(dhd);
+#endif /* DHD_LB_RXP_FLOW */
 #endif /* DHD_LB_RXP */
 #ifdef DHD_LB_TXP
 		cancel_work_sync(&dhd->tx_dispatcher_work);
@@ -184,6 +184,13 @@ struct dhd_rx_tx_work {
 #endif /* !DHD_LB */
 #endif /* DHD_LB_RXP || DHD_LB_RXC || DHD_LB_TXC || DHD_LB_STATS */
 
+#if defined(DHD_LB_BUSY_POLL)
+#if !defined(DHD_LB_RXP) || !defined(CONFIG_NET_RX_BUSY_POLL)
+#error "DHD_LB_BUSY_POLL needs DHD_LB_RXP and CONFIG_NET_RX_BUSY_POLL"
+#endif /* !DHD_LB_RXP || !CONFIG_NET_RX_BUSY_POLL */
+#include <net/busy_poll.h>
+#endif /* DHD_LB_BUSY_POLL */
+
 #if defined(DHD_LB)
 /* Dynamic CPU selection for load balancing */
 #include <linux/cpu.h>
@@ -282,6 +282,38 @@ lbrxp_onoff(struct dhd_info *dev, const char *buf, size_t count)
 
 	return count;
 }
+
+#if defined(DHD_LB_RXP_FLOW)
+static ssize_t
+show_lbrxp_flow(struct dhd_info *dev, char *buf)
+{
+	ssize_t ret = 0;
+	unsigned long onoff;
+	dhd_info_t *dhd = (dhd_info_t *)dev;
+
+	onoff = atomic_read(&dhd->lb_rxp_flow_active);
+	ret = scnprintf(buf, PAGE_SIZE - 1, "%lu \n",
+		onoff);
+	return ret;
+}
+
+static ssize_t
+lbrxp_flow_onoff(struct dhd_info *dev, const char *buf, size_t count)
+{
+	unsigned long onoff;
+	dhd_info_t *dhd = (dhd_info_t *)dev;
+
+	onoff = bcm_strtoul(buf, NULL, 10);
+
+	sscanf(buf, "%lu", &onoff);
+	if (onoff != 0 && onoff != 1) {
+		return -EINVAL;
+	}
+	atomic_set(&dhd->lb_rxp_flow_active, onoff);
+
+	return count;
+}
+#endif /* DHD_LB_RXP_FLOW */
 #endif /* DHD_LB_RXP */
 
 #ifdef DHD_LOG_DUMP
@@ -417,6 +449,10 @@ static struct dhd_attr dhd_attr_lbtxp =
 #if defined(DHD_LB_RXP)
 static struct dhd_attr dhd_attr_lbrxp =
 	__ATTR(lbrxp, 0660, show_lbrxp, lbrxp_onoff);
+#if defined(DHD_LB_RXP_FLOW)
+static struct dhd_attr dhd_attr_lbrxp_flow =
+	__ATTR(lbrxp_flow, 0660, show_lbrxp_flow, lbrxp_flow_onoff);
+#endif /* DHD_LB_RXP_FLOW */
 #endif /* DHD_LB_RXP */
 
 #ifdef DHD_LOG_DUMP
@@ -441,6 +477,9 @@ static struct attribute *default_attrs[] = {
 #endif /* DHD_LB_TXP */
 #if defined(DHD_LB_RXP)
 	&dhd_attr_lbrxp.attr,
+#if defined(DHD_LB_RXP_FLOW)
+	&dhd_attr_lbrxp_flow.attr,
+#endif /* DHD_LB_RXP_FLOW */
 #endif /* DHD_LB_RXP */
 #ifdef DHD_LOG_DUMP
 	&dhd_attr_logdump_periodic_flush.attr,
@@ -30,6 +30,14 @@
 
 #include <dhd_linux_priv.h>
 
+#if defined(DHD_LB_RXP_FLOW)
+#include <linux/ipv6.h>
+#include <net/ip.h>
+#include <net/rx_prof.h>
+#include <linux/jhash.h>
+#include <asm/unaligned.h>
+#endif /* DHD_LB_RXP_FLOW */
+
 extern dhd_pub_t* g_dhd_pub;
 
 #if defined(DHD_LB)
@@ -43,6 +51,14 @@ dhd_lb_set_default_cpus(dhd_info_t *dhd)
 	atomic_set(&dhd->tx_compl_cpu, 2);
 	atomic_set(&dhd->tx_cpu, 2);
 	atomic_set(&dhd->net_tx_cpu, 0);
+#if defined(DHD_LB_RXP_FLOW)
+	{
+		int i;
+
+		for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++)
+			atomic_set(&dhd->rx_flow_napi[i].cpu, 1);
+	}
+#endif /* DHD_LB_RXP_FLOW */
 }
 
 void
@@ -102,6 +118,37 @@ dhd_cpumasks_init(dhd_info_t *dhd)
 	return ret;
 }
 
+#if defined(DHD_LB_RXP_FLOW)
+/*
+ * Spread the per-flow NAPI contexts round robin over the available primary
+ * (big) CPUs, or the secondary ones if no primary CPU is online. With
+ * neither, all of them follow napi_cpu.
+ */
+static void
+dhd_lb_rx_flow_select_cpus(dhd_info_t *dhd)
+{
+	struct cpumask *mask = dhd->cpumask_primary_new;
+	uint32 cpu;
+	int i;
+
+	if (cpumask_empty(mask))
+		mask = dhd->cpumask_secondary_new;
+
+	cpu = cpumask_first(mask);
+	for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+		if (cpu >= nr_cpu_ids) {
+			atomic_set(&dhd->rx_flow_napi[i].cpu,
+				atomic_read(&dhd->rx_napi_cpu));
+			continue;
+		}
+		atomic_set(&dhd->rx_flow_napi[i].cpu, cpu);
+		cpu = cpumask_next(cpu, mask);
+		if (cpu >= nr_cpu_ids)
+			cpu = cpumask_first(mask);
+	}
+}
+#endif /* DHD_LB_RXP_FLOW */
+
 /*
  * The CPU Candidacy Algorithm
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -218,6 +265,10 @@ void dhd_select_cpu_candidacy(dhd_info_t *dhd)
 	atomic_set(&dhd->rx_compl_cpu, compl_cpu);
 	atomic_set(&dhd->tx_cpu, tx_cpu);
 
+#if defined(DHD_LB_RXP_FLOW)
+	dhd_lb_rx_flow_select_cpus(dhd);
+#endif /* DHD_LB_RXP_FLOW */
+
 	return;
 }
 
@@ -459,6 +510,23 @@ void dhd_lb_stats_init(dhd_pub_t *dhdp)
 		}
 	}
 #endif /* DHD_LB_RXC */
+#ifdef DHD_LB_RXP_FLOW
+	for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+		DHD_LB_STATS_CLR(dhd->rx_flow_napi[i].sched_cnt);
+		DHD_LB_STATS_CLR(dhd->rx_flow_napi[i].pkt_cnt);
+	}
+	for (j = 0; j < HIST_BIN_SIZE; j++) {
+		dhd->rx_flow_hist[j] = (uint32 *)MALLOC(dhdp->osh, alloc_size);
+		if (!dhd->rx_flow_hist[j]) {
+			DHD_ERROR(("%s(): dhd->rx_flow_hist[%d] malloc failed \n",
+				__FUNCTION__, j));
+			return;
+		}
+		for (i = 0; i < num_cpus; i++) {
+			DHD_LB_STATS_CLR(dhd->rx_flow_hist[j][i]);
+		}
+	}
+#endif /* DHD_LB_RXP_FLOW */
 	return;
 }
 
@@ -527,6 +595,12 @@ void dhd_lb_stats_deinit(dhd_pub_t *dhdp)
 			dhd->rxc_hist[j] = NULL;
 		}
 #endif /* DHD_LB_RXC */
+#ifdef DHD_LB_RXP_FLOW
+		if (dhd->rx_flow_hist[j]) {
+			MFREE(dhdp->osh, dhd->rx_flow_hist[j], alloc_size);
+			dhd->rx_flow_hist[j] = NULL;
+		}
+#endif /* DHD_LB_RXP_FLOW */
 	}
 
 	return;
@@ -626,6 +700,24 @@ void dhd_lb_stats_dump(dhd_pub_t *dhdp, struct bcmstrbuf *strbuf)
 	dhd_lb_stats_dump_histo(dhdp, strbuf, dhd->napi_rx_hist);
 #endif /* DHD_LB_RXP */
 
+#ifdef DHD_LB_RXP_FLOW
+	{
+		int i;
+
+		bcm_bprintf(strbuf, "\nrx_flow_napi: active %d\n",
+			atomic_read(&dhd->lb_rxp_flow_active));
+		for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+			dhd_rx_flow_napi_t *flow = &dhd->rx_flow_napi[i];
+
+			bcm_bprintf(strbuf, "%d: cpu %d sched %u pkts %u\n", i,
+				atomic_read(&flow->cpu), flow->sched_cnt,
+				flow->pkt_cnt);
+		}
+		bcm_bprintf(strbuf, "\nFlow NAPI Packets Received Histogram:\n");
+		dhd_lb_stats_dump_histo(dhdp, strbuf, dhd->rx_flow_hist);
+	}
+#endif /* DHD_LB_RXP_FLOW */
+
 #ifdef DHD_LB_RXC
 	bcm_bprintf(strbuf, "\nrxc_percpu_run_cnt:\n");
 	dhd_lb_stats_dump_cpu_array(strbuf, dhd->rxc_percpu_run_cnt);
@@ -720,6 +812,20 @@ void dhd_lb_stats_update_rxc_histo(dhd_pub_t *dhdp, uint32 count)
 	return;
 }
 
+#ifdef DHD_LB_RXP_FLOW
+void dhd_lb_stats_update_rx_flow_histo(dhd_pub_t *dhdp, uint32 count)
+{
+	int cpu;
+	dhd_info_t *dhd = dhdp->info;
+
+	cpu = get_cpu();
+	put_cpu();
+	dhd_lb_stats_update_histo(dhd->rx_flow_hist, count, cpu);
+
+	return;
+}
+#endif /* DHD_LB_RXP_FLOW */
+
 void dhd_lb_stats_txc_percpu_cnt_incr(dhd_pub_t *dhdp)
 {
 	dhd_info_t *dhd = dhdp->info;
@@ -967,28 +1073,19 @@ dhd_lb_tx_dispatch(dhd_pub_t *dhdp)
  * Dequeue each packet from head of rx_process_queue, fetch the ifid from the
  * packet tag and sendup.
  */
-int
-dhd_napi_poll(struct napi_struct *napi, int budget)
+static int
+dhd_napi_process(struct dhd_info *dhd, struct napi_struct *napi,
+	struct sk_buff_head *napi_queue, struct sk_buff_head *process_queue, int budget)
 {
 	int ifid;
 	const int pkt_count = 1;
 	const int chan = 0;
 	struct sk_buff * skb;
 	unsigned long flags;
-	struct dhd_info *dhd;
 	int processed = 0;
 
-#if defined(STRICT_GCC_WARNINGS) && defined(__GNUC__)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif // endif
-	dhd = container_of(napi, struct dhd_info, rx_napi_struct);
-#if defined(STRICT_GCC_WARNINGS) && defined(__GNUC__)
-#pragma GCC diagnostic pop
-#endif // endif
-
 	DHD_INFO(("%s napi_queue<%d> budget<%d>\n",
-		__FUNCTION__, skb_queue_len(&dhd->rx_napi_queue), budget));
+		__FUNCTION__, skb_queue_len(napi_queue), budget));
 
 	/*
 	 * Extract the entire rx_napi_queue into another rx_process_queue
@@ -1000,11 +1097,11 @@ dhd_napi_poll(struct napi_struct *napi, int budget)
 	 * If there are less than budget number of skbs in rx_process_queue,
 	 * call napi_complete to stop rescheduling napi poll.
 	 */
-	spin_lock_irqsave(&dhd->rx_napi_queue.lock, flags);
-	skb_queue_splice_tail_init(&dhd->rx_napi_queue, &dhd->rx_process_queue);
-	spin_unlock_irqrestore(&dhd->rx_napi_queue.lock, flags);
+	spin_lock_irqsave(&napi_queue->lock, flags);
+	skb_queue_splice_tail_init(napi_queue, process_queue);
+	spin_unlock_irqrestore(&napi_queue->lock, flags);
 
-	while ((processed < budget) && (skb = __skb_dequeue(&dhd->rx_process_queue)) != NULL) {
+	while ((processed < budget) && (skb = __skb_dequeue(process_queue)) != NULL) {
 		OSL_PREFETCH(skb->data);
 
 		ifid = DHD_PKTTAG_IFID((dhd_pkttag_fr_t *)PKTTAG(skb));
@@ -1012,10 +1109,36 @@ dhd_napi_poll(struct napi_struct *napi, int budget)
 		DHD_INFO(("%s dhd_rx_frame pkt<%p> ifid<%d>\n",
 			__FUNCTION__, skb, ifid));
 
+#ifdef DHD_LB_BUSY_POLL
+		/* let the receiving socket find this NAPI to busy poll it */
+		skb_mark_napi_id(skb, napi);
+#endif /* DHD_LB_BUSY_POLL */
+
 		dhd_rx_frame(&dhd->pub, ifid, skb, pkt_count, chan);
 		processed++;
 	}
 
+	return processed;
+}
+
+int
+dhd_napi_poll(struct napi_struct *napi, int budget)
+{
+	struct dhd_info *dhd;
+	int processed;
+
+#if defined(STRICT_GCC_WARNINGS) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif // endif
+	dhd = container_of(napi, struct dhd_info, rx_napi_struct);
+#if defined(STRICT_GCC_WARNINGS) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif // endif
+
+	processed = dhd_napi_process(dhd, napi, &dhd->rx_napi_queue,
+		&dhd->rx_process_queue, budget);
+
 	DHD_LB_STATS_UPDATE_NAPI_HISTO(&dhd->pub, processed);
 
 	DHD_INFO(("%s processed %d\n", __FUNCTION__, processed));
@@ -1027,6 +1150,44 @@ dhd_napi_poll(struct napi_struct *napi, int budget)
 	return processed;
 }
 
+#ifdef DHD_LB_BUSY_POLL
+#define DHD_BUSY_POLL_RXBOUND	16
+#define DHD_BUSY_POLL_BUDGET	8
+
+/**
+ * dhd_lb_busy_poll - ndo_busy_poll for a socket whose packets came up
+ * through @napi, either rx_napi_struct or one of the per-flow contexts
+ *
+ * Pull a few fresh RX completions from the dongle without waiting for the
+ * D2H interrupt and the dpc, then run @napi right here if it's idle, so
+ * that they reach the socket from the busy polling CPU. The dpc tasklet is
+ * held meanwhile; either of the two is skipped when it's busy elsewhere.
+ */
+int
+dhd_lb_busy_poll(dhd_info_t *dhd, struct napi_struct *napi)
+{
+	int processed = 0;
+
+	if (dhd->pub.busstate != DHD_BUS_DATA)
+		return LL_FLUSH_FAILED;
+
+	if (dhd->thr_dpc_ctl.thr_pid < 0 && tasklet_trylock(&dhd->tasklet)) {
+		dhd_bus_rx_busy_poll(dhd->pub.bus, DHD_BUSY_POLL_RXBOUND);
+		tasklet_unlock(&dhd->tasklet);
+	}
+
+	if (napi_schedule_prep(napi)) {
+		processed = napi->poll(napi, DHD_BUSY_POLL_BUDGET);
+		if (processed == DHD_BUSY_POLL_BUDGET) {
+			napi_complete_done(napi, processed);
+			napi_schedule(napi);
+		}
+	}
+
+	return processed;
+}
+#endif /* DHD_LB_BUSY_POLL */
+
 /**
  * dhd_napi_schedule - Place the napi struct into the current cpus softnet napi
  * poll list. This function may be invoked via the smp_call_function_single
@@ -1126,6 +1287,196 @@ void dhd_rx_napi_dispatcher_fn(struct work_struct * work)
 	dhd_napi_schedule(dhd);
 }
 
+#if defined(DHD_LB_RXP_FLOW)
+/*
+ * Per-flow RX steering
+ * ~~~~~~~~~~~~~~~~~~~~
+ * A single rx_napi_struct caps RX at what one core's NET_RX softirq can
+ * push up the stack. With lb_rxp_flow_active set, IP packets are instead
+ * hashed on their addresses and ports into one of DHD_LB_RXP_FLOW_NAPI
+ * contexts, each with its own NAPI instance on one of the big cores (see
+ * dhd_lb_rx_flow_select_cpus()). Everything else, events and EAPOL
+ * included, keeps going through rx_napi_struct.
+ */
+static bool
+dhd_lb_rx_flow_hash(struct sk_buff *skb, uint32 *hash)
+{
+	const struct ethhdr *eh = (const struct ethhdr *)skb->data;
+	uint32 len = skb_headlen(skb);
+	const uint8 *l4 = NULL;
+	uint32 saddr, daddr, ports = 0;
+	uint8 proto;
+
+	if (len < ETH_HLEN)
+		return FALSE;
+	len -= ETH_HLEN;
+
+	if (eh->h_proto == htons(ETH_P_IP)) {
+		const struct iphdr *iph = (const struct iphdr *)(eh + 1);
+
+		if (len < sizeof(*iph) || iph->ihl < 5)
+			return FALSE;
+		saddr = (__force uint32)iph->saddr;
+		daddr = (__force uint32)iph->daddr;
+		proto = iph->protocol;
+		if (!ip_is_fragment(iph) && len >= iph->ihl * 4 + sizeof(ports))
+			l4 = (const uint8 *)iph + iph->ihl * 4;
+	} else if (eh->h_proto == htons(ETH_P_IPV6)) {
+		const struct ipv6hdr *ip6h = (const struct ipv6hdr *)(eh + 1);
+		const __be32 *s = ip6h->saddr.s6_addr32;
+		const __be32 *d = ip6h->daddr.s6_addr32;
+
+		if (len < sizeof(*ip6h))
+			return FALSE;
+		saddr = (__force uint32)(s[0] ^ s[1] ^ s[2] ^ s[3]);
+		daddr = (__force uint32)(d[0] ^ d[1] ^ d[2] ^ d[3]);
+		proto = ip6h->nexthdr;
+		if (len >= sizeof(*ip6h) + sizeof(ports))
+			l4 = (const uint8 *)(ip6h + 1);
+	} else {
+		return FALSE;
+	}
+
+	if (l4 && (proto == IPPROTO_TCP || proto == IPPROTO_UDP))
+		ports = get_unaligned((const uint32 *)l4);
+
+	*hash = jhash_3words(saddr, daddr, ports ^ proto, 0);
+	return TRUE;
+}
+
+static int
+dhd_rx_flow_napi_poll(struct napi_struct *napi, int budget)
+{
+	dhd_rx_flow_napi_t *flow = container_of(napi, dhd_rx_flow_napi_t, napi);
+	int processed;
+
+	processed = dhd_napi_process(flow->dhd, napi, &flow->napi_queue,
+		&flow->process_queue, budget);
+
+	DHD_LB_STATS_UPDATE_RX_FLOW_HISTO(&flow->dhd->pub, processed);
+	DHD_LB_STATS_ADD(flow->pkt_cnt, processed);
+
+	if (processed < budget) {
+		napi_complete(napi);
+	}
+
+	return processed;
+}
+
+static void
+dhd_rx_flow_napi_schedule(dhd_rx_flow_napi_t *flow)
+{
+	if (napi_schedule_prep(&flow->napi)) {
+		__napi_schedule(&flow->napi);
+#ifdef WAKEUP_KSOFTIRQD_POST_NAPI_SCHEDULE
+		raise_softirq(NET_RX_SOFTIRQ);
+#endif /* WAKEUP_KSOFTIRQD_POST_NAPI_SCHEDULE */
+	}
+}
+
+static void
+dhd_rx_flow_napi_dispatcher_fn(struct work_struct *work)
+{
+	dhd_rx_flow_napi_t *flow =
+		container_of(work, dhd_rx_flow_napi_t, dispatcher_work);
+
+	dhd_rx_flow_napi_schedule(flow);
+}
+
+/* Hand every context's pending packets to its NAPI, on its own CPU */
+static void
+dhd_lb_rx_flow_dispatch(dhd_info_t *dhd)
+{
+	unsigned long flags;
+	int curr_cpu, on_cpu;
+	int i;
+
+	curr_cpu = get_cpu();
+	for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+		dhd_rx_flow_napi_t *flow = &dhd->rx_flow_napi[i];
+
+		if (skb_queue_empty(&flow->pend_queue))
+			continue;
+
+		spin_lock_irqsave(&flow->napi_queue.lock, flags);
+		skb_queue_splice_tail_init(&flow->pend_queue, &flow->napi_queue);
+		spin_unlock_irqrestore(&flow->napi_queue.lock, flags);
+
+		DHD_LB_STATS_INCR(flow->sched_cnt);
+
+		on_cpu = atomic_read(&flow->cpu);
+		if ((on_cpu == curr_cpu) || (!cpu_online(on_cpu)))
+			dhd_rx_flow_napi_schedule(flow);
+		else
+			dhd_work_schedule_on(&flow->dispatcher_work, on_cpu);
+	}
+	put_cpu();
+}
+
+void
+dhd_lb_rx_flow_init(dhd_info_t *dhd)
+{
+	int i;
+
+	for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+		dhd_rx_flow_napi_t *flow = &dhd->rx_flow_napi[i];
+
+		flow->dhd = dhd;
+		__skb_queue_head_init(&flow->pend_queue);
+		skb_queue_head_init(&flow->napi_queue);
+		__skb_queue_head_init(&flow->process_queue);
+		INIT_WORK(&flow->dispatcher_work, dhd_rx_flow_napi_dispatcher_fn);
+	}
+	atomic_set(&dhd->lb_rxp_flow_active, 1);
+}
+
+/* Called along with the netif_napi_add() of rx_napi_struct */
+void
+dhd_lb_rx_flow_napi_add(dhd_info_t *dhd, struct net_device *net, int weight)
+{
+	int i;
+
+	for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+		dhd_rx_flow_napi_t *flow = &dhd->rx_flow_napi[i];
+
+		memset(&flow->napi, 0, sizeof(struct napi_struct));
+		netif_napi_add(net, &flow->napi, dhd_rx_flow_napi_poll, weight);
+		napi_enable(&flow->napi);
+		skb_queue_head_init(&flow->napi_queue);
+		__skb_queue_head_init(&flow->process_queue);
+	}
+}
+
+/* Called along with the netif_napi_del() of rx_napi_struct */
+void
+dhd_lb_rx_flow_napi_del(dhd_info_t *dhd)
+{
+	int i;
+
+	for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+		dhd_rx_flow_napi_t *flow = &dhd->rx_flow_napi[i];
+
+		cancel_work_sync(&flow->dispatcher_work);
+		napi_disable(&flow->napi);
+		netif_napi_del(&flow->napi);
+		__skb_queue_purge(&flow->pend_queue);
+		skb_queue_purge(&flow->napi_queue);
+		__skb_queue_purge(&flow->process_queue);
+	}
+}
+
+void
+dhd_lb_rx_flow_cancel(dhd_info_t *dhd)
+{
+	int i;
+
+	for (i = 0; i < DHD_LB_RXP_FLOW_NAPI; i++) {
+		cancel_work_sync(&dhd->rx_flow_napi[i].dispatcher_work);
+		__skb_queue_purge(&dhd->rx_flow_napi[i].pend_queue);
+	}
+}
+#endif /* DHD_LB_RXP_FLOW */
+
 /**
  * dhd_lb_rx_napi_dispatch - load balance by dispatching the rx_napi_struct
  * to run on another CPU. The rx_napi_struct's poll function will retrieve all
@@ -1149,6 +1500,13 @@ dhd_lb_rx_napi_dispatch(dhd_pub_t *dhdp)
 		return;
 	}
 
+#if defined(DHD_LB_RXP_FLOW)
+	dhd_lb_rx_flow_dispatch(dhd);
+	/* only packets that were not steered are left to dispatch */
+	if (skb_queue_empty(&dhd->rx_pend_queue))
+		return;
+#endif /* DHD_LB_RXP_FLOW */
+
 	DHD_INFO(("%s append napi_queue<%d> pend_queue<%d>\n", __FUNCTION__,
 		skb_queue_len(&dhd->rx_napi_queue), skb_queue_len(&dhd->rx_pend_queue)));
 
@@ -1203,6 +1561,19 @@ dhd_lb_rx_pkt_enqueue(dhd_pub_t *dhdp, void *pkt, int ifidx)
 	DHD_INFO(("%s enqueue pkt<%p> ifidx<%d> pend_queue<%d>\n", __FUNCTION__,
 		pkt, ifidx, skb_queue_len(&dhd->rx_pend_queue)));
 	DHD_PKTTAG_SET_IFID((dhd_pkttag_fr_t *)PKTTAG(pkt), ifidx);
+	rx_prof_start((struct sk_buff *)pkt, RX_PROF_WIFI);
+#if defined(DHD_LB_RXP_FLOW)
+	if (atomic_read(&dhd->lb_rxp_flow_active)) {
+		uint32 hash;
+
+		if (dhd_lb_rx_flow_hash(pkt, &hash)) {
+			__skb_queue_tail(&dhd->rx_flow_napi[
+				reciprocal_scale(hash, DHD_LB_RXP_FLOW_NAPI)].pend_queue,
+				pkt);
+			return;
+		}
+	}
+#endif /* DHD_LB_RXP_FLOW */
 	__skb_queue_tail(&dhd->rx_pend_queue, pkt);
 }
 #endif /* DHD_LB_RXP */
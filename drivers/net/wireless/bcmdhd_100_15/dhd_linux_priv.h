@@ -53,6 +53,31 @@
 #include <dhd_flowring.h>
 #endif /* PCIE_FULL_DONGLE */
 
+#if defined(DHD_LB_RXP_FLOW)
+/* Number of NAPI contexts RX flows are spread over */
+#define DHD_LB_RXP_FLOW_NAPI	4
+
+/*
+ * One RX steering context. Flows are hashed from the packet headers into a
+ * context, which has the same pend/napi/process queue pipeline as the
+ * primary rx_napi_struct and runs on its own CPU, so that one flow always
+ * takes the same path and is never reordered.
+ */
+typedef struct dhd_rx_flow_napi {
+	struct sk_buff_head	pend_queue ____cacheline_aligned;
+	struct sk_buff_head	napi_queue ____cacheline_aligned;
+	struct sk_buff_head	process_queue ____cacheline_aligned;
+	struct napi_struct	napi ____cacheline_aligned;
+	struct work_struct	dispatcher_work;
+	atomic_t		cpu; /* cpu on which the napi is dispatched */
+	struct dhd_info		*dhd;
+	/* Number of times this context got scheduled */
+	uint32			sched_cnt;
+	/* Number of packets this context sent up */
+	uint32			pkt_cnt;
+} dhd_rx_flow_napi_t;
+#endif /* DHD_LB_RXP_FLOW */
+
 /*
  * Do not include this header except for the dhd_linux.c dhd_linux_sysfs.c
  * Local private structure (extension of pub)
@@ -228,6 +253,14 @@ typedef struct dhd_info {
 	struct work_struct    tx_dispatcher_work;
 	struct work_struct	  rx_compl_dispatcher_work;
 
+#if defined(DHD_LB_RXP_FLOW)
+	/* Per-flow RX steering contexts, used instead of rx_pend_queue for
+	 * IP packets while lb_rxp_flow_active is set
+	 */
+	dhd_rx_flow_napi_t	rx_flow_napi[DHD_LB_RXP_FLOW_NAPI];
+	atomic_t		lb_rxp_flow_active;
+#endif /* DHD_LB_RXP_FLOW */
+
 	/* Number of times DPC Tasklet ran */
 	uint32	dhd_dpc_cnt;
 	/* Number of times NAPI processing got scheduled */
@@ -322,6 +355,10 @@ typedef struct dhd_info {
 	uint32 *napi_rx_hist[HIST_BIN_SIZE];
 	uint32 *txc_hist[HIST_BIN_SIZE];
 	uint32 *rxc_hist[HIST_BIN_SIZE];
+#if defined(DHD_LB_RXP_FLOW)
+	/* Same as napi_rx_hist, for the per-flow NAPI contexts */
+	uint32 *rx_flow_hist[HIST_BIN_SIZE];
+#endif /* DHD_LB_RXP_FLOW */
 #endif /* DHD_LB */
 #if defined(DNGL_AXI_ERROR_LOGGING) && defined(DHD_USE_WQ_FOR_DNGL_AXI_ERROR)
 	struct work_struct	  axi_error_dispatcher_work;
@@ -389,9 +426,18 @@ void dhd_lb_tx_handler(unsigned long data);
 
 #if defined(DHD_LB_RXP)
 int dhd_napi_poll(struct napi_struct *napi, int budget);
+#ifdef DHD_LB_BUSY_POLL
+int dhd_lb_busy_poll(dhd_info_t *dhd, struct napi_struct *napi);
+#endif /* DHD_LB_BUSY_POLL */
 void dhd_rx_napi_dispatcher_fn(struct work_struct * work);
 void dhd_lb_rx_napi_dispatch(dhd_pub_t *dhdp);
 void dhd_lb_rx_pkt_enqueue(dhd_pub_t *dhdp, void *pkt, int ifidx);
+#if defined(DHD_LB_RXP_FLOW)
+void dhd_lb_rx_flow_init(dhd_info_t *dhd);
+void dhd_lb_rx_flow_napi_add(dhd_info_t *dhd, struct net_device *net, int weight);
+void dhd_lb_rx_flow_napi_del(dhd_info_t *dhd);
+void dhd_lb_rx_flow_cancel(dhd_info_t *dhd);
+#endif /* DHD_LB_RXP_FLOW */
 #endif /* DHD_LB_RXP */
 
 void dhd_lb_set_default_cpus(dhd_info_t *dhd);
@@ -437,12 +437,54 @@ typedef struct msgbuf_ring {
  */
 int h2d_max_txpost = H2DRING_TXPOST_MAX_ITEM;
 
+#ifdef DHD_DMA_POOL
+/*
+ * Buffers that are DMA mapped once and then recycled, so that the data path
+ * does not go through the PCIe SysMMU for every packet. Rx buffers are
+ * posted from the pool and their content is copied into a fresh skb on
+ * completion; tx frames up to DHD_TX_COPYBREAK bytes are copied into a pool
+ * buffer instead of mapping the skb. Packets that find the pool empty take
+ * the regular map/unmap path.
+ */
+#ifndef DHD_DMA_POOL_RX_ITEMS
+#define DHD_DMA_POOL_RX_ITEMS	512
+#endif /* DHD_DMA_POOL_RX_ITEMS */
+#ifndef DHD_DMA_POOL_TX_ITEMS
+#define DHD_DMA_POOL_TX_ITEMS	256
+#endif /* DHD_DMA_POOL_TX_ITEMS */
+#ifndef DHD_TX_COPYBREAK
+#define DHD_TX_COPYBREAK	256
+#endif /* DHD_TX_COPYBREAK */
+
+typedef struct dhd_dma_pool_buf {
+	struct dhd_dma_pool_buf *next;
+	void		*va;
+	dmaaddr_t	pa;
+} dhd_dma_pool_buf_t;
+
+typedef struct dhd_dma_pool {
+	dhd_dma_pool_buf_t *bufs;	/* all buffers, tells them apart from packets */
+	dhd_dma_pool_buf_t *free;
+	void		*lock;
+	uint16		nitems;
+	uint16		buf_sz;
+	uint8		dir;
+	uint32		hits;		/* packets that used a pool buffer */
+	uint32		misses;		/* packets that found the pool empty */
+} dhd_dma_pool_t;
+
+#define DHD_DMA_POOL_OWNS(pool, ptr) \
+	((pool)->nitems && (dhd_dma_pool_buf_t *)(ptr) >= (pool)->bufs && \
+	 (dhd_dma_pool_buf_t *)(ptr) < (pool)->bufs + (pool)->nitems)
+#endif /* DHD_DMA_POOL */
+
 /** DHD protocol handle. Is an opaque type to other DHD software layers. */
 typedef struct dhd_prot {
 	osl_t *osh;		/* OSL handle */
 	uint16 rxbufpost_sz;
 	uint16 rxbufpost;
 	uint16 max_rxbufpost;
+	uint16 rxbufpost_thresh; /* refill once this many rx buffers are consumed */
 	uint16 max_eventbufpost;
 	uint16 max_ioctlrespbufpost;
 	uint16 max_tsbufpost;
@@ -515,6 +557,10 @@ typedef struct dhd_prot {
 	void		*pktid_ctrl_map; /* a pktid maps to a packet and its metadata */
 	void		*pktid_rx_map;	/* pktid map for rx path */
 	void		*pktid_tx_map;	/* pktid map for tx path */
+#ifdef DHD_DMA_POOL
+	dhd_dma_pool_t	rx_pool;	/* premapped rx post buffers */
+	dhd_dma_pool_t	tx_pool;	/* premapped buffers for small tx frames */
+#endif /* DHD_DMA_POOL */
 	bool		metadata_dbg;
 	void		*pktid_map_handle_ioctl;
 #ifdef DHD_MAP_PKTID_LOGGING
@@ -626,6 +672,7 @@ static uint8* dhd_prot_get_read_addr(dhd_pub_t *dhd, msgbuf_ring_t *ring,
 /* Producer (WR index update) or Consumer (RD index update) indication */
 static void dhd_prot_ring_write_complete(dhd_pub_t *dhd, msgbuf_ring_t *ring,
 	void *p, uint16 len);
+static void dhd_prot_ring_doorbell(dhd_pub_t *dhd, msgbuf_ring_t *ring);
 static void dhd_prot_upd_read_idx(dhd_pub_t *dhd, msgbuf_ring_t *ring);
 
 static INLINE int dhd_prot_dma_indx_alloc(dhd_pub_t *dhd, uint8 type,
@@ -791,6 +838,145 @@ static void BCMFASTPATH dhd_rxchain_commit(dhd_pub_t *dhd);
 
 static void dhd_prot_h2d_sync_init(dhd_pub_t *dhd);
 
+#ifdef DHD_DMA_POOL
+static void
+dhd_dma_pool_fini(dhd_pub_t *dhd, dhd_dma_pool_t *pool)
+{
+	dhd_dma_pool_buf_t *buf;
+	uint16 i;
+
+	if (!pool->bufs)
+		return;
+
+	for (i = 0; i < pool->nitems; i++) {
+		buf = &pool->bufs[i];
+		if (!buf->va)
+			continue;
+		DMA_UNMAP(dhd->osh, buf->pa, pool->buf_sz, pool->dir, 0, DHD_DMAH_NULL);
+		MFREE(dhd->osh, buf->va, pool->buf_sz);
+	}
+
+	dhd_os_spin_lock_deinit(dhd->osh, pool->lock);
+	MFREE(dhd->osh, pool->bufs, sizeof(*pool->bufs) * pool->nitems);
+	memset(pool, 0, sizeof(*pool));
+}
+
+/*
+ * Allocate and map @nitems buffers of @buf_sz bytes. A pool that already
+ * has the right geometry is kept, so this may be called on every
+ * dhd_sync_with_dongle(); all its buffers are back after dhd_prot_reset().
+ */
+static int
+dhd_dma_pool_init(dhd_pub_t *dhd, dhd_dma_pool_t *pool, uint16 nitems,
+	uint16 buf_sz, uint8 dir)
+{
+	dhd_dma_pool_buf_t *buf;
+	uint16 i;
+
+	if (SECURE_DMA_ENAB(dhd->osh))
+		return BCME_UNSUPPORTED;
+
+	if (pool->bufs) {
+		if (pool->buf_sz == buf_sz && pool->dir == dir)
+			return BCME_OK;
+		dhd_dma_pool_fini(dhd, pool);
+	}
+
+	pool->bufs = MALLOCZ(dhd->osh, sizeof(*pool->bufs) * nitems);
+	if (!pool->bufs)
+		return BCME_NOMEM;
+	pool->lock = dhd_os_spin_lock_init(dhd->osh);
+	pool->nitems = nitems;
+	pool->buf_sz = buf_sz;
+	pool->dir = dir;
+
+	for (i = 0; i < nitems; i++) {
+		buf = &pool->bufs[i];
+		buf->va = MALLOC(dhd->osh, buf_sz);
+		if (!buf->va)
+			goto fail;
+		buf->pa = DMA_MAP(dhd->osh, buf->va, buf_sz, dir, NULL, 0);
+		if (PHYSADDRISZERO(buf->pa)) {
+			MFREE(dhd->osh, buf->va, buf_sz);
+			buf->va = NULL;
+			goto fail;
+		}
+		buf->next = pool->free;
+		pool->free = buf;
+	}
+
+	DHD_ERROR(("%s: %u %s buffers of %u bytes\n", __FUNCTION__, nitems,
+		dir == DMA_RX ? "rx" : "tx", buf_sz));
+	return BCME_OK;
+
+fail:
+	DHD_ERROR(("%s: failed at buffer %u of %u\n", __FUNCTION__, i, nitems));
+	dhd_dma_pool_fini(dhd, pool);
+	return BCME_NOMEM;
+}
+
+static dhd_dma_pool_buf_t * BCMFASTPATH
+dhd_dma_pool_get(dhd_dma_pool_t *pool)
+{
+	dhd_dma_pool_buf_t *buf;
+	unsigned long flags;
+
+	if (!pool->nitems)
+		return NULL;
+
+	flags = dhd_os_spin_lock(pool->lock);
+	buf = pool->free;
+	if (buf) {
+		pool->free = buf->next;
+		pool->hits++;
+	} else {
+		pool->misses++;
+	}
+	dhd_os_spin_unlock(pool->lock, flags);
+
+	return buf;
+}
+
+static void BCMFASTPATH
+dhd_dma_pool_put(dhd_pub_t *dhd, dhd_dma_pool_t *pool, dhd_dma_pool_buf_t *buf)
+{
+	unsigned long flags;
+
+	/* drop whatever the CPU pulled into the cache before the next rx */
+	if (pool->dir == DMA_RX)
+		DMA_SYNC_FOR_DEVICE(dhd->osh, buf->pa, pool->buf_sz, DMA_RX);
+
+	flags = dhd_os_spin_lock(pool->lock);
+	buf->next = pool->free;
+	pool->free = buf;
+	dhd_os_spin_unlock(pool->lock, flags);
+}
+
+/* Give back the pool buffer a pktid locker points to as its dmah, if any */
+static bool BCMFASTPATH
+dhd_dma_pool_release(dhd_pub_t *dhd, void *dmah)
+{
+	dhd_prot_t *prot = dhd->prot;
+
+	if (DHD_DMA_POOL_OWNS(&prot->rx_pool, dmah)) {
+		dhd_dma_pool_put(dhd, &prot->rx_pool, dmah);
+		return TRUE;
+	}
+	if (DHD_DMA_POOL_OWNS(&prot->tx_pool, dmah)) {
+		dhd_dma_pool_put(dhd, &prot->tx_pool, dmah);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+#define DHD_DMA_POOL_RELEASE(dhd, dmah)	dhd_dma_pool_release((dhd), (dmah))
+#define DHD_DMA_POOL_RX_DMAH(prot, p) \
+	(DHD_DMA_POOL_OWNS(&(prot)->rx_pool, (p)) ? (p) : DHD_DMAH_NULL)
+#else
+#define DHD_DMA_POOL_RELEASE(dhd, dmah)	FALSE
+#define DHD_DMA_POOL_RX_DMAH(prot, p)	DHD_DMAH_NULL
+#endif /* DHD_DMA_POOL */
+
 bool
 dhd_prot_is_cmpl_ring_empty(dhd_pub_t *dhd, void *prot_info)
 {
@@ -2199,12 +2385,14 @@ dhd_pktid_map_reset(dhd_pub_t *dhd, dhd_pktid_map_handle_t *handle)
 					SECURE_DMA_UNMAP(osh, locker->pa,
 						locker->len, locker->dir, 0,
 						locker->dmah, locker->secdma, 0);
-				else
+				else if (!DHD_DMA_POOL_RELEASE(dhd, locker->dmah))
 					DMA_UNMAP(osh, locker->pa, locker->len,
 						locker->dir, 0, locker->dmah);
 			}
-			dhd_prot_packet_free(dhd, (ulong*)locker->pkt,
-				locker->pkttype, data_tx);
+			/* a posted rx pool buffer is its own dmah, there is no packet */
+			if (locker->pkt != locker->dmah)
+				dhd_prot_packet_free(dhd, (ulong*)locker->pkt,
+					locker->pkttype, data_tx);
 		}
 		else {
 #ifdef DHD_PKTID_AUDIT_RING
@@ -3227,6 +3415,12 @@ dhd_prot_init(dhd_pub_t *dhd)
 	}
 	DHD_ERROR(("%s:%d: MAX_RXBUFPOST = %d\n", __FUNCTION__, __LINE__, prot->max_rxbufpost));
 
+	/*
+	 * Refill only once half of the rx buffers are consumed, so that a refill
+	 * posts many bursts of RX_BUF_BURST behind a single doorbell.
+	 */
+	prot->rxbufpost_thresh = MAX(RXBUFPOST_THRESHOLD, prot->max_rxbufpost / 2);
+
 	/* Initialize.  bzero() would blow away the dma pointers. */
 	prot->max_eventbufpost = DHD_FLOWRING_MAX_EVENTBUF_POST;
 	prot->max_ioctlrespbufpost = DHD_FLOWRING_MAX_IOCTLRESPBUF_POST;
@@ -3512,6 +3706,11 @@ void dhd_prot_detach(dhd_pub_t *dhd)
 #ifdef IOCTLRESP_USE_CONSTMEM
 		DHD_NATIVE_TO_PKTID_FINI_IOCTL(dhd, prot->pktid_map_handle_ioctl);
 #endif // endif
+#ifdef DHD_DMA_POOL
+		/* after the pktid maps, which hand the outstanding buffers back */
+		dhd_dma_pool_fini(dhd, &prot->rx_pool);
+		dhd_dma_pool_fini(dhd, &prot->tx_pool);
+#endif /* DHD_DMA_POOL */
 #ifdef DHD_MAP_PKTID_LOGGING
 		DHD_PKTID_LOG_FINI(dhd, prot->pktid_dma_map);
 		DHD_PKTID_LOG_FINI(dhd, prot->pktid_dma_unmap);
@@ -3764,7 +3963,7 @@ dhd_lb_dispatch_rx_compl(dhd_pub_t *dhdp)
 {
 	dhd_prot_t *prot = dhdp->prot;
 	/* Schedule the takslet only if we have to */
-	if (prot->rxbufpost <= (prot->max_rxbufpost - RXBUFPOST_THRESHOLD)) {
+	if (prot->rxbufpost <= (prot->max_rxbufpost - prot->rxbufpost_thresh)) {
 		/* flush WR index */
 		bcm_workq_prod_sync(&dhdp->prot->rx_compl_prod);
 		dhd_lb_rx_compl_dispatch(dhdp); /* dispatch rx_compl_tasklet */
@@ -4215,6 +4414,17 @@ int dhd_sync_with_dongle(dhd_pub_t *dhd)
 		}
 	}
 
+#ifdef DHD_DMA_POOL
+	/* rx buffer size is known now, failing here only costs performance */
+	dhd_dma_pool_init(dhd, &prot->rx_pool, DHD_DMA_POOL_RX_ITEMS,
+		prot->rxbufpost_sz, DMA_RX);
+#ifndef DHD_LB_TXC
+	/* the tx completion tasklet unmaps through the pkttag, not the locker */
+	dhd_dma_pool_init(dhd, &prot->tx_pool, DHD_DMA_POOL_TX_ITEMS,
+		DHD_TX_COPYBREAK, DMA_TX);
+#endif /* DHD_LB_TXC */
+#endif /* DHD_DMA_POOL */
+
 	/* Post buffers for packet reception */
 	dhd_msgbuf_rxbuf_post(dhd, FALSE); /* alloc pkt ids */
 
@@ -4441,6 +4651,7 @@ dhd_msgbuf_rxbuf_post(dhd_pub_t *dhd, bool use_rsv_pktid)
 	int16 fillbufs;
 	uint16 cnt = 256;
 	int retcount = 0;
+	int posted = 0;
 
 	fillbufs = prot->max_rxbufpost - prot->rxbufpost;
 	while (fillbufs >= RX_BUF_BURST) {
@@ -4460,6 +4671,7 @@ dhd_msgbuf_rxbuf_post(dhd_pub_t *dhd, bool use_rsv_pktid)
 
 		if (retcount >= 0) {
 			prot->rxbufpost += (uint16)retcount;
+			posted += retcount;
 #ifdef DHD_LB_RXC
 			/* dhd_prot_rxbuf_post returns the number of buffers posted */
 			DHD_LB_STATS_UPDATE_RXC_HISTO(dhd, retcount);
@@ -4471,9 +4683,22 @@ dhd_msgbuf_rxbuf_post(dhd_pub_t *dhd, bool use_rsv_pktid)
 			fillbufs = 0;
 		}
 	}
+
+	/* one WR index update and doorbell for all the bursts posted above */
+	if (posted > 0) {
+		msgbuf_ring_t *ring = &prot->h2dring_rxp_subn;
+		unsigned long flags;
+
+		DHD_RING_LOCK(ring->ring_lock, flags);
+		dhd_prot_ring_doorbell(dhd, ring);
+		DHD_RING_UNLOCK(ring->ring_lock, flags);
+	}
 }
 
-/** Post 'count' no of rx buffers to dongle */
+/**
+ * Post 'count' no of rx buffers to dongle. The messages are flushed but the
+ * WR index is left to the caller to publish with dhd_prot_ring_doorbell().
+ */
 static int BCMFASTPATH
 dhd_prot_rxbuf_post(dhd_pub_t *dhd, uint16 count, bool use_rsv_pktid)
 {
@@ -4505,6 +4730,23 @@ dhd_prot_rxbuf_post(dhd_pub_t *dhd, uint16 count, bool use_rsv_pktid)
 	pktlen = (uint32 *)((uint8 *)pktbuf_pa + sizeof(dmaaddr_t) * RX_BUF_BURST);
 
 	for (i = 0; i < count; i++) {
+#ifdef DHD_DMA_POOL
+		dhd_dma_pool_buf_t *buf = dhd_dma_pool_get(&prot->rx_pool);
+
+		if (buf) {
+			/* posted as is, see dhd_prot_rxpool_copy() */
+			p = buf;
+			pa = buf->pa;
+#ifdef DMAMAP_STATS
+			dhd->dma_stats.rxdata++;
+			dhd->dma_stats.rxdata_sz += prot->rx_pool.buf_sz;
+#endif /* DMAMAP_STATS */
+			pktlen[i] = prot->rx_pool.buf_sz - prot->rx_metadata_offset;
+			pktbuf[i] = p;
+			pktbuf_pa[i] = pa;
+			continue;
+		}
+#endif /* DHD_DMA_POOL */
 		if ((p = PKTGET(dhd->osh, pktsz, FALSE)) == NULL) {
 			DHD_ERROR(("%s:%d: PKTGET for rxbuf failed\n", __FUNCTION__, __LINE__));
 			dhd->rx_pktgetfail++;
@@ -4581,7 +4823,8 @@ dhd_prot_rxbuf_post(dhd_pub_t *dhd, uint16 count, bool use_rsv_pktid)
 			/* Now populate the previous locker with valid information */
 			if (pktid != DHD_PKTID_INVALID) {
 				DHD_NATIVE_TO_PKTID_SAVE(dhd, dhd->prot->pktid_rx_map,
-					p, pktid, pa, pktlen[i], DMA_RX, NULL, NULL,
+					p, pktid, pa, pktlen[i], DMA_RX,
+					DHD_DMA_POOL_RX_DMAH(prot, p), NULL,
 					PKTTYPE_DATA_RX);
 			}
 		} else
@@ -4591,7 +4834,8 @@ dhd_prot_rxbuf_post(dhd_pub_t *dhd, uint16 count, bool use_rsv_pktid)
 alloc_pkt_id:
 #endif /* DHD_LB_RXC */
 		pktid = DHD_NATIVE_TO_PKTID(dhd, dhd->prot->pktid_rx_map, p, pa,
-			pktlen[i], DMA_RX, NULL, ring->dma_buf.secdma, PKTTYPE_DATA_RX);
+			pktlen[i], DMA_RX, DHD_DMA_POOL_RX_DMAH(prot, p),
+			ring->dma_buf.secdma, PKTTYPE_DATA_RX);
 #if defined(DHD_PCIE_PKTID)
 		if (pktid == DHD_PKTID_INVALID) {
 			break;
@@ -4649,9 +4893,9 @@ dhd_prot_rxbuf_post(dhd_pub_t *dhd, uint16 count, bool use_rsv_pktid)
 		alloced = i;
 	}
 
-	/* update ring's WR index and ring doorbell to dongle */
+	/* the WR index and doorbell are updated by the caller */
 	if (alloced > 0) {
-		dhd_prot_ring_write_complete(dhd, ring, msg_start, alloced);
+		OSL_CACHE_FLUSH(msg_start, ring->item_len * alloced);
 	}
 
 	DHD_RING_UNLOCK(ring->ring_lock, flags);
@@ -4661,6 +4905,8 @@ dhd_prot_rxbuf_post(dhd_pub_t *dhd, uint16 count, bool use_rsv_pktid)
 		p = pktbuf[i];
 		pa = pktbuf_pa[i];
 
+		if (DHD_DMA_POOL_RELEASE(dhd, DHD_DMA_POOL_RX_DMAH(prot, p)))
+			continue;
 		if (SECURE_DMA_ENAB(dhd->osh))
 			SECURE_DMA_UNMAP(dhd->osh, pa, pktlen[i], DMA_RX, 0,
 				DHD_DMAH_NULL, ring->dma_buf.secdma, 0);
@@ -4674,6 +4920,43 @@ dhd_prot_rxbuf_post(dhd_pub_t *dhd, uint16 count, bool use_rsv_pktid)
 	return alloced;
 } /* dhd_prot_rxbufpost */
 
+#ifdef DHD_DMA_POOL
+/*
+ * Copy a completed rx pool buffer into a new skb laid out like a posted one,
+ * i.e. with the rx metadata already pulled, and recycle the buffer.
+ */
+static void * BCMFASTPATH
+dhd_prot_rxpool_copy(dhd_pub_t *dhd, dhd_dma_pool_buf_t *buf, host_rxbuf_cmpl_t *msg)
+{
+	dhd_prot_t *prot = dhd->prot;
+	dhd_dma_pool_t *pool = &prot->rx_pool;
+	uint32 len;
+	void *pkt;
+
+	len = ltoh16(msg->data_offset) ? ltoh16(msg->data_offset) : prot->rx_dataoffset;
+	len += prot->rx_metadata_offset + ltoh16(msg->data_len);
+	if (len > pool->buf_sz) {
+		DHD_ERROR(("%s: bad rx length %u\n", __FUNCTION__, len));
+		dhd_dma_pool_put(dhd, pool, buf);
+		return NULL;
+	}
+
+	pkt = PKTGET(dhd->osh, pool->buf_sz, FALSE);
+	if (!pkt) {
+		dhd->rx_pktgetfail++;
+		dhd_dma_pool_put(dhd, pool, buf);
+		return NULL;
+	}
+
+	DMA_SYNC_FOR_CPU(dhd->osh, buf->pa, len, DMA_RX);
+	memcpy(PKTDATA(dhd->osh, pkt), buf->va, len);
+	dhd_dma_pool_put(dhd, pool, buf);
+
+	PKTPULL(dhd->osh, pkt, prot->rx_metadata_offset);
+	return pkt;
+}
+#endif /* DHD_DMA_POOL */
+
 static int
 dhd_prot_infobufpost(dhd_pub_t *dhd, msgbuf_ring_t *ring)
 {
@@ -5623,6 +5906,16 @@ dhd_prot_process_msgbuf_rxcpl(dhd_pub_t *dhd, uint bound, int ringtype)
 				continue;
 			}
 
+#ifdef DHD_DMA_POOL
+			if (DHD_DMA_POOL_OWNS(&prot->rx_pool, dmah)) {
+				pkt = dhd_prot_rxpool_copy(dhd, dmah, msg);
+				if (!pkt) {
+					msg_len -= item_len;
+					msg_addr += item_len;
+					continue;
+				}
+			} else
+#endif /* DHD_DMA_POOL */
 			if (SECURE_DMA_ENAB(dhd->osh))
 				SECURE_DMA_UNMAP(dhd->osh, pa, (uint) len, DMA_RX, 0,
 				    dmah, secdma, 0);
@@ -6414,7 +6707,7 @@ dhd_prot_txstatus_process(dhd_pub_t *dhd, void *msg)
 		SECURE_DMA_UNMAP(dhd->osh, (uint) pa,
 			(uint) dhd->prot->tx_metadata_offset, DMA_RX, 0, dmah,
 			secdma, offset);
-	} else {
+	} else if (!DHD_DMA_POOL_RELEASE(dhd, dmah)) {
 		DMA_UNMAP(dhd->osh, pa, (uint) len, DMA_RX, 0, dmah);
 	}
 
@@ -6680,6 +6973,7 @@ dhd_prot_txdata(dhd_pub_t *dhd, void *PKTBUF, uint8 ifidx)
 	msgbuf_ring_t *ring;
 	flow_ring_table_t *flow_ring_table;
 	flow_ring_node_t *flow_ring_node;
+	void *txdmah = DHD_DMAH_NULL;
 #ifdef DHD_PKT_LOGGING
 	uint32 pkthash;
 #endif /* DHD_PKT_LOGGING */
@@ -6754,6 +7048,17 @@ dhd_prot_txdata(dhd_pub_t *dhd, void *PKTBUF, uint8 ifidx)
 	pktlen -= ETHER_HDR_LEN;
 
 	/* Map the data pointer to a DMA-able address */
+#ifdef DHD_DMA_POOL
+	if (pktlen <= prot->tx_pool.buf_sz && !prot->tx_metadata_offset &&
+		(txdmah = dhd_dma_pool_get(&prot->tx_pool)) != NULL) {
+		dhd_dma_pool_buf_t *buf = txdmah;
+
+		/* small frame, copy it to a premapped buffer */
+		memcpy(buf->va, PKTDATA(dhd->osh, PKTBUF), pktlen);
+		DMA_SYNC_FOR_DEVICE(dhd->osh, buf->pa, pktlen, DMA_TX);
+		pa = buf->pa;
+	} else
+#endif /* DHD_DMA_POOL */
 	if (SECURE_DMA_ENAB(dhd->osh)) {
 		int offset = 0;
 		BCM_REFERENCE(offset);
@@ -6782,7 +7087,7 @@ dhd_prot_txdata(dhd_pub_t *dhd, void *PKTBUF, uint8 ifidx)
 #endif /* DMAMAP_STATS */
 	/* No need to lock. Save the rest of the packet's metadata */
 	DHD_NATIVE_TO_PKTID_SAVE(dhd, dhd->prot->pktid_tx_map, PKTBUF, pktid,
-	    pa, pktlen, DMA_TX, NULL, ring->dma_buf.secdma, PKTTYPE_DATA_TX);
+	    pa, pktlen, DMA_TX, txdmah, ring->dma_buf.secdma, PKTTYPE_DATA_TX);
 
 #ifdef TXP_FLUSH_NITEMS
 	if (ring->pend_items_count == 0)
@@ -6964,6 +7269,10 @@ dhd_prot_txdata(dhd_pub_t *dhd, void *PKTBUF, uint8 ifidx)
 		/* Free up the PKTID. physaddr and pktlen will be garbage. */
 		DHD_PKTID_TO_NATIVE(dhd, dhd->prot->pktid_tx_map, pktid,
 			pa, pktlen, dmah, secdma, PKTTYPE_NO_CHECK);
+#ifdef DHD_DMA_POOL
+		if (txdmah)
+			dhd_dma_pool_release(dhd, txdmah);
+#endif /* DHD_DMA_POOL */
 	}
 
 err_no_res_pktfree:
@@ -7054,7 +7363,7 @@ dhd_prot_return_rxbuf(dhd_pub_t *dhd, uint32 pktid, uint32 rxcnt)
 	}
 
 #if !defined(DHD_LB_RXC)
-	if (prot->rxbufpost <= (prot->max_rxbufpost - RXBUFPOST_THRESHOLD))
+	if (prot->rxbufpost <= (prot->max_rxbufpost - prot->rxbufpost_thresh))
 		dhd_msgbuf_rxbuf_post(dhd, FALSE); /* alloc pkt ids */
 #endif /* !DHD_LB_RXC */
 	return;
@@ -8648,17 +8957,13 @@ dhd_prot_get_ring_space(msgbuf_ring_t *ring, uint16 nitems, uint16 * alloced,
  * always hold appropriate locks.
  */
 static void BCMFASTPATH
-__dhd_prot_ring_write_complete(dhd_pub_t *dhd, msgbuf_ring_t * ring, void* p,
-	uint16 nitems)
+__dhd_prot_ring_doorbell(dhd_pub_t *dhd, msgbuf_ring_t * ring)
 {
 	dhd_prot_t *prot = dhd->prot;
 	uint32 db_index;
 	uint16 max_flowrings = dhd->bus->max_tx_flowrings;
 	uint corerev;
 
-	/* cache flush */
-	OSL_CACHE_FLUSH(p, ring->item_len * nitems);
-
 	/* For HWA, update db_index and ring mb2 DB and return */
 	if (HWA_ACTIVE(dhd) && ring->hwa_db_type) {
 		db_index = HWA_DB_INDEX_VALUE(ring->wr) | ring->hwa_db_type;
@@ -8697,6 +9002,16 @@ __dhd_prot_ring_write_complete(dhd_pub_t *dhd, msgbuf_ring_t * ring, void* p,
 	}
 }
 
+static void BCMFASTPATH
+__dhd_prot_ring_write_complete(dhd_pub_t *dhd, msgbuf_ring_t * ring, void* p,
+	uint16 nitems)
+{
+	/* cache flush */
+	OSL_CACHE_FLUSH(p, ring->item_len * nitems);
+
+	__dhd_prot_ring_doorbell(dhd, ring);
+}
+
 static void BCMFASTPATH
 dhd_prot_ring_write_complete(dhd_pub_t *dhd, msgbuf_ring_t * ring, void* p,
 	uint16 nitems)
@@ -8707,6 +9022,19 @@ dhd_prot_ring_write_complete(dhd_pub_t *dhd, msgbuf_ring_t * ring, void* p,
 	DHD_BUS_UNLOCK(dhd->bus->bus_lock, flags_bus);
 }
 
+/**
+ * dhd_prot_ring_doorbell - publish the WR index of messages that were already
+ * flushed, see dhd_prot_rxbuf_post(). Callers hold the ring lock.
+ */
+static void BCMFASTPATH
+dhd_prot_ring_doorbell(dhd_pub_t *dhd, msgbuf_ring_t * ring)
+{
+	unsigned long flags_bus;
+	DHD_BUS_LOCK(dhd->bus->bus_lock, flags_bus);
+	__dhd_prot_ring_doorbell(dhd, ring);
+	DHD_BUS_UNLOCK(dhd->bus->bus_lock, flags_bus);
+}
+
 /**
  * dhd_prot_ring_write_complete_mbdata - will be called from dhd_prot_h2d_mbdata_send_ctrlmsg,
  * which will hold DHD_BUS_LOCK to update WR pointer, Ring DB and also update bus_low_power_state
@@ -9636,6 +9964,12 @@ void dhd_prot_print_info(dhd_pub_t *dhd, struct bcmstrbuf *strbuf)
 		DHD_PKTID_AVAIL(dhd->prot->pktid_ctrl_map),
 		DHD_PKTID_AVAIL(dhd->prot->pktid_rx_map),
 		DHD_PKTID_AVAIL(dhd->prot->pktid_tx_map));
+#ifdef DHD_DMA_POOL
+	bcm_bprintf(strbuf, "dma_pool(rx/tx) items %u %u hits %u %u misses %u %u\n",
+		dhd->prot->rx_pool.nitems, dhd->prot->tx_pool.nitems,
+		dhd->prot->rx_pool.hits, dhd->prot->tx_pool.hits,
+		dhd->prot->rx_pool.misses, dhd->prot->tx_pool.misses);
+#endif /* DHD_DMA_POOL */
 
 }
 
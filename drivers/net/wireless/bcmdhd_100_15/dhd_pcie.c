@@ -7985,6 +7985,48 @@ dhd_bus_dpc(struct dhd_bus *bus)
 
 }
 
+#ifdef DHD_LB_BUSY_POLL
+/*
+ * Process up to @bound RX completions on behalf of a busy polling socket,
+ * without waiting for the D2H interrupt. The caller holds the dpc tasklet,
+ * so that the ring is not read from two contexts. Returns TRUE if there are
+ * more completions left.
+ */
+bool
+dhd_bus_rx_busy_poll(struct dhd_bus *bus, uint bound)
+{
+	unsigned long flags;
+	bool more = FALSE;
+
+	DHD_GENERAL_LOCK(bus->dhd, flags);
+	if (bus->dhd->busstate != DHD_BUS_DATA ||
+		DHD_BUS_CHECK_SUSPEND_OR_SUSPEND_IN_PROGRESS(bus->dhd)) {
+		DHD_GENERAL_UNLOCK(bus->dhd, flags);
+		return FALSE;
+	}
+	DHD_BUS_BUSY_SET_IN_DPC(bus->dhd);
+	DHD_GENERAL_UNLOCK(bus->dhd, flags);
+
+	DHD_BUS_LOCK(bus->bus_lock, flags);
+	if (bus->bus_low_power_state != DHD_BUS_NO_LOW_POWER_STATE ||
+		bus->is_linkdown) {
+		DHD_BUS_UNLOCK(bus->bus_lock, flags);
+		goto done;
+	}
+	DHD_BUS_UNLOCK(bus->bus_lock, flags);
+
+	more = dhd_prot_process_msgbuf_rxcpl(bus->dhd, bound, DHD_REGULAR_RING);
+
+done:
+	DHD_GENERAL_LOCK(bus->dhd, flags);
+	DHD_BUS_BUSY_CLEAR_IN_DPC(bus->dhd);
+	dhd_os_busbusy_wake(bus->dhd);
+	DHD_GENERAL_UNLOCK(bus->dhd, flags);
+
+	return more;
+}
+#endif /* DHD_LB_BUSY_POLL */
+
 int
 dhdpcie_send_mb_data(dhd_bus_t *bus, uint32 h2d_mb_data)
 {
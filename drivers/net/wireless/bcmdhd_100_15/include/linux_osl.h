@@ -220,6 +220,13 @@ extern dmaaddr_t osl_dma_map(osl_t *osh, void *va, uint size, int direction, voi
 	hnddma_seg_map_t *txp_dmah);
 extern void osl_dma_unmap(osl_t *osh, dmaaddr_t pa, uint size, int direction);
 
+/* hand a buffer that stays mapped back and forth between CPU and device */
+#define	DMA_SYNC_FOR_CPU(osh, pa, size, direction) \
+	osl_dma_sync((osh), (pa), (size), (direction), TRUE)
+#define	DMA_SYNC_FOR_DEVICE(osh, pa, size, direction) \
+	osl_dma_sync((osh), (pa), (size), (direction), FALSE)
+extern void osl_dma_sync(osl_t *osh, dmaaddr_t pa, uint size, int direction, bool for_cpu);
+
 #ifndef PHYS_TO_VIRT
 #define	PHYS_TO_VIRT(pa)	osl_phys_to_virt(pa)
 #endif // endif
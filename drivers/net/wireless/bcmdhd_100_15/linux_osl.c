@@ -1099,6 +1099,35 @@ osl_dma_unmap(osl_t *osh, dmaaddr_t pa, uint size, int direction)
 	DMA_UNLOCK(osh);
 }
 
+void BCMFASTPATH
+osl_dma_sync(osl_t *osh, dmaaddr_t pa, uint size, int direction, bool for_cpu)
+{
+	int dir;
+	dma_addr_t paddr;
+
+	ASSERT((osh && (osh->magic == OS_HANDLE_MAGIC)));
+
+	dir = (direction == DMA_TX)? PCI_DMA_TODEVICE: PCI_DMA_FROMDEVICE;
+
+#ifdef BCMDMA64OSL
+	PHYSADDRTOULONG(pa, paddr);
+#else
+	paddr = (dma_addr_t)pa;
+#endif /* BCMDMA64OSL */
+
+#ifdef STB_SOC_WIFI
+	if (for_cpu)
+		dma_sync_single_for_cpu(osh->pdev, paddr, size, dir);
+	else
+		dma_sync_single_for_device(osh->pdev, paddr, size, dir);
+#else /* STB_SOC_WIFI */
+	if (for_cpu)
+		pci_dma_sync_single_for_cpu(osh->pdev, paddr, size, dir);
+	else
+		pci_dma_sync_single_for_device(osh->pdev, paddr, size, dir);
+#endif /* STB_SOC_WIFI */
+}
+
 /* OSL function for CPU relax */
 inline void BCMFASTPATH
 osl_cpu_relax(void)
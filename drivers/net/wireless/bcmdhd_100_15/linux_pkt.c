@@ -308,6 +308,15 @@ linux_pktfree(osl_t *osh, void *p, bool send)
 		bcm_object_trace_opr(skb, BCM_OBJDBG_REMOVE, caller, line);
 #endif /* BCM_OBJECT_TRACE */
 
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(4, 6, 0))
+		/* TX completions from the DPC or the load balancing tasklets hand
+		 * their heads to the per-cpu NAPI cache, which frees them in bulk
+		 * and feeds the next RX allocations from it
+		 */
+		if (send && in_serving_softirq() && !in_irq())
+			napi_consume_skb(skb, 1);
+		else
+#endif /* LINUX_VERSION_CODE >= KERNEL_VERSION(4, 6, 0) */
 		{
 			if (skb->destructor) {
 				/* cannot kfree_skb() on hard IRQ (net/core/skbuff.c) if
@@ -13,6 +13,22 @@
 
 #include "ufs-exynos-fmp.h"
 
+#ifdef CONFIG_SCSI_UFS_EXYNOS_FMP_CACHE
+/* transfer request slots the HCI can have */
+#define EXYNOS_UFS_FMP_CACHE_TAGS	32
+
+/*
+ * The setting built for the first PRDT entry of a request. Entries of
+ * the same request that come from the same mapping only differ in the
+ * IV sector, so they reuse it instead of re-deriving the key.
+ */
+struct exynos_ufs_fmp_cache {
+	bool valid;
+	struct address_space *mapping;
+	struct fmp_data_setting data;
+};
+#endif
+
 static int check_data_equal(void *data1, void *data2)
 {
 	return data1 == data2;
@@ -273,6 +289,13 @@ int exynos_ufs_fmp_host_set_device(struct platform_device *host_pdev,
 	}
 
 	ufs = dev_get_platdata(&host_pdev->dev);
+#ifdef CONFIG_SCSI_UFS_EXYNOS_FMP_CACHE
+	if (!ufs->fmp.cache)
+		ufs->fmp.cache = devm_kcalloc(&host_pdev->dev,
+					EXYNOS_UFS_FMP_CACHE_TAGS,
+					sizeof(struct exynos_ufs_fmp_cache),
+					GFP_KERNEL);
+#endif
 	ufs->fmp.pdev = pdev;
 	ufs->fmp.vops = fmp_vops;
 
@@ -310,6 +333,97 @@ static inline void exynos_ufs_fmp_bypass(void *desc)
 	SET_FAS((struct fmp_table_setting *)desc, 0);
 }
 
+#ifdef CONFIG_SCSI_UFS_EXYNOS_FMP_CACHE
+static struct exynos_ufs_fmp_cache *exynos_ufs_fmp_get_cache(
+				struct exynos_ufs *ufs,
+				struct ufshcd_lrb *lrbp)
+{
+	if (!ufs->fmp.cache || lrbp->task_tag >= EXYNOS_UFS_FMP_CACHE_TAGS)
+		return NULL;
+
+	return &ufs->fmp.cache[lrbp->task_tag];
+}
+
+/*
+ * Reuse the setting of the previous PRDT entry of this request if it was
+ * built for the same mapping, advancing the IV to this entry's sector.
+ */
+static struct fmp_data_setting *exynos_ufs_fmp_cached(
+				struct exynos_ufs_fmp_cache *cache,
+				struct scsi_cmnd *cmd, struct page *page,
+				uint32_t index, int sector_offset)
+{
+	struct bio *bio = cmd->request->bio;
+	sector_t sector;
+
+	if (!cache)
+		return NULL;
+
+	if (!index || !cache->valid || cache->mapping != page->mapping ||
+			!bio || !virt_addr_valid(bio)) {
+		cache->valid = false;
+		return NULL;
+	}
+
+	sector = bio->bi_iter.bi_sector + (sector_t)sector_offset;
+	if (cache->data.disk.algo_mode != EXYNOS_FMP_BYPASS_MODE)
+		cache->data.disk.sector = sector;
+	if (cache->data.file.algo_mode != EXYNOS_FMP_BYPASS_MODE)
+		cache->data.file.sector = sector;
+
+	return &cache->data;
+}
+
+/* where to build the setting of the first entry of a request */
+static struct fmp_data_setting *exynos_ufs_fmp_slot(
+				struct exynos_ufs_fmp_cache *cache,
+				struct fmp_data_setting *local)
+{
+	return cache ? &cache->data : local;
+}
+
+static void exynos_ufs_fmp_cache_set(struct exynos_ufs_fmp_cache *cache,
+				struct address_space *mapping)
+{
+	if (cache) {
+		cache->mapping = mapping;
+		cache->valid = true;
+	}
+}
+
+static void exynos_ufs_fmp_cache_clear(struct exynos_ufs_fmp_cache *cache)
+{
+	if (cache)
+		cache->valid = false;
+}
+#else
+static inline struct exynos_ufs_fmp_cache *exynos_ufs_fmp_get_cache(
+				struct exynos_ufs *ufs,
+				struct ufshcd_lrb *lrbp)
+{
+	return NULL;
+}
+
+static inline struct fmp_data_setting *exynos_ufs_fmp_cached(
+				struct exynos_ufs_fmp_cache *cache,
+				struct scsi_cmnd *cmd, struct page *page,
+				uint32_t index, int sector_offset)
+{
+	return NULL;
+}
+
+static inline struct fmp_data_setting *exynos_ufs_fmp_slot(
+				struct exynos_ufs_fmp_cache *cache,
+				struct fmp_data_setting *local)
+{
+	return local;
+}
+
+static inline void exynos_ufs_fmp_cache_set(struct exynos_ufs_fmp_cache *cache,
+				struct address_space *mapping) {}
+static inline void exynos_ufs_fmp_cache_clear(struct exynos_ufs_fmp_cache *cache) {}
+#endif
+
 int exynos_ufs_fmp_cfg(struct ufs_hba *hba,
 				struct ufshcd_lrb *lrbp,
 				struct scatterlist *sg,
@@ -317,7 +431,8 @@ int exynos_ufs_fmp_cfg(struct ufs_hba *hba,
 				int sector_offset)
 {
 	int ret;
-	struct fmp_data_setting data;
+	struct fmp_data_setting local, *data = &local;
+	struct exynos_ufs_fmp_cache *cache;
 	struct scsi_cmnd *cmd;
 	struct page *page;
 	struct exynos_ufs *ufs = dev_get_platdata(hba->dev);
@@ -336,32 +451,42 @@ int exynos_ufs_fmp_cfg(struct ufs_hba *hba,
 		return 0;
 	}
 
+	cache = exynos_ufs_fmp_get_cache(ufs, lrbp);
+
 	ret = is_ufs_fmp_test_enabled(cmd, ufs->fmp.pdev);
-	if (ret == TRUE)
+	if (ret == TRUE) {
+		exynos_ufs_fmp_cache_clear(cache);
 		goto out_test;
+	}
+
+	data = exynos_ufs_fmp_cached(cache, cmd, page, index, sector_offset);
+	if (data)
+		goto out_test;
+
+	data = exynos_ufs_fmp_slot(cache, &local);
 
-	ret = exynos_ufs_fmp_disk_cfg(cmd, &data.disk, sector_offset);
+	ret = exynos_ufs_fmp_disk_cfg(cmd, &data->disk, sector_offset);
 	if (ret) {
 		pr_err("%s: Fail to configure FMP Disk Encryption. ret(%d)\n",
 				__func__, ret);
 		return -EINVAL;
 	}
 
-	if (data.disk.algo_mode != EXYNOS_FMP_BYPASS_MODE)
+	if (data->disk.algo_mode != EXYNOS_FMP_BYPASS_MODE)
 		goto file_cfg;
 
-	ret = exynos_ufs_fmp_direct_io_cfg(cmd, &data.file, sector_offset);
+	ret = exynos_ufs_fmp_direct_io_cfg(cmd, &data->file, sector_offset);
 	if (ret) {
 		pr_err("%s: Fail to configure FMP direct IO Encryption. ret(%d)\n",
 				__func__, ret);
 		return -EINVAL;
 	}
 
-	if (data.file.algo_mode != EXYNOS_FMP_BYPASS_MODE)
+	if (data->file.algo_mode != EXYNOS_FMP_BYPASS_MODE)
 		goto out;
 
 file_cfg:
-	ret = exynos_ufs_fmp_file_cfg(cmd, page, &data.file, sector_offset);
+	ret = exynos_ufs_fmp_file_cfg(cmd, page, &data->file, sector_offset);
 	if (ret) {
 		pr_err("%s: Fail to configure FMP File Encryption. ret(%d)\n",
 				__func__, ret);
@@ -369,11 +494,12 @@ int exynos_ufs_fmp_cfg(struct ufs_hba *hba,
 	}
 
 out:
-	data.mapping = page->mapping;
+	data->mapping = page->mapping;
+	exynos_ufs_fmp_cache_set(cache, page->mapping);
 out_test:
-	data.table = (struct fmp_table_setting *)&lrbp->ucd_prdt_ptr[index];
-	data.cmdq_enabled = 0;
-	return ufs->fmp.vops->config(ufs->fmp.pdev, &data);
+	data->table = (struct fmp_table_setting *)&lrbp->ucd_prdt_ptr[index];
+	data->cmdq_enabled = 0;
+	return ufs->fmp.vops->config(ufs->fmp.pdev, data);
 }
 EXPORT_SYMBOL(exynos_ufs_fmp_cfg);
 
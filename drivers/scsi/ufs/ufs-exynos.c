@@ -555,7 +555,8 @@ static void exynos_ufs_set_features(struct ufs_hba *hba, u32 hw_rev)
 	/* caps */
 	hba->caps = UFSHCD_CAP_CLK_GATING |
 			UFSHCD_CAP_HIBERN8_WITH_CLK_GATING |
-			UFSHCD_CAP_INTR_AGGR;
+			UFSHCD_CAP_INTR_AGGR |
+			UFSHCD_CAP_SAME_CPU_COMPLETION;
 
 	/* quirks of common driver */
 	hba->quirks = UFSHCD_QUIRK_PRDT_BYTE_GRAN |
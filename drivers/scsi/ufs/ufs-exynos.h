@@ -529,9 +529,13 @@ struct exynos_smu_data {
 	struct platform_device *pdev;
 };
 
+struct exynos_ufs_fmp_cache;
+
 struct exynos_fmp_data {
 	struct exynos_fmp_variant_ops *vops;
 	struct platform_device *pdev;
+	/* crypto setting of the current request, per tag */
+	struct exynos_ufs_fmp_cache *cache;
 };
 
 struct exynos_ufs {
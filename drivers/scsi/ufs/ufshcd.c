@@ -1064,6 +1064,88 @@ static void ufshcd_ungate_work(struct work_struct *work)
 	scsi_unblock_requests(hba->host);
 }
 
+#if defined(CONFIG_SCSI_UFS_ADAPTIVE_GATING)
+#define UFS_IDLE_HIST_UPDATE	16
+#define UFS_IDLE_HIST_DECAY	1024
+#define UFS_GATING_EXIT_COST_US	5000
+
+/* representative idle period of a histogram bucket */
+static unsigned int ufshcd_idle_bucket_us(int i)
+{
+	return i ? 1500 << (i - 1) : 500;
+}
+
+/*
+ * Pick the gating delay, out of 1ms..1024ms in powers of two, with the
+ * lowest expected cost over the recorded idle periods. An idle period
+ * shorter than the delay costs its length in ungated time, a longer one
+ * costs the delay plus the hibern8 exit and clock ungating it will pay.
+ * Must be called with host lock held.
+ */
+static void ufshcd_gating_update_delay(struct ufs_hba *hba)
+{
+	struct ufs_clk_gating *gating = &hba->clk_gating;
+	u64 cost, best_cost = U64_MAX;
+	unsigned int delay_us, gap_us;
+	int i, j;
+
+	for (j = 0; j < UFS_IDLE_HIST_BUCKETS; j++) {
+		delay_us = 1000 << j;
+		cost = 0;
+		for (i = 0; i < UFS_IDLE_HIST_BUCKETS; i++) {
+			gap_us = ufshcd_idle_bucket_us(i);
+			if (gap_us <= delay_us)
+				cost += (u64)gating->idle_hist[i] * gap_us;
+			else
+				cost += (u64)gating->idle_hist[i] *
+					(delay_us + gating->exit_cost_us);
+		}
+		if (cost < best_cost) {
+			best_cost = cost;
+			gating->delay_ms = 1 << j;
+		}
+	}
+}
+
+/* host lock must be held */
+static void ufshcd_gating_idle_start(struct ufs_hba *hba)
+{
+	hba->clk_gating.idle_start = ktime_get();
+}
+
+/* host lock must be held */
+static void ufshcd_gating_idle_end(struct ufs_hba *hba)
+{
+	struct ufs_clk_gating *gating = &hba->clk_gating;
+	s64 idle_ms;
+	int i;
+
+	if (!ktime_to_ns(gating->idle_start))
+		return;
+
+	idle_ms = ktime_to_ms(ktime_sub(ktime_get(), gating->idle_start));
+	gating->idle_start = ktime_set(0, 0);
+
+	i = idle_ms > 0 ? fls(min_t(s64, idle_ms, INT_MAX)) : 0;
+	gating->idle_hist[min(i, UFS_IDLE_HIST_BUCKETS - 1)]++;
+
+	if (++gating->nr_samples % UFS_IDLE_HIST_UPDATE)
+		return;
+
+	if (gating->nr_samples >= UFS_IDLE_HIST_DECAY) {
+		for (i = 0; i < UFS_IDLE_HIST_BUCKETS; i++)
+			gating->idle_hist[i] >>= 1;
+		gating->nr_samples >>= 1;
+	}
+
+	if (gating->exit_cost_us)
+		ufshcd_gating_update_delay(hba);
+}
+#else
+static inline void ufshcd_gating_idle_start(struct ufs_hba *hba) {}
+static inline void ufshcd_gating_idle_end(struct ufs_hba *hba) {}
+#endif
+
 /**
  * ufshcd_hold - Enable clocks that were gated earlier due to ufshcd_release.
  * Also, exit from hibern8 mode and set the link as active.
@@ -1078,7 +1160,8 @@ int ufshcd_hold(struct ufs_hba *hba, bool async)
 	if (!ufshcd_is_clkgating_allowed(hba))
 		goto out;
 	spin_lock_irqsave(hba->host->host_lock, flags);
-	hba->clk_gating.active_reqs++;
+	if (++hba->clk_gating.active_reqs == 1)
+		ufshcd_gating_idle_end(hba);
 
 	if (ufshcd_eh_in_progress(hba)) {
 		spin_unlock_irqrestore(hba->host->host_lock, flags);
@@ -1246,6 +1329,7 @@ static void __ufshcd_release(struct ufs_hba *hba)
 		|| ufshcd_eh_in_progress(hba))
 		return;
 
+	ufshcd_gating_idle_start(hba);
 	hba->clk_gating.state = REQ_CLKS_OFF;
 	queue_delayed_work(hba->ufshcd_workq, &hba->clk_gating.gate_work,
 			msecs_to_jiffies(hba->clk_gating.delay_ms));
@@ -1284,6 +1368,92 @@ static ssize_t ufshcd_clkgate_delay_store(struct device *dev,
 	return count;
 }
 
+#if defined(CONFIG_SCSI_UFS_ADAPTIVE_GATING)
+static ssize_t ufshcd_clkgate_hist_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	u32 hist[UFS_IDLE_HIST_BUCKETS];
+	unsigned long flags;
+	ssize_t count = 0;
+	int i;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	memcpy(hist, hba->clk_gating.idle_hist, sizeof(hist));
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	for (i = 0; i < UFS_IDLE_HIST_BUCKETS; i++) {
+		if (!i)
+			count += snprintf(buf + count, PAGE_SIZE - count,
+					  "<1ms: %u\n", hist[i]);
+		else if (i == UFS_IDLE_HIST_BUCKETS - 1)
+			count += snprintf(buf + count, PAGE_SIZE - count,
+					  ">=%ums: %u\n", 1 << (i - 1), hist[i]);
+		else
+			count += snprintf(buf + count, PAGE_SIZE - count,
+					  "%u-%ums: %u\n", 1 << (i - 1),
+					  1 << i, hist[i]);
+	}
+
+	return count;
+}
+
+static ssize_t ufshcd_clkgate_exit_cost_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n", hba->clk_gating.exit_cost_us);
+}
+
+static ssize_t ufshcd_clkgate_exit_cost_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	unsigned long flags;
+	unsigned int value;
+
+	if (kstrtouint(buf, 0, &value))
+		return -EINVAL;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	hba->clk_gating.exit_cost_us = value;
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+	return count;
+}
+
+static void ufshcd_init_adaptive_gating(struct ufs_hba *hba)
+{
+	struct ufs_clk_gating *gating = &hba->clk_gating;
+
+	gating->exit_cost_us = UFS_GATING_EXIT_COST_US;
+
+	gating->hist_attr.show = ufshcd_clkgate_hist_show;
+	sysfs_attr_init(&gating->hist_attr.attr);
+	gating->hist_attr.attr.name = "clkgate_idle_hist";
+	gating->hist_attr.attr.mode = S_IRUGO;
+	if (device_create_file(hba->dev, &gating->hist_attr))
+		dev_err(hba->dev, "Failed to create sysfs for clkgate_idle_hist\n");
+
+	gating->exit_cost_attr.show = ufshcd_clkgate_exit_cost_show;
+	gating->exit_cost_attr.store = ufshcd_clkgate_exit_cost_store;
+	sysfs_attr_init(&gating->exit_cost_attr.attr);
+	gating->exit_cost_attr.attr.name = "clkgate_exit_cost_us";
+	gating->exit_cost_attr.attr.mode = S_IRUGO | S_IWUSR;
+	if (device_create_file(hba->dev, &gating->exit_cost_attr))
+		dev_err(hba->dev, "Failed to create sysfs for clkgate_exit_cost\n");
+}
+
+static void ufshcd_exit_adaptive_gating(struct ufs_hba *hba)
+{
+	device_remove_file(hba->dev, &hba->clk_gating.hist_attr);
+	device_remove_file(hba->dev, &hba->clk_gating.exit_cost_attr);
+}
+#else
+static inline void ufshcd_init_adaptive_gating(struct ufs_hba *hba) {}
+static inline void ufshcd_exit_adaptive_gating(struct ufs_hba *hba) {}
+#endif
+
 static int ufshcd_init_clk_gating(struct ufs_hba *hba)
 {
 	int ret = 0;
@@ -1309,6 +1479,7 @@ static int ufshcd_init_clk_gating(struct ufs_hba *hba)
 	if (device_create_file(hba->dev, &hba->clk_gating.delay_attr))
 		dev_err(hba->dev, "Failed to create sysfs for clkgate_delay\n");
 
+	ufshcd_init_adaptive_gating(hba);
 out:
 	return ret;
 }
@@ -1319,6 +1490,7 @@ static void ufshcd_exit_clk_gating(struct ufs_hba *hba)
 		return;
 	destroy_workqueue(hba->ufshcd_workq);
 	device_remove_file(hba->dev, &hba->clk_gating.delay_attr);
+	ufshcd_exit_adaptive_gating(hba);
 }
 
 #if defined(CONFIG_PM_DEVFREQ)
@@ -1435,6 +1607,10 @@ static inline void ufshcd_hba_capabilities(struct ufs_hba *hba)
 	hba->nutrs = (hba->capabilities & MASK_TRANSFER_REQUESTS_SLOTS) + 1;
 	hba->nutmrs =
 	((hba->capabilities & MASK_TASK_MANAGEMENT_REQUEST_SLOTS) >> 16) + 1;
+
+	hba->intr_aggr_cnt = min_t(int, hba->nutrs - 1,
+				   INT_AGGR_COUNTER_THLD_VAL(~0) >> 8);
+	hba->intr_aggr_tmout = INT_AGGR_DEF_TO;
 }
 
 /**
@@ -2014,6 +2190,8 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 
 	hba = shost_priv(host);
 
+	blk_rq_io_stamp(cmd->request, BLK_IO_QUEUECMD);
+
 	tag = cmd->request->tag;
 	if (!ufshcd_valid_tag(hba, tag)) {
 		dev_err(hba->dev,
@@ -2107,6 +2285,8 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 		ufshcd_release(hba);
 		goto out;
 	}
+	/* ufshcd_map_sg() also configures FMP through crypto_engine_cfg */
+	blk_rq_io_stamp(cmd->request, BLK_IO_CRYPT);
 
 	/* issue command to the controller */
 	spin_lock_irqsave(hba->host->host_lock, flags);
@@ -2116,6 +2296,7 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 	exynos_ufs_cmd_log_start(hba, cmd);
 #endif
 	ufshcd_send_command(hba, tag);
+	blk_rq_io_stamp(cmd->request, BLK_IO_DOORBELL);
 
 	if (hba->monitor.flag & UFSHCD_MONITOR_LEVEL1)
 		dev_info(hba->dev, "IO issued(%d)\n", tag);
@@ -4016,8 +4197,9 @@ static int ufshcd_make_hba_operational(struct ufs_hba *hba)
 	ufshcd_enable_intr(hba, UFSHCD_ENABLE_INTRS);
 
 	/* Configure interrupt aggregation */
-	if (ufshcd_is_intr_aggr_allowed(hba))
-		ufshcd_config_intr_aggr(hba, hba->nutrs - 1, INT_AGGR_DEF_TO);
+	if (ufshcd_is_intr_aggr_allowed(hba) && hba->intr_aggr_cnt)
+		ufshcd_config_intr_aggr(hba, hba->intr_aggr_cnt,
+					hba->intr_aggr_tmout);
 	else
 		ufshcd_disable_intr_aggr(hba);
 
@@ -4493,12 +4675,24 @@ static int ufshcd_change_queue_depth(struct scsi_device *sdev, int depth)
  */
 static int ufshcd_slave_configure(struct scsi_device *sdev)
 {
+	struct ufs_hba *hba = shost_priv(sdev->host);
 	struct request_queue *q = sdev->request_queue;
 
 	blk_queue_update_dma_pad(q, PRDT_DATA_BYTE_COUNT_PAD - 1);
 	blk_queue_max_segment_size(q, PRDT_DATA_BYTE_COUNT_MAX);
 	blk_queue_update_dma_alignment(q, PAGE_SIZE - 1);
 
+	/*
+	 * All completions arrive on the cpu the UFS interrupt is routed to.
+	 * Raise the completion softirq on the submitting cpu instead, the
+	 * same as rq_affinity=2, so that it runs where the request's data
+	 * is still cache hot.
+	 */
+	if (hba->caps & UFSHCD_CAP_SAME_CPU_COMPLETION) {
+		queue_flag_set_unlocked(QUEUE_FLAG_SAME_COMP, q);
+		queue_flag_set_unlocked(QUEUE_FLAG_SAME_FORCE, q);
+	}
+
 	return 0;
 }
 
@@ -4742,6 +4936,7 @@ static void __ufshcd_transfer_req_compl(struct ufs_hba *hba, int reason,
 		lrbp = &hba->lrb[index];
 		cmd = lrbp->cmd;
 		if (cmd) {
+			blk_rq_io_stamp(cmd->request, BLK_IO_IRQ);
 			result = ufshcd_vops_crypto_engine_clear(hba, lrbp);
 			if (result) {
 				dev_err(hba->dev,
@@ -4852,7 +5047,8 @@ static void ufshcd_transfer_req_compl(struct ufs_hba *hba, int reason)
 	 * false interrupt if device completes another request after resetting
 	 * aggregation and before reading the DB.
 	 */
-	if (!ufshcd_can_reset_intr_aggr(hba) && ufshcd_is_intr_aggr_allowed(hba))
+	if (!ufshcd_can_reset_intr_aggr(hba) &&
+	    ufshcd_is_intr_aggr_allowed(hba) && hba->intr_aggr_cnt)
 		ufshcd_reset_intr_aggr(hba);
 
 	tr_doorbell = ufshcd_readl(hba, REG_UTP_TRANSFER_REQ_DOOR_BELL);
@@ -8353,6 +8549,71 @@ ufshcd_exit_latency_hist(struct ufs_hba *hba)
 	device_create_file(hba->dev, &dev_attr_latency_hist);
 }
 
+/*
+ * "<counter> <timeout>" of UTRD interrupt aggregation. The timeout is in
+ * units of the host's aggregation tick, a counter of 0 disables it.
+ */
+static ssize_t
+intr_aggr_store(struct device *dev, struct device_attribute *attr,
+		const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	unsigned long flags;
+	unsigned int cnt, tmout;
+
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return -EOPNOTSUPP;
+	if (sscanf(buf, "%u %u", &cnt, &tmout) != 2)
+		return -EINVAL;
+	if (cnt >= hba->nutrs || cnt > (INT_AGGR_COUNTER_THLD_VAL(~0) >> 8) ||
+	    tmout > INT_AGGR_TIMEOUT_VAL(~0) || (cnt && !tmout))
+		return -EINVAL;
+
+	pm_runtime_get_sync(hba->dev);
+	ufshcd_hold(hba, false);
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	hba->intr_aggr_cnt = cnt;
+	hba->intr_aggr_tmout = tmout;
+	if (hba->is_powered) {
+		if (cnt)
+			ufshcd_config_intr_aggr(hba, cnt, tmout);
+		else
+			ufshcd_disable_intr_aggr(hba);
+	}
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	ufshcd_release(hba);
+	pm_runtime_put_sync(hba->dev);
+
+	return count;
+}
+
+static ssize_t
+intr_aggr_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%u %u\n",
+			hba->intr_aggr_cnt, hba->intr_aggr_tmout);
+}
+
+static DEVICE_ATTR(intr_aggr, S_IRUGO | S_IWUSR,
+		   intr_aggr_show, intr_aggr_store);
+
+static void
+ufshcd_init_intr_aggr(struct ufs_hba *hba)
+{
+	if (device_create_file(hba->dev, &dev_attr_intr_aggr))
+		dev_err(hba->dev, "Failed to create intr_aggr sysfs entry\n");
+}
+
+static void
+ufshcd_exit_intr_aggr(struct ufs_hba *hba)
+{
+	device_remove_file(hba->dev, &dev_attr_intr_aggr);
+}
+
 /**
  * ufshcd_remove - de-allocate SCSI host and host memory space
  *		data structure memory
@@ -8367,6 +8628,7 @@ void ufshcd_remove(struct ufs_hba *hba)
 
 	ufshcd_exit_clk_gating(hba);
 	ufshcd_exit_latency_hist(hba);
+	ufshcd_exit_intr_aggr(hba);
 #if defined(CONFIG_PM_DEVFREQ)
 	if (ufshcd_is_clkscaling_enabled(hba))
 		devfreq_remove_device(hba->devfreq);
@@ -8999,6 +9261,7 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 	pm_runtime_get_sync(dev);
 
 	ufshcd_init_latency_hist(hba);
+	ufshcd_init_intr_aggr(hba);
 
 	/*
 	 * The device-initialize-sequence hasn't been invoked yet.
@@ -9020,6 +9283,7 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 exit_gating:
 	ufshcd_exit_clk_gating(hba);
 	ufshcd_exit_latency_hist(hba);
+	ufshcd_exit_intr_aggr(hba);
 out_disable:
 	hba->is_irq_enabled = false;
 	ufshcd_hba_exit(hba);
@@ -356,7 +356,14 @@ enum clk_gating_state {
  * @delay_attr: sysfs attribute to control delay_attr
  * @active_reqs: number of requests that are pending and should be waited for
  * completion before gating clocks.
+ * @idle_start: when the host last went idle, 0 while busy
+ * @idle_hist: idle periods, bucket i > 0 counts [2^(i-1), 2^i) ms
+ * @nr_samples: idle periods recorded since the last decay
+ * @exit_cost_us: weight of one gating in us of ungated time, 0 keeps
+ * delay_ms fixed
  */
+#define UFS_IDLE_HIST_BUCKETS	11
+
 struct ufs_clk_gating {
 	struct delayed_work gate_work;
 	struct work_struct ungate_work;
@@ -365,6 +372,14 @@ struct ufs_clk_gating {
 	bool is_suspended;
 	struct device_attribute delay_attr;
 	int active_reqs;
+#if defined(CONFIG_SCSI_UFS_ADAPTIVE_GATING)
+	ktime_t idle_start;
+	u32 idle_hist[UFS_IDLE_HIST_BUCKETS];
+	u32 nr_samples;
+	unsigned int exit_cost_us;
+	struct device_attribute hist_attr;
+	struct device_attribute exit_cost_attr;
+#endif
 };
 
 struct ufs_clk_scaling {
@@ -655,6 +670,9 @@ struct ufs_hba {
 	u16 ee_ctrl_mask;
 	bool is_powered;
 	bool is_init_prefetch;
+	/* UTRD interrupt aggregation counter threshold (0: off) and timeout */
+	u8 intr_aggr_cnt;
+	u8 intr_aggr_tmout;
 	struct ufs_init_prefetch init_prefetch_data;
 
 	/* Work Queues */
@@ -717,6 +735,12 @@ struct ufs_hba {
 	/* Allow only hibern8 without clk gating */
 #define UFSHCD_CAP_FAKE_CLK_GATING (1 << 6)
 
+	/*
+	 * Complete requests on the cpu that submitted them rather than on
+	 * the cpu taking the UFS interrupt.
+	 */
+#define UFSHCD_CAP_SAME_CPU_COMPLETION (1 << 7)
+
 	struct devfreq *devfreq;
 	struct ufs_clk_scaling clk_scaling;
 	bool is_sys_suspended;
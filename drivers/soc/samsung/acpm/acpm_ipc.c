@@ -390,6 +390,9 @@ static void dequeue_policy(struct acpm_ipc_ch *channel)
 	unsigned int rear;
 	struct list_head *cb_list = &channel->list;
 	struct callback_info *cb;
+	struct acpm_ipc_async *async;
+	ipc_done_callback done;
+	unsigned int seq;
 
 	spin_lock(&channel->rx_lock);
 
@@ -420,8 +423,15 @@ static void dequeue_policy(struct acpm_ipc_ch *channel)
 		else
 			rear++;
 
-		if (!channel->polling)
+		seq = (channel->cmd[0] >> ACPM_IPC_PROTOCOL_SEQ_NUM) & 0x3f;
+		async = &channel->async[seq];
+		done = async->done;
+		if (done) {
+			async->done = NULL;
+			done(channel->cmd, channel->rx_ch.size, async->priv);
+		} else if (!channel->polling) {
 			complete(&channel->wait);
+		}
 
 		__raw_writel(rear, channel->rx_ch.rear);
 		front = __raw_readl(channel->rx_ch.front);
@@ -541,6 +551,65 @@ int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg)
 	return ret;
 }
 
+static int acpm_ipc_wait_response(struct acpm_ipc_ch *channel,
+		struct ipc_config *cfg)
+{
+	bool timeout_flag = 0;
+	u64 timeout, now;
+	u32 retry_cnt = 0;
+
+retry:
+	timeout = sched_clock() + IPC_TIMEOUT;
+	timeout_flag = false;
+
+	while (!(__raw_readl(acpm_ipc->intr + INTSR1) & (1 << channel->id)) ||
+			check_response(channel, cfg)) {
+		now = sched_clock();
+		if (timeout < now) {
+			if (retry_cnt++ < 5) {
+				pr_err("acpm_ipc timeout retry %d"
+					"now = %llu,"
+					"timeout = %llu\n",
+					retry_cnt, now, timeout);
+				goto retry;
+			}
+			timeout_flag = true;
+			break;
+		} else {
+			if (acpm_ipc->w_mode)
+				usleep_range(50, 100);
+			else
+				cpu_relax();
+		}
+	}
+
+	if (timeout_flag) {
+		if (!check_response(channel, cfg))
+			return 0;
+		pr_err("%s Timeout error! now = %llu, timeout = %llu\n",
+				__func__, now, timeout);
+		pr_err("[ACPM] int_status:0x%x, ch_id: 0x%x\n",
+				__raw_readl(acpm_ipc->intr + INTSR1),
+				1 << channel->id);
+		pr_err("[ACPM] queue, rx_rear:%u, rx_front:%u\n",
+				__raw_readl(channel->rx_ch.rear),
+				__raw_readl(channel->rx_ch.front));
+		pr_err("[ACPM] queue, tx_rear:%u, tx_front:%u\n",
+				__raw_readl(channel->tx_ch.rear),
+				__raw_readl(channel->tx_ch.front));
+
+		acpm_debug->debug_log_level = 1;
+		acpm_log_print();
+		acpm_debug->debug_log_level = 0;
+		acpm_ramdump();
+
+		BUG_ON(timeout_flag);
+		return -ETIMEDOUT;
+	}
+
+	return 0;
+}
+
 int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 {
 	unsigned int front;
@@ -549,8 +618,6 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	struct acpm_ipc_ch *channel;
 	bool timeout_flag = 0;
 	int ret;
-	u64 timeout, now;
-	u32 retry_cnt = 0;
 
 	if (channel_id >= acpm_ipc->num_channels && !cfg)
 		return -EIO;
@@ -607,61 +674,157 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	spin_unlock(&channel->tx_lock);
 
 	if (channel->polling && cfg->response) {
-retry:
-		timeout = sched_clock() + IPC_TIMEOUT;
-		timeout_flag = false;
-
-		while (!(__raw_readl(acpm_ipc->intr + INTSR1) & (1 << channel->id)) ||
-				check_response(channel, cfg)) {
-			now = sched_clock();
-			if (timeout < now) {
-				if (retry_cnt++ < 5) {
-					pr_err("acpm_ipc timeout retry %d"
-						"now = %llu,"
-						"timeout = %llu\n",
-						retry_cnt, now, timeout);
-					goto retry;
-				}
-				timeout_flag = true;
-				break;
-			} else {
-				if (acpm_ipc->w_mode)
-					usleep_range(50, 100);
-				else
-					cpu_relax();
-			}
+		ret = acpm_ipc_wait_response(channel, cfg);
+		if (ret)
+			return ret;
+
+		queue_work(update_log_wq, &acpm_debug->update_log_work);
+	}
+
+	return 0;
+}
+
+static int acpm_ipc_enqueue_batch(struct acpm_ipc_ch *channel,
+		struct ipc_config *cfg, unsigned int nr,
+		ipc_done_callback done, void *priv)
+{
+	unsigned int front;
+	unsigned int tmp_index;
+	bool timeout_flag = 0;
+	bool pending = false;
+	unsigned int i;
+
+	spin_lock(&channel->tx_lock);
+
+	front = __raw_readl(channel->tx_ch.front);
+
+	for (i = 0; i < nr; i++) {
+		tmp_index = front + 1;
+		if (tmp_index >= channel->tx_ch.len)
+			tmp_index = 0;
+
+		/* let ACPM drain what is already queued before waiting on it */
+		if (tmp_index == __raw_readl(channel->tx_ch.rear) && pending) {
+			writel(front, channel->tx_ch.front);
+			apm_interrupt_gen(channel->id);
+			pending = false;
 		}
 
+		/* buffer full check */
+		UNTIL_EQUAL(true, tmp_index != __raw_readl(channel->tx_ch.rear),
+				timeout_flag);
 		if (timeout_flag) {
-			if (!check_response(channel, cfg))
-				return 0;
-			pr_err("%s Timeout error! now = %llu, timeout = %llu\n",
-					__func__, now, timeout);
-			pr_err("[ACPM] int_status:0x%x, ch_id: 0x%x\n",
-					__raw_readl(acpm_ipc->intr + INTSR1),
-					1 << channel->id);
-			pr_err("[ACPM] queue, rx_rear:%u, rx_front:%u\n",
-					__raw_readl(channel->rx_ch.rear),
-					__raw_readl(channel->rx_ch.front));
-			pr_err("[ACPM] queue, tx_rear:%u, tx_front:%u\n",
-					__raw_readl(channel->tx_ch.rear),
-					__raw_readl(channel->tx_ch.front));
-
-			acpm_debug->debug_log_level = 1;
+			if (pending) {
+				writel(front, channel->tx_ch.front);
+				apm_interrupt_gen(channel->id);
+			}
 			acpm_log_print();
-			acpm_debug->debug_log_level = 0;
-			acpm_ramdump();
-
-			BUG_ON(timeout_flag);
+			acpm_debug->debug_log_level = 1;
+			spin_unlock(&channel->tx_lock);
+			pr_err("[%s] tx buffer full! timeout!!!\n", __func__);
 			return -ETIMEDOUT;
 		}
 
-		queue_work(update_log_wq, &acpm_debug->update_log_work);
+		if (++channel->seq_num == 64)
+			channel->seq_num = 1;
+
+		cfg[i].cmd[0] |= (channel->seq_num & 0x3f) << ACPM_IPC_PROTOCOL_SEQ_NUM;
+
+		/* published before the doorbell, so the response always finds it */
+		if (done && cfg[i].response) {
+			WARN_ON_ONCE(channel->async[channel->seq_num].done);
+			channel->async[channel->seq_num].priv = priv;
+			channel->async[channel->seq_num].done = done;
+		}
+
+		memcpy_align_4(channel->tx_ch.base + channel->tx_ch.size * front,
+				cfg[i].cmd, channel->tx_ch.size);
+
+		cfg[i].cmd[1] = 0;
+		cfg[i].cmd[2] = 0;
+		cfg[i].cmd[3] = 0;
+
+		front = tmp_index;
+		pending = true;
 	}
 
+	writel(front, channel->tx_ch.front);
+	apm_interrupt_gen(channel->id);
+	spin_unlock(&channel->tx_lock);
+
 	return 0;
 }
 
+/*
+ * Queue @nr direct commands on one channel and raise a single doorbell, so
+ * ACPM handles them back to back instead of taking one interrupt and one
+ * response round trip per command. The commands are executed in array
+ * order. Indirection commands are not supported here.
+ */
+int acpm_ipc_send_data_batch(unsigned int channel_id, struct ipc_config *cfg,
+		unsigned int nr)
+{
+	struct acpm_ipc_ch *channel;
+	unsigned int i;
+	int ret;
+
+	if (channel_id >= acpm_ipc->num_channels || !cfg || !nr)
+		return -EIO;
+
+	for (i = 0; i < nr; i++)
+		if (!cfg[i].cmd || cfg[i].indirection)
+			return -EINVAL;
+
+	channel = &acpm_ipc->channel[channel_id];
+
+	ret = acpm_ipc_enqueue_batch(channel, cfg, nr, NULL, NULL);
+	if (ret)
+		return ret;
+
+	if (!channel->polling)
+		return 0;
+
+	for (i = 0; i < nr; i++) {
+		if (!cfg[i].response)
+			continue;
+
+		ret = acpm_ipc_wait_response(channel, &cfg[i]);
+		if (ret)
+			return ret;
+	}
+
+	queue_work(update_log_wq, &acpm_debug->update_log_work);
+
+	return 0;
+}
+
+/*
+ * Like acpm_ipc_send_data_batch(), but return as soon as the commands are
+ * queued. @done is called from the IPC interrupt thread with the response
+ * of each command that has cfg->response set, in the order ACPM answers.
+ * It runs under the channel rx lock and must not sleep. Only interrupt
+ * mode channels deliver responses this way.
+ */
+int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_config *cfg,
+		unsigned int nr, ipc_done_callback done, void *priv)
+{
+	struct acpm_ipc_ch *channel;
+	unsigned int i;
+
+	if (channel_id >= acpm_ipc->num_channels || !cfg || !nr || !done)
+		return -EIO;
+
+	for (i = 0; i < nr; i++)
+		if (!cfg[i].cmd || cfg[i].indirection)
+			return -EINVAL;
+
+	channel = &acpm_ipc->channel[channel_id];
+	if (channel->polling)
+		return -EINVAL;
+
+	return acpm_ipc_enqueue_batch(channel, cfg, nr, done, priv);
+}
+
 static void log_buffer_init(struct device *dev, struct device_node *node)
 {
 	const __be32 *prop;
@@ -20,6 +20,11 @@ struct callback_info {
 	struct list_head list;
 };
 
+struct acpm_ipc_async {
+	ipc_done_callback done;
+	void *priv;
+};
+
 struct acpm_ipc_ch {
 	struct buff_info rx_ch;
 	struct buff_info tx_ch;
@@ -36,6 +41,9 @@ struct acpm_ipc_ch {
 
 	struct completion wait;
 	bool polling;
+
+	/* pending acpm_ipc_send_data_async() commands, by sequence number */
+	struct acpm_ipc_async async[64];
 };
 
 struct acpm_ipc_info {
@@ -6,6 +6,7 @@
 
 #include <soc/samsung/acpm_ipc_ctrl.h>
 #include <soc/samsung/tmu.h>
+#include <soc/samsung/exynos-dvfs-bench.h>
 
 #include "acpm_dvfs.h"
 #include "cmucal.h"
@@ -40,6 +41,43 @@ int exynos_acpm_set_rate(unsigned int id, unsigned long rate)
 	if (ret)
 		pr_err("%s:[%d] latency = %llu ret = %d",
 			__func__, id, latency, ret);
+	else if (exynos_dvfs_bench_clock())
+		exynos_dvfs_bench_record(DVFS_BENCH_ACPM_IPC, before, after);
+
+	return ret;
+}
+
+int exynos_acpm_set_rate_batch(const unsigned int *id, const unsigned long *rate,
+		unsigned int nr)
+{
+	struct ipc_config config[ACPM_DVFS_BATCH_MAX];
+	unsigned int cmd[ACPM_DVFS_BATCH_MAX][4];
+	unsigned long long before, after, latency;
+	unsigned int i;
+	int ret;
+
+	if (!nr || nr > ACPM_DVFS_BATCH_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < nr; i++) {
+		config[i].cmd = cmd[i];
+		config[i].response = true;
+		config[i].indirection = false;
+		config[i].cmd[0] = id[i];
+		config[i].cmd[1] = (unsigned int)rate[i];
+		config[i].cmd[2] = FREQ_REQ;
+		config[i].cmd[3] = 0;
+	}
+
+	before = sched_clock();
+	ret = acpm_ipc_send_data_batch(acpm_dvfs.ch_num, config, nr);
+	after = sched_clock();
+	latency = after - before;
+	if (ret)
+		pr_err("%s:[%d domains] latency = %llu ret = %d",
+			__func__, nr, latency, ret);
+	else if (exynos_dvfs_bench_clock())
+		exynos_dvfs_bench_record(DVFS_BENCH_ACPM_IPC, before, after);
 
 	return ret;
 }
@@ -22,8 +22,13 @@ struct acpm_dvfs {
 #define COLDTEMP_REQ    3
 #define POLICY_REQ      4
 
+/* maximum number of FREQ_REQ commands queued behind one doorbell */
+#define ACPM_DVFS_BATCH_MAX	8
+
 #ifdef CONFIG_ACPM_DVFS
 extern int exynos_acpm_set_rate(unsigned int id, unsigned long rate);
+extern int exynos_acpm_set_rate_batch(const unsigned int *id,
+		const unsigned long *rate, unsigned int nr);
 extern unsigned long exynos_acpm_get_rate(unsigned int id);
 extern void exynos_acpm_set_device(void *dev);
 extern int exynos_acpm_set_volt_margin(unsigned int id, int volt);
@@ -34,6 +39,12 @@ static inline int exynos_acpm_set_rate(unsigned int id, unsigned long rate)
 	return 0;
 }
 
+static inline int exynos_acpm_set_rate_batch(const unsigned int *id,
+		const unsigned long *rate, unsigned int nr)
+{
+	return 0;
+}
+
 static inline unsigned long exynos_acpm_get_rate(unsigned int id)
 {
 	return 0UL;
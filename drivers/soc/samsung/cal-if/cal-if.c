@@ -1,4 +1,6 @@
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/sched.h>
 #include <linux/exynos-ss.h>
 #include <soc/samsung/ect_parser.h>
 #include <soc/samsung/cal-if.h>
@@ -65,6 +67,94 @@ int cal_dfs_set_rate(unsigned int id, unsigned long rate)
 	return ret;
 }
 
+/*
+ * DVFS batch
+ *
+ * Between cal_dfs_batch_begin() and cal_dfs_batch_commit(), rate changes
+ * of ACPM managed domains requested by the same task through
+ * cal_dfs_set_rate_batched() are only recorded, and are sent to ACPM
+ * together behind one doorbell on commit. Other tasks and non-ACPM
+ * domains keep scaling synchronously.
+ */
+static struct cal_dfs_batch {
+	struct mutex lock;
+	struct task_struct *owner;
+	unsigned int nr;
+	unsigned int id[ACPM_DVFS_BATCH_MAX];
+	unsigned long rate[ACPM_DVFS_BATCH_MAX];
+} dfs_batch = {
+	.lock = __MUTEX_INITIALIZER(dfs_batch.lock),
+};
+
+void cal_dfs_batch_begin(void)
+{
+	mutex_lock(&dfs_batch.lock);
+	dfs_batch.nr = 0;
+	WRITE_ONCE(dfs_batch.owner, current);
+}
+
+int cal_dfs_set_rate_batched(unsigned int id, unsigned long rate)
+{
+	unsigned int i;
+
+	if (READ_ONCE(dfs_batch.owner) != current || !IS_ACPM_VCLK(id))
+		return cal_dfs_set_rate(id, rate);
+
+	for (i = 0; i < dfs_batch.nr; i++) {
+		if (dfs_batch.id[i] == id) {
+			dfs_batch.rate[i] = rate;
+			return 0;
+		}
+	}
+
+	if (dfs_batch.nr == ACPM_DVFS_BATCH_MAX)
+		return cal_dfs_set_rate(id, rate);
+
+	dfs_batch.id[dfs_batch.nr] = id;
+	dfs_batch.rate[dfs_batch.nr] = rate;
+	dfs_batch.nr++;
+
+	return 0;
+}
+
+int cal_dfs_batch_commit(void)
+{
+	unsigned int idx[ACPM_DVFS_BATCH_MAX];
+	struct vclk *vclk;
+	unsigned int i;
+	int ret = 0;
+
+	if (dfs_batch.owner != current) {
+		WARN_ON(1);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < dfs_batch.nr; i++)
+		idx[i] = GET_IDX(dfs_batch.id[i]);
+
+	if (dfs_batch.nr == 1)
+		ret = exynos_acpm_set_rate(idx[0], dfs_batch.rate[0]);
+	else if (dfs_batch.nr)
+		ret = exynos_acpm_set_rate_batch(idx, dfs_batch.rate,
+						 dfs_batch.nr);
+
+	for (i = 0; i < dfs_batch.nr; i++) {
+		/* retry one by one so that no domain is left behind */
+		if (ret && exynos_acpm_set_rate(idx[i], dfs_batch.rate[i]))
+			continue;
+
+		vclk = cmucal_get_node(dfs_batch.id[i]);
+		if (vclk)
+			vclk->vrate = (unsigned int)dfs_batch.rate[i];
+	}
+
+	dfs_batch.nr = 0;
+	WRITE_ONCE(dfs_batch.owner, NULL);
+	mutex_unlock(&dfs_batch.lock);
+
+	return ret;
+}
+
 int cal_dfs_set_rate_switch(unsigned int id, unsigned long switch_rate)
 {
 	int ret = 0;
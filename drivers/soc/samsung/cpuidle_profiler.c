@@ -11,6 +11,9 @@
 #include <linux/kobject.h>
 #include <linux/cpuidle.h>
 #include <linux/slab.h>
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/vmalloc.h>
 #include <linux/cpuidle_profiler.h>
 
 #include <asm/page.h>
@@ -95,6 +98,222 @@ static void exit_idle_state(struct cpuidle_profile_info *info,
 	info->usage[state].time += diff;
 }
 
+/************************************************************************
+ *                         Always-on statistics                         *
+ ************************************************************************/
+#ifdef CONFIG_EXYNOS_CPUIDLE_STAT
+/*
+ * Unlike the profiler above, these counters are never reset and are only
+ * touched by the local cpu, so they are cheap enough to keep running in
+ * the field. Residency is bucketed by powers of two from 32us up.
+ */
+#define IDLE_STAT_BUCKET_SHIFT	5
+
+struct cpuidle_stat {
+	u64 entry_time;
+	int cur_state;
+
+	u64 entry_count[CPUIDLE_STATE_MAX];
+	u64 early_wakeup_count[CPUIDLE_STATE_MAX];
+	u64 time[CPUIDLE_STATE_MAX];
+	u32 hist[CPUIDLE_STATE_MAX][CPUIDLE_STAT_BUCKETS];
+
+	u64 cpd_count;
+	u64 sicd_count;
+
+	/* how many times IDLE_IP[index] bit blocked a system power mode */
+	u32 blocker[NUM_SYS_POWERDOWN][NUM_IDLE_IP][IDLE_IP_REG_SIZE];
+};
+
+static DEFINE_PER_CPU(struct cpuidle_stat, cpuidle_stat) = {
+	.cur_state = -EINVAL,
+};
+
+static int cpuidle_stat_state_count;
+
+static void cpuidle_stat_enter(int cpu, int state, int substate)
+{
+	struct cpuidle_stat *stat = &per_cpu(cpuidle_stat, cpu);
+
+	if (state >= CPUIDLE_STATE_MAX)
+		return;
+
+	stat->cur_state = state;
+	stat->entry_time = local_clock();
+	stat->entry_count[state]++;
+
+	if (state == PROFILE_C2) {
+		if (substate == C2_CPD)
+			stat->cpd_count++;
+		else if (substate == C2_SICD)
+			stat->sicd_count++;
+	}
+}
+
+static void cpuidle_stat_exit(int cpu, int earlywakeup)
+{
+	struct cpuidle_stat *stat = &per_cpu(cpuidle_stat, cpu);
+	int state = stat->cur_state;
+	unsigned int bucket;
+	u64 us;
+
+	if (!state_entered(state))
+		return;
+
+	stat->cur_state = -EINVAL;
+
+	if (earlywakeup) {
+		stat->early_wakeup_count[state]++;
+		return;
+	}
+
+	us = div_u64(local_clock() - stat->entry_time, NSEC_PER_USEC);
+	stat->time[state] += us;
+
+	bucket = fls64(us >> IDLE_STAT_BUCKET_SHIFT);
+	if (bucket >= CPUIDLE_STAT_BUCKETS)
+		bucket = CPUIDLE_STAT_BUCKETS - 1;
+	stat->hist[state][bucket]++;
+}
+
+static void cpuidle_stat_collect_idle_ip(int mode, int index,
+						unsigned int idle_ip)
+{
+	struct cpuidle_stat *stat = this_cpu_ptr(&cpuidle_stat);
+	int i;
+
+	if (mode >= NUM_SYS_POWERDOWN || index >= NUM_IDLE_IP)
+		return;
+
+	for (i = 0; i < IDLE_IP_REG_SIZE; i++)
+		if (idle_ip & (1 << i))
+			stat->blocker[mode][index][i]++;
+}
+
+/*
+ * Binary layout of debugfs "cpuidle_profiler/stat": the header, then, for
+ * each possible cpu, a struct cpuidle_stat_cpu followed by
+ * u32 hist[nr_states][nr_buckets], then the blocker counts summed over
+ * all cpus as u32 blocker[nr_modes][nr_idle_ip][reg_size]. Counters are
+ * sampled without stopping the cpus, so one cpu's numbers may be one idle
+ * period apart from each other.
+ */
+static size_t cpuidle_stat_size(void)
+{
+	size_t hist = sizeof(u32) * cpuidle_stat_state_count * CPUIDLE_STAT_BUCKETS;
+
+	return sizeof(struct cpuidle_stat_header) +
+		num_possible_cpus() * (sizeof(struct cpuidle_stat_cpu) + hist) +
+		sizeof(u32) * NUM_SYS_POWERDOWN * NUM_IDLE_IP * IDLE_IP_REG_SIZE;
+}
+
+static int cpuidle_stat_open(struct inode *inode, struct file *file)
+{
+	struct cpuidle_stat_header *header;
+	struct cpuidle_stat_cpu *cpu_stat;
+	int state_count = cpuidle_stat_state_count;
+	size_t size = cpuidle_stat_size();
+	u32 *blocker;
+	void *buf, *p;
+	int cpu, i, j, k;
+
+	buf = vzalloc(size);
+	if (!buf)
+		return -ENOMEM;
+
+	header = buf;
+	header->magic = CPUIDLE_STAT_MAGIC;
+	header->version = CPUIDLE_STAT_VERSION;
+	header->nr_cpus = num_possible_cpus();
+	header->nr_states = state_count;
+	header->nr_buckets = CPUIDLE_STAT_BUCKETS;
+	header->bucket_shift = IDLE_STAT_BUCKET_SHIFT;
+	header->nr_modes = NUM_SYS_POWERDOWN;
+	header->nr_idle_ip = NUM_IDLE_IP;
+	header->reg_size = IDLE_IP_REG_SIZE;
+	header->timestamp = ktime_to_us(ktime_get());
+
+	p = header + 1;
+	blocker = buf + size -
+		sizeof(u32) * NUM_SYS_POWERDOWN * NUM_IDLE_IP * IDLE_IP_REG_SIZE;
+
+	for_each_possible_cpu(cpu) {
+		struct cpuidle_stat *stat = &per_cpu(cpuidle_stat, cpu);
+		u32 *hist;
+
+		cpu_stat = p;
+		cpu_stat->cpu = cpu;
+		cpu_stat->cluster = to_cluster(cpu);
+		cpu_stat->cpd_count = READ_ONCE(stat->cpd_count);
+		cpu_stat->sicd_count = READ_ONCE(stat->sicd_count);
+		for (i = 0; i < state_count; i++) {
+			cpu_stat->state[i].entry_count =
+				READ_ONCE(stat->entry_count[i]);
+			cpu_stat->state[i].early_wakeup_count =
+				READ_ONCE(stat->early_wakeup_count[i]);
+			cpu_stat->state[i].time = READ_ONCE(stat->time[i]);
+		}
+
+		hist = (u32 *)(cpu_stat + 1);
+		for (i = 0; i < state_count; i++)
+			for (j = 0; j < CPUIDLE_STAT_BUCKETS; j++)
+				*hist++ = READ_ONCE(stat->hist[i][j]);
+		p = hist;
+
+		for (i = 0; i < NUM_SYS_POWERDOWN; i++)
+			for (j = 0; j < NUM_IDLE_IP; j++)
+				for (k = 0; k < IDLE_IP_REG_SIZE; k++)
+					blocker[(i * NUM_IDLE_IP + j) * IDLE_IP_REG_SIZE + k] +=
+						READ_ONCE(stat->blocker[i][j][k]);
+	}
+
+	file->private_data = buf;
+
+	return 0;
+}
+
+static ssize_t cpuidle_stat_read(struct file *file, char __user *ubuf,
+					size_t count, loff_t *ppos)
+{
+	return simple_read_from_buffer(ubuf, count, ppos, file->private_data,
+					cpuidle_stat_size());
+}
+
+static int cpuidle_stat_release(struct inode *inode, struct file *file)
+{
+	vfree(file->private_data);
+
+	return 0;
+}
+
+static const struct file_operations cpuidle_stat_fops = {
+	.open		= cpuidle_stat_open,
+	.read		= cpuidle_stat_read,
+	.release	= cpuidle_stat_release,
+	.llseek		= default_llseek,
+};
+
+static void __init cpuidle_stat_init(void)
+{
+	struct dentry *root;
+
+	root = debugfs_create_dir("cpuidle_profiler", NULL);
+	if (!root) {
+		pr_err("CPUIDLE Profiler : error to create debugfs\n");
+		return;
+	}
+
+	if (!debugfs_create_file("stat", 0400, root, NULL, &cpuidle_stat_fops))
+		pr_err("CPUIDLE Profiler : error to create debugfs stat\n");
+}
+#else
+static inline void cpuidle_stat_enter(int cpu, int state, int substate) { }
+static inline void cpuidle_stat_exit(int cpu, int earlywakeup) { }
+static inline void cpuidle_stat_collect_idle_ip(int mode, int index,
+						unsigned int idle_ip) { }
+static inline void cpuidle_stat_init(void) { }
+#endif
+
 /*
  * C2 subordinate state such as CPD and SICD can be entered by many cpus.
  * The variables which contains these idle states need to keep
@@ -143,6 +362,8 @@ void __cpuidle_profile_start(int cpu, int state, int substate)
 
 void cpuidle_profile_start(int cpu, int state, int substate)
 {
+	cpuidle_stat_enter(cpu, state, substate);
+
 	/*
 	 * Return if profile is not started
 	 */
@@ -181,6 +402,8 @@ void __cpuidle_profile_finish(int cpu, int earlywakeup)
 
 void cpuidle_profile_finish(int cpu, int earlywakeup)
 {
+	cpuidle_stat_exit(cpu, earlywakeup);
+
 	/*
 	 * Return if profile is not started
 	 */
@@ -199,6 +422,8 @@ void cpuidle_profile_collect_idle_ip(int mode, int index,
 {
 	int i;
 
+	cpuidle_stat_collect_idle_ip(mode, index, idle_ip);
+
 	/*
 	 * Return if profile is not started
 	 */
@@ -618,6 +843,10 @@ void __init cpuidle_profile_register(struct cpuidle_driver *drv)
 
 	/* Initiailize System power mode information */
 	cpuidle_profile_info_init(&sys_info, NUM_SYS_POWERDOWN);
+
+#ifdef CONFIG_EXYNOS_CPUIDLE_STAT
+	cpuidle_stat_state_count = min(idle_state_count, CPUIDLE_STATE_MAX);
+#endif
 }
 
 static int __init cpuidle_profile_init(void)
@@ -635,6 +864,8 @@ static int __init cpuidle_profile_init(void)
 
 	exynos_get_idle_ip_list(idle_ip_list);
 
+	cpuidle_stat_init();
+
 	return 0;
 }
 late_initcall(cpuidle_profile_init);
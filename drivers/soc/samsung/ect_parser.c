@@ -9,6 +9,7 @@
 #include <linux/fs.h>
 #include <linux/file.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/vmalloc.h>
 
 #define ALIGNMENT_SIZE	 4
@@ -30,6 +31,10 @@ static phys_addr_t ect_size;
 
 static struct vm_struct ect_early_vm;
 
+#if defined(CONFIG_ECT_LAZY_PARSE)
+static DEFINE_MUTEX(ect_parse_lock);
+#endif
+
 /* API for internal */
 
 static void ect_parse_integer(void **address, void *value)
@@ -1237,6 +1242,47 @@ static struct ect_info ect_header_info = {
 	.block_precedence = -1,
 };
 
+#if defined(CONFIG_ECT_LAZY_PARSE)
+/*
+ * The blob stays mapped at S5P_VA_ECT, so a block is parsed the first
+ * time it is looked up. The parser fills a copy of the info and the
+ * handle is published only once the whole block has been built, so a
+ * lookup that does not take the lock never sees a partial block.
+ */
+static void *ect_get_block_handle(struct ect_info *info)
+{
+	struct ect_info parsed;
+	void *handle;
+
+	handle = smp_load_acquire(&info->block_handle);
+	if (handle != NULL || info->block_address == NULL)
+		return handle;
+
+	mutex_lock(&ect_parse_lock);
+
+	handle = info->block_handle;
+	if (handle == NULL && info->block_address != NULL) {
+		parsed = *info;
+		if (info->parser(info->block_address, &parsed)) {
+			pr_err("[ECT] : parse error %s\n", info->block_name);
+			info->block_address = NULL;
+		} else {
+			handle = parsed.block_handle;
+			smp_store_release(&info->block_handle, handle);
+		}
+	}
+
+	mutex_unlock(&ect_parse_lock);
+
+	return handle;
+}
+#else
+static void *ect_get_block_handle(struct ect_info *info)
+{
+	return info->block_handle;
+}
+#endif
+
 static struct ect_info ect_list[] = {
 	{
 		.block_name = BLOCK_AP_THERMAL,
@@ -2068,6 +2114,8 @@ static int dump_open(struct inode *inode, struct file *file)
 {
 	struct ect_info *info = (struct ect_info *)inode->i_private;
 
+	ect_get_block_handle(info);
+
 	return single_open(file, info->dump, inode->i_private);
 }
 
@@ -2084,6 +2132,8 @@ static int ect_dump_all(struct seq_file *s, void *data)
 			if (ect_list[j].block_precedence != i)
 				continue;
 
+			ect_get_block_handle(&ect_list[j]);
+
 			ret = ect_list[j].dump(s, data);
 			if (ret)
 				return ret;
@@ -2170,7 +2220,8 @@ static int ect_dump_init(void)
 		return -ENOMEM;
 
 	for (i = 0; i < ARRAY_SIZE32(ect_list); ++i) {
-		if (ect_list[i].block_handle == NULL)
+		if (ect_list[i].block_handle == NULL &&
+				ect_list[i].block_address == NULL)
 			continue;
 
 		d = debugfs_create_file(ect_list[i].dump_node_name, S_IRUGO, root, &(ect_list[i]),
@@ -2227,7 +2278,7 @@ void *ect_get_block(char *block_name)
 
 	for (i = 0; i < ARRAY_SIZE32(ect_list); ++i) {
 		if (ect_strcmp(block_name, ect_list[i].block_name) == 0)
-			return ect_list[i].block_handle;
+			return ect_get_block_handle(&ect_list[i]);
 	}
 
 	return NULL;
@@ -2576,11 +2627,15 @@ int ect_parse_binary_header(void)
 			if (strncmp(block_name, ect_list[j].block_name, ect_list[j].block_name_length) != 0)
 				continue;
 
+#if defined(CONFIG_ECT_LAZY_PARSE)
+			ect_list[j].block_address = (void *)ect_address + offset;
+#else
 			if (ect_list[j].parser((void *)ect_address + offset, ect_list + j)) {
 				pr_err("[ECT] : parse error %s\n", block_name);
 				ret = -EINVAL;
 				goto err_parser;
 			}
+#endif
 
 			ect_list[j].block_precedence = i;
 		}
@@ -2590,7 +2645,9 @@ int ect_parse_binary_header(void)
 
 	return ret;
 
+#if !defined(CONFIG_ECT_LAZY_PARSE)
 err_parser:
+#endif
 err_parse_string:
 err_memcmp:
 	kfree(ect_header);
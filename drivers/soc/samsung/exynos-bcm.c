@@ -27,6 +27,13 @@
 #include <linux/memblock.h>
 #include <asm/map.h>
 #include <asm/tlbflush.h>
+#ifdef CONFIG_EXYNOS_BCM_STREAM
+#include <linux/miscdevice.h>
+#include <linux/eventfd.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/exynos_bcm.h>
+#endif
 
 #define BCM_BDGGEN
 #ifdef BCM_BDGGEN
@@ -174,16 +181,243 @@ int bcm_pd_sync(struct bcm_info *bcm, bool on)
 }
 EXPORT_SYMBOL(bcm_pd_sync);
 
+#ifdef CONFIG_EXYNOS_BCM_STREAM
+#define BCM_STREAM_RECORDS	(32 * 1024)
+#define BCM_STREAM_SIZE		(PAGE_SIZE + BCM_STREAM_RECORDS * \
+				 sizeof(struct bcm_stream_record))
+
+static struct bcm_stream {
+	struct mutex lock;
+	bool opened;
+	bool enabled;
+	void *buf;
+	struct bcm_stream_header *header;
+	struct bcm_stream_record *records;
+	struct output_data *cursor;
+	struct eventfd_ctx *eventfd;
+	u64 notified;
+} bcm_stream = {
+	.lock = __MUTEX_INITIALIZER(bcm_stream.lock),
+};
+
+static bool bcm_output_valid(const struct output_data *data)
+{
+	return data->rd0 || data->rd1 || data->rd2 ||
+		data->rd3 || data->rd4 || data->rd5;
+}
+
+/*
+ * Move the records the firmware appended to its output buffer since the
+ * last call into the stream ring. Consumed records are cleared so that a
+ * non-zero record past the cursor is always a new one, also after the
+ * firmware wraps to fdata. Called with bcm_lock held.
+ */
+static void bcm_stream_collect(u64 now)
+{
+	struct bcm_stream *stream = &bcm_stream;
+	struct output_data *data;
+	u64 head;
+	unsigned int n = 0;
+
+	if (!stream->enabled || !os_func.fdata)
+		return;
+
+	data = stream->cursor;
+	if (!data || data < os_func.fdata || data >= os_func.ldata)
+		data = os_func.fdata;
+
+	head = stream->header->head;
+	while (n < BCM_STREAM_RECORDS && bcm_output_valid(data)) {
+		struct bcm_stream_record *rec =
+			&stream->records[head % BCM_STREAM_RECORDS];
+
+		rec->timestamp = now;
+		rec->index = data->index;
+		rec->rd0 = data->rd0;
+		rec->rd1 = data->rd1;
+		rec->rd2 = data->rd2;
+		rec->rd3 = data->rd3;
+		rec->rd4 = data->rd4;
+		rec->rd5 = data->rd5;
+		memset(data, 0, sizeof(*data));
+
+		head++;
+		n++;
+		if (++data >= os_func.ldata)
+			data = os_func.fdata;
+	}
+	stream->cursor = data;
+
+	if (!n)
+		return;
+
+	/* records must be visible before the head that covers them */
+	smp_wmb();
+	WRITE_ONCE(stream->header->head, head);
+
+	if (stream->eventfd &&
+	    head - stream->notified >= stream->header->notify_records) {
+		eventfd_signal(stream->eventfd, 1);
+		stream->notified = head;
+	}
+}
+
+static bool bcm_stream_enabled(void)
+{
+	return bcm_stream.enabled;
+}
+
+/* the firmware restarts its output at @data, called with bcm_lock held */
+static void bcm_stream_rewind(struct output_data *data)
+{
+	bcm_stream.cursor = data;
+}
+
+static int bcm_stream_open(struct inode *inode, struct file *file)
+{
+	struct bcm_stream *stream = &bcm_stream;
+	struct bcm_stream_header *header;
+	unsigned long flags;
+	int ret = 0;
+
+	mutex_lock(&stream->lock);
+	if (stream->opened) {
+		ret = -EBUSY;
+		goto out;
+	}
+
+	if (!stream->buf) {
+		stream->buf = vmalloc_user(BCM_STREAM_SIZE);
+		if (!stream->buf) {
+			ret = -ENOMEM;
+			goto out;
+		}
+		stream->header = stream->buf;
+		stream->records = stream->buf + PAGE_SIZE;
+	}
+
+	header = stream->header;
+	memset(header, 0, sizeof(*header));
+	header->magic = BCM_STREAM_MAGIC;
+	header->version = BCM_STREAM_VERSION;
+	header->record_size = sizeof(struct bcm_stream_record);
+	header->nr_records = BCM_STREAM_RECORDS;
+	header->data_offset = PAGE_SIZE;
+	header->notify_records = BCM_STREAM_RECORDS / 8;
+
+	spin_lock_irqsave(&bcm_lock, flags);
+	stream->cursor = NULL;
+	stream->notified = 0;
+	stream->enabled = true;
+	spin_unlock_irqrestore(&bcm_lock, flags);
+
+	stream->opened = true;
+out:
+	mutex_unlock(&stream->lock);
+	return ret;
+}
+
+static int bcm_stream_release(struct inode *inode, struct file *file)
+{
+	struct bcm_stream *stream = &bcm_stream;
+	struct eventfd_ctx *eventfd;
+	unsigned long flags;
+
+	mutex_lock(&stream->lock);
+	spin_lock_irqsave(&bcm_lock, flags);
+	stream->enabled = false;
+	eventfd = stream->eventfd;
+	stream->eventfd = NULL;
+	spin_unlock_irqrestore(&bcm_lock, flags);
+
+	if (eventfd)
+		eventfd_ctx_put(eventfd);
+	stream->opened = false;
+	mutex_unlock(&stream->lock);
+
+	return 0;
+}
+
+static int bcm_stream_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return remap_vmalloc_range(vma, bcm_stream.buf, vma->vm_pgoff);
+}
+
+static long bcm_stream_ioctl(struct file *file, unsigned int cmd,
+			     unsigned long arg)
+{
+	struct bcm_stream *stream = &bcm_stream;
+	struct eventfd_ctx *eventfd = NULL, *old;
+	unsigned long flags;
+	s32 fd;
+	u32 nr;
+
+	switch (cmd) {
+	case BCM_STREAM_SET_EVENTFD:
+		if (get_user(fd, (s32 __user *)arg))
+			return -EFAULT;
+		if (fd >= 0) {
+			eventfd = eventfd_ctx_fdget(fd);
+			if (IS_ERR(eventfd))
+				return PTR_ERR(eventfd);
+		}
+		spin_lock_irqsave(&bcm_lock, flags);
+		old = stream->eventfd;
+		stream->eventfd = eventfd;
+		stream->notified = stream->header->head;
+		spin_unlock_irqrestore(&bcm_lock, flags);
+		if (old)
+			eventfd_ctx_put(old);
+		return 0;
+	case BCM_STREAM_SET_NOTIFY:
+		if (get_user(nr, (u32 __user *)arg))
+			return -EFAULT;
+		if (!nr || nr > BCM_STREAM_RECORDS)
+			return -EINVAL;
+		WRITE_ONCE(stream->header->notify_records, nr);
+		return 0;
+	}
+
+	return -ENOTTY;
+}
+
+static const struct file_operations bcm_stream_fops = {
+	.owner		= THIS_MODULE,
+	.open		= bcm_stream_open,
+	.release	= bcm_stream_release,
+	.mmap		= bcm_stream_mmap,
+	.unlocked_ioctl	= bcm_stream_ioctl,
+	.compat_ioctl	= bcm_stream_ioctl,
+};
+
+static struct miscdevice bcm_stream_misc = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= "bcm_stream",
+	.fops	= &bcm_stream_fops,
+};
+#else
+static inline void bcm_stream_collect(u64 now) {}
+static inline bool bcm_stream_enabled(void) { return false; }
+static inline void bcm_stream_rewind(struct output_data *data) {}
+#endif
+
 static enum hrtimer_restart monitor_fn(struct hrtimer *hrtimer)
 {
 	unsigned long flags;
-	int duration;
+	int duration = 0;
 	enum hrtimer_restart ret = HRTIMER_NORESTART;
+	u64 now;
 
 	spin_lock_irqsave(&bcm_lock, flags);
 	if (fw_func) {
-		duration = fw_func->fw_periodic(get_time(),
+		now = get_time();
+		duration = fw_func->fw_periodic(now,
 						cal_dfs_cached_get_rate, NULL);
+		bcm_stream_collect(now);
 	}
 	spin_unlock_irqrestore(&bcm_lock, flags);
 
@@ -208,6 +442,7 @@ struct output_data *bcm_start(const int *usr)
 		}
 
 		data = fw_func->fw_init(usr);
+		bcm_stream_rewind(data);
 		if (data) {
 			duration = fw_func->fw_periodic(get_time(),
 					cal_dfs_cached_get_rate, usr);
@@ -240,17 +475,25 @@ struct output_data *bcm_stop(const int *usr)
 {
 	unsigned long flags;
 	struct output_data *data = NULL;
+	u64 now;
+
 	if (fw_func) {
 		spin_lock_irqsave(&bcm_lock, flags);
 		if (!fw_func) {
 			spin_unlock_irqrestore(&bcm_lock, flags);
 			return data;
 		}
-		data = fw_func->fw_stop(get_time(),
-				cal_dfs_cached_get_rate, usr);
+		now = get_time();
+		data = fw_func->fw_stop(now, cal_dfs_cached_get_rate, usr);
 		if (data)
 			hrtimer_try_to_cancel(&bcm_hrtimer);
+		bcm_stream_collect(now);
 		spin_unlock_irqrestore(&bcm_lock, flags);
+
+		/* records already went to the stream reader */
+		if (bcm_stream_enabled())
+			return data;
+
 		switch (fw_func->get_outform()) {
 		case OUT_FILE:
 			bcm_file_out(NULL);
@@ -484,6 +727,7 @@ static ssize_t store_load_bcm_fw(struct device *dev,
 		spin_unlock_irqrestore(&bcm_lock, flags);
 	}
 	if (value) {
+		bcm_stream_rewind(NULL);
 		if (!os_func.fdata) {
 			os_func.fdata = kzalloc(sizeof(struct output_data) *
 						BCM_MAX_DATA, GFP_KERNEL);
@@ -726,6 +970,12 @@ static int bcm_probe(struct platform_device *pdev)
 	panic_nb.priority = 0;
 	atomic_notifier_chain_register(&panic_notifier_list, &panic_nb);
 
+#ifdef CONFIG_EXYNOS_BCM_STREAM
+	ret = misc_register(&bcm_stream_misc);
+	if (ret)
+		dev_err(&pdev->dev, "failed to register bcm_stream: %d\n", ret);
+#endif
+
 	BCM_BDG("bcm driver is probed\n");
 
 	return 0;
@@ -21,6 +21,8 @@
 #include "acpm/acpm_ipc.h"
 
 #include <soc/samsung/exynos-dm.h>
+#include <soc/samsung/cal-if.h>
+#include <soc/samsung/exynos-dvfs-bench.h>
 
 static struct list_head *get_min_constraint_list(struct exynos_dm_data *dm_data);
 static struct list_head *get_max_constraint_list(struct exynos_dm_data *dm_data);
@@ -428,6 +430,62 @@ int exynos_dm_data_init(enum exynos_dm_type dm_type,
 	return ret;
 }
 
+/*
+ * Every domain keeps a compact array of the constraints that bound it, so
+ * that dm_data_updater() does not have to walk the constraint lists of all
+ * domains to find them.
+ */
+static int link_dm_bound(enum exynos_dm_type master,
+				struct exynos_dm_constraint *constraint)
+{
+	struct exynos_dm_data *dm = &exynos_dm->dm_data[constraint->constraint_dm_type];
+	struct exynos_dm_bound *bound;
+	u32 *nr;
+
+	if (constraint->constraint_type == CONSTRAINT_MIN) {
+		bound = dm->min_bound;
+		nr = &dm->nr_min_bound;
+	} else {
+		bound = dm->max_bound;
+		nr = &dm->nr_max_bound;
+	}
+
+	if (*nr >= EXYNOS_DM_MAX_BOUNDS) {
+		dev_err(exynos_dm->dev, "too many constraints for %s\n",
+				dm->dm_type_name);
+		return -ENOSPC;
+	}
+
+	bound[*nr].constraint = constraint;
+	bound[*nr].master = master;
+	(*nr)++;
+
+	return 0;
+}
+
+static void unlink_dm_bound(struct exynos_dm_constraint *constraint)
+{
+	struct exynos_dm_data *dm = &exynos_dm->dm_data[constraint->constraint_dm_type];
+	struct exynos_dm_bound *bound;
+	u32 *nr;
+	int i;
+
+	if (constraint->constraint_type == CONSTRAINT_MIN) {
+		bound = dm->min_bound;
+		nr = &dm->nr_min_bound;
+	} else {
+		bound = dm->max_bound;
+		nr = &dm->nr_max_bound;
+	}
+
+	for (i = 0; i < *nr; i++) {
+		if (bound[i].constraint == constraint) {
+			bound[i] = bound[--(*nr)];
+			break;
+		}
+	}
+}
+
 /*
  * 	Initialize sequence Step.2
  */
@@ -470,6 +528,12 @@ int register_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 	constraint->min_freq = 0;
 	constraint->max_freq = UINT_MAX;
 
+	ret = link_dm_bound(dm_type, constraint);
+	if (ret) {
+		mutex_unlock(&exynos_dm->lock);
+		return ret;
+	}
+
 	if (constraint->constraint_type == CONSTRAINT_MIN)
 		list_add(&constraint->node, &exynos_dm->dm_data[dm_type].min_clist);
 	else if (constraint->constraint_type == CONSTRAINT_MAX)
@@ -510,6 +574,10 @@ int register_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 					constraint->freq_table[i].master_freq;
 		}
 
+		ret = link_dm_bound(constraint->constraint_dm_type, sub_constraint);
+		if (ret)
+			goto err_link;
+
 		list_add(&sub_constraint->node,
 			&exynos_dm->dm_data[constraint->constraint_dm_type].max_clist);
 
@@ -521,10 +589,13 @@ int register_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 
 	return 0;
 
+err_link:
+	kfree(sub_constraint->freq_table);
 err_freq_table:
 	kfree(sub_constraint);
 err_sub_const:
 	list_del(&constraint->node);
+	unlink_dm_bound(constraint);
 
 	mutex_unlock(&exynos_dm->lock);
 
@@ -551,11 +622,13 @@ int unregister_exynos_dm_constraint_table(enum exynos_dm_type dm_type,
 	if (constraint->sub_constraint) {
 		sub_constraint = constraint->sub_constraint;
 		list_del(&sub_constraint->node);
+		unlink_dm_bound(sub_constraint);
 		kfree(sub_constraint->freq_table);
 		kfree(sub_constraint);
 	}
 
 	list_del(&constraint->node);
+	unlink_dm_bound(constraint);
 
 	mutex_unlock(&exynos_dm->lock);
 
@@ -671,7 +744,8 @@ static int __policy_update_call_to_DM(enum exynos_dm_type dm_type, u32 min_freq,
 
 	update_policy_min_max_freq(dm, min_freq, max_freq);
 
-	/* Check dependent domains */
+	/* Keep the cached bounds of this domain in sync with its policy */
+	dm_data_updater(dm_type);
 
 	/*Send policy to FVP*/
 #ifdef CONFIG_EXYNOS_ACPM
@@ -714,19 +788,28 @@ static int constraint_checker_min(struct list_head *head, u32 freq)
 {
 	struct exynos_dm_data *dm;
 	struct exynos_dm_constraint *constraint;
+	u32 old_freq;
 	int i;
 
 	if (!list_empty(head)) {
 		list_for_each_entry(constraint, head, node) {
+			old_freq = constraint->min_freq;
 			for (i = constraint->table_length - 1; i >= 0; i--) {
 				if (freq <= constraint->freq_table[i].master_freq) {
 					constraint->min_freq = constraint->freq_table[i].constraint_freq;
 					break;
 				}
 			}
-			dm_data_updater(constraint->constraint_dm_type);
+
+			/* bounds of the dependent only move if this constraint did */
+			if (constraint->min_freq == old_freq)
+				continue;
+
 			dm = &exynos_dm->dm_data[constraint->constraint_dm_type];
-			constraint_checker_min(get_min_constraint_list(dm), dm->min_freq);
+			old_freq = dm->min_freq;
+			dm_data_updater(constraint->constraint_dm_type);
+			if (dm->min_freq != old_freq)
+				constraint_checker_min(get_min_constraint_list(dm), dm->min_freq);
 		}
 	}
 
@@ -737,19 +820,27 @@ static int constraint_checker_max(struct list_head *head, u32 freq)
 {
 	struct exynos_dm_data *dm;
 	struct exynos_dm_constraint *constraint;
+	u32 old_freq;
 	int i;
 
 	if (!list_empty(head)) {
 		list_for_each_entry(constraint, head, node) {
+			old_freq = constraint->max_freq;
 			for (i = 0; i < constraint->table_length; i++) {
 				if (freq >= constraint->freq_table[i].master_freq) {
 					constraint->max_freq = constraint->freq_table[i].constraint_freq;
 					break;
 				}
 			}
-			dm_data_updater(constraint->constraint_dm_type);
+
+			if (constraint->max_freq == old_freq)
+				continue;
+
 			dm = &exynos_dm->dm_data[constraint->constraint_dm_type];
-			constraint_checker_max(get_max_constraint_list(dm), dm->max_freq);
+			old_freq = dm->max_freq;
+			dm_data_updater(constraint->constraint_dm_type);
+			if (dm->max_freq != old_freq)
+				constraint_checker_max(get_max_constraint_list(dm), dm->max_freq);
 		}
 	}
 
@@ -768,9 +859,12 @@ static int __DM_CALL(enum exynos_dm_type dm_type, unsigned long *target_freq)
 	u32 old_min_freq;
 	struct timeval pre, before, after;
 	s32 time = 0, pre_time = 0;
+	u64 bench_start, bench_scale;
 
 	exynos_ss_dm((int)dm_type, *target_freq, 1, pre_time, time);
 
+	bench_start = exynos_dvfs_bench_clock();
+
 	do_gettimeofday(&pre);
 	do_gettimeofday(&before);
 
@@ -810,6 +904,9 @@ static int __DM_CALL(enum exynos_dm_type dm_type, unsigned long *target_freq)
 	constraint_data_updater(dm_type, 1);
 	max_constraint_data_updater(dm_type, 1);
 
+	bench_scale = exynos_dvfs_bench_clock();
+	exynos_dvfs_bench_record(DVFS_BENCH_DM_CONSTRAINT, bench_start, bench_scale);
+
 	if (dm->target_freq > dm->cur_freq)
 		scaling_callback(UP, relation);
 	else if (dm->target_freq < dm->cur_freq)
@@ -819,6 +916,9 @@ static int __DM_CALL(enum exynos_dm_type dm_type, unsigned long *target_freq)
 	else if (dm->min_freq < old_min_freq)
 		scaling_callback(DOWN, relation);
 
+	exynos_dvfs_bench_record(DVFS_BENCH_DM_SCALE, bench_scale,
+				 exynos_dvfs_bench_clock());
+
 	/* min/max order clear */
 	for (i = 0; i <= DM_TYPE_END; i++) {
 		min_order[i] = DM_EMPTY;
@@ -840,8 +940,7 @@ static int __DM_CALL(enum exynos_dm_type dm_type, unsigned long *target_freq)
 static int dm_data_updater(enum exynos_dm_type dm_type)
 {
 	struct exynos_dm_data *dm;
-	struct exynos_dm_constraint *constraint;
-	struct list_head *constraint_list;
+	struct exynos_dm_bound *bound;
 	int i;
 	/* Initial min/max frequency is set to policy min/max frequency */
 	u32 min_freq;
@@ -852,29 +951,15 @@ static int dm_data_updater(enum exynos_dm_type dm_type)
 	max_freq = dm->policy_max_freq;
 
 	/* Check min/max constraint conditions */
-	for (i = 0; i < DM_TYPE_END; i++) {
-		if (!exynos_dm->dm_data[i].available)
-			continue;
-
-		constraint_list = get_min_constraint_list(&exynos_dm->dm_data[i]);
-		if (list_empty(constraint_list))
-			continue;
-		list_for_each_entry(constraint, constraint_list, node) {
-			if (constraint->constraint_dm_type == dm_type)
-				min_freq = max(min_freq, constraint->min_freq);
-		}
+	for (i = 0; i < dm->nr_min_bound; i++) {
+		bound = &dm->min_bound[i];
+		if (exynos_dm->dm_data[bound->master].available)
+			min_freq = max(min_freq, bound->constraint->min_freq);
 	}
-	for (i = 0; i < DM_TYPE_END; i++) {
-		if (!exynos_dm->dm_data[i].available)
-			continue;
-
-		constraint_list = get_max_constraint_list(&exynos_dm->dm_data[i]);
-		if (list_empty(constraint_list))
-			continue;
-		list_for_each_entry(constraint, constraint_list, node) {
-			if (constraint->constraint_dm_type == dm_type)
-				max_freq = min(max_freq, constraint->max_freq);
-		}
+	for (i = 0; i < dm->nr_max_bound; i++) {
+		bound = &dm->max_bound[i];
+		if (exynos_dm->dm_data[bound->master].available)
+			max_freq = min(max_freq, bound->constraint->max_freq);
 	}
 
 	min_freq = max(min_freq, dm->gov_min_freq); //MIN freq should be checked with gov_min_freq
@@ -917,6 +1002,33 @@ int policy_update_with_DM_CALL(enum exynos_dm_type dm_type, u32 min_freq, u32 ma
 	return ret;
 }
 
+/*
+ * The DVFS benchmark sweeps a domain through the frequencies CAL knows
+ * for it and puts it back to where its governor left it afterwards.
+ */
+int exynos_dm_get_domain_info(enum exynos_dm_type dm_type, u32 *cal_id, u32 *gov_min_freq)
+{
+	struct exynos_dm_data *dm;
+
+	if (!exynos_dm || exynos_dm_index_validate(dm_type))
+		return -ENODEV;
+
+	dm = &exynos_dm->dm_data[dm_type];
+	if (!dm->available)
+		return -ENODEV;
+
+	mutex_lock(&exynos_dm->lock);
+#ifdef CONFIG_EXYNOS_ACPM
+	*cal_id = dm->cal_id;
+#else
+	*cal_id = 0;
+#endif
+	*gov_min_freq = dm->gov_min_freq;
+	mutex_unlock(&exynos_dm->lock);
+
+	return 0;
+}
+
 static int constraint_data_updater(enum exynos_dm_type dm_type, int cnt)
 {
 	struct exynos_dm_data *dm;
@@ -989,6 +1101,17 @@ static int max_constraint_data_updater(enum exynos_dm_type dm_type, int cnt)
 	return 0;
 }
 
+static void dm_scale(struct exynos_dm_data *dm, unsigned int relation)
+{
+	if (!dm->freq_scaler)
+		return;
+
+	/* Related domains whose target did not move are left alone */
+	if (dm->target_freq != dm->cur_freq)
+		dm->freq_scaler(dm->dm_type, dm->target_freq, relation);
+	dm->cur_freq = dm->target_freq;
+}
+
 /*
  * Scaling Callback
  * Call callback function in each DVFS drivers to scaling frequency
@@ -998,6 +1121,13 @@ static int scaling_callback(enum dvfs_direction dir, unsigned int relation)
 	struct exynos_dm_data *dm;
 	int i;
 
+	/*
+	 * Frequency changes of ACPM managed domains requested by the
+	 * scalers below are collected and sent to ACPM at once, in the
+	 * order they were requested.
+	 */
+	cal_dfs_batch_begin();
+
 	switch (dir) {
 	case DOWN:
 		if (min_order[0] == 0 && max_flag == false) {
@@ -1007,10 +1137,7 @@ static int scaling_callback(enum dvfs_direction dir, unsigned int relation)
 
 				dm = &exynos_dm->dm_data[min_order[i]];
 				if (dm->constraint_checked) {
-					if (dm->freq_scaler) {
-						dm->freq_scaler(dm->dm_type, dm->target_freq, relation);
-						dm->cur_freq = dm->target_freq;
-					}
+					dm_scale(dm, relation);
 					dm->constraint_checked = 0;
 				}
 			}
@@ -1021,10 +1148,7 @@ static int scaling_callback(enum dvfs_direction dir, unsigned int relation)
 
 				dm = &exynos_dm->dm_data[max_order[i]];
 				if (dm->constraint_checked) {
-					if (dm->freq_scaler) {
-						dm->freq_scaler(dm->dm_type, dm->target_freq, relation);
-						dm->cur_freq = dm->target_freq;
-					}
+					dm_scale(dm, relation);
 					dm->constraint_checked = 0;
 				}
 			}
@@ -1038,10 +1162,7 @@ static int scaling_callback(enum dvfs_direction dir, unsigned int relation)
 
 				dm = &exynos_dm->dm_data[min_order[i]];
 				if (dm->constraint_checked) {
-					if (dm->freq_scaler) {
-						dm->freq_scaler(dm->dm_type, dm->target_freq, relation);
-						dm->cur_freq = dm->target_freq;
-					}
+					dm_scale(dm, relation);
 					dm->constraint_checked = 0;
 				}
 			}
@@ -1052,10 +1173,7 @@ static int scaling_callback(enum dvfs_direction dir, unsigned int relation)
 
 				dm = &exynos_dm->dm_data[max_order[i]];
 				if (dm->constraint_checked) {
-					if (dm->freq_scaler) {
-						dm->freq_scaler(dm->dm_type, dm->target_freq, relation);
-						dm->cur_freq = dm->target_freq;
-					}
+					dm_scale(dm, relation);
 					dm->constraint_checked = 0;
 				}
 			}
@@ -1071,14 +1189,13 @@ static int scaling_callback(enum dvfs_direction dir, unsigned int relation)
 
 		dm = &exynos_dm->dm_data[min_order[i]];
 		if (dm->constraint_checked) {
-			if (dm->freq_scaler) {
-				dm->freq_scaler(dm->dm_type, dm->target_freq, relation);
-				dm->cur_freq = dm->target_freq;
-			}
+			dm_scale(dm, relation);
 			dm->constraint_checked = 0;
 		}
 	}
 
+	cal_dfs_batch_commit();
+
 	max_flag = false;
 
 	return 0;
@@ -0,0 +1,325 @@
+/*
+ * Exynos DVFS transition latency benchmark
+ *
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Writing the name of a DVFS manager domain, e.g. "dm_mif", to
+ * <debugfs>/exynos-dvfs-bench/run moves the domain from every frequency
+ * of its CAL table to every other one through DM_CALL(), and records how
+ * long each phase of the change took. Governors keep running meanwhile,
+ * so pin them (userspace or performance) to get clean numbers. The
+ * domain is handed back to the frequency its governor last asked for.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/slab.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+
+#include <soc/samsung/cal-if.h>
+#include <soc/samsung/exynos-dm.h>
+#include <soc/samsung/exynos-dvfs-bench.h>
+
+#define DVFS_BENCH_PREFIX	"EXYNOS-DVFS-BENCH:"
+
+/* bucket 0 counts changes under 1us, bucket n those under 2^n us */
+#define DVFS_BENCH_NR_BUCKETS	16
+#define DVFS_BENCH_MAX_LV	32
+
+static const char *phase_name[DVFS_BENCH_PHASE_END] = {
+	"total",
+	"dm_constraint",
+	"dm_scale",
+	"cpu_scale",
+	"acpm_ipc",
+	"devfreq_prepare",
+	"devfreq_set",
+	"devfreq_post",
+};
+
+struct dvfs_bench_hist {
+	u64 count;
+	u64 sum_ns;
+	u64 min_ns;
+	u64 max_ns;
+	u32 bucket[DVFS_BENCH_NR_BUCKETS];
+};
+
+struct dvfs_bench_domain {
+	bool valid;
+	unsigned int nr_lv;
+	unsigned int iterations;
+	unsigned long freq[DVFS_BENCH_MAX_LV];
+	struct dvfs_bench_hist hist[DVFS_BENCH_PHASE_END];
+	/* mean total latency of each from -> to pair, in ns */
+	u64 pair_ns[DVFS_BENCH_MAX_LV][DVFS_BENCH_MAX_LV];
+};
+
+static struct dvfs_bench {
+	struct mutex lock;		/* one sweep at a time */
+	spinlock_t hist_lock;
+	enum exynos_dm_type cur;	/* domain receiving the samples */
+	unsigned int iterations;
+	struct dvfs_bench_domain *domain[DM_TYPE_END];
+	struct dentry *root;
+} bench = {
+	.lock = __MUTEX_INITIALIZER(bench.lock),
+	.hist_lock = __SPIN_LOCK_UNLOCKED(bench.hist_lock),
+	.iterations = 10,
+};
+
+bool exynos_dvfs_bench_recording;
+
+static void dvfs_bench_hist_add(struct dvfs_bench_hist *hist, u64 ns)
+{
+	unsigned long us = (unsigned long)div_u64(ns, NSEC_PER_USEC);
+	unsigned int idx = min_t(unsigned int, fls_long(us),
+				 DVFS_BENCH_NR_BUCKETS - 1);
+
+	if (!hist->count || ns < hist->min_ns)
+		hist->min_ns = ns;
+	if (ns > hist->max_ns)
+		hist->max_ns = ns;
+	hist->count++;
+	hist->sum_ns += ns;
+	hist->bucket[idx]++;
+}
+
+void exynos_dvfs_bench_record(enum exynos_dvfs_bench_phase phase,
+			      u64 start_ns, u64 end_ns)
+{
+	struct dvfs_bench_domain *domain;
+	unsigned long flags;
+
+	/* recording started or stopped in the middle of this phase */
+	if (!start_ns || end_ns < start_ns)
+		return;
+
+	spin_lock_irqsave(&bench.hist_lock, flags);
+	domain = bench.domain[bench.cur];
+	if (domain && READ_ONCE(exynos_dvfs_bench_recording))
+		dvfs_bench_hist_add(&domain->hist[phase], end_ns - start_ns);
+	spin_unlock_irqrestore(&bench.hist_lock, flags);
+}
+
+static void dvfs_bench_set_recording(bool on)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&bench.hist_lock, flags);
+	WRITE_ONCE(exynos_dvfs_bench_recording, on);
+	spin_unlock_irqrestore(&bench.hist_lock, flags);
+}
+
+static int dvfs_bench_sweep(enum exynos_dm_type dm_type)
+{
+	struct dvfs_bench_domain *domain;
+	unsigned long freq;
+	u32 cal_id, restore_freq;
+	unsigned int iterations = max(READ_ONCE(bench.iterations), 1U);
+	unsigned int nr_lv, from, to, i;
+	u64 start, end, sum;
+	int ret;
+
+	ret = exynos_dm_get_domain_info(dm_type, &cal_id, &restore_freq);
+	if (ret)
+		return ret;
+	if (!cal_id)
+		return -EINVAL;
+
+	/* CAL fills in the whole table, it has to fit */
+	nr_lv = cal_dfs_get_lv_num(cal_id);
+	if (nr_lv < 2 || nr_lv > DVFS_BENCH_MAX_LV)
+		return -EINVAL;
+
+	domain = bench.domain[dm_type];
+	if (!domain) {
+		domain = kzalloc(sizeof(*domain), GFP_KERNEL);
+		if (!domain)
+			return -ENOMEM;
+	} else {
+		memset(domain, 0, sizeof(*domain));
+	}
+
+	domain->nr_lv = nr_lv;
+	domain->iterations = iterations;
+	if (cal_dfs_get_rate_table(cal_id, domain->freq) != nr_lv) {
+		kfree(domain);
+		bench.domain[dm_type] = NULL;
+		return -EINVAL;
+	}
+
+	spin_lock_irq(&bench.hist_lock);
+	bench.domain[dm_type] = domain;
+	bench.cur = dm_type;
+	spin_unlock_irq(&bench.hist_lock);
+
+	for (from = 0; from < domain->nr_lv; from++) {
+		for (to = 0; to < domain->nr_lv; to++) {
+			if (from == to)
+				continue;
+
+			sum = 0;
+			for (i = 0; i < iterations; i++) {
+				freq = domain->freq[from];
+				DM_CALL(dm_type, &freq);
+
+				freq = domain->freq[to];
+				dvfs_bench_set_recording(true);
+				start = sched_clock();
+				ret = DM_CALL(dm_type, &freq);
+				end = sched_clock();
+				exynos_dvfs_bench_record(DVFS_BENCH_TOTAL,
+							 start, end);
+				dvfs_bench_set_recording(false);
+				if (ret)
+					goto out;
+
+				sum += end - start;
+			}
+			domain->pair_ns[from][to] = div_u64(sum, iterations);
+
+			cond_resched();
+		}
+	}
+	domain->valid = true;
+
+out:
+	freq = restore_freq;
+	DM_CALL(dm_type, &freq);
+
+	if (ret)
+		pr_err("%s %s: %s failed (%d)\n", DVFS_BENCH_PREFIX, __func__,
+				dm_type_name[dm_type], ret);
+
+	return ret;
+}
+
+static ssize_t dvfs_bench_run_write(struct file *file,
+		const char __user *user_buf, size_t count, loff_t *ppos)
+{
+	char buf[EXYNOS_DM_TYPE_NAME_LEN];
+	enum exynos_dm_type dm_type;
+	int ret;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, user_buf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+	strim(buf);
+
+	for (dm_type = 0; dm_type < DM_TYPE_END; dm_type++)
+		if (!strcmp(buf, dm_type_name[dm_type]))
+			break;
+	if (dm_type == DM_TYPE_END)
+		return -EINVAL;
+
+	mutex_lock(&bench.lock);
+	ret = dvfs_bench_sweep(dm_type);
+	mutex_unlock(&bench.lock);
+
+	return ret ? ret : count;
+}
+
+static const struct file_operations dvfs_bench_run_fops = {
+	.open = simple_open,
+	.write = dvfs_bench_run_write,
+	.llseek = default_llseek,
+};
+
+static void dvfs_bench_show_domain(struct seq_file *s,
+		enum exynos_dm_type dm_type, struct dvfs_bench_domain *domain)
+{
+	struct dvfs_bench_hist *hist;
+	unsigned int phase, i, from, to;
+
+	seq_printf(s, "[%s] %u levels, %u iterations per pair\n",
+			dm_type_name[dm_type], domain->nr_lv, domain->iterations);
+
+	for (phase = 0; phase < DVFS_BENCH_PHASE_END; phase++) {
+		hist = &domain->hist[phase];
+		if (!hist->count)
+			continue;
+
+		seq_printf(s, "  %-16s count %llu min %llu avg %llu max %llu (ns)\n",
+				phase_name[phase], hist->count, hist->min_ns,
+				div64_u64(hist->sum_ns, hist->count),
+				hist->max_ns);
+		seq_puts(s, "   ");
+		for (i = 0; i < DVFS_BENCH_NR_BUCKETS - 1; i++)
+			if (hist->bucket[i])
+				seq_printf(s, " <%luus:%u", 1UL << i,
+						hist->bucket[i]);
+		if (hist->bucket[i])
+			seq_printf(s, " >=%luus:%u", 1UL << (i - 1),
+					hist->bucket[i]);
+		seq_putc(s, '\n');
+	}
+
+	seq_puts(s, "  mean total latency (us), from \\ to\n");
+	seq_printf(s, "  %8s", "");
+	for (to = 0; to < domain->nr_lv; to++)
+		seq_printf(s, " %8lu", domain->freq[to]);
+	seq_putc(s, '\n');
+	for (from = 0; from < domain->nr_lv; from++) {
+		seq_printf(s, "  %8lu", domain->freq[from]);
+		for (to = 0; to < domain->nr_lv; to++)
+			seq_printf(s, " %8llu",
+				div_u64(domain->pair_ns[from][to], NSEC_PER_USEC));
+		seq_putc(s, '\n');
+	}
+}
+
+static int dvfs_bench_results_show(struct seq_file *s, void *unused)
+{
+	enum exynos_dm_type dm_type;
+
+	mutex_lock(&bench.lock);
+	for (dm_type = 0; dm_type < DM_TYPE_END; dm_type++)
+		if (bench.domain[dm_type] && bench.domain[dm_type]->valid)
+			dvfs_bench_show_domain(s, dm_type, bench.domain[dm_type]);
+	mutex_unlock(&bench.lock);
+
+	return 0;
+}
+
+static int dvfs_bench_results_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dvfs_bench_results_show, inode->i_private);
+}
+
+static const struct file_operations dvfs_bench_results_fops = {
+	.open = dvfs_bench_results_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int __init exynos_dvfs_bench_init(void)
+{
+	bench.root = debugfs_create_dir("exynos-dvfs-bench", NULL);
+	if (!bench.root) {
+		pr_err("%s %s: could not create debugfs dir\n",
+				DVFS_BENCH_PREFIX, __func__);
+		return -ENOMEM;
+	}
+
+	debugfs_create_u32("iterations", 0644, bench.root, &bench.iterations);
+	debugfs_create_file("run", 0200, bench.root, NULL, &dvfs_bench_run_fops);
+	debugfs_create_file("results", 0444, bench.root, NULL,
+			&dvfs_bench_results_fops);
+
+	return 0;
+}
+late_initcall(exynos_dvfs_bench_init);
@@ -29,7 +29,7 @@
 
 #define DEFAULT_BOOT_ENABLE_MS (40000)		/* 40 s */
 #define NUM_OF_GROUP	2
-#define ATTR_COUNT	14
+#define ATTR_COUNT	15
 
 #define LIT	0
 #define BIG	1
@@ -52,6 +52,7 @@ struct hpgov_attrib {
 	struct kobj_attribute	ldsum_heavy_thr;
 	struct kobj_attribute	cl_busy_ratio;
 	struct kobj_attribute	user_mode;
+	struct kobj_attribute	park_enabled;
 
 	struct attribute_group	attrib_group;
 };
@@ -88,7 +89,8 @@ struct {
 	int				ldsum_enabled;
 	int				change_ms;
 	int				cl_busy_ratio;
-	
+	int				park_enabled;
+
 	unsigned long			pol_max;
 	unsigned long			qos_max;
 
@@ -386,6 +388,33 @@ static void exynos_hpgov_irq_work(struct irq_work *irq_work)
 	start_slack_timer();
 }
 
+/**********************************************************************************/
+/*				Core parking					  */
+/**********************************************************************************/
+/*
+ * With park_enabled, big cpus beyond cur_cpu_min are parked instead of
+ * hotplugged out: the scheduler keeps them off the wakeup and balancing
+ * paths, so they drain and stay in their deepest idle state. Unparking is a
+ * mask update and a reschedule IPI instead of a trip through cpu_up().
+ * The big cluster stays online, so its max frequency stays at the QUAD limit.
+ */
+struct cpumask exynos_hpgov_parked_mask;
+
+static void exynos_hpgov_update_parked(unsigned int cpu_min)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		bool park = exynos_hpgov.park_enabled && cpu >= cpu_min &&
+			!cpumask_test_cpu(cpu, cpu_coregroup_mask(0));
+
+		if (park)
+			cpumask_set_cpu(cpu, &exynos_hpgov_parked_mask);
+		else if (cpumask_test_and_clear_cpu(cpu, &exynos_hpgov_parked_mask))
+			wake_up_if_idle(cpu);
+	}
+}
+
 static int exynos_hpgov_do_update_governor(void *data)
 {
 	struct hpgov_data *pdata = (struct hpgov_data *)data;
@@ -402,6 +431,11 @@ static int exynos_hpgov_do_update_governor(void *data)
 		pdata->event = 0;
 		spin_unlock_irqrestore(&hpgov_lock, flags);
 
+		if (exynos_hpgov.park_enabled) {
+			exynos_hpgov_update_parked(exynos_hpgov.cur_cpu_min);
+			continue;
+		}
+
 		exynos_hpgov_control_cpuidle(exynos_hpgov.cur_cpu_min);
 		trace_hpgov_req_hotplug(FAST_HP, exynos_hpgov.cur_cpu_min);
 		pm_qos_update_request_param(&hpgov_min_pm_qos,
@@ -416,6 +450,7 @@ static void __exynos_hpgov_set_disable(void)
 	if (exynos_hpgov.task)
 		kthread_stop(exynos_hpgov.task);
 
+	exynos_hpgov_update_parked(NR_CPUS);
 	pm_qos_update_request(&hpgov_min_pm_qos, PM_QOS_CPU_ONLINE_MAX_DEFAULT_VALUE);
 
 	pr_info("HP_GOV: Stop hotplug governor\n");
@@ -834,6 +869,34 @@ static int exynos_hpgov_set_user_mode(int val)
 	return 0;
 }
 
+static int exynos_hpgov_set_park_enabled(int val)
+{
+	long use_fast_hp = FAST_HP;
+
+	exynos_hpgov.park_enabled = !!val;
+
+	if (!exynos_hpgov.enabled)
+		return 0;
+
+	/*
+	 * Parking needs the whole big cluster online, and leaving park mode
+	 * hands the current mode back to cpu hotplug.
+	 */
+	if (exynos_hpgov.park_enabled) {
+		pm_qos_update_request_param(&hpgov_min_pm_qos,
+				PM_QOS_CPU_ONLINE_MAX_DEFAULT_VALUE, (void *)&use_fast_hp);
+		exynos_hpgov_control_cpuidle(PM_QOS_CPU_ONLINE_MAX_DEFAULT_VALUE);
+		exynos_hpgov_update_parked(exynos_hpgov.cur_cpu_min);
+	} else {
+		exynos_hpgov_update_parked(NR_CPUS);
+		exynos_hpgov_control_cpuidle(exynos_hpgov.cur_cpu_min);
+		pm_qos_update_request_param(&hpgov_min_pm_qos,
+				exynos_hpgov.cur_cpu_min, (void *)&use_fast_hp);
+	}
+
+	return 0;
+}
+
 static int exynos_hpgov_set_cl_busy_ratio(int val)
 {
 	if (!(val >= 0))
@@ -987,6 +1050,7 @@ HPGOV_PARAM(cl_busy_ratio, exynos_hpgov.cl_busy_ratio);
 HPGOV_PARAM(single_change_ms, exynos_hpgov.single_change_ms);
 HPGOV_PARAM(dual_change_ms, exynos_hpgov.dual_change_ms);
 HPGOV_PARAM(quad_change_ms, exynos_hpgov.quad_change_ms);
+HPGOV_PARAM(park_enabled, exynos_hpgov.park_enabled);
 
 static void hpgov_boot_enable(struct work_struct *work);
 static DECLARE_DELAYED_WORK(hpgov_boot_work, hpgov_boot_enable);
@@ -1181,6 +1245,7 @@ static int __init exynos_hpgov_init(void)
 	HPGOV_RW_ATTRIB(attr_count - (i_attr--), single_change_ms);
 	HPGOV_RW_ATTRIB(attr_count - (i_attr--), dual_change_ms);
 	HPGOV_RW_ATTRIB(attr_count - (i_attr--), quad_change_ms);
+	HPGOV_RW_ATTRIB(attr_count - (i_attr--), park_enabled);
 
 	exynos_hpgov.attrib.attrib_group.name = "governor";
 	ret = sysfs_create_group(exynos_cpu_hotplug_kobj(),
@@ -100,6 +100,14 @@ struct exynos_ocp_data {
 	unsigned int		release_mode;
 	unsigned int		release_threshold;
 	unsigned int		release_duration;
+
+	/* predictive limiter */
+	bool			predict_enabled;
+	unsigned int		predict_margin;
+	unsigned int		predict_period;
+	unsigned long		predict_threshold;
+	unsigned int		advisory_freq;
+	struct delayed_work	predict_work;
 };
 struct exynos_ocp_data *data;
 
@@ -283,6 +291,98 @@ static void control_ocp_operation(bool enable)
 	exynos_ss_printk("OCP_%s\n", (enable)?"enabled":"disabled");
 }
 
+/****************************************************************/
+/*			PREDICTIVE LIMITER			*/
+/****************************************************************/
+
+/*
+ * The current of the cluster is estimated as the sum over its cpus of
+ * the frequency each one would be busy at, in kHz. The load seen when
+ * OCP trips sets the threshold, and before it trips again schedutil is
+ * given the highest frequency whose estimated load stays under it, so
+ * performance goes down a step at a time instead of falling off a cliff.
+ */
+#define DEFAULT_PREDICT_MARGIN		(90)
+#define DEFAULT_PREDICT_PERIOD		(20)
+
+static unsigned long ocp_estimate_load(unsigned int freq)
+{
+	unsigned long capacity = capacity_orig_of(data->cpu);
+	unsigned long load = 0, busy;
+	unsigned int cpu;
+
+	for_each_cpu_and(cpu, &data->cpus, cpu_online_mask) {
+		busy = cpu_util(cpu) * data->max_freq / capacity;
+		load += min_t(unsigned long, busy, freq);
+	}
+
+	return load;
+}
+
+static void ocp_predict_learn(void)
+{
+	unsigned long load;
+
+	load = ocp_estimate_load(data->cur_freq) * data->predict_margin / ONE_HUNDRED;
+	if (!load)
+		return;
+
+	if (data->predict_threshold)
+		data->predict_threshold = (data->predict_threshold + load) / 2;
+	else
+		data->predict_threshold = load;
+}
+
+static void set_ocp_advisory_freq(unsigned int freq)
+{
+	if (data->advisory_freq == freq)
+		return;
+
+	data->advisory_freq = freq;
+	sugov_set_freq_ceiling(&data->cpus, freq < data->max_freq ? freq : 0);
+	pr_debug("OCP advisory max is set to %u kHz\n", freq);
+}
+
+static void exynos_ocp_predict_work(struct work_struct *work)
+{
+	struct ocp_stats *stats = data->stats;
+	unsigned int index, freq = data->max_freq;
+
+	if (data->enabled && data->predict_threshold && stats) {
+		/* freq_table is in descending order */
+		for (index = 0; index < stats->max_state; index++) {
+			freq = stats->freq_table[index];
+			if (freq > data->max_freq)
+				continue;
+			if (freq <= data->max_freq_wo_ocp ||
+			    ocp_estimate_load(freq) <= data->predict_threshold)
+				break;
+		}
+	}
+
+	set_ocp_advisory_freq(freq);
+
+	if (data->predict_enabled)
+		schedule_delayed_work(&data->predict_work,
+				msecs_to_jiffies(data->predict_period));
+}
+
+static void control_ocp_predict(bool enable)
+{
+	if (data->predict_enabled == enable)
+		return;
+
+	data->predict_enabled = enable;
+
+	if (enable) {
+		schedule_delayed_work(&data->predict_work,
+				msecs_to_jiffies(data->predict_period));
+	} else {
+		cancel_delayed_work_sync(&data->predict_work);
+		set_ocp_advisory_freq(data->max_freq);
+	}
+}
+
 /****************************************************************/
 /*			OCP INTERRUPT HANDLER			*/
 /****************************************************************/
@@ -335,6 +435,7 @@ static void exynos_ocp_work(struct work_struct *work)
 	if (check_ocp_interrupt()) {
 		data->flag = true;
 		clear_ocp_interrupt();
+		ocp_predict_learn();
 		set_ocp_max_limit(data->down_step);
 	}
 
@@ -566,6 +667,79 @@ time_in_state_show(struct device *dev, struct device_attribute *devattr,
 	return len;
 }
 
+static ssize_t
+predict_enabled_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%d\n", data->predict_enabled);
+}
+
+static ssize_t
+predict_enabled_store(struct device *dev, struct device_attribute *devattr,
+			const char *buf, size_t count)
+{
+	unsigned int input;
+
+	if (kstrtou32(buf, 10, &input))
+		return -EINVAL;
+
+	control_ocp_predict(!!input);
+
+	return count;
+}
+
+static ssize_t
+predict_threshold_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%lu\n", data->predict_threshold);
+}
+
+static ssize_t
+predict_threshold_store(struct device *dev, struct device_attribute *devattr,
+			const char *buf, size_t count)
+{
+	unsigned long input;
+
+	if (kstrtoul(buf, 10, &input))
+		return -EINVAL;
+
+	data->predict_threshold = input;
+
+	return count;
+}
+
+static ssize_t
+predict_margin_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%d\n", data->predict_margin);
+}
+
+static ssize_t
+predict_margin_store(struct device *dev, struct device_attribute *devattr,
+			const char *buf, size_t count)
+{
+	unsigned int input;
+
+	if (kstrtou32(buf, 10, &input))
+		return -EINVAL;
+
+	if (!input || input > ONE_HUNDRED)
+		return -EINVAL;
+
+	data->predict_margin = input;
+
+	return count;
+}
+
+static ssize_t
+advisory_freq_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%d\n", data->advisory_freq);
+}
+
 static DEVICE_ATTR(enabled, 0644, ocp_enable_show, ocp_enable_store);
 static DEVICE_ATTR(ocp_flag, 0444, ocp_flag_show, NULL);
 static DEVICE_ATTR(down_step, 0644, down_step_show, down_step_store);
@@ -575,6 +749,10 @@ static DEVICE_ATTR(release_duration, 0644, release_duration_show, release_durati
 static DEVICE_ATTR(clipped_freq, 0444, clipped_freq_show, NULL);
 static DEVICE_ATTR(total_trans, 0444, total_trans_show, NULL);
 static DEVICE_ATTR(time_in_state, 0444, time_in_state_show, NULL);
+static DEVICE_ATTR(predict_enabled, 0644, predict_enabled_show, predict_enabled_store);
+static DEVICE_ATTR(predict_threshold, 0644, predict_threshold_show, predict_threshold_store);
+static DEVICE_ATTR(predict_margin, 0644, predict_margin_show, predict_margin_store);
+static DEVICE_ATTR(advisory_freq, 0444, advisory_freq_show, NULL);
 
 static struct attribute *exynos_ocp_attrs[] = {
 	&dev_attr_enabled.attr,
@@ -586,6 +764,10 @@ static struct attribute *exynos_ocp_attrs[] = {
 	&dev_attr_clipped_freq.attr,
 	&dev_attr_total_trans.attr,
 	&dev_attr_time_in_state.attr,
+	&dev_attr_predict_enabled.attr,
+	&dev_attr_predict_threshold.attr,
+	&dev_attr_predict_margin.attr,
+	&dev_attr_advisory_freq.attr,
 	NULL,
 };
 
@@ -613,6 +795,11 @@ static int ocp_dt_parsing(struct device_node *dn)
 	if (ret)
 		return ret;
 
+	if (of_property_read_u32(dn, "predict-margin", &data->predict_margin))
+		data->predict_margin = DEFAULT_PREDICT_MARGIN;
+	if (of_property_read_u32(dn, "predict-period", &data->predict_period))
+		data->predict_period = DEFAULT_PREDICT_PERIOD;
+
 	cpulist_parse(buf, &data->cpus);
 	cpumask_and(&data->cpus, &data->cpus, cpu_possible_mask);
 	if (cpumask_weight(&data->cpus) == 0)
@@ -691,6 +878,7 @@ static int exynos_ocp_probe(struct platform_device *pdev)
 	data->min_freq = policy->user_policy.min;
 	data->max_freq = policy->user_policy.max;
 	data->clipped_freq = data->max_freq;
+	data->advisory_freq = data->max_freq;
 	ocp_stats_create_table(policy);
 
 	cpufreq_cpu_put(policy);
@@ -714,6 +902,7 @@ static int exynos_ocp_probe(struct platform_device *pdev)
 	INIT_WORK(&data->work, exynos_ocp_work);
 	INIT_DELAYED_WORK(&data->delayed_work, exynos_ocp_work_release);
 	init_irq_work(&data->irq_work, exynos_ocp_irq_work);
+	INIT_DEFERRABLE_WORK(&data->predict_work, exynos_ocp_predict_work);
 
 	get_s2mps18_i2c(&data->i2c);
 	if (data->i2c == NULL) {
@@ -725,6 +914,8 @@ static int exynos_ocp_probe(struct platform_device *pdev)
 	if (ret)
 		dev_err(&pdev->dev, "Failed to create Exynos OCP attr group");
 
+	control_ocp_predict(!of_property_read_bool(dn, "predict-disabled"));
+
 	dev_info(&pdev->dev, "Complete OCP Handler initialization\n");
 	return 0;
 }
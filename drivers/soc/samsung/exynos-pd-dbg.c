@@ -79,6 +79,7 @@ static void exynos_pd_dbg_summary_show(struct generic_pm_domain *genpd)
 		[RPM_SUSPENDING] = "suspending"
 	};
 	const char *p = "";
+	struct exynos_pm_domain *pd;
 	struct pm_domain_data *pm_data;
 	struct gpd_link *link;
 
@@ -93,6 +94,24 @@ static void exynos_pd_dbg_summary_show(struct generic_pm_domain *genpd)
 	pr_info("[GENPD] : %-30s [GPD_STATUS] : %-15s\n",
 			genpd->name, gpd_status_lookup[genpd->status]);
 
+	pd = exynos_pd_from_genpd(genpd);
+	if (pd && pd->pd_control) {
+		pr_info("\t[ON] : %lu times, latency avg %llu max %llu ns\n",
+				pd->stat.on_cnt,
+				pd->stat.on_cnt ? div64_u64(pd->stat.on_lat_total_ns,
+					pd->stat.on_cnt) : 0,
+				pd->stat.on_lat_max_ns);
+		pr_info("\t[OFF] : %lu times, latency avg %llu max %llu ns\n",
+				pd->stat.off_cnt,
+				pd->stat.off_cnt ? div64_u64(pd->stat.off_lat_total_ns,
+					pd->stat.off_cnt) : 0,
+				pd->stat.off_lat_max_ns);
+		pr_info("\t[OFF DELAY] : %u ms (max %u ms), idle gap avg %llu ns, %lu offs avoided%s\n",
+				pd->off_delay_ms, pd->off_delay_max_ms,
+				pd->idle_gap_avg_ns, pd->stat.off_avoided,
+				pd->off_pending ? ", off pending" : "");
+	}
+
 	list_for_each_entry(pm_data, &genpd->dev_list, list_node) {
 		if (pm_data->dev->power.runtime_error)
 			p = "error";
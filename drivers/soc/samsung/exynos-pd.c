@@ -17,6 +17,15 @@
 #include <soc/samsung/cal-if.h>
 #include <linux/apm-exynos.h>
 #include <soc/samsung/acpm_mfd.h>
+#include <linux/suspend.h>
+#include <linux/moduleparam.h>
+
+static int exynos_pd_power_off(struct generic_pm_domain *genpd);
+
+/* bound of the adaptive off delay of the domains not setting their own */
+static unsigned int off_delay_max_ms = 10;
+module_param(off_delay_max_ms, uint, 0444);
+
 struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name)
 {
 	struct exynos_pm_domain *exypd = NULL;
@@ -44,6 +53,24 @@ struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name)
 }
 EXPORT_SYMBOL(exynos_pd_lookup_name);
 
+struct exynos_pm_domain *exynos_pd_from_genpd(struct generic_pm_domain *genpd)
+{
+	if (genpd->power_off != exynos_pd_power_off)
+		return NULL;
+
+	return container_of(genpd, struct exynos_pm_domain, genpd);
+}
+EXPORT_SYMBOL(exynos_pd_from_genpd);
+
+static void exynos_pd_stat_latency(u64 *total, u64 *max, ktime_t start)
+{
+	u64 lat = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	*total += lat;
+	if (lat > *max)
+		*max = lat;
+}
+
 static int exynos_pd_status(struct exynos_pm_domain *pd)
 {
 	int status;
@@ -107,6 +134,7 @@ static void exynos_pd_prepare_forced_off(struct exynos_pm_domain *pd)
 static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 {
 	struct exynos_pm_domain *pd = container_of(genpd, struct exynos_pm_domain, genpd);
+	ktime_t start;
 	int ret = 0;
 
 	mutex_lock(&pd->access_lock);
@@ -123,8 +151,26 @@ static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 		goto acc_unlock;
 	}
 
+	if (pd->off_delay_max_ms && pd->off_req_time.tv64) {
+		u64 gap = ktime_to_ns(ktime_sub(ktime_get(), pd->off_req_time));
+
+		/* 1/4 weight to the newest idle gap */
+		pd->idle_gap_avg_ns = pd->idle_gap_avg_ns ?
+			(pd->idle_gap_avg_ns * 3 + gap) >> 2 : gap;
+		pd->off_req_time.tv64 = 0;
+	}
+
+	if (pd->off_pending) {
+		/* still powered, the delayed off never happened */
+		pd->off_pending = false;
+		cancel_delayed_work(&pd->off_work);
+		pd->stat.off_avoided++;
+		goto acc_unlock;
+	}
+
 	exynos_pd_power_on_pre(pd);
 
+	start = ktime_get();
 	ret = pd->pd_control(pd->cal_pdid, 1);
 	if (ret) {
 		pr_err(EXYNOS_PD_PREFIX "%s cannot be powered on\n", pd->name);
@@ -132,6 +178,9 @@ static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 		ret = -EAGAIN;
 		goto acc_unlock;
 	}
+	exynos_pd_stat_latency(&pd->stat.on_lat_total_ns,
+			&pd->stat.on_lat_max_ns, start);
+	pd->stat.on_cnt++;
 
 	exynos_pd_power_on_post(pd);
 
@@ -142,6 +191,96 @@ static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 	return ret;
 }
 
+static void exynos_pd_flush_delayed_off(struct exynos_pm_domain *pd);
+
+/* Power domain off sequence, called with access_lock held. */
+static int __exynos_pd_power_off(struct exynos_pm_domain *pd)
+{
+	struct gpd_link *link;
+	ktime_t start;
+	int ret;
+
+	/* a child still powered by a delayed off must go down first */
+	list_for_each_entry(link, &pd->genpd.master_links, master_node) {
+		struct exynos_pm_domain *child = exynos_pd_from_genpd(link->slave);
+
+		if (child)
+			exynos_pd_flush_delayed_off(child);
+	}
+
+	exynos_pd_power_off_pre(pd);
+
+	start = ktime_get();
+	ret = pd->pd_control(pd->cal_pdid, 0);
+	if (unlikely(ret)) {
+		if (ret == -4) {
+			pr_err(EXYNOS_PD_PREFIX "Timed out during %s  power off! -> forced power off\n", pd->name);
+			exynos_pd_prepare_forced_off(pd);
+			ret = pd->pd_control(pd->cal_pdid, 0);
+			if (unlikely(ret)) {
+				pr_err(EXYNOS_PD_PREFIX "%s occur error at power off!\n", pd->name);
+				return ret;
+			}
+		} else {
+			pr_err(EXYNOS_PD_PREFIX "%s occur error at power off!\n", pd->name);
+			return ret;
+		}
+	}
+	exynos_pd_stat_latency(&pd->stat.off_lat_total_ns,
+			&pd->stat.off_lat_max_ns, start);
+	pd->stat.off_cnt++;
+
+	exynos_pd_power_off_post(pd);
+	pd->power_down_skipped = false;
+
+	return 0;
+}
+
+static void exynos_pd_flush_delayed_off(struct exynos_pm_domain *pd)
+{
+	mutex_lock_nested(&pd->access_lock, SINGLE_DEPTH_NESTING);
+	if (pd->off_pending) {
+		pd->off_pending = false;
+		cancel_delayed_work(&pd->off_work);
+		__exynos_pd_power_off(pd);
+	}
+	mutex_unlock(&pd->access_lock);
+}
+
+static void exynos_pd_off_work_fn(struct work_struct *work)
+{
+	struct exynos_pm_domain *pd = container_of(to_delayed_work(work),
+			struct exynos_pm_domain, off_work);
+
+	mutex_lock(&pd->access_lock);
+	if (pd->off_pending) {
+		pd->off_pending = false;
+		__exynos_pd_power_off(pd);
+	}
+	mutex_unlock(&pd->access_lock);
+}
+
+/*
+ * A domain whose users come back within a few ms is kept powered for a
+ * while instead: the delay follows the average of the recent idle gaps
+ * when it is below off_delay_max_ms, and is 0 when the gaps are long
+ * enough for the power down to pay off.
+ */
+static unsigned int exynos_pd_off_delay_ms(struct exynos_pm_domain *pd)
+{
+	u64 max_ns = (u64)pd->off_delay_max_ms * NSEC_PER_MSEC;
+	u64 delay_ns;
+
+	if (!pd->off_delay_max_ms || pd->genpd.prepared_count)
+		return 0;
+
+	if (!pd->idle_gap_avg_ns || pd->idle_gap_avg_ns >= max_ns)
+		return 0;
+
+	delay_ns = min(pd->idle_gap_avg_ns + (pd->idle_gap_avg_ns >> 1), max_ns);
+	return DIV_ROUND_UP_ULL(delay_ns, NSEC_PER_MSEC);
+}
+
 static int exynos_pd_power_off(struct generic_pm_domain *genpd)
 {
 	struct exynos_pm_domain *pd = container_of(genpd, struct exynos_pm_domain, genpd);
@@ -162,26 +301,18 @@ static int exynos_pd_power_off(struct generic_pm_domain *genpd)
 		goto acc_unlock;
 	}
 
-	exynos_pd_power_off_pre(pd);
+	if (pd->off_delay_max_ms)
+		pd->off_req_time = ktime_get();
 
-	ret = pd->pd_control(pd->cal_pdid, 0);
-	if (unlikely(ret)) {
-		if (ret == -4) {
-			pr_err(EXYNOS_PD_PREFIX "Timed out during %s  power off! -> forced power off\n", genpd->name);
-			exynos_pd_prepare_forced_off(pd);
-			ret = pd->pd_control(pd->cal_pdid, 0);
-			if (unlikely(ret)) {
-				pr_err(EXYNOS_PD_PREFIX "%s occur error at power off!\n", genpd->name);
-				goto acc_unlock;
-			}
-		} else {
-			pr_err(EXYNOS_PD_PREFIX "%s occur error at power off!\n", genpd->name);
-			goto acc_unlock;
-		}
+	pd->off_delay_ms = exynos_pd_off_delay_ms(pd);
+	if (pd->off_delay_ms) {
+		pd->off_pending = true;
+		queue_delayed_work(system_power_efficient_wq, &pd->off_work,
+				msecs_to_jiffies(pd->off_delay_ms));
+		goto acc_unlock;
 	}
 
-	exynos_pd_power_off_post(pd);
-	pd->power_down_skipped = false;
+	ret = __exynos_pd_power_off(pd);
 
 acc_unlock:
 	DEBUG_PRINT_INFO("%s(%s)-, ret = %d\n", __func__, pd->name, ret);
@@ -348,6 +479,11 @@ static __init int exynos_pd_dt_parse(void)
 
 		pd->idle_ip_index = exynos_get_idle_ip_index(pd->name);
 
+		if (of_property_read_u32(np, "off-delay-max-ms",
+					&pd->off_delay_max_ms))
+			pd->off_delay_max_ms = off_delay_max_ms;
+		INIT_DELAYED_WORK(&pd->off_work, exynos_pd_off_work_fn);
+
 		mutex_init(&pd->access_lock);
 		platform_set_drvdata(pdev, pd);
 
@@ -376,6 +512,7 @@ static __init int exynos_pd_dt_parse(void)
 			sub_pd->pd_control = NULL;
 
 			sub_pd->devfreq_index = of_get_devfreq_sync_volt_idx(sub_pd->of_node);
+			INIT_DELAYED_WORK(&sub_pd->off_work, exynos_pd_off_work_fn);
 
 			/* kernel does not create sub-domain pdev. */
 			sub_pdev = of_find_device_by_node(children);
@@ -446,6 +583,37 @@ static __init int exynos_pd_dt_parse(void)
 }
 #endif /* CONFIG_OF */
 
+/* delayed offs must not keep domains powered through system suspend */
+static int exynos_pd_pm_notifier(struct notifier_block *nb,
+		unsigned long event, void *data)
+{
+	struct device_node *np;
+
+	if (event != PM_SUSPEND_PREPARE)
+		return NOTIFY_DONE;
+
+	for_each_compatible_node(np, NULL, "samsung,exynos-pd") {
+		struct platform_device *pdev;
+		struct exynos_pm_domain *pd;
+
+		if (!of_device_is_available(np))
+			continue;
+
+		pdev = of_find_device_by_node(np);
+		if (!pdev)
+			continue;
+		pd = platform_get_drvdata(pdev);
+		if (pd && pd->off_delay_max_ms)
+			exynos_pd_flush_delayed_off(pd);
+	}
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block exynos_pd_pm_nb = {
+	.notifier_call = exynos_pd_pm_notifier,
+};
+
 static int __init exynos_pd_init(void)
 {
 	int ret;
@@ -461,6 +629,8 @@ static int __init exynos_pd_init(void)
 		/* show information of power domain registration */
 		exynos_pd_show_power_domain();
 
+		register_pm_notifier(&exynos_pd_pm_nb);
+
 		return 0;
 	}
 #endif
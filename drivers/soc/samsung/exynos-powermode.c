@@ -396,8 +396,18 @@ static void update_c2_state(bool down, unsigned int cpu)
 		cpumask_clear_cpu(cpu, &pm_info->c2_mask);
 }
 
+/*
+ * Idle time of cpu, as predicted by the exynos idle governor from the
+ * wakeup history of that cpu. Without a prediction, fall back to the next
+ * timer event.
+ */
 static s64 get_next_event_time_us(unsigned int cpu)
 {
+	s64 predicted = exynos_idle_predicted_us(cpu);
+
+	if (predicted >= 0)
+		return predicted;
+
 	return ktime_to_us(tick_nohz_get_sleep_length());
 }
 
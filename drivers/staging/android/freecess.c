@@ -17,6 +17,7 @@
 #include <net/sock.h>
 #include <linux/hrtimer.h>
 #include <linux/proc_fs.h>
+#include <linux/cgroup.h>
 
 
 #define RET_OK   0
@@ -53,7 +54,8 @@ static char* mod_name[MOD_END] =
 	"MOD_BINDER",
 	"MOD_SIG",
 	"MOD_PKG",
-	"MOD_CFB"
+	"MOD_CFB",
+	"MOD_BATCH"
 };
 
 struct priv_data
@@ -324,7 +326,7 @@ static void recv_handler(struct sk_buff *skb)
 				break;
 			case MSG_TO_KERN:
 				if (mod_recv_handler[payload->mod])
-					mod_recv_handler[payload->mod](payload, sizeof(struct kfreecess_msg_data));
+					mod_recv_handler[payload->mod](payload, msglen);
 				else
 					dump_kfreecess_msg(payload);
 				break;
@@ -339,6 +341,105 @@ static void recv_handler(struct sk_buff *skb)
 	}
 }
 
+#ifdef CONFIG_CGROUP_FREEZER
+static int batch_sendmsg(struct kfreecess_batch_data *batch)
+{
+	int ret, msg_len = sizeof(struct kfreecess_batch_data);
+	struct sk_buff *skb = NULL;
+	struct nlmsghdr *nlh = NULL;
+
+	skb = nlmsg_new(msg_len, GFP_KERNEL);
+	if (!skb) {
+		pr_err("%s alloc_skb failed!\n", __func__);
+		return RET_ERR;
+	}
+
+	nlh = nlmsg_put(skb, 0, 0, 0, msg_len, 0);
+	if (!nlh) {
+		kfree_skb(skb);
+		return RET_ERR;
+	}
+	memcpy(nlmsg_data(nlh), batch, msg_len);
+
+	if ((ret = nlmsg_unicast(kfreecess_mod_sock, skb, batch->hdr.dst_portid)) < 0) {
+		pr_err("nlmsg_unicast failed! %s errno %d\n", __func__ , ret);
+		return RET_ERR;
+	}
+
+	return RET_OK;
+}
+
+/*
+ * Freeze or thaw a whole list of uids with one message: the processes are
+ * moved under a single hold of the cgroup locks instead of one cgroup.procs
+ * write per pid, and one aggregated reply goes back to the sender.
+ */
+static void kfreecess_batch_hook(void* data, unsigned int len)
+{
+	struct kfreecess_batch_data batch;
+	kuid_t uids[FREECESS_BATCH_MAX];
+	struct report_stat_s *stat;
+	u64 walltime, timecost;
+	unsigned long flags;
+	int i, ret;
+
+	if (len < sizeof(struct kfreecess_batch_data)) {
+		pr_err("%s: length err msglen %u!\n", __func__, len);
+		return;
+	}
+
+	walltime = ktime_to_us(ktime_get());
+	memcpy(&batch, data, sizeof(struct kfreecess_batch_data));
+	batch.path[FREECESS_PATH_LEN - 1] = '\0';
+	batch.nr_moved = 0;
+	batch.nr_failed = 0;
+	batch.error = 0;
+
+	if (batch.nr_uids <= 0 || batch.nr_uids > FREECESS_BATCH_MAX)
+		batch.error = -EINVAL;
+
+	//never touch system processes
+	for (i = 0; !batch.error && i < batch.nr_uids; i++) {
+		if (batch.uids[i] < UID_MIN_VALUE)
+			batch.error = -EPERM;
+		uids[i] = make_kuid(&init_user_ns, batch.uids[i]);
+	}
+
+	if (!batch.error) {
+		ret = cgroup_attach_uids(&freezer_cgrp_subsys, batch.path, uids,
+					 batch.nr_uids, &batch.nr_failed);
+		if (ret < 0)
+			batch.error = ret;
+		else
+			batch.nr_moved = ret;
+	}
+
+	batch.hdr.type = MSG_TO_USER;
+	batch.hdr.dst_portid = batch.hdr.src_portid;
+	batch.hdr.src_portid = KERNEL_ID_NETLINK;
+	ret = batch_sendmsg(&batch);
+
+	stat = &freecess_info.mod_reportstat[MOD_BATCH];
+	spin_lock_irqsave(&stat->lock, flags);
+	if (ret != RET_OK || batch.error) {
+		stat->data.report_fail_count++;
+		stat->data.report_fail_from_windowstart++;
+	} else {
+		stat->data.report_suc_count++;
+		stat->data.report_suc_from_windowstart++;
+	}
+
+	timecost = ktime_to_us(ktime_get()) - walltime;
+	stat->data.total_runtime += timecost;
+	stat->data.runtime_from_windowstart += timecost;
+	spin_unlock_irqrestore(&stat->lock, flags);
+
+	pr_info("%s: %s %d uids, moved %d failed %d err %d, %llu us\n", __func__,
+		batch.path, batch.nr_uids, batch.nr_moved, batch.nr_failed,
+		batch.error, timecost);
+}
+#endif
+
 /*proc and sysctl interface*/
 static int freecess_window_stat_show(struct seq_file *m, void *v)
 {
@@ -585,12 +686,18 @@ static int __init kfreecess_init(void)
 	}
 
 	freecess_runinfo_init(&freecess_info);
+#ifdef CONFIG_CGROUP_FREEZER
+	register_kfreecess_hook(MOD_BATCH, kfreecess_batch_hook);
+#endif
 	atomic_set(&kfreecess_init_suc, 1);
 	return RET_OK;
 }
 
 static void __exit kfreecess_exit(void)
 {
+#ifdef CONFIG_CGROUP_FREEZER
+	unregister_kfreecess_hook(MOD_BATCH);
+#endif
 	if (kfreecess_mod_sock)
 		netlink_kernel_release(kfreecess_mod_sock);
 
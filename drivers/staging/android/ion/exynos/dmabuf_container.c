@@ -16,11 +16,13 @@
 #include <linux/dma-buf.h>
 #include <linux/slab.h>
 #include <linux/fdtable.h>
+#include <linux/exynos_iovmm.h>
 
 #include <linux/dmabuf_container.h>
 #include "dmabuf_container_priv.h"
 #include "../../uapi/exynos_ion_uapi.h"
 #include "../ion.h"
+#include "../ion_priv.h"
 
 static void dmabuf_container_put_dmabuf(struct dmabuf_container *bufcon)
 {
@@ -55,6 +57,13 @@ static int dmabuf_container_get_dmabuf(struct dmabuf_container *bufcon, int *fd)
 static void dmabuf_container_dma_buf_release(struct dma_buf *dmabuf)
 {
 	struct dmabuf_container *bufcon = dmabuf->priv;
+	struct ion_iovm_map *iovm_map, *tmp;
+
+	list_for_each_entry_safe(iovm_map, tmp, &bufcon->iovas, list) {
+		iovmm_unmap(iovm_map->dev, iovm_map->iova);
+		list_del(&iovm_map->list);
+		kfree(iovm_map);
+	}
 
 	dmabuf_container_put_dmabuf(bufcon);
 
@@ -162,6 +171,100 @@ struct dma_buf *dmabuf_container_get_buffer(struct dma_buf *dmabuf, int index)
 	return bufcon->bufs[index];
 }
 
+/*
+ * Offset of the buffer at @index from the IO address returned by
+ * dmabuf_container_iovmm_map(). Buffers are placed back to back at page
+ * aligned offsets in the order of the container.
+ */
+size_t dmabuf_container_get_offset(struct dma_buf *dmabuf, int index)
+{
+	struct dmabuf_container *bufcon = bufcon_get_container(dmabuf);
+	size_t offset = 0;
+	int i;
+
+	if (IS_ERR(bufcon))
+		return 0;
+
+	for (i = 0; i < min(index, bufcon->bufcount); i++)
+		offset += PAGE_ALIGN(bufcon->bufs[i]->size);
+
+	return offset;
+}
+
+/*
+ * Maps all the buffers in the container into one IO region with a single TLB
+ * invalidation rather than mapping the buffers one by one. Like
+ * ion_iovmm_map(), the mapping is kept until the container is released.
+ */
+dma_addr_t dmabuf_container_iovmm_map(struct dma_buf_attachment *attachment,
+				      int prop)
+{
+	struct dmabuf_container *bufcon = attachment->dmabuf->priv;
+	struct scatterlist *sgl[MAX_BUFCON_BUFS];
+	size_t sizes[MAX_BUFCON_BUFS];
+	struct ion_iovm_map *iovm_map;
+	struct iommu_domain *domain;
+	dma_addr_t iova;
+	int i;
+
+	domain = get_domain_from_dev(attachment->dev);
+	if (!domain) {
+		pr_err("%s: invalid iommu device\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < bufcon->bufcount; i++) {
+		struct ion_buffer *buffer = ion_dma_buf_to_buffer(bufcon->bufs[i]);
+
+		if (IS_ERR(buffer) || (buffer->flags & ION_FLAG_PROTECTED)) {
+			pr_err("%s: buffer %d is not able to be mapped together\n",
+			       __func__, i);
+			return -EINVAL;
+		}
+
+		if (!ion_buffer_cached(buffer))
+			prop &= ~IOMMU_CACHE;
+
+		sgl[i] = buffer->sg_table->sgl;
+		sizes[i] = buffer->size;
+	}
+
+	mutex_lock(&bufcon->lock);
+
+	list_for_each_entry(iovm_map, &bufcon->iovas, list) {
+		if ((domain == iovm_map->domain) && (prop == iovm_map->prop)) {
+			mutex_unlock(&bufcon->lock);
+			return iovm_map->iova;
+		}
+	}
+
+	iovm_map = kzalloc(sizeof(*iovm_map), GFP_KERNEL);
+	if (!iovm_map) {
+		mutex_unlock(&bufcon->lock);
+		return -ENOMEM;
+	}
+
+	iova = iovmm_map_multi(attachment->dev, sgl, sizes, bufcon->bufcount,
+			       prop);
+	if (IS_ERR_VALUE(iova)) {
+		pr_err("%s: Unable to allocate IOVA for %s\n",
+		       __func__, dev_name(attachment->dev));
+		mutex_unlock(&bufcon->lock);
+		kfree(iovm_map);
+		return iova;
+	}
+
+	iovm_map->dev = attachment->dev;
+	iovm_map->domain = domain;
+	iovm_map->iova = iova;
+	iovm_map->prop = prop;
+	list_add_tail(&iovm_map->list, &bufcon->iovas);
+
+	mutex_unlock(&bufcon->lock);
+
+	return iova;
+}
+
 int dmabuf_container_create(void __user *arg)
 {
 	struct dmabuf_container_data data;
@@ -185,6 +288,8 @@ int dmabuf_container_create(void __user *arg)
 		return -ENOMEM;
 
 	bufcon->bufcount = data.count;
+	mutex_init(&bufcon->lock);
+	INIT_LIST_HEAD(&bufcon->iovas);
 
 	ret = dmabuf_container_get_dmabuf(bufcon, data.fds);
 	if (ret < 0)
@@ -13,17 +13,23 @@
 /*
  * struct dmabuf_container - container description
  * @table:	dummy sg_table for container
+ * @lock:	protects @iovas
+ * @iovas:	IO regions where all the buffers are mapped together
  * @bufs:	dmabuf array representing each buffers
  * @bufcount:	the number of the buffers
  */
 
 struct dmabuf_container {
 	struct sg_table	table;
+	struct mutex	lock;
+	struct list_head iovas;
 	int		bufcount;
 	struct dma_buf	*bufs[0];
 };
 
 int dmabuf_container_create(void __user *arg);
+dma_addr_t dmabuf_container_iovmm_map(struct dma_buf_attachment *attachment,
+				      int prop);
 
 #ifdef CONFIG_ION_EXYNOS
 bool is_dmabuf_container(struct dma_buf *dmabuf);
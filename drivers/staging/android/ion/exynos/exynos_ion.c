@@ -688,6 +688,10 @@ static long exynos_custom_ioctl(struct ion_client *client, unsigned int cmd,
 
 	if (cmd == ION_IOC_CUSTOM_CONTAINER_CREATE)
 		ret = dmabuf_container_create((void __user *)arg);
+	else if (cmd == ION_IOC_CUSTOM_HPA_PREPARE)
+		ret = ion_hpa_heap_prepare((void __user *)arg);
+	else if (cmd == ION_IOC_CUSTOM_MARK_DIRTY)
+		ret = exynos_ion_sync_mark_dirty((void __user *)arg);
 	else
 		pr_err("%s: Unknown IOCTL cmd %#x\n", __func__, cmd);
 
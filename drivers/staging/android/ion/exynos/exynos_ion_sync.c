@@ -1,8 +1,10 @@
 #include <linux/dma-mapping.h>
 #include <linux/mutex.h>
+#include <linux/uaccess.h>
 #include <linux/exynos_ion.h>
 
 #include "dmabuf_container_priv.h"
+#include "../../uapi/exynos_ion_uapi.h"
 #include "../ion.h"
 #include "../ion_priv.h"
 
@@ -25,6 +27,34 @@ static void __exynos_sync_sg_for_device(struct device *dev, size_t size,
 	}
 }
 
+static void __exynos_sync_sg_range_for_device(struct device *dev,
+					       struct scatterlist *sgl,
+					       int nelems, size_t offset,
+					       size_t len,
+					       enum dma_data_direction dir)
+{
+	struct scatterlist *sg;
+	int i;
+
+	for_each_sg(sgl, sg, nelems, i) {
+		size_t sg_len;
+
+		if (offset >= sg->length) {
+			offset -= sg->length;
+			continue;
+		}
+
+		sg_len = min_t(size_t, len, sg->length - offset);
+		__dma_map_area(phys_to_virt(dma_to_phys(dev, sg->dma_address)) +
+			       offset, sg_len, dir);
+
+		len -= sg_len;
+		if (!len)
+			break;
+		offset = 0;
+	}
+}
+
 static void __exynos_sync_sg_for_cpu(struct device *dev, size_t size,
 				      struct scatterlist *sgl, int nelems,
 				      enum dma_data_direction dir)
@@ -70,6 +100,75 @@ static void exynos_flush_sg(struct device *dev, size_t size,
 #define exynos_sync_sg_for_cpu(dev, size, sg, nents, dir)	\
 	__exynos_sync_sg_for_cpu(dev, size, sg, nents, dir)
 
+/*
+ * Cleans only the ranges recorded by ION_IOC_CUSTOM_MARK_DIRTY. Returns false
+ * if the ranges cover most of @size so that a single pass over the whole
+ * buffer is cheaper. The recorded ranges are consumed either way.
+ */
+static bool exynos_sync_dirty_for_device(struct device *dev,
+					 struct ion_buffer *buffer, size_t size,
+					 enum dma_data_direction dir)
+{
+	size_t dirty = 0;
+	int i;
+
+	for (i = 0; i < buffer->nr_dirty; i++)
+		dirty += buffer->dirty[i].len;
+
+	if (dirty > size / 2) {
+		buffer->nr_dirty = 0;
+		return false;
+	}
+
+	for (i = 0; i < buffer->nr_dirty; i++) {
+		size_t offset = buffer->dirty[i].offset;
+		size_t len = buffer->dirty[i].len;
+
+		if (offset >= size)
+			continue;
+		len = min(len, size - offset);
+
+		if (!IS_ERR_OR_NULL(buffer->vaddr))
+			exynos_sync_single_for_device(buffer->vaddr + offset,
+						      len, dir);
+		else
+			__exynos_sync_sg_range_for_device(dev,
+					buffer->sg_table->sgl,
+					buffer->sg_table->nents,
+					offset, len, dir);
+	}
+
+	buffer->nr_dirty = 0;
+
+	return true;
+}
+
+int exynos_ion_sync_mark_dirty(void __user *arg)
+{
+	struct ion_dirty_data data;
+	struct dma_buf *dmabuf;
+	unsigned int i;
+	int ret = 0;
+
+	if (copy_from_user(&data, arg, sizeof(data)))
+		return -EFAULT;
+
+	if (!data.count || data.count > ION_MAX_DIRTY_REGIONS)
+		return -EINVAL;
+
+	dmabuf = dma_buf_get(data.fd);
+	if (IS_ERR(dmabuf))
+		return PTR_ERR(dmabuf);
+
+	for (i = 0; i < data.count && !ret; i++)
+		ret = ion_buffer_mark_dirty(dmabuf, data.regions[i].offset,
+					    data.regions[i].len);
+
+	dma_buf_put(dmabuf);
+
+	return ret;
+}
+
 void exynos_ion_flush_dmabuf_for_device(struct device *dev,
 					struct dma_buf *dmabuf, size_t size)
 {
@@ -122,12 +221,16 @@ void exynos_ion_sync_dmabuf_for_device(struct device *dev,
 	trace_ion_sync_start(_RET_IP_, dev, dir, size,
 			buffer->vaddr, 0, size >= ION_FLUSH_ALL_HIGHLIMIT);
 
+	if (buffer->dirty_tracked &&
+	    exynos_sync_dirty_for_device(dev, buffer, size, dir))
+		goto out;
+
 	if (!IS_ERR_OR_NULL(buffer->vaddr))
 		exynos_sync_single_for_device(buffer->vaddr, size, dir);
 	else
 		exynos_sync_sg_for_device(dev, size, buffer->sg_table->sgl,
 						buffer->sg_table->nents, dir);
-
+out:
 	trace_ion_sync_end(_RET_IP_, dev, dir, size,
 			buffer->vaddr, 0, size >= ION_FLUSH_ALL_HIGHLIMIT);
 
@@ -19,10 +19,12 @@
 #include <linux/slab.h>
 #include <linux/sort.h>
 #include <linux/spinlock.h>
+#include <linux/uaccess.h>
 #include <linux/ion.h>
 #include <linux/exynos_ion.h>
 
 #include "../ion_priv.h"
+#include "../../uapi/exynos_ion_uapi.h"
 #include "ion_hpa_heap.h"
 
 struct ion_hpa_heap {
@@ -177,6 +179,29 @@ static struct ion_heap_ops ion_hpa_ops = {
 	.unmap_kernel = ion_heap_unmap_kernel,
 };
 
+/*
+ * Camera sessions know the amount of HPA memory well before they allocate it.
+ * Let the HPA allocator collect the chunks in the background in the meantime.
+ */
+int ion_hpa_heap_prepare(void __user *arg)
+{
+	struct ion_hpa_prepare_data data;
+	u64 count;
+
+	if (copy_from_user(&data, arg, sizeof(data)))
+		return -EFAULT;
+
+	if (data.reserved)
+		return -EINVAL;
+
+	count = ALIGN(data.len, ION_HPA_DEFAULT_SIZE) >> ION_HPA_DEFAULT_PAGE_ORDER;
+	if (count > INT_MAX)
+		return -EINVAL;
+
+	return hpa_reserve_highorder(ION_HPA_DEFAULT_ORDER, (int)count,
+				     data.timeout_ms);
+}
+
 static int hpa_heap_debug_show(struct ion_heap *heap, struct seq_file *s,
 			       void *unused)
 {
@@ -23,7 +23,9 @@
 #define ION_HPA_PAGE_COUNT(len) \
 		(ALIGN(len, ION_HPA_DEFAULT_SIZE) / ION_HPA_DEFAULT_SIZE)
 
-#ifndef CONFIG_HPA
+#ifdef CONFIG_HPA
+int ion_hpa_heap_prepare(void __user *arg);
+#else
 struct ion_heap *ion_hpa_heap_create(struct ion_platform_heap *data)
 {
 	return NULL;
@@ -32,6 +34,11 @@ struct ion_heap *ion_hpa_heap_create(struct ion_platform_heap *data)
 void ion_hpa_heap_destroy(struct ion_heap *heap)
 {
 }
+
+static inline int ion_hpa_heap_prepare(void __user *arg)
+{
+	return -ENOTTY;
+}
 #endif
 #endif /* _ION_HPA_HEAP_H */
 
@@ -1746,6 +1746,66 @@ int ion_sync_partial_for_device(struct ion_client *client, int fd,
 	return 0;
 }
 
+#ifdef CONFIG_ION_EXYNOS
+struct ion_buffer *ion_dma_buf_to_buffer(struct dma_buf *dmabuf)
+{
+	if (dmabuf->ops != &dma_buf_ops)
+		return ERR_PTR(-EINVAL);
+
+	return dmabuf->priv;
+}
+
+/*
+ * Records a range of @dmabuf written by the CPU. Once a buffer has a range
+ * recorded, the next sync for device maintains only the recorded ranges.
+ * Overlapping and adjacent ranges are merged and the last range absorbs the
+ * new one if no slot is left.
+ */
+int ion_buffer_mark_dirty(struct dma_buf *dmabuf, size_t offset, size_t len)
+{
+	struct ion_buffer *buffer;
+	struct ion_dirty_range *range;
+	size_t end;
+	int i;
+
+	if (dmabuf->ops != &dma_buf_ops)
+		return -EINVAL;
+
+	buffer = dmabuf->priv;
+	if (!len || offset >= buffer->size || len > buffer->size - offset)
+		return -EINVAL;
+
+	end = offset + len;
+
+	mutex_lock(&buffer->lock);
+	buffer->dirty_tracked = true;
+
+	for (i = 0; i < buffer->nr_dirty; i++) {
+		range = &buffer->dirty[i];
+		if (offset <= range->offset + range->len && range->offset <= end)
+			break;
+	}
+
+	if (i == buffer->nr_dirty) {
+		if (buffer->nr_dirty < ION_MAX_DIRTY_RANGES) {
+			range = &buffer->dirty[buffer->nr_dirty++];
+			range->offset = offset;
+			range->len = len;
+			goto out;
+		}
+		range = &buffer->dirty[ION_MAX_DIRTY_RANGES - 1];
+	}
+
+	end = max(end, range->offset + range->len);
+	range->offset = min(offset, range->offset);
+	range->len = end - range->offset;
+out:
+	mutex_unlock(&buffer->lock);
+
+	return 0;
+}
+#endif
+
 int ion_query_heaps(struct ion_client *client, struct ion_heap_query *query)
 {
 	struct ion_device *dev = client->dev;
@@ -2406,7 +2466,7 @@ dma_addr_t ion_iovmm_map(struct dma_buf_attachment *attachment,
 	struct iommu_domain *domain;
 
 	if (is_dmabuf_container(dmabuf))
-		return 0;
+		return dmabuf_container_iovmm_map(attachment, prop);
 
 	BUG_ON(dmabuf->ops != &dma_buf_ops);
 
@@ -144,6 +144,33 @@ int ion_page_pool_total(struct ion_page_pool *pool, bool high)
 	return count << pool->order;
 }
 
+/*
+ * Top @pool up to @nr_pages pages with zeroed pages that are cleaned from
+ * the CPU caches, so they can be handed out like pages that came back
+ * from freed buffers. Never enters reclaim nor wakes kswapd: the pool is
+ * only grown from memory that is free anyway. Returns the number of pages
+ * added.
+ */
+int ion_page_pool_refill(struct ion_page_pool *pool, int nr_pages)
+{
+	gfp_t gfp_mask = (pool->gfp_mask | __GFP_ZERO | __GFP_NOWARN |
+			  __GFP_NORETRY) & ~__GFP_RECLAIM;
+	int added = 0;
+
+	while (ion_page_pool_total(pool, true) < nr_pages) {
+		struct page *page = alloc_pages(gfp_mask, pool->order);
+
+		if (!page)
+			break;
+
+		__dma_flush_area(page_address(page), PAGE_SIZE << pool->order);
+		ion_page_pool_add(pool, page);
+		added += 1 << pool->order;
+	}
+
+	return added;
+}
+
 int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 			 int nr_to_scan)
 {
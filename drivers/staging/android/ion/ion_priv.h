@@ -129,6 +129,19 @@ struct ion_iovm_map {
 	int prop;
 };
 
+#ifdef CONFIG_ION_EXYNOS
+#define ION_MAX_DIRTY_RANGES	8
+
+/* a range of the buffer written by the CPU since the last sync for device */
+struct ion_dirty_range {
+	size_t offset;
+	size_t len;
+};
+
+int ion_buffer_mark_dirty(struct dma_buf *dmabuf, size_t offset, size_t len);
+struct ion_buffer *ion_dma_buf_to_buffer(struct dma_buf *dmabuf);
+#endif
+
 /**
  * struct ion_buffer - metadata for a particular buffer
  * @ref:		reference count
@@ -153,6 +166,9 @@ struct ion_iovm_map {
  *			handle, used for debugging
  * @pid:		pid of last client to reference this buffer in a
  *			handle, used for debugging
+ * @dirty_tracked:	CPU writes to the buffer are recorded in @dirty
+ * @nr_dirty:		number of valid ranges in @dirty
+ * @dirty:		ranges to be cleaned at the next sync for device
 */
 struct ion_buffer {
 	struct kref ref;
@@ -184,6 +200,11 @@ struct ion_buffer {
 	char thread_comm[TASK_COMM_LEN];
 	pid_t tid;
 #endif
+#ifdef CONFIG_ION_EXYNOS
+	bool dirty_tracked;
+	int nr_dirty;
+	struct ion_dirty_range dirty[ION_MAX_DIRTY_RANGES];
+#endif
 };
 
 #ifdef CONFIG_ION_EXYNOS_STAT_LOG
@@ -624,6 +645,14 @@ void *ion_page_pool_only_alloc(struct ion_page_pool *a);
 struct page *ion_page_pool_alloc(struct ion_page_pool *pool, bool zeroed);
 void ion_page_pool_free(struct ion_page_pool *, struct page *);
 
+/** ion_page_pool_refill - fills the pool with pre-zeroed pages
+ * @pool:		the pool
+ * @nr_pages:		number of pages the pool should hold
+ *
+ * returns the number of pages added
+ */
+int ion_page_pool_refill(struct ion_page_pool *pool, int nr_pages);
+
 /** ion_page_pool_shrink - shrinks the size of the memory cached in the pool
  * @pool:		the pool
  * @gfp_mask:		the memory type to reclaim
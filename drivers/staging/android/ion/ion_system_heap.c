@@ -25,6 +25,8 @@
 #include <linux/slab.h>
 #include <linux/vmalloc.h>
 #include <linux/kthread.h>
+#include <linux/freezer.h>
+#include <linux/moduleparam.h>
 #include <asm/tlbflush.h>
 #include "ion.h"
 #include "ion_priv.h"
@@ -37,6 +39,17 @@ static gfp_t low_order_gfp_flags  = (GFP_HIGHUSER | __GFP_ZERO);
 static const unsigned int orders[] = {8, 4, 0};
 static struct ion_system_heap *system_heap;
 
+/*
+ * Amount of pre-zeroed memory the refill thread keeps in each cached and
+ * uncached pool of the matching order, in KB. 0 disables the refill.
+ */
+static unsigned int pool_watermark_kb[NUM_ORDERS] = {4096, 2048, 1024};
+module_param_array(pool_watermark_kb, uint, NULL, 0644);
+
+/* Refilling stops for a while when the shrinker takes pages back */
+#define POOL_REFILL_SHRINK_BACKOFF	(5 * HZ)
+#define POOL_REFILL_FAIL_BACKOFF	(HZ)
+
 static int order_to_index(unsigned int order)
 {
 	int i;
@@ -57,8 +70,67 @@ struct ion_system_heap {
 	struct ion_heap heap;
 	struct ion_page_pool *uncached_pools[NUM_ORDERS];
 	struct ion_page_pool *cached_pools[NUM_ORDERS];
+	struct task_struct *refill_task;
+	wait_queue_head_t refill_wait;
+	unsigned long refill_resume;
 };
 
+static int pool_refill_target(int index)
+{
+	return READ_ONCE(pool_watermark_kb[index]) >> (PAGE_SHIFT - 10);
+}
+
+static bool ion_system_heap_need_refill(struct ion_system_heap *heap)
+{
+	int i;
+
+	if (time_before(jiffies, READ_ONCE(heap->refill_resume)))
+		return false;
+
+	for (i = 0; i < NUM_ORDERS; i++) {
+		int target = pool_refill_target(i);
+
+		if (ion_page_pool_total(heap->uncached_pools[i], true) < target)
+			return true;
+		if (ion_page_pool_total(heap->cached_pools[i], true) < target)
+			return true;
+	}
+
+	return false;
+}
+
+static int ion_system_heap_refill(void *data)
+{
+	struct ion_system_heap *heap = data;
+
+	set_freezable();
+
+	while (!kthread_should_stop()) {
+		int i;
+
+		wait_event_freezable(heap->refill_wait,
+				     kthread_should_stop() ||
+				     ion_system_heap_need_refill(heap));
+
+		for (i = 0; i < NUM_ORDERS; i++) {
+			int target = pool_refill_target(i);
+
+			if (time_before(jiffies, READ_ONCE(heap->refill_resume)))
+				break;
+
+			ion_page_pool_refill(heap->uncached_pools[i], target);
+			ion_page_pool_refill(heap->cached_pools[i], target);
+		}
+
+		/* Out of free memory, do not spin on the allocator */
+		if (ion_system_heap_need_refill(heap))
+			WRITE_ONCE(heap->refill_resume,
+				   jiffies + POOL_REFILL_FAIL_BACKOFF);
+	}
+
+	return 0;
+}
+
 /**
  * The page from page-pool are all zeroed before. We need do cache
  * clean for cached buffer. The uncached buffer are always non-cached
@@ -197,6 +269,9 @@ static int ion_system_heap_allocate(struct ion_heap *heap,
 	buffer->private_flags = 0;
 	buffer->sg_table = table;
 	buffer->priv_virt = table;
+
+	if (sys_heap->refill_task && ion_system_heap_need_refill(sys_heap))
+		wake_up(&sys_heap->refill_wait);
 	return 0;
 
 free_table:
@@ -241,6 +316,9 @@ static int ion_system_heap_shrink(struct ion_heap *heap, gfp_t gfp_mask,
 
 	if (!nr_to_scan)
 		only_scan = 1;
+	else
+		WRITE_ONCE(sys_heap->refill_resume,
+			   jiffies + POOL_REFILL_SHRINK_BACKOFF);
 
 	for (i = 0; i < NUM_ORDERS; i++) {
 		uncached_pool = sys_heap->uncached_pools[i];
@@ -418,6 +496,21 @@ struct ion_heap *ion_system_heap_create(struct ion_platform_heap *unused)
 		goto destroy_uncached_pools;
 
 	heap->heap.debug_show = ion_system_heap_debug_show;
+
+	init_waitqueue_head(&heap->refill_wait);
+	heap->refill_task = kthread_run(ion_system_heap_refill, heap,
+					"ion_pool_refill");
+	if (IS_ERR(heap->refill_task)) {
+		pr_err("%s: creating thread for pool refill failed\n",
+		       __func__);
+		heap->refill_task = NULL;
+	} else {
+		struct sched_param param = { .sched_priority = 0 };
+
+		sched_setscheduler(heap->refill_task, SCHED_IDLE, &param);
+		wake_up(&heap->refill_wait);
+	}
+
 	if (!system_heap)
 		system_heap = heap;
 	else
@@ -439,6 +532,9 @@ void ion_system_heap_destroy(struct ion_heap *heap)
 							heap);
 	int i;
 
+	if (sys_heap->refill_task)
+		kthread_stop(sys_heap->refill_task);
+
 	for (i = 0; i < NUM_ORDERS; i++) {
 		ion_page_pool_destroy(sys_heap->uncached_pools[i]);
 		ion_page_pool_destroy(sys_heap->cached_pools[i]);
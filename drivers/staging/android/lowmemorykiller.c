@@ -49,6 +49,7 @@
 #include <linux/slab.h>
 #include <linux/poll.h>
 #include <linux/ratelimit.h>
+#include <linux/rbtree.h>
 
 #define CREATE_TRACE_POINTS
 #include "trace/lowmemorykiller.h"
@@ -222,6 +223,75 @@ static void lmk_event_init(void)
 		pr_err("error creating kernel lmk event file\n");
 }
 
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+/*
+ * Group leaders ordered by the oom_score_adj they had when last (re)inserted,
+ * so lowmem_scan() can start at the highest level and stop as soon as it is
+ * below the one it has to kill at. Nests inside tasklist_lock at fork and
+ * exit, and task_lock is taken inside it by lowmem_scan().
+ */
+static DEFINE_SPINLOCK(lmk_adj_lock);
+static struct rb_root lmk_adj_tree = RB_ROOT;
+
+static void __lmk_adj_tree_insert(struct task_struct *tsk)
+{
+	struct rb_node **link = &lmk_adj_tree.rb_node;
+	struct rb_node *parent = NULL;
+	struct task_struct *entry;
+
+	tsk->lmk_adj = tsk->signal->oom_score_adj;
+	while (*link) {
+		parent = *link;
+		entry = rb_entry(parent, struct task_struct, lmk_adj_node);
+		if (tsk->lmk_adj < entry->lmk_adj)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&tsk->lmk_adj_node, parent, link);
+	rb_insert_color(&tsk->lmk_adj_node, &lmk_adj_tree);
+}
+
+static void __lmk_adj_tree_erase(struct task_struct *tsk)
+{
+	rb_erase(&tsk->lmk_adj_node, &lmk_adj_tree);
+	RB_CLEAR_NODE(&tsk->lmk_adj_node);
+}
+
+void lmk_adj_tree_add(struct task_struct *tsk)
+{
+	spin_lock(&lmk_adj_lock);
+	if (RB_EMPTY_NODE(&tsk->lmk_adj_node))
+		__lmk_adj_tree_insert(tsk);
+	spin_unlock(&lmk_adj_lock);
+}
+
+void lmk_adj_tree_del(struct task_struct *tsk)
+{
+	spin_lock(&lmk_adj_lock);
+	if (!RB_EMPTY_NODE(&tsk->lmk_adj_node))
+		__lmk_adj_tree_erase(tsk);
+	spin_unlock(&lmk_adj_lock);
+}
+
+/* re-sort @tsk's thread group after its oom_score_adj was written */
+void lmk_adj_tree_update(struct task_struct *tsk)
+{
+	struct task_struct *leader;
+
+	rcu_read_lock();
+	spin_lock(&lmk_adj_lock);
+	leader = READ_ONCE(tsk->group_leader);
+	if (!RB_EMPTY_NODE(&leader->lmk_adj_node) &&
+			leader->lmk_adj != leader->signal->oom_score_adj) {
+		__lmk_adj_tree_erase(leader);
+		__lmk_adj_tree_insert(leader);
+	}
+	spin_unlock(&lmk_adj_lock);
+	rcu_read_unlock();
+}
+#endif
+
 static int test_task_flag(struct task_struct *p, int flag)
 {
 	struct task_struct *t = p;
@@ -330,6 +400,10 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 	unsigned long nr_cma_free;
 	unsigned long nr_rbin_free, nr_rbin_pool, nr_rbin_alloc, nr_rbin_file;
 	int migratetype;
+	unsigned long nr_dying;
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+	struct rb_node *node;
+#endif
 #if defined(CONFIG_ZSWAP)
 	int zswap_stored_pages_temp;
 	int swap_rss;
@@ -351,6 +425,10 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 		other_file -= nr_rbin_file;
 	}
 
+	/* memory earlier victims are about to give back */
+	nr_dying = memkill_pending_pages();
+	other_free += nr_dying;
+
 	if (!current_is_kswapd() && is_mem_boost_high() &&
 			lowmem_direct_minfree_size && lowmem_direct_adj_size) {
 		array_size = ARRAY_SIZE(lowmem_direct_adj);
@@ -379,9 +457,9 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 		}
 	}
 
-	lowmem_print(3, "lowmem_scan %lu, %x, ofree %d %d, ma %hd\n",
+	lowmem_print(3, "lowmem_scan %lu, %x, ofree %d %d, dying %lu, ma %hd\n",
 		     sc->nr_to_scan, sc->gfp_mask, other_free,
-		     other_file, min_score_adj);
+		     other_file, nr_dying, min_score_adj);
 
 	if (min_score_adj == OOM_SCORE_ADJ_MAX + 1) {
 		lowmem_print(5, "lowmem_scan %lu, %x, return 0\n",
@@ -392,9 +470,23 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 	selected_oom_score_adj = min_score_adj;
 
 	rcu_read_lock();
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+	spin_lock(&lmk_adj_lock);
+	for (node = rb_last(&lmk_adj_tree); node; node = rb_prev(node)) {
+		struct task_struct *p;
+		short oom_score_adj;
+
+		tsk = rb_entry(node, struct task_struct, lmk_adj_node);
+		/* everything further left is at a lower oom_score_adj */
+		if (tsk->lmk_adj < min_score_adj)
+			break;
+		if (selected && tsk->lmk_adj < selected_oom_score_adj)
+			break;
+#else
 	for_each_process(tsk) {
 		struct task_struct *p;
 		short oom_score_adj;
+#endif
 
 		if (tsk->flags & PF_KTHREAD)
 			continue;
@@ -414,6 +506,9 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 
 			if (time_before_eq(jiffies,
 					   lowmem_deathpending_timeout)) {
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+				spin_unlock(&lmk_adj_lock);
+#endif
 				rcu_read_unlock();
 				return SHRINK_STOP;
 			}
@@ -462,6 +557,11 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 		lowmem_print(2, "select '%s' (%d), adj %hd, size %d, to kill\n",
 			     p->comm, p->pid, oom_score_adj, tasksize);
 	}
+	if (selected)
+		get_task_struct(selected);
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+	spin_unlock(&lmk_adj_lock);
+#endif
 	if (selected) {
 		long cache_size = other_file * (long)(PAGE_SIZE / 1024);
 		long cache_limit = minfree * (long)(PAGE_SIZE / 1024);
@@ -472,8 +572,10 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 
 		task_lock(selected);
 		send_sig(SIGKILL, selected, 0);
-		if (selected->mm)
+		if (selected->mm) {
 			task_set_lmk_waiting(selected);
+			memkill_track(selected->mm, selected_tasksize);
+		}
 		task_unlock(selected);
 		trace_lowmemory_kill(selected, cache_size, cache_limit, free);
 		lowmem_print(1, "Killing '%s' (%d) (tgid %d), adj %hd,\n"
@@ -508,7 +610,6 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 
 		lowmem_deathpending_timeout = jiffies + HZ;
 		rem += selected_tasksize;
-		get_task_struct(selected);
 		lowmem_lmkcount++;
 	}
 
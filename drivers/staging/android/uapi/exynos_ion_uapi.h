@@ -28,4 +28,44 @@ struct dmabuf_container_data {
 #define ION_IOC_CUSTOM_CONTAINER_CREATE \
 		_IOWR(ION_IOC_CUSTOM_MAGIC, 0, struct dmabuf_container_data)
 
+/*
+ * struct ion_hpa_prepare_data - announcement of upcoming HPA heap allocations
+ *
+ * @len:			total size in bytes to be allocated; 0 cancels
+ * @timeout_ms:		how long the prepared memory is held; 0 for default
+ * @reserved:		must be zero
+ */
+struct ion_hpa_prepare_data {
+	__u64 len;
+	__u32 timeout_ms;
+	__u32 reserved;
+};
+
+#define ION_IOC_CUSTOM_HPA_PREPARE \
+		_IOW(ION_IOC_CUSTOM_MAGIC, 1, struct ion_hpa_prepare_data)
+
+#define ION_MAX_DIRTY_REGIONS 8
+/*
+ * struct ion_dirty_data - ranges of a buffer written by the CPU
+ *
+ * @fd:				a file descriptor representing the buffer
+ * @count:			the number of valid entries in @regions
+ * @regions:		offset and length in bytes of each written range
+ *
+ * Once a range is marked, the buffer is cleaned only over the ranges marked
+ * since the previous sync for device. Userspace then has to mark every range
+ * it writes before handing the buffer to a device.
+ */
+struct ion_dirty_data {
+	__s32 fd;
+	__u32 count;
+	struct {
+		__u64 offset;
+		__u64 len;
+	} regions[ION_MAX_DIRTY_REGIONS];
+};
+
+#define ION_IOC_CUSTOM_MARK_DIRTY \
+		_IOW(ION_IOC_CUSTOM_MAGIC, 2, struct ion_dirty_data)
+
 #endif
@@ -27,6 +27,11 @@
 #include <linux/interrupt.h>
 #include <linux/sec_argos.h>
 #include <linux/ologk.h>
+#include <linux/netdevice.h>
+#include <linux/rtnetlink.h>
+#include <linux/workqueue.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
 
 #ifdef CONFIG_SCHED_EHMP
 #include <linux/ehmp.h>
@@ -84,6 +89,43 @@ struct argos_pm_qos {
 	struct pm_qos_request hotplug_min_qos_req;
 };
 
+#ifdef CONFIG_RPS
+#define ARGOS_RPS_HOLD_MS	2000
+
+struct argos_rps_profile {
+	struct cpumask cpus;
+	unsigned int flow_cnt;
+};
+
+/*
+ * RPS/RFS steering of the rx queues of the netdevs whose name starts with
+ * one of ifaces. Levels are raised right away, lowered only once the lower
+ * level was requested for hold_ms so that bursts do not tear down the
+ * flow tables every time.
+ */
+struct argos_rps {
+	const char *desc;
+	const char **ifaces;
+	int nifaces;
+	/* profiles[0] is used below the first threshold, [level + 1] above */
+	struct argos_rps_profile *profiles;
+	int nprofiles;
+	unsigned int hold_ms;
+	/* written by argos_rps_work() under rtnl */
+	int cur_level;
+	int req_level;
+	struct delayed_work work;
+	/* protect req_level, cur_level updates and the stats below */
+	spinlock_t lock;
+	unsigned long stamp;
+	u64 *residency;		/* msecs spent in each profile */
+	unsigned long raise;
+	unsigned long lower;
+	unsigned long held;
+	unsigned long fail;
+};
+#endif
+
 struct argos {
 	const char *desc;
 	struct platform_device *pdev;
@@ -97,6 +139,9 @@ struct argos {
 	bool irq_hotplug_disable;
 	bool hmpboost_enable;
 	bool argos_block;
+#ifdef CONFIG_RPS
+	struct argos_rps *rps;
+#endif
 	struct blocking_notifier_head argos_notifier;
 	/* protect prev_level, qos, task/irq_hotplug_disable, hmpboost_enable */
 	struct mutex level_mutex;
@@ -412,6 +457,195 @@ int argos_hmpboost_apply(int dev_num, bool enable)
 	return 0;
 }
 
+#ifdef CONFIG_RPS
+static bool argos_rps_match(struct argos_rps *rps, const char *name)
+{
+	int i;
+
+	for (i = 0; i < rps->nifaces; i++)
+		if (!strncmp(name, rps->ifaces[i], strlen(rps->ifaces[i])))
+			return true;
+	return false;
+}
+
+static int argos_rps_apply_dev(struct net_device *dev,
+			       struct argos_rps_profile *p)
+{
+	int i, err = 0;
+
+	for (i = 0; i < dev->num_rx_queues; i++) {
+		err |= netif_set_rps_map(&dev->_rx[i], &p->cpus);
+		err |= netif_set_rps_flow_cnt(&dev->_rx[i], p->flow_cnt);
+	}
+
+	return err;
+}
+
+/* called with rps->lock held */
+static void argos_rps_account(struct argos_rps *rps)
+{
+	unsigned long now = jiffies;
+
+	rps->residency[rps->cur_level + 1] += jiffies_to_msecs(now - rps->stamp);
+	rps->stamp = now;
+}
+
+static void argos_rps_work(struct work_struct *work)
+{
+	struct argos_rps *rps = container_of(to_delayed_work(work),
+					     struct argos_rps, work);
+	struct argos_rps_profile *p;
+	struct net_device *dev;
+	int level, err = 0;
+	bool again;
+
+	rtnl_lock();
+	spin_lock(&rps->lock);
+	level = rps->req_level;
+	spin_unlock(&rps->lock);
+
+	if (level == rps->cur_level)
+		goto out;
+
+	p = &rps->profiles[level + 1];
+	for_each_netdev(&init_net, dev)
+		if (argos_rps_match(rps, dev->name))
+			err |= argos_rps_apply_dev(dev, p);
+
+	spin_lock(&rps->lock);
+	argos_rps_account(rps);
+	if (level > rps->cur_level)
+		rps->raise++;
+	else
+		rps->lower++;
+	if (err)
+		rps->fail++;
+	rps->cur_level = level;
+	/* a request that raced with us found nothing pending to cancel */
+	again = rps->req_level != level;
+	spin_unlock(&rps->lock);
+
+	pr_info("%s name:%s, level:%d, rps cpu_mask:0x%X, flow_cnt:%u%s\n",
+		__func__, rps->desc, level, (int)*p->cpus.bits, p->flow_cnt,
+		err ? " (failed)" : "");
+
+	if (again)
+		mod_delayed_work(system_wq, &rps->work, 0);
+out:
+	rtnl_unlock();
+}
+
+static void argos_rps_request(struct argos *cnode, int level, bool now)
+{
+	struct argos_rps *rps = cnode->rps;
+	unsigned long delay = 0;
+	int cur;
+
+	if (!rps)
+		return;
+
+	spin_lock(&rps->lock);
+	rps->req_level = level;
+	cur = rps->cur_level;
+	spin_unlock(&rps->lock);
+
+	if (level == cur) {
+		if (cancel_delayed_work(&rps->work)) {
+			spin_lock(&rps->lock);
+			rps->held++;
+			spin_unlock(&rps->lock);
+		}
+		return;
+	}
+
+	if (level < cur && !now)
+		delay = msecs_to_jiffies(rps->hold_ms);
+	mod_delayed_work(system_wq, &rps->work, delay);
+}
+
+/* give netdevs showing up later the profile of the current level */
+static int argos_rps_netdev_event(struct notifier_block *nb,
+				  unsigned long event, void *ptr)
+{
+	struct net_device *dev = netdev_notifier_info_to_dev(ptr);
+	struct argos_rps *rps;
+	int i;
+
+	if (event != NETDEV_REGISTER && event != NETDEV_CHANGENAME)
+		return NOTIFY_DONE;
+
+	for (i = 0; i < argos_pdata->ndevice; i++) {
+		rps = argos_pdata->devices[i].rps;
+		if (rps && argos_rps_match(rps, dev->name))
+			argos_rps_apply_dev(dev,
+					    &rps->profiles[rps->cur_level + 1]);
+	}
+
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block argos_rps_netdev_nb = {
+	.notifier_call = argos_rps_netdev_event,
+};
+
+static int argos_rps_stats_show(struct seq_file *m, void *v)
+{
+	struct argos_rps *rps;
+	int i, j;
+
+	for (i = 0; i < argos_pdata->ndevice; i++) {
+		rps = argos_pdata->devices[i].rps;
+		if (!rps)
+			continue;
+
+		seq_printf(m, "%s: ifaces", rps->desc);
+		for (j = 0; j < rps->nifaces; j++)
+			seq_printf(m, " %s", rps->ifaces[j]);
+		seq_printf(m, " hold_ms %u\n", rps->hold_ms);
+
+		spin_lock(&rps->lock);
+		argos_rps_account(rps);
+		seq_printf(m, "  level %d requested %d raise %lu lower %lu held %lu fail %lu\n",
+			   rps->cur_level, rps->req_level, rps->raise,
+			   rps->lower, rps->held, rps->fail);
+		for (j = 0; j < rps->nprofiles; j++)
+			seq_printf(m, "  %2d: cpus %*pbl flow_cnt %u time_ms %llu\n",
+				   j - 1, cpumask_pr_args(&rps->profiles[j].cpus),
+				   rps->profiles[j].flow_cnt,
+				   rps->residency[j]);
+		spin_unlock(&rps->lock);
+	}
+
+	return 0;
+}
+
+static int argos_rps_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, argos_rps_stats_show, NULL);
+}
+
+static const struct file_operations argos_rps_stats_fops = {
+	.open = argos_rps_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static bool argos_rps_enabled(struct argos_platform_data *pdata)
+{
+	int i;
+
+	for (i = 0; i < pdata->ndevice; i++)
+		if (pdata->devices[i].rps)
+			return true;
+	return false;
+}
+#else
+static inline void argos_rps_request(struct argos *cnode, int level, bool now)
+{
+}
+#endif
+
 static void argos_freq_unlock(int type)
 {
 	struct argos_pm_qos *qos = argos_pdata->devices[type].qos;
@@ -512,6 +746,7 @@ void argos_block_enable(char *req_name, bool set)
 		argos_task_affinity_apply(dev_num, 0);
 		argos_irq_affinity_apply(dev_num, 0);
 		argos_hmpboost_apply(dev_num, 0);
+		argos_rps_request(cnode, -1, true);
 		cnode->prev_level = -1;
 		mutex_unlock(&cnode->level_mutex);
 	} else {
@@ -608,6 +843,7 @@ static int argos_pm_qos_notify(struct notifier_block *nfb,
 				argos_task_affinity_apply(type, 0);
 				argos_irq_affinity_apply(type, 0);
 				argos_hmpboost_apply(type, 0);
+				argos_rps_request(cnode, -1, false);
 			} else {
 				unsigned int enable_flag;
 
@@ -620,6 +856,7 @@ static int argos_pm_qos_notify(struct notifier_block *nfb,
 				enable_flag =
 					argos_pdata->devices[type].tables[level].items[HMP_BOOST_EN];
 				argos_hmpboost_apply(type, enable_flag);
+				argos_rps_request(cnode, level, false);
 
 				if (cnode->argos_notifier.head) {
 					pr_debug("%s: Call argos notifier(%s lev:%d)\n",
@@ -640,6 +877,87 @@ static int argos_pm_qos_notify(struct notifier_block *nfb,
 }
 
 #ifdef CONFIG_OF
+#ifdef CONFIG_RPS
+static void argos_rps_set_profile(struct argos_rps_profile *p, u32 cpus,
+				  u32 flow_cnt)
+{
+	int cpu;
+
+	cpumask_clear(&p->cpus);
+	for (cpu = 0; cpu < min_t(int, nr_cpu_ids, 32); cpu++)
+		if (cpus & BIT(cpu))
+			cpumask_set_cpu(cpu, &p->cpus);
+	p->flow_cnt = flow_cnt;
+}
+
+/*
+ * net_boost,rps_table holds a <cpu_mask flow_cnt> pair per level of
+ * net_boost,table, net_boost,rps_default the pair used below the first
+ * threshold (RPS and RFS off if absent).
+ */
+static int argos_rps_parse_dt(struct device *dev, struct device_node *np,
+			      struct argos *cnode)
+{
+	struct argos_rps *rps;
+	u32 cpus, flow_cnt;
+	int i, n;
+
+	n = of_property_count_u32_elems(np, "net_boost,rps_table");
+	if (n <= 0)
+		return 0;
+	if (n != cnode->ntables * 2) {
+		dev_err(dev, "rps_table needs a cpu mask and flow count per level\n");
+		return -EINVAL;
+	}
+
+	rps = devm_kzalloc(dev, sizeof(*rps), GFP_KERNEL);
+	if (!rps)
+		return -ENOMEM;
+
+	rps->nifaces = of_property_count_strings(np, "net_boost,rps_ifaces");
+	if (rps->nifaces <= 0) {
+		dev_err(dev, "rps_table without rps_ifaces\n");
+		return -EINVAL;
+	}
+	rps->ifaces = devm_kcalloc(dev, rps->nifaces, sizeof(*rps->ifaces),
+				   GFP_KERNEL);
+	rps->nprofiles = cnode->ntables + 1;
+	rps->profiles = devm_kcalloc(dev, rps->nprofiles,
+				     sizeof(*rps->profiles), GFP_KERNEL);
+	rps->residency = devm_kcalloc(dev, rps->nprofiles,
+				      sizeof(*rps->residency), GFP_KERNEL);
+	if (!rps->ifaces || !rps->profiles || !rps->residency)
+		return -ENOMEM;
+	of_property_read_string_array(np, "net_boost,rps_ifaces", rps->ifaces,
+				      rps->nifaces);
+
+	if (!of_property_read_u32_index(np, "net_boost,rps_default", 0, &cpus) &&
+	    !of_property_read_u32_index(np, "net_boost,rps_default", 1, &flow_cnt))
+		argos_rps_set_profile(&rps->profiles[0], cpus, flow_cnt);
+
+	for (i = 0; i < cnode->ntables; i++) {
+		of_property_read_u32_index(np, "net_boost,rps_table", i * 2,
+					   &cpus);
+		of_property_read_u32_index(np, "net_boost,rps_table", i * 2 + 1,
+					   &flow_cnt);
+		argos_rps_set_profile(&rps->profiles[i + 1], cpus, flow_cnt);
+	}
+
+	rps->hold_ms = ARGOS_RPS_HOLD_MS;
+	of_property_read_u32(np, "net_boost,rps_hold_ms", &rps->hold_ms);
+
+	rps->desc = cnode->desc;
+	rps->cur_level = -1;
+	rps->req_level = -1;
+	rps->stamp = jiffies;
+	spin_lock_init(&rps->lock);
+	INIT_DELAYED_WORK(&rps->work, argos_rps_work);
+	cnode->rps = rps;
+
+	return 0;
+}
+#endif
+
 static int argos_parse_dt(struct device *dev)
 {
 	struct argos_platform_data *pdata = dev->platform_data;
@@ -705,6 +1023,11 @@ static int argos_parse_dt(struct device *dev)
 			goto err_out;
 		}
 		BLOCKING_INIT_NOTIFIER_HEAD(&cnode->argos_notifier);
+#ifdef CONFIG_RPS
+		retval = argos_rps_parse_dt(dev, cnp, cnode);
+		if (retval)
+			goto err_out;
+#endif
 
 		device_count++;
 	}
@@ -758,6 +1081,14 @@ static int argos_probe(struct platform_device *pdev)
 	register_reboot_notifier(&argos_cpuidle_reboot_nb);
 	argos_pdata = pdata;
 	platform_set_drvdata(pdev, pdata);
+#ifdef CONFIG_RPS
+	if (argos_rps_enabled(pdata)) {
+		register_netdevice_notifier(&argos_rps_netdev_nb);
+		if (!proc_create("argos_rps", S_IRUGO, NULL,
+				 &argos_rps_stats_fops))
+			dev_warn(&pdev->dev, "Failed to create argos_rps\n");
+	}
+#endif
 
 	return 0;
 }
@@ -770,6 +1101,17 @@ static int argos_remove(struct platform_device *pdev)
 		return 0;
 	pm_qos_remove_notifier(PM_QOS_NETWORK_THROUGHPUT, &pdata->pm_qos_nfb);
 	unregister_reboot_notifier(&argos_cpuidle_reboot_nb);
+#ifdef CONFIG_RPS
+	if (argos_rps_enabled(pdata)) {
+		int i;
+
+		remove_proc_entry("argos_rps", NULL);
+		unregister_netdevice_notifier(&argos_rps_netdev_nb);
+		for (i = 0; i < pdata->ndevice; i++)
+			if (pdata->devices[i].rps)
+				cancel_delayed_work_sync(&pdata->devices[i].rps->work);
+	}
+#endif
 
 	return 0;
 }
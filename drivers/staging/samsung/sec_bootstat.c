@@ -28,6 +28,8 @@
 #include <linux/sec_ext.h>
 #include <clocksource/arm_arch_timer.h>
 #include <linux/slab.h>
+#include <linux/debugfs.h>
+#include <linux/atomic.h>
 
 static u32 mct_start;
 
@@ -98,6 +100,92 @@ static bool bootcompleted = false;
 
 LIST_HEAD(systemserver_init_time_list);
 
+/*
+ * Every initcall and driver probe until bootcomplete, exported through
+ * debugfs as a Chrome trace (chrome://tracing, Perfetto). Spans shorter
+ * than SPAN_MIN_NS are dropped to keep the table small, except probes that
+ * returned -EPROBE_DEFER: their time is what deferral costs the boot.
+ */
+#define MAX_SPANS	2048
+#define SPAN_MIN_NS	(50 * NSEC_PER_USEC)
+
+enum span_type {
+	SPAN_INITCALL,
+	SPAN_PROBE,
+	SPAN_DEFER,
+};
+
+struct boot_span {
+	u64 start;		/* ns since boot */
+	u32 dur;		/* ns */
+	s16 ret;
+	u8 type;
+	u8 cpu;
+	union {
+		initcall_t fn;
+		char drv[24];
+	};
+	char dev[24];
+};
+
+static struct boot_span boot_spans[MAX_SPANS];
+static atomic_t nr_boot_spans = ATOMIC_INIT(0);
+static atomic_t nr_defer_spans = ATOMIC_INIT(0);
+static atomic64_t defer_time = ATOMIC64_INIT(0);
+
+static struct boot_span *sec_bootstat_new_span(int type, u64 start, int ret)
+{
+	struct boot_span *span;
+	u64 dur = local_clock() - start;
+	int i;
+
+	if (bootcompleted)
+		return NULL;
+
+	if (type == SPAN_DEFER) {
+		atomic_inc(&nr_defer_spans);
+		atomic64_add(dur, &defer_time);
+	} else if (dur < SPAN_MIN_NS) {
+		return NULL;
+	}
+
+	i = atomic_inc_return(&nr_boot_spans) - 1;
+	if (i >= MAX_SPANS)
+		return NULL;
+
+	span = &boot_spans[i];
+	span->start = start;
+	span->dur = (u32)min_t(u64, dur, U32_MAX);
+	span->ret = (s16)clamp_t(int, ret, S16_MIN, S16_MAX);
+	span->type = type;
+	span->cpu = raw_smp_processor_id();
+
+	return span;
+}
+
+void sec_bootstat_add_initcall_span(initcall_t fn, unsigned long long start,
+		int ret)
+{
+	struct boot_span *span;
+
+	span = sec_bootstat_new_span(SPAN_INITCALL, start, ret);
+	if (span)
+		span->fn = fn;
+}
+
+void sec_bootstat_add_probe_span(const char *drv, const char *dev,
+		unsigned long long start, int ret)
+{
+	struct boot_span *span;
+
+	span = sec_bootstat_new_span(ret == -EPROBE_DEFER ? SPAN_DEFER :
+			SPAN_PROBE, start, ret);
+	if (span) {
+		strlcpy(span->drv, drv, sizeof(span->drv));
+		strlcpy(span->dev, dev ? dev : "", sizeof(span->dev));
+	}
+}
+
 void sec_bootstat_mct_start(u64 rate)
 {
 	mct_start = (u32)(rate & 0xFFFFFFFF);
@@ -194,6 +282,10 @@ static int sec_boot_stat_proc_show(struct seq_file *m, void *v)
 		last_time = boot_initcall[i].time;
 	}
 
+	seq_printf(m, "deferred probes: %d, %llu ms\n",
+			atomic_read(&nr_defer_spans),
+			(unsigned long long)atomic64_read(&defer_time) / NSEC_PER_MSEC);
+
 	seq_puts(m, "---------------------------------------------------------------------------------------------------------\n");
 	seq_puts(m, "FRAMEWORK\n");
 	seq_puts(m, "---------------------------------------------------------------------------------------------------------\n");
@@ -230,6 +322,82 @@ static const struct file_operations sec_boot_stat_proc_fops = {
 	.release = single_release,
 };
 
+static const char * const span_cat[] = {
+	[SPAN_INITCALL] = "initcall",
+	[SPAN_PROBE] = "probe",
+	[SPAN_DEFER] = "defer",
+};
+
+/* one position per span, then SEQ_START_TOKEN closes the array */
+static void *boot_trace_start(struct seq_file *m, loff_t *pos)
+{
+	int nr = min(atomic_read(&nr_boot_spans), MAX_SPANS);
+
+	if (*pos < nr)
+		return &boot_spans[*pos];
+
+	return *pos == nr ? SEQ_START_TOKEN : NULL;
+}
+
+static void *boot_trace_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	++*pos;
+	return boot_trace_start(m, pos);
+}
+
+static void boot_trace_stop(struct seq_file *m, void *v)
+{
+}
+
+static int boot_trace_show(struct seq_file *m, void *v)
+{
+	struct boot_span *span = v;
+
+	if (span == &boot_spans[0] ||
+	    (v == SEQ_START_TOKEN && !atomic_read(&nr_boot_spans)))
+		seq_puts(m, "{\"traceEvents\":[\n");
+
+	if (v == SEQ_START_TOKEN) {
+		seq_puts(m, "{}]}\n");
+		return 0;
+	}
+
+	seq_puts(m, "{\"name\":\"");
+	if (span->type == SPAN_INITCALL)
+		seq_printf(m, "%pf", span->fn);
+	else
+		seq_printf(m, "%s %s", span->drv, span->dev);
+
+	seq_printf(m, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+			"\"ts\":%llu.%03llu,\"dur\":%u.%03u,"
+			"\"args\":{\"ret\":%d}},\n",
+			span_cat[span->type], span->cpu,
+			span->start / NSEC_PER_USEC, span->start % NSEC_PER_USEC,
+			span->dur / NSEC_PER_USEC, span->dur % NSEC_PER_USEC,
+			span->ret);
+
+	return 0;
+}
+
+static const struct seq_operations boot_trace_seq_ops = {
+	.start = boot_trace_start,
+	.next = boot_trace_next,
+	.stop = boot_trace_stop,
+	.show = boot_trace_show,
+};
+
+static int boot_trace_open(struct inode *inode, struct file *file)
+{
+	return seq_open(file, &boot_trace_seq_ops);
+}
+
+static const struct file_operations boot_trace_fops = {
+	.open    = boot_trace_open,
+	.read    = seq_read,
+	.llseek  = seq_lseek,
+	.release = seq_release,
+};
+
 static ssize_t store_boot_stat(struct device *dev, struct device_attribute *attr,
 			const char *buf, size_t count)
 {
@@ -275,6 +443,10 @@ static int __init sec_bootstat_init(void)
 	if (device_create_file(dev, &dev_attr_boot_stat) < 0)
 		pr_err("%s: Failed to create device file\n", __func__);
 
+	// debugfs
+	debugfs_create_file("boot_trace.json", 0400, NULL, NULL,
+			&boot_trace_fops);
+
 	return 0;
 }
 
@@ -989,49 +989,86 @@ int sec_debug_enter_upload(void)
 
 #if defined(CONFIG_SEC_DUMP_SUMMARY)
 
+/* both keys are only enabled once summary_info is set up */
+DEFINE_STATIC_KEY_FALSE(sec_debug_sched_log_key);
+DEFINE_STATIC_KEY_FALSE(sec_debug_irq_log_key);
+
+#define SCHED_LOG_LEVEL_OFF	0
+#define SCHED_LOG_LEVEL_SCHED	1
+#define SCHED_LOG_LEVEL_IRQ	2
+
+static unsigned int sched_log_level = SCHED_LOG_LEVEL_IRQ;
+static DEFINE_MUTEX(sched_log_level_lock);
+
+static void sec_debug_sched_log_apply(void)
+{
+	bool sched = summary_info && sched_log_level >= SCHED_LOG_LEVEL_SCHED;
+	bool irq = summary_info && sched_log_level >= SCHED_LOG_LEVEL_IRQ;
+
+	mutex_lock(&sched_log_level_lock);
+	if (sched != static_key_enabled(&sec_debug_sched_log_key)) {
+		if (sched)
+			static_branch_enable(&sec_debug_sched_log_key);
+		else
+			static_branch_disable(&sec_debug_sched_log_key);
+	}
+	if (irq != static_key_enabled(&sec_debug_irq_log_key)) {
+		if (irq)
+			static_branch_enable(&sec_debug_irq_log_key);
+		else
+			static_branch_disable(&sec_debug_irq_log_key);
+	}
+	mutex_unlock(&sched_log_level_lock);
+}
+
+static int sec_debug_sched_log_level_set(const char *val,
+					 const struct kernel_param *kp)
+{
+	unsigned int level;
+
+	if (kstrtouint(val, 0, &level) || level > SCHED_LOG_LEVEL_IRQ)
+		return -EINVAL;
+
+	sched_log_level = level;
+	sec_debug_sched_log_apply();
+
+	return 0;
+}
+
+static const struct kernel_param_ops sched_log_level_ops = {
+	.set = sec_debug_sched_log_level_set,
+	.get = param_get_uint,
+};
+module_param_cb(sched_log_level, &sched_log_level_ops, &sched_log_level, 0644);
+
 void __sec_debug_task_sched_log(int cpu, struct task_struct *task, char *msg)
 {
+	struct sched_log *log;
 	unsigned long i;
 
-	if (!summary_info)
-		return;
-
 	if (!task && !msg)
 		return;
 
 	i = atomic_inc_return(&summary_info->sched_log.idx_sched[cpu]) & (SCHED_LOG_MAX - 1);
-	summary_info->sched_log.sched[cpu][i].time = cpu_clock(cpu);
+	log = &summary_info->sched_log.sched[cpu][i];
+	log->time = cpu_clock(cpu);
 	if (task) {
-		strlcpy(summary_info->sched_log.sched[cpu][i].comm, task->comm,
-			sizeof(summary_info->sched_log.sched[cpu][i].comm));
-		summary_info->sched_log.sched[cpu][i].pid = task->pid;
-		summary_info->sched_log.sched[cpu][i].pTask = task;
+		/* comm is always NUL terminated within TASK_COMM_LEN */
+		memcpy(log->comm, task->comm, sizeof(log->comm));
+		log->pid = task->pid;
+		log->pTask = task;
 	} else {
-		strlcpy(summary_info->sched_log.sched[cpu][i].comm, msg,
-			sizeof(summary_info->sched_log.sched[cpu][i].comm));
-		summary_info->sched_log.sched[cpu][i].pid = -1;
-		summary_info->sched_log.sched[cpu][i].pTask = NULL;
+		strlcpy(log->comm, msg, sizeof(log->comm));
+		log->pid = -1;
+		log->pTask = NULL;
 	}
 }
 
-void sec_debug_task_sched_log_short_msg(char *msg)
-{
-	__sec_debug_task_sched_log(raw_smp_processor_id(), NULL, msg);
-}
-
-void sec_debug_task_sched_log(int cpu, struct task_struct *task)
-{
-	__sec_debug_task_sched_log(cpu, task, NULL);
-}
-
-void sec_debug_irq_sched_log(unsigned int irq, void *fn, int en)
+void __sec_debug_irq_sched_log(unsigned int irq, void *fn, int en)
 {
 	int cpu = smp_processor_id();
 	unsigned long i;
 
-	if (!summary_info)
-		return;
-
 	i = atomic_inc_return(&summary_info->sched_log.idx_irq[cpu]) & (SCHED_LOG_MAX - 1);
 	summary_info->sched_log.irq[cpu][i].time = cpu_clock(cpu);
 	summary_info->sched_log.irq[cpu][i].irq = irq;
@@ -1041,14 +1078,11 @@ void sec_debug_irq_sched_log(unsigned int irq, void *fn, int en)
 	summary_info->sched_log.irq[cpu][i].context = &cpu;
 }
 
-void sec_debug_irq_enterexit_log(unsigned int irq, unsigned long long start_time)
+void __sec_debug_irq_enterexit_log(unsigned int irq, unsigned long long start_time)
 {
 	int cpu = smp_processor_id();
 	unsigned long i;
 
-	if (!summary_info)
-		return;
-
 	i = atomic_inc_return(&summary_info->sched_log.idx_irq_exit[cpu]) & (SCHED_LOG_MAX - 1);
 	summary_info->sched_log.irq_exit[cpu][i].time = start_time;
 	summary_info->sched_log.irq_exit[cpu][i].end_time = cpu_clock(cpu);
@@ -1096,6 +1130,40 @@ static int __init sec_summary_log_setup(char *str)
 }
 __setup("sec_summary_log=", sec_summary_log_setup);
 
+/* the last context switches of each cpu, formatted only when we panic */
+#define SCHED_LOG_PANIC_DUMP	8
+
+static int sec_debug_sched_log_panic(struct notifier_block *nb,
+				     unsigned long event, void *buf)
+{
+	struct sched_log *log;
+	int cpu, n, idx;
+
+	if (!static_key_enabled(&sec_debug_sched_log_key))
+		return NOTIFY_DONE;
+
+	for_each_possible_cpu(cpu) {
+		idx = atomic_read(&summary_info->sched_log.idx_sched[cpu]);
+		if (idx < 0)
+			continue;
+
+		pr_emerg("sched_log cpu%d:\n", cpu);
+		for (n = min(idx + 1, SCHED_LOG_PANIC_DUMP) - 1; n >= 0; n--) {
+			log = &summary_info->sched_log.sched[cpu][(idx - n) & (SCHED_LOG_MAX - 1)];
+			pr_emerg("  [%llu.%06llu] %-16.16s %d\n",
+				 log->time / NSEC_PER_SEC,
+				 (log->time % NSEC_PER_SEC) / NSEC_PER_USEC,
+				 log->comm, log->pid);
+		}
+	}
+
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block sec_debug_sched_log_panic_block = {
+	.notifier_call = sec_debug_sched_log_panic,
+};
+
 int sec_debug_summary_init(void)
 {
 	int offset = 0;
@@ -1136,6 +1204,9 @@ int sec_debug_summary_init(void)
 
 	sec_debug_set_kallsyms_info(&(summary_info->ksyms), SEC_DEBUG_SUMMARY_MAGIC1);
 
+	sec_debug_sched_log_apply();
+	atomic_notifier_chain_register(&panic_notifier_list, &sec_debug_sched_log_panic_block);
+
 	pr_debug("%s done [%d]\n", __func__, offset);
 
 	return 0;
@@ -8,13 +8,17 @@
  */
 
 #include <linux/cpumask.h>
+#include <linux/debugfs.h>
 #include <linux/device.h>
 #include <linux/err.h>
+#include <linux/mm.h>
 #include <linux/platform_device.h>
+#include <linux/sec_heavy_task_cpu.h>
 #include <linux/sec_sysfs.h>
 #include <linux/sysfs.h>
 #include <linux/threads.h>
 #include <linux/types.h>
+#include <linux/vmalloc.h>
 
 #include "../../../kernel/sched/sched.h"
 
@@ -57,6 +61,168 @@ static ssize_t heavy_task_cpu_show(struct device *dev, struct device_attribute *
 
 static DEVICE_ATTR(heavy_task_cpu, 0444, heavy_task_cpu_show, NULL);
 
+#ifdef CONFIG_SEC_HEAVY_TASK_CPU_PROFILER
+#define HTC_NR_RECORDS		256
+#define HTC_NR_SLOTS		16
+#define HTC_WINDOW_MS		1000
+
+/*
+ * Per-cpu sampler: every tick is charged to the running task in a small
+ * table of candidates. When the window ends, the top SEC_HTC_TOP_TASKS
+ * tasks are written into the cpu's ring buffer and the table starts over.
+ * Everything runs on the owning cpu from the tick, so no locking is needed.
+ */
+struct htc_slot {
+	pid_t pid;
+	unsigned int ticks;
+	char comm[TASK_COMM_LEN];
+};
+
+struct htc_cpu {
+	struct sec_htc_header *buf;
+	u64 window_start;
+	struct htc_slot slot[HTC_NR_SLOTS];
+};
+
+static DEFINE_PER_CPU(struct htc_cpu, htc_cpu);
+static bool htc_enabled;
+static unsigned int htc_window_ms = HTC_WINDOW_MS;
+
+static void htc_account(struct htc_cpu *hc, struct task_struct *p)
+{
+	struct htc_slot *slot, *victim = &hc->slot[0];
+	int i;
+
+	for (i = 0; i < HTC_NR_SLOTS; i++) {
+		slot = &hc->slot[i];
+		if (slot->pid == p->pid && slot->ticks) {
+			slot->ticks++;
+			return;
+		}
+		if (slot->ticks < victim->ticks)
+			victim = slot;
+	}
+
+	/* Replace the lightest candidate */
+	victim->pid = p->pid;
+	victim->ticks = 1;
+	memcpy(victim->comm, p->comm, TASK_COMM_LEN);
+}
+
+static void htc_flush(struct htc_cpu *hc, u64 now)
+{
+	struct sec_htc_header *hdr = hc->buf;
+	struct sec_htc_record *rec;
+	unsigned int tick_ms = jiffies_to_msecs(1);
+	int i, j, n = 0;
+
+	rec = &hdr->record[hdr->head % hdr->nr_records];
+	rec->timestamp_ns = now;
+	rec->window_ms = div_u64(now - hc->window_start, NSEC_PER_MSEC);
+
+	/* Selection sort of the few top entries out of the slots */
+	for (i = 0; i < SEC_HTC_TOP_TASKS; i++) {
+		struct htc_slot *top = NULL;
+
+		for (j = 0; j < HTC_NR_SLOTS; j++)
+			if (hc->slot[j].ticks &&
+			    (!top || hc->slot[j].ticks > top->ticks))
+				top = &hc->slot[j];
+		if (!top)
+			break;
+
+		rec->task[n].pid = top->pid;
+		rec->task[n].runtime_ms = top->ticks * tick_ms;
+		memcpy(rec->task[n].comm, top->comm, sizeof(rec->task[n].comm));
+		top->ticks = 0;
+		n++;
+	}
+	rec->nr_tasks = n;
+
+	/* Publish the record before moving head past it */
+	smp_wmb();
+	WRITE_ONCE(hdr->head, hdr->head + 1);
+
+	memset(hc->slot, 0, sizeof(hc->slot));
+	hc->window_start = now;
+}
+
+void sec_heavy_task_cpu_tick(int cpu, struct task_struct *curr)
+{
+	struct htc_cpu *hc = &per_cpu(htc_cpu, cpu);
+	u64 now;
+
+	if (!READ_ONCE(htc_enabled) || !hc->buf)
+		return;
+
+	now = local_clock();
+	if (now - hc->window_start >= (u64)htc_window_ms * NSEC_PER_MSEC)
+		htc_flush(hc, now);
+
+	if (!is_idle_task(curr))
+		htc_account(hc, curr);
+}
+
+static int htc_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct sec_htc_header *hdr = file->private_data;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	return remap_vmalloc_range(vma, hdr, vma->vm_pgoff);
+}
+
+static ssize_t htc_read(struct file *file, char __user *buf,
+			size_t count, loff_t *ppos)
+{
+	struct sec_htc_header *hdr = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, hdr,
+			offsetof(struct sec_htc_header, record[hdr->nr_records]));
+}
+
+static const struct file_operations htc_fops = {
+	.open	= simple_open,
+	.read	= htc_read,
+	.mmap	= htc_mmap,
+	.llseek	= default_llseek,
+};
+
+static void __init htc_init(void)
+{
+	struct dentry *dir;
+	size_t size = offsetof(struct sec_htc_header, record[HTC_NR_RECORDS]);
+	char name[8];
+	int cpu;
+
+	dir = debugfs_create_dir("sec_heavy_task_cpu", NULL);
+	if (IS_ERR_OR_NULL(dir))
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct htc_cpu *hc = &per_cpu(htc_cpu, cpu);
+		struct sec_htc_header *hdr = vmalloc_user(size);
+
+		if (!hdr)
+			continue;
+
+		hdr->version = 1;
+		hdr->nr_records = HTC_NR_RECORDS;
+		hc->window_start = local_clock();
+		hc->buf = hdr;
+
+		snprintf(name, sizeof(name), "cpu%d", cpu);
+		debugfs_create_file(name, 0400, dir, hdr, &htc_fops);
+	}
+
+	debugfs_create_bool("enabled", 0600, dir, &htc_enabled);
+	debugfs_create_u32("window_ms", 0600, dir, &htc_window_ms);
+}
+#else
+static inline void htc_init(void) { }
+#endif
+
 static struct attribute *heavy_task_cpu_attributes[] = {
 	&dev_attr_heavy_task_cpu.attr,
 	NULL
@@ -81,6 +247,8 @@ int __init heavy_task_cpu_init(void)
 	if (ret)
 		dev_err(dev, "failed to create sysfs group\n");
 
+	htc_init();
+
 	return 0;
 }
 late_initcall(heavy_task_cpu_init);
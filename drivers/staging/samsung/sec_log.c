@@ -17,6 +17,7 @@
 #include <linux/module.h>
 #include <linux/uaccess.h>
 #include <linux/proc_fs.h>
+#include <linux/percpu.h>
 #ifdef CONFIG_NO_BOOTMEM
 #include <linux/memblock.h>
 #endif
@@ -250,15 +251,13 @@ static int __init sec_tsp_log_setup(char *str)
 }
 __setup("sec_tsp_log=", sec_tsp_log_setup);
 
-static int sec_tsp_log_timestamp(unsigned long idx)
+static int sec_tsp_log_timestamp(unsigned long idx, unsigned long long t)
 {
-	/* Add the current time stamp */
+	/* Add the time stamp of the log */
 	char tbuf[50];
 	unsigned int tlen;
-	unsigned long long t;
 	unsigned long nanosec_rem;
 
-	t = local_clock();
 	nanosec_rem = do_div(t, 1000000000);
 	tlen = sprintf(tbuf, "[%5lu.%06lu] ", (unsigned long)t,
 		       nanosec_rem / 1000);
@@ -303,36 +302,256 @@ static int sec_tsp_raw_data_timestamp(unsigned long idx)
 }
 
 #define TSP_BUF_SIZE 512
-void sec_debug_tsp_log(char *fmt, ...)
+
+/* Store one log line, prefixed by msg when there is one */
+static void sec_tsp_log_emit(unsigned long long t, const char *msg,
+			     const char *buf)
 {
-	va_list args;
-	char buf[TSP_BUF_SIZE];
 	int len = 0;
-	unsigned long idx;
-	unsigned long size;
-
-	/* In case of sec_tsp_log_setup is failed */
-	if (!sec_tsp_log_size)
-		return;
-	va_start(args, fmt);
-	vsnprintf(buf, sizeof(buf), fmt, args);
-	va_end(args);
+	unsigned int idx;
+	size_t size;
+	size_t size_dev_name;
 
 	idx = *sec_tsp_log_ptr;
 	size = strlen(buf);
 
-	idx = sec_tsp_log_timestamp(idx);
+	idx = sec_tsp_log_timestamp(idx, t);
+
+	if (!msg) {
+		/* Overflow buffer size */
+		if (idx + size > sec_tsp_log_size - 1) {
+			len = scnprintf(&sec_tsp_log_buf[0],
+					size + 1, "%s\n", buf);
+			*sec_tsp_log_ptr = len;
+		} else {
+			len = scnprintf(&sec_tsp_log_buf[idx], size + 1, "%s\n", buf);
+			*sec_tsp_log_ptr += len;
+		}
+		return;
+	}
+
+	size_dev_name = strlen(msg);
 
 	/* Overflow buffer size */
-	if (idx + size > sec_tsp_log_size - 1) {
+	if (idx + size + size_dev_name + 3 + 1 > sec_tsp_log_size) {
 		len = scnprintf(&sec_tsp_log_buf[0],
-				size + 1, "%s\n", buf);
+				size + size_dev_name + 3 + 1,
+				"%s : %s", msg, buf);
 		*sec_tsp_log_ptr = len;
 	} else {
-		len = scnprintf(&sec_tsp_log_buf[idx], size + 1, "%s\n", buf);
+		len = scnprintf(&sec_tsp_log_buf[idx],
+				size + size_dev_name + 3 + 1,
+				"%s : %s", msg, buf);
 		*sec_tsp_log_ptr += len;
 	}
 }
+
+#ifdef CONFIG_SEC_DEBUG_TSP_LOG_PERCPU
+/*
+ * The touch drivers log on every event. Instead of formatting into the
+ * shared buffer, the caller only saves the format and its binary
+ * arguments into a ring of its own CPU. The rings are formatted into
+ * sec_tsp_log_buf in time order when tsp_msg is read, or on panic so
+ * that the reserved buffer still holds the text for the ramdump.
+ */
+#define TSP_PCPU_RECORDS	128
+#define TSP_MSG_SIZE		48
+#define TSP_ARGS_WORDS		30
+
+struct sec_tsp_record {
+	unsigned long long ts_nsec;
+	const char *fmt;	/* NULL if args holds the formatted text */
+	char msg[TSP_MSG_SIZE];
+	u32 args[TSP_ARGS_WORDS];
+};
+
+struct sec_tsp_pcpu_log {
+	unsigned int head;
+	unsigned int tail;	/* only touched by the drain */
+	struct sec_tsp_record rec[TSP_PCPU_RECORDS];
+};
+
+static struct sec_tsp_pcpu_log __percpu *sec_tsp_pcpu_log;
+static DEFINE_RAW_SPINLOCK(sec_tsp_drain_lock);
+
+static bool sec_tsp_log_record(const char *msg, const char *fmt, va_list args)
+{
+	struct sec_tsp_pcpu_log *log;
+	struct sec_tsp_record *rec;
+	unsigned long flags;
+	va_list copy;
+	int words;
+
+	if (!sec_tsp_pcpu_log)
+		return false;
+
+	local_irq_save(flags);
+	log = this_cpu_ptr(sec_tsp_pcpu_log);
+	rec = &log->rec[log->head % TSP_PCPU_RECORDS];
+
+	rec->ts_nsec = local_clock();
+	if (msg)
+		strlcpy(rec->msg, msg, sizeof(rec->msg));
+	else
+		rec->msg[0] = '\0';
+
+	va_copy(copy, args);
+	words = vbin_printf(rec->args, TSP_ARGS_WORDS, fmt, copy);
+	va_end(copy);
+	if (words >= 0 && words <= TSP_ARGS_WORDS) {
+		rec->fmt = fmt;
+	} else {
+		/* too many arguments to keep in binary, keep the text */
+		vscnprintf((char *)rec->args, sizeof(rec->args), fmt, args);
+		rec->fmt = NULL;
+	}
+
+	/* publish the record before the drain can see it */
+	smp_wmb();
+	log->head++;
+	local_irq_restore(flags);
+
+	return true;
+}
+
+static void sec_tsp_log_emit_record(struct sec_tsp_record *rec)
+{
+	char buf[TSP_BUF_SIZE];
+
+	if (rec->fmt)
+		bstr_printf(buf, sizeof(buf), rec->fmt, rec->args);
+	else
+		strlcpy(buf, (char *)rec->args, sizeof(buf));
+
+	sec_tsp_log_emit(rec->ts_nsec, rec->msg[0] ? rec->msg : NULL, buf);
+}
+
+/*
+ * Copy the oldest pending record of a CPU. A record that a writer
+ * lapped while it was being copied is dropped.
+ */
+static bool sec_tsp_log_peek(struct sec_tsp_pcpu_log *log,
+			     struct sec_tsp_record *rec)
+{
+	unsigned int head;
+
+	for (;;) {
+		head = READ_ONCE(log->head);
+		smp_rmb();
+
+		/* the slot at head may be under a write already */
+		if (head - log->tail >= TSP_PCPU_RECORDS)
+			log->tail = head - TSP_PCPU_RECORDS + 1;
+		if (log->tail == head)
+			return false;
+
+		memcpy(rec, &log->rec[log->tail % TSP_PCPU_RECORDS],
+		       sizeof(*rec));
+		smp_rmb();
+
+		if (READ_ONCE(log->head) - log->tail < TSP_PCPU_RECORDS)
+			return true;
+	}
+}
+
+static void sec_tsp_log_drain(void)
+{
+	static struct sec_tsp_record rec, oldest;
+	struct sec_tsp_pcpu_log *log, *next;
+	unsigned long flags;
+	int cpu;
+
+	if (!sec_tsp_pcpu_log)
+		return;
+
+	if (oops_in_progress) {
+		if (!raw_spin_trylock_irqsave(&sec_tsp_drain_lock, flags))
+			return;
+	} else {
+		raw_spin_lock_irqsave(&sec_tsp_drain_lock, flags);
+	}
+
+	for (;;) {
+		next = NULL;
+		for_each_possible_cpu(cpu) {
+			log = per_cpu_ptr(sec_tsp_pcpu_log, cpu);
+			if (!sec_tsp_log_peek(log, &rec))
+				continue;
+			if (!next || rec.ts_nsec < oldest.ts_nsec) {
+				next = log;
+				oldest = rec;
+			}
+		}
+		if (!next)
+			break;
+
+		next->tail++;
+		sec_tsp_log_emit_record(&oldest);
+	}
+
+	raw_spin_unlock_irqrestore(&sec_tsp_drain_lock, flags);
+}
+
+static int sec_tsp_log_panic(struct notifier_block *nb,
+			     unsigned long event, void *data)
+{
+	sec_tsp_log_drain();
+
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block sec_tsp_log_panic_nb = {
+	.notifier_call = sec_tsp_log_panic,
+};
+
+static int __init sec_tsp_log_pcpu_init(void)
+{
+	if (!sec_tsp_log_buf)
+		return 0;
+
+	sec_tsp_pcpu_log = alloc_percpu(struct sec_tsp_pcpu_log);
+	if (!sec_tsp_pcpu_log) {
+		pr_err("%s: failed to allocate per-cpu log\n", __func__);
+		return -ENOMEM;
+	}
+
+	atomic_notifier_chain_register(&panic_notifier_list,
+				       &sec_tsp_log_panic_nb);
+
+	return 0;
+}
+fs_initcall(sec_tsp_log_pcpu_init);	/* earlier than device_initcall */
+#else
+static inline bool sec_tsp_log_record(const char *msg, const char *fmt,
+				      va_list args)
+{
+	return false;
+}
+
+static inline void sec_tsp_log_drain(void)
+{
+}
+#endif /* CONFIG_SEC_DEBUG_TSP_LOG_PERCPU */
+
+void sec_debug_tsp_log(char *fmt, ...)
+{
+	va_list args;
+	char buf[TSP_BUF_SIZE];
+	bool recorded;
+
+	/* In case of sec_tsp_log_setup is failed */
+	if (!sec_tsp_log_size)
+		return;
+
+	va_start(args, fmt);
+	recorded = sec_tsp_log_record(NULL, fmt, args);
+	if (!recorded)
+		vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+
+	if (!recorded)
+		sec_tsp_log_emit(local_clock(), NULL, buf);
+}
 EXPORT_SYMBOL(sec_debug_tsp_log);
 
 void sec_debug_tsp_raw_data(char *fmt, ...)
@@ -371,36 +590,20 @@ void sec_debug_tsp_log_msg(char *msg, char *fmt, ...)
 {
 	va_list args;
 	char buf[TSP_BUF_SIZE];
-	int len = 0;
-	unsigned int idx;
-	size_t size;
-	size_t size_dev_name;
+	bool recorded;
 
 	/* In case of sec_tsp_log_setup is failed */
 	if (!sec_tsp_log_size)
 		return;
+
 	va_start(args, fmt);
-	vsnprintf(buf, sizeof(buf), fmt, args);
+	recorded = sec_tsp_log_record(msg, fmt, args);
+	if (!recorded)
+		vsnprintf(buf, sizeof(buf), fmt, args);
 	va_end(args);
 
-	idx = *sec_tsp_log_ptr;
-	size = strlen(buf);
-	size_dev_name = strlen(msg);
-
-	idx = sec_tsp_log_timestamp(idx);
-
-	/* Overflow buffer size */
-	if (idx + size + size_dev_name + 3 + 1 > sec_tsp_log_size) {
-		len = scnprintf(&sec_tsp_log_buf[0],
-				size + size_dev_name + 3 + 1,
-				"%s : %s", msg, buf);
-		*sec_tsp_log_ptr = len;
-	} else {
-		len = scnprintf(&sec_tsp_log_buf[idx],
-				size + size_dev_name + 3 + 1,
-				"%s : %s", msg, buf);
-		*sec_tsp_log_ptr += len;
-	}
+	if (!recorded)
+		sec_tsp_log_emit(local_clock(), msg, buf);
 }
 EXPORT_SYMBOL(sec_debug_tsp_log_msg);
 
@@ -530,6 +733,9 @@ static ssize_t sec_tsp_log_read(struct file *file, char __user *buf,
 	if (!sec_tsp_log_buf)
 		return 0;
 
+	if (pos == 0)
+		sec_tsp_log_drain();
+
 	if (pos >= *sec_tsp_log_ptr)
 		return 0;
 
@@ -0,0 +1,336 @@
+/*
+ *  linux/drivers/thermal/charger_cooling.c
+ *
+ *  Charge current as a cooling device
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ * Fast charging heats the same chassis as the SoC, but the charger and
+ * the thermal zones used to throttle on their own, so charging while
+ * gaming throttled the CPU and GPU as hard as if the charger were not
+ * there. Bound to a power_allocator zone, the charger becomes one more
+ * power actor: the governor splits the budget between it and the CPU
+ * and GPU by their requests and weights, so a busy foreground app takes
+ * headroom from the charge current and an idle one gives it back.
+ *
+ * The node lists the charge current of each cooling state and the heat
+ * in mW it causes, highest current first:
+ *
+ *	charger_cooling: charger-cooling {
+ *		compatible = "samsung,charger-cooling";
+ *		power-supply = "battery";
+ *		charge-current-ma = <3000 2000 1500 1000 500>;
+ *		charge-power-mw = <1500 900 650 400 200>;
+ *		#cooling-cells = <2>;
+ *	};
+ *
+ * The limit is applied through POWER_SUPPLY_PROP_CONSTANT_CHARGE_CURRENT_MAX.
+ * Policy is in sysfs: the zone's cdevN_weight sets how the charger competes
+ * with the other actors, and min_current_ma on the platform device keeps
+ * the governor from throttling charging below a floor.
+ */
+#include <linux/module.h>
+#include <linux/platform_device.h>
+#include <linux/of.h>
+#include <linux/slab.h>
+#include <linux/power_supply.h>
+#include <linux/thermal.h>
+
+/**
+ * struct charger_cooling_device - data for the charger cooling device
+ * @cool_dev: the registered thermal cooling device
+ * @psy_name: name of the power supply the limit is applied to
+ * @current_ma: charge current of each cooling state
+ * @power_mw: heat caused by charging at each cooling state
+ * @max_state: highest cooling state
+ * @state: current cooling state
+ * @min_current_ma: charge current the governor may not go below
+ * @lock: protects @state and @min_current_ma
+ */
+struct charger_cooling_device {
+	struct thermal_cooling_device *cool_dev;
+	const char *psy_name;
+	u32 *current_ma;
+	u32 *power_mw;
+	unsigned long max_state;
+	unsigned long state;
+	u32 min_current_ma;
+	struct mutex lock;
+};
+
+/* deepest state the floor allows, called with ccdev->lock held */
+static unsigned long charger_floor_state(struct charger_cooling_device *ccdev)
+{
+	unsigned long state = ccdev->max_state;
+
+	while (state && ccdev->current_ma[state] < ccdev->min_current_ma)
+		state--;
+
+	return state;
+}
+
+static bool charger_is_charging(struct charger_cooling_device *ccdev)
+{
+	union power_supply_propval val;
+	struct power_supply *psy;
+	int ret;
+
+	psy = power_supply_get_by_name(ccdev->psy_name);
+	if (!psy)
+		return false;
+
+	ret = power_supply_get_property(psy, POWER_SUPPLY_PROP_STATUS, &val);
+	power_supply_put(psy);
+
+	return !ret && val.intval == POWER_SUPPLY_STATUS_CHARGING;
+}
+
+static int charger_apply_state(struct charger_cooling_device *ccdev,
+			       unsigned long state)
+{
+	union power_supply_propval val;
+	struct power_supply *psy;
+	int ret;
+
+	psy = power_supply_get_by_name(ccdev->psy_name);
+	if (!psy)
+		return -ENODEV;
+
+	val.intval = ccdev->current_ma[state] * 1000;
+	ret = power_supply_set_property(psy,
+			POWER_SUPPLY_PROP_CONSTANT_CHARGE_CURRENT_MAX, &val);
+	power_supply_put(psy);
+
+	return ret;
+}
+
+static int charger_get_max_state(struct thermal_cooling_device *cdev,
+				 unsigned long *state)
+{
+	struct charger_cooling_device *ccdev = cdev->devdata;
+
+	*state = ccdev->max_state;
+
+	return 0;
+}
+
+static int charger_get_cur_state(struct thermal_cooling_device *cdev,
+				 unsigned long *state)
+{
+	struct charger_cooling_device *ccdev = cdev->devdata;
+
+	*state = ccdev->state;
+
+	return 0;
+}
+
+static int charger_set_cur_state(struct thermal_cooling_device *cdev,
+				 unsigned long state)
+{
+	struct charger_cooling_device *ccdev = cdev->devdata;
+	int ret = 0;
+
+	if (state > ccdev->max_state)
+		return -EINVAL;
+
+	mutex_lock(&ccdev->lock);
+	state = min(state, charger_floor_state(ccdev));
+	if (state != ccdev->state) {
+		ret = charger_apply_state(ccdev, state);
+		if (!ret)
+			ccdev->state = state;
+	}
+	mutex_unlock(&ccdev->lock);
+
+	return ret;
+}
+
+/*
+ * The charger asks for the power of full speed charging while it
+ * charges and nothing otherwise, so an idle charger leaves the whole
+ * budget to the other actors.
+ */
+static int charger_get_requested_power(struct thermal_cooling_device *cdev,
+				       struct thermal_zone_device *tz,
+				       u32 *power)
+{
+	struct charger_cooling_device *ccdev = cdev->devdata;
+
+	*power = charger_is_charging(ccdev) ? ccdev->power_mw[0] : 0;
+
+	return 0;
+}
+
+static int charger_state2power(struct thermal_cooling_device *cdev,
+			       struct thermal_zone_device *tz,
+			       unsigned long state, u32 *power)
+{
+	struct charger_cooling_device *ccdev = cdev->devdata;
+
+	if (state > ccdev->max_state)
+		return -EINVAL;
+
+	*power = ccdev->power_mw[state];
+
+	return 0;
+}
+
+static int charger_power2state(struct thermal_cooling_device *cdev,
+			       struct thermal_zone_device *tz, u32 power,
+			       unsigned long *state)
+{
+	struct charger_cooling_device *ccdev = cdev->devdata;
+	unsigned long i;
+
+	for (i = 0; i < ccdev->max_state; i++)
+		if (ccdev->power_mw[i] <= power)
+			break;
+	*state = i;
+
+	return 0;
+}
+
+static const struct thermal_cooling_device_ops charger_cooling_ops = {
+	.get_max_state = charger_get_max_state,
+	.get_cur_state = charger_get_cur_state,
+	.set_cur_state = charger_set_cur_state,
+	.get_requested_power = charger_get_requested_power,
+	.state2power = charger_state2power,
+	.power2state = charger_power2state,
+};
+
+static ssize_t min_current_ma_show(struct device *dev,
+				   struct device_attribute *attr, char *buf)
+{
+	struct charger_cooling_device *ccdev = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n", ccdev->min_current_ma);
+}
+
+static ssize_t min_current_ma_store(struct device *dev,
+				    struct device_attribute *attr,
+				    const char *buf, size_t count)
+{
+	struct charger_cooling_device *ccdev = dev_get_drvdata(dev);
+	unsigned long floor;
+	u32 val;
+	int ret;
+
+	ret = kstrtou32(buf, 0, &val);
+	if (ret)
+		return ret;
+
+	mutex_lock(&ccdev->lock);
+	ccdev->min_current_ma = val;
+	floor = charger_floor_state(ccdev);
+	if (ccdev->state > floor && !charger_apply_state(ccdev, floor))
+		ccdev->state = floor;
+	mutex_unlock(&ccdev->lock);
+
+	return count;
+}
+static DEVICE_ATTR_RW(min_current_ma);
+
+static ssize_t current_ma_show(struct device *dev,
+			       struct device_attribute *attr, char *buf)
+{
+	struct charger_cooling_device *ccdev = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			ccdev->current_ma[ccdev->state]);
+}
+static DEVICE_ATTR_RO(current_ma);
+
+static struct attribute *charger_cooling_attrs[] = {
+	&dev_attr_min_current_ma.attr,
+	&dev_attr_current_ma.attr,
+	NULL,
+};
+
+static const struct attribute_group charger_cooling_attr_group = {
+	.attrs = charger_cooling_attrs,
+};
+
+static int charger_cooling_probe(struct platform_device *pdev)
+{
+	struct device_node *np = pdev->dev.of_node;
+	struct charger_cooling_device *ccdev;
+	int count, ret;
+
+	ccdev = devm_kzalloc(&pdev->dev, sizeof(*ccdev), GFP_KERNEL);
+	if (!ccdev)
+		return -ENOMEM;
+
+	if (of_property_read_string(np, "power-supply", &ccdev->psy_name))
+		return -EINVAL;
+
+	count = of_property_count_u32_elems(np, "charge-current-ma");
+	if (count <= 0 ||
+	    count != of_property_count_u32_elems(np, "charge-power-mw"))
+		return -EINVAL;
+
+	ccdev->current_ma = devm_kcalloc(&pdev->dev, count, sizeof(u32),
+					 GFP_KERNEL);
+	ccdev->power_mw = devm_kcalloc(&pdev->dev, count, sizeof(u32),
+				       GFP_KERNEL);
+	if (!ccdev->current_ma || !ccdev->power_mw)
+		return -ENOMEM;
+
+	of_property_read_u32_array(np, "charge-current-ma",
+				   ccdev->current_ma, count);
+	of_property_read_u32_array(np, "charge-power-mw",
+				   ccdev->power_mw, count);
+	ccdev->max_state = count - 1;
+	mutex_init(&ccdev->lock);
+
+	platform_set_drvdata(pdev, ccdev);
+
+	ret = sysfs_create_group(&pdev->dev.kobj, &charger_cooling_attr_group);
+	if (ret)
+		return ret;
+
+	ccdev->cool_dev = thermal_of_cooling_device_register(np,
+				"thermal-charger", ccdev, &charger_cooling_ops);
+	if (IS_ERR(ccdev->cool_dev)) {
+		sysfs_remove_group(&pdev->dev.kobj, &charger_cooling_attr_group);
+		return PTR_ERR(ccdev->cool_dev);
+	}
+
+	return 0;
+}
+
+static int charger_cooling_remove(struct platform_device *pdev)
+{
+	struct charger_cooling_device *ccdev = platform_get_drvdata(pdev);
+
+	thermal_cooling_device_unregister(ccdev->cool_dev);
+	sysfs_remove_group(&pdev->dev.kobj, &charger_cooling_attr_group);
+
+	return 0;
+}
+
+static const struct of_device_id charger_cooling_match[] = {
+	{ .compatible = "samsung,charger-cooling", },
+	{ },
+};
+MODULE_DEVICE_TABLE(of, charger_cooling_match);
+
+static struct platform_driver charger_cooling_driver = {
+	.probe = charger_cooling_probe,
+	.remove = charger_cooling_remove,
+	.driver = {
+		.name = "charger-cooling",
+		.of_match_table = charger_cooling_match,
+	},
+};
+module_platform_driver(charger_cooling_driver);
+
+MODULE_DESCRIPTION("Charge current cooling device");
+MODULE_LICENSE("GPL v2");
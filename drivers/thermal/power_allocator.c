@@ -343,6 +343,59 @@ static void divvy_up_power(u32 *req_power, u32 *max_power, int num_actors,
 					extra_power) / capped_extra_power;
 }
 
+#ifdef CONFIG_THERMAL_POWER_ALLOCATOR_FPS
+/* how strongly a frame deficit biases the split towards saturated actors */
+#define FPS_FEEDBACK_GAIN	int_to_frac(2)
+
+/**
+ * apply_frame_feedback() - bias the weighted requests by frame rate
+ * @tz:		thermal zone we are operating in
+ * @req_power:	power requested by each actor
+ * @max_power:	maximum power of each actor
+ * @weighted_req_power:	weighted requests, updated in place
+ * @num_actors:	number of actors
+ *
+ * An actor requesting close to its maximum power is the one limiting
+ * the frame rate, while the others have headroom they don't use.  When
+ * the zone misses its frame rate target, scale each weighted request
+ * up by the frame deficit times the saturation of the actor, so that
+ * divvy_up_power() hands the bottleneck a larger share of the budget.
+ *
+ * Return: the new total of the weighted requests.
+ */
+static u32 apply_frame_feedback(struct thermal_zone_device *tz,
+				u32 *req_power, u32 *max_power,
+				u32 *weighted_req_power, int num_actors)
+{
+	s32 target = tz->tzp->fps_target, cur = tz->tzp->fps_cur;
+	u32 total_weighted_req_power = 0;
+	s64 deficit = 0;
+	int i;
+
+	if (target > 0 && cur > 0 && cur < target)
+		deficit = div_frac(target - cur, target);
+
+	for (i = 0; i < num_actors; i++) {
+		s64 saturation, boost;
+
+		if (deficit) {
+			saturation = div_frac(req_power[i],
+					      max_t(u32, max_power[i], 1));
+			saturation = min_t(s64, saturation, int_to_frac(1));
+			boost = int_to_frac(1) +
+				mul_frac(mul_frac(FPS_FEEDBACK_GAIN, deficit),
+					 saturation);
+			weighted_req_power[i] = mul_frac(weighted_req_power[i],
+							 boost);
+		}
+
+		total_weighted_req_power += weighted_req_power[i];
+	}
+
+	return total_weighted_req_power;
+}
+#endif
+
 static int allocate_power(struct thermal_zone_device *tz,
 			  int control_temp)
 {
@@ -432,6 +485,11 @@ static int allocate_power(struct thermal_zone_device *tz,
 		i++;
 	}
 
+#ifdef CONFIG_THERMAL_POWER_ALLOCATOR_FPS
+	total_weighted_req_power = apply_frame_feedback(tz, req_power,
+				max_power, weighted_req_power, i);
+#endif
+
 	power_range = pid_controller(tz, control_temp, max_allocatable_power);
 
 	divvy_up_power(weighted_req_power, max_power, num_actors,
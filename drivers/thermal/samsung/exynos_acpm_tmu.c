@@ -27,6 +27,7 @@
 #include <linux/fs.h>
 #include <linux/file.h>
 #include <linux/debugfs.h>
+#include <linux/spinlock.h>
 #include <soc/samsung/acpm_ipc_ctrl.h>
 #include "exynos_acpm_tmu.h"
 
@@ -50,6 +51,154 @@ void exynos_acpm_tmu_log(bool mode)
 	acpm_tmu_log = mode;
 }
 
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+/*
+ * Band mode
+ *
+ * Every thermal zone poll costs a synchronous IPC to ACPM. While a sensor
+ * stays within a band well away from its trip points, the last reading is
+ * served from a cache instead. The cache of a zone is dropped when the
+ * TMU raises a trip interrupt, when ACPM firmware with CAP_APM_BAND
+ * reports that the sensor left the band, and around suspend. Without
+ * firmware support, a reading is also never older than
+ * ACPM_TMU_BAND_HOLD_MS.
+ */
+#define ACPM_TMU_MAX_TZ		8
+#define ACPM_TMU_BAND_HOLD_MS	500
+#define ACPM_TMU_FW_HOLD_MS	2000
+
+struct acpm_tmu_band {
+	int low;
+	int high;
+	int temp;
+	int stat;
+	unsigned long long stamp;
+	bool valid;
+};
+
+static struct acpm_tmu_band acpm_tmu_band[ACPM_TMU_MAX_TZ];
+static DEFINE_SPINLOCK(acpm_tmu_band_lock);
+static bool acpm_tmu_fw_band;
+static acpm_tmu_notify_t acpm_tmu_notify;
+
+static int __exynos_acpm_tmu_set_band(int tz, int low, int high);
+
+static bool acpm_tmu_band_lookup(int tz, int *temp, int *stat)
+{
+	struct acpm_tmu_band *band;
+	unsigned long long hold;
+	unsigned long flags;
+	bool hit = false;
+
+	if (tz < 0 || tz >= ACPM_TMU_MAX_TZ)
+		return false;
+
+	band = &acpm_tmu_band[tz];
+	hold = (acpm_tmu_fw_band ? ACPM_TMU_FW_HOLD_MS : ACPM_TMU_BAND_HOLD_MS) *
+		NSEC_PER_MSEC;
+
+	spin_lock_irqsave(&acpm_tmu_band_lock, flags);
+	if (band->valid && band->low < band->high &&
+			band->temp > band->low && band->temp < band->high &&
+			sched_clock() - band->stamp < hold) {
+		*temp = band->temp;
+		*stat = band->stat;
+		hit = true;
+	}
+	spin_unlock_irqrestore(&acpm_tmu_band_lock, flags);
+
+	return hit;
+}
+
+static void acpm_tmu_band_store(int tz, int temp, int stat)
+{
+	struct acpm_tmu_band *band;
+	unsigned long flags;
+
+	if (tz < 0 || tz >= ACPM_TMU_MAX_TZ)
+		return;
+
+	band = &acpm_tmu_band[tz];
+
+	spin_lock_irqsave(&acpm_tmu_band_lock, flags);
+	band->temp = temp;
+	band->stat = stat;
+	band->stamp = sched_clock();
+	band->valid = true;
+	spin_unlock_irqrestore(&acpm_tmu_band_lock, flags);
+}
+
+void exynos_acpm_tmu_invalidate(int tz)
+{
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&acpm_tmu_band_lock, flags);
+	for (i = 0; i < ACPM_TMU_MAX_TZ; i++)
+		if (tz < 0 || tz == i)
+			acpm_tmu_band[i].valid = false;
+	spin_unlock_irqrestore(&acpm_tmu_band_lock, flags);
+}
+
+/*
+ * Set the band of a thermal zone, in degrees Celsius. An empty band
+ * (low >= high) disables caching for the zone.
+ */
+void exynos_acpm_tmu_set_band(int tz, int low, int high)
+{
+	struct acpm_tmu_band *band;
+	unsigned long flags;
+
+	if (tz < 0 || tz >= ACPM_TMU_MAX_TZ)
+		return;
+
+	band = &acpm_tmu_band[tz];
+
+	spin_lock_irqsave(&acpm_tmu_band_lock, flags);
+	if (band->low == low && band->high == high) {
+		spin_unlock_irqrestore(&acpm_tmu_band_lock, flags);
+		return;
+	}
+	band->low = low;
+	band->high = high;
+	spin_unlock_irqrestore(&acpm_tmu_band_lock, flags);
+
+	if (acpm_tmu_fw_band && __exynos_acpm_tmu_set_band(tz, low, high))
+		acpm_tmu_fw_band = false;
+}
+
+void exynos_acpm_tmu_register_notify(acpm_tmu_notify_t fn)
+{
+	acpm_tmu_notify = fn;
+}
+
+/*
+ * Called for every message on the TMU channel, including the responses to
+ * our own requests, with the channel rx lock held.
+ */
+static void exynos_acpm_tmu_ipc_callback(unsigned int *cmd, unsigned int size)
+{
+	union tmu_ipc_message message;
+
+	memcpy(message.data, cmd, sizeof(message.data));
+
+	if (message.resp.type != TMU_IPC_BAND_NOTIFY)
+		return;
+
+	exynos_acpm_tmu_invalidate(message.resp.tzid);
+
+	if (acpm_tmu_notify)
+		acpm_tmu_notify(message.resp.tzid, message.resp.temp);
+}
+#else
+static inline bool acpm_tmu_band_lookup(int tz, int *temp, int *stat)
+{
+	return false;
+}
+static inline void acpm_tmu_band_store(int tz, int temp, int stat) { }
+#define exynos_acpm_tmu_ipc_callback	NULL
+#endif
+
 #define acpm_ipc_latency_check() \
 	do { \
 		if (acpm_tmu_log) { \
@@ -101,6 +250,13 @@ int exynos_acpm_tmu_set_init(struct acpm_tmu_cap *cap)
 	if (message.resp.ret & CAP_APM_DIVIDER)
 		cap->acpm_divider = true;
 
+	if (message.resp.ret & CAP_APM_BAND)
+		cap->acpm_band = true;
+
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+	acpm_tmu_fw_band = cap->acpm_band;
+#endif
+
 	return 0;
 }
 
@@ -119,6 +275,9 @@ int exynos_acpm_tmu_set_read_temp(int tz, int *temp, int *stat)
 	if (acpm_tmu_test_mode)
 		return -1;
 
+	if (acpm_tmu_band_lookup(tz, temp, stat))
+		return 0;
+
 	memset(&message, 0, sizeof(message));
 
 	message.req.type = TMU_IPC_READ_TEMP;
@@ -148,8 +307,54 @@ int exynos_acpm_tmu_set_read_temp(int tz, int *temp, int *stat)
 	*temp = message.resp.temp;
 	*stat = message.resp.stat;
 
+	acpm_tmu_band_store(tz, *temp, *stat);
+
+	return 0;
+}
+
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+/*
+ * TMU_IPC_SET_BAND
+ *
+ * - tz: thermal zone index registered in device tree
+ * - low, high: band in degrees Celsius
+ */
+static int __exynos_acpm_tmu_set_band(int tz, int low, int high)
+{
+	struct ipc_config config;
+	union tmu_ipc_message message;
+	int ret;
+	unsigned long long before, after, latency;
+
+	memset(&message, 0, sizeof(message));
+
+	message.req.type = TMU_IPC_SET_BAND;
+	message.req.tzid = tz;
+	message.req.rsvd = clamp(low, 0, 255);
+	message.req.rsvd2 = clamp(high, 0, 255);
+
+	config.cmd = message.data;
+	config.response = true;
+	config.indirection = false;
+
+	before = sched_clock();
+	ret = acpm_ipc_send_data(acpm_tmu_ch_num, &config);
+	after = sched_clock();
+	latency = after - before;
+
+	acpm_ipc_err_check();
+	acpm_ipc_latency_check();
+
+	memcpy(message.data, config.cmd, sizeof(message.data));
+	if (message.resp.ret < 0) {
+		pr_warn("[acpm_tmu] band not supported by firmware, ret %d\n",
+				message.resp.ret);
+		return -1;
+	}
+
 	return 0;
 }
+#endif
 
 /*
  * TMU_IPC_AP_SUSPEND
@@ -163,6 +368,10 @@ int exynos_acpm_tmu_set_suspend(int flag)
 
 	memset(&message, 0, sizeof(message));
 
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+	exynos_acpm_tmu_invalidate(-1);
+#endif
+
 	message.req.type = TMU_IPC_AP_SUSPEND;
 	message.req.rsvd = flag;
 
@@ -240,6 +449,10 @@ int exynos_acpm_tmu_set_resume(void)
 
 	memset(&message, 0, sizeof(message));
 
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+	exynos_acpm_tmu_invalidate(-1);
+#endif
+
 	message.req.type = TMU_IPC_AP_RESUME;
 
 	config.cmd = message.data;
@@ -316,6 +529,7 @@ static int __init exynos_acpm_tmu_init(void)
 	if (!np)
 		return -ENODEV;
 
-	return acpm_ipc_request_channel(np, NULL, &acpm_tmu_ch_num, &acpm_tmu_size);
+	return acpm_ipc_request_channel(np, exynos_acpm_tmu_ipc_callback,
+			&acpm_tmu_ch_num, &acpm_tmu_size);
 }
 fs_initcall(exynos_acpm_tmu_init);
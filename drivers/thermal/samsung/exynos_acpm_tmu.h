@@ -37,6 +37,7 @@
 /* Return values - capabilities */
 #define CAP_APM_IRQ		0x1
 #define CAP_APM_DIVIDER		0x2
+#define CAP_APM_BAND		0x4
 
 /* IPC Request Types */
 #define TMU_IPC_INIT		0x01
@@ -44,6 +45,14 @@
 #define	TMU_IPC_AP_SUSPEND	0x04
 #define	TMU_IPC_CP_CALL		0x08
 #define	TMU_IPC_AP_RESUME	0x10
+#define	TMU_IPC_SET_BAND	0x20
+#define	TMU_IPC_BAND_NOTIFY	0x40
+
+/*
+ * TMU_IPC_SET_BAND carries the band in req.rsvd (low) and req.rsvd2 (high),
+ * in degrees Celsius. The firmware pushes TMU_IPC_BAND_NOTIFY with the
+ * current temp in resp.temp once the sensor leaves the band.
+ */
 
 /*
  * 16-byte TMU IPC message format (REQ)
@@ -105,8 +114,11 @@ union tmu_ipc_message {
 struct acpm_tmu_cap {
 	bool acpm_irq;
 	bool acpm_divider;
+	bool acpm_band;
 };
 
+typedef void (*acpm_tmu_notify_t)(int tz, int temp);
+
 int exynos_acpm_tmu_set_init(struct acpm_tmu_cap *cap);
 int exynos_acpm_tmu_set_read_temp(int tz, int *temp, int *stat);
 int exynos_acpm_tmu_set_suspend(int flag);
@@ -117,4 +129,14 @@ bool exynos_acpm_tmu_is_test_mode(void);
 void exynos_acpm_tmu_set_test_mode(bool mode);
 void exynos_acpm_tmu_log(bool mode);
 
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+void exynos_acpm_tmu_set_band(int tz, int low, int high);
+void exynos_acpm_tmu_invalidate(int tz);
+void exynos_acpm_tmu_register_notify(acpm_tmu_notify_t fn);
+#else
+static inline void exynos_acpm_tmu_set_band(int tz, int low, int high) { }
+static inline void exynos_acpm_tmu_invalidate(int tz) { }
+static inline void exynos_acpm_tmu_register_notify(acpm_tmu_notify_t fn) { }
+#endif
+
 #endif /* __EXYNOS_ACPM_TMU_H__ */
@@ -860,12 +860,79 @@ static int exynos_tmu_set_emulation(void *drv_data, int temp)
 static bool cpufreq_limited;
 static struct pm_qos_request thermal_cpu_limit_request;
 
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+/* distance in degrees Celsius kept from any trip point */
+#define ACPM_TMU_BAND_MARGIN	5
+
+/*
+ * Narrow the ACPM band of the zone to the trip points around temp, with
+ * the hysteresis of the trip below, so that readings near any trip,
+ * passive ones included, always go to ACPM.
+ */
+static void exynos_tmu_update_band(struct exynos_tmu_data *data, int temp)
+{
+	struct thermal_zone_device *tz = data->tzd;
+	int low = INT_MIN, high = INT_MAX;
+	int i, trip_temp, trip_hyst;
+
+	for (i = 0; i < of_thermal_get_ntrips(tz); i++) {
+		if (tz->ops->get_trip_temp(tz, i, &trip_temp))
+			continue;
+		trip_temp /= MCELSIUS;
+
+		if (trip_temp > temp) {
+			high = min(high, trip_temp);
+		} else {
+			if (tz->ops->get_trip_hyst && !tz->ops->get_trip_hyst(tz, i, &trip_hyst))
+				trip_temp -= trip_hyst / MCELSIUS;
+			low = max(low, trip_temp);
+		}
+	}
+
+	if (low != INT_MIN)
+		low += ACPM_TMU_BAND_MARGIN;
+	else
+		low = 0;
+	if (high != INT_MAX)
+		high -= ACPM_TMU_BAND_MARGIN;
+	else
+		high = EXYNOS_MAX_TEMP;
+
+	exynos_acpm_tmu_set_band(tz->id, low, high);
+}
+
+static void exynos_tmu_band_work(struct work_struct *work)
+{
+	struct exynos_tmu_data *data = container_of(work,
+			struct exynos_tmu_data, band_work);
+
+	exynos_report_trigger(data);
+}
+
+/* Called from ACPM IPC interrupt context when a sensor left its band */
+static void exynos_tmu_band_notify(int tz, int temp)
+{
+	struct exynos_tmu_data *data;
+
+	list_for_each_entry(data, &dtm_dev_list, node) {
+		if (!IS_ERR_OR_NULL(data->tzd) && data->tzd->id == tz) {
+			schedule_work(&data->band_work);
+			break;
+		}
+	}
+}
+#else
+static inline void exynos_tmu_update_band(struct exynos_tmu_data *data, int temp) { }
+#define exynos_tmu_band_notify	NULL
+#endif
+
 static int exynos9810_tmu_read(struct exynos_tmu_data *data)
 {
 	int temp = 0, stat = 0;
 
 #ifdef CONFIG_EXYNOS_ACPM_THERMAL
 	exynos_acpm_tmu_set_read_temp(data->tzd->id, &temp, &stat);
+	exynos_tmu_update_band(data, temp);
 #endif
 
 	if (data->hotplug_enable) {
@@ -888,6 +955,10 @@ static void exynos_tmu_work(struct work_struct *work)
 	struct exynos_tmu_data *data = container_of(work,
 			struct exynos_tmu_data, irq_work);
 
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL
+	/* A trip was crossed, so the cached ACPM reading is stale */
+	exynos_acpm_tmu_invalidate(data->tzd->id);
+#endif
 	exynos_report_trigger(data);
 	mutex_lock(&data->lock);
 
@@ -1549,6 +1620,9 @@ static int exynos_tmu_probe(struct platform_device *pdev)
 		goto err_sensor;
 
 	INIT_WORK(&data->irq_work, exynos_tmu_work);
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+	INIT_WORK(&data->band_work, exynos_tmu_band_work);
+#endif
 
 	/*
 	 * data->tzd must be registered before calling exynos_tmu_initialize(),
@@ -1616,12 +1690,14 @@ static int exynos_tmu_probe(struct platform_device *pdev)
 	num_of_devices++;
 	mutex_unlock(&data->lock);
 
-	if (list_is_singular(&dtm_dev_list))
+	if (list_is_singular(&dtm_dev_list)) {
 #ifdef CONFIG_EXYNOS_ACPM_THERMAL
 		exynos_acpm_tmu_set_init(&cap);
+		exynos_acpm_tmu_register_notify(exynos_tmu_band_notify);
 #else
 		register_pm_notifier(&exynos_tmu_pm_notifier);
 #endif
+	}
 
 	if (!IS_ERR(data->tzd))
 		data->tzd->ops->set_mode(data->tzd, THERMAL_DEVICE_ENABLED);
@@ -151,6 +151,9 @@ struct exynos_tmu_data {
 	int irq;
 	enum soc_type soc;
 	struct work_struct irq_work;
+#ifdef CONFIG_EXYNOS_ACPM_THERMAL_BAND
+	struct work_struct band_work;
+#endif
 	struct mutex lock;
 	u16 temp_error1, temp_error2;
 	struct thermal_zone_device *tzd;
@@ -1093,6 +1093,10 @@ create_s32_tzp_attr(integral_cutoff);
 create_s32_tzp_attr(slope);
 create_s32_tzp_attr(offset);
 create_s32_tzp_attr(integral_max);
+#ifdef CONFIG_THERMAL_POWER_ALLOCATOR_FPS
+create_s32_tzp_attr(fps_target);
+create_s32_tzp_attr(fps_cur);
+#endif
 #undef create_s32_tzp_attr
 
 static struct device_attribute *dev_tzp_attrs[] = {
@@ -1105,6 +1109,10 @@ static struct device_attribute *dev_tzp_attrs[] = {
 	&dev_attr_slope,
 	&dev_attr_offset,
 	&dev_attr_integral_max,
+#ifdef CONFIG_THERMAL_POWER_ALLOCATOR_FPS
+	&dev_attr_fps_target,
+	&dev_attr_fps_cur,
+#endif
 };
 
 static int create_tzp_attrs(struct device *dev)
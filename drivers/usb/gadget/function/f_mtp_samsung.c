@@ -53,6 +53,7 @@
 #include <linux/kernel.h>
 #include <linux/file.h>
 #include <linux/configfs.h>
+#include <linux/backing-dev.h>
 #include "f_mtp.h"
 #include "configfs.h"
 
@@ -102,6 +103,16 @@
 #define MTPG_MTPG_TX_REQ_MAX		8
 #define MTPG_INTR_REQ_MAX	5
 
+/*
+ * Bulk request sizes tried first, falling back to MTPG_BULK_BUFFER_SIZE
+ * when the buffers can not be allocated. Large requests keep a super
+ * speed link busy with much fewer completions and file reads.
+ */
+static unsigned int mtp_tx_req_len = 131072;
+module_param(mtp_tx_req_len, uint, S_IRUGO | S_IWUSR);
+static unsigned int mtp_rx_req_len = 131072;
+module_param(mtp_rx_req_len, uint, S_IRUGO | S_IWUSR);
+
 /* ID for Microsoft MTP OS String */
 #define MTPG_OS_STRING_ID   0xEE
 
@@ -148,6 +159,9 @@ struct mtpg_dev {
 	unsigned char		*read_buf;
 	unsigned		read_count;
 
+	unsigned int		tx_req_len;
+	unsigned int		rx_req_len;
+
 	struct usb_ep		*bulk_in;
 	struct usb_ep		*bulk_out;
 	struct usb_ep		*int_in;
@@ -666,7 +680,7 @@ static ssize_t mtpg_read(struct file *fp, char __user *buf,
 		DEBUG_MTPR("[%s]\t%d: get request\n", __func__, __LINE__);
 		while ((req = mtpg_req_get(dev, &dev->rx_idle))) {
 requeue_req:
-			req->length = MTPG_BULK_BUFFER_SIZE;
+			req->length = dev->rx_req_len;
 			DEBUG_MTPR("[%s]\t%d:usb-ep-queue\n",
 						__func__, __LINE__);
 			ret = usb_ep_queue(dev->bulk_out, req, GFP_ATOMIC);
@@ -808,8 +822,8 @@ static ssize_t mtpg_write(struct file *fp, const char __user *buf,
 		}
 
 		if (req != 0) {
-			if (count > MTPG_BULK_BUFFER_SIZE)
-				xfer = MTPG_BULK_BUFFER_SIZE;
+			if (count > dev->tx_req_len)
+				xfer = dev->tx_req_len;
 			else
 				xfer = count;
 
@@ -943,6 +957,17 @@ static void read_send_work(struct work_struct *work)
 	if ((count & (dev->bulk_in->maxpacket - 1)) == 0)
 		ZLP_flag = 1;
 
+	/*
+	 * The file is read front to back while the previous chunks are on
+	 * the bus: open up the read-ahead window as POSIX_FADV_SEQUENTIAL
+	 * does, so the next chunk is mostly in the page cache already.
+	 */
+	spin_lock(&file->f_lock);
+	file->f_ra.ra_pages = max_t(unsigned int, file->f_ra.ra_pages,
+			inode_to_bdi(file_inode(file))->ra_pages * 2);
+	file->f_mode &= ~FMODE_RANDOM;
+	spin_unlock(&file->f_lock);
+
 	while (count > 0 || ZLP_flag) {
 		/*Breaking the loop after sending Zero Length Packet*/
 		if (count == 0)
@@ -967,8 +992,8 @@ static void read_send_work(struct work_struct *work)
 			break;
 		}
 
-		if (count > MTPG_BULK_BUFFER_SIZE)
-			xfer = MTPG_BULK_BUFFER_SIZE;
+		if (count > dev->tx_req_len)
+			xfer = dev->tx_req_len;
 		else
 			xfer = count;
 
@@ -1382,6 +1407,43 @@ static void mtpg_complete_intr(struct usb_ep *ep, struct usb_request *req)
 }
 static DEVICE_ATTR(guid,  S_IRUGO | S_IWUSR,
 		guid_show, guid_store);
+/*
+ * Allocate @nr requests of @len bytes on @head, retrying with the default
+ * size if @len is larger and fails. Returns the size used, 0 on failure.
+ */
+static unsigned int mtpg_alloc_bulk_reqs(struct mtpg_dev *mtpg,
+		struct usb_ep *ep, struct list_head *head, int nr,
+		unsigned int len, void (*complete)(struct usb_ep *,
+			struct usb_request *))
+{
+	struct usb_request *req;
+	int i;
+
+	if (len < MTPG_BULK_BUFFER_SIZE)
+		len = MTPG_BULK_BUFFER_SIZE;
+retry:
+	for (i = 0; i < nr; i++) {
+		req = mtpg_request_new(ep, len);
+		if (!req)
+			break;
+		req->complete = complete;
+		mtpg_req_put(mtpg, head, req);
+	}
+	if (i == nr)
+		return len;
+
+	while ((req = mtpg_req_get(mtpg, head)))
+		mtpg_request_free(req, ep);
+
+	if (len > MTPG_BULK_BUFFER_SIZE) {
+		printk(KERN_INFO "[%s] %s: %u byte requests failed, fall back\n",
+				__func__, ep->name, len);
+		len = MTPG_BULK_BUFFER_SIZE;
+		goto retry;
+	}
+	return 0;
+}
+
 static void
 mtpg_function_unbind(struct usb_configuration *c, struct usb_function *f)
 {
@@ -1469,21 +1531,17 @@ mtpg_function_bind(struct usb_configuration *c, struct usb_function *f)
 		req->complete = mtpg_complete_intr;
 		mtpg_req_put(mtpg, &mtpg->intr_idle, req);
 	}
-	for (i = 0; i < MTPG_RX_REQ_MAX; i++) {
-		req = mtpg_request_new(mtpg->bulk_out, MTPG_BULK_BUFFER_SIZE);
-		if (!req)
-			goto out;
-		req->complete = mtpg_complete_out;
-		mtpg_req_put(mtpg, &mtpg->rx_idle, req);
-	}
-
-	for (i = 0; i < MTPG_MTPG_TX_REQ_MAX; i++) {
-		req = mtpg_request_new(mtpg->bulk_in, MTPG_BULK_BUFFER_SIZE);
-		if (!req)
-			goto out;
-		req->complete = mtpg_complete_in;
-		mtpg_req_put(mtpg, &mtpg->tx_idle, req);
-	}
+	mtpg->rx_req_len = mtpg_alloc_bulk_reqs(mtpg, mtpg->bulk_out,
+			&mtpg->rx_idle, MTPG_RX_REQ_MAX, mtp_rx_req_len,
+			mtpg_complete_out);
+	if (!mtpg->rx_req_len)
+		goto out;
+
+	mtpg->tx_req_len = mtpg_alloc_bulk_reqs(mtpg, mtpg->bulk_in,
+			&mtpg->tx_idle, MTPG_MTPG_TX_REQ_MAX, mtp_tx_req_len,
+			mtpg_complete_in);
+	if (!mtpg->tx_req_len)
+		goto out;
 
 	if (gadget_is_dualspeed(cdev->gadget)) {
 
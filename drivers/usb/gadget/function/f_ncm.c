@@ -19,6 +19,8 @@
 #include <linux/device.h>
 #include <linux/etherdevice.h>
 #include <linux/crc32.h>
+#include <linux/hrtimer.h>
+#include <linux/interrupt.h>
 
 #include <linux/usb/cdc.h>
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
@@ -66,8 +68,17 @@ struct f_ncm {
 	u32				ndp_sign;
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 	uint16_t	dgramsize;
-	struct net_device *net;
 #endif
+	struct net_device		*net;
+
+	/* TX aggregation, see ncm_wrap_ntb() */
+	struct sk_buff			*skb_tx_data;
+	struct sk_buff			*skb_tx_ndp;
+	u16				ndp_dgram_count;
+	bool				timer_force_tx;
+	bool				timer_stopping;
+	struct tasklet_struct		tx_tasklet;
+	struct hrtimer			task_timer;
 	/*
 	 * for notification, it is accessed from both
 	 * callback and ethernet open/close
@@ -94,10 +105,8 @@ static inline unsigned ncm_bitrate(struct usb_gadget *g)
 /*-------------------------------------------------------------------------*/
 
 /*
- * We cannot group frames so use just the minimal size which ok to put
- * one max-size ethernet frame.
- * If the host can group frames, allow it to do that, 16K is selected,
- * because it's used by default by the current linux host driver
+ * Allow both ends to group frames, 16K is selected because it's used by
+ * default by the current linux host driver.
  */
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 #define NTB_DEFAULT_IN_SIZE	16384
@@ -109,16 +118,15 @@ static inline unsigned ncm_bitrate(struct usb_gadget *g)
 		sizeof(struct usb_cdc_ncm_ndp16) +	\
 		((MAX_NDP_DATAGRAMS)*sizeof(struct usb_cdc_ncm_dpe16)))
 #else
-#define NTB_DEFAULT_IN_SIZE	USB_CDC_NCM_NTB_MIN_IN_SIZE
+#define NTB_DEFAULT_IN_SIZE	16384
 #endif
 #define NTB_OUT_SIZE		16384
 
-/*
- * skbs of size less than that will not be aligned
- * to NCM's dwNtbInMaxSize to save bus bandwidth
- */
+/* datagram pointer entries per TX NTB, including the zero one */
+#define TX_MAX_NUM_DPE		32
 
-#define	MAX_TX_NONFIXED		(512 * 3)
+/* partial NTB flush timeout when the adaptive policy is off */
+#define NCM_TX_TIMEOUT_NSECS	300000
 
 #define FORMATS_SUPPORTED	(USB_CDC_NCM_NTB16_SUPPORTED |	\
 				 USB_CDC_NCM_NTB32_SUPPORTED)
@@ -563,8 +571,21 @@ static inline void ncm_reset_values(struct f_ncm *ncm)
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 	/* Revisit issue for the case of Toyota Head Unit */
 	ncm->dgramsize = NCM_MAX_DGRAM_SIZE;	//ETH_FRAME_LEN
-	ncm->net = NULL;
 #endif
+	ncm->net = NULL;
+}
+
+/* drop the pending NTB, after gether_disconnect() stopped the wraps */
+static void ncm_tx_stop(struct f_ncm *ncm)
+{
+	ncm->timer_stopping = true;
+	hrtimer_cancel(&ncm->task_timer);
+
+	dev_kfree_skb_any(ncm->skb_tx_data);
+	ncm->skb_tx_data = NULL;
+	dev_kfree_skb_any(ncm->skb_tx_ndp);
+	ncm->skb_tx_ndp = NULL;
+	ncm->ndp_dgram_count = 0;
 }
 
 /*
@@ -996,6 +1017,7 @@ static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 		if (ncm->port.in_ep->driver_data) {
 			DBG(cdev, "reset ncm\n");
 			gether_disconnect(&ncm->port);
+			ncm_tx_stop(ncm);
 			ncm_reset_values(ncm);
 		}
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
@@ -1032,8 +1054,9 @@ static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 			net = gether_connect(&ncm->port);
 			if (IS_ERR(net))
 				return PTR_ERR(net);
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 			ncm->net = net;
+			ncm->timer_stopping = false;
+#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 			ncm->net->mtu = ncm->dgramsize - ETH_HLEN;
 			printk(KERN_DEBUG "activate ncm setting MTU size (%d)\n", ncm->net->mtu);
 #endif
@@ -1069,131 +1092,230 @@ static int ncm_get_alt(struct usb_function *f, unsigned intf)
 		return 0;
 	return ncm->port.in_ep->driver_data ? 1 : 0;
 }
-static struct sk_buff *ncm_wrap_ntb(struct gether *port,
-				    struct sk_buff *skb)
+/*
+ * TX aggregation: datagrams are collected in skb_tx_data behind the NTH
+ * while their pointer entries go to skb_tx_ndp, which is appended once the
+ * NTB is complete. How many datagrams an NTB carries and how long a partial
+ * one waits for more is up to the adaptive policy in u_ether; with that off
+ * every datagram is sent in an NTB of its own right away.
+ */
+static int ncm_start_ntb(struct f_ncm *ncm, unsigned max_size)
 {
-	struct f_ncm	*ncm = func_to_ncm(&port->func);
-	struct sk_buff	*skb2;
-	int		ncb_len = 0;
+	const struct ndp_parser_opts *opts = ncm->parser_opts;
 	__le16		*tmp;
-	int		div;
-	int		rem;
-	int		pad;
-	int		ndp_align;
-	int		ndp_pad;
-	unsigned	max_size = ncm->port.fixed_in_len;
+
+	ncm->skb_tx_data = alloc_skb(max_size, GFP_ATOMIC);
+	if (!ncm->skb_tx_data)
+		return -ENOMEM;
+
+	ncm->skb_tx_ndp = alloc_skb(opts->ndp_size +
+			TX_MAX_NUM_DPE * 2 * 2 * opts->dgram_item_len,
+			GFP_ATOMIC);
+	if (!ncm->skb_tx_ndp) {
+		dev_kfree_skb_any(ncm->skb_tx_data);
+		ncm->skb_tx_data = NULL;
+		return -ENOMEM;
+	}
+
+	/* NTH, (d)wBlockLength and (d)wFpIndex are set by ncm_package_ntb() */
+	tmp = (void *)skb_put(ncm->skb_tx_data, opts->nth_size);
+	memset(tmp, 0, opts->nth_size);
+	put_unaligned_le32(opts->nth_sign, tmp); /* dwSignature */
+	tmp += 2;
+	/* wHeaderLength */
+	put_unaligned_le16(opts->nth_size, tmp++);
+
+	/* NDP, wLength is set by ncm_package_ntb() */
+	tmp = (void *)skb_put(ncm->skb_tx_ndp, opts->ndp_size);
+	memset(tmp, 0, opts->ndp_size);
+	put_unaligned_le32(ncm->ndp_sign, tmp); /* dwSignature */
+
+	/* account for the terminating zero entry */
+	ncm->ndp_dgram_count = 1;
+
+	return 0;
+}
+
+/* close the pending NTB: append its NDP and fill in the lengths */
+static struct sk_buff *ncm_package_ntb(struct f_ncm *ncm)
+{
 	const struct ndp_parser_opts *opts = ncm->parser_opts;
-	unsigned	crc_len = ncm->is_crc ? sizeof(uint32_t) : 0;
+	const int	ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
+	const int	dgram_idx_len = 2 * 2 * opts->dgram_item_len;
+	struct sk_buff	*skb = ncm->skb_tx_data;
+	unsigned	ndp_pad, ndp_index, new_len;
+	__le16		*tmp;
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 	int		force_shortpkt = 0;
 #endif
-	div = le16_to_cpu(ntb_parameters.wNdpInDivisor);
-	rem = le16_to_cpu(ntb_parameters.wNdpInPayloadRemainder);
-	ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
 
-	ncb_len += opts->nth_size;
-	ndp_pad = ALIGN(ncb_len, ndp_align) - ncb_len;
-	ncb_len += ndp_pad;
-	ncb_len += opts->ndp_size;
-	ncb_len += 2 * 2 * opts->dgram_item_len; /* Datagram entry */
-	ncb_len += 2 * 2 * opts->dgram_item_len; /* Zero datagram entry */
-	pad = ALIGN(ncb_len, div) + rem - ncb_len;
-	ncb_len += pad;
+	hrtimer_try_to_cancel(&ncm->task_timer);
 
-	if (ncb_len + skb->len + crc_len > max_size) {
-		printk(KERN_ERR"usb: %s Dropped skb skblen (%d) \n", __func__, skb->len);
-		dev_kfree_skb_any(skb);
-		return NULL;
-	}
+	ndp_pad = ALIGN(skb->len, ndp_align) - skb->len;
+	ndp_index = skb->len + ndp_pad;
+	new_len = ndp_index + ncm->skb_tx_ndp->len + dgram_idx_len;
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if ((ncb_len + skb->len + crc_len < max_size) && (((ncb_len + skb->len + crc_len) %
-		le16_to_cpu(ncm->port.in_ep->desc->wMaxPacketSize)) == 0)) {
+	if (new_len < ncm->port.fixed_in_len &&
+	    !(new_len % ncm->port.in_ep->maxpacket)) {
 		/* force short packet */
-		printk(KERN_ERR "usb: force short packet %d  \n", ncm->port.in_ep->desc->wMaxPacketSize);
 		force_shortpkt = 1;
 	}
 #endif
-	skb2 = skb_copy_expand(skb, ncb_len,
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-			       force_shortpkt,
-#else
-			       max_size - skb->len - ncb_len - crc_len,
-#endif
-			       GFP_ATOMIC);
-	dev_kfree_skb_any(skb);
+
+	tmp = (void *)skb->data;
+	tmp += 2 + 1 + 1; /* dwSignature, wHeaderLength, wSequence */
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if (!skb2) {
-		printk(KERN_ERR"usb: %s Dropped skb skblen realloc failed (%d) \n", __func__, skb->len);
-		return NULL;
-	}
+	put_ncm(&tmp, opts->block_length, new_len + force_shortpkt); /* (d)wBlockLength */
 #else
-	if (!skb2)
-		return NULL;
+	put_ncm(&tmp, opts->block_length, new_len); /* (d)wBlockLength */
 #endif
-	skb = skb2;
+	put_ncm(&tmp, opts->fp_index, ndp_index); /* (d)wFpIndex */
 
-	tmp = (void *) skb_push(skb, ncb_len);
-	memset(tmp, 0, ncb_len);
-
-	put_unaligned_le32(opts->nth_sign, tmp); /* dwSignature */
+	/* wLength of the NDP, including the zero entry */
+	tmp = (void *)ncm->skb_tx_ndp->data;
 	tmp += 2;
-	/* wHeaderLength */
-	put_unaligned_le16(opts->nth_size, tmp++);
-	tmp++; /* skip wSequence */
+	put_unaligned_le16(opts->ndp_size +
+			   ncm->ndp_dgram_count * dgram_idx_len, tmp);
+
+	memset(skb_put(skb, ndp_pad), 0, ndp_pad);
+	memcpy(skb_put(skb, ncm->skb_tx_ndp->len), ncm->skb_tx_ndp->data,
+	       ncm->skb_tx_ndp->len);
+	/* (d)wDatagramIndex[n] and (d)wDatagramLength[n] of the zero entry */
+	memset(skb_put(skb, dgram_idx_len), 0, dgram_idx_len);
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	put_ncm(&tmp, opts->block_length, skb->len + force_shortpkt); /* (d)wBlockLength */
-#else
-	put_ncm(&tmp, opts->block_length, skb->len); /* (d)wBlockLength */
+	if (force_shortpkt)
+		memset(skb_put(skb, force_shortpkt), 0, force_shortpkt);
 #endif
-	/* (d)wFpIndex */
-	/* the first pointer is right after the NTH + align */
-	put_ncm(&tmp, opts->fp_index, opts->nth_size + ndp_pad);
 
-	tmp = (void *)tmp + ndp_pad;
+	dev_consume_skb_any(ncm->skb_tx_ndp);
+	ncm->skb_tx_ndp = NULL;
+	ncm->skb_tx_data = NULL;
+	ncm->ndp_dgram_count = 0;
 
-	/* NDP */
-	put_unaligned_le32(ncm->ndp_sign, tmp); /* dwSignature */
-	tmp += 2;
-	/* wLength */
-	put_unaligned_le16(ncb_len - opts->nth_size - pad, tmp++);
+	return skb;
+}
 
-	tmp += opts->reserved1;
-	tmp += opts->next_fp_index; /* skip reserved (d)wNextFpIndex */
-	tmp += opts->reserved2;
+/* called by u_ether with its dev->lock held */
+static struct sk_buff *ncm_wrap_ntb(struct gether *port,
+				    struct sk_buff *skb)
+{
+	struct f_ncm	*ncm = func_to_ncm(&port->func);
+	struct sk_buff	*skb2 = NULL;
+	int		ncb_len;
+	__le16		*tmp;
+	int		div;
+	int		rem;
+	int		pad;
+	int		ndp_align;
+	int		dgram_idx_len;
+	unsigned	frames;
+	unsigned	max_size = ncm->port.fixed_in_len;
+	const struct ndp_parser_opts *opts = ncm->parser_opts;
+	unsigned	crc_len = ncm->is_crc ? sizeof(uint32_t) : 0;
 
-	if (ncm->is_crc) {
-		uint32_t crc;
+	if (!skb) {
+		/* flush requested by ncm_tx_tasklet() */
+		if (ncm->skb_tx_data && ncm->timer_force_tx)
+			skb2 = ncm_package_ntb(ncm);
+		return skb2;
+	}
 
-		crc = ~crc32_le(~0,
-				skb->data + ncb_len,
-				skb->len - ncb_len);
-		put_unaligned_le32(crc, skb->data + skb->len);
-		skb_put(skb, crc_len);
+	div = le16_to_cpu(ntb_parameters.wNdpInDivisor);
+	rem = le16_to_cpu(ntb_parameters.wNdpInPayloadRemainder);
+	ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
+	dgram_idx_len = 2 * 2 * opts->dgram_item_len;
+
+	/* the worst case NTB carrying only this datagram */
+	if (opts->nth_size + div + rem + skb->len + crc_len + ndp_align +
+	    opts->ndp_size + 2 * dgram_idx_len > max_size) {
+		printk(KERN_ERR"usb: %s Dropped skb skblen (%d) \n", __func__, skb->len);
+		goto err;
 	}
 
-	/* (d)wDatagramIndex[0] */
+	/* send the pending NTB first if this datagram does not fit */
+	if (ncm->skb_tx_data &&
+	    (ncm->ndp_dgram_count >= TX_MAX_NUM_DPE ||
+	     ncm->skb_tx_data->len + div + rem + skb->len + crc_len +
+	     ndp_align + ncm->skb_tx_ndp->len + 2 * dgram_idx_len > max_size))
+		skb2 = ncm_package_ntb(ncm);
+
+	if (!ncm->skb_tx_data && ncm_start_ntb(ncm, max_size))
+		goto err;
+
+	ncb_len = ncm->skb_tx_data->len;
+	pad = ALIGN(ncb_len, div) + rem - ncb_len;
+	ncb_len += pad;
+
+	tmp = (void *)skb_put(ncm->skb_tx_ndp, dgram_idx_len);
+	/* (d)wDatagramIndex[n] */
 	put_ncm(&tmp, opts->dgram_item_len, ncb_len);
-	/* (d)wDatagramLength[0] */
-	put_ncm(&tmp, opts->dgram_item_len, skb->len - ncb_len);
-	/* (d)wDatagramIndex[1] and  (d)wDatagramLength[1] already zeroed */
-
-	/* Incase of Higher MTU size we do not need to expand and zero off the remaining
-	   In packet size to max_size . This saves bandwidth . e.g for 16K In size max mtu is 9k
-	*/
-#ifndef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if (skb->len > MAX_TX_NONFIXED) {
-		memset(skb_put(skb, max_size - skb->len),
-		       0, max_size - skb->len);
-		printk(KERN_DEBUG"usb:%s Expanding the buffer %d \n", __func__, skb->len);
-	}
-#else
-	if (force_shortpkt) {
-		memset(skb_put(skb, force_shortpkt),
-		       0, force_shortpkt);
-		printk(KERN_ERR"usb:%s final Expanding the buffer %d \n", __func__, skb->len);
+	/* (d)wDatagramLength[n] */
+	put_ncm(&tmp, opts->dgram_item_len, skb->len + crc_len);
+	ncm->ndp_dgram_count++;
+
+	memset(skb_put(ncm->skb_tx_data, pad), 0, pad);
+	if (skb_copy_bits(skb, 0, skb_put(ncm->skb_tx_data, skb->len),
+			  skb->len))
+		BUG();
+
+	if (ncm->is_crc) {
+		uint32_t crc;
+
+		crc = ~crc32_le(~0, ncm->skb_tx_data->data + ncb_len,
+				skb->len);
+		put_unaligned_le32(crc, skb_put(ncm->skb_tx_data, crc_len));
 	}
-#endif
-	return skb;
+	dev_consume_skb_any(skb);
+
+	frames = gether_aggr_frames(&port->tx_aggr, 1, TX_MAX_NUM_DPE - 1);
+	if (!skb2 && ncm->ndp_dgram_count > frames)
+		skb2 = ncm_package_ntb(ncm);
+
+	/* flush whatever is left if no more datagrams come in time */
+	if (ncm->skb_tx_data)
+		hrtimer_start(&ncm->task_timer,
+			      ns_to_ktime(gether_aggr_timeout_ns(&port->tx_aggr,
+						NCM_TX_TIMEOUT_NSECS)),
+			      HRTIMER_MODE_REL);
+
+	return skb2;
+
+err:
+	if (ncm->net)
+		ncm->net->stats.tx_dropped++;
+	dev_kfree_skb_any(skb);
+	return skb2;
+}
+
+static void ncm_tx_tasklet(unsigned long data)
+{
+	struct f_ncm	*ncm = (void *)data;
+	struct net_device *net = READ_ONCE(ncm->net);
+	netdev_tx_t	ret;
+
+	if (ncm->timer_stopping || !net || !ncm->skb_tx_data)
+		return;
+
+	/* u_ether has no other entry point, push the NTB with a NULL skb */
+	netif_tx_lock(net);
+	ncm->timer_force_tx = true;
+	ret = net->netdev_ops->ndo_start_xmit(NULL, net);
+	ncm->timer_force_tx = false;
+	netif_tx_unlock(net);
+
+	/* no free request, retry once one might have completed */
+	if (ret == NETDEV_TX_BUSY && !ncm->timer_stopping)
+		hrtimer_start(&ncm->task_timer,
+			      ktime_set(0, NCM_TX_TIMEOUT_NSECS),
+			      HRTIMER_MODE_REL);
+}
+
+static enum hrtimer_restart ncm_tx_timeout(struct hrtimer *data)
+{
+	struct f_ncm	*ncm = container_of(data, struct f_ncm, task_timer);
+
+	tasklet_schedule(&ncm->tx_tasklet);
+	return HRTIMER_NORESTART;
 }
 
 static int ncm_unwrap_ntb(struct gether *port,
@@ -1280,6 +1402,10 @@ static int ncm_unwrap_ntb(struct gether *port,
 			     dg_len);
 			goto err;
 		}
+		if (index > skb->len || dg_len > skb->len - index) {
+			ret = -EOVERFLOW;
+			goto err;
+		}
 		if (ncm->is_crc) {
 			uint32_t crc, crc2;
 
@@ -1299,18 +1425,14 @@ static int ncm_unwrap_ntb(struct gether *port,
 
 		if (index2 == 0 || dg_len2 == 0) {
 			skb2 = skb;
+			skb_pull(skb2, index);
+			skb_trim(skb2, dg_len - crc_len);
 		} else {
-			skb2 = skb_clone(skb, GFP_ATOMIC);
+			skb2 = gether_rx_dgram(port, skb, index,
+					       dg_len - crc_len);
 			if (skb2 == NULL)
 				goto err;
 		}
-
-		if (!skb_pull(skb2, index)) {
-			ret = -EOVERFLOW;
-			goto err;
-		}
-
-		skb_trim(skb2, dg_len - crc_len);
 		skb_queue_tail(list, skb2);
 
 		ndp_len -= 2 * (opts->dgram_item_len * 2);
@@ -1338,8 +1460,10 @@ static void ncm_disable(struct usb_function *f)
 
 	DBG(cdev, "ncm deactivated\n");
 
-	if (ncm->port.in_ep->driver_data)
+	if (ncm->port.in_ep->driver_data) {
 		gether_disconnect(&ncm->port);
+		ncm_tx_stop(ncm);
+	}
 
 	if (ncm->notify->driver_data) {
 		usb_ep_disable(ncm->notify);
@@ -1818,6 +1942,9 @@ static void ncm_unbind(struct usb_configuration *c, struct usb_function *f)
 #endif
 	DBG(c->cdev, "ncm unbind\n");
 
+	hrtimer_cancel(&ncm->task_timer);
+	tasklet_kill(&ncm->tx_tasklet);
+
 	ncm_string_defs[0].id = 0;
 	usb_free_all_descriptors(f);
 
@@ -1857,6 +1984,10 @@ static struct usb_function *ncm_alloc(struct usb_function_instance *fi)
 	mutex_unlock(&opts->lock);
 	ncm->port.is_fixed = true;
 	ncm->port.supports_multi_frame = true;
+
+	tasklet_init(&ncm->tx_tasklet, ncm_tx_tasklet, (unsigned long)ncm);
+	hrtimer_init(&ncm->task_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	ncm->task_timer.function = ncm_tx_timeout;
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
 	ncm->port.func.name = "ncm";
 #else
@@ -1139,7 +1139,7 @@ int rndis_rm_hdr(struct gether *port,
 			break;
 		}
 
-		skb2 = skb_clone(skb, GFP_ATOMIC);
+		skb2 = gether_rx_dgram(port, skb, 0, data_len);
 		if (!skb2) {
 			pr_err("%s:skb clone failed\n", __func__);
 			dev_kfree_skb_any(skb);
@@ -1147,7 +1147,6 @@ int rndis_rm_hdr(struct gether *port,
 		}
 
 		skb_pull(skb, msg_len - sizeof *hdr);
-		skb_trim(skb2, data_len);
 		skb_queue_tail(list, skb2);
 
 		num_pkts++;
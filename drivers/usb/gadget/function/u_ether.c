@@ -112,8 +112,109 @@ struct eth_dev {
 
 /*-------------------------------------------------------------------------*/
 
+/*
+ * Adaptive TX aggregation.
+ *
+ * Batching frames into one USB transfer saves interrupts on both ends and
+ * is what lets tethering reach line rate, but on a lightly loaded link every
+ * held frame only waits for the flush timer. Track the smoothed gap between
+ * the frames the stack hands us, batch only as many as are expected within
+ * aggr_latency_us and flush after about two gaps when a burst ends early.
+ * With the budget at 0 the functions keep their fixed policy.
+ */
+static unsigned int aggr_latency_us;
+module_param(aggr_latency_us, uint, S_IRUGO|S_IWUSR);
+MODULE_PARM_DESC(aggr_latency_us, "latency budget of adaptive TX aggregation in usecs (0 = fixed aggregation)");
+
+#define AGGR_MIN_TIMEOUT_NSECS	20000
+
+static u64 gether_aggr_budget_ns(void)
+{
+	return (u64)READ_ONCE(aggr_latency_us) * NSEC_PER_USEC;
+}
+
+static void gether_aggr_reset(struct gether_aggr *aggr)
+{
+	aggr->last = ktime_get();
+	aggr->gap_ns = U64_MAX;
+}
+
+/* called for each frame queued for TX, with dev->lock held */
+static void gether_aggr_update(struct gether_aggr *aggr)
+{
+	u64 budget = gether_aggr_budget_ns();
+	ktime_t now;
+	u64 sample;
+
+	if (!budget)
+		return;
+
+	now = ktime_get();
+	sample = min_t(u64, ktime_to_ns(ktime_sub(now, aggr->last)),
+		       2 * budget);
+	aggr->last = now;
+
+	/* the first sample, or one after the budget shrank, seeds the average */
+	if (aggr->gap_ns > 2 * budget)
+		aggr->gap_ns = sample;
+	else
+		aggr->gap_ns = aggr->gap_ns - (aggr->gap_ns >> 3) + (sample >> 3);
+}
+
+/* number of frames to batch per transfer, at most @max */
+unsigned int gether_aggr_frames(const struct gether_aggr *aggr,
+		unsigned int fixed, unsigned int max)
+{
+	u64 budget = gether_aggr_budget_ns();
+
+	if (!budget)
+		return fixed;
+	if (aggr->gap_ns >= budget)
+		return 1;
+
+	return clamp_t(u64, div64_u64(budget, max_t(u64, aggr->gap_ns, 1)),
+		       1, max);
+}
+EXPORT_SYMBOL_GPL(gether_aggr_frames);
+
+/* how long a partial batch may wait for more frames */
+u64 gether_aggr_timeout_ns(const struct gether_aggr *aggr, u64 fixed_ns)
+{
+	u64 budget = gether_aggr_budget_ns();
+
+	if (!budget)
+		return fixed_ns;
+
+	return clamp_t(u64, aggr->gap_ns < budget ? 2 * aggr->gap_ns : budget,
+		       AGGR_MIN_TIMEOUT_NSECS, budget);
+}
+EXPORT_SYMBOL_GPL(gether_aggr_timeout_ns);
+
+/*-------------------------------------------------------------------------*/
+
 #define RX_EXTRA	20	/* bytes guarding against rx overflows */
 
+/*
+ * With rx_zero_copy the OUT requests complete into pages of their own
+ * rather than into skbs, and the datagrams unwrapped from a transfer
+ * point into that page instead of sharing a cloned head. Only the
+ * Ethernet header is copied, into a small head with room for the stack
+ * to pull the rest of the headers, so forwarding (NAT, TTL) no longer
+ * has to unshare, i.e. copy, every tethered frame.
+ */
+static bool rx_zero_copy;
+module_param(rx_zero_copy, bool, S_IRUGO);
+MODULE_PARM_DESC(rx_zero_copy, "receive into pages and hand out page fragments");
+
+#define RX_HDR_ROOM	128	/* linear room of a page fragment skb */
+
+/* the page also holds the skb_shared_info of build_skb() */
+static inline size_t rx_page_size(size_t size)
+{
+	return SKB_DATA_ALIGN(size + NET_IP_ALIGN) +
+		SKB_DATA_ALIGN(sizeof(struct skb_shared_info));
+}
+
 #define DEFAULT_QLEN	2	/* double buffering by default */
 
 /* for dual-speed hardware, use deeper queues at high/super speed */
@@ -220,7 +321,8 @@ static void rx_complete(struct usb_ep *ep, struct usb_request *req);
 static int
 rx_submit(struct eth_dev *dev, struct usb_request *req, gfp_t gfp_flags)
 {
-	struct sk_buff	*skb;
+	struct sk_buff	*skb = NULL;
+	struct page	*page = NULL;
 	int		retval = -ENOMEM;
 	size_t		size = 0;
 	struct usb_ep	*out;
@@ -263,22 +365,34 @@ rx_submit(struct eth_dev *dev, struct usb_request *req, gfp_t gfp_flags)
 	spin_unlock_irqrestore(&dev->lock, flags);
 
 	DBG(dev, "%s: size: %zd\n", __func__, size);
-	skb = alloc_skb(size + NET_IP_ALIGN, gfp_flags);
-	if (skb == NULL) {
-		DBG(dev, "no rx skb\n");
-		goto enomem;
-	}
+	if (rx_zero_copy) {
+		page = alloc_pages(gfp_flags | __GFP_COMP | __GFP_NOWARN,
+				   get_order(rx_page_size(size)));
+		if (page == NULL) {
+			DBG(dev, "no rx page\n");
+			goto enomem;
+		}
+		req->buf = page_address(page) + NET_IP_ALIGN;
+		req->context = page;
+	} else {
+		skb = alloc_skb(size + NET_IP_ALIGN, gfp_flags);
+		if (skb == NULL) {
+			DBG(dev, "no rx skb\n");
+			goto enomem;
+		}
 
-	/* Some platforms perform better when IP packets are aligned,
-	 * but on at least one, checksumming fails otherwise.  Note:
-	 * RNDIS headers involve variable numbers of LE32 values.
-	 */
-	skb_reserve(skb, NET_IP_ALIGN);
+		/* Some platforms perform better when IP packets are aligned,
+		 * but on at least one, checksumming fails otherwise.  Note:
+		 * RNDIS headers involve variable numbers of LE32 values.
+		 */
+		skb_reserve(skb, NET_IP_ALIGN);
+
+		req->buf = skb->data;
+		req->context = skb;
+	}
 
-	req->buf = skb->data;
 	req->length = size;
 	req->complete = rx_complete;
-	req->context = skb;
 
 	retval = usb_ep_queue(out, req, gfp_flags);
 	if (retval == -ENOMEM)
@@ -288,10 +402,78 @@ rx_submit(struct eth_dev *dev, struct usb_request *req, gfp_t gfp_flags)
 		DBG(dev, "rx submit --> %d\n", retval);
 		if (skb)
 			dev_kfree_skb_any(skb);
+		if (page)
+			put_page(page);
 	}
 	return retval;
 }
 
+/* wrap the page of an rx_zero_copy request into an skb */
+static struct sk_buff *rx_build_skb(struct usb_request *req)
+{
+	struct page	*page = req->context;
+	struct sk_buff	*skb;
+
+	skb = build_skb(page_address(page), PAGE_SIZE << compound_order(page));
+	if (!skb) {
+		put_page(page);
+		return NULL;
+	}
+	skb_reserve(skb, NET_IP_ALIGN);
+
+	return skb;
+}
+
+/**
+ * gether_rx_dgram - get an skb for one datagram of a received transfer
+ * @port: the USB link the transfer came from
+ * @skb: the transfer, as passed to unwrap()
+ * @offset: start of the datagram within @skb
+ * @len: length of the datagram, which must lie within @skb
+ *
+ * The transfer skb itself is left alone. With rx_zero_copy the new skb
+ * carries the datagram as a fragment of the received page, else it is a
+ * clone of @skb.
+ *
+ * Returns NULL if out of memory.
+ */
+struct sk_buff *gether_rx_dgram(struct gether *port, struct sk_buff *skb,
+		unsigned int offset, unsigned int len)
+{
+	struct sk_buff	*skb2;
+	struct page	*page;
+	unsigned int	hlen;
+	u8		*data;
+
+	if (!skb->head_frag) {
+		skb2 = skb_clone(skb, GFP_ATOMIC);
+		if (!skb2)
+			return NULL;
+		skb_pull(skb2, offset);
+		skb_trim(skb2, len);
+		return skb2;
+	}
+
+	skb2 = netdev_alloc_skb_ip_align(port->ioport->net, RX_HDR_ROOM);
+	if (!skb2)
+		return NULL;
+
+	/* eth_type_trans() wants the Ethernet header in the linear part */
+	hlen = min_t(unsigned int, len, ETH_HLEN);
+	memcpy(skb_put(skb2, hlen), skb->data + offset, hlen);
+
+	if (len > hlen) {
+		data = skb->data + offset + hlen;
+		page = virt_to_head_page(data);
+		get_page(page);
+		skb_add_rx_frag(skb2, 0, page, data - (u8 *)page_address(page),
+				len - hlen, len - hlen);
+	}
+
+	return skb2;
+}
+EXPORT_SYMBOL_GPL(gether_rx_dgram);
+
 static void rx_complete(struct usb_ep *ep, struct usb_request *req)
 {
 	struct sk_buff	*skb = req->context;
@@ -299,6 +481,12 @@ static void rx_complete(struct usb_ep *ep, struct usb_request *req)
 	int		status = req->status;
 	bool		queue = 0;
 
+	if (rx_zero_copy) {
+		skb = rx_build_skb(req);
+		if (!skb && !status)
+			status = -ENOMEM;
+	}
+
 	switch (status) {
 
 	/* normal completion */
@@ -801,6 +989,10 @@ static netdev_tx_t eth_start_xmit(struct sk_buff *skb,
 	bool eth_multi_pkt_xfer = 0;
 	bool eth_supports_multi_frame = 0;
 	bool eth_is_fixed = 0;
+	unsigned int aggr_frames = dev->dl_max_pkts_per_xfer;
+#ifdef CONFIG_USB_RNDIS_MULTIPACKET_WITH_TIMER
+	u64 aggr_timeout = TX_TIMEOUT_NSECS;
+#endif
 
 #ifdef CONFIG_USB_RNDIS_MULTIPACKET_WITH_TIMER
 	if (dev->en_timer) {
@@ -815,6 +1007,15 @@ static netdev_tx_t eth_start_xmit(struct sk_buff *skb,
 		eth_multi_pkt_xfer = dev->port_usb->multi_pkt_xfer;
 		eth_supports_multi_frame = dev->port_usb->supports_multi_frame;
 		eth_is_fixed = dev->port_usb->is_fixed;
+		if (skb)
+			gether_aggr_update(&dev->port_usb->tx_aggr);
+		aggr_frames = gether_aggr_frames(&dev->port_usb->tx_aggr,
+				dev->dl_max_pkts_per_xfer,
+				dev->dl_max_pkts_per_xfer);
+#ifdef CONFIG_USB_RNDIS_MULTIPACKET_WITH_TIMER
+		aggr_timeout = gether_aggr_timeout_ns(&dev->port_usb->tx_aggr,
+				TX_TIMEOUT_NSECS);
+#endif
 	} else {
 		in = NULL;
 		cdc_filter = 0;
@@ -916,11 +1117,11 @@ static netdev_tx_t eth_start_xmit(struct sk_buff *skb,
 		dev_kfree_skb_any(skb);
 
 		spin_lock_irqsave(&dev->req_lock, flags);
-		if (dev->tx_skb_hold_count < dev->dl_max_pkts_per_xfer) {
+		if (dev->tx_skb_hold_count < aggr_frames) {
 #ifdef CONFIG_USB_RNDIS_MULTIPACKET_WITH_TIMER
 			list_add(&req->list, &dev->tx_reqs);
 			spin_unlock_irqrestore(&dev->req_lock, flags);
-			hrtimer_start(&dev->tx_timer, ktime_set(0, TX_TIMEOUT_NSECS),
+			hrtimer_start(&dev->tx_timer, ns_to_ktime(aggr_timeout),
 					HRTIMER_MODE_REL);
 			dev->en_timer = 1;
 			goto success;
@@ -1518,6 +1719,7 @@ struct net_device *gether_connect(struct gether *link)
 	dev->tx_skb_hold_count = 0;
 	dev->no_tx_req_used = 0;
 	dev->no_of_zlp = 0;
+	gether_aggr_reset(&link->tx_aggr);
 	dev->port_usb = link;
 	if (netif_running(dev->net)) {
 		if (link->open)
@@ -19,6 +19,7 @@
 #include <linux/usb/composite.h>
 #include <linux/usb/cdc.h>
 #include <linux/netdevice.h>
+#include <linux/ktime.h>
 
 #ifdef CONFIG_USB_RNDIS_MULTIPACKET
 #define QMULT_DEFAULT 10
@@ -46,6 +47,12 @@
 
 struct eth_dev;
 
+/* TX load estimate driving the adaptive aggregation, see u_ether.c */
+struct gether_aggr {
+	ktime_t				last;
+	u64				gap_ns;	/* smoothed gap between frames */
+};
+
 /*
  * This represents the USB side of an "ethernet" link, managed by a USB
  * function which provides control and (maybe) framing.  Two functions
@@ -81,6 +88,7 @@ struct gether {
 	unsigned		dl_max_pkts_per_xfer;
 	bool				multi_pkt_xfer;
 	bool				supports_multi_frame;
+	struct gether_aggr		tx_aggr;
 	struct rndis_packet_msg_type	*header;
 	struct sk_buff			*(*wrap)(struct gether *port,
 						struct sk_buff *skb);
@@ -98,6 +106,15 @@ struct gether {
 			|USB_CDC_PACKET_TYPE_PROMISCUOUS \
 			|USB_CDC_PACKET_TYPE_DIRECTED)
 
+/* adaptive TX aggregation, for functions that batch frames in wrap() */
+unsigned int gether_aggr_frames(const struct gether_aggr *aggr,
+		unsigned int fixed, unsigned int max);
+u64 gether_aggr_timeout_ns(const struct gether_aggr *aggr, u64 fixed_ns);
+
+/* skb for one datagram of a received transfer, for use in unwrap() */
+struct sk_buff *gether_rx_dgram(struct gether *port, struct sk_buff *skb,
+		unsigned int offset, unsigned int len);
+
 /* variant of gether_setup that allows customizing network device name */
 struct eth_dev *gether_setup_name(struct usb_gadget *g,
 		const char *dev_addr, const char *host_addr,
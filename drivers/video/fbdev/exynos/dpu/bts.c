@@ -11,6 +11,7 @@
 
 #include "decon.h"
 
+#include <linux/module.h>
 #include <soc/samsung/bts.h>
 #include <media/v4l2-subdev.h>
 
@@ -19,6 +20,14 @@
 #define LCD_REFRESH_RATE	63UL
 #define MULTI_FACTOR 		(1UL << 10)
 
+/*
+ * Vote for the bandwidth of a frame when it is queued rather than when it
+ * is applied, which leaves MIF at least a vsync to ramp up.
+ */
+static int dpu_bts_lookahead;
+module_param(dpu_bts_lookahead, int, 0644);
+MODULE_PARM_DESC(dpu_bts_lookahead, "Raise the bandwidth as soon as a frame is queued (0 = off)");
+
 u64 dpu_bts_calc_aclk_disp(struct decon_device *decon,
 		struct decon_win_config *config, u64 resol_clock)
 {
@@ -44,6 +53,13 @@ u64 dpu_bts_calc_aclk_disp(struct decon_device *decon,
 	return aclk_disp;
 }
 
+static void dpu_bts_get_ch_bw(u32 bw[], u32 ch_bw[])
+{
+	ch_bw[BTS_DPU0] = bw[BTS_DPP4] + bw[BTS_DPP5];
+	ch_bw[BTS_DPU1] = bw[BTS_DPP0] + bw[BTS_DPP2];
+	ch_bw[BTS_DPU2] = bw[BTS_DPP1] + bw[BTS_DPP3];
+}
+
 static void dpu_bts_sum_all_decon_bw(struct decon_device *decon, u32 ch_bw[])
 {
 	int id = decon->id;
@@ -103,9 +119,7 @@ static void dpu_bts_find_max_disp_freq(struct decon_device *decon,
 
 	memset(disp_ch_bw, 0, sizeof(disp_ch_bw));
 
-	disp_ch_bw[BTS_DPU0] = decon->bts.bw[BTS_DPP4] + decon->bts.bw[BTS_DPP5];
-	disp_ch_bw[BTS_DPU1] = decon->bts.bw[BTS_DPP0] + decon->bts.bw[BTS_DPP2];
-	disp_ch_bw[BTS_DPU2] = decon->bts.bw[BTS_DPP1] + decon->bts.bw[BTS_DPP3];
+	dpu_bts_get_ch_bw(decon->bts.bw, disp_ch_bw);
 
 	/* must be considered other decon's bw */
 	dpu_bts_sum_all_decon_bw(decon, disp_ch_bw);
@@ -219,42 +233,49 @@ static void dpu_bts_share_bw_info(int id)
 	}
 }
 
-void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
+static void dpu_bts_fill_info(struct decon_device *decon,
+		struct decon_win_config *config, struct bts_decon_info *info)
 {
-	struct decon_win_config *config = regs->dpp_config;
-	struct bts_decon_info bts_info;
 	int idx, i;
 
-	memset(&bts_info, 0, sizeof(struct bts_decon_info));
+	memset(info, 0, sizeof(struct bts_decon_info));
 	for (i = 0; i < MAX_DECON_WIN; ++i) {
 		idx = config[i].idma_type;
 		if (config[i].state == DECON_WIN_STATE_BUFFER) {
-			bts_info.dpp[idx].used = true;
+			info->dpp[idx].used = true;
 		} else {
-			bts_info.dpp[idx].used = false;
+			info->dpp[idx].used = false;
 			continue;
 		}
 
-		bts_info.dpp[idx].bpp = dpu_get_bpp(config[i].format);
-		bts_info.dpp[idx].src_w = config[i].src.w;
-		bts_info.dpp[idx].src_h = config[i].src.h;
-		bts_info.dpp[idx].dst.x1 = config[i].dst.x;
-		bts_info.dpp[idx].dst.x2 = config[i].dst.x + config[i].dst.w;
-		bts_info.dpp[idx].dst.y1 = config[i].dst.y;
-		bts_info.dpp[idx].dst.y2 = config[i].dst.y + config[i].dst.h;
+		info->dpp[idx].bpp = dpu_get_bpp(config[i].format);
+		info->dpp[idx].src_w = config[i].src.w;
+		info->dpp[idx].src_h = config[i].src.h;
+		info->dpp[idx].dst.x1 = config[i].dst.x;
+		info->dpp[idx].dst.x2 = config[i].dst.x + config[i].dst.w;
+		info->dpp[idx].dst.y1 = config[i].dst.y;
+		info->dpp[idx].dst.y2 = config[i].dst.y + config[i].dst.h;
 
 		DPU_DEBUG_BTS("%s:used(%d), bpp(%d), src_w(%d), src_h(%d)\n",
 				__func__,
-				bts_info.dpp[idx].used, bts_info.dpp[idx].bpp,
-				bts_info.dpp[idx].src_w, bts_info.dpp[idx].src_h);
+				info->dpp[idx].used, info->dpp[idx].bpp,
+				info->dpp[idx].src_w, info->dpp[idx].src_h);
 		DPU_DEBUG_BTS("\t\t\t\tdst x(%d), right(%d), y(%d), bottom(%d)\n",
-				bts_info.dpp[idx].dst.x1, bts_info.dpp[idx].dst.x2,
-				bts_info.dpp[idx].dst.y1, bts_info.dpp[idx].dst.y2);
+				info->dpp[idx].dst.x1, info->dpp[idx].dst.x2,
+				info->dpp[idx].dst.y1, info->dpp[idx].dst.y2);
 	}
 
-	bts_info.vclk = decon->bts.resol_clk;
-	bts_info.lcd_w = decon->lcd_info->xres;
-	bts_info.lcd_h = decon->lcd_info->yres;
+	info->vclk = decon->bts.resol_clk;
+	info->lcd_w = decon->lcd_info->xres;
+	info->lcd_h = decon->lcd_info->yres;
+}
+
+void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
+{
+	struct bts_decon_info bts_info;
+	int i;
+
+	dpu_bts_fill_info(decon, regs->dpp_config, &bts_info);
 	decon->bts.total_bw = bts_calc_bw(decon->bts.type, &bts_info);
 
 	for (i = 0; i < BTS_DPP_MAX; ++i) {
@@ -271,13 +292,106 @@ void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
 	dpu_bts_share_bw_info(decon->id);
 }
 
+/*
+ * Estimate the bandwidth and display clock @config needs, together with
+ * what the other DECONs use, without touching the state of the applied
+ * frame. The formats in @config are the ones of the DPP.
+ */
+void dpu_bts_estimate_bw(struct decon_device *decon,
+		struct decon_win_config *config, struct bts_bw *bw,
+		u32 *disp_freq)
+{
+	struct bts_decon_info bts_info;
+	u32 dpp_bw[BTS_DPP_MAX], ch_bw[BTS_DPU_MAX];
+	u32 peak = 0, freq;
+	int i, j;
+
+	dpu_bts_fill_info(decon, config, &bts_info);
+	bw->read = bts_calc_bw(decon->bts.type, &bts_info);
+
+	for (i = 0; i < BTS_DPP_MAX; ++i)
+		dpp_bw[i] = bts_info.dpp[i].bw;
+	dpu_bts_get_ch_bw(dpp_bw, ch_bw);
+
+	for (i = 0; i < BTS_DPU_MAX; ++i) {
+		for (j = 0; j < 3; j++)
+			if (j != decon->id)
+				ch_bw[i] += decon->bts.ch_bw[j][i];
+		peak = max(peak, ch_bw[i]);
+	}
+	bw->peak = peak;
+
+	*disp_freq = peak * 100 / (16 * BUS_UTIL) + 1;
+	for (i = 0; i < MAX_DECON_WIN; ++i) {
+		if (config[i].state != DECON_WIN_STATE_BUFFER)
+			continue;
+
+		freq = dpu_bts_calc_aclk_disp(decon, &config[i],
+				decon->bts.resol_clk);
+		*disp_freq = max(*disp_freq, freq);
+	}
+}
+
+/*
+ * Called when @regs is queued for the update thread. The estimate only
+ * raises the vote, which stays up until the queued frames have been
+ * applied.
+ */
+void dpu_bts_prepare_bw(struct decon_device *decon, struct decon_reg_data *regs)
+{
+	struct bts_bw bw = { 0, }, est = { 0, };
+	u32 total_bw, peak, disp_freq;
+
+	if (!dpu_bts_lookahead)
+		return;
+
+	dpu_bts_estimate_bw(decon, regs->dpp_config, &est, &disp_freq);
+	total_bw = est.read;
+	peak = est.peak;
+
+	DPU_DEBUG_BTS("queued: peak=%d, read=%d, disp freq(%d)\n",
+			peak, total_bw, disp_freq);
+
+	mutex_lock(&decon->bts.lock);
+
+	decon->bts.pre_cnt++;
+
+	if (total_bw > decon->bts.pre_total_bw || peak > decon->bts.pre_peak) {
+		decon->bts.pre_total_bw = max(decon->bts.pre_total_bw, total_bw);
+		decon->bts.pre_peak = max(decon->bts.pre_peak, peak);
+		if (decon->bts.pre_total_bw > decon->bts.prev_total_bw) {
+			bw.peak = decon->bts.pre_peak;
+			bw.read = decon->bts.pre_total_bw;
+			bts_update_bw(decon->bts.type, bw);
+		}
+	}
+
+	if (disp_freq > decon->bts.pre_disp_freq) {
+		decon->bts.pre_disp_freq = disp_freq;
+		if (disp_freq > decon->bts.prev_max_disp_freq)
+			pm_qos_update_request(&decon->bts.disp_qos, disp_freq);
+	}
+
+	mutex_unlock(&decon->bts.lock);
+}
+
 void dpu_bts_update_bw(struct decon_device *decon, struct decon_reg_data *regs,
 		u32 is_after)
 {
 	struct bts_bw bw = { 0, };
+	u32 disp_freq;
 
 	DPU_DEBUG_BTS("%s +\n", __func__);
 
+	mutex_lock(&decon->bts.lock);
+
+	/* this frame is out of the queue once it has been applied */
+	if (is_after && decon->bts.pre_cnt && !--decon->bts.pre_cnt) {
+		decon->bts.pre_peak = 0;
+		decon->bts.pre_total_bw = 0;
+		decon->bts.pre_disp_freq = 0;
+	}
+
 	/* update peak & read bandwidth per DPU port */
 	bw.peak = decon->bts.peak;
 	bw.read = decon->bts.total_bw;
@@ -286,13 +400,17 @@ void dpu_bts_update_bw(struct decon_device *decon, struct decon_reg_data *regs,
 	if (bw.read == 0)
 		bw.peak = 0;
 
+	/* never go below what the frames still queued asked for */
+	bw.peak = max(bw.peak, decon->bts.pre_peak);
+	bw.read = max(bw.read, decon->bts.pre_total_bw);
+	disp_freq = max(decon->bts.max_disp_freq, decon->bts.pre_disp_freq);
+
 	if (is_after) { /* after DECON h/w configuration */
 		if (decon->bts.total_bw <= decon->bts.prev_total_bw)
 			bts_update_bw(decon->bts.type, bw);
 
 		if (decon->bts.max_disp_freq <= decon->bts.prev_max_disp_freq)
-			pm_qos_update_request(&decon->bts.disp_qos,
-					decon->bts.max_disp_freq);
+			pm_qos_update_request(&decon->bts.disp_qos, disp_freq);
 
 		decon->bts.prev_total_bw = decon->bts.total_bw;
 		decon->bts.prev_max_disp_freq = decon->bts.max_disp_freq;
@@ -301,10 +419,11 @@ void dpu_bts_update_bw(struct decon_device *decon, struct decon_reg_data *regs,
 			bts_update_bw(decon->bts.type, bw);
 
 		if (decon->bts.max_disp_freq > decon->bts.prev_max_disp_freq)
-			pm_qos_update_request(&decon->bts.disp_qos,
-					decon->bts.max_disp_freq);
+			pm_qos_update_request(&decon->bts.disp_qos, disp_freq);
 	}
 
+	mutex_unlock(&decon->bts.lock);
+
 	DPU_DEBUG_BTS("%s -\n", __func__);
 }
 
@@ -355,10 +474,16 @@ void dpu_bts_release_bw(struct decon_device *decon)
 	struct bts_bw bw = { 0, };
 	DPU_DEBUG_BTS("%s +\n", __func__);
 
+	mutex_lock(&decon->bts.lock);
 	bts_update_bw(decon->bts.type, bw);
 	decon->bts.prev_total_bw = 0;
 	pm_qos_update_request(&decon->bts.disp_qos, 0);
 	decon->bts.prev_max_disp_freq = 0;
+	decon->bts.pre_cnt = 0;
+	decon->bts.pre_peak = 0;
+	decon->bts.pre_total_bw = 0;
+	decon->bts.pre_disp_freq = 0;
+	mutex_unlock(&decon->bts.lock);
 
 	DPU_DEBUG_BTS("%s -\n", __func__);
 }
@@ -411,6 +536,7 @@ void dpu_bts_init(struct decon_device *decon)
 	pm_qos_add_request(&decon->bts.int_qos, PM_QOS_DEVICE_THROUGHPUT, 0);
 	pm_qos_add_request(&decon->bts.disp_qos, PM_QOS_DISPLAY_THROUGHPUT, 0);
 	decon->bts.scen_updated = 0;
+	mutex_init(&decon->bts.lock);
 }
 
 void dpu_bts_deinit(struct decon_device *decon)
@@ -425,6 +551,8 @@ void dpu_bts_deinit(struct decon_device *decon)
 struct decon_bts_ops decon_bts_control = {
 	.bts_init		= dpu_bts_init,
 	.bts_calc_bw		= dpu_bts_calc_bw,
+	.bts_prepare_bw		= dpu_bts_prepare_bw,
+	.bts_estimate_bw	= dpu_bts_estimate_bw,
 	.bts_update_bw		= dpu_bts_update_bw,
 	.bts_release_bw		= dpu_bts_release_bw,
 	.bts_update_qos_mif	= dpu_bts_update_qos_mif,
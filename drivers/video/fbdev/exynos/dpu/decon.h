@@ -708,6 +708,18 @@ struct decon_win_config_data {
 	struct decon_win_config config[MAX_DECON_WIN + 1];
 };
 
+/*
+ * Related with S3CFB_CHECK_WIN_CONFIG: idma_type of the buffer windows is
+ * rewritten with the cheapest channels that accept them, and the estimated
+ * bandwidth of that assignment is returned. Nothing is applied.
+ */
+struct decon_win_config_check {
+	struct decon_win_config config[MAX_DECON_WIN + 1];
+	__u32	total_bw;	/* KB/s */
+	__u32	peak_bw;	/* KB/s on the busiest DPU port */
+	__u32	disp_freq;	/* KHz */
+};
+
 struct dpu_size_info {
 	u32 w_in;
 	u32 h_in;
@@ -961,12 +973,20 @@ struct decon_win_update {
 	u32 verti_cnt;
 	/* previous update region */
 	struct decon_rect prev_up_region;
+	/* previous frame, compared against for the automatic update region */
+	bool prev_valid;
+	struct decon_win_config prev_config[MAX_DECON_WIN];
+	struct dma_buf *prev_buf[MAX_DECON_WIN];
 };
 
 #if defined(CONFIG_EXYNOS8895_BTS)
 struct decon_bts_ops {
 	void (*bts_init)(struct decon_device *decon);
 	void (*bts_calc_bw)(struct decon_device *decon, struct decon_reg_data *regs);
+	void (*bts_prepare_bw)(struct decon_device *decon, struct decon_reg_data *regs);
+	void (*bts_estimate_bw)(struct decon_device *decon,
+			struct decon_win_config *config, struct bts_bw *bw,
+			u32 *disp_freq);
 	void (*bts_update_bw)(struct decon_device *decon, struct decon_reg_data *regs,
 			u32 is_after);
 	void (*bts_release_bw)(struct decon_device *decon);
@@ -992,6 +1012,12 @@ struct decon_bts {
 	struct pm_qos_request int_qos;
 	struct pm_qos_request disp_qos;
 	u32 scen_updated;
+	/* vote for the frames queued but not applied yet, under lock */
+	struct mutex lock;
+	u32 pre_cnt;
+	u32 pre_peak;
+	u32 pre_total_bw;
+	u32 pre_disp_freq;
 };
 #endif
 
@@ -1181,6 +1207,7 @@ void dpu_set_win_update_config(struct decon_device *decon,
 		struct decon_reg_data *regs);
 void dpu_set_win_update_partial_size(struct decon_device *decon,
 		struct decon_rect *up_region);
+void dpu_reset_win_update_damage(struct decon_device *decon);
 
 /* internal only function API */
 int decon_check_var(struct fb_var_screeninfo *var, struct fb_info *info);
@@ -1344,7 +1371,7 @@ void decon_to_psr_info(struct decon_device *decon, struct decon_mode_info *psr);
 void decon_to_init_param(struct decon_device *decon, struct decon_param *p);
 void decon_create_timeline(struct decon_device *decon, char *name);
 int decon_create_fence(struct decon_device *decon);
-void decon_wait_fence(struct sync_file *fence);
+void decon_wait_fence(struct decon_device *decon, struct sync_file *fence);
 void decon_signal_fence(struct decon_device *decon);
 
 bool decon_intersect(struct decon_rect *r1, struct decon_rect *r2);
@@ -1372,6 +1399,8 @@ void decon_dpp_stop(struct decon_device *decon, bool do_reset);
 #define S3CFB_SET_VSYNC_INT		_IOW('F', 206, __u32)
 #define S3CFB_WIN_CONFIG		_IOW('F', 209, \
 						struct decon_win_config_data)
+#define S3CFB_CHECK_WIN_CONFIG		_IOWR('F', 210, \
+						struct decon_win_config_check)
 
 #define S3CFB_START_CRC			_IOW('F', 270, u32)
 #define S3CFB_SEL_CRC_BITS		_IOW('F', 271, u32)
@@ -46,6 +46,9 @@
 
 int decon_log_level = 6;
 module_param(decon_log_level, int, 0644);
+/* skip a queued frame once a newer one is ready to be shown */
+static int decon_drop_late_frames;
+module_param(decon_drop_late_frames, int, 0644);
 struct decon_device *decon_drvdata[MAX_DECON_CNT];
 EXPORT_SYMBOL(decon_drvdata);
 
@@ -518,6 +521,7 @@ static int decon_enable(struct decon_device *decon)
 	 * DECON, DSIM and Panel are initialized as FULL size during UNBLANK
 	 */
 	DPU_FULL_RECT(&decon->win_up.prev_up_region, decon->lcd_info);
+	dpu_reset_win_update_damage(decon);
 
 	if (!decon->id && !decon->eint_status) {
 		enable_irq(decon->res.irq);
@@ -697,6 +701,7 @@ static int decon_disable(struct decon_device *decon)
 	decon_runtime_suspend(decon->dev);
 #endif
 
+	dpu_reset_win_update_damage(decon);
 	decon->state = DECON_STATE_OFF;
 
 err:
@@ -1623,7 +1628,7 @@ static void decon_update_regs(struct decon_device *decon,
 
 	for (i = 0; i < decon->dt.max_win; i++) {
 		if (regs->dma_buf_data[i][0].fence)
-			decon_wait_fence(regs->dma_buf_data[i][0].fence);
+			decon_wait_fence(decon, regs->dma_buf_data[i][0].fence);
 	}
 
 	decon_check_used_dpp(decon, regs);
@@ -1692,6 +1697,48 @@ static void decon_update_regs(struct decon_device *decon,
 	decon_dpp_stop(decon, false);
 }
 
+static bool decon_reg_data_ready(struct decon_device *decon,
+		struct decon_reg_data *regs)
+{
+	struct sync_file *fence;
+	int i;
+
+	for (i = 0; i < decon->dt.max_win; i++) {
+		fence = regs->dma_buf_data[i][0].fence;
+		if (fence && !fence_is_signaled(fence->fence))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Throw away a queued frame that @next supersedes. Its release fence is
+ * signalled along with the one of @next.
+ */
+static void decon_drop_reg_data(struct decon_device *decon,
+		struct decon_reg_data *regs, struct decon_reg_data *next)
+{
+	int i, j;
+
+	decon_dbg("decon%d: frame dropped, a newer one is ready\n", decon->id);
+
+	for (i = 0; i < decon->dt.max_win; i++)
+		for (j = 0; j < MAX_PLANE_CNT; ++j)
+			decon_free_dma_buf(decon, &regs->dma_buf_data[i][j]);
+
+	/* the update region of @next was derived from this frame's */
+	if (regs->need_update)
+		next->need_update = true;
+
+#if defined(CONFIG_EXYNOS8895_BTS)
+	/* nothing changes on the bus, only the queued vote goes away */
+	decon->bts.ops->bts_update_bw(decon, regs, 1);
+#endif
+
+	decon_hiber_unblock(decon);
+}
+
 static void decon_update_regs_handler(struct kthread_work *work)
 {
 	struct decon_update_regs *up =
@@ -1702,6 +1749,8 @@ static void decon_update_regs_handler(struct kthread_work *work)
 	struct decon_reg_data *data, *next;
 	struct list_head saved_list;
 
+	int dropped = 0;
+
 	mutex_lock(&decon->up.lock);
 	decon->up.saved_list = decon->up.list;
 	saved_list = decon->up.list;
@@ -1712,7 +1761,25 @@ static void decon_update_regs_handler(struct kthread_work *work)
 	mutex_unlock(&decon->up.lock);
 
 	list_for_each_entry_safe(data, next, &saved_list, list) {
+		if (decon_drop_late_frames && !decon->up_list_saved &&
+				decon->dt.out_type != DECON_OUT_WB &&
+				!list_is_last(&data->list, &saved_list) &&
+				decon_reg_data_ready(decon, next)) {
+			decon_drop_reg_data(decon, data, next);
+			dropped++;
+			list_del(&data->list);
+			kfree(data);
+			continue;
+		}
+
 		decon_update_regs(decon, data);
+		/*
+		 * The frames dropped in front of this one are retired with it,
+		 * their buffers never reached the screen and what was shown
+		 * before them stayed up until now.
+		 */
+		for (; dropped; dropped--)
+			decon_signal_fence(decon);
 		decon_hiber_unblock(decon);
 		if (!decon->up_list_saved) {
 			list_del(&data->list);
@@ -1880,6 +1947,10 @@ static int decon_set_win_config(struct decon_device *decon,
 	if (ret)
 		goto err_prepare;
 
+#if defined(CONFIG_EXYNOS8895_BTS)
+	decon->bts.ops->bts_prepare_bw(decon, regs);
+#endif
+
 	decon_hiber_block(decon);
 
 	mutex_lock(&decon->up.lock);
@@ -1894,6 +1965,8 @@ static int decon_set_win_config(struct decon_device *decon,
 	return ret;
 
 err_prepare:
+	/* the frame is not shown, do not compare the next one against it */
+	dpu_reset_win_update_damage(decon);
 	kfree(regs);
 	win_data->fence = -1;
 err:
@@ -1901,12 +1974,125 @@ static int decon_set_win_config(struct decon_device *decon,
 	return ret;
 }
 
+/* channels that could take window @idx of @config, as a bitmap */
+static unsigned long decon_get_capable_dpp(struct decon_device *decon,
+		int idx, struct decon_win_config *config)
+{
+	struct decon_win_config tmp;
+	unsigned long capable = 0;
+	int ch;
+
+	for (ch = 0; ch < ODMA_WB; ch++) {
+		/* IDMA_G0 channel is dedicated to WIN5 */
+		if (!decon->id && ch == IDMA_G0 && idx != MAX_DECON_WIN - 1)
+			continue;
+
+		if (!decon->dpp_sd[ch])
+			continue;
+
+		memcpy(&tmp, config, sizeof(struct decon_win_config));
+		tmp.idma_type = ch;
+		if (decon_check_limitation(decon, idx, &tmp))
+			return 0;
+
+		tmp.format = dpu_translate_fmt_to_dpp(tmp.format);
+		if (!v4l2_subdev_call(decon->dpp_sd[ch], core, ioctl,
+					DPP_CHECK_CONFIG, &tmp))
+			set_bit(ch, &capable);
+	}
+
+	return capable;
+}
+
+/*
+ * Give every buffer window the cheapest free channel that accepts it. The
+ * channels are ordered from the plain to the scaling/AFBC ones, and the
+ * windows with the fewest choices are placed first.
+ */
+static int decon_check_win_config(struct decon_device *decon,
+		struct decon_win_config_check *check)
+{
+	unsigned long capable[MAX_DECON_WIN] = { 0, };
+	unsigned long used = 0, avail;
+	bool placed[MAX_DECON_WIN] = { false, };
+	struct decon_device *other;
+	int i, best, n, best_n;
+
+	for (i = 0; i < MAX_DECON_CNT; i++) {
+		other = get_decon_drvdata(i);
+		if (other && other != decon)
+			used |= other->cur_using_dpp;
+	}
+
+	for (i = 0; i < decon->dt.max_win; i++) {
+		if (check->config[i].state != DECON_WIN_STATE_BUFFER) {
+			placed[i] = true;
+			continue;
+		}
+
+		capable[i] = decon_get_capable_dpp(decon, i, &check->config[i]);
+	}
+
+	for (;;) {
+		best = -1;
+		best_n = 0;
+		for (i = 0; i < decon->dt.max_win; i++) {
+			if (placed[i])
+				continue;
+
+			n = hweight_long(capable[i] & ~used);
+			if (best < 0 || n < best_n) {
+				best = i;
+				best_n = n;
+			}
+		}
+
+		if (best < 0)
+			break;
+
+		avail = capable[best] & ~used;
+		if (!avail) {
+			decon_dbg("decon%d: no channel left for win%d\n",
+					decon->id, best);
+			return -EINVAL;
+		}
+
+		check->config[best].idma_type = __ffs(avail);
+		set_bit(check->config[best].idma_type, &used);
+		placed[best] = true;
+	}
+
+#if defined(CONFIG_EXYNOS8895_BTS)
+	{
+		enum decon_pixel_format format[MAX_DECON_WIN];
+		struct bts_bw bw = { 0, };
+
+		/* BTS works on the DPP formats, hand the caller's back after */
+		for (i = 0; i < MAX_DECON_WIN; i++) {
+			format[i] = check->config[i].format;
+			check->config[i].format = dpu_translate_fmt_to_dpp(format[i]);
+		}
+
+		decon->bts.ops->bts_estimate_bw(decon, check->config, &bw,
+				&check->disp_freq);
+		check->total_bw = bw.read;
+		check->peak_bw = bw.peak;
+
+		for (i = 0; i < MAX_DECON_WIN; i++)
+			check->config[i].format = format[i];
+	}
+#endif
+
+	return 0;
+}
+
 static int decon_ioctl(struct fb_info *info, unsigned int cmd,
 			unsigned long arg)
 {
 	struct decon_win *win = info->par;
 	struct decon_device *decon = win->decon;
 	struct decon_win_config_data win_data;
+	struct decon_win_config_check *check;
 	struct exynos_displayport_data displayport_data;
 	int ret = 0;
 	u32 crtc;
@@ -1958,6 +2144,29 @@ static int decon_ioctl(struct fb_info *info, unsigned int cmd,
 		}
 		break;
 
+	case S3CFB_CHECK_WIN_CONFIG:
+		check = kzalloc(sizeof(*check), GFP_KERNEL);
+		if (!check) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		if (copy_from_user(check,
+				   (struct decon_win_config_check __user *)arg,
+				   sizeof(*check))) {
+			ret = -EFAULT;
+			kfree(check);
+			break;
+		}
+
+		ret = decon_check_win_config(decon, check);
+		if (!ret && copy_to_user((struct decon_win_config_check __user *)arg,
+				check, sizeof(*check)))
+			ret = -EFAULT;
+
+		kfree(check);
+		break;
+
 	case S3CFB_START_CRC:
 		if (get_user(crc_start, (u32 __user *)arg)) {
 			ret = -EFAULT;
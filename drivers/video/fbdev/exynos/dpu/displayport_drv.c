@@ -47,6 +47,15 @@ static u8 max_link_rate;
 static u64 reduced_resolution;
 struct displayport_debug_param g_displayport_debug_param;
 
+/*
+ * Memory read bandwidth in MB/s a mode may cost the DECON driving the
+ * external display, so that DeX on a large monitor leaves the bus to the
+ * rest of the system. 0 means no limit.
+ */
+static unsigned int displayport_bw_budget;
+module_param(displayport_bw_budget, uint, 0644);
+MODULE_PARM_DESC(displayport_bw_budget, "Max DPU read bandwidth of a mode in MB/s (0 = no limit)");
+
 struct displayport_device *displayport_drvdata;
 EXPORT_SYMBOL(displayport_drvdata);
 
@@ -1793,6 +1802,17 @@ static u64 displayport_get_max_pixelclock(void)
 	return pc;
 }
 
+/*
+ * Read bandwidth in MB/s of a full screen ARGB8888 layer in @preset, the
+ * frame DeX composes, as bts_calc_bw() counts it for a single DPP.
+ */
+static u32 displayport_preset_bw(struct displayport_supported_preset *preset)
+{
+	u64 bw = (u64)preset->xres * preset->yres * preset->refresh * 4;
+
+	return (u32)div_u64(bw, 1000000);
+}
+
 static int displayport_enum_dv_timings(struct v4l2_subdev *sd,
 		struct v4l2_enum_dv_timings *timings)
 {
@@ -1815,6 +1835,14 @@ static int displayport_enum_dv_timings(struct v4l2_subdev *sd,
 		return -E2BIG;
 	}
 
+	if (displayport_bw_budget && displayport_bw_budget <
+			displayport_preset_bw(&displayport_supported_presets[timings->index])) {
+		displayport_info("%s over bw budget: %u MB/s\n",
+				displayport_supported_presets[timings->index].name,
+				displayport_bw_budget);
+		return -E2BIG;
+	}
+
 	if (displayport_supported_presets[timings->index].edid_support_match) {
 		displayport_info("matched %d(%s)\n", timings->index,
 				displayport_supported_presets[timings->index].name);
@@ -344,10 +344,9 @@ static inline void dma_write_mask(u32 id, u32 reg_id, u32 val, u32 mask)
 #endif
 
 static inline void dpp_select_format(struct dpp_device *dpp,
+			struct decon_win_config *config,
 			struct dpp_img_format *vi, struct dpp_params_info *p)
 {
-	struct decon_win_config *config = dpp->config;
-
 	vi->vgr = is_vgr(dpp);
 	vi->normal = is_normal(dpp);
 	vi->flip = p->flip;
@@ -389,5 +388,6 @@ void dma_reg_set_common_debug(u32 id);
 #define DPP_WB_WAIT_FOR_FRAMEDONE	_IOR('P', 3, u32)
 #define DPP_WAIT_IDLE			_IOR('P', 4, unsigned long)
 #define DPP_SET_RECOVERY_NUM		_IOR('P', 5, unsigned long)
+#define DPP_CHECK_CONFIG		_IOW('P', 6, struct decon_win_config)
 
 #endif /* __SAMSUNG_DPP_H__ */
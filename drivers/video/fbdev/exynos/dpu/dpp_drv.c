@@ -292,10 +292,10 @@ static int dpp_wb_wait_for_framedone(struct dpp_device *dpp)
 	return 0;
 }
 
-static void dpp_get_params(struct dpp_device *dpp, struct dpp_params_info *p)
+static void dpp_get_params(struct dpp_device *dpp,
+		struct decon_win_config *config, struct dpp_params_info *p)
 {
 	u64 src_w, src_h, dst_w, dst_h;
-	struct decon_win_config *config = dpp->config;
 
 	memcpy(&p->src, &config->src, sizeof(struct decon_frame));
 	memcpy(&p->dst, &config->dst, sizeof(struct decon_frame));
@@ -332,9 +332,9 @@ static void dpp_get_params(struct dpp_device *dpp, struct dpp_params_info *p)
 		p->is_block = true;
 }
 
-static int dpp_check_size(struct dpp_device *dpp, struct dpp_img_format *vi)
+static int dpp_check_size(struct dpp_device *dpp,
+		struct decon_win_config *config, struct dpp_img_format *vi)
 {
-	struct decon_win_config *config = dpp->config;
 	struct decon_frame *src = &config->src;
 	struct decon_frame *dst = &config->dst;
 	struct dpp_size_constraints vc;
@@ -454,7 +454,8 @@ static int dpp_check_format(struct dpp_device *dpp, struct dpp_params_info *p)
  * TODO: h/w limitation will be changed in KC
  * This function must be modified for KC after releasing DPP constraints
  */
-static int dpp_check_limitation(struct dpp_device *dpp, struct dpp_params_info *p)
+static int dpp_check_limitation(struct dpp_device *dpp,
+		struct decon_win_config *config, struct dpp_params_info *p)
 {
 	int ret;
 	struct dpp_img_format vi;
@@ -465,7 +466,7 @@ static int dpp_check_limitation(struct dpp_device *dpp, struct dpp_params_info *
 		return -EINVAL;
 	}
 
-	dpp_select_format(dpp, &vi, p);
+	dpp_select_format(dpp, config, &vi, p);
 
 	ret = dpp_check_format(dpp, p);
 	if (ret)
@@ -508,7 +509,7 @@ static int dpp_check_limitation(struct dpp_device *dpp, struct dpp_params_info *
 		return -EINVAL;
 	}
 
-	ret = dpp_check_size(dpp, &vi);
+	ret = dpp_check_size(dpp, config, &vi);
 	if (ret)
 		return -EINVAL;
 
@@ -542,10 +543,10 @@ static int dpp_set_config(struct dpp_device *dpp)
 	}
 
 	/* parameters from decon driver are translated for dpp driver */
-	dpp_get_params(dpp, &params);
+	dpp_get_params(dpp, dpp->config, &params);
 
 	/* all parameters must be passed dpp hw limitation */
-	ret = dpp_check_limitation(dpp, &params);
+	ret = dpp_check_limitation(dpp, dpp->config, &params);
 	if (ret)
 		goto err;
 
@@ -570,6 +571,20 @@ static int dpp_set_config(struct dpp_device *dpp)
 	return ret;
 }
 
+/* Only tells whether @config would be accepted, the hardware is not touched */
+static int dpp_check_config(struct dpp_device *dpp,
+		struct decon_win_config *config)
+{
+	struct dpp_params_info params;
+
+	if (!config->dst.w || !config->dst.h)
+		return -EINVAL;
+
+	dpp_get_params(dpp, config, &params);
+
+	return dpp_check_limitation(dpp, config, &params);
+}
+
 static int dpp_stop(struct dpp_device *dpp, bool reset)
 {
 	int ret = 0;
@@ -625,6 +640,10 @@ static long dpp_subdev_ioctl(struct v4l2_subdev *sd, unsigned int cmd, void *arg
 			dpp_err("failed to configure dpp%d\n", dpp->id);
 		break;
 
+	case DPP_CHECK_CONFIG:
+		ret = dpp_check_config(dpp, (struct decon_win_config *)arg);
+		break;
+
 	case DPP_STOP:
 		ret = dpp_stop(dpp, reset);
 		if (ret)
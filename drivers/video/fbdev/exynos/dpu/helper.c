@@ -11,6 +11,7 @@
 
 #include <linux/clk.h>
 #include <linux/err.h>
+#include <linux/moduleparam.h>
 #include <linux/pm_runtime.h>
 #include <linux/sync_file.h>
 #include <asm/cacheflush.h>
@@ -365,9 +366,45 @@ int decon_create_fence(struct decon_device *decon)
 	return fd;
 }
 
-void decon_wait_fence(struct sync_file *sync_file)
+#ifdef CONFIG_MALI_DVFS_FENCE_BOOST
+extern int gpu_dvfs_fence_boost(struct sync_file *sync_file);
+
+/* boost the GPU once an acquire fence kept us waiting this % of a frame */
+static unsigned int decon_fence_boost_pct;
+module_param(decon_fence_boost_pct, uint, 0644);
+
+static void decon_wait_fence_boost(struct decon_device *decon,
+		struct sync_file *sync_file)
 {
-	int err = sync_file_wait(sync_file, 900);
+	u32 fps = decon->lcd_info->fps ? decon->lcd_info->fps : 60;
+	unsigned int pct = min(READ_ONCE(decon_fence_boost_pct), 100U);
+	signed long timeout;
+
+	if (!pct)
+		return;
+
+	timeout = usecs_to_jiffies(USEC_PER_SEC / fps * pct / 100);
+	if (fence_wait_timeout(sync_file->fence, true, timeout ? timeout : 1))
+		return;
+
+	/* still not signaled, ask the GPU to hurry up if the fence is its own */
+	if (!gpu_dvfs_fence_boost(sync_file))
+		decon_dbg("boosted GPU for a late acquire fence\n");
+}
+#else
+static inline void decon_wait_fence_boost(struct decon_device *decon,
+		struct sync_file *sync_file)
+{
+}
+#endif
+
+void decon_wait_fence(struct decon_device *decon, struct sync_file *sync_file)
+{
+	int err;
+
+	decon_wait_fence_boost(decon, sync_file);
+
+	err = sync_file_wait(sync_file, 900);
 	if (err >= 0)
 		return;
 
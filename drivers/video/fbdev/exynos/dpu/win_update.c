@@ -9,12 +9,177 @@
  * published by the Free Software Foundation.
 */
 
+#include <linux/module.h>
+#include <linux/dma-buf.h>
 #include <video/mipi_display.h>
 
 #include "decon.h"
 #include "dpp.h"
 #include "dsim.h"
 
+/*
+ * Derive the update region from the windows that changed since the previous
+ * frame when the platform does not pass one in DECON_WIN_UPDATE_IDX.
+ */
+static int win_update_auto;
+module_param(win_update_auto, int, 0644);
+MODULE_PARM_DESC(win_update_auto, "Compute the partial update region from window changes (0 = off)");
+
+static bool win_update_win_changed(struct decon_win_config *old,
+		struct dma_buf *old_buf, struct decon_win_config *new,
+		struct dma_buf *new_buf)
+{
+	if (old->state != new->state)
+		return true;
+
+	if (new->state == DECON_WIN_STATE_DISABLED)
+		return false;
+
+	if (memcmp(&old->dst, &new->dst, sizeof(struct decon_frame)))
+		return true;
+
+	if (new->state == DECON_WIN_STATE_COLOR)
+		return old->color != new->color;
+
+	/*
+	 * The same buffer is queued again with an acquire fence when its
+	 * content has been rendered anew, count that as a change as well.
+	 */
+	if (!new_buf || new_buf != old_buf || new->fence_fd >= 0)
+		return true;
+
+	return memcmp(&old->src, &new->src, sizeof(struct decon_frame)) ||
+		old->plane_alpha != new->plane_alpha ||
+		old->blending != new->blending ||
+		old->idma_type != new->idma_type ||
+		old->format != new->format ||
+		old->dpp_parm.flip != new->dpp_parm.flip ||
+		old->dpp_parm.eq_mode != new->dpp_parm.eq_mode ||
+		old->dpp_parm.comp_src != new->dpp_parm.comp_src ||
+		old->protection != new->protection;
+}
+
+static void win_update_add_damage(struct decon_device *decon,
+		struct decon_win_config *config, struct decon_rect *damage,
+		bool *damaged)
+{
+	struct decon_lcd *lcd = decon->lcd_info;
+	struct decon_rect r;
+
+	if (config->state == DECON_WIN_STATE_DISABLED)
+		return;
+
+	if (!config->dst.w || !config->dst.h ||
+			config->dst.x + (int)config->dst.w <= 0 ||
+			config->dst.y + (int)config->dst.h <= 0 ||
+			config->dst.x >= (int)lcd->xres ||
+			config->dst.y >= (int)lcd->yres)
+		return;
+
+	r.left = max(config->dst.x, 0);
+	r.top = max(config->dst.y, 0);
+	r.right = min_t(u32, config->dst.x + config->dst.w, lcd->xres) - 1;
+	r.bottom = min_t(u32, config->dst.y + config->dst.h, lcd->yres) - 1;
+
+	if (!*damaged) {
+		memcpy(damage, &r, sizeof(struct decon_rect));
+		*damaged = true;
+		return;
+	}
+
+	damage->left = min(damage->left, r.left);
+	damage->top = min(damage->top, r.top);
+	damage->right = max(damage->right, r.right);
+	damage->bottom = max(damage->bottom, r.bottom);
+}
+
+/*
+ * Compare the windows with the previous frame and remember this one. Unless
+ * the caller asked for an update region itself, the union of the old and new
+ * areas of the changed windows becomes the update region. Called with
+ * decon->lock held, before any coordinate is reconfigured.
+ */
+static void win_update_detect_damage(struct decon_device *decon,
+		struct decon_win_config *win_config)
+{
+	struct decon_win_config *update_config = &win_config[DECON_WIN_UPDATE_IDX];
+	struct decon_win_update *win_up = &decon->win_up;
+	struct decon_win_config *config, *prev;
+	struct dma_buf *buf;
+	struct decon_rect damage, full;
+	bool damaged = false;
+	int i;
+
+	for (i = 0; i < decon->dt.max_win; i++) {
+		config = &win_config[i];
+		prev = &win_up->prev_config[i];
+
+		buf = NULL;
+		if (config->state == DECON_WIN_STATE_BUFFER) {
+			buf = dma_buf_get(config->fd_idma[0]);
+			if (IS_ERR(buf))
+				buf = NULL;
+		}
+
+		if (!win_up->prev_valid ||
+				win_update_win_changed(prev, win_up->prev_buf[i],
+					config, buf)) {
+			win_update_add_damage(decon, prev, &damage, &damaged);
+			win_update_add_damage(decon, config, &damage, &damaged);
+		}
+
+		/* the reference only keeps the pointer from being reused */
+		if (win_up->prev_buf[i])
+			dma_buf_put(win_up->prev_buf[i]);
+		win_up->prev_buf[i] = buf;
+		memcpy(prev, config, sizeof(struct decon_win_config));
+	}
+
+	if (!win_up->prev_valid) {
+		win_up->prev_valid = true;
+		return;
+	}
+
+	if (update_config->state == DECON_WIN_STATE_UPDATE)
+		return;
+
+	/* nothing changed: any region is right, keep the current one */
+	if (!damaged)
+		memcpy(&damage, &win_up->prev_up_region, sizeof(struct decon_rect));
+
+	DPU_FULL_RECT(&full, decon->lcd_info);
+	if (!is_decon_rect_differ(&damage, &full))
+		return;
+
+	DPU_DEBUG_WIN("damage region[%d %d %d %d]\n",
+			damage.left, damage.top,
+			damage.right - damage.left + 1,
+			damage.bottom - damage.top + 1);
+
+	update_config->state = DECON_WIN_STATE_UPDATE;
+	update_config->dst.x = damage.left;
+	update_config->dst.y = damage.top;
+	update_config->dst.w = damage.right - damage.left + 1;
+	update_config->dst.h = damage.bottom - damage.top + 1;
+}
+
+/*
+ * Forget the previous frame, so that the next one is compared against
+ * nothing and shown in full. Called with decon->lock held.
+ */
+void dpu_reset_win_update_damage(struct decon_device *decon)
+{
+	struct decon_win_update *win_up = &decon->win_up;
+	int i;
+
+	for (i = 0; i < MAX_DECON_WIN; i++) {
+		if (win_up->prev_buf[i])
+			dma_buf_put(win_up->prev_buf[i]);
+		win_up->prev_buf[i] = NULL;
+	}
+	win_up->prev_valid = false;
+}
+
 static void win_update_adjust_region(struct decon_device *decon,
 		struct decon_win_config *win_config,
 		struct decon_reg_data *regs)
@@ -230,6 +395,11 @@ void dpu_prepare_win_update_config(struct decon_device *decon,
 	if (decon->dt.out_type != DECON_OUT_DSI)
 		return;
 
+	if (win_update_auto)
+		win_update_detect_damage(decon, win_config);
+	else if (decon->win_up.prev_valid)
+		dpu_reset_win_update_damage(decon);
+
 	/* find adjusted update region on LCD */
 	win_update_adjust_region(decon, win_config, regs);
 
@@ -69,6 +69,9 @@ struct iva_ipcq_stat {
 	uint32_t		trans_nr;
 };
 
+/* mails to the mcu waiting for the mailbox, a power of 2 */
+#define IVA_IPCQ_DB_NR		(64)
+
 struct iq_pend_mail;
 struct iva_ipcq {
 	struct iva_dev_data	*iva_data;
@@ -91,6 +94,10 @@ struct iva_ipcq {
 	uint32_t		rsv_hint;
 	struct iq_pend_mail	*rsv;
 	struct iva_ipcq_stat	ipcq_stat;
+	spinlock_t		db_slock;
+	uint32_t		db_head;
+	uint32_t		db_nr;
+	uint32_t		db_mails[IVA_IPCQ_DB_NR];
 };
 
 #define IVA_ST_INIT_DONE		(0)
@@ -109,6 +116,8 @@ struct iva_proc {
 	uint32_t		mem_map_nr;
 	struct mutex		mem_map_lock;
 	DECLARE_HASHTABLE(h_mem_map, 9);	/* 512 */
+	struct list_head	mem_map_idle;	/* lru of cached iova maps */
+	uint32_t		mem_map_idle_nr;
 };
 
 struct iva_dev_data {
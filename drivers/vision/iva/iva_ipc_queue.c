@@ -208,6 +208,11 @@ static void __iva_ipcq_free_pend_mail(struct iva_ipcq *ipcq,
 }
 
 
+/*
+ * return 1 if the pending list was empty, that is the waiters need to be
+ * woken up. Otherwise they were already woken up for the earlier mails and
+ * will find this one before going back to sleep.
+ */
 static int iva_ipcq_insert_pending_mail(struct iva_ipcq *ipcq,
 		uint64_t mail, bool from_mbox, bool from_irq)
 {
@@ -215,6 +220,7 @@ static int iva_ipcq_insert_pending_mail(struct iva_ipcq *ipcq,
 	struct iva_dev_data	*iva = ipcq->iva_data;
 	struct device		*dev = iva->dev;
 	unsigned long		flags;
+	int			was_empty;
 
 	pend_mail = __iva_ipcq_alloc_pend_mail(ipcq, from_irq);
 	if (!pend_mail) {
@@ -231,10 +237,11 @@ static int iva_ipcq_insert_pending_mail(struct iva_ipcq *ipcq,
 			__func__, pend_mail, pend_mail->mail, pend_mail->flags);
 
 	spin_lock_irqsave(&ipcq->ipcq_slock, flags);
+	was_empty = list_empty(&ipcq->ipcq_pend_list);
 	list_add_tail(&pend_mail->node, &ipcq->ipcq_pend_list);
 	spin_unlock_irqrestore(&ipcq->ipcq_slock, flags);
 
-	return 0;
+	return was_empty;
 }
 
 #ifdef ENABLE_IPCQ_WORK_QUEUE
@@ -249,7 +256,7 @@ static void iva_ipcq_do_work(struct work_struct *work)
 
 	ret = iva_ipcq_insert_pending_mail(ipcq,
 			(uint64_t) ipcq_work->msg, true, false);
-	if (ret) {	/* error */
+	if (ret < 0) {	/* error */
 		dev_err(dev, "%s() fail to insert mail. ret(%d)\n", ret);
 		return;
 	}
@@ -266,7 +273,7 @@ static bool iva_ipcq_callback(struct iva_mbox_cb_block *ctrl_blk, uint32_t msg)
 #ifdef ENABLE_IPCQ_WORK_QUEUE
 	struct iva_ipcq_work	*ipcq_work = &iva->ipcq_work;
 #endif
-	bool			ret;
+	int			ret;
 
 	dev_dbg(iva->dev, "%s() 0x%x\n", __func__, msg);
 #ifdef ENABLE_IPCQ_WORK_QUEUE
@@ -274,14 +281,15 @@ static bool iva_ipcq_callback(struct iva_mbox_cb_block *ctrl_blk, uint32_t msg)
 	schedule_work(&ipcq_work->work);
 #else
 	ret = iva_ipcq_insert_pending_mail(ipcq, (uint64_t) msg, true, true);
-	if (ret) {	/* error */
+	if (ret < 0) {	/* error */
 		dev_err(iva->dev, "%s() fail to insert mail.\n", __func__);
 		return true;
 	}
 
-	dev_dbg(iva->dev, "%s() wake up... 0x%x\n", __func__, msg);
-
-	wake_up(&ipcq->ipcq_wait_queue);
+	if (ret) {
+		dev_dbg(iva->dev, "%s() wake up... 0x%x\n", __func__, msg);
+		wake_up(&ipcq->ipcq_wait_queue);
+	}
 #endif
 	return true;
 }
@@ -534,6 +542,49 @@ static void iva_ipcq_save_transaction(struct iva_ipcq *ipcq,
 	mutex_unlock(&stat->trans_mtx);
 }
 
+/*
+ * Mails to the mcu are queued and pushed into the mailbox by one producer
+ * at a time, the one which found the queue empty. The others return at
+ * once instead of all polling the mailbox occupancy against each other
+ * when several clients share the mcu.
+ */
+static int iva_ipcq_ring_doorbell(struct iva_ipcq *ipcq, uint32_t mail)
+{
+	struct iva_dev_data	*iva = ipcq->iva_data;
+	uint32_t		idx;
+	int			ret = 0;
+
+	spin_lock(&ipcq->db_slock);
+	if (ipcq->db_nr == IVA_IPCQ_DB_NR) {
+		spin_unlock(&ipcq->db_slock);
+		dev_err(iva->dev, "%s() doorbell queue is full\n", __func__);
+		return -EBUSY;
+	}
+
+	idx = (ipcq->db_head + ipcq->db_nr) & (IVA_IPCQ_DB_NR - 1);
+	ipcq->db_mails[idx] = mail;
+	if (ipcq->db_nr++) {
+		/* being flushed by another producer */
+		spin_unlock(&ipcq->db_slock);
+		return 0;
+	}
+
+	while (ipcq->db_nr) {
+		mail = ipcq->db_mails[ipcq->db_head];
+		spin_unlock(&ipcq->db_slock);
+
+		if (!ret)
+			ret = iva_mbox_send_mail_to_mcu(iva, mail);
+
+		spin_lock(&ipcq->db_slock);
+		ipcq->db_head = (ipcq->db_head + 1) & (IVA_IPCQ_DB_NR - 1);
+		ipcq->db_nr--;
+	}
+	spin_unlock(&ipcq->db_slock);
+
+	return ret;
+}
+
 static int iva_ipcq_send_cmd(struct iva_ipcq *ipcq,
 		struct ipc_cmd_param __iomem *ipc_param)
 {
@@ -550,7 +601,7 @@ static int iva_ipcq_send_cmd(struct iva_ipcq *ipcq,
 	/* send really */
 	conv_param_p = __iva_ipcq_get_mcu_from_va(iva, cmd_param);
 
-	return iva_mbox_send_mail_to_mcu(iva, conv_param_p);
+	return iva_ipcq_ring_doorbell(ipcq, conv_param_p);
 }
 
 static inline int iva_ipcq_copy_from_user(uint32_t *dest,
@@ -717,7 +768,7 @@ static int32_t iva_ipcq_free_rsp(struct iva_ipcq *ipcq,
 		r_param->ipc_cmd_type = IPC_CMD_NONE;
 
 		if (ipcq->ipcq_ctrl_req)
-			iva_mbox_send_mail_to_mcu(iva,
+			iva_ipcq_ring_doorbell(ipcq,
 				MBOX_CTRL_IPCQ_CTRL_RSP_QUEUE_FREE);
 		ipcq->ipcq_ctrl_req = false;
 	}
@@ -966,13 +1017,14 @@ int iva_ipcq_send_rsp_k(struct iva_ipcq *ipcq,
 	#endif
 			false, false);
 
-	if (ret) {
+	if (ret < 0) {
 		dev_err(dev, "%s() fail to insert pend mail, from %pF\n",
 				__func__, __builtin_return_address(0));
 		return ret;
 	}
 
-	wake_up(&ipcq->ipcq_wait_queue);
+	if (ret)
+		wake_up(&ipcq->ipcq_wait_queue);
 #endif
 	return 0;
 }
@@ -1128,6 +1180,9 @@ int iva_ipcq_probe(struct iva_dev_data *iva)
 	mutex_init(&ipcq->ipcq_mutex);
 	spin_lock_init(&ipcq->ipcq_slock);
 	spin_lock_init(&ipcq->rsv_slock);
+	spin_lock_init(&ipcq->db_slock);
+	ipcq->db_head = 0;
+	ipcq->db_nr = 0;
 	init_waitqueue_head(&ipcq->ipcq_wait_queue);
 	INIT_LIST_HEAD(&ipcq->ipcq_pend_list);
 #ifdef ENABLE_IPCQ_WORK_QUEUE
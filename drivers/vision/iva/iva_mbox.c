@@ -272,21 +272,32 @@ int iva_mbox_callback_unregister(struct iva_mbox_cb_block *cb)
 	return ret;
 }
 
+/* mails handled in one go before giving the cpu back */
+#define MBOX_IRQ_BATCH_NR	(8)
+
 static inline void __iva_mbox_handle_irq(struct iva_dev_data *iva)
 {
 	uint32_t msg;
+	int i;
 
-	if (!iva_mbox_pending_mail_from_mcu(iva))
-		return;
+	/*
+	 * The mcu may post the next completion while the previous one is
+	 * handled: take it in the same pass rather than with another irq.
+	 */
+	for (i = 0; i < MBOX_IRQ_BATCH_NR; i++) {
+		if (!iva_mbox_pending_mail_from_mcu(iva))
+			return;
 
-	/* read msg and clear intr */
-	msg = iva_mbox_read_mail_from_mcu(iva);
-	iva_mbox_clear_pending_mail_from_mcu(iva);
+		/* read msg and clear intr */
+		msg = iva_mbox_read_mail_from_mcu(iva);
+		iva_mbox_clear_pending_mail_from_mcu(iva);
 
-	dev_dbg(iva->dev, "%s() iva(%p) cb->msg(0x%x)\n", __func__, iva, msg);
+		dev_dbg(iva->dev, "%s() iva(%p) cb->msg(0x%x)\n",
+				__func__, iva, msg);
 
-	/* transfer it to customer */
-	iva_mbox_call_cb_chain(msg);
+		/* transfer it to customer */
+		iva_mbox_call_cb_chain(msg);
+	}
 }
 
 
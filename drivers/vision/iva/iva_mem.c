@@ -37,6 +37,9 @@
 #define IVA_MEM_GET_SHARED_FD(fd) \
 	(fd & ~(1 << IVA_MEM_ALLOC_TYPE_FD_SHIFT))
 
+/* iova maps kept per process after their last put, oldest dropped first */
+#define IVA_MEM_IDLE_MAP_MAX		(16)
+
 static void __iva_mem_map_destroy(struct kref *kref)
 {
 	struct iva_mem_map	*iva_map_node =
@@ -72,6 +75,9 @@ static void __iva_mem_map_destroy(struct kref *kref)
 	}
 }
 
+static void iva_mem_drop_idle_map(struct iva_proc *proc,
+		struct iva_mem_map *iva_map_node);
+
 static inline void iva_mem_map_get_refcnt(struct iva_mem_map *iva_map)
 {
 	kref_get(&iva_map->map_ref);
@@ -87,6 +93,16 @@ int iva_mem_map_read_refcnt(struct iva_mem_map *iva_map)
 	return atomic_read(&iva_map->map_ref.refcount);
 }
 
+/* references held by user, a cached map holds one more of its own */
+static inline int iva_mem_map_read_user_refcnt(struct iva_mem_map *iva_map)
+{
+	int ref_cnt = iva_mem_map_read_refcnt(iva_map);
+
+	if (MAP_CACHED(iva_map->flags))
+		ref_cnt--;
+	return ref_cnt;
+}
+
 static int iva_mem_show_proc_mapped_list_nolock(struct iva_proc *proc)
 {
 	struct iva_mem_map	*iva_map_node;
@@ -238,6 +254,7 @@ static struct iva_mem_map *iva_mem_ion_alloc(struct iva_proc *proc,
 	iva_map_node->attachment = NULL;
 	iva_map_node->sg_table	= NULL;
 	iva_map_node->io_va	= 0x0;
+	INIT_LIST_HEAD(&iva_map_node->idle_node);
 	iva_map_node->req_size	= size;
 	iva_map_node->act_size	= (uint32_t) dmabuf->size;
 
@@ -291,7 +308,7 @@ static int iva_mem_ion_free(struct iva_proc *proc, struct iva_mem_map *iva_map_n
 	}
 
 	/* still iova mapped */
-	ref_cnt = iva_mem_map_read_refcnt(iva_map_node);
+	ref_cnt = iva_mem_map_read_user_refcnt(iva_map_node);
 	if (ref_cnt) {
 		iva_map_node->flags |= IVA_FREE_REQUESTED;
 		dev_dbg(dev,
@@ -300,6 +317,9 @@ static int iva_mem_ion_free(struct iva_proc *proc, struct iva_mem_map *iva_map_n
 		return 0;
 	}
 
+	if (MAP_CACHED(iva_map_node->flags))
+		iva_mem_drop_idle_map(proc, iva_map_node);
+
 	dma_buf_put(iva_map_node->dmabuf);	/* ion_share_dma_buf */
 
 	/* close() should be done in user space */
@@ -340,6 +360,11 @@ static int iva_mem_get_ion_iova(struct iva_proc *proc,
 			iva_map_node->req_size,
 			iva_map_node->act_size,
 			map_ref_cnt);
+		if (!list_empty(&iva_map_node->idle_node)) {
+			/* back in use */
+			list_del_init(&iva_map_node->idle_node);
+			proc->mem_map_idle_nr--;
+		}
 		iva_mem_map_get_refcnt(iva_map_node);
 		return 0;
 	}
@@ -399,6 +424,10 @@ static int iva_mem_get_ion_iova(struct iva_proc *proc,
 	iva_map_node->sg_table		= sg_table;
 	kref_init(&iva_map_node->map_ref);
 
+	/* keep the iova after the last put for the next request */
+	iva_mem_map_get_refcnt(iva_map_node);
+	iva_map_node->flags |= IVA_MAP_CACHED;
+
 	dev_dbg(dev,
 		"%s() buf_fd(%d, %ld) attachment(%p) iova(0x%lx), size(0x%x, 0x%x), ref_cnt(%d)\n",
 		__func__, iva_map_node->shared_fd,
@@ -432,6 +461,11 @@ static int iva_mem_put_ion_iova(struct iva_proc *proc,
 
 	if (forced_put) {
 		/* forced to unmap iova */
+		if (!list_empty(&iva_map_node->idle_node)) {
+			list_del_init(&iva_map_node->idle_node);
+			proc->mem_map_idle_nr--;
+		}
+		iva_map_node->flags &= ~IVA_MAP_CACHED;
 		__iva_mem_map_destroy(&iva_map_node->map_ref);
 		atomic_set(&iva_map_node->map_ref.refcount, 0);
 		return 0;
@@ -448,8 +482,26 @@ static int iva_mem_put_ion_iova(struct iva_proc *proc,
 		return 0;
 	}
 
+	if (MAP_CACHED(iva_map_node->flags) &&
+			iva_mem_map_read_refcnt(iva_map_node) == 1) {
+		/* last user put: park it, still mapped */
+		list_add_tail(&iva_map_node->idle_node, &proc->mem_map_idle);
+		proc->mem_map_idle_nr++;
+		return 0;
+	}
+
 	/* return ref count */
-	return iva_mem_map_read_refcnt(iva_map_node);
+	return iva_mem_map_read_user_refcnt(iva_map_node);
+}
+
+/*
+ * The cache type is only known for the buffers allocated here, the ion
+ * sync helpers check the imported ones themselves.
+ */
+static inline bool iva_mem_map_is_uncached(struct iva_mem_map *iva_map_node)
+{
+	return ALLOC_INSIDE(iva_map_node->flags) &&
+		!(GET_IVA_CACHE_TYPE(iva_map_node->flags) & ION_FLAG_CACHED);
 }
 
 static int iva_mem_ion_sync_for_cpu(struct iva_proc *proc,
@@ -466,6 +518,8 @@ static int iva_mem_ion_sync_for_cpu(struct iva_proc *proc,
 			       __func__, iva_map_node->shared_fd);
 			return -EINVAL;
 		}
+		if (iva_mem_map_is_uncached(iva_map_node))
+			return 0;
 	#ifdef CONFIG_ION_EXYNOS
 		exynos_ion_sync_dmabuf_for_cpu(dev, dmabuf,
 				iva_map_node->act_size,	DMA_BIDIRECTIONAL);
@@ -498,6 +552,8 @@ static int iva_mem_ion_sync_for_device(struct iva_proc *proc,
 				__func__, iva_map_node->shared_fd);
 			return -EINVAL;
 		}
+		if (iva_mem_map_is_uncached(iva_map_node))
+			return 0;
 	#ifdef CONFIG_ION_EXYNOS
 		if (clean_only)
 			exynos_ion_sync_dmabuf_for_device(dev, dmabuf,
@@ -562,6 +618,7 @@ static struct iva_mem_map *iva_mem_import_ion_buf(struct iva_proc *proc,
 	iva_map_node->attachment	= NULL;
 	iva_map_node->sg_table		= NULL;
 	iva_map_node->io_va		= 0x0;
+	INIT_LIST_HEAD(&iva_map_node->idle_node);
 	iva_map_node->req_size		= 0;	/* not alloced inside */
 	iva_map_node->act_size		= (uint32_t) dmabuf->size;
 
@@ -612,6 +669,49 @@ static void iva_mem_cancel_imported_ion_buf(struct iva_proc *proc,
 	iva_mem_free_map_node(iva, iva_map_node);
 }
 
+/* unmap a cached iova which has no user any more */
+static void iva_mem_drop_idle_map(struct iva_proc *proc,
+		struct iva_mem_map *iva_map_node)
+{
+	list_del_init(&iva_map_node->idle_node);
+	proc->mem_map_idle_nr--;
+	iva_map_node->flags &= ~IVA_MAP_CACHED;
+	iva_mem_map_put_refcnt(iva_map_node);
+}
+
+static void iva_mem_evict_idle_map(struct iva_proc *proc,
+		struct iva_mem_map *iva_map_node)
+{
+	iva_mem_drop_idle_map(proc, iva_map_node);
+
+	if (ALLOC_OUTSIDE(iva_map_node->flags))
+		iva_mem_cancel_imported_ion_buf(proc, iva_map_node);
+	else if (FREE_REQUESTED(iva_map_node->flags))
+		iva_mem_ion_free(proc, iva_map_node);
+}
+
+/*
+ * An imported buffer whose only file reference left is ours has been
+ * released by everybody else: nobody can hand its fd to us again.
+ */
+static inline bool iva_mem_idle_map_is_stale(struct iva_mem_map *iva_map_node)
+{
+	return ALLOC_OUTSIDE(iva_map_node->flags) &&
+			file_count(iva_map_node->dmabuf->file) == 1;
+}
+
+static void iva_mem_trim_idle_maps(struct iva_proc *proc)
+{
+	struct iva_mem_map	*iva_map_node, *tmp;
+
+	list_for_each_entry_safe(iva_map_node, tmp, &proc->mem_map_idle,
+			idle_node) {
+		if (proc->mem_map_idle_nr > IVA_MEM_IDLE_MAP_MAX ||
+				iva_mem_idle_map_is_stale(iva_map_node))
+			iva_mem_evict_idle_map(proc, iva_map_node);
+	}
+}
+
 static int iva_mem_ion_alloc_param(struct iva_proc *proc,
 			struct iva_ion_param *ion_param)
 {
@@ -723,11 +823,25 @@ static int iva_mem_get_ion_iova_param(struct iva_proc *proc,
 {
 	int	ret;
 	struct iva_mem_map	*iva_map_node;
+	struct dma_buf		*dmabuf;
 	bool			new_map = false;	/* from outside */
 
 	mutex_lock(&proc->mem_map_lock);
 	iva_map_node = iva_mem_find_proc_map_with_fd_nolock(proc, ion_param->shared_fd);
+	if (iva_map_node && !list_empty(&iva_map_node->idle_node) &&
+			ALLOC_OUTSIDE(iva_map_node->flags)) {
+		/* the fd may have been closed and reused since the last put */
+		dmabuf = dma_buf_get(IVA_MEM_GET_SHARED_FD(ion_param->shared_fd));
+		if (IS_ERR_OR_NULL(dmabuf) || dmabuf != iva_map_node->dmabuf) {
+			iva_mem_evict_idle_map(proc, iva_map_node);
+			iva_map_node = NULL;
+		}
+		if (!IS_ERR_OR_NULL(dmabuf))
+			dma_buf_put(dmabuf);
+	}
+
 	if (!iva_map_node) {	/* buf fd from outside */
+		iva_mem_trim_idle_maps(proc);
 		iva_map_node = iva_mem_import_ion_buf(proc, ion_param->shared_fd);
 		if (!iva_map_node) {
 			mutex_unlock(&proc->mem_map_lock);
@@ -770,7 +884,12 @@ static int iva_mem_put_ion_iova_param(struct iva_proc *proc,
 	}
 
 	ret = iva_mem_put_ion_iova(proc, iva_map_node, false);
-	if (!ret) {	/* success to iova unmap */
+	if (!ret && MAP_CACHED(iva_map_node->flags)) {
+		/* no user left but kept mapped */
+		if (FREE_REQUESTED(iva_map_node->flags))
+			iva_mem_evict_idle_map(proc, iva_map_node);
+		iva_mem_trim_idle_maps(proc);
+	} else if (!ret) {	/* success to iova unmap */
 		if (ALLOC_OUTSIDE(iva_map_node->flags))	{
 			/* if exported fd */
 			iva_mem_cancel_imported_ion_buf(proc, iva_map_node);
@@ -918,6 +1037,8 @@ void iva_mem_init_proc_mem(struct iva_proc *proc)
 	proc->mem_map_nr = 0;
 	mutex_init(&proc->mem_map_lock);
 	hash_init(proc->h_mem_map);
+	INIT_LIST_HEAD(&proc->mem_map_idle);
+	proc->mem_map_idle_nr = 0;
 }
 
 void iva_mem_deinit_proc_mem(struct iva_proc *proc)
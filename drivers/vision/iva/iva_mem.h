@@ -33,6 +33,11 @@
 #define IVA_FREE_REQUESTED		(IVA_FREE_REQ_MASK << IVA_FREE_REQ_SHIFT)
 #define FREE_REQUESTED(flag)		(flag & IVA_FREE_REQUESTED)
 
+#define IVA_MAP_CACHED_MASK		(0x1)
+#define IVA_MAP_CACHED_SHIFT		(5)	/* iova kept while unused */
+#define IVA_MAP_CACHED			(IVA_MAP_CACHED_MASK << IVA_MAP_CACHED_SHIFT)
+#define MAP_CACHED(flag)		(flag & IVA_MAP_CACHED)
+
 #define IVA_ALLOC_TYPE_MASK		(0x3)
 #define IVA_ALLOC_TYPE_SHIFT		(0)
 #define IVA_ALLOC_TYPE_IMPORTED		(0x2)	/* from outside */
@@ -55,6 +60,7 @@ struct iva_mem_map {
 	/* TO DO: ref */
 	struct list_head	node;		/* global */
 	struct hlist_node	h_node;		/* per process */
+	struct list_head	idle_node;	/* per process, unused maps */
 	int			flags;
 	struct kref		map_ref;	/* iova mapping */
 	struct device		*dev;
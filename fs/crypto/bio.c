@@ -25,15 +25,31 @@
 #include <linux/namei.h>
 #include "fscrypt_private.h"
 
+/*
+ * The pages of a bio normally share one inode and so one tfm: a single
+ * request is set up for them and only the tweak changes per page.
+ */
 static void __fscrypt_decrypt_bio(struct bio *bio, bool done)
 {
+	struct skcipher_request *req = NULL;
+	struct crypto_skcipher *tfm = NULL;
 	struct bio_vec *bv;
 	int i;
 
 	bio_for_each_segment_all(bv, bio, i) {
 		struct page *page = bv->bv_page;
-		int ret = fscrypt_decrypt_page(page->mapping->host, page,
-				PAGE_SIZE, 0, page->index);
+		const struct inode *inode = page->mapping->host;
+		int ret = -ENOMEM;
+
+		if (!req || tfm != inode->i_crypt_info->ci_ctfm) {
+			skcipher_request_free(req);
+			tfm = inode->i_crypt_info->ci_ctfm;
+			req = skcipher_request_alloc(tfm, GFP_NOFS);
+		}
+		if (req)
+			ret = fscrypt_do_page_crypto_req(req, inode, FS_DECRYPT,
+							 page->index, page, page,
+							 PAGE_SIZE, 0);
 
 		if (ret) {
 			WARN_ON_ONCE(1);
@@ -44,6 +60,8 @@ static void __fscrypt_decrypt_bio(struct bio *bio, bool done)
 		if (done)
 			unlock_page(page);
 	}
+
+	skcipher_request_free(req);
 }
 
 void fscrypt_decrypt_bio(struct bio *bio)
@@ -97,6 +115,7 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 {
 	struct fscrypt_ctx *ctx;
 	struct page *ciphertext_page = NULL;
+	struct skcipher_request *req;
 	struct bio *bio;
 	int ret, err = 0;
 
@@ -106,6 +125,12 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 	if (IS_ERR(ctx))
 		return PTR_ERR(ctx);
 
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_ctfm, GFP_NOFS);
+	if (!req) {
+		fscrypt_release_ctx(ctx);
+		return -ENOMEM;
+	}
+
 	ciphertext_page = fscrypt_alloc_bounce_page(ctx, GFP_NOWAIT);
 	if (IS_ERR(ciphertext_page)) {
 		err = PTR_ERR(ciphertext_page);
@@ -113,9 +138,9 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 	}
 
 	while (len--) {
-		err = fscrypt_do_page_crypto(inode, FS_ENCRYPT, lblk,
-					     ZERO_PAGE(0), ciphertext_page,
-					     PAGE_SIZE, 0, GFP_NOFS);
+		err = fscrypt_do_page_crypto_req(req, inode, FS_ENCRYPT, lblk,
+						 ZERO_PAGE(0), ciphertext_page,
+						 PAGE_SIZE, 0);
 		if (err)
 			goto errout;
 
@@ -148,6 +173,7 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 	}
 	err = 0;
 errout:
+	skcipher_request_free(req);
 	fscrypt_release_ctx(ctx);
 	return err;
 }
@@ -146,27 +146,26 @@ void fscrypt_generate_iv(union fscrypt_iv *iv, u64 lblk_num,
 		crypto_cipher_encrypt_one(ci->ci_essiv_tfm, iv->raw, iv->raw);
 }
 
-int fscrypt_do_page_crypto(const struct inode *inode, fscrypt_direction_t rw,
-			   u64 lblk_num, struct page *src_page,
-			   struct page *dest_page, unsigned int len,
-			   unsigned int offs, gfp_t gfp_flags)
+/*
+ * Like fscrypt_do_page_crypto(), with a request the caller allocated for
+ * the inode's ci_ctfm, so that it can be reused across pages.
+ */
+int fscrypt_do_page_crypto_req(struct skcipher_request *req,
+			       const struct inode *inode,
+			       fscrypt_direction_t rw, u64 lblk_num,
+			       struct page *src_page, struct page *dest_page,
+			       unsigned int len, unsigned int offs)
 {
 	union fscrypt_iv iv;
-	struct skcipher_request *req = NULL;
 	DECLARE_CRYPTO_WAIT(wait);
 	struct scatterlist dst, src;
 	struct fscrypt_info *ci = inode->i_crypt_info;
-	struct crypto_skcipher *tfm = ci->ci_ctfm;
 	int res = 0;
 
 	BUG_ON(len == 0);
 
 	fscrypt_generate_iv(&iv, lblk_num, ci);
 
-	req = skcipher_request_alloc(tfm, gfp_flags);
-	if (!req)
-		return -ENOMEM;
-
 	skcipher_request_set_callback(
 		req, CRYPTO_TFM_REQ_MAY_BACKLOG | CRYPTO_TFM_REQ_MAY_SLEEP,
 		crypto_req_done, &wait);
@@ -180,7 +179,6 @@ int fscrypt_do_page_crypto(const struct inode *inode, fscrypt_direction_t rw,
 		res = crypto_wait_req(crypto_skcipher_decrypt(req), &wait);
 	else
 		res = crypto_wait_req(crypto_skcipher_encrypt(req), &wait);
-	skcipher_request_free(req);
 	if (res) {
 		fscrypt_err(inode->i_sb,
 			    "%scryption failed for inode %lu, block %llu: %d",
@@ -191,6 +189,24 @@ int fscrypt_do_page_crypto(const struct inode *inode, fscrypt_direction_t rw,
 	return 0;
 }
 
+int fscrypt_do_page_crypto(const struct inode *inode, fscrypt_direction_t rw,
+			   u64 lblk_num, struct page *src_page,
+			   struct page *dest_page, unsigned int len,
+			   unsigned int offs, gfp_t gfp_flags)
+{
+	struct skcipher_request *req;
+	int res;
+
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_ctfm, gfp_flags);
+	if (!req)
+		return -ENOMEM;
+
+	res = fscrypt_do_page_crypto_req(req, inode, rw, lblk_num, src_page,
+					 dest_page, len, offs);
+	skcipher_request_free(req);
+	return res;
+}
+
 struct page *fscrypt_alloc_bounce_page(struct fscrypt_ctx *ctx,
 				       gfp_t gfp_flags)
 {
@@ -497,6 +513,7 @@ static void __exit fscrypt_exit(void)
 	kmem_cache_destroy(fscrypt_info_cachep);
 
 	fscrypt_essiv_cleanup();
+	fscrypt_derived_key_cleanup();
 }
 module_exit(fscrypt_exit);
 
@@ -15,6 +15,44 @@
 #include <crypto/skcipher.h>
 #include "fscrypt_private.h"
 
+/*
+ * Synchronous transforms take an on-stack request and complete inline,
+ * which saves an allocation and a completion per name on readdir.
+ */
+static int fname_crypt(struct crypto_skcipher *tfm, struct scatterlist *src,
+		       struct scatterlist *dst, unsigned int len,
+		       union fscrypt_iv *iv, bool encrypt)
+{
+	struct skcipher_request *req;
+	DECLARE_CRYPTO_WAIT(wait);
+	int res;
+
+	if (!(crypto_skcipher_alg(tfm)->base.cra_flags & CRYPTO_ALG_ASYNC)) {
+		SKCIPHER_REQUEST_ON_STACK(sreq, tfm);
+
+		skcipher_request_set_tfm(sreq, tfm);
+		skcipher_request_set_callback(sreq, CRYPTO_TFM_REQ_MAY_SLEEP,
+					      NULL, NULL);
+		skcipher_request_set_crypt(sreq, src, dst, len, iv);
+		res = encrypt ? crypto_skcipher_encrypt(sreq) :
+				crypto_skcipher_decrypt(sreq);
+		skcipher_request_zero(sreq);
+		return res;
+	}
+
+	req = skcipher_request_alloc(tfm, GFP_NOFS);
+	if (!req)
+		return -ENOMEM;
+	skcipher_request_set_callback(req,
+			CRYPTO_TFM_REQ_MAY_BACKLOG | CRYPTO_TFM_REQ_MAY_SLEEP,
+			crypto_req_done, &wait);
+	skcipher_request_set_crypt(req, src, dst, len, iv);
+	res = crypto_wait_req(encrypt ? crypto_skcipher_encrypt(req) :
+				crypto_skcipher_decrypt(req), &wait);
+	skcipher_request_free(req);
+	return res;
+}
+
 static inline bool fscrypt_is_dot_dotdot(const struct qstr *str)
 {
 	if (str->len == 1 && str->name[0] == '.')
@@ -37,8 +75,6 @@ static inline bool fscrypt_is_dot_dotdot(const struct qstr *str)
 int fname_encrypt(struct inode *inode, const struct qstr *iname,
 		  u8 *out, unsigned int olen)
 {
-	struct skcipher_request *req = NULL;
-	DECLARE_CRYPTO_WAIT(wait);
 	struct fscrypt_info *ci = inode->i_crypt_info;
 	struct crypto_skcipher *tfm = ci->ci_ctfm;
 	union fscrypt_iv iv;
@@ -57,19 +93,9 @@ int fname_encrypt(struct inode *inode, const struct qstr *iname,
 	/* Initialize the IV */
 	fscrypt_generate_iv(&iv, 0, ci);
 
-	/* Set up the encryption request */
-	req = skcipher_request_alloc(tfm, GFP_NOFS);
-	if (!req)
-		return -ENOMEM;
-	skcipher_request_set_callback(req,
-			CRYPTO_TFM_REQ_MAY_BACKLOG | CRYPTO_TFM_REQ_MAY_SLEEP,
-			crypto_req_done, &wait);
-	sg_init_one(&sg, out, olen);
-	skcipher_request_set_crypt(req, &sg, &sg, olen, &iv);
-
 	/* Do the encryption */
-	res = crypto_wait_req(crypto_skcipher_encrypt(req), &wait);
-	skcipher_request_free(req);
+	sg_init_one(&sg, out, olen);
+	res = fname_crypt(tfm, &sg, &sg, olen, &iv, true);
 	if (res < 0) {
 		fscrypt_err(inode->i_sb,
 			    "Filename encryption failed for inode %lu: %d",
@@ -91,31 +117,18 @@ static int fname_decrypt(struct inode *inode,
 				const struct fscrypt_str *iname,
 				struct fscrypt_str *oname)
 {
-	struct skcipher_request *req = NULL;
-	DECLARE_CRYPTO_WAIT(wait);
 	struct scatterlist src_sg, dst_sg;
 	struct fscrypt_info *ci = inode->i_crypt_info;
 	struct crypto_skcipher *tfm = ci->ci_ctfm;
 	union fscrypt_iv iv;
 	int res;
 
-	/* Allocate request */
-	req = skcipher_request_alloc(tfm, GFP_NOFS);
-	if (!req)
-		return -ENOMEM;
-	skcipher_request_set_callback(req,
-		CRYPTO_TFM_REQ_MAY_BACKLOG | CRYPTO_TFM_REQ_MAY_SLEEP,
-		crypto_req_done, &wait);
-
 	/* Initialize IV */
 	fscrypt_generate_iv(&iv, 0, ci);
 
-	/* Create decryption request */
 	sg_init_one(&src_sg, iname->name, iname->len);
 	sg_init_one(&dst_sg, oname->name, oname->len);
-	skcipher_request_set_crypt(req, &src_sg, &dst_sg, iname->len, &iv);
-	res = crypto_wait_req(crypto_skcipher_decrypt(req), &wait);
-	skcipher_request_free(req);
+	res = fname_crypt(tfm, &src_sg, &dst_sg, iname->len, &iv, false);
 	if (res < 0) {
 		fscrypt_err(inode->i_sb,
 			    "Filename decryption failed for inode %lu: %d",
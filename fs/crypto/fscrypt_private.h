@@ -117,6 +117,12 @@ static inline bool fscrypt_valid_enc_modes(u32 contents_mode,
 /* crypto.c */
 extern struct kmem_cache *fscrypt_info_cachep;
 extern int fscrypt_initialize(unsigned int cop_flags);
+extern int fscrypt_do_page_crypto_req(struct skcipher_request *req,
+				      const struct inode *inode,
+				      fscrypt_direction_t rw, u64 lblk_num,
+				      struct page *src_page,
+				      struct page *dest_page,
+				      unsigned int len, unsigned int offs);
 extern int fscrypt_do_page_crypto(const struct inode *inode,
 				  fscrypt_direction_t rw, u64 lblk_num,
 				  struct page *src_page,
@@ -170,5 +176,6 @@ struct fscrypt_mode {
 };
 
 extern void __exit fscrypt_essiv_cleanup(void);
+extern void __exit fscrypt_derived_key_cleanup(void);
 
 #endif /* _FSCRYPT_PRIVATE_H */
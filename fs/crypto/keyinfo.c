@@ -10,6 +10,7 @@
 
 #include <keys/user-type.h>
 #include <linux/hashtable.h>
+#include <linux/jhash.h>
 #include <linux/scatterlist.h>
 #include <linux/ratelimit.h>
 #include <crypto/aes.h>
@@ -24,6 +25,31 @@ static struct crypto_shash *essiv_hash_tfm;
 static DEFINE_HASHTABLE(fscrypt_master_keys, 6); /* 6 bits = 64 buckets */
 static DEFINE_SPINLOCK(fscrypt_master_keys_lock);
 
+/*
+ * Recently derived per-file keys, so that reloading an evicted inode does
+ * not have to allocate an "ecb(aes)" transform just to derive its key
+ * again. An entry is only used if the master key currently found in the
+ * keyring is byte for byte the one it was derived from, so this never
+ * makes a key available that the keyring lookup would not. Entries of a
+ * master key are wiped as soon as that key is found missing.
+ */
+#define FSCRYPT_DK_CACHE_MAX	128
+
+struct fscrypt_derived_key {
+	struct hlist_node dk_node;
+	struct list_head dk_lru;
+	u8 dk_descriptor[FS_KEY_DESCRIPTOR_SIZE];
+	u8 dk_nonce[FS_KEY_DERIVATION_NONCE_SIZE];
+	unsigned int dk_keysize;
+	u8 dk_master[FS_MAX_KEY_SIZE];
+	u8 dk_derived[FS_MAX_KEY_SIZE];
+};
+
+static DEFINE_HASHTABLE(fscrypt_derived_keys, 6);
+static LIST_HEAD(fscrypt_derived_keys_lru);
+static unsigned int fscrypt_derived_keys_count;
+static DEFINE_SPINLOCK(fscrypt_derived_keys_lock);
+
 /*
  * Key derivation function.  This generates the derived key by encrypting the
  * master key with AES-128-ECB using the inode's nonce as the AES key.
@@ -70,6 +96,98 @@ static int derive_key_aes(const u8 *master_key,
 	return res;
 }
 
+static inline u32 derived_key_hash(const struct fscrypt_context *ctx)
+{
+	return jhash(ctx->nonce, sizeof(ctx->nonce), 0);
+}
+
+static bool find_derived_key(const struct fscrypt_context *ctx,
+			     const u8 *master_key, u8 *derived_key,
+			     unsigned int derived_keysize)
+{
+	struct fscrypt_derived_key *dk;
+	bool found = false;
+
+	spin_lock(&fscrypt_derived_keys_lock);
+	hash_for_each_possible(fscrypt_derived_keys, dk, dk_node,
+			       derived_key_hash(ctx)) {
+		if (dk->dk_keysize != derived_keysize ||
+		    memcmp(dk->dk_nonce, ctx->nonce, sizeof(ctx->nonce)) ||
+		    memcmp(dk->dk_descriptor, ctx->master_key_descriptor,
+			   FS_KEY_DESCRIPTOR_SIZE))
+			continue;
+		if (crypto_memneq(dk->dk_master, master_key, derived_keysize))
+			continue;
+		memcpy(derived_key, dk->dk_derived, derived_keysize);
+		list_move(&dk->dk_lru, &fscrypt_derived_keys_lru);
+		found = true;
+		break;
+	}
+	spin_unlock(&fscrypt_derived_keys_lock);
+	return found;
+}
+
+static void add_derived_key(const struct fscrypt_context *ctx,
+			    const u8 *master_key, const u8 *derived_key,
+			    unsigned int derived_keysize)
+{
+	struct fscrypt_derived_key *dk, *victim = NULL;
+
+	dk = kzalloc(sizeof(*dk), GFP_NOFS | __GFP_NOWARN);
+	if (!dk)
+		return;
+	memcpy(dk->dk_descriptor, ctx->master_key_descriptor,
+	       FS_KEY_DESCRIPTOR_SIZE);
+	memcpy(dk->dk_nonce, ctx->nonce, sizeof(ctx->nonce));
+	dk->dk_keysize = derived_keysize;
+	memcpy(dk->dk_master, master_key, derived_keysize);
+	memcpy(dk->dk_derived, derived_key, derived_keysize);
+
+	spin_lock(&fscrypt_derived_keys_lock);
+	if (fscrypt_derived_keys_count >= FSCRYPT_DK_CACHE_MAX) {
+		victim = list_last_entry(&fscrypt_derived_keys_lru,
+					 struct fscrypt_derived_key, dk_lru);
+		hash_del(&victim->dk_node);
+		list_del(&victim->dk_lru);
+		fscrypt_derived_keys_count--;
+	}
+	hash_add(fscrypt_derived_keys, &dk->dk_node, derived_key_hash(ctx));
+	list_add(&dk->dk_lru, &fscrypt_derived_keys_lru);
+	fscrypt_derived_keys_count++;
+	spin_unlock(&fscrypt_derived_keys_lock);
+
+	kzfree(victim);
+}
+
+/* The master key with this descriptor is gone, forget what came from it */
+static void evict_derived_keys(const u8 *descriptor)
+{
+	struct fscrypt_derived_key *dk, *tmp;
+	LIST_HEAD(free_list);
+
+	spin_lock(&fscrypt_derived_keys_lock);
+	list_for_each_entry_safe(dk, tmp, &fscrypt_derived_keys_lru, dk_lru) {
+		if (memcmp(dk->dk_descriptor, descriptor,
+			   FS_KEY_DESCRIPTOR_SIZE))
+			continue;
+		hash_del(&dk->dk_node);
+		list_move(&dk->dk_lru, &free_list);
+		fscrypt_derived_keys_count--;
+	}
+	spin_unlock(&fscrypt_derived_keys_lock);
+
+	list_for_each_entry_safe(dk, tmp, &free_list, dk_lru)
+		kzfree(dk);
+}
+
+void __exit fscrypt_derived_key_cleanup(void)
+{
+	struct fscrypt_derived_key *dk, *tmp;
+
+	list_for_each_entry_safe(dk, tmp, &fscrypt_derived_keys_lru, dk_lru)
+		kzfree(dk);
+}
+
 /*
  * Search the current task's subscribed keyrings for a "logon" key with
  * description prefix:descriptor, and if found acquire a read lock on it and
@@ -201,8 +319,11 @@ static int find_and_derive_key(const struct inode *inode,
 						ctx->master_key_descriptor,
 						mode->keysize, &payload);
 	}
-	if (IS_ERR(key))
+	if (IS_ERR(key)) {
+		if (key == ERR_PTR(-ENOKEY))
+			evict_derived_keys(ctx->master_key_descriptor);
 		return PTR_ERR(key);
+	}
 
 	if (ctx->flags & FS_POLICY_FLAG_DIRECT_KEY) {
 		if (mode->ivsize < offsetofend(union fscrypt_iv, nonce)) {
@@ -219,9 +340,15 @@ static int find_and_derive_key(const struct inode *inode,
 			memcpy(derived_key, payload->raw, mode->keysize);
 			err = 0;
 		}
+	} else if (find_derived_key(ctx, payload->raw, derived_key,
+				    mode->keysize)) {
+		err = 0;
 	} else {
 		err = derive_key_aes(payload->raw, ctx, derived_key,
 				     mode->keysize);
+		if (!err)
+			add_derived_key(ctx, payload->raw, derived_key,
+					mode->keysize);
 	}
 	up_read(&key->sem);
 	key_put(key);
@@ -236,7 +363,17 @@ allocate_skcipher_for_mode(struct fscrypt_mode *mode, const u8 *raw_key,
 	struct crypto_skcipher *tfm;
 	int err;
 
-	tfm = crypto_alloc_skcipher(mode->cipher_str, 0, 0);
+	/*
+	 * Filenames are short and en/decrypted one at a time from process
+	 * context, so prefer a synchronous implementation: fname.c can then
+	 * use an on-stack request without waiting for a completion.
+	 */
+	tfm = ERR_PTR(-ENOENT);
+	if (S_ISDIR(inode->i_mode) || S_ISLNK(inode->i_mode))
+		tfm = crypto_alloc_skcipher(mode->cipher_str, 0,
+					    CRYPTO_ALG_ASYNC);
+	if (IS_ERR(tfm))
+		tfm = crypto_alloc_skcipher(mode->cipher_str, 0, 0);
 	if (IS_ERR(tfm)) {
 		fscrypt_warn(inode->i_sb,
 			     "error allocating '%s' transform for inode %lu: %ld",
@@ -178,6 +178,26 @@ struct epitem {
 	struct epoll_event event;
 };
 
+/*
+ * Ready list shard of an EPOLL_SHARDED eventpoll.  Such a set has one shard
+ * per possible CPU and an item always stays on the shard picked by its fd,
+ * whose lock protects the ->rdllink and ->next of the item in place of
+ * "ep->lock".  Files becoming ready together then mostly queue themselves
+ * on different locks.
+ */
+struct ep_shard {
+	spinlock_t lock;
+
+	/* List of ready file descriptors of this shard */
+	struct list_head rdllist;
+
+	/* Same as "struct eventpoll"->ovflist, for the items of this shard */
+	struct epitem *ovflist;
+
+	/* Items handed back by ep_scan_ready_list(), protected by "mtx" */
+	struct list_head txlist;
+} ____cacheline_aligned_in_smp;
+
 /*
  * This structure is stored inside the "private_data" member of the file
  * structure and represents the main data structure for the eventpoll
@@ -217,6 +237,10 @@ struct eventpoll {
 	/* wakeup_source used when ep_scan_ready_list is running */
 	struct wakeup_source *ws;
 
+	/* Ready list shards of an EPOLL_SHARDED set, NULL otherwise */
+	struct ep_shard *shards;
+	int nr_shards;
+
 	/* The user that created the eventpoll descriptor */
 	struct user_struct *user;
 
@@ -382,9 +406,26 @@ static void ep_nested_calls_init(struct nested_calls *ncalls)
  */
 static inline int ep_events_available(struct eventpoll *ep)
 {
+	int i;
+
+	if (ep->shards) {
+		for (i = 0; i < ep->nr_shards; i++) {
+			if (!list_empty(&ep->shards[i].rdllist) ||
+			    READ_ONCE(ep->shards[i].ovflist) != EP_UNACTIVE_PTR)
+				return 1;
+		}
+		return 0;
+	}
+
 	return !list_empty(&ep->rdllist) || ep->ovflist != EP_UNACTIVE_PTR;
 }
 
+static inline struct ep_shard *ep_item_shard(struct eventpoll *ep,
+					     struct epitem *epi)
+{
+	return &ep->shards[epi->ffd.fd % ep->nr_shards];
+}
+
 /**
  * ep_call_nested - Perform a bound (possibly) nested call, by checking
  *                  that the recursion limit is not exceeded, and that
@@ -587,6 +628,117 @@ static inline void ep_pm_stay_awake_rcu(struct epitem *epi)
 	rcu_read_unlock();
 }
 
+/*
+ * Steal the ready lists of all the shards of @ep into @txlist and chain the
+ * items becoming ready from now on into the ->ovflist of their shard.
+ */
+static void ep_shards_steal(struct eventpoll *ep, struct list_head *txlist)
+{
+	struct ep_shard *shard;
+	unsigned long flags;
+	int i;
+
+	for (i = 0; i < ep->nr_shards; i++) {
+		shard = &ep->shards[i];
+		spin_lock_irqsave(&shard->lock, flags);
+		list_splice_tail_init(&shard->rdllist, txlist);
+		shard->ovflist = NULL;
+		spin_unlock_irqrestore(&shard->lock, flags);
+	}
+}
+
+/*
+ * Give the items left on @txlist, and the level triggered ones the "sproc"
+ * callback queued back on ep->rdllist, back to their shards together with
+ * the ones chained on the ->ovflist of the shards meanwhile.
+ *
+ * Returns true if any shard has ready items afterwards.
+ */
+static bool ep_shards_restore(struct eventpoll *ep, struct list_head *txlist)
+{
+	struct epitem *epi, *nepi;
+	struct ep_shard *shard;
+	unsigned long flags;
+	bool ready = false;
+	int i;
+
+	/*
+	 * The poll callback does not touch ->rdllink while the ->ovflist of
+	 * the shard is active, so the items can be sorted out without locks.
+	 */
+	list_splice_tail_init(&ep->rdllist, txlist);
+	list_for_each_entry_safe(epi, nepi, txlist, rdllink)
+		list_move_tail(&epi->rdllink, &ep_item_shard(ep, epi)->txlist);
+
+	for (i = 0; i < ep->nr_shards; i++) {
+		shard = &ep->shards[i];
+		spin_lock_irqsave(&shard->lock, flags);
+		for (nepi = shard->ovflist; (epi = nepi) != NULL;
+		     nepi = epi->next, epi->next = EP_UNACTIVE_PTR) {
+			if (!ep_is_linked(&epi->rdllink)) {
+				list_add_tail(&epi->rdllink, &shard->rdllist);
+				ep_pm_stay_awake(epi);
+			}
+		}
+		shard->ovflist = EP_UNACTIVE_PTR;
+		list_splice_init(&shard->txlist, &shard->rdllist);
+		if (!list_empty(&shard->rdllist))
+			ready = true;
+		spin_unlock_irqrestore(&shard->lock, flags);
+	}
+
+	return ready;
+}
+
+/*
+ * Wake up a task waiting in ep_poll() on a sharded @ep, after an item has
+ * been queued on a shard.  Returns true if there was one.
+ */
+static bool ep_shard_wake_up(struct eventpoll *ep)
+{
+	unsigned long flags;
+
+	/* Pairs with the barrier of set_current_state() in ep_poll() */
+	smp_mb();
+	if (!waitqueue_active(&ep->wq))
+		return false;
+
+	spin_lock_irqsave(&ep->lock, flags);
+	wake_up_locked(&ep->wq);
+	spin_unlock_irqrestore(&ep->lock, flags);
+
+	return true;
+}
+
+/*
+ * Queue @epi on the ready list of its shard and wake up a waiter, for
+ * ep_insert() and ep_modify() of a sharded @ep.  Must be called with "mtx"
+ * held, so the ->ovflist of the shard is not active.
+ *
+ * Returns true if ep->poll_wait needs a wake up.
+ */
+static bool ep_shard_queue(struct eventpoll *ep, struct epitem *epi)
+{
+	struct ep_shard *shard = ep_item_shard(ep, epi);
+	unsigned long flags;
+	bool queued = false;
+
+	spin_lock_irqsave(&shard->lock, flags);
+	if (!ep_is_linked(&epi->rdllink)) {
+		list_add_tail(&epi->rdllink, &shard->rdllist);
+		ep_pm_stay_awake(epi);
+		queued = true;
+	}
+	spin_unlock_irqrestore(&shard->lock, flags);
+
+	if (!queued)
+		return false;
+
+	ep_shard_wake_up(ep);
+
+	return waitqueue_active(&ep->poll_wait);
+}
+
 /**
  * ep_scan_ready_list - Scans the ready list in a way that makes possible for
  *                      the scan code, to call f_op->poll(). Also allows for
@@ -608,6 +760,7 @@ static int ep_scan_ready_list(struct eventpoll *ep,
 	int error, pwake = 0;
 	unsigned long flags;
 	struct epitem *epi, *nepi;
+	bool ready;
 	LIST_HEAD(txlist);
 
 	/*
@@ -626,16 +779,26 @@ static int ep_scan_ready_list(struct eventpoll *ep,
 	 * because we want the "sproc" callback to be able to do it
 	 * in a lockless way.
 	 */
-	spin_lock_irqsave(&ep->lock, flags);
-	list_splice_init(&ep->rdllist, &txlist);
-	ep->ovflist = NULL;
-	spin_unlock_irqrestore(&ep->lock, flags);
+	if (ep->shards) {
+		ep_shards_steal(ep, &txlist);
+	} else {
+		spin_lock_irqsave(&ep->lock, flags);
+		list_splice_init(&ep->rdllist, &txlist);
+		ep->ovflist = NULL;
+		spin_unlock_irqrestore(&ep->lock, flags);
+	}
 
 	/*
 	 * Now call the callback function.
 	 */
 	error = (*sproc)(ep, &txlist, priv);
 
+	if (ep->shards) {
+		ready = ep_shards_restore(ep, &txlist);
+		spin_lock_irqsave(&ep->lock, flags);
+		goto relax;
+	}
+
 	spin_lock_irqsave(&ep->lock, flags);
 	/*
 	 * During the time we spent inside the "sproc" callback, some
@@ -666,9 +829,11 @@ static int ep_scan_ready_list(struct eventpoll *ep,
 	 * Quickly re-inject items left on "txlist".
 	 */
 	list_splice(&txlist, &ep->rdllist);
+	ready = !list_empty(&ep->rdllist);
+relax:
 	__pm_relax(ep->ws);
 
-	if (!list_empty(&ep->rdllist)) {
+	if (ready) {
 		/*
 		 * Wake up (if active) both the eventpoll wait list and
 		 * the ->poll() wait list (delayed after we release the lock).
@@ -696,13 +861,25 @@ static void epi_rcu_free(struct rcu_head *head)
 	kmem_cache_free(epi_cache, epi);
 }
 
+/* Drops @epi from the ready list it is on, if any */
+static void ep_unlink_ready(struct eventpoll *ep, struct epitem *epi)
+{
+	spinlock_t *lock = ep->shards ? &ep_item_shard(ep, epi)->lock :
+					&ep->lock;
+	unsigned long flags;
+
+	spin_lock_irqsave(lock, flags);
+	if (ep_is_linked(&epi->rdllink))
+		list_del_init(&epi->rdllink);
+	spin_unlock_irqrestore(lock, flags);
+}
+
 /*
  * Removes a "struct epitem" from the eventpoll RB tree and deallocates
  * all the associated resources. Must be called with "mtx" held.
  */
 static int ep_remove(struct eventpoll *ep, struct epitem *epi)
 {
-	unsigned long flags;
 	struct file *file = epi->ffd.file;
 
 	/*
@@ -722,10 +899,7 @@ static int ep_remove(struct eventpoll *ep, struct epitem *epi)
 
 	rb_erase(&epi->rbn, &ep->rbr);
 
-	spin_lock_irqsave(&ep->lock, flags);
-	if (ep_is_linked(&epi->rdllink))
-		list_del_init(&epi->rdllink);
-	spin_unlock_irqrestore(&ep->lock, flags);
+	ep_unlink_ready(ep, epi);
 
 	wakeup_source_unregister(ep_wakeup_source(epi));
 	/*
@@ -791,6 +965,7 @@ static void ep_free(struct eventpoll *ep)
 	mutex_destroy(&ep->mtx);
 	free_uid(ep->user);
 	wakeup_source_unregister(ep->ws);
+	kfree(ep->shards);
 	kfree(ep);
 }
 
@@ -943,9 +1118,9 @@ void eventpoll_release_file(struct file *file)
 	mutex_unlock(&epmutex);
 }
 
-static int ep_alloc(struct eventpoll **pep)
+static int ep_alloc(struct eventpoll **pep, bool sharded)
 {
-	int error;
+	int error, i;
 	struct user_struct *user;
 	struct eventpoll *ep;
 
@@ -955,6 +1130,22 @@ static int ep_alloc(struct eventpoll **pep)
 	if (unlikely(!ep))
 		goto free_uid;
 
+	/* A single shard would only add a lock */
+	if (sharded && num_possible_cpus() > 1) {
+		ep->nr_shards = num_possible_cpus();
+		ep->shards = kcalloc(ep->nr_shards, sizeof(*ep->shards),
+				     GFP_KERNEL);
+		if (unlikely(!ep->shards))
+			goto free_ep;
+
+		for (i = 0; i < ep->nr_shards; i++) {
+			spin_lock_init(&ep->shards[i].lock);
+			INIT_LIST_HEAD(&ep->shards[i].rdllist);
+			ep->shards[i].ovflist = EP_UNACTIVE_PTR;
+			INIT_LIST_HEAD(&ep->shards[i].txlist);
+		}
+	}
+
 	spin_lock_init(&ep->lock);
 	mutex_init(&ep->mtx);
 	init_waitqueue_head(&ep->wq);
@@ -968,6 +1159,8 @@ static int ep_alloc(struct eventpoll **pep)
 
 	return 0;
 
+free_ep:
+	kfree(ep);
 free_uid:
 	free_uid(user);
 	return error;
@@ -1007,15 +1200,45 @@ static struct epitem *ep_find(struct eventpoll *ep, struct file *file, int fd)
  * mechanism. It is called by the stored file descriptors when they
  * have events to report.
  */
+static int ep_exclusive_wake(struct epitem *epi, void *key)
+{
+	if (!(epi->event.events & EPOLLEXCLUSIVE) ||
+	    ((unsigned long)key & POLLFREE))
+		return 0;
+
+	switch ((unsigned long)key & EPOLLINOUT_BITS) {
+	case POLLIN:
+		return !!(epi->event.events & POLLIN);
+	case POLLOUT:
+		return !!(epi->event.events & POLLOUT);
+	case 0:
+		return 1;
+	}
+
+	return 0;
+}
+
 static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *key)
 {
-	int pwake = 0;
+	int pwake = 0, swake = 0;
 	unsigned long flags;
 	struct epitem *epi = ep_item_from_wait(wait);
 	struct eventpoll *ep = epi->ep;
+	spinlock_t *lock = &ep->lock;
+	struct list_head *rdllist = &ep->rdllist;
+	struct epitem **ovflist = &ep->ovflist;
 	int ewake = 0;
 
-	spin_lock_irqsave(&ep->lock, flags);
+	/* A sharded set queues the item under the lock of its shard */
+	if (ep->shards) {
+		struct ep_shard *shard = ep_item_shard(ep, epi);
+
+		lock = &shard->lock;
+		rdllist = &shard->rdllist;
+		ovflist = &shard->ovflist;
+	}
+
+	spin_lock_irqsave(lock, flags);
 
 	/*
 	 * If the event mask does not contain any poll(2) event, we consider the
@@ -1041,10 +1264,10 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 	 * semantics). All the events that happen during that period of time are
 	 * chained in ep->ovflist and requeued later on.
 	 */
-	if (ep->ovflist != EP_UNACTIVE_PTR) {
+	if (*ovflist != EP_UNACTIVE_PTR) {
 		if (epi->next == EP_UNACTIVE_PTR) {
-			epi->next = ep->ovflist;
-			ep->ovflist = epi;
+			epi->next = *ovflist;
+			*ovflist = epi;
 			if (epi->ws) {
 				/*
 				 * Activate ep->ws since epi->ws may get
@@ -1059,38 +1282,29 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 
 	/* If this file is already in the ready list we exit soon */
 	if (!ep_is_linked(&epi->rdllink)) {
-		list_add_tail(&epi->rdllink, &ep->rdllist);
+		list_add_tail(&epi->rdllink, rdllist);
 		ep_pm_stay_awake_rcu(epi);
 	}
 
 	/*
 	 * Wake up ( if active ) both the eventpoll wait list and the ->poll()
-	 * wait list.
+	 * wait list.  The waiters of a sharded set are woken up once the
+	 * lock of the shard is dropped.
 	 */
-	if (waitqueue_active(&ep->wq)) {
-		if ((epi->event.events & EPOLLEXCLUSIVE) &&
-					!((unsigned long)key & POLLFREE)) {
-			switch ((unsigned long)key & EPOLLINOUT_BITS) {
-			case POLLIN:
-				if (epi->event.events & POLLIN)
-					ewake = 1;
-				break;
-			case POLLOUT:
-				if (epi->event.events & POLLOUT)
-					ewake = 1;
-				break;
-			case 0:
-				ewake = 1;
-				break;
-			}
-		}
+	if (ep->shards) {
+		swake = 1;
+	} else if (waitqueue_active(&ep->wq)) {
+		ewake = ep_exclusive_wake(epi, key);
 		wake_up_locked(&ep->wq);
 	}
 	if (waitqueue_active(&ep->poll_wait))
 		pwake++;
 
 out_unlock:
-	spin_unlock_irqrestore(&ep->lock, flags);
+	spin_unlock_irqrestore(lock, flags);
+
+	if (swake && ep_shard_wake_up(ep))
+		ewake = ep_exclusive_wake(epi, key);
 
 	/* We have to call this outside the lock */
 	if (pwake)
@@ -1372,6 +1586,12 @@ static int ep_insert(struct eventpoll *ep, struct epoll_event *event,
 		goto error_remove_epi;
 
 	/* We have to drop the new item inside our item list to keep track of it */
+	if (ep->shards) {
+		if (revents & event->events)
+			pwake = ep_shard_queue(ep, epi);
+		goto out;
+	}
+
 	spin_lock_irqsave(&ep->lock, flags);
 
 	/* If the file is already "ready" we drop it inside the ready list */
@@ -1388,6 +1608,7 @@ static int ep_insert(struct eventpoll *ep, struct epoll_event *event,
 
 	spin_unlock_irqrestore(&ep->lock, flags);
 
+out:
 	atomic_long_inc(&ep->user->epoll_watches);
 
 	/* We have to call this outside the lock */
@@ -1412,10 +1633,7 @@ static int ep_insert(struct eventpoll *ep, struct epoll_event *event,
 	 * list, since that is used/cleaned only inside a section bound by "mtx".
 	 * And ep_insert() is called with "mtx" held.
 	 */
-	spin_lock_irqsave(&ep->lock, flags);
-	if (ep_is_linked(&epi->rdllink))
-		list_del_init(&epi->rdllink);
-	spin_unlock_irqrestore(&ep->lock, flags);
+	ep_unlink_ready(ep, epi);
 
 	wakeup_source_unregister(ep_wakeup_source(epi));
 
@@ -1481,7 +1699,9 @@ static int ep_modify(struct eventpoll *ep, struct epitem *epi, struct epoll_even
 	 * If the item is "hot" and it is not registered inside the ready
 	 * list, push it inside.
 	 */
-	if (revents & event->events) {
+	if ((revents & event->events) && ep->shards) {
+		pwake = ep_shard_queue(ep, epi);
+	} else if (revents & event->events) {
 		spin_lock_irq(&ep->lock);
 		if (!ep_is_linked(&epi->rdllink)) {
 			list_add_tail(&epi->rdllink, &ep->rdllist);
@@ -1573,6 +1793,8 @@ static int ep_send_events_proc(struct eventpoll *ep, struct list_head *head,
 				 * callers are locked out by
 				 * ep_scan_ready_list() holding "mtx" and the
 				 * poll callback will queue them in ep->ovflist.
+				 * A sharded set hands them back to their
+				 * shards in ep_shards_restore().
 				 */
 				list_add_tail(&epi->rdllink, &ep->rdllist);
 				ep_pm_stay_awake(epi);
@@ -1657,7 +1879,15 @@ static int ep_poll(struct eventpoll *ep, struct epoll_event __user *events,
 		 * ep_poll_callback() when events will become available.
 		 */
 		init_waitqueue_entry(&wait, current);
-		__add_wait_queue_exclusive(&ep->wq, &wait);
+		/*
+		 * A sharded set wakes up its waiters in turn rather than
+		 * the last one that went to sleep, so that the events of
+		 * a burst spread over the threads of the event loop.
+		 */
+		if (ep->shards)
+			__add_wait_queue_tail_exclusive(&ep->wq, &wait);
+		else
+			__add_wait_queue_exclusive(&ep->wq, &wait);
 
 		for (;;) {
 			/*
@@ -1810,13 +2040,14 @@ SYSCALL_DEFINE1(epoll_create1, int, flags)
 
 	/* Check the EPOLL_* constant for consistency.  */
 	BUILD_BUG_ON(EPOLL_CLOEXEC != O_CLOEXEC);
+	BUILD_BUG_ON(EPOLL_SHARDED & EPOLL_CLOEXEC);
 
-	if (flags & ~EPOLL_CLOEXEC)
+	if (flags & ~(EPOLL_CLOEXEC | EPOLL_SHARDED))
 		return -EINVAL;
 	/*
 	 * Create the internal data structure ("struct eventpoll").
 	 */
-	error = ep_alloc(&ep);
+	error = ep_alloc(&ep, flags & EPOLL_SHARDED);
 	if (error < 0)
 		return error;
 	/*
@@ -1081,6 +1081,15 @@ struct ext4_inode_info {
 	tid_t i_sync_tid;
 	tid_t i_datasync_tid;
 
+	/*
+	 * Streaming write-behind, protected by i_mutex: end of the last
+	 * buffered write, start of the stream not yet flushed and start
+	 * of the flushed part not yet dropped.
+	 */
+	loff_t i_wb_next;
+	loff_t i_wb_start;
+	loff_t i_wb_dropped;
+
 #ifdef CONFIG_QUOTA
 	struct dquot *i_dquot[MAXQUOTAS];
 #endif
@@ -1488,6 +1497,11 @@ struct ext4_sb_info {
 	/* the size of zero-out chunk */
 	unsigned int s_extent_max_zeroout_kb;
 
+	/* streaming write-behind window, 0 disables it */
+	unsigned int s_write_behind_kb;
+	/* drop the page cache of streams once written back */
+	unsigned int s_drop_behind;
+
 	unsigned int s_log_groups_per_flex;
 	struct flex_groups * __rcu *s_flex_groups;
 	ext4_group_t s_flex_groups_allocated;
@@ -2513,6 +2527,7 @@ extern int ext4_truncate_restart_trans(handle_t *, struct inode *, int nblocks);
 extern void ext4_set_inode_flags(struct inode *);
 extern void ext4_get_inode_flags(struct ext4_inode_info *);
 extern int ext4_alloc_da_blocks(struct inode *inode);
+extern void ext4_write_behind(struct inode *inode, loff_t pos, ssize_t written);
 extern void ext4_set_aops(struct inode *inode);
 extern int ext4_writepage_trans_blocks(struct inode *);
 extern int ext4_chunk_trans_blocks(struct inode *, int nrblocks);
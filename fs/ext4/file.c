@@ -167,6 +167,8 @@ ext4_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
 	}
 
 	ret = __generic_file_write_iter(iocb, from);
+	if (!o_direct && ret > 0)
+		ext4_write_behind(inode, iocb->ki_pos - ret, ret);
 	/*
 	 * Unaligned direct AIO must be the only IO in flight. Otherwise
 	 * overlapping aligned IO after unaligned might result in data
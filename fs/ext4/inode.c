@@ -3187,6 +3187,53 @@ int ext4_alloc_da_blocks(struct inode *inode)
 	return filemap_flush(inode->i_mapping);
 }
 
+/*
+ * Streaming write-behind, called under i_mutex after a buffered write of
+ * @written bytes at @pos.
+ *
+ * Writers that keep appending where their last write ended, such as
+ * camera and video recorders, otherwise pile up dirty pages until global
+ * writeback or balance_dirty_pages() flushes them in one burst. Once a
+ * stream has s_write_behind_kb not yet flushed, start writeback of it
+ * (which allocates the delayed blocks), but do not wait for it. With
+ * s_drop_behind, also drop the window flushed the time before, which has
+ * most likely completed; pages still dirty or under writeback are kept.
+ */
+void ext4_write_behind(struct inode *inode, loff_t pos, ssize_t written)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	struct ext4_sb_info *sbi = EXT4_SB(inode->i_sb);
+	loff_t window = (loff_t)READ_ONCE(sbi->s_write_behind_kb) << 10;
+	loff_t start;
+
+	if (!window || written <= 0 || IS_DAX(inode))
+		return;
+
+	/* anything but an append to the last write starts a new stream */
+	if (pos != ei->i_wb_next) {
+		ei->i_wb_start = pos;
+		ei->i_wb_dropped = pos;
+	}
+	ei->i_wb_next = pos + written;
+
+	if (ei->i_wb_next - ei->i_wb_start < window)
+		return;
+
+	start = ei->i_wb_start;
+	__filemap_fdatawrite_range(inode->i_mapping, start,
+				   ei->i_wb_next - 1, WB_SYNC_NONE);
+
+	/* the page holding start may still be partly dirty, keep it */
+	if (READ_ONCE(sbi->s_drop_behind) &&
+	    (ei->i_wb_dropped >> PAGE_SHIFT) < (start >> PAGE_SHIFT))
+		invalidate_mapping_pages(inode->i_mapping,
+					 ei->i_wb_dropped >> PAGE_SHIFT,
+					 (start >> PAGE_SHIFT) - 1);
+
+	ei->i_wb_dropped = start;
+	ei->i_wb_start = ei->i_wb_next;
+}
+
 /*
  * bmap() is special.  It gets used by applications such as lilo and by
  * the swapper to find the on-disk block of a specific piece of data.
@@ -1094,6 +1094,58 @@ static bool __need_flush_quota(struct f2fs_sb_info *sbi)
 	return false;
 }
 
+#ifdef CONFIG_F2FS_CP_PARALLEL_FLUSH
+struct cp_flush_work {
+	struct work_struct work;
+	struct f2fs_sb_info *sbi;
+	pgoff_t start;
+	pgoff_t end;
+};
+
+static void cp_flush_node_work(struct work_struct *work)
+{
+	struct cp_flush_work *fw = container_of(work,
+					struct cp_flush_work, work);
+
+	f2fs_flush_node_range(fw->sbi, fw->start, fw->end);
+}
+
+/*
+ * Write most of the dirty node pages before cp_rwsem is taken, from several
+ * workers each owning a slice of the nid space, so that block_operations()
+ * only writes what got dirtied in the meantime with all operations blocked.
+ */
+static void f2fs_cp_parallel_flush(struct f2fs_sb_info *sbi)
+{
+	unsigned int nr = min(sbi->cp_flush_threads, num_online_cpus());
+	struct cp_flush_work *fw;
+	pgoff_t slice;
+	unsigned int i;
+
+	if (nr < 2 || get_pages(sbi, F2FS_DIRTY_NODES) < CP_FLUSH_MIN_NODES)
+		return;
+
+	fw = kcalloc(nr, sizeof(*fw), GFP_NOFS);
+	if (!fw)
+		return;
+
+	slice = DIV_ROUND_UP(NM_I(sbi)->max_nid, nr);
+	for (i = 0; i < nr; i++) {
+		INIT_WORK(&fw[i].work, cp_flush_node_work);
+		fw[i].sbi = sbi;
+		fw[i].start = i * slice;
+		fw[i].end = (i == nr - 1) ? ULONG_MAX : (i + 1) * slice;
+		queue_work(system_unbound_wq, &fw[i].work);
+	}
+
+	for (i = 0; i < nr; i++)
+		flush_work(&fw[i].work);
+	kfree(fw);
+}
+#else
+static inline void f2fs_cp_parallel_flush(struct f2fs_sb_info *sbi) { }
+#endif
+
 /*
  * Freeze all the FS-operations for checkpoint.
  */
@@ -1107,6 +1159,8 @@ static int block_operations(struct f2fs_sb_info *sbi)
 	struct blk_plug plug;
 	int err = 0, cnt = 0;
 
+	f2fs_cp_parallel_flush(sbi);
+
 	blk_start_plug(&plug);
 
 retry_flush_quotas:
@@ -634,6 +634,7 @@ static int f2fs_submit_page_read(struct inode *inode, struct page *page,
 	}
 	ClearPageError(page);
 	inc_page_count(F2FS_I_SB(inode), F2FS_RD_DATA);
+	f2fs_update_read_heat(F2FS_I_SB(inode), blkaddr);
 	__f2fs_submit_read_bio(F2FS_I_SB(inode), bio, DATA);
 	return 0;
 }
@@ -1655,6 +1656,7 @@ static int f2fs_mpage_readpages(struct address_space *mapping,
 			goto submit_and_realloc;
 
 		inc_page_count(F2FS_I_SB(inode), F2FS_RD_DATA);
+		f2fs_update_read_heat(F2FS_I_SB(inode), block_nr);
 		ClearPageError(page);
 		last_block_in_bio = block_nr;
 		goto next_page;
@@ -1685,6 +1687,7 @@ static int f2fs_read_data_page(struct file *file, struct page *page)
 	int ret = -EAGAIN;
 
 	trace_f2fs_readpage(page, DATA);
+	f2fs_launch_record(inode, page->index, 1);
 
 	/* If the file has inline data, try to read it directly */
 	if (f2fs_has_inline_data(inode))
@@ -1702,6 +1705,7 @@ static int f2fs_read_data_pages(struct file *file,
 	struct page *page = list_last_entry(pages, struct page, lru);
 
 	trace_f2fs_readpages(inode, page, nr_pages);
+	f2fs_launch_record(inode, page->index, nr_pages);
 
 	/* If the file has inline data, skip readpages */
 	if (f2fs_has_inline_data(inode))
@@ -186,6 +186,7 @@ enum {
 
 #define MAX_DISCARD_BLOCKS(sbi)		BLKS_PER_SEC(sbi)
 #define DEF_MAX_DISCARD_REQUEST		8	/* issue 8 discards per round */
+#define DEF_IDLE_DISCARD_REQUEST	64	/* per round, when charging and idle */
 #define DEF_MIN_DISCARD_ISSUE_TIME	50	/* 50 ms, if exists */
 #define DEF_MID_DISCARD_ISSUE_TIME	500	/* 500 ms, if device busy */
 #define DEF_MAX_DISCARD_ISSUE_TIME	60000	/* 60 s, if no candidates */
@@ -297,6 +298,7 @@ struct discard_cmd {
 
 enum {
 	DPOLICY_BG,
+	DPOLICY_IDLE,
 	DPOLICY_FORCE,
 	DPOLICY_FSTRIM,
 	DPOLICY_UMOUNT,
@@ -317,6 +319,12 @@ struct discard_policy {
 	int timeout;			/* discard timeout for put_super */
 };
 
+struct discard_policy_stat {
+	unsigned long long rounds;	/* # of issue rounds */
+	unsigned long long issued;	/* # of discards issued */
+	unsigned long long interrupted;	/* # of rounds cut short by I/O */
+};
+
 struct discard_cmd_control {
 	struct task_struct *f2fs_issue_discard;	/* discard thread */
 	struct list_head entry_list;		/* 4KB discard entry list */
@@ -336,6 +344,7 @@ struct discard_cmd_control {
 	atomic_t discard_cmd_cnt;		/* # of cached cmd count */
 	struct rb_root root;			/* root of discard rb-tree */
 	bool rbtree_check;			/* config for consistence check */
+	struct discard_policy_stat dpolicy_stat[MAX_DPOLICY];
 };
 
 /* for the list of fsync inodes, used only during recovery */
@@ -537,6 +546,13 @@ enum {
 /* maximum retry quota flush count */
 #define DEFAULT_RETRY_QUOTA_FLUSH_COUNT		8
 
+#ifdef CONFIG_F2FS_CP_PARALLEL_FLUSH
+/* # of workers flushing node pages ahead of checkpoint, 0 or 1 disables it */
+#define DEF_CP_FLUSH_THREADS	4
+/* below this many dirty node pages, checkpoint flushes them by itself */
+#define CP_FLUSH_MIN_NODES	256
+#endif
+
 #define F2FS_LINK_MAX	0xffffffff	/* maximum link count per file */
 
 #define MAX_DIR_RA_PAGES	4	/* maximum ra pages of dir */
@@ -1140,6 +1156,39 @@ enum fsync_mode {
 	FSYNC_MODE_NOBARRIER,	/* fsync behaves nobarrier based on posix */
 };
 
+#ifdef CONFIG_F2FS_LAUNCH_PROFILE
+#define F2FS_LAUNCH_KEY_LEN		32
+#define F2FS_LAUNCH_MAX_RANGES		1024	/* per profile */
+#define F2FS_LAUNCH_MAX_PROFILES	16
+#define DEF_LAUNCH_WINDOW_MS		3000	/* recording window */
+
+struct f2fs_launch_range {
+	nid_t ino;			/* inode number */
+	pgoff_t index;			/* first page */
+	unsigned int len;		/* # of pages */
+};
+
+struct f2fs_launch_profile {
+	struct list_head list;		/* in f2fs_launch_info.profiles */
+	char key[F2FS_LAUNCH_KEY_LEN];	/* given by userspace */
+	unsigned int nr;		/* # of recorded ranges */
+	struct f2fs_launch_range ranges[F2FS_LAUNCH_MAX_RANGES];
+};
+
+struct f2fs_launch_info {
+	spinlock_t lock;		/* protects everything below */
+	struct list_head profiles;	/* most recently used first */
+	unsigned int nr_profiles;
+	struct f2fs_launch_profile *rec;	/* profile being recorded */
+	pid_t rec_tgid;			/* process being recorded */
+	unsigned long rec_end;		/* end of recording, in jiffies */
+	char replay_key[F2FS_LAUNCH_KEY_LEN];
+	struct work_struct replay_work;
+	bool dead;			/* umounting */
+	unsigned int window_ms;		/* recording window */
+};
+#endif
+
 #ifdef CONFIG_F2FS_FS_ENCRYPTION
 #define DUMMY_ENCRYPTION_ENABLED(sbi) \
 			(unlikely(F2FS_OPTION(sbi).test_dummy_encryption))
@@ -1259,6 +1308,7 @@ struct f2fs_sb_info {
 	struct f2fs_gc_kthread	*gc_thread;	/* GC thread */
 	unsigned int cur_victim_sec;		/* current victim section num */
 	unsigned int gc_mode;			/* current GC state */
+	unsigned int discard_idle_mode;		/* charging and screen off */
 	unsigned int next_victim_seg[2];	/* next segment in victim section */
 	/* for skip statistic */
 	unsigned long long skipped_atomic_files[2];	/* FG_GC and BG_GC */
@@ -1271,6 +1321,10 @@ struct f2fs_sb_info {
 	unsigned int max_victim_search;
 	/* migration granularity of garbage collection, unit: segment */
 	unsigned int migration_granularity;
+#ifdef CONFIG_F2FS_CP_PARALLEL_FLUSH
+	/* # of workers flushing node pages before cp_rwsem is taken */
+	unsigned int cp_flush_threads;
+#endif
 
 	/*
 	 * for stat information.
@@ -1305,6 +1359,11 @@ struct f2fs_sb_info {
 	unsigned long long write_iostat[NR_IO_TYPE];
 	bool iostat_enable;
 
+#ifdef CONFIG_F2FS_LAUNCH_PROFILE
+	/* For app launch read-ahead */
+	struct f2fs_launch_info launch_info;
+#endif
+
 	/* For sysfs suppport */
 	struct kobject s_kobj;
 	struct completion s_kobj_unregister;
@@ -3028,6 +3087,8 @@ int f2fs_fsync_node_pages(struct f2fs_sb_info *sbi, struct inode *inode,
 int f2fs_sync_node_pages(struct f2fs_sb_info *sbi,
 			struct writeback_control *wbc,
 			bool do_balance, enum iostat_type io_type);
+int f2fs_flush_node_range(struct f2fs_sb_info *sbi,
+			pgoff_t start, pgoff_t end);
 int f2fs_build_free_nids(struct f2fs_sb_info *sbi, bool sync, bool mount);
 bool f2fs_alloc_nid(struct f2fs_sb_info *sbi, nid_t *nid);
 void f2fs_alloc_nid_done(struct f2fs_sb_info *sbi, nid_t nid);
@@ -3508,6 +3569,22 @@ void f2fs_init_extent_cache_info(struct f2fs_sb_info *sbi);
 int __init f2fs_create_extent_cache(void);
 void f2fs_destroy_extent_cache(void);
 
+/*
+ * launch.c
+ */
+#ifdef CONFIG_F2FS_LAUNCH_PROFILE
+void f2fs_launch_record(struct inode *inode, pgoff_t index, unsigned int nr);
+int f2fs_launch_profile_cmd(struct f2fs_sb_info *sbi, const char *buf);
+ssize_t f2fs_launch_profile_show(struct f2fs_sb_info *sbi, char *buf);
+void f2fs_init_launch_info(struct f2fs_sb_info *sbi);
+void f2fs_destroy_launch_info(struct f2fs_sb_info *sbi);
+#else
+static inline void f2fs_launch_record(struct inode *inode, pgoff_t index,
+						unsigned int nr) { }
+static inline void f2fs_init_launch_info(struct f2fs_sb_info *sbi) { }
+static inline void f2fs_destroy_launch_info(struct f2fs_sb_info *sbi) { }
+#endif
+
 /*
  * sysfs.c
  */
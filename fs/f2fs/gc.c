@@ -239,6 +239,49 @@ static unsigned int check_bg_victims(struct f2fs_sb_info *sbi)
 	return NULL_SEGNO;
 }
 
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+static unsigned int get_sec_read_heat(struct f2fs_sb_info *sbi,
+						unsigned int segno)
+{
+	unsigned int start = GET_SEG_FROM_SEC(sbi, GET_SEC_FROM_SEG(sbi, segno));
+	unsigned int heat = 0;
+	unsigned int i;
+
+	for (i = 0; i < sbi->segs_per_sec; i++)
+		heat += get_read_heat(sbi, start + i);
+
+	return heat / sbi->segs_per_sec;
+}
+
+/* valid blocks of a read-hot section go to the warm log, not the cold one */
+static bool is_read_hot_segment(struct f2fs_sb_info *sbi, unsigned int segno)
+{
+	return get_sec_read_heat(sbi, segno) >= READ_HEAT_HOT;
+}
+
+static void decay_read_heat(struct f2fs_sb_info *sbi)
+{
+	struct sit_info *sit_i = SIT_I(sbi);
+	unsigned int segno;
+
+	if (time_before(jiffies, sit_i->heat_decay_time))
+		return;
+
+	for (segno = 0; segno < MAIN_SEGS(sbi); segno++)
+		WRITE_ONCE(sit_i->read_heat[segno],
+				sit_i->read_heat[segno] >> 1);
+	sit_i->heat_decay_time = jiffies + READ_HEAT_DECAY_INTERVAL;
+}
+#else
+static inline bool is_read_hot_segment(struct f2fs_sb_info *sbi,
+						unsigned int segno)
+{
+	return false;
+}
+
+static inline void decay_read_heat(struct f2fs_sb_info *sbi) { }
+#endif
+
 static unsigned int get_cb_cost(struct f2fs_sb_info *sbi, unsigned int segno)
 {
 	struct sit_info *sit_i = SIT_I(sbi);
@@ -268,6 +311,12 @@ static unsigned int get_cb_cost(struct f2fs_sb_info *sbi, unsigned int segno)
 		age = 100 - div64_u64(100 * (mtime - sit_i->min_mtime),
 				sit_i->max_mtime - sit_i->min_mtime);
 
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+	/* blocks read often gain little from being moved, prefer cold ones */
+	age = age * READ_HEAT_SCALE / (READ_HEAT_SCALE + get_sec_read_heat(sbi,
+									segno));
+#endif
+
 	return UINT_MAX - ((100 * (100 - u) * age) / (100 + u));
 }
 
@@ -729,6 +778,7 @@ static int move_data_block(struct inode *inode, block_t bidx,
 	block_t newaddr;
 	int err = 0;
 	bool lfs_mode = test_opt(fio.sbi, LFS);
+	bool hot = is_read_hot_segment(fio.sbi, segno);
 
 	/* do not read out */
 	page = f2fs_grab_cache_page(inode->i_mapping, bidx, false);
@@ -786,7 +836,9 @@ static int move_data_block(struct inode *inode, block_t bidx,
 		down_write(&fio.sbi->io_order_lock);
 
 	f2fs_allocate_data_block(fio.sbi, NULL, fio.old_blkaddr, &newaddr,
-					&sum, CURSEG_COLD_DATA, NULL, false);
+			&sum, hot ? CURSEG_WARM_DATA : CURSEG_COLD_DATA,
+			NULL, false);
+	fio.temp = hot ? WARM : COLD;
 
 	fio.encrypted_page = f2fs_pagecache_get_page(META_MAPPING(fio.sbi),
 				newaddr, FGP_LOCK | FGP_CREAT, GFP_NOFS);
@@ -875,6 +927,7 @@ static int move_data_block(struct inode *inode, block_t bidx,
 static int move_data_page(struct inode *inode, block_t bidx, int gc_type,
 							unsigned int segno, int off)
 {
+	bool hot = is_read_hot_segment(F2FS_I_SB(inode), segno);
 	struct page *page;
 	int err = 0;
 
@@ -906,7 +959,8 @@ static int move_data_page(struct inode *inode, block_t bidx, int gc_type,
 			goto out;
 		}
 		set_page_dirty(page);
-		set_cold_data(page);
+		if (!hot)
+			set_cold_data(page);
 	} else {
 		struct f2fs_io_info fio = {
 			.sbi = F2FS_I_SB(inode),
@@ -932,7 +986,8 @@ static int move_data_page(struct inode *inode, block_t bidx, int gc_type,
 			f2fs_remove_dirty_inode(inode);
 		}
 
-		set_cold_data(page);
+		if (!hot)
+			set_cold_data(page);
 
 		err = f2fs_do_write_data_page(&fio);
 		if (err) {
@@ -1245,6 +1300,7 @@ int f2fs_gc(struct f2fs_sb_info *sbi, bool sync,
 	cpc.reason = __get_cp_reason(sbi);
 	sbi->skipped_gc_rwsem = 0;
 	first_skipped = last_skipped;
+	decay_read_heat(sbi);
 gc_more:
 	if (unlikely(!(sbi->sb->s_flags & MS_ACTIVE))) {
 		ret = -EINVAL;
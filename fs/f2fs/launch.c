@@ -0,0 +1,375 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * f2fs launch profile support
+ *
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *             http://www.samsung.com/
+ *
+ * A launch profile is the list of file ranges a process read from the page
+ * cache misses of its first seconds, recorded once and read ahead in one
+ * sorted, merged and plugged pass the next time the same key is replayed.
+ * Userspace (the app launcher) decides what a key is and when to record.
+ */
+
+#include <linux/fs.h>
+#include <linux/f2fs_fs.h>
+#include <linux/sort.h>
+#include <linux/blkdev.h>
+
+#include "f2fs.h"
+#include "node.h"
+
+static void free_launch_profile(struct f2fs_launch_profile *p)
+{
+	kvfree(p);
+}
+
+/* called with li->lock held */
+static struct f2fs_launch_profile *__lookup_launch_profile(
+				struct f2fs_launch_info *li, const char *key)
+{
+	struct f2fs_launch_profile *p;
+
+	list_for_each_entry(p, &li->profiles, list)
+		if (!strncmp(p->key, key, F2FS_LAUNCH_KEY_LEN))
+			return p;
+	return NULL;
+}
+
+/* called with li->lock held */
+static void __remove_launch_profile(struct f2fs_launch_info *li,
+				struct f2fs_launch_profile *p)
+{
+	if (li->rec == p)
+		li->rec = NULL;
+	list_del(&p->list);
+	li->nr_profiles--;
+}
+
+/*
+ * Page cache misses of the recording process. Readpages may skip cached
+ * pages in the middle of its window, so recording [index, index + nr) is an
+ * over-estimate that costs nothing at replay time.
+ */
+void f2fs_launch_record(struct inode *inode, pgoff_t index, unsigned int nr)
+{
+	struct f2fs_launch_info *li = &F2FS_I_SB(inode)->launch_info;
+	struct f2fs_launch_profile *p;
+	struct f2fs_launch_range *r;
+
+	if (likely(!READ_ONCE(li->rec)))
+		return;
+	if (current->tgid != READ_ONCE(li->rec_tgid) ||
+					!S_ISREG(inode->i_mode))
+		return;
+
+	spin_lock(&li->lock);
+	p = li->rec;
+	if (!p || current->tgid != li->rec_tgid)
+		goto out;
+
+	if (time_after(jiffies, li->rec_end)) {
+		li->rec = NULL;
+		goto out;
+	}
+
+	if (p->nr) {
+		r = &p->ranges[p->nr - 1];
+		if (r->ino == inode->i_ino && index >= r->index &&
+					index <= r->index + r->len) {
+			r->len = max_t(pgoff_t, r->len, index + nr - r->index);
+			goto out;
+		}
+	}
+
+	if (p->nr >= F2FS_LAUNCH_MAX_RANGES) {
+		li->rec = NULL;
+		goto out;
+	}
+
+	r = &p->ranges[p->nr++];
+	r->ino = inode->i_ino;
+	r->index = index;
+	r->len = nr;
+out:
+	spin_unlock(&li->lock);
+}
+
+static int cmp_launch_range(const void *a, const void *b)
+{
+	const struct f2fs_launch_range *ra = a, *rb = b;
+
+	if (ra->ino != rb->ino)
+		return ra->ino < rb->ino ? -1 : 1;
+	if (ra->index != rb->index)
+		return ra->index < rb->index ? -1 : 1;
+	return 0;
+}
+
+static void f2fs_launch_readahead(struct inode *inode,
+				pgoff_t index, pgoff_t len)
+{
+	struct file_ra_state ra;
+	pgoff_t end;
+
+	end = DIV_ROUND_UP(i_size_read(inode), PAGE_SIZE);
+	end = min(end, index + len);
+
+	file_ra_state_init(&ra, inode->i_mapping);
+	if (!ra.ra_pages)
+		return;
+
+	while (index < end) {
+		unsigned long nr = min_t(pgoff_t, end - index, ra.ra_pages);
+
+		page_cache_sync_readahead(inode->i_mapping, &ra, NULL,
+								index, nr);
+		index += nr;
+	}
+}
+
+static bool launch_inode_alive(struct f2fs_sb_info *sbi, nid_t ino)
+{
+	struct node_info ni;
+
+	if (f2fs_check_nid_range(sbi, ino))
+		return false;
+	if (f2fs_get_node_info(sbi, ino, &ni))
+		return false;
+	return ni.ino == ino && __is_valid_data_blkaddr(ni.blk_addr);
+}
+
+static void f2fs_launch_replay(struct f2fs_sb_info *sbi,
+			struct f2fs_launch_range *ranges, unsigned int nr)
+{
+	struct blk_plug plug;
+	unsigned int i = 0;
+
+	sort(ranges, nr, sizeof(*ranges), cmp_launch_range, NULL);
+
+	blk_start_plug(&plug);
+	while (i < nr) {
+		nid_t ino = ranges[i].ino;
+		struct inode *inode;
+
+		if (!launch_inode_alive(sbi, ino)) {
+			while (i < nr && ranges[i].ino == ino)
+				i++;
+			continue;
+		}
+
+		inode = f2fs_iget(sbi->sb, ino);
+		if (IS_ERR(inode) || is_bad_inode(inode) ||
+				!S_ISREG(inode->i_mode) ||
+				(f2fs_encrypted_file(inode) &&
+				!fscrypt_has_encryption_key(inode))) {
+			if (!IS_ERR(inode))
+				iput(inode);
+			while (i < nr && ranges[i].ino == ino)
+				i++;
+			continue;
+		}
+
+		while (i < nr && ranges[i].ino == ino) {
+			pgoff_t start = ranges[i].index;
+			pgoff_t end = start + ranges[i].len;
+
+			/* merge overlapping and adjacent ranges of the inode */
+			for (i++; i < nr && ranges[i].ino == ino &&
+					ranges[i].index <= end; i++)
+				end = max_t(pgoff_t, end,
+					ranges[i].index + ranges[i].len);
+
+			f2fs_launch_readahead(inode, start, end - start);
+		}
+		iput(inode);
+	}
+	blk_finish_plug(&plug);
+}
+
+static void f2fs_launch_replay_work(struct work_struct *work)
+{
+	struct f2fs_launch_info *li = container_of(work,
+				struct f2fs_launch_info, replay_work);
+	struct f2fs_sb_info *sbi = container_of(li,
+				struct f2fs_sb_info, launch_info);
+	struct f2fs_launch_range *ranges;
+	struct f2fs_launch_profile *p;
+	unsigned int nr = 0;
+
+	ranges = f2fs_kvmalloc(sbi, sizeof(*ranges) * F2FS_LAUNCH_MAX_RANGES,
+								GFP_KERNEL);
+	if (!ranges)
+		return;
+
+	spin_lock(&li->lock);
+	p = __lookup_launch_profile(li, li->replay_key);
+	if (p && p != li->rec) {
+		nr = p->nr;
+		memcpy(ranges, p->ranges, sizeof(*ranges) * nr);
+	}
+	spin_unlock(&li->lock);
+
+	if (nr)
+		f2fs_launch_replay(sbi, ranges, nr);
+	kvfree(ranges);
+}
+
+static int f2fs_launch_start_record(struct f2fs_sb_info *sbi,
+				pid_t pid, const char *key)
+{
+	struct f2fs_launch_info *li = &sbi->launch_info;
+	struct f2fs_launch_profile *p, *old = NULL, *victim = NULL;
+	struct task_struct *task;
+	pid_t tgid;
+
+	rcu_read_lock();
+	task = find_task_by_vpid(pid);
+	tgid = task ? task->tgid : 0;
+	rcu_read_unlock();
+	if (!tgid)
+		return -ESRCH;
+
+	p = f2fs_kvzalloc(sbi, sizeof(*p), GFP_KERNEL);
+	if (!p)
+		return -ENOMEM;
+	strlcpy(p->key, key, F2FS_LAUNCH_KEY_LEN);
+
+	spin_lock(&li->lock);
+	if (li->dead) {
+		spin_unlock(&li->lock);
+		free_launch_profile(p);
+		return -ENODEV;
+	}
+
+	old = __lookup_launch_profile(li, p->key);
+	if (old)
+		__remove_launch_profile(li, old);
+	if (li->nr_profiles >= F2FS_LAUNCH_MAX_PROFILES) {
+		victim = list_last_entry(&li->profiles,
+					struct f2fs_launch_profile, list);
+		__remove_launch_profile(li, victim);
+	}
+
+	list_add(&p->list, &li->profiles);
+	li->nr_profiles++;
+	li->rec_tgid = tgid;
+	li->rec_end = jiffies + msecs_to_jiffies(li->window_ms);
+	WRITE_ONCE(li->rec, p);
+	spin_unlock(&li->lock);
+
+	if (old)
+		free_launch_profile(old);
+	if (victim)
+		free_launch_profile(victim);
+	return 0;
+}
+
+static int f2fs_launch_start_replay(struct f2fs_sb_info *sbi, const char *key)
+{
+	struct f2fs_launch_info *li = &sbi->launch_info;
+	struct f2fs_launch_profile *p;
+	int err = 0;
+
+	spin_lock(&li->lock);
+	p = __lookup_launch_profile(li, key);
+	if (!p) {
+		err = -ENOENT;
+	} else if (p == li->rec) {
+		err = -EBUSY;
+	} else if (!li->dead) {
+		list_move(&p->list, &li->profiles);
+		strlcpy(li->replay_key, key, F2FS_LAUNCH_KEY_LEN);
+		queue_work(system_unbound_wq, &li->replay_work);
+	}
+	spin_unlock(&li->lock);
+	return err;
+}
+
+static int f2fs_launch_drop(struct f2fs_sb_info *sbi, const char *key)
+{
+	struct f2fs_launch_info *li = &sbi->launch_info;
+	struct f2fs_launch_profile *p;
+
+	spin_lock(&li->lock);
+	p = __lookup_launch_profile(li, key);
+	if (p)
+		__remove_launch_profile(li, p);
+	spin_unlock(&li->lock);
+
+	if (!p)
+		return -ENOENT;
+	free_launch_profile(p);
+	return 0;
+}
+
+/*
+ * "record <pid> <key>", "replay <key>" or "drop <key>"
+ */
+int f2fs_launch_profile_cmd(struct f2fs_sb_info *sbi, const char *buf)
+{
+	char key[F2FS_LAUNCH_KEY_LEN];
+	int pid;
+
+	if (sscanf(buf, "record %d %31s", &pid, key) == 2)
+		return f2fs_launch_start_record(sbi, pid, key);
+	if (sscanf(buf, "replay %31s", key) == 1)
+		return f2fs_launch_start_replay(sbi, key);
+	if (sscanf(buf, "drop %31s", key) == 1)
+		return f2fs_launch_drop(sbi, key);
+	return -EINVAL;
+}
+
+ssize_t f2fs_launch_profile_show(struct f2fs_sb_info *sbi, char *buf)
+{
+	struct f2fs_launch_info *li = &sbi->launch_info;
+	struct f2fs_launch_profile *p;
+	ssize_t len = 0;
+
+	spin_lock(&li->lock);
+	list_for_each_entry(p, &li->profiles, list) {
+		unsigned long pages = 0;
+		unsigned int i;
+
+		for (i = 0; i < p->nr; i++)
+			pages += p->ranges[i].len;
+
+		len += snprintf(buf + len, PAGE_SIZE - len, "%s %u %lu%s\n",
+				p->key, p->nr, pages,
+				p == li->rec ? " recording" : "");
+		if (len >= PAGE_SIZE)
+			break;
+	}
+	spin_unlock(&li->lock);
+
+	return min_t(ssize_t, len, PAGE_SIZE - 1);
+}
+
+void f2fs_init_launch_info(struct f2fs_sb_info *sbi)
+{
+	struct f2fs_launch_info *li = &sbi->launch_info;
+
+	spin_lock_init(&li->lock);
+	INIT_LIST_HEAD(&li->profiles);
+	INIT_WORK(&li->replay_work, f2fs_launch_replay_work);
+	li->window_ms = DEF_LAUNCH_WINDOW_MS;
+}
+
+void f2fs_destroy_launch_info(struct f2fs_sb_info *sbi)
+{
+	struct f2fs_launch_info *li = &sbi->launch_info;
+	struct f2fs_launch_profile *p, *tmp;
+
+	spin_lock(&li->lock);
+	li->dead = true;
+	li->rec = NULL;
+	spin_unlock(&li->lock);
+
+	cancel_work_sync(&li->replay_work);
+
+	list_for_each_entry_safe(p, tmp, &li->profiles, list) {
+		list_del(&p->list);
+		free_launch_profile(p);
+	}
+	li->nr_profiles = 0;
+}
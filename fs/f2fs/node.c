@@ -1865,6 +1865,78 @@ int f2fs_sync_node_pages(struct f2fs_sb_info *sbi,
 	return ret;
 }
 
+/*
+ * Write back the dirty node pages with an index in [start, end), skipping
+ * locked and inline ones. Whatever is left is written by block_operations().
+ */
+int f2fs_flush_node_range(struct f2fs_sb_info *sbi,
+			pgoff_t start, pgoff_t end)
+{
+	struct writeback_control wbc = {
+		.sync_mode = WB_SYNC_NONE,
+		.nr_to_write = LONG_MAX,
+		.for_reclaim = 0,
+	};
+	pgoff_t index = start;
+	struct pagevec pvec;
+	int nwritten = 0;
+	int nr_pages;
+
+	pagevec_init(&pvec, 0);
+
+	while (index < end && (nr_pages = pagevec_lookup_tag(&pvec,
+			NODE_MAPPING(sbi), &index, PAGECACHE_TAG_DIRTY))) {
+		int i;
+
+		for (i = 0; i < nr_pages; i++) {
+			struct page *page = pvec.pages[i];
+			bool submitted = false;
+
+			if (page->index >= end) {
+				index = end;
+				break;
+			}
+
+			if (!trylock_page(page))
+				continue;
+
+			if (unlikely(page->mapping != NODE_MAPPING(sbi)) ||
+					!PageDirty(page) || is_inline_node(page)) {
+				unlock_page(page);
+				continue;
+			}
+
+			f2fs_wait_on_page_writeback(page, NODE, true, true);
+
+			if (!clear_page_dirty_for_io(page)) {
+				unlock_page(page);
+				continue;
+			}
+
+			set_fsync_mark(page, 0);
+			set_dentry_mark(page, 0);
+
+			if (__write_node_page(page, false, &submitted,
+					&wbc, false, FS_CP_NODE_IO, NULL))
+				unlock_page(page);
+			else if (submitted)
+				nwritten++;
+		}
+		pagevec_release(&pvec);
+		cond_resched();
+
+		if (unlikely(f2fs_cp_error(sbi)))
+			break;
+	}
+
+	if (nwritten)
+		f2fs_submit_merged_write(sbi, NODE);
+
+	if (unlikely(f2fs_cp_error(sbi)))
+		return -EIO;
+	return 0;
+}
+
 int f2fs_wait_on_node_pages_writeback(struct f2fs_sb_info *sbi,
 						unsigned int seq_id)
 {
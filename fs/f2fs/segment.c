@@ -1072,6 +1072,15 @@ static void __init_discard_policy(struct f2fs_sb_info *sbi,
 			dpolicy->granularity = 1;
 			dpolicy->max_interval = DEF_MIN_DISCARD_ISSUE_TIME;
 		}
+	} else if (discard_type == DPOLICY_IDLE) {
+		/* charging and screen off: drain everything, largest first */
+		dpolicy->min_interval = DEF_MIN_DISCARD_ISSUE_TIME;
+		dpolicy->mid_interval = DEF_MID_DISCARD_ISSUE_TIME;
+		dpolicy->max_interval = DEF_MAX_DISCARD_ISSUE_TIME;
+		dpolicy->max_requests = DEF_IDLE_DISCARD_REQUEST;
+		dpolicy->io_aware = true;
+		dpolicy->sync = false;
+		dpolicy->granularity = 1;
 	} else if (discard_type == DPOLICY_FORCE) {
 		dpolicy->min_interval = DEF_MIN_DISCARD_ISSUE_TIME;
 		dpolicy->mid_interval = DEF_MID_DISCARD_ISSUE_TIME;
@@ -1436,6 +1445,29 @@ static unsigned int __issue_discard_cmd_orderly(struct f2fs_sb_info *sbi,
 	return issued;
 }
 
+/*
+ * Requests in flight on the whole disk, so that I/O to other partitions
+ * also holds back idle-time discards.
+ */
+static bool f2fs_disk_busy(struct f2fs_sb_info *sbi)
+{
+	struct block_device *bdev = sbi->sb->s_bdev;
+
+	return part_in_flight(&bdev->bd_disk->part0) != 0;
+}
+
+static void __update_discard_stat(struct discard_cmd_control *dcc,
+				struct discard_policy *dpolicy, int issued)
+{
+	struct discard_policy_stat *stat = &dcc->dpolicy_stat[dpolicy->type];
+
+	stat->rounds++;
+	if (issued > 0)
+		stat->issued += issued;
+	else if (issued < 0)
+		stat->interrupted++;
+}
+
 static int __issue_discard_cmd(struct f2fs_sb_info *sbi,
 					struct discard_policy *dpolicy)
 {
@@ -1449,6 +1481,11 @@ static int __issue_discard_cmd(struct f2fs_sb_info *sbi,
 	if (dpolicy->timeout != 0)
 		f2fs_update_time(sbi, dpolicy->timeout);
 
+	if (dpolicy->io_aware && f2fs_disk_busy(sbi)) {
+		io_interrupted = true;
+		goto out;
+	}
+
 	for (i = MAX_PLIST_NUM - 1; i >= 0; i--) {
 		if (dpolicy->timeout != 0 &&
 				f2fs_time_over(sbi, dpolicy->timeout))
@@ -1457,8 +1494,11 @@ static int __issue_discard_cmd(struct f2fs_sb_info *sbi,
 		if (i + 1 < dpolicy->granularity)
 			break;
 
-		if (i < DEFAULT_DISCARD_GRANULARITY && dpolicy->ordered)
-			return __issue_discard_cmd_orderly(sbi, dpolicy);
+		if (i < DEFAULT_DISCARD_GRANULARITY && dpolicy->ordered) {
+			issued = __issue_discard_cmd_orderly(sbi, dpolicy);
+			__update_discard_stat(dcc, dpolicy, issued);
+			return issued;
+		}
 
 		pend_list = &dcc->pend_list[i];
 
@@ -1490,10 +1530,11 @@ static int __issue_discard_cmd(struct f2fs_sb_info *sbi,
 		if (issued >= dpolicy->max_requests || io_interrupted)
 			break;
 	}
-
+out:
 	if (!issued && io_interrupted)
 		issued = -1;
 
+	__update_discard_stat(dcc, dpolicy, issued);
 	return issued;
 }
 
@@ -1671,8 +1712,9 @@ static int issue_discard_thread(void *data)
 	set_freezable();
 
 	do {
-		__init_discard_policy(sbi, &dpolicy, DPOLICY_BG,
-					dcc->discard_granularity);
+		__init_discard_policy(sbi, &dpolicy,
+				sbi->discard_idle_mode ? DPOLICY_IDLE : DPOLICY_BG,
+				dcc->discard_granularity);
 
 		wait_event_interruptible_timeout(*q,
 				kthread_should_stop() || freezing(current) ||
@@ -2436,6 +2478,10 @@ static void reset_curseg(struct f2fs_sb_info *sbi, int type, int modified)
 	curseg->zone = GET_ZONE_FROM_SEG(sbi, curseg->segno);
 	curseg->next_blkoff = 0;
 	curseg->next_segno = NULL_SEGNO;
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+	/* reads of the blocks that were here say nothing about new ones */
+	SIT_I(sbi)->read_heat[curseg->segno] = 0;
+#endif
 
 	sum_footer = &(curseg->sum_blk->footer);
 	memset(sum_footer, 0, sizeof(struct summary_footer));
@@ -3920,6 +3966,13 @@ static int build_sit_info(struct f2fs_sb_info *sbi)
 	if (!sit_i->tmp_map)
 		return -ENOMEM;
 
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+	sit_i->read_heat = f2fs_kvzalloc(sbi, MAIN_SEGS(sbi), GFP_KERNEL);
+	if (!sit_i->read_heat)
+		return -ENOMEM;
+	sit_i->heat_decay_time = jiffies + READ_HEAT_DECAY_INTERVAL;
+#endif
+
 	if (__is_large_section(sbi)) {
 		sit_i->sec_entries =
 			f2fs_kvzalloc(sbi, array_size(sizeof(struct sec_entry),
@@ -4441,6 +4494,9 @@ static void destroy_sit_info(struct f2fs_sb_info *sbi)
 		}
 	}
 	kvfree(sit_i->tmp_map);
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+	kvfree(sit_i->read_heat);
+#endif
 
 	kvfree(sit_i->sentries);
 	kvfree(sit_i->sec_entries);
@@ -247,8 +247,20 @@ struct sit_info {
 	unsigned long long max_mtime;		/* max. modification time */
 
 	unsigned int last_victim[MAX_GC_POLICY]; /* last victim segment # */
+
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+	/* for read heat aware victim selection */
+	unsigned char *read_heat;		/* decaying # of reads per segment */
+	unsigned long heat_decay_time;		/* next decay, in jiffies */
+#endif
 };
 
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+#define READ_HEAT_DECAY_INTERVAL	(60 * HZ)	/* halve heat every minute */
+#define READ_HEAT_SCALE			16	/* heat halving the cb benefit */
+#define READ_HEAT_HOT			32	/* heat of a hot section */
+#endif
+
 struct free_segmap_info {
 	unsigned int start_segno;	/* start segment number logically */
 	unsigned int free_segments;	/* # of free segments */
@@ -319,6 +331,35 @@ static inline struct seg_entry *get_seg_entry(struct f2fs_sb_info *sbi,
 	return &sit_i->sentries[segno];
 }
 
+#ifdef CONFIG_F2FS_GC_READ_HEAT
+/*
+ * Called for every data block read. The counter saturates and is updated
+ * without any lock, losing an increment now and then is fine.
+ */
+static inline void f2fs_update_read_heat(struct f2fs_sb_info *sbi,
+						block_t blkaddr)
+{
+	unsigned int segno = GET_SEGNO(sbi, blkaddr);
+	unsigned char *heat;
+
+	if (segno >= MAIN_SEGS(sbi))
+		return;
+
+	heat = &SIT_I(sbi)->read_heat[segno];
+	if (*heat < U8_MAX)
+		WRITE_ONCE(*heat, *heat + 1);
+}
+
+static inline unsigned int get_read_heat(struct f2fs_sb_info *sbi,
+						unsigned int segno)
+{
+	return READ_ONCE(SIT_I(sbi)->read_heat[segno]);
+}
+#else
+static inline void f2fs_update_read_heat(struct f2fs_sb_info *sbi,
+						block_t blkaddr) { }
+#endif
+
 static inline struct sec_entry *get_sec_entry(struct f2fs_sb_info *sbi,
 						unsigned int segno)
 {
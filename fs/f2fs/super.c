@@ -1038,6 +1038,9 @@ static void f2fs_put_super(struct super_block *sb)
 
 	f2fs_quota_off_umount(sb);
 
+	/* no more replays looking up inodes */
+	f2fs_destroy_launch_info(sbi);
+
 	/* prevent remaining shrinker jobs */
 	mutex_lock(&sbi->umount_mutex);
 
@@ -2727,6 +2730,9 @@ static void init_sb_info(struct f2fs_sb_info *sbi)
 	sbi->next_victim_seg[FG_GC] = NULL_SEGNO;
 	sbi->max_victim_search = DEF_MAX_VICTIM_SEARCH;
 	sbi->migration_granularity = sbi->segs_per_sec;
+#ifdef CONFIG_F2FS_CP_PARALLEL_FLUSH
+	sbi->cp_flush_threads = DEF_CP_FLUSH_THREADS;
+#endif
 
 	sbi->dir_level = DEF_DIR_LEVEL;
 	sbi->interval_time[CP_TIME] = DEF_CP_INTERVAL;
@@ -3298,6 +3304,7 @@ static int f2fs_fill_super(struct super_block *sb, void *data, int silent)
 			le64_to_cpu(seg_i->journal->info.kbytes_written);
 
 	f2fs_build_gc_manager(sbi);
+	f2fs_init_launch_info(sbi);
 
 	err = f2fs_build_stats(sbi);
 	if (err)
@@ -3453,6 +3460,7 @@ static int f2fs_fill_super(struct super_block *sb, void *data, int silent)
 	/* evict some inodes being cached by GC */
 	evict_inodes(sb);
 	f2fs_unregister_sysfs(sbi);
+	f2fs_destroy_launch_info(sbi);
 free_root_inode:
 	dput(sb->s_root);
 	sb->s_root = NULL;
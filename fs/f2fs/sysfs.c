@@ -68,6 +68,50 @@ static ssize_t dirty_segments_show(struct f2fs_attr *a,
 		(unsigned long long)(dirty_segments(sbi)));
 }
 
+static ssize_t discard_stat_show(struct f2fs_attr *a,
+		struct f2fs_sb_info *sbi, char *buf)
+{
+	static const char *dpolicy_name[MAX_DPOLICY] = {
+		[DPOLICY_BG] = "bg",
+		[DPOLICY_IDLE] = "idle",
+		[DPOLICY_FORCE] = "force",
+		[DPOLICY_FSTRIM] = "fstrim",
+		[DPOLICY_UMOUNT] = "umount",
+	};
+	struct discard_cmd_control *dcc = SM_I(sbi)->dcc_info;
+	ssize_t len = 0;
+	int i;
+
+	if (!dcc)
+		return snprintf(buf, PAGE_SIZE, "discard is off\n");
+
+	len += snprintf(buf, PAGE_SIZE, "%-8s %12s %12s %12s\n",
+			"policy", "rounds", "issued", "interrupted");
+	for (i = 0; i < MAX_DPOLICY; i++)
+		len += snprintf(buf + len, PAGE_SIZE - len,
+				"%-8s %12llu %12llu %12llu\n", dpolicy_name[i],
+				dcc->dpolicy_stat[i].rounds,
+				dcc->dpolicy_stat[i].issued,
+				dcc->dpolicy_stat[i].interrupted);
+	return len;
+}
+
+#ifdef CONFIG_F2FS_LAUNCH_PROFILE
+static ssize_t launch_profile_show(struct f2fs_attr *a,
+		struct f2fs_sb_info *sbi, char *buf)
+{
+	return f2fs_launch_profile_show(sbi, buf);
+}
+
+static ssize_t launch_profile_store(struct f2fs_attr *a,
+		struct f2fs_sb_info *sbi, const char *buf, size_t count)
+{
+	int ret = f2fs_launch_profile_cmd(sbi, buf);
+
+	return ret ? ret : count;
+}
+#endif
+
 static ssize_t lifetime_write_kbytes_show(struct f2fs_attr *a,
 		struct f2fs_sb_info *sbi, char *buf)
 {
@@ -281,6 +325,13 @@ static ssize_t __sbi_store(struct f2fs_attr *a,
 	}
 
 
+	if (!strcmp(a->attr.name, "discard_idle_mode")) {
+		sbi->discard_idle_mode = !!t;
+		if (SM_I(sbi)->dcc_info)
+			wake_up_discard_thread(sbi, true);
+		return count;
+	}
+
 	if (!strcmp(a->attr.name, "iostat_enable")) {
 		sbi->iostat_enable = !!t;
 		if (!sbi->iostat_enable)
@@ -404,6 +455,7 @@ F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_max_sleep_time, max_sleep_time);
 F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_no_gc_sleep_time, no_gc_sleep_time);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_idle, gc_mode);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_urgent, gc_mode);
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, discard_idle_mode, discard_idle_mode);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, reclaim_segments, rec_prefree_segments);
 F2FS_RW_ATTR(DCC_INFO, discard_cmd_control, max_small_discards, max_discards);
 F2FS_RW_ATTR(DCC_INFO, discard_cmd_control, discard_granularity, discard_granularity);
@@ -432,11 +484,20 @@ F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, iostat_enable, iostat_enable);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, readdir_ra, readdir_ra);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_pin_file_thresh, gc_pin_file_threshold);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_super_block, extension_list, extension_list);
+#ifdef CONFIG_F2FS_CP_PARALLEL_FLUSH
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, cp_flush_threads, cp_flush_threads);
+#endif
+#ifdef CONFIG_F2FS_LAUNCH_PROFILE
+F2FS_ATTR_OFFSET(F2FS_SBI, launch_profile, 0644,
+		launch_profile_show, launch_profile_store, 0);
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, launch_profile_ms, launch_info.window_ms);
+#endif
 #ifdef CONFIG_F2FS_FAULT_INJECTION
 F2FS_RW_ATTR(FAULT_INFO_RATE, f2fs_fault_info, inject_rate, inject_rate);
 F2FS_RW_ATTR(FAULT_INFO_TYPE, f2fs_fault_info, inject_type, inject_type);
 #endif
 F2FS_GENERAL_RO_ATTR(dirty_segments);
+F2FS_GENERAL_RO_ATTR(discard_stat);
 F2FS_GENERAL_RO_ATTR(lifetime_write_kbytes);
 F2FS_GENERAL_RO_ATTR(features);
 F2FS_GENERAL_RO_ATTR(current_reserved_blocks);
@@ -468,6 +529,7 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(reclaim_segments),
 	ATTR_LIST(max_small_discards),
 	ATTR_LIST(discard_granularity),
+	ATTR_LIST(discard_idle_mode),
 	ATTR_LIST(batched_trim_sections),
 	ATTR_LIST(ipu_policy),
 	ATTR_LIST(min_ipu_util),
@@ -490,11 +552,19 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(readdir_ra),
 	ATTR_LIST(gc_pin_file_thresh),
 	ATTR_LIST(extension_list),
+#ifdef CONFIG_F2FS_CP_PARALLEL_FLUSH
+	ATTR_LIST(cp_flush_threads),
+#endif
+#ifdef CONFIG_F2FS_LAUNCH_PROFILE
+	ATTR_LIST(launch_profile),
+	ATTR_LIST(launch_profile_ms),
+#endif
 #ifdef CONFIG_F2FS_FAULT_INJECTION
 	ATTR_LIST(inject_rate),
 	ATTR_LIST(inject_type),
 #endif
 	ATTR_LIST(dirty_segments),
+	ATTR_LIST(discard_stat),
 	ATTR_LIST(lifetime_write_kbytes),
 	ATTR_LIST(features),
 	ATTR_LIST(reserved_blocks),
@@ -2264,6 +2264,16 @@ static long fuse_dev_ioctl(struct file *file, unsigned int cmd,
 				fput(old);
 			}
 		}
+	} else if (cmd == FUSE_DEV_IOC_PASSTHROUGH_OPEN) {
+		struct fuse_dev *fud = fuse_get_dev(file);
+		int fd;
+
+		err = -EFAULT;
+		if (!get_user(fd, (__u32 __user *) arg)) {
+			err = -EINVAL;
+			if (fud)
+				err = fuse_passthrough_open(fud->fc, fd);
+		}
 	}
 	return err;
 }
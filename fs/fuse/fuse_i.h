@@ -119,6 +119,12 @@ enum {
 
 struct fuse_conn;
 
+/** Backing file of a passthrough fuse_file */
+struct fuse_passthrough {
+	struct file *filp;
+	const struct cred *cred;
+};
+
 /** FUSE specific file data */
 struct fuse_file {
 	/** Fuse connection for this file */
@@ -153,6 +159,11 @@ struct fuse_file {
 
 	/** Has flock been performed on this file? */
 	bool flock:1;
+
+#ifdef CONFIG_FUSE_PASSTHROUGH
+	/** Backing file serving read/write/mmap, if any */
+	struct fuse_passthrough passthrough;
+#endif
 };
 
 /** One input argument of a request */
@@ -622,6 +633,9 @@ struct fuse_conn {
 	/** Does the filesystem support posix acls? */
 	unsigned posix_acl:1;
 
+	/** Can files be opened in passthrough mode? */
+	unsigned passthrough:1;
+
 	/** Check permissions based on the file mode or not? */
 	unsigned default_permissions:1;
 
@@ -669,6 +683,12 @@ struct fuse_conn {
 
 	/** List of device instances belonging to this connection */
 	struct list_head devices;
+
+#ifdef CONFIG_FUSE_PASSTHROUGH
+	/** Backing files registered but not yet claimed by an open */
+	struct idr passthrough_req;
+	spinlock_t passthrough_req_lock;
+#endif
 };
 
 static inline struct fuse_conn *get_fuse_conn_super(struct super_block *sb)
@@ -989,4 +1009,62 @@ struct posix_acl;
 struct posix_acl *fuse_get_acl(struct inode *inode, int type);
 int fuse_set_acl(struct inode *inode, struct posix_acl *acl, int type);
 
+/* passthrough.c */
+#ifdef CONFIG_FUSE_PASSTHROUGH
+int fuse_passthrough_open(struct fuse_conn *fc, int fd);
+void fuse_passthrough_setup(struct fuse_conn *fc, struct fuse_file *ff,
+			    struct fuse_open_out *openarg);
+void fuse_passthrough_release(struct fuse_passthrough *passthrough);
+void fuse_passthrough_destroy(struct fuse_conn *fc);
+ssize_t fuse_passthrough_read_iter(struct kiocb *iocb, struct iov_iter *iter);
+ssize_t fuse_passthrough_write_iter(struct kiocb *iocb, struct iov_iter *iter);
+int fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma);
+
+static inline void fuse_passthrough_init(struct fuse_conn *fc)
+{
+	idr_init(&fc->passthrough_req);
+	spin_lock_init(&fc->passthrough_req_lock);
+}
+
+static inline bool fuse_file_passthrough(struct fuse_file *ff)
+{
+	return ff->passthrough.filp != NULL;
+}
+
+static inline void fuse_file_passthrough_release(struct fuse_file *ff)
+{
+	fuse_passthrough_release(&ff->passthrough);
+}
+#else
+static inline int fuse_passthrough_open(struct fuse_conn *fc, int fd)
+{
+	return -ENOTTY;
+}
+static inline void fuse_passthrough_setup(struct fuse_conn *fc,
+					  struct fuse_file *ff,
+					  struct fuse_open_out *openarg) { }
+static inline void fuse_passthrough_destroy(struct fuse_conn *fc) { }
+static inline ssize_t fuse_passthrough_read_iter(struct kiocb *iocb,
+						 struct iov_iter *iter)
+{
+	return -EINVAL;
+}
+static inline ssize_t fuse_passthrough_write_iter(struct kiocb *iocb,
+						  struct iov_iter *iter)
+{
+	return -EINVAL;
+}
+static inline int fuse_passthrough_mmap(struct file *file,
+					struct vm_area_struct *vma)
+{
+	return -EINVAL;
+}
+static inline void fuse_passthrough_init(struct fuse_conn *fc) { }
+static inline bool fuse_file_passthrough(struct fuse_file *ff)
+{
+	return false;
+}
+static inline void fuse_file_passthrough_release(struct fuse_file *ff) { }
+#endif
+
 #endif /* _FS_FUSE_I_H */
@@ -0,0 +1,219 @@
+/*
+ * FUSE passthrough: serve reads, writes and mmap of an open FUSE file
+ * straight from a backing file registered by the userspace daemon.
+ *
+ * The daemon opens the backing file itself, registers it with
+ * FUSE_DEV_IOC_PASSTHROUGH_OPEN and returns the resulting id in
+ * fuse_open_out.passthrough_fh. Everything except the data path still
+ * goes through the daemon.
+ *
+ * This program can be distributed under the terms of the GNU GPL.
+ * See the file COPYING.
+ */
+
+#include "fuse_i.h"
+
+#include <linux/file.h>
+#include <linux/idr.h>
+#include <linux/uio.h>
+
+static void fuse_copyattr(struct file *dst_file, struct file *src_file)
+{
+	struct inode *dst = file_inode(dst_file);
+	struct inode *src = file_inode(src_file);
+
+	i_size_write(dst, i_size_read(src));
+}
+
+ssize_t fuse_passthrough_read_iter(struct kiocb *iocb, struct iov_iter *iter)
+{
+	struct file *fuse_filp = iocb->ki_filp;
+	struct fuse_file *ff = fuse_filp->private_data;
+	struct file *passthrough_filp = ff->passthrough.filp;
+	const struct cred *old_cred;
+	ssize_t ret;
+
+	if (!iov_iter_count(iter))
+		return 0;
+
+	old_cred = override_creds(ff->passthrough.cred);
+	ret = vfs_iter_read(passthrough_filp, iter, &iocb->ki_pos);
+	revert_creds(old_cred);
+
+	if (ret >= 0)
+		file_accessed(fuse_filp);
+	return ret;
+}
+
+ssize_t fuse_passthrough_write_iter(struct kiocb *iocb, struct iov_iter *iter)
+{
+	struct file *fuse_filp = iocb->ki_filp;
+	struct fuse_file *ff = fuse_filp->private_data;
+	struct inode *fuse_inode = file_inode(fuse_filp);
+	struct file *passthrough_filp = ff->passthrough.filp;
+	const struct cred *old_cred;
+	ssize_t ret;
+
+	if (!iov_iter_count(iter))
+		return 0;
+
+	inode_lock(fuse_inode);
+
+	old_cred = override_creds(ff->passthrough.cred);
+	file_start_write(passthrough_filp);
+	ret = vfs_iter_write(passthrough_filp, iter, &iocb->ki_pos);
+	file_end_write(passthrough_filp);
+	revert_creds(old_cred);
+
+	if (ret > 0) {
+		fuse_copyattr(fuse_filp, passthrough_filp);
+		fuse_invalidate_attr(fuse_inode);
+	}
+
+	inode_unlock(fuse_inode);
+	return ret;
+}
+
+int fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct fuse_file *ff = file->private_data;
+	struct file *passthrough_filp = ff->passthrough.filp;
+	const struct cred *old_cred;
+	int ret;
+
+	if (!passthrough_filp->f_op->mmap)
+		return -ENODEV;
+	if (WARN_ON(file != vma->vm_file))
+		return -EIO;
+
+	vma->vm_file = get_file(passthrough_filp);
+
+	old_cred = override_creds(ff->passthrough.cred);
+	ret = passthrough_filp->f_op->mmap(passthrough_filp, vma);
+	revert_creds(old_cred);
+
+	if (ret) {
+		/* drop the reference taken for the backing file */
+		fput(passthrough_filp);
+		vma->vm_file = file;
+	} else {
+		/* the vma now holds the backing file instead */
+		fput(file);
+	}
+
+	file_accessed(file);
+	return ret;
+}
+
+/*
+ * Register @fd as a backing file. Returns the id for
+ * fuse_open_out.passthrough_fh or a negative error.
+ */
+int fuse_passthrough_open(struct fuse_conn *fc, int fd)
+{
+	struct fuse_passthrough *passthrough;
+	struct file *passthrough_filp;
+	struct super_block *passthrough_sb;
+	int res;
+
+	if (!fc->passthrough)
+		return -EPERM;
+
+	passthrough_filp = fget(fd);
+	if (!passthrough_filp)
+		return -EBADF;
+
+	res = -EINVAL;
+	if (!passthrough_filp->f_op->read_iter ||
+	    !passthrough_filp->f_op->write_iter)
+		goto out_fput;
+
+	passthrough_sb = file_inode(passthrough_filp)->i_sb;
+	if (passthrough_sb->s_stack_depth >= FILESYSTEM_MAX_STACK_DEPTH)
+		goto out_fput;
+
+	res = -ENOMEM;
+	passthrough = kmalloc(sizeof(*passthrough), GFP_KERNEL);
+	if (!passthrough)
+		goto out_fput;
+
+	passthrough->filp = passthrough_filp;
+	passthrough->cred = prepare_creds();
+	if (!passthrough->cred)
+		goto out_free;
+
+	idr_preload(GFP_KERNEL);
+	spin_lock(&fc->passthrough_req_lock);
+	res = idr_alloc(&fc->passthrough_req, passthrough, 1, 0, GFP_ATOMIC);
+	spin_unlock(&fc->passthrough_req_lock);
+	idr_preload_end();
+	if (res > 0)
+		return res;
+
+	put_cred(passthrough->cred);
+out_free:
+	kfree(passthrough);
+out_fput:
+	fput(passthrough_filp);
+	return res;
+}
+
+/*
+ * Attach the backing file registered as @openarg->passthrough_fh to @ff.
+ * The registration is consumed either way; on failure the file simply
+ * keeps going through the daemon.
+ */
+void fuse_passthrough_setup(struct fuse_conn *fc, struct fuse_file *ff,
+			    struct fuse_open_out *openarg)
+{
+	struct fuse_passthrough *passthrough;
+	int id = openarg->passthrough_fh;
+
+	if (!fc->passthrough || id <= 0)
+		return;
+
+	spin_lock(&fc->passthrough_req_lock);
+	passthrough = idr_find(&fc->passthrough_req, id);
+	if (passthrough)
+		idr_remove(&fc->passthrough_req, id);
+	spin_unlock(&fc->passthrough_req_lock);
+
+	if (!passthrough)
+		return;
+
+	/* direct_io files bypass read_iter/write_iter of fuse_file_operations */
+	if (ff->open_flags & FOPEN_DIRECT_IO) {
+		fuse_passthrough_release(passthrough);
+		kfree(passthrough);
+		return;
+	}
+
+	ff->passthrough = *passthrough;
+	kfree(passthrough);
+}
+
+void fuse_passthrough_release(struct fuse_passthrough *passthrough)
+{
+	if (passthrough->filp) {
+		fput(passthrough->filp);
+		passthrough->filp = NULL;
+	}
+	if (passthrough->cred) {
+		put_cred(passthrough->cred);
+		passthrough->cred = NULL;
+	}
+}
+
+static int fuse_passthrough_free_req(int id, void *p, void *data)
+{
+	fuse_passthrough_release(p);
+	kfree(p);
+	return 0;
+}
+
+/* drop backing files registered but never claimed by an open */
+void fuse_passthrough_destroy(struct fuse_conn *fc)
+{
+	idr_for_each(&fc->passthrough_req, fuse_passthrough_free_req, NULL);
+	idr_destroy(&fc->passthrough_req);
+}
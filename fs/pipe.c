@@ -122,18 +122,42 @@ void pipe_wait(struct pipe_inode_info *pipe)
 	pipe_lock(pipe);
 }
 
+/*
+ * Pipes enlarged with F_SETPIPE_SZ are the ones streaming a lot of data,
+ * so let them keep more released pages around, one more per default
+ * sized pipe worth of buffers. Their buffers are already charged to the
+ * user, the cached pages can never exceed that.
+ */
+static inline unsigned int pipe_tmp_pages_max(struct pipe_inode_info *pipe)
+{
+	return clamp_t(unsigned int, pipe->buffers / PIPE_DEF_BUFFERS,
+		       1, PIPE_TMP_PAGES_MAX);
+}
+
+static void pipe_trim_tmp_pages(struct pipe_inode_info *pipe,
+				unsigned int nr)
+{
+	while (pipe->nr_tmp_pages > nr) {
+		unsigned int i = --pipe->nr_tmp_pages;
+
+		__free_page(pipe->tmp_pages[i]);
+		pipe->tmp_pages[i] = NULL;
+	}
+}
+
 static void anon_pipe_buf_release(struct pipe_inode_info *pipe,
 				  struct pipe_buffer *buf)
 {
 	struct page *page = buf->page;
 
 	/*
-	 * If nobody else uses this page, and we don't already have a
-	 * temporary page, let's keep track of it as a one-deep
-	 * allocation cache. (Otherwise just release our reference to it)
+	 * If nobody else uses this page, and the cache of temporary pages
+	 * is not full, keep it for the next write. (Otherwise just release
+	 * our reference to it)
 	 */
-	if (page_count(page) == 1 && !pipe->tmp_page)
-		pipe->tmp_page = page;
+	if (page_count(page) == 1 &&
+	    pipe->nr_tmp_pages < pipe_tmp_pages_max(pipe))
+		pipe->tmp_pages[pipe->nr_tmp_pages++] = page;
 	else
 		put_page(page);
 }
@@ -427,17 +451,18 @@ pipe_write(struct kiocb *iocb, struct iov_iter *from)
 		if (bufs < pipe->buffers) {
 			int newbuf = (pipe->curbuf + bufs) & (pipe->buffers-1);
 			struct pipe_buffer *buf = pipe->bufs + newbuf;
-			struct page *page = pipe->tmp_page;
+			struct page *page;
 			int copied;
 
-			if (!page) {
+			if (!pipe->nr_tmp_pages) {
 				page = alloc_page(GFP_HIGHUSER | __GFP_ACCOUNT);
 				if (unlikely(!page)) {
 					ret = ret ? : -ENOMEM;
 					break;
 				}
-				pipe->tmp_page = page;
+				pipe->tmp_pages[pipe->nr_tmp_pages++] = page;
 			}
+			page = pipe->tmp_pages[pipe->nr_tmp_pages - 1];
 			/* Always wake up, even if the copy fails. Otherwise
 			 * we lock up (O_NONBLOCK-)readers that sleep due to
 			 * syscall merging.
@@ -463,7 +488,7 @@ pipe_write(struct kiocb *iocb, struct iov_iter *from)
 				buf->flags = PIPE_BUF_FLAG_PACKET;
 			}
 			pipe->nrbufs = ++bufs;
-			pipe->tmp_page = NULL;
+			pipe->tmp_pages[--pipe->nr_tmp_pages] = NULL;
 
 			if (!iov_iter_count(from))
 				break;
@@ -691,8 +716,7 @@ void free_pipe_info(struct pipe_inode_info *pipe)
 		if (buf->ops)
 			pipe_buf_release(pipe, buf);
 	}
-	if (pipe->tmp_page)
-		__free_page(pipe->tmp_page);
+	pipe_trim_tmp_pages(pipe, 0);
 	kfree(pipe->bufs);
 	kfree(pipe);
 }
@@ -1136,6 +1160,7 @@ static long pipe_set_size(struct pipe_inode_info *pipe, unsigned long arg)
 	kfree(pipe->bufs);
 	pipe->bufs = bufs;
 	pipe->buffers = nr_pages;
+	pipe_trim_tmp_pages(pipe, pipe_tmp_pages_max(pipe));
 	return nr_pages * PAGE_SIZE;
 
 out_revert_acct:
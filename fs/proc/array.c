@@ -667,6 +667,55 @@ int proc_pid_statlmkd(struct seq_file *m, struct pid_namespace *ns,
 
 	return 0;
 }
+
+/*
+ * Memory summary for memory policy decisions, built from the counters the
+ * mm keeps up to date anyway: unlike smaps_rollup it walks no page table,
+ * so it is cheap enough to poll for every process. SwapResident estimates
+ * the compressed size of the swapped out pages, as in statlmkd.
+ */
+int proc_pid_memsummary(struct seq_file *m, struct pid_namespace *ns,
+			struct pid *pid, struct task_struct *task)
+{
+	struct mm_struct *mm = get_task_mm(task);
+	unsigned long anon, file, shmem, swap, ptes;
+	unsigned long swapresident = 0;
+
+	if (!mm)
+		return 0;
+
+	anon = get_mm_counter(mm, MM_ANONPAGES);
+	file = get_mm_counter(mm, MM_FILEPAGES);
+	shmem = get_mm_counter(mm, MM_SHMEMPAGES);
+	swap = get_mm_counter(mm, MM_SWAPENTS);
+	ptes = PTRS_PER_PTE * sizeof(pte_t) * atomic_long_read(&mm->nr_ptes);
+#ifdef CONFIG_MMU
+	{
+		unsigned long size, resident;
+
+		task_statlmkd(mm, &size, &resident, &swapresident);
+	}
+#endif
+	mmput(mm);
+
+	seq_printf(m,
+		"Rss:\t%8lu kB\n"
+		"RssAnon:\t%8lu kB\n"
+		"RssFile:\t%8lu kB\n"
+		"RssShmem:\t%8lu kB\n"
+		"Swap:\t%8lu kB\n"
+		"SwapResident:\t%8lu kB\n"
+		"PageTables:\t%8lu kB\n",
+		(anon + file + shmem) << (PAGE_SHIFT-10),
+		anon << (PAGE_SHIFT-10),
+		file << (PAGE_SHIFT-10),
+		shmem << (PAGE_SHIFT-10),
+		swap << (PAGE_SHIFT-10),
+		swapresident << (PAGE_SHIFT-10),
+		ptes >> 10);
+
+	return 0;
+}
 #ifdef CONFIG_PROC_CHILDREN
 static struct pid *
 get_children_pid(struct inode *inode, struct pid *pid_prev, loff_t pos)
@@ -1338,6 +1338,157 @@ const struct file_operations proc_clear_refs_operations = {
 	.llseek		= noop_llseek,
 };
 
+#ifdef CONFIG_PROCESS_RECLAIM
+enum reclaim_type {
+	RECLAIM_FILE,
+	RECLAIM_ANON,
+	RECLAIM_ALL,
+};
+
+struct reclaim_private {
+	enum reclaim_type type;
+	unsigned long nr_to_reclaim;
+	unsigned long nr_reclaimed;
+};
+
+static int reclaim_pte_range(pmd_t *pmd, unsigned long addr,
+				unsigned long end, struct mm_walk *walk)
+{
+	struct reclaim_private *rp = walk->private;
+	struct vm_area_struct *vma = walk->vma;
+	pte_t *orig_pte, *pte, ptent;
+	spinlock_t *ptl;
+	struct page *page;
+	LIST_HEAD(page_list);
+	unsigned long isolated;
+
+	split_huge_pmd(vma, pmd, addr);
+	if (pmd_trans_unstable(pmd))
+		return 0;
+cont:
+	isolated = 0;
+	orig_pte = pte = pte_offset_map_lock(vma->vm_mm, pmd, addr, &ptl);
+	for (; addr != end; pte++, addr += PAGE_SIZE) {
+		ptent = *pte;
+		if (!pte_present(ptent))
+			continue;
+
+		page = vm_normal_page(vma, addr, ptent);
+		if (!page)
+			continue;
+
+		/* leave pages other processes still use alone */
+		if (page_mapcount(page) != 1)
+			continue;
+
+		if (isolate_lru_page(page))
+			continue;
+
+		list_add(&page->lru, &page_list);
+		inc_node_page_state(page, NR_ISOLATED_ANON +
+				page_is_file_cache(page));
+		isolated++;
+		if (isolated >= SWAP_CLUSTER_MAX ||
+		    rp->nr_reclaimed + isolated >= rp->nr_to_reclaim) {
+			pte++;
+			addr += PAGE_SIZE;
+			break;
+		}
+	}
+	pte_unmap_unlock(orig_pte, ptl);
+
+	rp->nr_reclaimed += reclaim_pages_from_list(&page_list);
+	if (rp->nr_reclaimed >= rp->nr_to_reclaim)
+		return 1;
+	if (fatal_signal_pending(current))
+		return -EINTR;
+	cond_resched();
+	if (addr != end)
+		goto cont;
+
+	return 0;
+}
+
+static int reclaim_test_walk(unsigned long start, unsigned long end,
+				struct mm_walk *walk)
+{
+	struct reclaim_private *rp = walk->private;
+	struct vm_area_struct *vma = walk->vma;
+
+	if (vma->vm_flags & (VM_LOCKED | VM_PFNMAP | VM_HUGETLB))
+		return 1;
+	if (rp->type == RECLAIM_ANON && !vma_is_anonymous(vma))
+		return 1;
+	if (rp->type == RECLAIM_FILE && vma_is_anonymous(vma))
+		return 1;
+	return 0;
+}
+
+/*
+ * "file", "anon" or "all", optionally followed by the maximum number of
+ * pages to reclaim.
+ */
+static ssize_t reclaim_write(struct file *file, const char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	struct task_struct *task;
+	char buffer[32];
+	char *type_buf, *nr_buf;
+	struct mm_struct *mm;
+	struct reclaim_private rp = {
+		.nr_to_reclaim = ULONG_MAX,
+	};
+	struct mm_walk reclaim_walk = {
+		.pmd_entry = reclaim_pte_range,
+		.test_walk = reclaim_test_walk,
+		.private = &rp,
+	};
+
+	memset(buffer, 0, sizeof(buffer));
+	if (count > sizeof(buffer) - 1)
+		count = sizeof(buffer) - 1;
+	if (copy_from_user(buffer, buf, count))
+		return -EFAULT;
+
+	nr_buf = strstrip(buffer);
+	type_buf = strsep(&nr_buf, " ");
+	if (!strcmp(type_buf, "file"))
+		rp.type = RECLAIM_FILE;
+	else if (!strcmp(type_buf, "anon"))
+		rp.type = RECLAIM_ANON;
+	else if (!strcmp(type_buf, "all"))
+		rp.type = RECLAIM_ALL;
+	else
+		return -EINVAL;
+
+	if (nr_buf && (kstrtoul(skip_spaces(nr_buf), 10, &rp.nr_to_reclaim) ||
+			!rp.nr_to_reclaim))
+		return -EINVAL;
+
+	task = get_proc_task(file_inode(file));
+	if (!task)
+		return -ESRCH;
+
+	mm = get_task_mm(task);
+	if (mm) {
+		reclaim_walk.mm = mm;
+		lru_add_drain();
+		down_read(&mm->mmap_sem);
+		walk_page_range(0, mm->highest_vm_end, &reclaim_walk);
+		up_read(&mm->mmap_sem);
+		mmput(mm);
+	}
+	put_task_struct(task);
+
+	return count;
+}
+
+const struct file_operations proc_reclaim_operations = {
+	.write		= reclaim_write,
+	.llseek		= noop_llseek,
+};
+#endif
+
 typedef struct {
 	u64 pme;
 } pagemap_entry_t;
@@ -21,6 +21,45 @@
 #include "sdcardfs.h"
 #include "linux/ctype.h"
 
+atomic_t sdcardfs_d_gen = ATOMIC_INIT(1);
+
+/*
+ * A dentry that passed a full revalidation stays valid for as long as
+ * its lower dentry is neither unhashed nor moved, both of which bump the
+ * lower d_seq, and nothing bumped sdcardfs_d_gen (package list updates,
+ * abandoned top data). That can be checked without taking any reference,
+ * so it also works in rcu-walk mode.
+ */
+static bool sdcardfs_d_revalidate_cached(struct dentry *dentry)
+{
+	struct sdcardfs_dentry_info *info = READ_ONCE(dentry->d_fsdata);
+	struct dentry *lower_dentry;
+
+	if (!info)
+		return false;
+	if (READ_ONCE(info->d_gen) != atomic_read(&sdcardfs_d_gen))
+		return false;
+	/* obb grafts compare paths in is_obbpath_invalid() */
+	if (READ_ONCE(info->orig_path.dentry))
+		return false;
+	lower_dentry = READ_ONCE(info->lower_path.dentry);
+	if (!lower_dentry || (lower_dentry->d_flags & DCACHE_OP_REVALIDATE))
+		return false;
+	return !read_seqcount_retry(&lower_dentry->d_seq,
+					READ_ONCE(info->lower_seq));
+}
+
+static void sdcardfs_d_revalidate_done(struct dentry *dentry, int gen,
+						unsigned int seq)
+{
+	struct sdcardfs_dentry_info *info = SDCARDFS_D(dentry);
+
+	if (has_graft_path(dentry))
+		return;
+	WRITE_ONCE(info->lower_seq, seq);
+	WRITE_ONCE(info->d_gen, gen);
+}
+
 
 /*
  * returns: -ERRNO if error (returned to user)
@@ -37,6 +76,11 @@ static int sdcardfs_d_revalidate(struct dentry *dentry, unsigned int flags)
 	struct dentry *lower_dentry = NULL;
 	struct inode *inode;
 	struct sdcardfs_inode_data *data;
+	unsigned int lower_seq;
+	int gen;
+
+	if (sdcardfs_d_revalidate_cached(dentry))
+		return 1;
 
 	if (flags & LOOKUP_RCU)
 		return -ECHILD;
@@ -62,6 +106,10 @@ static int sdcardfs_d_revalidate(struct dentry *dentry, unsigned int flags)
 	lower_dentry = lower_path.dentry;
 	lower_cur_parent_dentry = dget_parent(lower_dentry);
 
+	/* sample before checking, so any change after this fails the cache */
+	gen = atomic_read(&sdcardfs_d_gen);
+	lower_seq = raw_seqcount_begin(&lower_dentry->d_seq);
+
 	if ((lower_dentry->d_flags & DCACHE_OP_REVALIDATE)) {
 		err = lower_dentry->d_op->d_revalidate(lower_dentry, flags);
 		if (err == 0) {
@@ -116,6 +164,8 @@ static int sdcardfs_d_revalidate(struct dentry *dentry, unsigned int flags)
 		iput(inode);
 	}
 
+	if (err == 1)
+		sdcardfs_d_revalidate_done(dentry, gen, lower_seq);
 out:
 	dput(parent_dentry);
 	dput(lower_cur_parent_dentry);
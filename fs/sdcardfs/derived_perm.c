@@ -146,8 +146,8 @@ void get_derived_permission_inode_new(struct dentry *parent,
 	case PERM_ANDROID_DATA:
 	case PERM_ANDROID_MEDIA:
 		info->data->perm = PERM_ANDROID_PACKAGE;
-		appid = get_appid(name->name);
-		if (appid != 0 && !is_excluded(name->name, parent_data->userid))
+		appid = get_appid_for_user(name->name, parent_data->userid);
+		if (appid != 0)
 			info->data->d_uid =
 				multiuser_get_uid(parent_data->userid, appid);
 		set_top(info, info->data);
@@ -185,8 +185,8 @@ void get_derived_permission_inode_new(struct dentry *parent,
 		break;
 	case PERM_KNOX_ANDROID_DATA:
 		info->data->perm = PERM_KNOX_ANDROID_PACKAGE;
-		appid = get_appid(name->name);
-		if (appid != 0 && !is_excluded(name->name, parent_data->userid))
+		appid = get_appid_for_user(name->name, parent_data->userid);
+		if (appid != 0)
 			info->data->d_uid =
 				multiuser_get_uid(parent_data->userid, appid);
 		set_top(info, info->data);
@@ -385,6 +385,7 @@ static void __fixup_perms_recursive(struct dentry *dentry, struct limit_search *
 
 void fixup_perms_recursive(struct dentry *dentry, struct limit_search *limit)
 {
+	sdcardfs_d_gen_bump();
 	__fixup_perms_recursive(dentry, limit, 0);
 }
 
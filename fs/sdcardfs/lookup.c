@@ -36,15 +36,27 @@ int sdcardfs_init_dentry_cache(void)
 
 void sdcardfs_destroy_dentry_cache(void)
 {
+	/* wait for free_dentry_private_data() callbacks */
+	rcu_barrier();
 	kmem_cache_destroy(sdcardfs_dentry_cachep);
 }
 
+static void free_dentry_private_data_rcu(struct rcu_head *head)
+{
+	kmem_cache_free(sdcardfs_dentry_cachep,
+			container_of(head, struct sdcardfs_dentry_info, rcu));
+}
+
+/* rcu-walk revalidation may still be looking at it */
 void free_dentry_private_data(struct dentry *dentry)
 {
+	struct sdcardfs_dentry_info *info;
+
 	if (!dentry || !dentry->d_fsdata)
 		return;
-	kmem_cache_free(sdcardfs_dentry_cachep, dentry->d_fsdata);
+	info = dentry->d_fsdata;
 	dentry->d_fsdata = NULL;
+	call_rcu(&info->rcu, free_dentry_private_data_rcu);
 }
 
 /* allocate new dentry private data */
@@ -36,6 +36,7 @@ struct hashtable_entry {
 	struct hlist_node dlist; /* for deletion cleanup */
 	struct qstr key;
 	atomic_t value;
+	struct rcu_head rcu;
 };
 
 static DEFINE_HASHTABLE(package_to_appid, 8);
@@ -145,6 +146,23 @@ appid_t is_excluded(const char *key, userid_t user)
 	return __is_excluded(&q, user);
 }
 
+/*
+ * get_appid() and is_excluded() in one go, so the name is only hashed
+ * once on the lookup path. Returns 0 when the package is unknown or
+ * excluded for @user.
+ */
+appid_t get_appid_for_user(const char *key, userid_t user)
+{
+	struct qstr q;
+	appid_t appid;
+
+	qstr_init(&q, key);
+	appid = __get_appid(&q);
+	if (appid && __is_excluded(&q, user))
+		return 0;
+	return appid;
+}
+
 /* Kernel has already enforced everything we returned through
  * derive_permissions_locked(), so this is used to lock down access
  * even further, such as enforcing that apps hold sdcard_rw.
@@ -332,29 +350,37 @@ static void free_hashtable_entry(struct hashtable_entry *entry)
 	kmem_cache_free(hashtable_entry_cachep, entry);
 }
 
+static void free_hashtable_entry_rcu(struct rcu_head *head)
+{
+	free_hashtable_entry(container_of(head, struct hashtable_entry, rcu));
+}
+
+/*
+ * Removals run under sdcardfs_super_list_lock, which every lookup that
+ * derives permissions also needs, so don't hold it across a grace period.
+ */
+static void remove_hashtable_entry_locked(struct hashtable_entry *entry)
+{
+	hash_del_rcu(&entry->hlist);
+	call_rcu(&entry->rcu, free_hashtable_entry_rcu);
+}
+
 static void remove_packagelist_entry_locked(const struct qstr *key)
 {
 	struct hashtable_entry *hash_cur;
-	unsigned int hash = key->hash;
 	struct hlist_node *h_t;
-	HLIST_HEAD(free_list);
+	unsigned int hash = key->hash;
 
-	hash_for_each_possible_rcu(package_to_userid, hash_cur, hlist, hash) {
-		if (qstr_case_eq(key, &hash_cur->key)) {
-			hash_del_rcu(&hash_cur->hlist);
-			hlist_add_head(&hash_cur->dlist, &free_list);
-		}
+	hash_for_each_possible_safe(package_to_userid, hash_cur, h_t, hlist, hash) {
+		if (qstr_case_eq(key, &hash_cur->key))
+			remove_hashtable_entry_locked(hash_cur);
 	}
-	hash_for_each_possible_rcu(package_to_appid, hash_cur, hlist, hash) {
+	hash_for_each_possible_safe(package_to_appid, hash_cur, h_t, hlist, hash) {
 		if (qstr_case_eq(key, &hash_cur->key)) {
-			hash_del_rcu(&hash_cur->hlist);
-			hlist_add_head(&hash_cur->dlist, &free_list);
+			remove_hashtable_entry_locked(hash_cur);
 			break;
 		}
 	}
-	synchronize_rcu();
-	hlist_for_each_entry_safe(hash_cur, h_t, &free_list, dlist)
-		free_hashtable_entry(hash_cur);
 }
 
 static void remove_packagelist_entry(const struct qstr *key)
@@ -372,9 +398,7 @@ static void remove_ext_gid_entry_locked(const struct qstr *key, gid_t group)
 
 	hash_for_each_possible_rcu(ext_to_groupid, hash_cur, hlist, hash) {
 		if (qstr_case_eq(key, &hash_cur->key) && atomic_read(&hash_cur->value) == group) {
-			hash_del_rcu(&hash_cur->hlist);
-			synchronize_rcu();
-			free_hashtable_entry(hash_cur);
+			remove_hashtable_entry_locked(hash_cur);
 			break;
 		}
 	}
@@ -391,18 +415,11 @@ static void remove_userid_all_entry_locked(userid_t userid)
 {
 	struct hashtable_entry *hash_cur;
 	struct hlist_node *h_t;
-	HLIST_HEAD(free_list);
 	int i;
 
-	hash_for_each_rcu(package_to_userid, i, hash_cur, hlist) {
-		if (atomic_read(&hash_cur->value) == userid) {
-			hash_del_rcu(&hash_cur->hlist);
-			hlist_add_head(&hash_cur->dlist, &free_list);
-		}
-	}
-	synchronize_rcu();
-	hlist_for_each_entry_safe(hash_cur, h_t, &free_list, dlist) {
-		free_hashtable_entry(hash_cur);
+	hash_for_each_safe(package_to_userid, i, h_t, hash_cur, hlist) {
+		if (atomic_read(&hash_cur->value) == userid)
+			remove_hashtable_entry_locked(hash_cur);
 	}
 }
 
@@ -422,9 +439,7 @@ static void remove_userid_exclude_entry_locked(const struct qstr *key, userid_t
 	hash_for_each_possible_rcu(package_to_userid, hash_cur, hlist, hash) {
 		if (qstr_case_eq(key, &hash_cur->key) &&
 				atomic_read(&hash_cur->value) == userid) {
-			hash_del_rcu(&hash_cur->hlist);
-			synchronize_rcu();
-			free_hashtable_entry(hash_cur);
+			remove_hashtable_entry_locked(hash_cur);
 			break;
 		}
 	}
@@ -877,5 +892,7 @@ void packagelist_exit(void)
 {
 	configfs_sdcardfs_exit();
 	packagelist_destroy();
+	/* wait for entries freed by call_rcu() */
+	rcu_barrier();
 	kmem_cache_destroy(hashtable_entry_cachep);
 }
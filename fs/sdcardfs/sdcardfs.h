@@ -218,6 +218,10 @@ struct sdcardfs_dentry_info {
 	spinlock_t lock;	/* protects lower_path */
 	struct path lower_path;
 	struct path orig_path;
+	/* last successful revalidation, see sdcardfs_d_revalidate() */
+	int d_gen;
+	unsigned int lower_seq;
+	struct rcu_head rcu;
 };
 
 struct sdcardfs_mount_options {
@@ -411,6 +415,17 @@ static inline void data_put(struct sdcardfs_inode_data *data)
 	kref_put(&data->refcount, data_release);
 }
 
+/*
+ * Bumped whenever a cached dentry may need a full revalidation for
+ * reasons not visible on its lower dentry.
+ */
+extern atomic_t sdcardfs_d_gen;
+
+static inline void sdcardfs_d_gen_bump(void)
+{
+	atomic_inc(&sdcardfs_d_gen);
+}
+
 static inline void release_own_data(struct sdcardfs_inode_info *info)
 {
 	/*
@@ -421,6 +436,7 @@ static inline void release_own_data(struct sdcardfs_inode_info *info)
 	BUG_ON(info->data->abandoned == true);
 
 	info->data->abandoned = true;
+	sdcardfs_d_gen_bump();
 	data_put(info->data);
 }
 
@@ -543,6 +559,7 @@ extern struct list_head sdcardfs_super_list;
 extern appid_t get_appid(const char *app_name);
 extern appid_t get_ext_gid(const char *app_name);
 extern appid_t is_excluded(const char *app_name, userid_t userid);
+extern appid_t get_appid_for_user(const char *app_name, userid_t userid);
 extern int check_caller_access_to_name(struct inode *parent_node, const struct qstr *name);
 extern int packagelist_init(void);
 extern void packagelist_exit(void);
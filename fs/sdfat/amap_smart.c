@@ -459,6 +459,9 @@ int amap_create(struct super_block *sb, u32 pack_ratio, u32 sect_per_au, u32 hid
 	amap->cur_cold.au = NULL;
 	amap->cur_hot.au = NULL;
 	amap->n_need_packing = 0;
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	amap->cur_stream.au = NULL;
+#endif
 
 
 	/* Build AMAP info */
@@ -734,6 +737,41 @@ static inline AU_INFO_T *amap_get_packing_au(AMAP_T *amap, int dest, int num_to_
 }
 
 
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+/* Streaming AU:
+ * Only a clean AU is taken, and nobody else allocates from a working AU,
+ * so every cluster from cur_stream.idx to the end of the AU is free.
+ * Returns NULL if there is no clean AU left.
+ */
+static inline TARGET_AU_T *amap_get_stream_au(AMAP_T *amap)
+{
+	AU_INFO_T *au;
+
+	if (amap->cur_stream.au &&
+		(amap->cur_stream.idx < amap->clusters_per_au) &&
+		(amap->cur_stream.au->free_clusters > 0))
+		return &amap->cur_stream;
+
+	au = amap_pop_cold_au_largest(amap, amap->clusters_per_au);
+	if (!au)
+		return NULL;
+
+	if (au->free_clusters != amap->clusters_per_au) {
+		/* Not clean: put it back */
+		amap_add_cold_au(amap, au);
+		return NULL;
+	}
+
+	MMSG("AMAP: new stream AU(%d)\n", au->idx);
+
+	SET_AU_WORKING(au);
+	amap->cur_stream.au = au;
+	amap->cur_stream.idx = 0;
+	amap->cur_stream.clu_to_skip = 0;
+	return &amap->cur_stream;
+}
+#endif
+
 /* Pick a target AU:
  * This function should be called
  * only if there are one or more free clusters in the bdev.
@@ -780,6 +818,18 @@ TARGET_AU_T *amap_get_target_au(AMAP_T *amap, int dest, int num_to_wb)
 		return &amap->cur_hot;
 	}
 
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	if (dest == ALLOC_COLD_STREAM) {
+		TARGET_AU_T *cur = amap_get_stream_au(amap);
+
+		if (cur)
+			return cur;
+
+		/* No clean AU: share the ordinary cold AU */
+		dest = ALLOC_COLD_ALIGNED;
+	}
+#endif
+
 	/* Cold allocation:
 	 * If amap->cur_cold.au has one or more free cluster(s),
 	 * then just return amap->cur_cold
@@ -921,6 +971,12 @@ void amap_put_target_au(AMAP_T *amap, TARGET_AU_T *cur, unsigned int num_allocat
 
 			// cur->au = NULL;	// This value will be used for the next AU selection
 			cur->idx = amap->clusters_per_au;	// AU closing
+
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+			/* Write back the FAT of a whole streaming AU at once */
+			if (cur == &amap->cur_stream)
+				fcache_flush(amap->sb, 0);
+#endif
 		}
 	}
 
@@ -975,6 +1031,67 @@ static inline int amap_skip_cluster(struct super_block *sb, TARGET_AU_T *cur, in
 }
 
 
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+/* Allocate a run of contiguous clusters on the streaming AU.
+ *
+ * The range is checked to be free first, then linked from its tail so that
+ * the chain never reaches an unterminated entry, which writes each FAT entry
+ * once instead of twice (EOF + link) per cluster.
+ * Returns the # of allocated clusters, 0 if the per-cluster path should be
+ * used, or -EIO.
+ */
+static s32 amap_fat_alloc_stream(struct super_block *sb, TARGET_AU_T *cur,
+		u32 num_alloc, CHAIN_T *p_chain, u32 *last_clu)
+{
+	AMAP_T *amap = SDFAT_SB(sb)->fsi.amap;
+	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
+	u32 first, clu, read_clu, n;
+
+	first = CLU_of_i_AU(amap, cur->au->idx, cur->idx);
+	n = min_t(u32, num_alloc, amap->clusters_per_au - cur->idx);
+
+	if ((first < CLUS_BASE) || (first + n > fsi->num_clusters))
+		return 0;
+
+	/* Trust but verify: stop the run at the first used cluster */
+	for (clu = first; clu < first + n; clu++) {
+		if (fat_ent_get(sb, clu, &read_clu))
+			return -EIO;
+		if (!IS_CLUS_FREE(read_clu))
+			break;
+	}
+	n = clu - first;
+	if (!n)
+		return 0;
+
+	clu = first + n - 1;
+	if (fat_ent_set(sb, clu, CLUS_EOF))
+		return -EIO;
+	while (clu > first) {
+		if (fat_ent_set(sb, clu - 1, clu))
+			goto undo;
+		clu--;
+	}
+
+	if (IS_CLUS_EOF(p_chain->dir)) {
+		p_chain->dir = first;
+	} else if (fat_ent_set(sb, *last_clu, first)) {
+		goto undo;
+	}
+	*last_clu = first + n - 1;
+
+	cur->idx += n;
+	cur->au->free_clusters -= n;
+	return n;
+
+undo:
+	/* Not linked yet: release what was written */
+	for (; clu < first + n; clu++)
+		fat_ent_set(sb, clu, CLUS_FREE);
+	return -EIO;
+}
+#endif
+
 /* AMAP-based allocation function for FAT32 */
 s32 amap_fat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p_chain, s32 dest)
 {
@@ -1037,6 +1154,21 @@ s32 amap_fat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p_cha
 	BUG_ON(cur->idx >= amap->clusters_per_au);
 
 	num_allocated_each = 0;
+
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	if (cur == &amap->cur_stream) {
+		s32 n = amap_fat_alloc_stream(sb, cur, num_alloc, p_chain, &last_clu);
+
+		if (n < 0) {
+			ret = n;
+			goto error;
+		}
+		num_allocated_each = n;
+		if (num_allocated_each)
+			goto put_target;
+	}
+#endif
+
 	new_clu = CLU_of_i_AU(amap, target_au->idx, cur->idx);
 
 	do {
@@ -1083,6 +1215,9 @@ s32 amap_fat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p_cha
 			break;
 	} while (num_allocated_each < num_alloc);
 
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+put_target:
+#endif
 	/* Update strategy info */
 	amap_put_target_au(amap, cur, num_allocated_each);
 
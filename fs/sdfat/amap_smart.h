@@ -32,6 +32,7 @@
  * #define ALLOC_COLD_ALIGNED	(1)
  * #define ALLOC_COLD_PACKING	(2)
  * #define ALLOC_COLD_SEQ	(4)
+ * #define ALLOC_COLD_STREAM	(8)
  */
 
 /* Minimum sectors for support AMAP create */
@@ -104,6 +105,10 @@ typedef struct __AMAP_T {
 	TARGET_AU_T cur_cold;
 	TARGET_AU_T cur_hot;
 	int n_need_packing;
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	/* Clean AU reserved for streaming writers (3rd working AU) */
+	TARGET_AU_T cur_stream;
+#endif
 } AMAP_T;
 
 
@@ -301,6 +301,7 @@ typedef struct __FS_INFO_T {
 		cache_ent_t pool[FAT_CACHE_SIZE];
 		cache_ent_t lru_list;
 		cache_ent_t hash_list[FAT_CACHE_HASH_SIZE];
+		cache_ent_t *last_hit;        // checked before walking the hash chain
 	} fcache;
 
 	/* meta cache */
@@ -309,6 +310,7 @@ typedef struct __FS_INFO_T {
 		cache_ent_t lru_list;
 		cache_ent_t keep_list;        // CACHEs in this list will not be kicked by normal lru operations
 		cache_ent_t hash_list[BUF_CACHE_HASH_SIZE];
+		cache_ent_t *last_hit;        // checked before walking the hash chain
 	} dcache;
 } FS_INFO_T;
 
@@ -49,6 +49,7 @@
 #define LOCKBIT         (0x01)
 #define DIRTYBIT        (0x02)
 #define KEEPBIT         (0x04)
+#define REFBIT          (0x08)	/* hit since its last trip through the LRU */
 
 /*----------------------------------------------------------------------*/
 /*  Cache handling function declarations                                */
@@ -96,6 +97,21 @@ static void move_to_lru(cache_ent_t *bp, cache_ent_t *list)
 	push_to_lru(bp, list);
 }
 
+/*
+ * A hit only sets REFBIT, the entry is moved to MRU here when it reaches
+ * the LRU end (second chance). Each step clears one REFBIT, so this ends
+ * after one pass over the list at most.
+ */
+static void age_lru(cache_ent_t *list)
+{
+	cache_ent_t *bp;
+
+	while ((bp = list->prev) != list && (bp->flag & REFBIT)) {
+		bp->flag &= ~(REFBIT);
+		move_to_mru(bp, list);
+	}
+}
+
 static inline s32 __check_hash_valid(cache_ent_t *bp)
 {
 #ifdef DEBUG_HASH_LIST
@@ -190,7 +206,6 @@ static s32 __fcache_ent_discard(struct super_block *sb, cache_ent_t *bp)
 u8 *fcache_getblk(struct super_block *sb, u64 sec)
 {
 	cache_ent_t *bp;
-	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 	u32 page_ra_count = FCACHE_MAX_RA_SIZE >> sb->s_blocksize_bits;
 
 	bp = __fcache_find(sb, sec);
@@ -200,7 +215,7 @@ u8 *fcache_getblk(struct super_block *sb, u64 sec)
 			__fcache_ent_discard(sb, bp);
 			return NULL;
 		}
-		move_to_mru(bp, &fsi->fcache.lru_list);
+		bp->flag |= REFBIT;
 		return bp->bh->b_data;
 	}
 
@@ -305,6 +320,9 @@ s32 meta_cache_init(struct super_block *sb)
 		push_to_mru(&(fsi->dcache.pool[i]), &fsi->dcache.lru_list);
 	}
 
+	fsi->fcache.last_hit = NULL;
+	fsi->dcache.last_hit = NULL;
+
 	/* HASH list */
 	for (i = 0; i < FAT_CACHE_HASH_SIZE; i++) {
 		fsi->fcache.hash_list[i].sec = ~0;
@@ -396,21 +414,29 @@ static cache_ent_t *__fcache_find(struct super_block *sb, u64 sec)
 	cache_ent_t *bp, *hp;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
+	/* FAT chain walks hit the same sector many times in a row */
+	bp = fsi->fcache.last_hit;
+	if (bp && bp->sec == sec)
+		goto found;
+
 	off = (sec + (sec >> fsi->sect_per_clus_bits)) & (FAT_CACHE_HASH_SIZE - 1);
 	hp = &(fsi->fcache.hash_list[off]);
 	for (bp = hp->hash.next; bp != hp; bp = bp->hash.next) {
-		if (bp->sec == sec) {
-			/*
-			 * patch 1.2.4 : for debugging
-			 */
-			WARN(!bp->bh, "[SDFAT] fcache has no bh. "
-					  "It will make system panic.\n");
-
-			touch_buffer(bp->bh);
-			return bp;
-		}
+		if (bp->sec == sec)
+			goto found;
 	}
 	return NULL;
+
+found:
+	/*
+	 * patch 1.2.4 : for debugging
+	 */
+	WARN(!bp->bh, "[SDFAT] fcache has no bh. "
+			  "It will make system panic.\n");
+
+	touch_buffer(bp->bh);
+	fsi->fcache.last_hit = bp;
+	return bp;
 }
 
 static cache_ent_t *__fcache_get(struct super_block *sb)
@@ -418,6 +444,8 @@ static cache_ent_t *__fcache_get(struct super_block *sb)
 	cache_ent_t *bp;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
+	age_lru(&fsi->fcache.lru_list);
+
 	bp = fsi->fcache.lru_list.prev;
 #ifdef CONFIG_SDFAT_DELAYED_META_DIRTY
 	while (bp->flag & DIRTYBIT) {
@@ -552,7 +580,6 @@ static s32 __dcache_ent_discard(struct super_block *sb, cache_ent_t *bp)
 u8 *dcache_getblk(struct super_block *sb, u64 sec)
 {
 	cache_ent_t *bp;
-	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
 	bp = __dcache_find(sb, sec);
 	if (bp) {
@@ -565,7 +592,7 @@ u8 *dcache_getblk(struct super_block *sb, u64 sec)
 		}
 
 		if (!(bp->flag & KEEPBIT))	// already in keep list
-			move_to_mru(bp, &fsi->dcache.lru_list);
+			bp->flag |= REFBIT;
 
 		return bp->bh->b_data;
 	}
@@ -761,16 +788,24 @@ static cache_ent_t *__dcache_find(struct super_block *sb, u64 sec)
 	cache_ent_t *bp, *hp;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
+	/* directory scans read every dentry of a sector before moving on */
+	bp = fsi->dcache.last_hit;
+	if (bp && bp->sec == sec)
+		goto found;
+
 	off = (sec + (sec >> fsi->sect_per_clus_bits)) & (BUF_CACHE_HASH_SIZE - 1);
 
 	hp = &(fsi->dcache.hash_list[off]);
 	for (bp = hp->hash.next; bp != hp; bp = bp->hash.next) {
-		if (bp->sec == sec) {
-			touch_buffer(bp->bh);
-			return bp;
-		}
+		if (bp->sec == sec)
+			goto found;
 	}
 	return NULL;
+
+found:
+	touch_buffer(bp->bh);
+	fsi->dcache.last_hit = bp;
+	return bp;
 }
 
 static cache_ent_t *__dcache_get(struct super_block *sb)
@@ -778,6 +813,8 @@ static cache_ent_t *__dcache_get(struct super_block *sb)
 	cache_ent_t *bp;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
+	age_lru(&fsi->dcache.lru_list);
+
 	bp = fsi->dcache.lru_list.prev;
 #ifdef CONFIG_SDFAT_DELAYED_META_DIRTY
 	while (bp->flag & (DIRTYBIT | LOCKBIT)) {
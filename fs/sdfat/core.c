@@ -2182,6 +2182,16 @@ s32 fscore_read_link(struct inode *inode, FILE_ID_T *fid, void *buffer, u64 coun
 	return ret;
 } /* end of fscore_read_link */
 
+/* allocation destination for file data */
+static inline s32 __file_alloc_dest(struct inode *inode)
+{
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	if (SDFAT_I(inode)->stream)
+		return ALLOC_COLD_STREAM;
+#endif
+	return ALLOC_COLD;
+}
+
 /* write data into a opened file */
 s32 fscore_write_link(struct inode *inode, FILE_ID_T *fid, void *buffer, u64 count, u64 *wcount)
 {
@@ -2262,7 +2272,8 @@ s32 fscore_write_link(struct inode *inode, FILE_ID_T *fid, void *buffer, u64 cou
 			new_clu.flags = fid->flags;
 
 			/* (1) allocate a chain of clusters */
-			ret = fsi->fs_func->alloc_cluster(sb, num_alloc, &new_clu, ALLOC_COLD);
+			ret = fsi->fs_func->alloc_cluster(sb, num_alloc, &new_clu,
+						__file_alloc_dest(inode));
 			if (ret)
 				goto err_out;
 
@@ -3237,7 +3248,8 @@ s32 fscore_map_clus(struct inode *inode, u32 clu_offset, u32 *clu, int dest)
 			return -EIO;
 		}
 
-		ret = fsi->fs_func->alloc_cluster(sb, num_to_be_allocated, &new_clu, ALLOC_COLD);
+		ret = fsi->fs_func->alloc_cluster(sb, num_to_be_allocated, &new_clu,
+						__file_alloc_dest(inode));
 		if (ret)
 			return ret;
 
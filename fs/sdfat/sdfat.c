@@ -2270,6 +2270,22 @@ static int sdfat_dbg_ioctl(struct inode *inode, struct file *filp,
 	return -ENOTTY;
 }
 
+static int sdfat_ioctl_set_stream(struct inode *inode, unsigned long arg)
+{
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	if (!S_ISREG(inode->i_mode))
+		return -EINVAL;
+
+	/* Only the smart allocator knows about AUs, a no-op otherwise */
+	__lock_super(inode->i_sb);
+	SDFAT_I(inode)->stream = !!arg;
+	__unlock_super(inode->i_sb);
+	return 0;
+#else
+	return -ENOTTY;
+#endif
+}
+
 static long sdfat_generic_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 {
 	struct inode *inode = file_inode(filp);
@@ -2278,6 +2294,9 @@ static long sdfat_generic_ioctl(struct file *filp, unsigned int cmd, unsigned lo
 	if (cmd == SDFAT_IOCTL_GET_VOLUME_ID)
 		return sdfat_ioctl_volume_id(inode);
 
+	if (cmd == SDFAT_IOCTL_SET_STREAM)
+		return sdfat_ioctl_set_stream(inode, arg);
+
 	err = sdfat_dfr_ioctl(inode, filp, cmd, arg);
 	if (err != -ENOTTY)
 		return err;
@@ -4031,6 +4050,9 @@ static struct inode *sdfat_alloc_inode(struct super_block *sb)
 		return NULL;
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 4, 0)
 	init_rwsem(&ei->truncate_lock);
+#endif
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	ei->stream = 0;
 #endif
 	return &ei->vfs_inode;
 }
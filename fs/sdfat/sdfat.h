@@ -55,6 +55,7 @@
 #define ALLOC_COLD_ALIGNED	(1)
 #define ALLOC_COLD_PACKING	(2)
 #define ALLOC_COLD_SEQ		(4)
+#define ALLOC_COLD_STREAM	(8)    /* AU reserved for streaming writes */
 
 /*
  * sdfat nls lossy flag
@@ -205,6 +206,9 @@ struct sdfat_inode_info {
 #endif
 #ifdef	CONFIG_SDFAT_DFR
 	struct defrag_info dfr_info;
+#endif
+#ifdef CONFIG_SDFAT_AMAP_STREAM
+	int stream;                  /* set by SDFAT_IOCTL_SET_STREAM */
 #endif
 	struct inode vfs_inode;
 };
@@ -157,6 +157,7 @@
 #define SDFAT_IOCTL_DFR_REQ		_IOC(_IOC_NONE, 'E', 0x15, sizeof(u32))
 #define SDFAT_IOCTL_DFR_SPO_FLAG	_IOC(_IOC_NONE, 'E', 0x16, sizeof(u32))
 #define SDFAT_IOCTL_PANIC               _IOC(_IOC_NONE, 'E', 0x17, sizeof(u32))
+#define SDFAT_IOCTL_SET_STREAM		_IOC(_IOC_NONE, 'E', 0x18, sizeof(u32))
 
 /*
  * ioctl command for debugging
@@ -182,8 +182,12 @@ struct shash_alg {
 	int (*import)(struct shash_desc *desc, const void *in);
 	int (*setkey)(struct crypto_shash *tfm, const u8 *key,
 		      unsigned int keylen);
+	int (*finup_mb)(struct shash_desc *desc, const u8 * const data[],
+			unsigned int len, u8 * const outs[],
+			unsigned int num_msgs);
 
 	unsigned int descsize;
+	unsigned int mb_max_msgs;
 
 	/* These fields must match hash_alg_common. */
 	unsigned int digestsize
@@ -924,6 +928,38 @@ int crypto_shash_final(struct shash_desc *desc, u8 *out);
 int crypto_shash_finup(struct shash_desc *desc, const u8 *data,
 		       unsigned int len, u8 *out);
 
+/**
+ * crypto_shash_mb_max_msgs() - obtain the number of messages that
+ *				crypto_shash_finup_mb() can hash at once
+ * @tfm: cipher handle
+ *
+ * Return: 1 if the algorithm has no multi-buffer support, else the
+ *	   largest num_msgs that crypto_shash_finup_mb() accepts
+ */
+static inline unsigned int crypto_shash_mb_max_msgs(struct crypto_shash *tfm)
+{
+	return crypto_shash_alg(tfm)->mb_max_msgs ?: 1;
+}
+
+/**
+ * crypto_shash_finup_mb() - finish several messages sharing a prefix
+ * @desc: operational state holding the common prefix of the messages
+ * @data: the remaining data of each message
+ * @len: length of each entry in @data, the same for all messages
+ * @outs: output buffer of each message
+ * @num_msgs: number of messages, at most crypto_shash_mb_max_msgs()
+ *
+ * This is crypto_shash_finup() on a copy of @desc for each message, done
+ * by the algorithm in one interleaved pass where it supports that. The
+ * state in @desc is not usable afterwards.
+ *
+ * Return: 0 if the message digests were created successfully; < 0 if an
+ *	   error occurred
+ */
+int crypto_shash_finup_mb(struct shash_desc *desc, const u8 * const data[],
+			  unsigned int len, u8 * const outs[],
+			  unsigned int num_msgs);
+
 static inline void shash_desc_zero(struct shash_desc *desc)
 {
 	memzero_explicit(desc,
@@ -44,6 +44,10 @@ struct blk_mq_hw_ctx {
 	unsigned int		queue_num;
 
 	atomic_t		nr_active;
+#ifdef CONFIG_BLK_MQ_FG_LANE
+	atomic_t		nr_bg_active;
+	unsigned int		bg_depth;
+#endif
 
 	struct delayed_work	delay_work;
 
@@ -212,6 +212,7 @@ enum rq_flag_bits {
 	__REQ_PM,		/* runtime pm request */
 	__REQ_HASHED,		/* on IO scheduler merge hash */
 	__REQ_MQ_INFLIGHT,	/* track inflight for MQ */
+	__REQ_MQ_BG,		/* counted as background inflight for MQ */
 	__REQ_NR_BITS,		/* stops here */
 };
 
@@ -258,6 +259,7 @@ enum rq_flag_bits {
 #define REQ_PM			(1ULL << __REQ_PM)
 #define REQ_HASHED		(1ULL << __REQ_HASHED)
 #define REQ_MQ_INFLIGHT		(1ULL << __REQ_MQ_INFLIGHT)
+#define REQ_MQ_BG		(1ULL << __REQ_MQ_BG)
 
 enum req_op {
 	REQ_OP_READ,
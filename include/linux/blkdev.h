@@ -87,6 +87,22 @@ enum rq_cmd_type_bits {
 
 #define BLK_MAX_CDB	16
 
+/*
+ * Points of a request's way from the file system to the device and back,
+ * see CONFIG_BLK_IO_TIMELINE.
+ */
+enum blk_io_stage {
+	BLK_IO_SUBMIT,		/* request built from the first bio */
+	BLK_IO_INSERT,		/* added to the I/O scheduler */
+	BLK_IO_DISPATCH,	/* handed to the driver */
+	BLK_IO_QUEUECMD,	/* entered the host driver */
+	BLK_IO_CRYPT,		/* PRDT and inline crypto set up */
+	BLK_IO_DOORBELL,	/* doorbell rung */
+	BLK_IO_IRQ,		/* completion seen in the interrupt */
+	BLK_IO_DONE,		/* all bios ended */
+	BLK_IO_NR_STAGES,
+};
+
 /*
  * Try to put the fields that are referenced together in the same cacheline.
  *
@@ -207,6 +223,12 @@ struct request {
 
 	ktime_t			lat_hist_io_start;
 	int			lat_hist_enabled;
+#ifdef CONFIG_BLK_IO_TIMELINE
+	u64			io_stamp[BLK_IO_NR_STAGES];
+	/* position and size at dispatch, both are consumed by completion */
+	sector_t		io_stamp_sector;
+	unsigned int		io_stamp_bytes;
+#endif
 };
 
 #define REQ_OP_SHIFT (8 * sizeof(u64) - REQ_OP_BITS)
@@ -1790,6 +1812,39 @@ blk_update_latency_hist(struct io_latency_state *s, u_int64_t delta_us)
 ssize_t blk_latency_hist_show(char* name, struct io_latency_state *s,
 		char *buf, int buf_size);
 
+#ifdef CONFIG_BLK_IO_TIMELINE
+static inline void blk_rq_io_stamp(struct request *rq, enum blk_io_stage stage)
+{
+	if (!rq)
+		return;
+
+	rq->io_stamp[stage] = sched_clock();
+	if (stage == BLK_IO_DISPATCH) {
+		rq->io_stamp_sector = blk_rq_pos(rq);
+		rq->io_stamp_bytes = blk_rq_bytes(rq);
+	}
+}
+
+static inline void blk_rq_io_timeline_init(struct request *rq)
+{
+	memset(rq->io_stamp, 0, sizeof(rq->io_stamp));
+}
+
+void blk_rq_io_timeline_done(struct request *rq);
+#else
+static inline void blk_rq_io_stamp(struct request *rq, enum blk_io_stage stage)
+{
+}
+
+static inline void blk_rq_io_timeline_init(struct request *rq)
+{
+}
+
+static inline void blk_rq_io_timeline_done(struct request *rq)
+{
+}
+#endif
+
 #else /* CONFIG_BLOCK */
 
 struct block_device;
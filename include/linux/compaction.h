@@ -92,6 +92,11 @@ extern int sysctl_extfrag_handler(struct ctl_table *table, int write,
 extern int sysctl_compact_unevictable_allowed;
 
 extern int fragmentation_index(struct zone *zone, unsigned int order);
+#ifdef CONFIG_COMPACTION_PROACTIVE
+extern unsigned int sysctl_compaction_proactiveness;
+extern unsigned int sysctl_compaction_proactive_budget_ms;
+extern unsigned int extfrag_for_order(struct zone *zone, unsigned int order);
+#endif
 extern enum compact_result try_to_compact_pages(gfp_t gfp_mask,
 		unsigned int order, unsigned int alloc_flags,
 		const struct alloc_context *ac, enum compact_priority prio);
@@ -0,0 +1,30 @@
+#ifndef _LINUX_CONTPTE_H
+#define _LINUX_CONTPTE_H
+
+#include <linux/sched.h> /* MMF_VM_CONTPTE */
+
+#ifdef CONFIG_ANON_CONTPTE
+extern int __contpte_enter(struct mm_struct *mm);
+extern int contpte_madvise(struct vm_area_struct *vma,
+			   unsigned long *vm_flags, int advice);
+
+static inline int contpte_fork(struct mm_struct *mm, struct mm_struct *oldmm)
+{
+	if (test_bit(MMF_VM_CONTPTE, &oldmm->flags))
+		return __contpte_enter(mm);
+	return 0;
+}
+#else
+static inline int contpte_madvise(struct vm_area_struct *vma,
+				  unsigned long *vm_flags, int advice)
+{
+	return -EINVAL;
+}
+
+static inline int contpte_fork(struct mm_struct *mm, struct mm_struct *oldmm)
+{
+	return 0;
+}
+#endif
+
+#endif /* _LINUX_CONTPTE_H */
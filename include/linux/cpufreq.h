@@ -584,8 +584,10 @@ extern struct cpufreq_governor cpufreq_gov_sched;
 
 #if defined (CONFIG_CPU_FREQ_GOV_SCHEDUTIL)
 int sugov_fast_start(struct cpufreq_policy *policy, unsigned int cpu);
+void sugov_set_freq_ceiling(const struct cpumask *cpus, unsigned int freq);
 #else
 static inline int sugov_fast_start(struct cpufreq_policy *policy, unsigned int cpu) { return 0; }
+static inline void sugov_set_freq_ceiling(const struct cpumask *cpus, unsigned int freq) { }
 #endif
 /*********************************************************************
  *                     FREQUENCY TABLE HELPERS                       *
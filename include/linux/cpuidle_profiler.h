@@ -46,6 +46,39 @@ struct cpuidle_profile_info {
 	struct cpuidle_profile_state_usage *usage;
 };
 
+/*
+ * Binary record of the always-on idle statistics, read from debugfs
+ * "cpuidle_profiler/stat". See cpuidle_profiler.c for the layout.
+ */
+#define CPUIDLE_STAT_MAGIC	0x49444c45	/* "IDLE" */
+#define CPUIDLE_STAT_VERSION	1
+#define CPUIDLE_STAT_BUCKETS	12
+
+struct cpuidle_stat_header {
+	u32 magic;
+	u16 version;
+	u16 nr_cpus;
+	u16 nr_states;
+	u16 nr_buckets;
+	u16 bucket_shift;
+	u16 nr_modes;
+	u16 nr_idle_ip;
+	u16 reg_size;
+	u64 timestamp;
+} __packed;
+
+struct cpuidle_stat_cpu {
+	u32 cpu;
+	u32 cluster;
+	u64 cpd_count;
+	u64 sicd_count;
+	struct {
+		u64 entry_count;
+		u64 early_wakeup_count;
+		u64 time;
+	} __packed state[CPUIDLE_STATE_MAX];
+} __packed;
+
 extern void cpuidle_profile_start(int cpu, int state, int sub_state);
 extern void cpuidle_profile_finish(int cpuid, int early_wakeup);
 extern void cpuidle_profile_register(struct cpuidle_driver *drv);
@@ -362,6 +362,9 @@ struct devfreq_simple_interactive_data {
 #define INTERACTIVE_TOLERANCE		1
 	unsigned int tolerance;
 	/* governor end */
+	/* frequency needed by bandwidth declared in advance, optional */
+	unsigned long (*get_bw_freq)(void);
+	long bw_residual;
 #endif
 	bool use_delay_time;
 	int *delay_time;
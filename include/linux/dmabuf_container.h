@@ -17,6 +17,7 @@
 #ifdef CONFIG_ION_EXYNOS
 int dmabuf_container_get_count(struct dma_buf *dmabuf);
 struct dma_buf *dmabuf_container_get_buffer(struct dma_buf *dmabuf, int index);
+size_t dmabuf_container_get_offset(struct dma_buf *dmabuf, int index);
 #else
 int dmabuf_container_get_count(struct dma_buf *dmabuf)
 {
@@ -26,5 +27,9 @@ struct dma_buf *dmabuf_container_get_buffer(struct dma_buf *dmabuf, int index)
 {
 	return NULL;
 }
+size_t dmabuf_container_get_offset(struct dma_buf *dmabuf, int index)
+{
+	return 0;
+}
 #endif
 #endif
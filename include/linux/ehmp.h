@@ -12,6 +12,7 @@
  */
 
 #include <linux/plist.h>
+#include <linux/ktime.h>
 
 #ifdef CONFIG_CGROUP_SCHEDTUNE
 enum stune_group {
@@ -27,6 +28,16 @@ struct gb_qos_request {
 	struct plist_node node;
 	char *name;
 	bool active;
+
+	/*
+	 * Timed request: boost is held at timed_value until decay_start, then
+	 * decays linearly to zero at expires, when the request is dropped.
+	 */
+	bool timed;
+	u32 timed_value;
+	ktime_t decay_start;
+	ktime_t expires;
+	struct list_head timed_node;
 };
 
 #ifdef CONFIG_SCHED_EHMP
@@ -51,8 +62,11 @@ extern void ehmp_update_max_cpu_capacity(int cpu, unsigned long val);
 
 extern void ehmp_update_overutilized(int cpu, unsigned long capacity);
 extern bool ehmp_trigger_lb(int src_cpu, int dst_cpu);
+extern void ehmp_update_cluster_snapshot(int cpu);
 
 extern void gb_qos_update_request(struct gb_qos_request *req, u32 new_value);
+extern void gb_qos_update_request_timeout(struct gb_qos_request *req,
+		u32 new_value, unsigned int hold_ms, unsigned int decay_ms);
 
 extern void request_kernel_prefer_perf(int grp_idx, int enable);
 #else
@@ -80,8 +94,11 @@ static inline void ehmp_update_max_cpu_capacity(int cpu, unsigned long val) { }
 
 static inline void ehmp_update_overutilized(int cpu, unsigned long capacity) { }
 static inline bool ehmp_trigger_lb(int src_cpu, int dst_cpu) { return false; }
+static inline void ehmp_update_cluster_snapshot(int cpu) { }
 
 static inline void gb_qos_update_request(struct gb_qos_request *req, u32 new_value) { }
+static inline void gb_qos_update_request_timeout(struct gb_qos_request *req,
+		u32 new_value, unsigned int hold_ms, unsigned int decay_ms) { }
 
 extern void request_kernel_prefer_perf(int grp_idx, int enable) { }
 #endif /* CONFIG_SCHED_EHMP */
@@ -167,6 +167,7 @@ void exynos_ion_sync_sg_for_cpu(struct device *dev, size_t size,
 					enum dma_data_direction dir);
 void exynos_ion_flush_dmabuf_for_device(struct device *dev,
 					struct dma_buf *dmabuf, size_t size);
+int exynos_ion_sync_mark_dirty(void __user *arg);
 unsigned int ion_exynos_contig_region_mask(char *region_name);
 int ion_exynos_contig_heap_isolate(int region_id);
 void ion_exynos_contig_heap_deisolate(int region_id);
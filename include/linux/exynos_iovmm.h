@@ -128,6 +128,20 @@ struct iommu_domain *get_domain_from_dev(struct device *dev);
 dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
 		size_t size, enum dma_data_direction direction, int prot);
 
+/* iovmm_map_multi() - Maps several buffers into a single IO region
+ * @dev: the owner of the IO address space where the mapping is created
+ * @sgl: list of the first physical memory chunk of each buffer
+ * @sizes: size in bytes of each buffer
+ * @count: number of buffers
+ * @prot: iommu mapping property
+ *
+ * Buffers are placed back to back at page aligned addresses and the TLB is
+ * invalidated once for the whole region. Returns the start IO address of the
+ * region that is released by iovmm_unmap(), or minus error number.
+ */
+dma_addr_t iovmm_map_multi(struct device *dev, struct scatterlist **sgl,
+			   size_t *sizes, int count, int prot);
+
 /* iovmm_unmap() - unmaps the given IO address
  * @dev: the owner of the IO address space where @iova belongs
  * @iova: IO address that needs to be unmapped and freed.
@@ -162,6 +176,7 @@ void iovmm_unmap(struct device *dev, dma_addr_t iova);
 #define iovmm_activate(dev)		(-ENOSYS)
 #define iovmm_deactivate(dev)		do { } while (0)
 #define iovmm_map(dev, sg, offset, size, direction, prot) (-ENOSYS)
+#define iovmm_map_multi(dev, sgl, sizes, count, prot) (-ENOSYS)
 #define iovmm_unmap(dev, iova)		do { } while (0)
 #define get_domain_from_dev(dev)	NULL
 static inline dma_addr_t exynos_iovmm_map_userptr(struct device *dev,
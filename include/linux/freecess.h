@@ -16,7 +16,11 @@
 #define MOD_SIG                2
 #define MOD_PKG                3
 #define MOD_CFB                4
-#define MOD_END                5
+#define MOD_BATCH              5
+#define MOD_END                6
+
+#define FREECESS_BATCH_MAX     64
+#define FREECESS_PATH_LEN      64
 
 typedef enum {
 	ADD_UID,
@@ -42,6 +46,23 @@ struct kfreecess_msg_data
 	pkg_info_t pkg_info;	//MOD_PKG
 };
 
+/*
+ * MOD_BATCH: move every process of @uids into the freezer cgroup @path
+ * (relative to the freezer root) in one go. Moving into a frozen cgroup
+ * freezes them, moving into a thawed one thaws them. The kernel answers
+ * with the same message, the reply fields filled in.
+ */
+struct kfreecess_batch_data
+{
+	struct kfreecess_msg_data hdr;
+	char path[FREECESS_PATH_LEN];
+	int nr_uids;
+	uid_t uids[FREECESS_BATCH_MAX];
+	int nr_moved;		//reply: processes moved
+	int nr_failed;		//reply: processes that could not be moved
+	int error;		//reply: 0 or -errno
+};
+
 typedef void (*freecess_hook)(void* data, unsigned int len);
 
 int sig_report(struct task_struct *caller, struct task_struct *p);
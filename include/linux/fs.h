@@ -909,7 +909,22 @@ struct file_ra_state {
 	unsigned int ra_pages;		/* Maximum readahead window */
 	unsigned int mmap_miss;		/* Cache miss stat for mmap accesses */
 	loff_t prev_pos;		/* Cache last read() position */
+#ifdef CONFIG_READAHEAD_PATTERN
+	pgoff_t fault_index;		/* Last mmap fault offset */
+	long fault_stride;		/* Last distance between faults */
+	unsigned char pattern;		/* enum ra_pattern of mmap faults */
+	unsigned char pattern_conf;	/* Confidence in pattern, 0..3 */
+#endif
+};
+
+#ifdef CONFIG_READAHEAD_PATTERN
+enum ra_pattern {
+	RA_PATTERN_NONE,
+	RA_PATTERN_SEQ,
+	RA_PATTERN_STRIDED,
+	RA_PATTERN_RANDOM,
 };
+#endif
 
 /*
  * Check if @index falls in the readahead windows.
@@ -585,11 +585,18 @@ extern void init_cma_reserved_pageblock(struct page *page, bool is_rbin);
 
 #ifdef CONFIG_HPA
 int alloc_pages_highorder(int order, struct page **pages, int nents);
+int hpa_reserve_highorder(int order, int nents, unsigned int timeout_ms);
 #else
 static inline int alloc_pages_highorder(int order, struct page **pages, int nents)
 {
 	return 0;
 }
+
+static inline int hpa_reserve_highorder(int order, int nents,
+					unsigned int timeout_ms)
+{
+	return 0;
+}
 #endif
 
 #endif /* __LINUX_GFP_H */
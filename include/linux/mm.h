@@ -111,6 +111,7 @@ extern int mmap_rnd_compat_bits __read_mostly;
 #define DEFAULT_MAX_MAP_COUNT	(USHRT_MAX - MAPCOUNT_ELF_CORE_MARGIN)
 
 extern int sysctl_max_map_count;
+extern int sysctl_fork_lazy_file_kb;
 
 extern unsigned long sysctl_user_reserve_kbytes;
 extern unsigned long sysctl_admin_reserve_kbytes;
@@ -231,6 +232,12 @@ extern unsigned int kobjsize(const void *objp);
 # define VM_GROWSUP	VM_ARCH_1
 #elif !defined(CONFIG_MMU)
 # define VM_MAPPED_COPY	VM_ARCH_1	/* T if mapped copy of data (nommu mmap) */
+#elif defined(CONFIG_ANON_CONTPTE)
+# define VM_CONTPTE	VM_ARCH_1	/* MADV_CONTPTE marked this vma (arm64) */
+#endif
+
+#ifndef VM_CONTPTE
+# define VM_CONTPTE	VM_NONE
 #endif
 
 #if defined(CONFIG_X86)
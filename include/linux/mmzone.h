@@ -306,6 +306,12 @@ struct per_cpu_pages {
 
 	/* Lists of pages, one per migrate type stored on the pcp-lists */
 	struct list_head lists[MIGRATE_PCPTYPES];
+
+#ifdef CONFIG_PCP_HIGH_ORDER
+	int high_count;		/* pages (not blocks) on high_lists */
+	/* orders 1..PAGE_ALLOC_COSTLY_ORDER, one list per migrate type */
+	struct list_head high_lists[PAGE_ALLOC_COSTLY_ORDER][MIGRATE_PCPTYPES];
+#endif
 };
 
 struct per_cpu_pageset {
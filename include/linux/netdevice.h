@@ -699,6 +699,13 @@ struct netdev_rx_queue {
 	struct net_device		*dev;
 } ____cacheline_aligned_in_smp;
 
+#ifdef CONFIG_RPS
+int netif_set_rps_map(struct netdev_rx_queue *queue,
+		      const struct cpumask *mask);
+int netif_set_rps_flow_cnt(struct netdev_rx_queue *queue,
+			   unsigned long count);
+#endif
+
 /*
  * RX queue sysfs structures and functions.
  */
@@ -4180,6 +4187,7 @@ static inline bool net_gso_ok(netdev_features_t features, int gso_type)
 	BUILD_BUG_ON(SKB_GSO_PARTIAL != (NETIF_F_GSO_PARTIAL >> NETIF_F_GSO_SHIFT));
 	BUILD_BUG_ON(SKB_GSO_TUNNEL_REMCSUM != (NETIF_F_GSO_TUNNEL_REMCSUM >> NETIF_F_GSO_SHIFT));
 	BUILD_BUG_ON(SKB_GSO_SCTP    != (NETIF_F_GSO_SCTP >> NETIF_F_GSO_SHIFT));
+	BUILD_BUG_ON(SKB_GSO_UDP_L4 != (NETIF_F_GSO_UDP_L4 >> NETIF_F_GSO_SHIFT));
 
 	return (features & feature) == feature;
 }
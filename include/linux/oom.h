@@ -81,6 +81,61 @@ extern void oom_killer_enable(void);
 
 extern struct task_struct *find_lock_task_mm(struct task_struct *p);
 
+#ifdef CONFIG_MEMKILL_TRACKING
+extern void memkill_track(struct mm_struct *mm, unsigned long pages);
+extern void memkill_mm_released(struct mm_struct *mm);
+extern unsigned long memkill_pending_pages(void);
+extern bool memkill_wait(long timeout);
+#else
+static inline void memkill_track(struct mm_struct *mm, unsigned long pages)
+{
+}
+
+static inline void memkill_mm_released(struct mm_struct *mm)
+{
+}
+
+static inline unsigned long memkill_pending_pages(void)
+{
+	return 0;
+}
+
+static inline bool memkill_wait(long timeout)
+{
+	return true;
+}
+#endif
+
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+extern void lmk_adj_tree_add(struct task_struct *tsk);
+extern void lmk_adj_tree_del(struct task_struct *tsk);
+extern void lmk_adj_tree_update(struct task_struct *tsk);
+
+static inline void lmk_adj_tree_replace(struct task_struct *old,
+					struct task_struct *new)
+{
+	lmk_adj_tree_del(old);
+	lmk_adj_tree_add(new);
+}
+#else
+static inline void lmk_adj_tree_add(struct task_struct *tsk)
+{
+}
+
+static inline void lmk_adj_tree_del(struct task_struct *tsk)
+{
+}
+
+static inline void lmk_adj_tree_update(struct task_struct *tsk)
+{
+}
+
+static inline void lmk_adj_tree_replace(struct task_struct *old,
+					struct task_struct *new)
+{
+}
+#endif
+
 extern void dump_tasks(struct mem_cgroup *memcg, const nodemask_t *nodemask);
 
 /* sysctls */
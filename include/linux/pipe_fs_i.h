@@ -25,6 +25,12 @@ struct pipe_buffer {
 	unsigned long private;
 };
 
+/*
+ * Upper bound on the released pages a pipe keeps for reuse. Pipes of the
+ * default size keep a single one, see pipe_tmp_pages_max().
+ */
+#define PIPE_TMP_PAGES_MAX	8
+
 /**
  *	struct pipe_inode_info - a linux kernel pipe
  *	@mutex: mutex protecting the whole thing
@@ -32,7 +38,8 @@ struct pipe_buffer {
  *	@nrbufs: the number of non-empty pipe buffers in this pipe
  *	@buffers: total number of buffers (should be a power of 2)
  *	@curbuf: the current pipe buffer entry
- *	@tmp_page: cached released page
+ *	@nr_tmp_pages: number of cached released pages
+ *	@tmp_pages: cached released pages, for reuse by pipe_write()
  *	@readers: number of current readers of this pipe
  *	@writers: number of current writers of this pipe
  *	@files: number of struct file referring this pipe (protected by ->i_lock)
@@ -54,7 +61,8 @@ struct pipe_inode_info {
 	unsigned int waiting_writers;
 	unsigned int r_counter;
 	unsigned int w_counter;
-	struct page *tmp_page;
+	unsigned int nr_tmp_pages;
+	struct page *tmp_pages[PIPE_TMP_PAGES_MAX];
 	struct fasync_struct *fasync_readers;
 	struct fasync_struct *fasync_writers;
 	struct pipe_buffer *bufs;
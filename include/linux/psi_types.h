@@ -76,6 +76,9 @@ struct psi_group_cpu {
 	/* Delta detection against the sampling buckets */
 	u32 times_prev[NR_PSI_AGGREGATORS][NR_PSI_STATES]
 			____cacheline_aligned_in_smp;
+
+	/* Same for the aggregator of the cluster this CPU belongs to */
+	u32 cluster_times_prev[NR_PSI_AGGREGATORS][NR_PSI_STATES];
 };
 
 /* PSI growth tracking window */
@@ -100,6 +103,12 @@ struct psi_trigger {
 	/* User-spacified threshold in ns */
 	u64 threshold;
 
+	/*
+	 * Memory triggers only: fire only while free memory is below this
+	 * watermark (enum zone_watermarks), NR_WMARK if not set
+	 */
+	int wmark;
+
 	/* List node inside triggers list */
 	struct list_head node;
 
@@ -132,6 +141,12 @@ struct psi_group {
 	/* Per-cpu task state & time tracking */
 	struct psi_group_cpu __percpu *pcpu;
 
+	/*
+	 * CPUs aggregated by a cluster group, which shares the task state
+	 * of the system group. NULL to aggregate all possible CPUs.
+	 */
+	const struct cpumask *cpus;
+
 	/* Running pressure averages */
 	u64 avg_total[NR_PSI_STATES - 1];
 	u64 avg_last_update;
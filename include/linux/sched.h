@@ -174,6 +174,9 @@ struct task_group;
 extern void proc_sched_show_task(struct task_struct *p, struct seq_file *m);
 extern void proc_sched_set_task(struct task_struct *p);
 #endif
+#ifdef CONFIG_SCHED_WALT
+extern void proc_walt_show_demand(struct task_struct *p, struct seq_file *m);
+#endif
 
 /*
  * Task state bitmask. NOTE! These bits are also
@@ -519,6 +522,7 @@ static inline int get_dumpable(struct mm_struct *mm)
 #define MMF_OOM_SKIP		21	/* mm is of no interest for the OOM killer */
 #define MMF_UNSTABLE		22	/* mm is unstable for copy_from_user */
 #define MMF_HUGE_ZERO_PAGE	23      /* mm has ever used the global huge zero page */
+#define MMF_VM_CONTPTE		24	/* set when VM_CONTPTE is set on vma */
 #define MMF_OOM_REAP_QUEUED	26	/* mm was queued for oom_reaper */
 
 #define MMF_INIT_MASK		(MMF_DUMPABLE_MASK | MMF_DUMP_FILTER_MASK)
@@ -843,6 +847,26 @@ static inline int signal_group_exit(const struct signal_struct *sig)
 /*
  * Some day this will be a full-fledged user tracking system..
  */
+/*
+ * CPU time and I/O of all the tasks of a user, accumulated per cpu as it
+ * is accounted so that per-uid statistics need no walk over the tasks.
+ */
+enum uid_sys_acct_item {
+	UID_ACCT_UTIME,
+	UID_ACCT_STIME,
+	UID_ACCT_READ_BYTES,
+	UID_ACCT_WRITE_BYTES,
+	UID_ACCT_CANCELLED_WRITE_BYTES,
+	UID_ACCT_RCHAR,
+	UID_ACCT_WCHAR,
+	UID_ACCT_FSYNC,
+	UID_ACCT_NR,
+};
+
+struct uid_sys_acct {
+	u64 val[UID_ACCT_NR];
+};
+
 struct user_struct {
 	atomic_t __count;	/* reference count */
 	atomic_t processes;	/* How many processes does this user have? */
@@ -877,10 +901,26 @@ struct user_struct {
 #if defined(CONFIG_PERF_EVENTS) || defined(CONFIG_BPF_SYSCALL)
 	atomic_long_t locked_vm;
 #endif
+#ifdef CONFIG_UID_SYS_STATS
+	struct uid_sys_acct __percpu *sys_acct;
+#endif
 };
 
 extern int uids_sysfs_init(void);
 
+#ifdef CONFIG_UID_SYS_STATS
+extern void uid_sys_acct_add(struct task_struct *tsk,
+			     enum uid_sys_acct_item item, u64 val);
+extern void uid_sys_acct_read(struct user_struct *up, struct uid_sys_acct *acct);
+extern void for_each_user_struct(void (*fn)(struct user_struct *up, void *data),
+				 void *data);
+#else
+static inline void uid_sys_acct_add(struct task_struct *tsk,
+				    enum uid_sys_acct_item item, u64 val)
+{
+}
+#endif
+
 extern struct user_struct *find_user(kuid_t);
 
 extern struct user_struct root_user;
@@ -1393,8 +1433,20 @@ struct ontime_avg {
 	unsigned long load_avg;
 };
 
+#define ONTIME_HIST_SIZE	5
+
+/* demand of the recent activations, used to predict the next one */
+struct ontime_hist {
+	u64 wakeup_time;
+	u64 wakeup_exec;
+	unsigned short demand[ONTIME_HIST_SIZE];
+	unsigned short predicted;
+	int idx;
+};
+
 struct ontime_entity {
 	struct ontime_avg avg;
+	struct ontime_hist hist;
 	int flags;
 	int cpu;
 };
@@ -1922,6 +1974,12 @@ struct task_struct {
 	struct rb_node *pi_waiters_leftmost;
 	/* Deadlock detection and priority inheritance handling */
 	struct rt_mutex_waiter *pi_blocked_on;
+#ifdef CONFIG_CGROUP_SCHEDTUNE
+	/* schedtune attributes inherited from pi_waiters */
+	int st_pi_boost;
+	int st_pi_prefer_idle;
+	int st_pi_prefer_perf;
+#endif
 #endif
 
 #ifdef CONFIG_DEBUG_MUTEXES
@@ -2094,6 +2152,15 @@ struct task_struct {
 	 */
 	u64 timer_slack_ns;
 	u64 default_timer_slack_ns;
+#ifdef CONFIG_CGROUP_SCHED
+	/*
+	 * slack and expiry alignment imposed by the cpu cgroup, 0 if none.
+	 * While the slack is imposed, default_timer_slack_ns still holds the
+	 * task's own one.
+	 */
+	u64 cgroup_timer_slack_ns;
+	u64 cgroup_timer_align_ns;
+#endif
 
 #ifdef CONFIG_KASAN
 	unsigned int kasan_depth;
@@ -2157,6 +2224,11 @@ struct task_struct {
 #ifdef CONFIG_MMU
 	struct task_struct *oom_reaper_list;
 #endif
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+	/* group leaders only, keyed by lmk_adj, see lowmemorykiller.c */
+	struct rb_node lmk_adj_node;
+	short lmk_adj;
+#endif
 #ifdef CONFIG_VMAP_STACK
 	struct vm_struct *stack_vm_area;
 #endif
@@ -3756,11 +3828,13 @@ extern int task_can_switch_user(struct user_struct *up,
 static inline void add_rchar(struct task_struct *tsk, ssize_t amt)
 {
 	tsk->ioac.rchar += amt;
+	uid_sys_acct_add(tsk, UID_ACCT_RCHAR, amt);
 }
 
 static inline void add_wchar(struct task_struct *tsk, ssize_t amt)
 {
 	tsk->ioac.wchar += amt;
+	uid_sys_acct_add(tsk, UID_ACCT_WCHAR, amt);
 }
 
 static inline void inc_syscr(struct task_struct *tsk)
@@ -3776,6 +3850,7 @@ static inline void inc_syscw(struct task_struct *tsk)
 static inline void inc_syscfs(struct task_struct *tsk)
 {
 	tsk->ioac.syscfs++;
+	uid_sys_acct_add(tsk, UID_ACCT_FSYNC, 1);
 }
 #else
 static inline void add_rchar(struct task_struct *tsk, ssize_t amt)
@@ -21,6 +21,10 @@ extern void rt_mutex_setprio(struct task_struct *p, int prio);
 extern int rt_mutex_get_effective_prio(struct task_struct *task, int newprio);
 extern struct task_struct *rt_mutex_get_top_task(struct task_struct *task);
 extern void rt_mutex_adjust_pi(struct task_struct *p);
+#ifdef CONFIG_CGROUP_SCHEDTUNE
+extern void schedtune_pi_inherit(struct task_struct *p,
+				 struct task_struct *donor);
+#endif
 static inline bool tsk_is_pi_blocked(struct task_struct *tsk)
 {
 	return tsk->pi_blocked_on != NULL;
@@ -41,4 +41,24 @@ void init_sched_energy_costs(void);
 
 #endif /* CONFIG_SMP */
 
+#ifdef CONFIG_SCHED_ENERGY_CALIBRATION
+extern int sched_energy_calibrate(const struct cpumask *cpus,
+				  const unsigned long *rates,
+				  const unsigned int *volts, int nr);
+extern int sched_energy_refine(int cpu, int sd_level, int idx,
+			       unsigned long power);
+#else
+static inline int sched_energy_calibrate(const struct cpumask *cpus,
+					 const unsigned long *rates,
+					 const unsigned int *volts, int nr)
+{
+	return 0;
+}
+static inline int sched_energy_refine(int cpu, int sd_level, int idx,
+				      unsigned long power)
+{
+	return 0;
+}
+#endif
+
 #endif
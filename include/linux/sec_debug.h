@@ -17,6 +17,7 @@
 #include <linux/memblock.h>
 #include <linux/module.h>
 #include <linux/reboot.h>
+#include <linux/jump_label.h>
 
 #define SEC_DEBUG_MAGIC_PA memblock_start_of_DRAM()
 #define SEC_DEBUG_MAGIC_VA phys_to_virt(SEC_DEBUG_MAGIC_PA)
@@ -610,11 +611,44 @@ struct sec_debug_summary {
 	struct sec_debug_ksyms ksyms;
 };
 
-extern void sec_debug_task_sched_log_short_msg(char *msg);
-extern void sec_debug_task_sched_log(int cpu, struct task_struct *task);
-extern void sec_debug_irq_sched_log(unsigned int irq, void *fn, int en);
-extern void sec_debug_irq_enterexit_log(unsigned int irq,
+/*
+ * sched_log_level selects which of the hooks below record anything:
+ * 0 turns them all into a patched out branch, 1 keeps context switches
+ * and 2 (the default) also keeps irq entry and exit.
+ */
+DECLARE_STATIC_KEY_FALSE(sec_debug_sched_log_key);
+DECLARE_STATIC_KEY_FALSE(sec_debug_irq_log_key);
+
+extern void __sec_debug_task_sched_log(int cpu, struct task_struct *task, char *msg);
+extern void __sec_debug_irq_sched_log(unsigned int irq, void *fn, int en);
+extern void __sec_debug_irq_enterexit_log(unsigned int irq,
 						unsigned long long start_time);
+
+static inline void sec_debug_task_sched_log_short_msg(char *msg)
+{
+	if (static_branch_unlikely(&sec_debug_sched_log_key))
+		__sec_debug_task_sched_log(raw_smp_processor_id(), NULL, msg);
+}
+
+static inline void sec_debug_task_sched_log(int cpu, struct task_struct *task)
+{
+	if (static_branch_unlikely(&sec_debug_sched_log_key))
+		__sec_debug_task_sched_log(cpu, task, NULL);
+}
+
+static inline void sec_debug_irq_sched_log(unsigned int irq, void *fn, int en)
+{
+	if (static_branch_unlikely(&sec_debug_irq_log_key))
+		__sec_debug_irq_sched_log(irq, fn, en);
+}
+
+static inline void sec_debug_irq_enterexit_log(unsigned int irq,
+						unsigned long long start_time)
+{
+	if (static_branch_unlikely(&sec_debug_irq_log_key))
+		__sec_debug_irq_enterexit_log(irq, start_time);
+}
+
 extern void sec_debug_set_kallsyms_info(struct sec_debug_ksyms *ksyms, int magic);
 extern int sec_debug_check_sj(void);
 
@@ -39,6 +39,10 @@
 extern void sec_bootstat_mct_start(u64 t);
 extern void sec_bootstat_add(const char *c);
 extern void sec_bootstat_add_initcall(const char *name);
+extern void sec_bootstat_add_initcall_span(initcall_t fn,
+		unsigned long long start, int ret);
+extern void sec_bootstat_add_probe_span(const char *drv, const char *dev,
+		unsigned long long start, int ret);
 
 extern void sec_bootstat_get_cpuinfo(int *freq, int *online);
 extern void sec_bootstat_get_thermal(int *temp);
@@ -46,6 +50,8 @@ extern void sec_bootstat_get_thermal(int *temp);
 #define sec_bootstat_mct_start(a)		do { } while (0)
 #define sec_bootstat_add(a)			do { } while (0)
 #define sec_bootstat_add_initcall(a)		do { } while (0)
+#define sec_bootstat_add_initcall_span(a, b, c)	do { } while (0)
+#define sec_bootstat_add_probe_span(a, b, c, d)	do { } while (0)
 
 #define sec_bootstat_get_cpuinfo(a, b)		do { } while (0)
 #define sec_bootstat_get_thermal(a)		do { } while (0)
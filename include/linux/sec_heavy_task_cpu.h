@@ -0,0 +1,43 @@
+#ifndef _SEC_HEAVY_TASK_CPU_H
+#define _SEC_HEAVY_TASK_CPU_H
+
+#include <linux/types.h>
+
+struct task_struct;
+
+#ifdef CONFIG_SEC_HEAVY_TASK_CPU_PROFILER
+/*
+ * Ring buffer layout shared with userspace through
+ * /sys/kernel/debug/sec_heavy_task_cpu/cpu<N>. The writer is the owning
+ * cpu only: it fills the record at head % nr_records, then bumps head.
+ * Readers read head, copy records and check head again to detect records
+ * overwritten meanwhile.
+ */
+#define SEC_HTC_TOP_TASKS	4
+
+struct sec_htc_task {
+	__s32 pid;
+	__u32 runtime_ms;
+	char comm[16];
+};
+
+struct sec_htc_record {
+	__u64 timestamp_ns;
+	__u32 window_ms;
+	__u32 nr_tasks;
+	struct sec_htc_task task[SEC_HTC_TOP_TASKS];
+};
+
+struct sec_htc_header {
+	__u32 version;
+	__u32 nr_records;
+	__u64 head;
+	struct sec_htc_record record[0];
+};
+
+extern void sec_heavy_task_cpu_tick(int cpu, struct task_struct *curr);
+#else
+static inline void sec_heavy_task_cpu_tick(int cpu, struct task_struct *curr) { }
+#endif
+
+#endif /* _SEC_HEAVY_TASK_CPU_H */
@@ -0,0 +1,56 @@
+#ifndef _LINUX_SWAP_SLOTS_H
+#define _LINUX_SWAP_SLOTS_H
+
+#include <linux/swap.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+
+#define SWAP_SLOTS_CACHE_SIZE	64
+
+struct swap_slots_cache {
+	struct mutex	alloc_lock;	/* protects slots, nr, cur */
+	swp_entry_t	slots[SWAP_SLOTS_CACHE_SIZE];
+	int		nr;
+	int		cur;
+	spinlock_t	free_lock;	/* protects slots_ret, n_ret */
+	swp_entry_t	slots_ret[SWAP_SLOTS_CACHE_SIZE];
+	int		n_ret;
+};
+
+#ifdef CONFIG_SWAP_SLOTS_CACHE
+extern bool swap_slots_cache_active(void);
+extern bool swap_slots_alloc(swp_entry_t *entry);
+extern bool swap_slots_free(swp_entry_t entry);
+extern void enable_swap_slots_cache(void);
+extern void disable_swap_slots_cache_lock(void);
+extern void reenable_swap_slots_cache_unlock(void);
+#else
+static inline bool swap_slots_cache_active(void)
+{
+	return false;
+}
+
+static inline bool swap_slots_alloc(swp_entry_t *entry)
+{
+	return false;
+}
+
+static inline bool swap_slots_free(swp_entry_t entry)
+{
+	return false;
+}
+
+static inline void enable_swap_slots_cache(void)
+{
+}
+
+static inline void disable_swap_slots_cache_lock(void)
+{
+}
+
+static inline void reenable_swap_slots_cache_unlock(void)
+{
+}
+#endif
+
+#endif /* _LINUX_SWAP_SLOTS_H */
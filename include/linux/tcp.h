@@ -257,6 +257,8 @@ struct tcp_sock {
 	struct list_head tsq_node; /* anchor in tsq_tasklet.head list */
 	unsigned long	tsq_flags;
 
+	struct hrtimer	pacing_timer;	/* internal pacing, see tcp_pace_kick() */
+
 	/* Data for direct copy to user */
 	struct {
 		struct sk_buff_head	prequeue;
@@ -348,6 +348,16 @@ struct thermal_zone_params {
 	 * 		Used by thermal zone drivers (default 0).
 	 */
 	int offset;
+
+#ifdef CONFIG_THERMAL_POWER_ALLOCATOR_FPS
+	/*
+	 * Frame rate the foreground application aims for and the frame
+	 * rate it currently achieves, both reported by userspace. The power
+	 * allocator favours saturated actors while @fps_cur < @fps_target.
+	 */
+	s32 fps_target;
+	s32 fps_cur;
+#endif
 };
 
 struct thermal_genl_event {
@@ -26,6 +26,9 @@ enum vm_event_item { PGPGIN, PGPGOUT, PSWPIN, PSWPOUT,
 		FOR_ALL_ZONES(ALLOCSTALL),
 		FOR_ALL_ZONES(PGSCAN_SKIP),
 		PGFREE, PGACTIVATE, PGDEACTIVATE,
+#ifdef CONFIG_PCP_HIGH_ORDER
+		PCP_HIGH_ORDER_HIT, PCP_HIGH_ORDER_MISS,
+#endif
 		PGFAULT, PGMAJFAULT,
 		PGLAZYFREED,
 		PGREFILL,
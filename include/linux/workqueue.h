@@ -123,14 +123,30 @@ struct delayed_work {
  * A struct for workqueue attributes.  This can be used to change
  * attributes of an unbound workqueue.
  *
- * Unlike other fields, ->no_numa isn't a property of a worker_pool.  It
- * only modifies how apply_workqueue_attrs() select pools and thus doesn't
- * participate in pool hash calculations or equality comparisons.
+ * Unlike other fields, ->no_numa and ->cluster aren't properties of a
+ * worker_pool.  They only modify how apply_workqueue_attrs() select pools
+ * and thus don't participate in pool hash calculations or equality
+ * comparisons.
  */
 struct workqueue_attrs {
 	int			nice;		/* nice level */
 	cpumask_var_t		cpumask;	/* allowed CPUs */
 	bool			no_numa;	/* disable NUMA affinity */
+	int			cluster;	/* WQ_CLUSTER_* placement hint */
+};
+
+/*
+ * Cluster placement hints of unbound workqueues on asymmetric
+ * (big.LITTLE) systems.  BIG and LITTLE restrict the workers to the CPUs
+ * of that class, SUBMITTER keeps a pool per class and runs each work item
+ * on the class of the CPU which queued it.  The hints are ignored on
+ * symmetric systems and when they leave no CPU in the cpumask.
+ */
+enum {
+	WQ_CLUSTER_ANY,
+	WQ_CLUSTER_BIG,
+	WQ_CLUSTER_LITTLE,
+	WQ_CLUSTER_SUBMITTER,
 };
 
 static inline struct delayed_work *to_delayed_work(struct work_struct *work)
@@ -309,6 +325,15 @@ enum {
 	 */
 	WQ_POWER_EFFICIENT	= 1 << 7,
 
+	/*
+	 * Initial cluster placement hints of unbound workqueues, see
+	 * WQ_CLUSTER_*.  They can be changed later through the "cluster"
+	 * sysfs attribute of WQ_SYSFS workqueues.
+	 */
+	WQ_PREFER_BIG		= 1 << 8,
+	WQ_PREFER_LITTLE	= 1 << 9,
+	WQ_FOLLOW_CLUSTER	= 1 << 10,
+
 	__WQ_DRAINING		= 1 << 16, /* internal: workqueue is draining */
 	__WQ_ORDERED		= 1 << 17, /* internal: workqueue is ordered */
 	__WQ_LEGACY		= 1 << 18, /* internal: create*_workqueue() */
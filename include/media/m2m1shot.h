@@ -206,6 +206,13 @@ struct m2m1shot_task {
  *                driver can reset the H/W to cancle the current task.
  * @custom_ioctl: [OPTIONAL]
  *                The driver can directly interact with this @custom_ioctl.
+ * @begin_batch: [OPTIONAL]
+ *               called before the tasks of M2M1SHOT_IOC_PROCESS_BATCH are
+ *               processed with the number of the tasks. The driver can set
+ *               up resources like QoS once for all of them.
+ * @end_batch: [OPTIONAL]
+ *             called after the last task of a batch is finished, failed or
+ *             not, if @begin_batch succeeded.
  */
 struct m2m1shot_devops {
 	int (*init_context)(struct m2m1shot_context *ctx);
@@ -232,6 +239,8 @@ struct m2m1shot_devops {
 	/* optional */
 	long (*custom_ioctl)(struct m2m1shot_context *ctx,
 			unsigned int cmd, unsigned long arg);
+	int (*begin_batch)(struct m2m1shot_context *ctx, unsigned int count);
+	void (*end_batch)(struct m2m1shot_context *ctx);
 };
 
 /**
@@ -306,6 +306,18 @@ int fib6_add(struct fib6_node *root, struct rt6_info *rt,
 	     struct nl_info *info, struct mx6_config *mxc);
 int fib6_del(struct rt6_info *rt, struct nl_info *info);
 
+enum {
+	FIB6_CHANGE_ALL,	/* anything may have changed */
+	FIB6_CHANGE_DST,	/* a route to addr/plen was added */
+	FIB6_CHANGE_SRC,	/* source address addr came or went */
+};
+
+void fib6_flush_trees_saddr(struct net *net, const struct in6_addr *saddr);
+void fib6_change_log_all(struct net *net);
+bool fib6_changes_unrelated(struct net *net, u32 from, u32 to,
+			    const struct in6_addr *daddr,
+			    const struct in6_addr *saddr);
+
 void inet6_rt_notify(int event, struct rt6_info *rt, struct nl_info *info,
 		     unsigned int flags);
 
@@ -163,6 +163,7 @@ void rt6_ifdown(struct net *net, struct net_device *dev);
 void rt6_mtu_change(struct net_device *dev, unsigned int mtu);
 void rt6_remove_prefsrc(struct inet6_ifaddr *ifp);
 void rt6_clean_tohost(struct net *net, struct in6_addr *gateway);
+bool rt6_sk_dst_revalidate(struct sock *sk, struct dst_entry *dst);
 
 
 /*
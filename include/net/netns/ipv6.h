@@ -6,10 +6,22 @@
 
 #ifndef __NETNS_IPV6_H__
 #define __NETNS_IPV6_H__
+#include <linux/in6.h>
+#include <linux/seqlock.h>
 #include <net/dst_ops.h>
 
 struct ctl_table_header;
 
+#define FIB6_CHANGE_LOG_SIZE	16
+
+/* One tree change, logged by the serial number it set, see ip6_fib.c */
+struct fib6_change {
+	struct in6_addr		addr;
+	int			sernum;
+	u8			plen;
+	u8			type;
+};
+
 struct netns_sysctl_ipv6 {
 #ifdef CONFIG_SYSCTL
 	struct ctl_table_header *hdr;
@@ -27,6 +39,7 @@ struct netns_sysctl_ipv6 {
 	int ip6_rt_gc_elasticity;
 	int ip6_rt_mtu_expires;
 	int ip6_rt_min_advmss;
+	int ip6_rt_sk_dst_revalidate;
 	int flowlabel_consistency;
 	int auto_flowlabels;
 	int icmpv6_time;
@@ -85,6 +98,8 @@ struct netns_ipv6 {
 #endif
 	atomic_t		dev_addr_genid;
 	atomic_t		fib6_sernum;
+	seqlock_t		fib6_change_lock;
+	struct fib6_change	fib6_changes[FIB6_CHANGE_LOG_SIZE];
 };
 
 #if IS_ENABLED(CONFIG_NF_DEFRAG_IPV6)
@@ -0,0 +1,61 @@
+/*
+ * Sampling profiler of the per packet cost of the network RX path
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef _NET_RX_PROF_H
+#define _NET_RX_PROF_H
+
+#include <linux/skbuff.h>
+
+enum rx_prof_src {
+	RX_PROF_NONE,		/* skb is not sampled */
+	RX_PROF_WIFI,
+	RX_PROF_MODEM,
+	RX_PROF_NR_SRC,
+};
+
+/* in the order a packet goes through them */
+enum rx_prof_stage {
+	RX_PROF_DRIVER,		/* received by the link driver */
+	RX_PROF_STACK,		/* handed to GRO or the backlog */
+	RX_PROF_CORE,		/* __netif_receive_skb_core() */
+	RX_PROF_PREROUTING,	/* past the PRE_ROUTING hooks */
+	RX_PROF_LOCAL_IN,	/* past the LOCAL_IN hooks, xt_qtaguid included */
+	RX_PROF_SOCK,		/* queued on the receiving socket */
+	RX_PROF_NR_STAGES,
+};
+
+#ifdef CONFIG_NET_RX_PROF
+extern unsigned int rx_prof_rate;
+
+void __rx_prof_start(struct sk_buff *skb, enum rx_prof_src src);
+void __rx_prof_stamp(struct sk_buff *skb, enum rx_prof_stage stage);
+
+/* sample one in rx_prof_rate packets received by @src */
+static inline void rx_prof_start(struct sk_buff *skb, enum rx_prof_src src)
+{
+	if (unlikely(READ_ONCE(rx_prof_rate)))
+		__rx_prof_start(skb, src);
+}
+
+static inline void rx_prof_stamp(struct sk_buff *skb, enum rx_prof_stage stage)
+{
+	if (unlikely(skb->rx_prof_src))
+		__rx_prof_stamp(skb, stage);
+}
+#else
+static inline void rx_prof_start(struct sk_buff *skb, enum rx_prof_src src)
+{
+}
+
+static inline void rx_prof_stamp(struct sk_buff *skb, enum rx_prof_stage stage)
+{
+}
+#endif
+
+#endif /* _NET_RX_PROF_H */
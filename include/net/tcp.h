@@ -748,8 +748,23 @@ void tcp_fin(struct sock *sk);
 
 /* tcp_timer.c */
 void tcp_init_xmit_timers(struct sock *);
+enum hrtimer_restart tcp_pace_kick(struct hrtimer *timer);
+
+/* Pacing was asked for, but no packet scheduler (sch_fq) does it for us */
+static inline bool tcp_needs_internal_pacing(const struct sock *sk)
+{
+	return smp_load_acquire(&sk->sk_pacing_status) == SK_PACING_NEEDED;
+}
+
+/* The pacing timer is armed until the previous packet left its slot */
+static inline bool tcp_pacing_check(const struct sock *sk)
+{
+	return tcp_needs_internal_pacing(sk) &&
+	       hrtimer_active(&tcp_sk(sk)->pacing_timer);
+}
 static inline void tcp_clear_xmit_timers(struct sock *sk)
 {
+	hrtimer_cancel(&tcp_sk(sk)->pacing_timer);
 	inet_csk_clear_xmit_timers(sk);
 }
 
@@ -1140,6 +1155,9 @@ int tcp_set_default_congestion_control(const char *name);
 void tcp_get_default_congestion_control(char *name);
 void tcp_get_available_congestion_control(char *buf, size_t len);
 void tcp_get_allowed_congestion_control(char *buf, size_t len);
+int tcp_set_iface_congestion_control(char *val);
+void tcp_get_iface_congestion_control(char *buf, size_t len);
+u32 tcp_ca_iface_key(const struct net_device *dev);
 int tcp_set_allowed_congestion_control(char *allowed);
 int tcp_set_congestion_control(struct sock *sk, const char *name);
 u32 tcp_slow_start(struct tcp_sock *tp, u32 acked);
@@ -2214,6 +2232,8 @@ static inline int tcp_inq(struct sock *sk)
 }
 
 int tcp_peek_len(struct socket *sock);
+int tcp_mmap(struct file *file, struct socket *sock,
+	     struct vm_area_struct *vma);
 
 static inline void tcp_segs_in(struct tcp_sock *tp, const struct sk_buff *skb)
 {
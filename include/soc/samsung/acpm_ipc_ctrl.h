@@ -2,6 +2,8 @@
 #define __ACPM_IPC_CTRL_H__
 
 typedef void (*ipc_callback)(unsigned int *cmd, unsigned int size);
+typedef void (*ipc_done_callback)(unsigned int *cmd, unsigned int size,
+		void *priv);
 
 struct ipc_config {
 	unsigned int *cmd;
@@ -29,6 +31,10 @@ unsigned int acpm_ipc_request_channel(struct device_node *np, ipc_callback handl
 unsigned int acpm_ipc_release_channel(struct device_node *np, unsigned int channel_id);
 int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg);
 int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg);
+int acpm_ipc_send_data_batch(unsigned int channel_id, struct ipc_config *cfg,
+		unsigned int nr);
+int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_config *cfg,
+		unsigned int nr, ipc_done_callback done, void *priv);
 int acpm_ipc_set_ch_mode(struct device_node *np, bool polling);
 void exynos_acpm_reboot(void);
 void acpm_stop_log(void);
@@ -55,6 +61,19 @@ static inline int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_co
 	return 0;
 }
 
+static inline int acpm_ipc_send_data_batch(unsigned int channel_id,
+		struct ipc_config *cfg, unsigned int nr)
+{
+	return 0;
+}
+
+static inline int acpm_ipc_send_data_async(unsigned int channel_id,
+		struct ipc_config *cfg, unsigned int nr,
+		ipc_done_callback done, void *priv)
+{
+	return 0;
+}
+
 static inline int acpm_ipc_set_ch_mode(struct device_node *np, bool polling)
 {
 	return 0;
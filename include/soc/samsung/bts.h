@@ -192,6 +192,16 @@ unsigned int bts_calc_bw(enum bts_bw_type type, void *data);
 #define bts_calc_bw(a, b) do {} while(0)
 #endif
 
+#if defined(CONFIG_EXYNOS9810_BTS)
+/* MIF frequency (kHz) required by the bandwidth declared to BTS */
+unsigned long bts_get_mif_bw_freq(void);
+#else
+static inline unsigned long bts_get_mif_bw_freq(void)
+{
+	return 0;
+}
+#endif
+
 #if defined(CONFIG_EXYNOS5422_BTS) || defined(CONFIG_EXYNOS5433_BTS)	\
 	|| defined(CONFIG_EXYNOS7420_BTS) || defined(CONFIG_EXYNOS7890_BTS) \
 	|| defined(CONFIG_EXYNOS8890_BTS)
@@ -46,6 +46,9 @@ extern unsigned int cal_dfs_get(char *name);
 extern unsigned long cal_dfs_get_max_freq(unsigned int id);
 extern unsigned long cal_dfs_get_min_freq(unsigned int id);
 extern int cal_dfs_set_rate(unsigned int id, unsigned long rate);
+extern void cal_dfs_batch_begin(void);
+extern int cal_dfs_set_rate_batched(unsigned int id, unsigned long rate);
+extern int cal_dfs_batch_commit(void);
 extern int cal_dfs_set_rate_switch(unsigned int id, unsigned long switch_rate);
 extern unsigned long cal_dfs_cached_get_rate(unsigned int id);
 extern unsigned long cal_dfs_get_rate(unsigned int id);
@@ -404,6 +404,7 @@ struct ect_info
 	struct file_operations dump_ops;
 	char *dump_node_name;
 	void *block_handle;
+	void *block_address;
 	int block_precedence;
 };
 
@@ -12,6 +12,8 @@
 #ifndef __EXYNOS_CPU_HOTPLUG_H
 #define __EXYNOS_CPU_HOTPLUG_H __FILE__
 
+#include <linux/cpumask.h>
+
 #define FAST_HP		0xFA57
 
 struct kobject *exynos_cpu_hotplug_kobj(void);
@@ -23,9 +25,16 @@ int exynos_hpgov_update_cpu_capacity(int cpu);
 #ifdef CONFIG_EXYNOS_HOTPLUG_GOVERNOR
 void exynos_hpgov_validate_hpin(unsigned int cpu);
 void exynos_hpgov_validate_scale(unsigned int cpu, unsigned int target_freq);
+
+extern struct cpumask exynos_hpgov_parked_mask;
+static inline bool exynos_hpgov_cpu_parked(int cpu)
+{
+	return cpumask_test_cpu(cpu, &exynos_hpgov_parked_mask);
+}
 #else
 static inline void exynos_hpgov_validate_hpin(unsigned int cpu) {};
 static inline void exynos_hpgov_validate_scale(unsigned int cpu, unsigned int target_freq) {};
+static inline bool exynos_hpgov_cpu_parked(int cpu) { return false; }
 #endif
 
 #define UPDATE_ONLINE_CPU (1)
@@ -90,6 +90,14 @@ struct exynos_dm_constraint {
 	struct exynos_dm_constraint	*sub_constraint;
 };
 
+/* Maximum number of constraints of other domains bounding one domain */
+#define EXYNOS_DM_MAX_BOUNDS		(DM_TYPE_END * 2)
+
+struct exynos_dm_bound {
+	struct exynos_dm_constraint	*constraint;
+	enum exynos_dm_type		master;
+};
+
 struct exynos_dm_data {
 	bool				available;		/* use for DVFS domain available */
 #ifdef CONFIG_EXYNOS_ACPM
@@ -114,6 +122,12 @@ struct exynos_dm_data {
 	struct list_head		min_clist;
 	struct list_head		max_clist;
 	u32				constraint_checked;
+
+	/* reverse index of constraints bounding this domain */
+	struct exynos_dm_bound		min_bound[EXYNOS_DM_MAX_BOUNDS];
+	struct exynos_dm_bound		max_bound[EXYNOS_DM_MAX_BOUNDS];
+	u32				nr_min_bound;
+	u32				nr_max_bound;
 #ifdef CONFIG_EXYNOS_ACPM
 	u32				cal_id;
 #endif
@@ -139,6 +153,7 @@ int unregister_exynos_dm_freq_scaler(enum exynos_dm_type dm_type);
 int policy_update_call_to_DM(enum exynos_dm_type dm_type, u32 min_freq, u32 max_freq);
 int DM_CALL(enum exynos_dm_type dm_type, unsigned long *target_freq);
 int policy_update_with_DM_CALL(enum exynos_dm_type dm_type, u32 min_freq, u32 max_freq, unsigned long *target_freq);
+int exynos_dm_get_domain_info(enum exynos_dm_type dm_type, u32 *cal_id, u32 *gov_min_freq);
 #else
 static inline
 int exynos_dm_data_init(enum exynos_dm_type dm_type,
@@ -184,6 +199,11 @@ int policy_update_with_DM_CALL(enum exynos_dm_type dm_type, u32 min_freq, u32 ma
 {
 	return 0;
 }
+static inline
+int exynos_dm_get_domain_info(enum exynos_dm_type dm_type, u32 *cal_id, u32 *gov_min_freq)
+{
+	return -ENODEV;
+}
 #endif
 
 #endif /* __EXYNOS_DM_H */
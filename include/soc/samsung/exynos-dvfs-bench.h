@@ -0,0 +1,59 @@
+/*
+ * Exynos DVFS transition latency benchmark
+ *
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __EXYNOS_DVFS_BENCH_H
+#define __EXYNOS_DVFS_BENCH_H
+
+#include <linux/sched.h>
+
+/* Phases of one frequency change, as seen from the DVFS manager down */
+enum exynos_dvfs_bench_phase {
+	DVFS_BENCH_TOTAL = 0,		/* DM_CALL() end to end */
+	DVFS_BENCH_DM_CONSTRAINT,	/* exynos-dm constraint propagation */
+	DVFS_BENCH_DM_SCALE,		/* exynos-dm scalers and batch commit */
+	DVFS_BENCH_CPU_SCALE,		/* exynos-acme scale() */
+	DVFS_BENCH_ACPM_IPC,		/* ACPM DVFS request and response */
+	DVFS_BENCH_DEVFREQ_PREPARE,	/* devfreq ->set_freq_prepare() */
+	DVFS_BENCH_DEVFREQ_SET,		/* devfreq switch and ->set_freq() */
+	DVFS_BENCH_DEVFREQ_POST,	/* devfreq ->set_freq_post() */
+	DVFS_BENCH_PHASE_END
+};
+
+#ifdef CONFIG_EXYNOS_DVFS_BENCH
+extern bool exynos_dvfs_bench_recording;
+
+/*
+ * Returns a timestamp to be passed to exynos_dvfs_bench_record(), or 0
+ * when no benchmark runs so that the DVFS paths do not pay for it.
+ */
+static inline u64 exynos_dvfs_bench_clock(void)
+{
+	if (likely(!READ_ONCE(exynos_dvfs_bench_recording)))
+		return 0;
+
+	return sched_clock();
+}
+
+void exynos_dvfs_bench_record(enum exynos_dvfs_bench_phase phase,
+			      u64 start_ns, u64 end_ns);
+#else
+static inline u64 exynos_dvfs_bench_clock(void)
+{
+	return 0;
+}
+
+static inline void exynos_dvfs_bench_record(enum exynos_dvfs_bench_phase phase,
+					    u64 start_ns, u64 end_ns)
+{
+}
+#endif
+
+#endif /* __EXYNOS_DVFS_BENCH_H */
@@ -53,6 +53,16 @@
 
 struct exynos_pm_domain;
 
+struct exynos_pd_stat {
+	unsigned long on_cnt;
+	unsigned long off_cnt;
+	unsigned long off_avoided;	/* delayed off cancelled by an on */
+	u64 on_lat_total_ns;
+	u64 on_lat_max_ns;
+	u64 off_lat_total_ns;
+	u64 off_lat_max_ns;
+};
+
 struct exynos_pm_domain {
 	struct generic_pm_domain genpd;
 	char *name;
@@ -70,6 +80,18 @@ struct exynos_pm_domain {
 #endif
 	bool power_down_skipped;
 	unsigned int need_smc;
+
+	/*
+	 * power off delay learned from the recent idle gaps of the domain,
+	 * bounded by off_delay_max_ms which is 0 if the domain does not use it.
+	 */
+	unsigned int off_delay_max_ms;
+	unsigned int off_delay_ms;
+	u64 idle_gap_avg_ns;
+	ktime_t off_req_time;
+	bool off_pending;
+	struct delayed_work off_work;
+	struct exynos_pd_stat stat;
 };
 
 struct exynos_pd_dbg_info {
@@ -82,11 +104,17 @@ struct exynos_pd_dbg_info {
 
 #ifdef CONFIG_EXYNOS_PD
 struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name);
+struct exynos_pm_domain *exynos_pd_from_genpd(struct generic_pm_domain *genpd);
 #else
 static inline struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name)
 {
 	return NULL;
 }
+
+static inline struct exynos_pm_domain *exynos_pd_from_genpd(struct generic_pm_domain *genpd)
+{
+	return NULL;
+}
 #endif
 
 #ifdef CONFIG_SND_SOC_SAMSUNG_VTS
@@ -112,6 +112,12 @@ extern u64 exynos_get_eint_wake_mask(void);
 static inline u64 exynos_get_eint_wake_mask(void) { return 0xffffffffL; }
 #endif
 
+#ifdef CONFIG_CPU_IDLE_GOV_EXYNOS
+extern s64 exynos_idle_predicted_us(unsigned int cpu);
+#else
+static inline s64 exynos_idle_predicted_us(unsigned int cpu) { return -1; }
+#endif
+
 /* SUPPORT HOTPLUG */
 #ifdef CONFIG_HOTPLUG_CPU
 extern int exynos_hotplug_in_callback(unsigned int cpu);
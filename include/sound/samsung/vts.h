@@ -12,6 +12,22 @@
 #define __VTS_H
 
 #include <linux/platform_device.h>
+#include <linux/notifier.h>
+
+/* events reported through vts_register_notifier() */
+#define VTS_EVENT_TRIGGERED	(1)
+
+/**
+ * Information passed with VTS_EVENT_TRIGGERED
+ * @id:		keyword id reported by the firmware
+ * @score:	detection score
+ * @frame_count: frames of pre-roll buffered in the trigger DMA buffer
+ */
+struct vts_trigger_info {
+	unsigned int id;
+	unsigned int score;
+	unsigned int frame_count;
+};
 
 #ifdef CONFIG_SND_SOC_SAMSUNG_VTS
 /**
@@ -43,6 +59,20 @@ extern int vts_clear_sram(struct platform_device *pdev);
  */
 extern volatile bool vts_is_on(void);
 extern volatile bool vts_is_recognitionrunning(void);
+
+/**
+ * Register a notifier for VTS events
+ * @param[in]	nb	notifier block, called in process context
+ * @return		error code if any
+ */
+extern int vts_register_notifier(struct notifier_block *nb);
+
+/**
+ * Unregister a notifier for VTS events
+ * @param[in]	nb	notifier block
+ * @return		error code if any
+ */
+extern int vts_unregister_notifier(struct notifier_block *nb);
 #else /* !CONFIG_SND_SOC_SAMSUNG_VTS */
 static inline int vts_acquire_sram(struct platform_device *pdev, int vts)
 { return -ENODEV; }
@@ -51,6 +81,10 @@ static inline int vts_release_sram(struct platform_device *pdev, int vts)
 static inline int vts_clear_sram(struct platform_device *pdev) { return -ENODEV; }
 static inline bool vts_is_on(void) { return false; }
 static inline bool vts_is_recognitionrunning(void) { return false; }
+static inline int vts_register_notifier(struct notifier_block *nb)
+{ return -ENODEV; }
+static inline int vts_unregister_notifier(struct notifier_block *nb)
+{ return -ENODEV; }
 #endif /* !CONFIG_SND_SOC_SAMSUNG_VTS */
 
 #endif /* __VTS_H */
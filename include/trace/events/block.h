@@ -676,6 +676,60 @@ TRACE_EVENT(block_rq_remap,
 		  (unsigned long long)__entry->old_sector, __entry->nr_bios)
 );
 
+#ifdef CONFIG_BLK_IO_TIMELINE
+/**
+ * block_rq_timeline - a request went all the way from submission to completion
+ * @rq: block IO operation request
+ *
+ * Reports, in ns, how long the request spent between each stamped stage
+ * of its way down and back, see enum blk_io_stage. A stage it did not go
+ * through reads as 0 and is counted in the next one.
+ */
+TRACE_EVENT(block_rq_timeline,
+
+	TP_PROTO(struct request *rq),
+
+	TP_ARGS(rq),
+
+	TP_STRUCT__entry(
+		__field(  dev_t,	dev			)
+		__field(  sector_t,	sector			)
+		__field(  unsigned int,	nr_sector		)
+		__array(  char,		rwbs,	RWBS_LEN	)
+		__array(  u32,		delta,	BLK_IO_NR_STAGES	)
+	),
+
+	TP_fast_assign(
+		u64 prev = rq->io_stamp[BLK_IO_SUBMIT];
+		int i;
+
+		__entry->dev	   = rq->rq_disk ? disk_devt(rq->rq_disk) : 0;
+		__entry->sector    = rq->io_stamp_sector;
+		__entry->nr_sector = rq->io_stamp_bytes >> 9;
+		blk_fill_rwbs(__entry->rwbs, req_op(rq), rq->cmd_flags,
+			      rq->io_stamp_bytes);
+
+		__entry->delta[BLK_IO_SUBMIT] = 0;
+		for (i = BLK_IO_SUBMIT + 1; i < BLK_IO_NR_STAGES; i++) {
+			if (!rq->io_stamp[i]) {
+				__entry->delta[i] = 0;
+				continue;
+			}
+			__entry->delta[i] = prev ? rq->io_stamp[i] - prev : 0;
+			prev = rq->io_stamp[i];
+		}
+	),
+
+	TP_printk("%d,%d %s %llu + %u insert %u dispatch %u queuecmd %u crypt %u doorbell %u irq %u done %u",
+		  MAJOR(__entry->dev), MINOR(__entry->dev), __entry->rwbs,
+		  (unsigned long long)__entry->sector, __entry->nr_sector,
+		  __entry->delta[BLK_IO_INSERT], __entry->delta[BLK_IO_DISPATCH],
+		  __entry->delta[BLK_IO_QUEUECMD], __entry->delta[BLK_IO_CRYPT],
+		  __entry->delta[BLK_IO_DOORBELL], __entry->delta[BLK_IO_IRQ],
+		  __entry->delta[BLK_IO_DONE])
+);
+#endif
+
 #endif /* _TRACE_BLOCK_H */
 
 /* This part must be outside protection */
@@ -52,6 +52,43 @@ DEFINE_EVENT(mm_filemap_op_page_cache, mm_filemap_add_to_page_cache,
 	TP_ARGS(page)
 	);
 
+#ifdef CONFIG_READAHEAD_PATTERN
+TRACE_EVENT(mm_filemap_ra_pattern,
+
+	TP_PROTO(struct inode *inode, pgoff_t index, unsigned int pattern,
+		 long stride),
+
+	TP_ARGS(inode, index, pattern, stride),
+
+	TP_STRUCT__entry(
+		__field(unsigned long, i_ino)
+		__field(dev_t, s_dev)
+		__field(pgoff_t, index)
+		__field(unsigned int, pattern)
+		__field(long, stride)
+	),
+
+	TP_fast_assign(
+		__entry->i_ino = inode->i_ino;
+		__entry->s_dev = inode->i_sb->s_dev;
+		__entry->index = index;
+		__entry->pattern = pattern;
+		__entry->stride = stride;
+	),
+
+	TP_printk("dev %d:%d ino %lx ofs=%lu pattern=%s stride=%ld",
+		MAJOR(__entry->s_dev), MINOR(__entry->s_dev),
+		__entry->i_ino,
+		__entry->index << PAGE_SHIFT,
+		__print_symbolic(__entry->pattern,
+			{ RA_PATTERN_NONE,	"none" },
+			{ RA_PATTERN_SEQ,	"sequential" },
+			{ RA_PATTERN_STRIDED,	"strided" },
+			{ RA_PATTERN_RANDOM,	"random" }),
+		__entry->stride)
+);
+#endif
+
 #endif /* _TRACE_FILEMAP_H */
 
 /* This part must be outside protection */
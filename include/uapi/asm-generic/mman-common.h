@@ -58,6 +58,9 @@
 					   overrides the coredump filter bits */
 #define MADV_DODUMP	17		/* Clear the MADV_DONTDUMP flag */
 
+#define MADV_CONTPTE	60		/* Worth backing with contiguous PTEs */
+#define MADV_NOCONTPTE	61		/* Not worth backing with contiguous PTEs */
+
 /* compatibility flags */
 #define MAP_FILE	0
 
@@ -0,0 +1,54 @@
+/*
+ * Exynos BCM counter streaming interface
+ *
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef _UAPI_LINUX_EXYNOS_BCM_H
+#define _UAPI_LINUX_EXYNOS_BCM_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define BCM_STREAM_MAGIC	0x4243534d	/* "BCSM" */
+#define BCM_STREAM_VERSION	1
+
+/*
+ * /dev/bcm_stream maps read-only as one header page followed by
+ * nr_records records. The kernel writes record (head % nr_records) and
+ * then advances head; a reader that falls more than nr_records behind has
+ * lost the oldest records.
+ */
+struct bcm_stream_header {
+	__u32 magic;
+	__u32 version;
+	__u32 record_size;
+	__u32 nr_records;
+	__u32 data_offset;
+	__u32 notify_records;
+	__u64 head;
+};
+
+/* One firmware output record, stamped with the sample time in ns */
+struct bcm_stream_record {
+	__u64 timestamp;
+	__s32 index;
+	__u32 rd0;
+	__u32 rd1;
+	__u32 rd2;
+	__u64 rd3;
+	__u64 rd4;
+	__u64 rd5;
+};
+
+/* eventfd to signal every notify_records records, -1 to clear */
+#define BCM_STREAM_SET_EVENTFD	_IOW('B', 1, __s32)
+/* number of records between eventfd signals */
+#define BCM_STREAM_SET_NOTIFY	_IOW('B', 2, __u32)
+
+#endif /* _UAPI_LINUX_EXYNOS_BCM_H */
@@ -114,7 +114,22 @@ struct m2m1shot_custom_data {
 	unsigned long arg;
 };
 
+#define M2M1SHOT_BATCH_MAX	32
+
+/*
+ * tasks: user pointer to an array of count struct m2m1shot processed in
+ *        order under the same context. Each entry is written back like
+ *        M2M1SHOT_IOC_PROCESS does.
+ * done : number of tasks processed successfully, set by the driver
+ */
+struct m2m1shot_batch {
+	__u64 tasks;
+	__u32 count;
+	__u32 done;
+};
+
 #define M2M1SHOT_IOC_PROCESS	_IOWR('M',  0, struct m2m1shot)
+#define M2M1SHOT_IOC_PROCESS_BATCH	_IOWR('M',  1, struct m2m1shot_batch)
 #define M2M1SHOT_IOC_CUSTOM	_IOWR('M', 16, struct m2m1shot_custom_data)
 
 #endif /* _UAPI__M2M1SHOT_H_ */
@@ -283,6 +283,9 @@ enum
 	LINUX_MIB_TCPMTUPFAIL,			/* TCPMTUPFail */
 	LINUX_MIB_TCPMTUPSUCCESS,		/* TCPMTUPSuccess */
 	LINUX_MIB_TCPWQUEUETOOBIG,		/* TCPWqueueTooBig */
+	LINUX_MIB_IP6SKDSTHIT,			/* IP6SkDstHit */
+	LINUX_MIB_IP6SKDSTREVALIDATED,		/* IP6SkDstRevalidated */
+	LINUX_MIB_IP6SKDSTMISS,			/* IP6SkDstMiss */
 	__LINUX_MIB_MAX
 };
 
@@ -127,6 +127,7 @@ enum {
 #define TCP_SAVED_SYN		28	/* Get SYN headers recorded for connection */
 #define TCP_REPAIR_WINDOW	29	/* Get/set window parameters */
 #define TCP_FASTOPEN_CONNECT	30	/* Attempt FastOpen with connect */
+#define TCP_ZEROCOPY_RECEIVE	35	/* Map received payload pages */
 #ifdef CONFIG_MPTCP
 #define MPTCP_ENABLED		42
 #define MPTCP_SCHEDULER		43
@@ -141,6 +142,13 @@ struct tcp_repair_opt {
 	__u32	opt_val;
 };
 
+/* setsockopt(fd, IPPROTO_TCP, TCP_ZEROCOPY_RECEIVE, ...) */
+struct tcp_zerocopy_receive {
+	__u64 address;		/* in: address of mapping */
+	__u32 length;		/* in/out: number of bytes to map/mapped */
+	__u32 recv_skip_hint;	/* out: amount of bytes to skip */
+};
+
 struct tcp_repair_window {
 	__u32	snd_wl1;
 	__u32	snd_wnd;
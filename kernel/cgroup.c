@@ -2981,6 +2981,122 @@ static ssize_t cgroup_procs_write(struct kernfs_open_file *of,
 	return __cgroup_procs_write(of, buf, nbytes, off, true);
 }
 
+#ifdef CONFIG_SAMSUNG_FREECESS
+static bool cgroup_uid_listed(struct task_struct *p, const kuid_t *uids,
+			      int nr_uids)
+{
+	kuid_t uid = task_uid(p);
+	int i;
+
+	for (i = 0; i < nr_uids; i++)
+		if (uid_eq(uid, uids[i]))
+			return true;
+	return false;
+}
+
+/**
+ * cgroup_attach_uids - move all processes of a set of uids to a cgroup
+ * @ss: subsystem whose hierarchy @path is on
+ * @path: destination cgroup, relative to the root of that hierarchy
+ * @uids: real uids of the processes to move
+ * @nr_uids: number of entries in @uids
+ * @nr_failed: out, number of processes that could not be moved
+ *
+ * Writing each pid to cgroup.procs takes cgroup_mutex and
+ * cgroup_threadgroup_rwsem once per process. Take both once and move
+ * every matching process under them instead; processes already in the
+ * destination are left alone. Returns the number of processes moved or
+ * -errno.
+ */
+int cgroup_attach_uids(struct cgroup_subsys *ss, const char *path,
+		       const kuid_t *uids, int nr_uids, int *nr_failed)
+{
+	struct task_struct **tasks = NULL, *p;
+	struct cgroup_subsys *pss;
+	struct kernfs_node *kn;
+	struct cgroup *dst_cgrp;
+	int i, nr = 0, nr_match = 0, ret = 0, ssid;
+
+	*nr_failed = 0;
+
+	mutex_lock(&cgroup_mutex);
+
+	if (!(ss->root->subsys_mask & (1 << ss->id))) {
+		mutex_unlock(&cgroup_mutex);
+		return -ENODEV;
+	}
+
+	kn = kernfs_walk_and_get(ss->root->cgrp.kn, path);
+	if (!kn) {
+		mutex_unlock(&cgroup_mutex);
+		return -ENOENT;
+	}
+	dst_cgrp = kernfs_type(kn) == KERNFS_DIR ? kn->priv : NULL;
+	kernfs_put(kn);
+
+	/* cgroup_mutex keeps @dst_cgrp from being removed from here on */
+	if (!dst_cgrp || cgroup_is_dead(dst_cgrp)) {
+		mutex_unlock(&cgroup_mutex);
+		return -ENOENT;
+	}
+	if (!cgroup_may_migrate_to(dst_cgrp)) {
+		mutex_unlock(&cgroup_mutex);
+		return -EBUSY;
+	}
+
+	percpu_down_write(&cgroup_threadgroup_rwsem);
+
+	/* new processes can't appear while we hold the rwsem */
+	rcu_read_lock();
+	for_each_process(p)
+		if (cgroup_uid_listed(p, uids, nr_uids))
+			nr_match++;
+	rcu_read_unlock();
+
+	if (nr_match) {
+		tasks = kmalloc_array(nr_match, sizeof(*tasks), GFP_KERNEL);
+		if (!tasks) {
+			ret = -ENOMEM;
+			goto out_unlock;
+		}
+	}
+
+	spin_lock_irq(&css_set_lock);
+	rcu_read_lock();
+	for_each_process(p) {
+		if (nr == nr_match)
+			break;
+		if (!cgroup_uid_listed(p, uids, nr_uids) ||
+		    (p->flags & (PF_EXITING | PF_KTHREAD)) ||
+		    p->no_cgroup_migration)
+			continue;
+		if (task_cgroup_from_root(p, dst_cgrp->root) == dst_cgrp)
+			continue;
+		get_task_struct(p);
+		tasks[nr++] = p;
+	}
+	rcu_read_unlock();
+	spin_unlock_irq(&css_set_lock);
+
+	for (i = 0; i < nr; i++) {
+		if (!cgroup_attach_task(dst_cgrp, tasks[i], true))
+			ret++;
+		else
+			(*nr_failed)++;
+		put_task_struct(tasks[i]);
+	}
+	kfree(tasks);
+
+out_unlock:
+	percpu_up_write(&cgroup_threadgroup_rwsem);
+	for_each_subsys(pss, ssid)
+		if (pss->post_attach)
+			pss->post_attach();
+	mutex_unlock(&cgroup_mutex);
+	return ret;
+}
+#endif /* CONFIG_SAMSUNG_FREECESS */
+
 static ssize_t cgroup_release_agent_write(struct kernfs_open_file *of,
 					  char *buf, size_t nbytes, loff_t off)
 {
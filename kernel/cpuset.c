@@ -1531,6 +1531,7 @@ static void cpuset_attach(struct cgroup_taskset *tset)
 	struct cgroup_subsys_state *css;
 	struct cpuset *cs;
 	struct cpuset *oldcs = cpuset_attach_old_cs;
+	bool mems_changed = false;
 
 	cgroup_taskset_first(tset, &css);
 	cs = css_cs(css);
@@ -1550,17 +1551,34 @@ static void cpuset_attach(struct cgroup_taskset *tset)
 		 * can_attach beforehand should guarantee that this doesn't
 		 * fail.  TODO: have a better way to handle failure here
 		 */
-		WARN_ON_ONCE(set_cpus_allowed_ptr(task, cpus_attach));
+		if (!cpumask_equal(&task->cpus_allowed, cpus_attach))
+			WARN_ON_ONCE(set_cpus_allowed_ptr(task, cpus_attach));
 
-		cpuset_change_task_nodemask(task, &cpuset_attach_nodemask_to);
+		/*
+		 * Moves between the top-app, foreground and background
+		 * cpusets only change cpus. mems_allowed is only written
+		 * under cpuset_mutex, so it can be compared unlocked.
+		 */
+		if (!nodes_equal(task->mems_allowed,
+				 cpuset_attach_nodemask_to)) {
+			cpuset_change_task_nodemask(task,
+					&cpuset_attach_nodemask_to);
+			mems_changed = true;
+		}
 		cpuset_update_task_spread_flag(cs, task);
 	}
 
 	/*
 	 * Change mm for all threadgroup leaders. This is expensive and may
-	 * sleep and should be moved outside migration path proper.
+	 * sleep and should be moved outside migration path proper. It is a
+	 * no-op, apart from taking each mmap_sem for write, when no task
+	 * changed mems and the old cpuset had the same mems.
 	 */
 	cpuset_attach_nodemask_to = cs->effective_mems;
+	if (!mems_changed &&
+	    nodes_equal(oldcs->old_mems_allowed, cpuset_attach_nodemask_to))
+		goto out;
+
 	cgroup_taskset_for_each_leader(leader, css, tset) {
 		struct mm_struct *mm = get_task_mm(leader);
 
@@ -1583,6 +1601,7 @@ static void cpuset_attach(struct cgroup_taskset *tset)
 		}
 	}
 
+out:
 	cs->old_mems_allowed = cpuset_attach_nodemask_to;
 
 	cs->attach_in_progress--;
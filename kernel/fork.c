@@ -73,6 +73,7 @@
 #include <linux/user-return-notifier.h>
 #include <linux/oom.h>
 #include <linux/khugepaged.h>
+#include <linux/contpte.h>
 #include <linux/signalfd.h>
 #include <linux/uprobes.h>
 #include <linux/aio.h>
@@ -604,6 +605,9 @@ static __latent_entropy int dup_mmap(struct mm_struct *mm,
 	if (retval)
 		goto out;
 	retval = khugepaged_fork(mm, oldmm);
+	if (retval)
+		goto out;
+	retval = contpte_fork(mm, oldmm);
 	if (retval)
 		goto out;
 
@@ -889,6 +893,7 @@ static inline void __mmput(struct mm_struct *mm)
 	ksm_exit(mm);
 	khugepaged_exit(mm); /* must run before exit_mmap */
 	exit_mmap(mm);
+	memkill_mm_released(mm);
 	mm_put_huge_zero_page(mm);
 	set_mm_exe_file(mm, NULL);
 	if (!list_empty(&mm->mmlist)) {
@@ -1448,6 +1453,11 @@ static void rt_mutex_init_task(struct task_struct *p)
 	p->pi_waiters = RB_ROOT;
 	p->pi_waiters_leftmost = NULL;
 	p->pi_blocked_on = NULL;
+#ifdef CONFIG_CGROUP_SCHEDTUNE
+	p->st_pi_boost = 0;
+	p->st_pi_prefer_idle = 0;
+	p->st_pi_prefer_perf = 0;
+#endif
 #endif
 }
 
@@ -1757,6 +1767,9 @@ static __latent_entropy struct task_struct *copy_process(
 	p->flags &= ~(PF_SUPERPRIV | PF_WQ_WORKER);
 	p->flags |= PF_FORKNOEXEC;
 	INIT_LIST_HEAD(&p->children);
+#ifdef CONFIG_ANDROID_LMK_ADJ_RBTREE
+	RB_CLEAR_NODE(&p->lmk_adj_node);
+#endif
 	INIT_LIST_HEAD(&p->sibling);
 	rcu_copy_process(p);
 	p->vfork_done = NULL;
@@ -1779,6 +1792,11 @@ static __latent_entropy struct task_struct *copy_process(
 #endif
 
 	p->default_timer_slack_ns = current->timer_slack_ns;
+#ifdef CONFIG_CGROUP_SCHED
+	/* a slack imposed by the cpu cgroup is not the parent's own */
+	if (current->cgroup_timer_slack_ns)
+		p->default_timer_slack_ns = current->default_timer_slack_ns;
+#endif
 
 #ifdef CONFIG_PSI
 	p->psi_flags = 0;
@@ -2041,6 +2059,7 @@ static __latent_entropy struct task_struct *copy_process(
 			p->signal->tty = tty_kref_get(current->signal->tty);
 			list_add_tail(&p->sibling, &p->real_parent->children);
 			list_add_tail_rcu(&p->tasks, &init_task.tasks);
+			lmk_adj_tree_add(p);
 			attach_pid(p, PIDTYPE_PGID);
 			attach_pid(p, PIDTYPE_SID);
 			__this_cpu_inc(process_counts);
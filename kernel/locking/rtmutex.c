@@ -356,6 +356,31 @@ int rt_mutex_get_effective_prio(struct task_struct *task, int newprio)
 	return newprio;
 }
 
+#ifdef CONFIG_CGROUP_SCHEDTUNE
+/*
+ * Let @task inherit the schedtune boost, prefer_idle and prefer_perf of the
+ * top waiters of the locks it holds.  Priority inheritance alone does not
+ * move a CFS lock owner out of a background group, so a UI thread blocked
+ * on it would still wait for a little core at a low frequency.
+ *
+ * task->pi_lock must be held.
+ */
+static void rt_mutex_adjust_boost(struct task_struct *task)
+{
+	struct rt_mutex_waiter *waiter;
+	struct rb_node *node;
+
+	schedtune_pi_inherit(task, NULL);
+
+	for (node = rb_first(&task->pi_waiters); node; node = rb_next(node)) {
+		waiter = rb_entry(node, struct rt_mutex_waiter, pi_tree_entry);
+		schedtune_pi_inherit(task, waiter->task);
+	}
+}
+#else
+static inline void rt_mutex_adjust_boost(struct task_struct *task) { }
+#endif
+
 /*
  * Adjust the priority of a task, after its pi_waiters got modified.
  *
@@ -365,6 +390,8 @@ static void __rt_mutex_adjust_prio(struct task_struct *task)
 {
 	int prio = rt_mutex_getprio(task);
 
+	rt_mutex_adjust_boost(task);
+
 	if (task->prio != prio || dl_prio(prio))
 		rt_mutex_setprio(task, prio);
 }
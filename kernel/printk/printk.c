@@ -42,6 +42,7 @@
 #include <linux/rculist.h>
 #include <linux/poll.h>
 #include <linux/irq_work.h>
+#include <linux/kthread.h>
 #include <linux/utsname.h>
 #include <linux/ctype.h>
 #include <linux/uio.h>
@@ -1917,6 +1918,68 @@ static size_t log_output(int facility, int level, enum log_flags lflags, const c
 	return log_store(facility, level, lflags, 0, dict, dictlen, text, text_len);
 }
 
+/*
+ * With offloading, printk() only stores the message and the "printk"
+ * kthread prints it to the consoles, so a slow UART or pstore console
+ * does not stall whoever hit the message. Oopses, panics, reboots and
+ * messages of KERN_CRIT or more are still printed by the caller.
+ */
+static bool printk_offload = IS_ENABLED(CONFIG_PRINTK_OFFLOAD);
+module_param_named(offload, printk_offload, bool, S_IRUGO | S_IWUSR);
+
+static struct task_struct *printk_offload_thread;
+static atomic_t printk_offload_pending = ATOMIC_INIT(0);
+
+static bool printk_offload_console(int level)
+{
+	if (!printk_offload || !printk_offload_thread)
+		return false;
+
+	if (oops_in_progress || system_state != SYSTEM_RUNNING ||
+	    level <= LOGLEVEL_CRIT)
+		return false;
+
+	if (!atomic_xchg(&printk_offload_pending, 1))
+		wake_up_process(printk_offload_thread);
+
+	return true;
+}
+
+static int printk_offload_fn(void *data)
+{
+	set_user_nice(current, MAX_NICE);
+
+	while (!kthread_should_stop()) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (!atomic_xchg(&printk_offload_pending, 0)) {
+			schedule();
+			continue;
+		}
+		__set_current_state(TASK_RUNNING);
+
+		console_lock();
+		console_unlock();
+	}
+	__set_current_state(TASK_RUNNING);
+
+	return 0;
+}
+
+static int __init printk_offload_init(void)
+{
+	struct task_struct *thread;
+
+	thread = kthread_run(printk_offload_fn, NULL, "printk");
+	if (IS_ERR(thread)) {
+		pr_err("printk: failed to start the console thread\n");
+		return PTR_ERR(thread);
+	}
+	printk_offload_thread = thread;
+
+	return 0;
+}
+late_initcall(printk_offload_init);
+
 asmlinkage int vprintk_emit(int facility, int level,
 			    const char *dict, size_t dictlen,
 			    const char *fmt, va_list args)
@@ -2048,7 +2111,7 @@ asmlinkage int vprintk_emit(int facility, int level,
 	local_irq_restore(flags);
 
 	/* If called from the scheduler, we can not call up(). */
-	if (!in_sched) {
+	if (!in_sched && !printk_offload_console(level)) {
 		lockdep_off();
 		/*
 		 * Try to acquire and then immediately release the console
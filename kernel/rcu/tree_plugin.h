@@ -2281,6 +2281,72 @@ static void __init rcu_boot_init_nocb_percpu_data(struct rcu_data *rdp)
 	rdp->nocb_follower_tail = &rdp->nocb_follower_head;
 }
 
+/*
+ * CPUs the rcuo kthreads may run on, all of them if empty.  This can be
+ * changed at runtime, for instance to keep callback invocation on the
+ * little cluster while the no-CBs big cores run latency-critical tasks.
+ */
+static struct cpumask rcu_nocb_affinity;
+static DEFINE_MUTEX(rcu_nocb_affinity_mutex);
+
+static void rcu_nocb_set_affinity(struct task_struct *t)
+{
+	lockdep_assert_held(&rcu_nocb_affinity_mutex);
+
+	if (cpumask_intersects(&rcu_nocb_affinity, cpu_online_mask))
+		set_cpus_allowed_ptr(t, &rcu_nocb_affinity);
+	else
+		set_cpus_allowed_ptr(t, cpu_possible_mask);
+}
+
+static int param_set_nocb_affinity(const char *val,
+				   const struct kernel_param *kp)
+{
+	struct rcu_state *rsp;
+	struct task_struct *t;
+	int cpu, ret;
+
+	mutex_lock(&rcu_nocb_affinity_mutex);
+
+	ret = cpulist_parse(val, &rcu_nocb_affinity);
+	if (ret) {
+		cpumask_clear(&rcu_nocb_affinity);
+		goto out;
+	}
+
+	/* Move the rcuo kthreads spawned so far, later ones follow at spawn. */
+	for_each_rcu_flavor(rsp) {
+		for_each_possible_cpu(cpu) {
+			t = READ_ONCE(per_cpu_ptr(rsp->rda, cpu)->nocb_kthread);
+			if (t)
+				rcu_nocb_set_affinity(t);
+		}
+	}
+
+out:
+	mutex_unlock(&rcu_nocb_affinity_mutex);
+	return ret;
+}
+
+static int param_get_nocb_affinity(char *buffer,
+				   const struct kernel_param *kp)
+{
+	int ret;
+
+	mutex_lock(&rcu_nocb_affinity_mutex);
+	ret = scnprintf(buffer, PAGE_SIZE, "%*pbl",
+			cpumask_pr_args(&rcu_nocb_affinity));
+	mutex_unlock(&rcu_nocb_affinity_mutex);
+
+	return ret;
+}
+
+static const struct kernel_param_ops rcu_nocb_affinity_ops = {
+	.set = param_set_nocb_affinity,
+	.get = param_get_nocb_affinity,
+};
+module_param_cb(rcu_nocb_affinity, &rcu_nocb_affinity_ops, NULL, 0644);
+
 /*
  * If the specified CPU is a no-CBs CPU that does not already have its
  * rcuo kthread for the specified RCU flavor, spawn it.  If the CPUs are
@@ -2326,7 +2392,11 @@ static void rcu_spawn_one_nocb_kthread(struct rcu_state *rsp, int cpu)
 	t = kthread_run(rcu_nocb_kthread, rdp_spawn,
 			"rcuo%c/%d", rsp->abbr, cpu);
 	BUG_ON(IS_ERR(t));
+
+	mutex_lock(&rcu_nocb_affinity_mutex);
+	rcu_nocb_set_affinity(t);
 	WRITE_ONCE(rdp_spawn->nocb_kthread, t);
+	mutex_unlock(&rcu_nocb_affinity_mutex);
 }
 
 /*
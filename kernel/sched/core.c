@@ -78,6 +78,8 @@
 #include <linux/exynos-ss.h>
 #include <linux/cpufreq_times.h>
 #include <linux/sched/loadavg.h>
+#include <linux/ehmp.h>
+#include <linux/sec_heavy_task_cpu.h>
 
 #include <asm/switch_to.h>
 #include <asm/tlb.h>
@@ -1633,6 +1635,38 @@ static int select_fallback_rq(int cpu, struct task_struct *p)
 	return dest_cpu;
 }
 
+#ifdef CONFIG_EXYNOS_HOTPLUG_GOVERNOR
+/*
+ * Move a wakeup off a cpu parked by the hotplug governor: stay on the
+ * previous cpu or the same cluster if possible. Tasks affine only to parked
+ * cpus keep the selected one.
+ */
+static int select_unparked_rq(struct task_struct *p, int cpu)
+{
+	struct cpumask allowed;
+	int new_cpu;
+
+	cpumask_andnot(&allowed, tsk_cpus_allowed(p), &exynos_hpgov_parked_mask);
+	cpumask_and(&allowed, &allowed, cpu_active_mask);
+
+	if (cpumask_test_cpu(task_cpu(p), &allowed))
+		return task_cpu(p);
+
+	new_cpu = cpumask_any_and(&allowed, cpu_coregroup_mask(cpu));
+	if (new_cpu < nr_cpu_ids)
+		return new_cpu;
+
+	new_cpu = cpumask_any(&allowed);
+
+	return new_cpu < nr_cpu_ids ? new_cpu : cpu;
+}
+#else
+static inline int select_unparked_rq(struct task_struct *p, int cpu)
+{
+	return cpu;
+}
+#endif
+
 /*
  * The caller (fork, wakeup) owns p->pi_lock, ->cpus_allowed is stable.
  */
@@ -1660,6 +1694,9 @@ int select_task_rq(struct task_struct *p, int cpu, int sd_flags, int wake_flags)
 		     !cpu_online(cpu)))
 		cpu = select_fallback_rq(task_cpu(p), p);
 
+	if (unlikely(exynos_hpgov_cpu_parked(cpu)))
+		cpu = select_unparked_rq(p, cpu);
+
 	return cpu;
 }
 
@@ -3280,10 +3317,12 @@ void scheduler_tick(void)
 	raw_spin_unlock(&rq->lock);
 
 	perf_event_task_tick();
+	sec_heavy_task_cpu_tick(cpu, curr);
 
 #ifdef CONFIG_SMP
 	rq->idle_balance = idle_cpu(cpu);
 	trigger_load_balance(rq);
+	ehmp_update_cluster_snapshot(cpu);
 #endif
 	rq_last_tick_reset(rq);
 }
@@ -8778,13 +8817,75 @@ static int cpu_cgroup_can_attach(struct cgroup_taskset *tset)
 	return ret;
 }
 
+/*
+ * Give @p the timer policy of @tg. Leaving a group which imposed a slack
+ * restores the task's own one, a group without a slack keeps whatever the
+ * task set itself.
+ */
+static void tg_apply_timer_slack(struct task_group *tg, struct task_struct *p)
+{
+	if (tg->timer_slack_ns)
+		p->timer_slack_ns = tg->timer_slack_ns;
+	else if (p->cgroup_timer_slack_ns)
+		p->timer_slack_ns = p->default_timer_slack_ns;
+	p->cgroup_timer_slack_ns = tg->timer_slack_ns;
+	p->cgroup_timer_align_ns = tg->timer_align_ns;
+}
+
 static void cpu_cgroup_attach(struct cgroup_taskset *tset)
 {
 	struct task_struct *task;
 	struct cgroup_subsys_state *css;
 
-	cgroup_taskset_for_each(task, css, tset)
+	cgroup_taskset_for_each(task, css, tset) {
 		sched_move_task(task);
+		tg_apply_timer_slack(css_tg(css), task);
+	}
+}
+
+static void cpu_timer_policy_update(struct cgroup_subsys_state *css)
+{
+	struct css_task_iter it;
+	struct task_struct *p;
+
+	css_task_iter_start(css, &it);
+	while ((p = css_task_iter_next(&it)))
+		tg_apply_timer_slack(css_tg(css), p);
+	css_task_iter_end(&it);
+}
+
+static u64 cpu_timer_slack_read_u64(struct cgroup_subsys_state *css,
+				    struct cftype *cft)
+{
+	return css_tg(css)->timer_slack_ns;
+}
+
+static int cpu_timer_slack_write_u64(struct cgroup_subsys_state *css,
+				     struct cftype *cft, u64 slack)
+{
+	if (slack > ULONG_MAX)
+		return -EINVAL;
+
+	css_tg(css)->timer_slack_ns = slack;
+	cpu_timer_policy_update(css);
+	return 0;
+}
+
+static u64 cpu_timer_align_read_u64(struct cgroup_subsys_state *css,
+				    struct cftype *cft)
+{
+	return css_tg(css)->timer_align_ns;
+}
+
+static int cpu_timer_align_write_u64(struct cgroup_subsys_state *css,
+				     struct cftype *cft, u64 align)
+{
+	if (align > NSEC_PER_SEC * 60)
+		return -EINVAL;
+
+	css_tg(css)->timer_align_ns = align;
+	cpu_timer_policy_update(css);
+	return 0;
 }
 
 #ifdef CONFIG_FAIR_GROUP_SCHED
@@ -9107,6 +9208,18 @@ static struct cftype cpu_files[] = {
 		.write_u64 = cpu_rt_period_write_uint,
 	},
 #endif
+	{
+		.name = "timer_slack_ns",
+		.flags = CFTYPE_NOT_ON_ROOT,
+		.read_u64 = cpu_timer_slack_read_u64,
+		.write_u64 = cpu_timer_slack_write_u64,
+	},
+	{
+		.name = "timer_align_ns",
+		.flags = CFTYPE_NOT_ON_ROOT,
+		.read_u64 = cpu_timer_align_read_u64,
+		.write_u64 = cpu_timer_align_write_u64,
+	},
 	{ }	/* terminate */
 };
 
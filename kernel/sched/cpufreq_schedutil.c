@@ -29,11 +29,13 @@ unsigned long boosted_cpu_util(int cpu);
 #define cpufreq_enable_fast_switch(x)
 #define cpufreq_disable_fast_switch(x)
 #define LATENCY_MULTIPLIER			(1000)
+#define DEFAULT_TRANSITION_COST_FACTOR		(10)
 
 struct sugov_tunables {
 	struct gov_attr_set attr_set;
 	unsigned int up_rate_limit_us;
 	unsigned int down_rate_limit_us;
+	unsigned int transition_cost_factor;
 };
 
 struct sugov_policy {
@@ -57,6 +59,15 @@ struct sugov_policy {
 	bool work_in_progress;
 
 	bool need_freq_update;
+
+	/*
+	 * Measured cost of the frequency transitions, indexed by the from/to
+	 * positions in policy->freq_table, and how long the requested
+	 * frequencies have been lasting recently.
+	 */
+	u32 *trans_cost_ns;
+	int nr_freqs;
+	u64 avg_hold_ns;
 };
 
 struct sugov_cpu {
@@ -80,6 +91,21 @@ struct sugov_cpu {
 
 static DEFINE_PER_CPU(struct sugov_cpu, sugov_cpu);
 
+/*
+ * Advisory ceiling for the frequency schedutil asks for. Unlike
+ * policy->max it does not bound other requests, it only keeps the
+ * governor from selecting frequencies the platform is about to throttle.
+ */
+static DEFINE_PER_CPU(unsigned int, sugov_freq_ceiling) = UINT_MAX;
+
+void sugov_set_freq_ceiling(const struct cpumask *cpus, unsigned int freq)
+{
+	int cpu;
+
+	for_each_cpu(cpu, cpus)
+		WRITE_ONCE(per_cpu(sugov_freq_ceiling, cpu), freq ? freq : UINT_MAX);
+}
+
 /******************* exynos specific function *******************/
 #define DEFAULT_EXPIRED_TIME	70
 struct sugov_exynos {
@@ -123,6 +149,69 @@ static bool sugov_should_update_freq(struct sugov_policy *sg_policy, u64 time)
 	return delta_ns >= sg_policy->min_rate_limit_ns;
 }
 
+/*
+ * A transition only pays off if the new frequency is kept for a while
+ * compared to what the switch itself costs. Estimate how long it will be kept
+ * from how long the recent requests lasted, and hold back transitions that
+ * cannot be amortized over transition_cost_factor times their cost.
+ */
+static u32 sugov_transition_cost(struct sugov_policy *sg_policy,
+				 unsigned int from, unsigned int to)
+{
+	struct cpufreq_policy *policy = sg_policy->policy;
+	int i, j;
+
+	if (!sg_policy->trans_cost_ns)
+		return 0;
+
+	i = cpufreq_frequency_table_get_index(policy, from);
+	j = cpufreq_frequency_table_get_index(policy, to);
+	if (i < 0 || j < 0)
+		return 0;
+
+	return READ_ONCE(sg_policy->trans_cost_ns[i * sg_policy->nr_freqs + j]);
+}
+
+static void sugov_update_transition_cost(struct sugov_policy *sg_policy,
+				unsigned int from, unsigned int to, u64 cost)
+{
+	struct cpufreq_policy *policy = sg_policy->policy;
+	u32 *entry, old;
+	int i, j;
+
+	if (!sg_policy->trans_cost_ns || from == to)
+		return;
+
+	i = cpufreq_frequency_table_get_index(policy, from);
+	j = cpufreq_frequency_table_get_index(policy, to);
+	if (i < 0 || j < 0)
+		return;
+
+	cost = min_t(u64, cost, U32_MAX);
+	entry = &sg_policy->trans_cost_ns[i * sg_policy->nr_freqs + j];
+	old = READ_ONCE(*entry);
+
+	/* Start with the first sample, then weight the new one 1/4 */
+	WRITE_ONCE(*entry, old ? (u32)((3 * (u64)old + cost) >> 2) : (u32)cost);
+}
+
+static bool sugov_transition_too_costly(struct sugov_policy *sg_policy,
+				s64 delta_ns, unsigned int next_freq)
+{
+	unsigned int factor = sg_policy->tunables->transition_cost_factor;
+	u64 window;
+
+	if (!factor || sg_policy->next_freq == UINT_MAX)
+		return false;
+
+	window = (u64)factor * sugov_transition_cost(sg_policy,
+					sg_policy->next_freq, next_freq);
+	if (!window)
+		return false;
+
+	return sg_policy->avg_hold_ns < window && delta_ns < window;
+}
+
 static bool sugov_up_down_rate_limit(struct sugov_policy *sg_policy, u64 time,
 				     unsigned int next_freq)
 {
@@ -138,6 +227,10 @@ static bool sugov_up_down_rate_limit(struct sugov_policy *sg_policy, u64 time,
 	    delta_ns < sg_policy->down_rate_delay_ns)
 			return true;
 
+	if (next_freq != sg_policy->next_freq &&
+	    sugov_transition_too_costly(sg_policy, delta_ns, next_freq))
+		return true;
+
 	return false;
 }
 
@@ -176,6 +269,13 @@ static void sugov_update_commit(struct sugov_policy *sg_policy, u64 time,
 	if (sg_policy->next_freq == next_freq)
 		return;
 
+	if (sg_policy->last_freq_update_time) {
+		u64 hold = time - sg_policy->last_freq_update_time;
+
+		sg_policy->avg_hold_ns = sg_policy->avg_hold_ns ?
+			(3 * sg_policy->avg_hold_ns + hold) >> 2 : hold;
+	}
+
 	sg_policy->next_freq = next_freq;
 	sg_policy->last_freq_update_time = time;
 
@@ -235,6 +335,7 @@ static unsigned int get_next_freq(struct sugov_policy *sg_policy,
 				policy->max : policy->cur;
 
 	freq = freqvar_tipping_point(policy->cpu, freq) * util / max;
+	freq = min(freq, READ_ONCE(per_cpu(sugov_freq_ceiling, policy->cpu)));
 
 	if (freq == sg_policy->cached_raw_freq && sg_policy->next_freq != UINT_MAX)
 		return sg_policy->next_freq;
@@ -425,10 +526,17 @@ static void sugov_update_shared(struct update_util_data *hook, u64 time,
 static void sugov_work(struct work_struct *work)
 {
 	struct sugov_policy *sg_policy = container_of(work, struct sugov_policy, work);
+	struct cpufreq_policy *policy = sg_policy->policy;
+	unsigned int from;
+	u64 start;
 
 	mutex_lock(&sg_policy->work_lock);
-	__cpufreq_driver_target(sg_policy->policy, sg_policy->next_freq,
+	from = policy->cur;
+	start = ktime_get_ns();
+	__cpufreq_driver_target(policy, sg_policy->next_freq,
 				CPUFREQ_RELATION_L);
+	sugov_update_transition_cost(sg_policy, from, policy->cur,
+				     ktime_get_ns() - start);
 	mutex_unlock(&sg_policy->work_lock);
 
 	sg_policy->work_in_progress = false;
@@ -564,12 +672,72 @@ static ssize_t down_rate_limit_us_store(struct gov_attr_set *attr_set,
 	return count;
 }
 
+static ssize_t transition_cost_factor_show(struct gov_attr_set *attr_set,
+					   char *buf)
+{
+	struct sugov_tunables *tunables = to_sugov_tunables(attr_set);
+
+	return sprintf(buf, "%u\n", tunables->transition_cost_factor);
+}
+
+static ssize_t transition_cost_factor_store(struct gov_attr_set *attr_set,
+					    const char *buf, size_t count)
+{
+	struct sugov_tunables *tunables = to_sugov_tunables(attr_set);
+	unsigned int factor;
+
+	if (kstrtouint(buf, 10, &factor))
+		return -EINVAL;
+
+	tunables->transition_cost_factor = factor;
+
+	return count;
+}
+
+static ssize_t transition_cost_show(struct gov_attr_set *attr_set, char *buf)
+{
+	struct sugov_policy *sg_policy;
+	struct cpufreq_frequency_table *table;
+	ssize_t len = 0;
+	int i, j;
+
+	list_for_each_entry(sg_policy, &attr_set->policy_list, tunables_hook) {
+		if (!sg_policy->trans_cost_ns)
+			continue;
+
+		table = sg_policy->policy->freq_table;
+		len += scnprintf(buf + len, PAGE_SIZE - len, "policy%u\n",
+				 sg_policy->policy->cpu);
+
+		for (i = 0; i < sg_policy->nr_freqs; i++) {
+			for (j = 0; j < sg_policy->nr_freqs; j++) {
+				u32 cost = READ_ONCE(sg_policy->trans_cost_ns[i *
+							sg_policy->nr_freqs + j]);
+
+				if (!cost)
+					continue;
+
+				len += scnprintf(buf + len, PAGE_SIZE - len,
+						"%u -> %u: %u ns\n",
+						table[i].frequency,
+						table[j].frequency, cost);
+			}
+		}
+	}
+
+	return len;
+}
+
 static struct governor_attr up_rate_limit_us = __ATTR_RW(up_rate_limit_us);
 static struct governor_attr down_rate_limit_us = __ATTR_RW(down_rate_limit_us);
+static struct governor_attr transition_cost_factor = __ATTR_RW(transition_cost_factor);
+static struct governor_attr transition_cost = __ATTR_RO(transition_cost);
 
 static struct attribute *sugov_attributes[] = {
 	&up_rate_limit_us.attr,
 	&down_rate_limit_us.attr,
+	&transition_cost_factor.attr,
+	&transition_cost.attr,
 	NULL
 };
 
@@ -595,12 +763,29 @@ static struct sugov_policy *sugov_policy_alloc(struct cpufreq_policy *policy)
 	INIT_WORK(&sg_policy->work, sugov_work);
 	mutex_init(&sg_policy->work_lock);
 	raw_spin_lock_init(&sg_policy->update_lock);
+
+	if (policy->freq_table) {
+		struct cpufreq_frequency_table *pos;
+		int nr = 0;
+
+		for (pos = policy->freq_table;
+		     pos->frequency != CPUFREQ_TABLE_END; pos++)
+			nr++;
+
+		/* Without the cost table transitions are only rate limited */
+		sg_policy->trans_cost_ns = kcalloc(nr * nr,
+				sizeof(*sg_policy->trans_cost_ns), GFP_KERNEL);
+		if (sg_policy->trans_cost_ns)
+			sg_policy->nr_freqs = nr;
+	}
+
 	return sg_policy;
 }
 
 static void sugov_policy_free(struct sugov_policy *sg_policy)
 {
 	mutex_destroy(&sg_policy->work_lock);
+	kfree(sg_policy->trans_cost_ns);
 	kfree(sg_policy);
 }
 
@@ -666,6 +851,7 @@ static int sugov_init(struct cpufreq_policy *policy)
 
 	tunables->up_rate_limit_us = UP_LATENCY_MULTIPLIER;
 	tunables->down_rate_limit_us = DOWN_LATENCY_MULTIPLIER;
+	tunables->transition_cost_factor = DEFAULT_TRANSITION_COST_FACTOR;
 	lat = policy->cpuinfo.transition_latency / NSEC_PER_USEC;
 	if (lat) {
 		tunables->up_rate_limit_us *= lat;
@@ -763,6 +949,7 @@ static int sugov_start(struct cpufreq_policy *policy)
 		sg_policy->tunables->down_rate_limit_us * NSEC_PER_USEC;
 	update_min_rate_limit_us(sg_policy);
 	sg_policy->last_freq_update_time = 0;
+	sg_policy->avg_hold_ns = 0;
 	sg_policy->next_freq = UINT_MAX;
 	sg_policy->work_in_progress = false;
 	sg_policy->need_freq_update = false;
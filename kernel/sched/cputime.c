@@ -155,6 +155,7 @@ void account_user_time(struct task_struct *p, cputime_t cputime,
 	p->utime += cputime;
 	p->utimescaled += cputime_scaled;
 	account_group_user_time(p, cputime);
+	uid_sys_acct_add(p, UID_ACCT_UTIME, (__force u64) cputime);
 
 	index = (task_nice(p) > 0) ? CPUTIME_NICE : CPUTIME_USER;
 
@@ -212,6 +213,7 @@ void __account_system_time(struct task_struct *p, cputime_t cputime,
 	p->stime += cputime;
 	p->stimescaled += cputime_scaled;
 	account_group_system_time(p, cputime);
+	uid_sys_acct_add(p, UID_ACCT_STIME, (__force u64) cputime);
 
 	/* Add system time to cpustat. */
 	task_group_account_field(p, index, (__force u64) cputime);
@@ -10,6 +10,9 @@
 #include <linux/pm_qos.h>
 #include <linux/ehmp.h>
 #include <linux/sched_energy.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <soc/samsung/exynos-cpu_hotplug.h>
 
 #define CREATE_TRACE_POINTS
 #include <trace/events/ehmp.h>
@@ -392,8 +395,17 @@ static struct plist_head gb_list = PLIST_HEAD_INIT(gb_list);
 
 static DEFINE_SPINLOCK(gb_lock);
 
+/* Timed requests, all expired and decayed by gb_timer */
+static LIST_HEAD(gb_timed_list);
+static struct hrtimer gb_timer;
+
+#define GB_DECAY_STEP_NS	(10 * NSEC_PER_MSEC)
+
 static int gb_qos_max_value(void)
 {
+	if (plist_head_empty(&gb_list))
+		return 0;
+
 	return plist_last(&gb_list)->prio;
 }
 
@@ -402,15 +414,8 @@ static int gb_qos_req_value(struct gb_qos_request *req)
 	return req->node.prio;
 }
 
-void gb_qos_update_request(struct gb_qos_request *req, u32 new_value)
+static void __gb_qos_update_request(struct gb_qos_request *req, u32 new_value)
 {
-	unsigned long flags;
-
-	if (req->node.prio == new_value)
-		return;
-
-	spin_lock_irqsave(&gb_lock, flags);
-
 	if (req->active)
 		plist_del(&req->node, &gb_list);
 	else
@@ -419,8 +424,128 @@ void gb_qos_update_request(struct gb_qos_request *req, u32 new_value)
 	plist_node_init(&req->node, new_value);
 	plist_add(&req->node, &gb_list);
 
-	gb_value = gb_max_value * gb_qos_max_value() / 100;
 	trace_ehmp_global_boost(req->name, new_value);
+}
+
+static void __gb_qos_remove_request(struct gb_qos_request *req)
+{
+	if (req->timed) {
+		list_del(&req->timed_node);
+		req->timed = false;
+	}
+
+	if (req->active) {
+		plist_del(&req->node, &gb_list);
+		req->active = 0;
+	}
+
+	trace_ehmp_global_boost(req->name, 0);
+}
+
+/*
+ * Apply the decay curve of all timed requests at @now. Returns when the
+ * next update is due, KTIME_MAX if no timed request is left.
+ */
+static ktime_t gb_update_timed_requests(ktime_t now)
+{
+	struct gb_qos_request *req, *tmp;
+	ktime_t next = { .tv64 = KTIME_MAX };
+
+	list_for_each_entry_safe(req, tmp, &gb_timed_list, timed_node) {
+		u32 value = req->timed_value;
+		ktime_t due;
+
+		if (!ktime_before(now, req->expires)) {
+			__gb_qos_remove_request(req);
+			continue;
+		}
+
+		if (ktime_before(now, req->decay_start)) {
+			due = req->decay_start;
+		} else {
+			value = div64_u64((u64)value *
+					ktime_to_ns(ktime_sub(req->expires, now)),
+					ktime_to_ns(ktime_sub(req->expires,
+							req->decay_start)));
+			due = ktime_add_ns(now, GB_DECAY_STEP_NS);
+			if (ktime_after(due, req->expires))
+				due = req->expires;
+		}
+
+		if (gb_qos_req_value(req) != value || !req->active)
+			__gb_qos_update_request(req, value);
+
+		if (ktime_before(due, next))
+			next = due;
+	}
+
+	gb_value = gb_max_value * gb_qos_max_value() / 100;
+
+	return next;
+}
+
+static void gb_timer_start(ktime_t next)
+{
+	if (next.tv64 == KTIME_MAX)
+		return;
+
+	hrtimer_start(&gb_timer, next, HRTIMER_MODE_ABS);
+}
+
+static enum hrtimer_restart gb_timer_fn(struct hrtimer *timer)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&gb_lock, flags);
+	gb_timer_start(gb_update_timed_requests(ktime_get()));
+	spin_unlock_irqrestore(&gb_lock, flags);
+
+	return HRTIMER_NORESTART;
+}
+
+void gb_qos_update_request(struct gb_qos_request *req, u32 new_value)
+{
+	unsigned long flags;
+
+	if (req->node.prio == new_value && !req->timed)
+		return;
+
+	spin_lock_irqsave(&gb_lock, flags);
+
+	/* A plain update turns a timed request back into a permanent one */
+	if (req->timed) {
+		list_del(&req->timed_node);
+		req->timed = false;
+	}
+
+	__gb_qos_update_request(req, new_value);
+	gb_value = gb_max_value * gb_qos_max_value() / 100;
+
+	spin_unlock_irqrestore(&gb_lock, flags);
+}
+
+/*
+ * Fire-and-forget boost: hold @new_value for @hold_ms, then decay it
+ * linearly to zero over @decay_ms and drop the request. Calling it again
+ * before the request expired restarts the curve.
+ */
+void gb_qos_update_request_timeout(struct gb_qos_request *req,
+		u32 new_value, unsigned int hold_ms, unsigned int decay_ms)
+{
+	unsigned long flags;
+	ktime_t now = ktime_get();
+
+	spin_lock_irqsave(&gb_lock, flags);
+
+	req->timed_value = new_value;
+	req->decay_start = ktime_add_ms(now, hold_ms);
+	req->expires = ktime_add_ms(req->decay_start, decay_ms);
+	if (!req->timed) {
+		list_add_tail(&req->timed_node, &gb_timed_list);
+		req->timed = true;
+	}
+
+	gb_timer_start(gb_update_timed_requests(now));
 
 	spin_unlock_irqrestore(&gb_lock, flags);
 }
@@ -442,16 +567,68 @@ static ssize_t store_global_boost(struct kobject *kobj,
 		struct kobj_attribute *attr, const char *buf,
 		size_t count)
 {
-	unsigned int input;
+	unsigned int input, hold_ms, decay_ms = 0;
+	int ret;
 
-	if (!sscanf(buf, "%d", &input))
+	/* "value" or "value hold_ms [decay_ms]" for a timed boost */
+	ret = sscanf(buf, "%u %u %u", &input, &hold_ms, &decay_ms);
+	if (ret < 1)
 		return -EINVAL;
 
-	gb_qos_update_request(&gb_req_user, input);
+	if (ret == 1)
+		gb_qos_update_request(&gb_req_user, input);
+	else
+		gb_qos_update_request_timeout(&gb_req_user, input,
+					      hold_ms, decay_ms);
 
 	return count;
 }
 
+static int gb_debug_show(struct seq_file *m, void *v)
+{
+	struct gb_qos_request *req;
+	unsigned long flags;
+	ktime_t now = ktime_get();
+
+	spin_lock_irqsave(&gb_lock, flags);
+
+	seq_printf(m, "global boost: %lu\n", gb_value);
+	plist_for_each_entry(req, &gb_list, node) {
+		seq_printf(m, "%-32s %3d", req->name, gb_qos_req_value(req));
+		if (req->timed)
+			seq_printf(m, " timed %u hold %lld ms expires %lld ms",
+				req->timed_value,
+				max_t(s64, 0, ktime_ms_delta(req->decay_start, now)),
+				ktime_ms_delta(req->expires, now));
+		seq_puts(m, "\n");
+	}
+
+	spin_unlock_irqrestore(&gb_lock, flags);
+
+	return 0;
+}
+
+static int gb_debug_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, gb_debug_show, NULL);
+}
+
+static const struct file_operations gb_debug_fops = {
+	.open		= gb_debug_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init init_gb_debugfs(void)
+{
+	debugfs_create_file("ehmp_global_boost", 0444, NULL, NULL,
+			    &gb_debug_fops);
+
+	return 0;
+}
+late_initcall(init_gb_debugfs);
+
 static struct kobj_attribute global_boost_attr =
 __ATTR(global_boost, 0644, show_global_boost, store_global_boost);
 
@@ -500,6 +677,9 @@ static int __init init_global_boost(void)
 {
 	gb_max_value = find_second_max_cap() + 1;
 
+	hrtimer_init(&gb_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	gb_timer.function = gb_timer_fn;
+
 	return 0;
 }
 pure_initcall(init_global_boost);
@@ -607,6 +787,93 @@ static void mark_shallowest_cpu(int cpu, unsigned int *min_exit_latency,
 
 	cpumask_set_cpu(cpu, shallowest_cpus);
 }
+
+/**********************************************************************
+ * Cluster idle snapshot                                              *
+ **********************************************************************/
+/*
+ * Idle entry/exit and the tick record, per cluster, the idle cpu in the
+ * shallowest idle state and the idle cpu with the lowest utilization. Wakeup
+ * placement tries these first instead of visiting every cpu of the domain.
+ * The snapshot is updated without serialization and may be stale, so the
+ * cpu taken from it is validated and the full scan remains the fallback.
+ */
+struct cluster_snapshot {
+	int shallowest_cpu;
+	int lowest_cpu;
+};
+
+static DEFINE_PER_CPU(struct cluster_snapshot, cluster_snapshot) = {
+	.shallowest_cpu = -1,
+	.lowest_cpu = -1,
+};
+
+static inline struct cluster_snapshot *cluster_snapshot_of(int cpu)
+{
+	return &per_cpu(cluster_snapshot, cpumask_first(cpu_coregroup_mask(cpu)));
+}
+
+void ehmp_update_cluster_snapshot(int cpu)
+{
+	struct cluster_snapshot *cs = cluster_snapshot_of(cpu);
+	int min_idle_idx = INT_MAX;
+	unsigned long lowest_util = ULONG_MAX;
+	int shallowest_cpu = -1;
+	int lowest_cpu = -1;
+	int i;
+
+	for_each_cpu_and(i, cpu_coregroup_mask(cpu), cpu_online_mask) {
+		unsigned long util;
+		int idle_idx = -1;
+
+		if (!idle_cpu(i))
+			continue;
+
+		/*
+		 * This is called from the idle path where rcu is not watching.
+		 * Only the state index is read, and a deeper state has a larger
+		 * index within the cluster.
+		 */
+#ifdef CONFIG_CPU_IDLE
+		idle_idx = READ_ONCE(cpu_rq(i)->idle_state_idx);
+#endif
+		if (idle_idx < min_idle_idx) {
+			min_idle_idx = idle_idx;
+			shallowest_cpu = i;
+		}
+
+		util = cpu_util(i);
+		if (util < lowest_util) {
+			lowest_util = util;
+			lowest_cpu = i;
+		}
+	}
+
+	WRITE_ONCE(cs->shallowest_cpu, shallowest_cpu);
+	WRITE_ONCE(cs->lowest_cpu, lowest_cpu);
+}
+
+/* Returns the idle cpu of @sg given by the snapshot if it is still usable */
+static int snapshot_idle_cpu(struct sched_group *sg, struct task_struct *p,
+						bool shallowest)
+{
+	struct cluster_snapshot *cs;
+	int cpu;
+
+	cs = cluster_snapshot_of(cpumask_first(sched_group_cpus(sg)));
+	cpu = shallowest ? READ_ONCE(cs->shallowest_cpu) : READ_ONCE(cs->lowest_cpu);
+
+	if (!cpu_selected(cpu))
+		return -1;
+
+	if (!cpumask_test_cpu(cpu, sched_group_cpus(sg)) ||
+	    !cpumask_test_cpu(cpu, tsk_cpus_allowed(p)) ||
+	    !cpu_online(cpu) || cpu_rq(cpu)->nr_running)
+		return -1;
+
+	return cpu;
+}
+
 static int check_migration_task(struct task_struct *p)
 {
 	if (rt_task(p))
@@ -723,6 +990,31 @@ find_boost_target(struct sched_domain *sd, struct task_struct *p,
 
 	max_capacity = maxcap_val;
 
+	/*
+	 * The first cluster that can hold the boosted task takes an idle cpu
+	 * in the shallowest state. Try the one in the snapshot before scanning.
+	 */
+	sg = sd->groups;
+	do {
+		unsigned long new_util;
+		int cpu = cpumask_first(sched_group_cpus(sg));
+
+		new_util = max(min_util, task_util(p));
+		if (min(new_util + boost, max_capacity) > capacity_orig_of(cpu))
+			continue;
+
+		cpu = snapshot_idle_cpu(sg, p, true);
+		if (cpu_selected(cpu)) {
+			new_util = max(min_util, cpu_util_wake(cpu, p) + task_util(p));
+			if (min(new_util + boost, max_capacity) <= capacity_orig_of(cpu)) {
+				target_cpu = cpu;
+				strcpy(state, "big idle snapshot");
+				goto out;
+			}
+		}
+		break;
+	} while (sg = sg->next, sg != sd->groups);
+
 	sg = sd->groups;
 
 	do {
@@ -818,12 +1110,35 @@ static int find_prefer_idle_target(struct sched_domain *sd,
 	unsigned long overcap_util = ULONG_MAX;
 	struct cpumask idle_candidates;
 	struct cpumask overcap_idle_candidates;
+	int i;
+
+	/*
+	 * The scan below stops at the first cluster that has an idle cpu the
+	 * task fits in, choosing the previous cpu or the idle cpu with the
+	 * lowest utilization. Check those two in the first cluster up front.
+	 */
+	sg = sd->groups;
+	for (i = 0; i < 2; i++) {
+		int cpu = i ? snapshot_idle_cpu(sg, p, false) : task_cpu(p);
+		unsigned long new_util;
+
+		if (!cpu_selected(cpu) ||
+		    !cpumask_test_cpu(cpu, sched_group_cpus(sg)) ||
+		    !cpumask_test_cpu(cpu, tsk_cpus_allowed(p)) ||
+		    !cpu_online(cpu) || !idle_cpu(cpu) ||
+		    schedtune_cpu_reserved(p, cpu))
+			continue;
+
+		new_util = max(min_util, cpu_util_wake(cpu, p) + task_util(p));
+		if (new_util <= capacity_orig_of(cpu)) {
+			target_cpu = cpu;
+			goto out;
+		}
+	}
 
 	cpumask_clear(&idle_candidates);
 	cpumask_clear(&overcap_idle_candidates);
 
-	sg = sd->groups;
-
 	do {
 		int i;
 
@@ -833,6 +1148,10 @@ static int find_prefer_idle_target(struct sched_domain *sd,
 			if (!cpu_online(i))
 				continue;
 
+			/* Leave cpus reserved by other boost groups alone */
+			if (schedtune_cpu_reserved(p, i))
+				continue;
+
 			wake_util = cpu_util_wake(i, p);
 			new_util = wake_util + task_util(p);
 			new_util = max(min_util, new_util);
@@ -983,6 +1302,31 @@ static ssize_t store_down_threshold(struct kobject *kobj,
 static struct kobj_attribute down_threshold_attr =
 __ATTR(down_threshold, 0644, show_down_threshold, store_down_threshold);
 
+static unsigned int ontime_predict;
+
+static ssize_t show_ontime_predict(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return snprintf(buf, 10, "%u\n", ontime_predict);
+}
+
+static ssize_t store_ontime_predict(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf,
+		size_t count)
+{
+	unsigned int input;
+
+	if (!sscanf(buf, "%u", &input))
+		return -EINVAL;
+
+	ontime_predict = !!input;
+
+	return count;
+}
+
+static struct kobj_attribute ontime_predict_attr =
+__ATTR(ontime_predict, 0644, show_ontime_predict, store_ontime_predict);
+
 #define ontime_flag(p)			(ontime_of(p)->flags)
 #define ontime_migration_time(p)	(ontime_of(p)->avg.ontime_migration_time)
 #define ontime_load_avg(p)		(ontime_of(p)->avg.load_avg)
@@ -1021,6 +1365,9 @@ ontime_select_target_cpu(struct sched_group *sg, const struct cpumask *mask)
 		if (cpu_rq(cpu)->ontime_migrating)
 			continue;
 
+		if (exynos_hpgov_cpu_parked(cpu))
+			continue;
+
 		idle = idle_get_state(cpu_rq(cpu));
 		if (idle && idle->exit_latency < min_exit_latency) {
 			min_exit_latency = idle->exit_latency;
@@ -1146,6 +1493,7 @@ void ontime_new_entity_load(struct task_struct *parent, struct sched_entity *se)
 	ontime->avg.load_sum = ontime_of(parent)->avg.load_sum;
 	ontime->avg.load_avg = ontime_of(parent)->avg.load_avg;
 	ontime->avg.ontime_migration_time = 0;
+	memset(&ontime->hist, 0, sizeof(ontime->hist));
 	ontime->flags = NOT_ONTIME;
 
 	trace_ehmp_ontime_new_entity_load(task_of(se), &ontime->avg);
@@ -1399,6 +1747,54 @@ void ontime_migration(void)
 	spin_unlock(&om_lock);
 }
 
+/*
+ * PELT based ontime load lags a burst by tens of milliseconds. With
+ * ontime_predict set, the demand of each activation, runtime over the time
+ * between two consecutive wakeups scaled to the capacity and frequency of the
+ * cpu the task ran on, is kept in a small history. Like the WALT window
+ * policy of max(recent, average), the larger of the latest demand and the
+ * average of the history predicts the demand of the next activation.
+ */
+#define ONTIME_HIST_MIN_PERIOD		NSEC_PER_MSEC
+
+static void ontime_update_hist(struct task_struct *p)
+{
+	struct ontime_hist *hist = &ontime_of(p)->hist;
+	u64 now = local_clock();
+	u64 exec = p->se.sum_exec_runtime;
+	u64 period, busy, demand;
+	int cpu = task_cpu(p);
+	int i, sum = 0;
+
+	if (!hist->wakeup_time)
+		goto out;
+
+	period = now - hist->wakeup_time;
+	if (period < ONTIME_HIST_MIN_PERIOD)
+		return;
+
+	busy = min(exec - hist->wakeup_exec, period);
+	demand = div64_u64(busy << SCHED_CAPACITY_SHIFT, period);
+	demand = (demand * arch_scale_freq_capacity(NULL, cpu)) >> SCHED_CAPACITY_SHIFT;
+	demand = (demand * arch_scale_cpu_capacity(NULL, cpu)) >> SCHED_CAPACITY_SHIFT;
+
+	hist->demand[hist->idx] = demand;
+	hist->idx = (hist->idx + 1) % ONTIME_HIST_SIZE;
+
+	for (i = 0; i < ONTIME_HIST_SIZE; i++)
+		sum += hist->demand[i];
+
+	hist->predicted = max_t(int, demand, sum / ONTIME_HIST_SIZE);
+out:
+	hist->wakeup_time = now;
+	hist->wakeup_exec = exec;
+}
+
+static inline unsigned long ontime_predicted_load(struct task_struct *p)
+{
+	return ontime_predict ? ontime_of(p)->hist.predicted : 0;
+}
+
 int ontime_can_migration(struct task_struct *p, int cpu)
 {
 	int target_cpu = cpu < 0 ? task_cpu(p) : cpu;
@@ -1436,7 +1832,8 @@ int ontime_can_migration(struct task_struct *p, int cpu)
 		goto release;
 	}
 
-	if (ontime_load_avg(p) >= down_threshold) {
+	if (ontime_load_avg(p) >= down_threshold ||
+	    ontime_predicted_load(p) >= down_threshold) {
 		trace_ehmp_ontime_check_migrate(target_cpu, false, "heavy task");
 		return false;
 	}
@@ -1469,8 +1866,12 @@ static int ontime_wakeup_migration(struct task_struct *p, int target_cpu)
 
 static int ontime_wakeup(struct task_struct *p, int target_cpu)
 {
+	if (ontime_predict)
+		ontime_update_hist(p);
+
 	if (ontime_flag(p) & NOT_ONTIME) {
-		if (ontime_load_avg(p) > up_threshold)
+		if (ontime_load_avg(p) > up_threshold ||
+		    ontime_predicted_load(p) > up_threshold)
 			return ontime_wakeup_migration(p, target_cpu);
 
 		return target_cpu;
@@ -2003,6 +2404,7 @@ static struct attribute *ehmp_attrs[] = {
 	&min_residency_attr.attr,
 	&up_threshold_attr.attr,
 	&down_threshold_attr.attr,
+	&ontime_predict_attr.attr,
 	&top_overutil_attr.attr,
 	&bot_overutil_attr.attr,
 	&ensure_perf_attr.attr,
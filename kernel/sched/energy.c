@@ -26,6 +26,11 @@
 #include <linux/sched.h>
 #include <linux/sched_energy.h>
 #include <linux/stddef.h>
+#include <linux/debugfs.h>
+#include <linux/mutex.h>
+#include <linux/rcupdate.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
 
 struct sched_group_energy *sge_array[NR_CPUS][NR_SD_LEVELS];
 
@@ -122,3 +127,240 @@ void init_sched_energy_costs(void)
 out:
 	free_resources();
 }
+
+#ifdef CONFIG_SCHED_ENERGY_CALIBRATION
+/*
+ * Runtime calibration of the energy model
+ *
+ * The busy power values from DT are characterised on a typical sample,
+ * while the voltage actually applied to each OPP depends on the ASV
+ * group of the running chip. sched_energy_calibrate() rebuilds the
+ * per-OPP power of every sd level of a frequency domain as
+ *
+ *	P(i) = P(top) * (f(i) / f(top)) * (V(i) / V(top))^2
+ *
+ * keeping the DT top OPP power as the anchor, and
+ * sched_energy_refine() rescales a whole curve from one measured value.
+ *
+ * The capacity_state arrays are read locklessly from the wakeup path
+ * under rcu_read_lock(), so a new array is published with
+ * rcu_assign_pointer() and the old one is freed after a grace period.
+ * The number of states and the capacities never change, only power.
+ */
+static DEFINE_MUTEX(sge_calib_mutex);
+
+static void sge_publish_cap_states(struct sched_group_energy *sge,
+				   struct capacity_state *new)
+{
+	struct capacity_state *old = sge->cap_states;
+
+	rcu_assign_pointer(sge->cap_states, new);
+	synchronize_rcu();
+	kfree(old);
+}
+
+static struct capacity_state *sge_dup_cap_states(struct sched_group_energy *sge)
+{
+	return kmemdup(sge->cap_states,
+		       sge->nr_cap_states * sizeof(struct capacity_state),
+		       GFP_KERNEL);
+}
+
+/* Voltage of the lowest OPP that can run at @freq, in mV */
+static unsigned long sge_volt_of(unsigned long freq, const unsigned long *rates,
+				 const unsigned int *volts, int nr)
+{
+	unsigned long best_rate = ULONG_MAX, max_rate = 0;
+	unsigned int best = 0, max = 0;
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		if (!rates[i] || !volts[i])
+			continue;
+
+		if (rates[i] >= freq && rates[i] < best_rate) {
+			best_rate = rates[i];
+			best = volts[i];
+		}
+		if (rates[i] > max_rate) {
+			max_rate = rates[i];
+			max = volts[i];
+		}
+	}
+
+	return (best ? best : max) / 1000;
+}
+
+int sched_energy_calibrate(const struct cpumask *cpus,
+			   const unsigned long *rates,
+			   const unsigned int *volts, int nr)
+{
+	struct sched_group_energy *sge;
+	struct capacity_state *new;
+	unsigned long f_top = 0, v_top, cap_top, f, v;
+	int cpu, sd_level, i, top, ret = 0;
+
+	for (i = 0; i < nr; i++)
+		f_top = max(f_top, rates[i]);
+
+	v_top = sge_volt_of(f_top, rates, volts, nr);
+	if (!f_top || !v_top)
+		return -EINVAL;
+
+	mutex_lock(&sge_calib_mutex);
+
+	for_each_cpu(cpu, cpus) {
+		for_each_possible_sd_level(sd_level) {
+			sge = sge_array[cpu][sd_level];
+			if (!sge || !sge->nr_cap_states)
+				continue;
+
+			new = sge_dup_cap_states(sge);
+			if (!new) {
+				ret = -ENOMEM;
+				goto unlock;
+			}
+
+			top = sge->nr_cap_states - 1;
+			cap_top = new[top].cap;
+
+			for (i = 0; i < top; i++) {
+				u64 power;
+
+				f = f_top * new[i].cap / cap_top;
+				v = sge_volt_of(f, rates, volts, nr);
+
+				power = (u64)new[top].power * f * v * v;
+				new[i].power = div64_u64(power,
+						(u64)f_top * v_top * v_top);
+			}
+
+			sge_publish_cap_states(sge, new);
+		}
+	}
+
+	pr_info("calibrated busy costs of cpus %*pbl from %d OPPs\n",
+		cpumask_pr_args(cpus), nr);
+unlock:
+	mutex_unlock(&sge_calib_mutex);
+
+	return ret;
+}
+
+int sched_energy_refine(int cpu, int sd_level, int idx, unsigned long power)
+{
+	struct sched_group_energy *sge;
+	struct capacity_state *new;
+	unsigned long cur;
+	int i, ret = 0;
+
+	if (cpu < 0 || cpu >= nr_cpu_ids || !cpu_possible(cpu) ||
+	    sd_level < 0 || sd_level >= NR_SD_LEVELS || !power)
+		return -EINVAL;
+
+	mutex_lock(&sge_calib_mutex);
+
+	sge = sge_array[cpu][sd_level];
+	if (!sge || idx < 0 || idx >= sge->nr_cap_states ||
+	    !sge->cap_states[idx].power) {
+		ret = -EINVAL;
+		goto unlock;
+	}
+	cur = sge->cap_states[idx].power;
+
+	/* sge_array is per cpu, rescale every sibling sharing the table */
+	for_each_cpu(i, cpu_coregroup_mask(cpu)) {
+		int j;
+
+		sge = sge_array[i][sd_level];
+		if (!sge)
+			continue;
+
+		new = sge_dup_cap_states(sge);
+		if (!new) {
+			ret = -ENOMEM;
+			goto unlock;
+		}
+
+		for (j = 0; j < sge->nr_cap_states; j++)
+			new[j].power = DIV_ROUND_CLOSEST_ULL(
+					(u64)new[j].power * power, cur);
+
+		sge_publish_cap_states(sge, new);
+	}
+
+unlock:
+	mutex_unlock(&sge_calib_mutex);
+
+	return ret;
+}
+
+static int sge_debugfs_show(struct seq_file *m, void *v)
+{
+	struct sched_group_energy *sge;
+	struct capacity_state *cs;
+	int cpu, sd_level, i;
+
+	rcu_read_lock();
+	for_each_possible_cpu(cpu) {
+		for_each_possible_sd_level(sd_level) {
+			sge = sge_array[cpu][sd_level];
+			if (!sge)
+				continue;
+
+			cs = rcu_dereference(sge->cap_states);
+			seq_printf(m, "cpu%d lv%d:", cpu, sd_level);
+			for (i = 0; i < sge->nr_cap_states; i++)
+				seq_printf(m, " %lu/%lu", cs[i].cap, cs[i].power);
+			seq_putc(m, '\n');
+		}
+	}
+	rcu_read_unlock();
+
+	return 0;
+}
+
+static int sge_debugfs_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sge_debugfs_show, NULL);
+}
+
+/* "<cpu> <sd_level> <cap_state index> <measured power>" */
+static ssize_t sge_debugfs_write(struct file *file, const char __user *ubuf,
+				 size_t count, loff_t *ppos)
+{
+	char buf[64];
+	int cpu, sd_level, idx, ret;
+	unsigned long power;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	if (sscanf(buf, "%d %d %d %lu", &cpu, &sd_level, &idx, &power) != 4)
+		return -EINVAL;
+
+	ret = sched_energy_refine(cpu, sd_level, idx, power);
+
+	return ret ? ret : count;
+}
+
+static const struct file_operations sge_debugfs_fops = {
+	.open		= sge_debugfs_open,
+	.read		= seq_read,
+	.write		= sge_debugfs_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init sge_debugfs_init(void)
+{
+	debugfs_create_file("sched_energy_costs", 0644, NULL, NULL,
+			    &sge_debugfs_fops);
+	return 0;
+}
+late_initcall(sge_debugfs_init);
+#endif /* CONFIG_SCHED_ENERGY_CALIBRATION */
@@ -7787,6 +7787,10 @@ int can_migrate_task(struct task_struct *p, struct lb_env *env)
 		return 0;
 #endif
 
+	/* Parked cpus must not pull tasks */
+	if (exynos_hpgov_cpu_parked(env->dst_cpu))
+		return 0;
+
 	if (throttled_lb_pair(task_group(p), env->src_cpu, env->dst_cpu))
 		return 0;
 
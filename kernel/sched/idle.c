@@ -9,6 +9,7 @@
 #include <linux/mm.h>
 #include <linux/stackprotector.h>
 #include <linux/suspend.h>
+#include <linux/ehmp.h>
 #include <linux/cpu_pm.h>
 
 #include <asm/tlb.h>
@@ -28,6 +29,7 @@ void sched_idle_set_state(struct cpuidle_state *idle_state, int index)
 {
 	idle_set_state(this_rq(), idle_state);
 	idle_set_state_idx(this_rq(), index);
+	ehmp_update_cluster_snapshot(smp_processor_id());
 }
 
 static int __read_mostly cpu_idle_force_poll;
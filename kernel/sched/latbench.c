@@ -0,0 +1,442 @@
+/*
+ * Wakeup to run latency harness for scheduler tuning
+ *
+ * Spawns synthetic tasks and records, for every wakeup, how late the
+ * task got to run, on which CPU and at which frequency. Writing
+ *
+ *	<type> <tasks> <period_us> <run_us> <duration_ms>
+ *
+ * to <debugfs>/sched_latbench/run runs one test and blocks until it
+ * ends. The tasks are put in the cgroups, schedtune group included, of
+ * the task writing the command, so e.g.
+ *
+ *	echo $$ > /dev/stune/top-app/tasks
+ *	echo "render 2 16666 4000 10000" > /d/sched_latbench/run
+ *
+ * runs two UI/render pairs as top-app. Types are:
+ *
+ *  periodic - wakes every period and runs for run_us (cyclictest)
+ *  bursty   - like periodic, with period and run time drawn between a
+ *             quarter of and twice the given values
+ *  render   - a UI task woken every period (vsync) runs run_us / 2,
+ *             then wakes its render task which runs run_us. The render
+ *             task latency is counted from the wake_up_process() call.
+ *
+ * results shows a latency histogram and migration count per task and
+ * the wakeups and mean frequency per CPU, samples the last wakeups.
+ */
+
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/kthread.h>
+#include <linux/hrtimer.h>
+#include <linux/cgroup.h>
+#include <linux/cpufreq.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/random.h>
+#include <linux/mutex.h>
+#include <linux/sched.h>
+
+#define LATBENCH_MAX_TASKS	16
+#define LATBENCH_NR_BUCKETS	16	/* bucket n counts latencies < 2^n us */
+#define LATBENCH_NR_SAMPLES	4096
+
+enum latbench_type {
+	LATBENCH_PERIODIC,
+	LATBENCH_BURSTY,
+	LATBENCH_RENDER,
+	LATBENCH_NR_TYPES,
+};
+
+static const char * const latbench_type_name[LATBENCH_NR_TYPES] = {
+	"periodic", "bursty", "render",
+};
+
+struct latbench_sample {
+	u64 time_ns;
+	u32 latency_ns;
+	u32 freq;
+	u16 task;
+	u16 cpu;
+};
+
+struct latbench_task {
+	struct task_struct *tsk;
+	unsigned int id;
+	bool render;			/* woken by its UI task, not by a timer */
+	struct latbench_task *peer;	/* render task of a UI task */
+	u64 wake_ns;
+	bool woken;
+
+	u64 nr_wakeups;
+	u64 sum_ns;
+	u64 max_ns;
+	u64 migrations;
+	int last_cpu;
+	u32 bucket[LATBENCH_NR_BUCKETS];
+};
+
+struct latbench_cpu {
+	atomic64_t wakeups;
+	atomic64_t freq_sum;
+};
+
+static struct latbench {
+	struct mutex lock;
+	enum latbench_type type;
+	unsigned int nr_tasks;
+	u64 period_ns;
+	u64 run_ns;
+	unsigned int duration_ms;
+	struct latbench_task task[LATBENCH_MAX_TASKS];
+	struct latbench_cpu cpu[NR_CPUS];
+	struct latbench_sample sample[LATBENCH_NR_SAMPLES];
+	atomic_t nr_samples;
+	bool valid;
+} bench = {
+	.lock = __MUTEX_INITIALIZER(bench.lock),
+};
+
+static void latbench_record(struct latbench_task *t, u64 now, u64 latency)
+{
+	int cpu = raw_smp_processor_id();
+	unsigned int freq = cpufreq_quick_get(cpu);
+	struct latbench_sample *s;
+	unsigned long us = (unsigned long)div_u64(latency, NSEC_PER_USEC);
+
+	t->nr_wakeups++;
+	t->sum_ns += latency;
+	t->max_ns = max(t->max_ns, latency);
+	t->bucket[min_t(unsigned int, fls_long(us), LATBENCH_NR_BUCKETS - 1)]++;
+	if (t->last_cpu >= 0 && t->last_cpu != cpu)
+		t->migrations++;
+	t->last_cpu = cpu;
+
+	atomic64_inc(&bench.cpu[cpu].wakeups);
+	atomic64_add(freq, &bench.cpu[cpu].freq_sum);
+
+	s = &bench.sample[(atomic_inc_return(&bench.nr_samples) - 1) %
+			  LATBENCH_NR_SAMPLES];
+	s->time_ns = now;
+	s->latency_ns = (u32)min_t(u64, latency, U32_MAX);
+	s->freq = freq;
+	s->task = t->id;
+	s->cpu = cpu;
+}
+
+static void latbench_spin(u64 ns)
+{
+	u64 end = local_clock() + ns;
+
+	while (local_clock() < end && !kthread_should_stop())
+		cpu_relax();
+}
+
+/* a quarter to twice @ns for the bursty tasks, @ns otherwise */
+static u64 latbench_vary(u64 ns)
+{
+	if (bench.type != LATBENCH_BURSTY)
+		return ns;
+
+	return ns / 4 + div_u64((u64)prandom_u32_max(1024) * (ns * 7 / 4), 1024);
+}
+
+static int latbench_timer_thread(void *data)
+{
+	struct latbench_task *t = data;
+	u64 run_ns = bench.type == LATBENCH_RENDER ? bench.run_ns / 2 :
+						     bench.run_ns;
+	ktime_t next = ktime_add_ns(ktime_get(), bench.period_ns);
+	ktime_t now;
+
+	while (!kthread_should_stop()) {
+		set_current_state(TASK_UNINTERRUPTIBLE);
+		schedule_hrtimeout_range(&next, 0, HRTIMER_MODE_ABS);
+		if (kthread_should_stop())
+			break;
+
+		now = ktime_get();
+		latbench_record(t, ktime_to_ns(now),
+				max_t(s64, ktime_to_ns(ktime_sub(now, next)), 0));
+
+		latbench_spin(latbench_vary(run_ns));
+
+		if (t->peer) {
+			t->peer->wake_ns = ktime_get_ns();
+			WRITE_ONCE(t->peer->woken, true);
+			wake_up_process(t->peer->tsk);
+		}
+
+		next = ktime_add_ns(next, latbench_vary(bench.period_ns));
+		/* overran the period, start over rather than catch up */
+		now = ktime_get();
+		if (ktime_before(next, now))
+			next = ktime_add_ns(now, bench.period_ns);
+	}
+
+	return 0;
+}
+
+static int latbench_render_thread(void *data)
+{
+	struct latbench_task *t = data;
+	u64 now;
+
+	while (!kthread_should_stop()) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (!READ_ONCE(t->woken) && !kthread_should_stop())
+			schedule();
+		__set_current_state(TASK_RUNNING);
+
+		if (!READ_ONCE(t->woken))
+			continue;
+		WRITE_ONCE(t->woken, false);
+
+		now = ktime_get_ns();
+		latbench_record(t, now, now - t->wake_ns);
+		latbench_spin(bench.run_ns);
+	}
+
+	return 0;
+}
+
+static void latbench_stop(unsigned int nr)
+{
+	unsigned int i;
+
+	for (i = 0; i < nr; i++) {
+		kthread_stop(bench.task[i].tsk);
+		put_task_struct(bench.task[i].tsk);
+	}
+}
+
+static int latbench_run(void)
+{
+	struct latbench_task *t;
+	unsigned int i;
+	int ret;
+
+	memset(bench.task, 0, sizeof(bench.task));
+	memset(bench.cpu, 0, sizeof(bench.cpu));
+	atomic_set(&bench.nr_samples, 0);
+	bench.valid = false;
+
+	for (i = 0; i < bench.nr_tasks; i++) {
+		t = &bench.task[i];
+		t->id = i;
+		t->last_cpu = -1;
+		/* render tasks follow their UI task */
+		t->render = bench.type == LATBENCH_RENDER && (i & 1);
+		if (t->render)
+			bench.task[i - 1].peer = t;
+
+		t->tsk = kthread_create(t->render ? latbench_render_thread :
+						   latbench_timer_thread,
+					t, "latbench/%u", i);
+		if (IS_ERR(t->tsk)) {
+			ret = PTR_ERR(t->tsk);
+			goto out_stop;
+		}
+		get_task_struct(t->tsk);
+
+		ret = cgroup_attach_task_all(current, t->tsk);
+		if (ret) {
+			/* not started yet, kthread_stop() lets it exit */
+			i++;
+			goto out_stop;
+		}
+	}
+
+	for (i = 0; i < bench.nr_tasks; i++)
+		wake_up_process(bench.task[i].tsk);
+
+	ret = msleep_interruptible(bench.duration_ms) ? -EINTR : 0;
+
+	latbench_stop(bench.nr_tasks);
+	bench.valid = !ret;
+
+	return ret;
+
+out_stop:
+	latbench_stop(i);
+
+	return ret;
+}
+
+static ssize_t latbench_run_write(struct file *file, const char __user *ubuf,
+				  size_t count, loff_t *ppos)
+{
+	char buf[64], type[16];
+	unsigned int nr_tasks, period_us, run_us, duration_ms;
+	int i, ret;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	if (sscanf(buf, "%15s %u %u %u %u", type, &nr_tasks, &period_us,
+		   &run_us, &duration_ms) != 5)
+		return -EINVAL;
+
+	for (i = 0; i < LATBENCH_NR_TYPES; i++)
+		if (!strcmp(type, latbench_type_name[i]))
+			break;
+	if (i == LATBENCH_NR_TYPES)
+		return -EINVAL;
+
+	/* render tasks come in UI/render pairs */
+	if (i == LATBENCH_RENDER)
+		nr_tasks *= 2;
+	if (!nr_tasks || nr_tasks > LATBENCH_MAX_TASKS ||
+	    !period_us || run_us >= period_us || !duration_ms)
+		return -EINVAL;
+
+	mutex_lock(&bench.lock);
+	bench.type = i;
+	bench.nr_tasks = nr_tasks;
+	bench.period_ns = (u64)period_us * NSEC_PER_USEC;
+	bench.run_ns = (u64)run_us * NSEC_PER_USEC;
+	bench.duration_ms = duration_ms;
+	ret = latbench_run();
+	mutex_unlock(&bench.lock);
+
+	return ret ? ret : count;
+}
+
+static const struct file_operations latbench_run_fops = {
+	.open		= simple_open,
+	.write		= latbench_run_write,
+	.llseek		= default_llseek,
+};
+
+/* upper bound of the bucket holding the @pct percentile */
+static unsigned long latbench_percentile_us(struct latbench_task *t,
+					    unsigned int pct)
+{
+	u64 target = div_u64(t->nr_wakeups * pct + 99, 100);
+	u64 seen = 0;
+	int i;
+
+	for (i = 0; i < LATBENCH_NR_BUCKETS; i++) {
+		seen += t->bucket[i];
+		if (seen >= target)
+			return 1UL << i;
+	}
+
+	return 1UL << (LATBENCH_NR_BUCKETS - 1);
+}
+
+static int latbench_results_show(struct seq_file *m, void *v)
+{
+	struct latbench_task *t;
+	unsigned int i, cpu;
+	u64 wakeups;
+
+	mutex_lock(&bench.lock);
+	if (!bench.valid)
+		goto out;
+
+	seq_printf(m, "%s tasks %u period %lluus run %lluus duration %ums\n",
+		   latbench_type_name[bench.type], bench.nr_tasks,
+		   div_u64(bench.period_ns, NSEC_PER_USEC),
+		   div_u64(bench.run_ns, NSEC_PER_USEC), bench.duration_ms);
+
+	seq_printf(m, "%-5s %-7s %9s %9s %9s %9s %9s %10s\n", "task", "kind",
+		   "wakeups", "avg_us", "p50_us<", "p99_us<", "max_us",
+		   "migrations");
+	for (i = 0; i < bench.nr_tasks; i++) {
+		t = &bench.task[i];
+		seq_printf(m, "%-5u %-7s %9llu %9llu %9lu %9lu %9llu %10llu\n",
+			   i, t->render ? "render" : "timer", t->nr_wakeups,
+			   t->nr_wakeups ?
+				div64_u64(t->sum_ns, t->nr_wakeups * NSEC_PER_USEC) : 0,
+			   latbench_percentile_us(t, 50),
+			   latbench_percentile_us(t, 99),
+			   div_u64(t->max_ns, NSEC_PER_USEC), t->migrations);
+	}
+
+	seq_printf(m, "%-5s %9s %13s\n", "cpu", "wakeups", "avg_freq_khz");
+	for_each_possible_cpu(cpu) {
+		wakeups = atomic64_read(&bench.cpu[cpu].wakeups);
+		if (!wakeups)
+			continue;
+		seq_printf(m, "%-5u %9llu %13llu\n", cpu, wakeups,
+			   div64_u64(atomic64_read(&bench.cpu[cpu].freq_sum),
+				     wakeups));
+	}
+out:
+	mutex_unlock(&bench.lock);
+
+	return 0;
+}
+
+static int latbench_results_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, latbench_results_show, NULL);
+}
+
+static const struct file_operations latbench_results_fops = {
+	.open		= latbench_results_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int latbench_samples_show(struct seq_file *m, void *v)
+{
+	struct latbench_sample *s;
+	unsigned int nr, first, i;
+
+	mutex_lock(&bench.lock);
+	if (!bench.valid)
+		goto out;
+
+	nr = atomic_read(&bench.nr_samples);
+	first = nr > LATBENCH_NR_SAMPLES ? nr - LATBENCH_NR_SAMPLES : 0;
+
+	seq_puts(m, "time_ns task cpu freq_khz latency_ns\n");
+	for (i = first; i < nr; i++) {
+		s = &bench.sample[i % LATBENCH_NR_SAMPLES];
+		seq_printf(m, "%llu %u %u %u %u\n", s->time_ns, s->task,
+			   s->cpu, s->freq, s->latency_ns);
+	}
+out:
+	mutex_unlock(&bench.lock);
+
+	return 0;
+}
+
+static int latbench_samples_open(struct inode *inode, struct file *file)
+{
+	return single_open_size(file, latbench_samples_show, NULL,
+				LATBENCH_NR_SAMPLES * 48);
+}
+
+static const struct file_operations latbench_samples_fops = {
+	.open		= latbench_samples_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static __init int latbench_init(void)
+{
+	struct dentry *root;
+
+	root = debugfs_create_dir("sched_latbench", NULL);
+	if (!root)
+		return -ENOMEM;
+
+	debugfs_create_file("run", 0200, root, NULL, &latbench_run_fops);
+	debugfs_create_file("results", 0444, root, NULL,
+			    &latbench_results_fops);
+	debugfs_create_file("samples", 0444, root, NULL,
+			    &latbench_samples_fops);
+
+	return 0;
+}
+late_initcall(latbench_init);
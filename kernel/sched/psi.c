@@ -140,6 +140,7 @@
 #include <linux/file.h>
 #include <linux/poll.h>
 #include <linux/psi.h>
+#include <linux/vmstat.h>
 #include "sched.h"
 
 static int psi_bug __read_mostly;
@@ -177,14 +178,23 @@ static struct psi_group psi_system = {
 	.pcpu = &system_group_pcpu,
 };
 
+/*
+ * Per-cluster CPU pressure. Cluster groups aggregate the system group's
+ * per-cpu state over the CPUs of one cluster, so they cost nothing in the
+ * scheduler hot path beyond waking up their aggregators.
+ */
+static struct psi_group *psi_cluster_of[NR_CPUS];
+
 static void psi_avgs_work(struct work_struct *work);
 
 static void group_init(struct psi_group *group)
 {
 	int cpu;
 
-	for_each_possible_cpu(cpu)
-		seqcount_init(&per_cpu_ptr(group->pcpu, cpu)->seq);
+	/* The per-cpu state of a cluster group belongs to the system group */
+	if (!group->cpus)
+		for_each_possible_cpu(cpu)
+			seqcount_init(&per_cpu_ptr(group->pcpu, cpu)->seq);
 	group->avg_last_update = sched_clock();
 	group->avg_next_update = group->avg_last_update + psi_period;
 	INIT_DELAYED_WORK(&group->avgs_work, psi_avgs_work);
@@ -239,6 +249,8 @@ static void get_recent_times(struct psi_group *group, int cpu,
 			     u32 *pchanged_states)
 {
 	struct psi_group_cpu *groupc = per_cpu_ptr(group->pcpu, cpu);
+	u32 *times_prev = group->cpus ? groupc->cluster_times_prev[aggregator] :
+					groupc->times_prev[aggregator];
 	u64 now, state_start;
 	enum psi_states s;
 	unsigned int seq;
@@ -270,8 +282,8 @@ static void get_recent_times(struct psi_group *group, int cpu,
 		if (state_mask & (1 << s))
 			times[s] += now - state_start;
 
-		delta = times[s] - groupc->times_prev[aggregator][s];
-		groupc->times_prev[aggregator][s] = times[s];
+		delta = times[s] - times_prev[s];
+		times_prev[s] = times[s];
 
 		times[s] = delta;
 		if (delta)
@@ -317,7 +329,7 @@ static void collect_percpu_times(struct psi_group *group,
 	 * the sampling period. This eliminates artifacts from uneven
 	 * loading, or even entirely idle CPUs.
 	 */
-	for_each_possible_cpu(cpu) {
+	for_each_cpu(cpu, group->cpus ? group->cpus : cpu_possible_mask) {
 		u32 times[NR_PSI_STATES];
 		u32 nonidle;
 		u32 cpu_changed_states;
@@ -500,6 +512,23 @@ static void init_triggers(struct psi_group *group, u64 now)
 	group->polling_next_update = now + group->poll_min_period;
 }
 
+/*
+ * Free memory below the sum of the zones' @wmark watermarks, i.e. kswapd
+ * (low), direct reclaim (min) or nothing yet (high) is in the way of
+ * allocations. Stalls with plenty of free memory are refaults userspace
+ * cannot help with by killing.
+ */
+static bool psi_free_below_wmark(int wmark)
+{
+	unsigned long mark = 0;
+	struct zone *zone;
+
+	for_each_populated_zone(zone)
+		mark += zone->watermark[wmark];
+
+	return global_page_state(NR_FREE_PAGES) < mark;
+}
+
 static u64 update_triggers(struct psi_group *group, u64 now)
 {
 	struct psi_trigger *t;
@@ -534,6 +563,9 @@ static u64 update_triggers(struct psi_group *group, u64 now)
 		if (now < t->last_event_time + t->win.size)
 			continue;
 
+		if (t->wmark < NR_WMARK && !psi_free_below_wmark(t->wmark))
+			continue;
+
 		/* Generate an event */
 		if (cmpxchg(&t->event, 0, 1) == 0)
 			wake_up_interruptible(&t->event_wait);
@@ -720,6 +752,20 @@ static u32 psi_group_change(struct psi_group *group, int cpu,
 	return state_mask;
 }
 
+static void psi_cluster_change(int cpu, u32 state_mask, bool wake_clock)
+{
+	struct psi_group *group = READ_ONCE(psi_cluster_of[cpu]);
+
+	if (!group)
+		return;
+
+	if (state_mask & group->poll_states)
+		psi_schedule_poll_work(group, 1);
+
+	if (wake_clock && !delayed_work_pending(&group->avgs_work))
+		schedule_delayed_work(&group->avgs_work, PSI_FREQ);
+}
+
 static struct psi_group *iterate_groups(struct task_struct *task, void **iter)
 {
 #ifdef CONFIG_CGROUPS
@@ -785,6 +831,9 @@ void psi_task_change(struct task_struct *task, int clear, int set)
 
 		if (wake_clock && !delayed_work_pending(&group->avgs_work))
 			schedule_delayed_work(&group->avgs_work, PSI_FREQ);
+
+		if (group == &psi_system)
+			psi_cluster_change(cpu, state_mask, wake_clock);
 	}
 }
 
@@ -989,6 +1038,11 @@ static int psi_cpu_show(struct seq_file *m, void *v)
 	return psi_show(m, &psi_system, PSI_CPU);
 }
 
+static int psi_cpu_cluster_show(struct seq_file *m, void *v)
+{
+	return psi_show(m, PDE_DATA(file_inode(m->file)), PSI_CPU);
+}
+
 static int psi_io_open(struct inode *inode, struct file *file)
 {
 	return single_open(file, psi_io_show, NULL);
@@ -1004,6 +1058,11 @@ static int psi_cpu_open(struct inode *inode, struct file *file)
 	return single_open(file, psi_cpu_show, NULL);
 }
 
+static int psi_cpu_cluster_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, psi_cpu_cluster_show, NULL);
+}
+
 struct psi_trigger *psi_trigger_create(struct psi_group *group,
 			char *buf, size_t nbytes, enum psi_res res)
 {
@@ -1011,16 +1070,37 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group,
 	enum psi_states state;
 	u32 threshold_us;
 	u32 window_us;
+	char wmark_str[8];
+	int wmark = NR_WMARK;
+	int nr;
 
 	if (static_branch_likely(&psi_disabled))
 		return ERR_PTR(-EOPNOTSUPP);
 
-	if (sscanf(buf, "some %u %u", &threshold_us, &window_us) == 2)
+	nr = sscanf(buf, "some %u %u %7s", &threshold_us, &window_us, wmark_str);
+	if (nr >= 2) {
 		state = PSI_IO_SOME + res * 2;
-	else if (sscanf(buf, "full %u %u", &threshold_us, &window_us) == 2)
+	} else {
+		nr = sscanf(buf, "full %u %u %7s", &threshold_us, &window_us,
+								wmark_str);
+		if (nr < 2)
+			return ERR_PTR(-EINVAL);
 		state = PSI_IO_FULL + res * 2;
-	else
-		return ERR_PTR(-EINVAL);
+	}
+
+	/* optional "min", "low" or "high" watermark gate for memory */
+	if (nr == 3) {
+		if (res != PSI_MEM)
+			return ERR_PTR(-EINVAL);
+		if (!strcmp(wmark_str, "min"))
+			wmark = WMARK_MIN;
+		else if (!strcmp(wmark_str, "low"))
+			wmark = WMARK_LOW;
+		else if (!strcmp(wmark_str, "high"))
+			wmark = WMARK_HIGH;
+		else
+			return ERR_PTR(-EINVAL);
+	}
 
 	if (state >= PSI_NONIDLE)
 		return ERR_PTR(-EINVAL);
@@ -1040,6 +1120,7 @@ struct psi_trigger *psi_trigger_create(struct psi_group *group,
 	t->group = group;
 	t->state = state;
 	t->threshold = threshold_us * NSEC_PER_USEC;
+	t->wmark = wmark;
 	t->win.size = window_us * NSEC_PER_USEC;
 	window_reset(&t->win, 0, 0, 0);
 
@@ -1189,7 +1270,7 @@ unsigned int psi_trigger_poll(void **trigger_ptr, struct file *file,
 }
 
 static ssize_t psi_write(struct file *file, const char __user *user_buf,
-			 size_t nbytes, enum psi_res res)
+			 size_t nbytes, struct psi_group *group, enum psi_res res)
 {
 	char buf[32];
 	size_t buf_size;
@@ -1208,7 +1289,7 @@ static ssize_t psi_write(struct file *file, const char __user *user_buf,
 
 	buf[buf_size - 1] = '\0';
 
-	new = psi_trigger_create(&psi_system, buf, nbytes, res);
+	new = psi_trigger_create(group, buf, nbytes, res);
 	if (IS_ERR(new))
 		return PTR_ERR(new);
 
@@ -1224,19 +1305,27 @@ static ssize_t psi_write(struct file *file, const char __user *user_buf,
 static ssize_t psi_io_write(struct file *file, const char __user *user_buf,
 			    size_t nbytes, loff_t *ppos)
 {
-	return psi_write(file, user_buf, nbytes, PSI_IO);
+	return psi_write(file, user_buf, nbytes, &psi_system, PSI_IO);
 }
 
 static ssize_t psi_memory_write(struct file *file, const char __user *user_buf,
 				size_t nbytes, loff_t *ppos)
 {
-	return psi_write(file, user_buf, nbytes, PSI_MEM);
+	return psi_write(file, user_buf, nbytes, &psi_system, PSI_MEM);
 }
 
 static ssize_t psi_cpu_write(struct file *file, const char __user *user_buf,
 			     size_t nbytes, loff_t *ppos)
 {
-	return psi_write(file, user_buf, nbytes, PSI_CPU);
+	return psi_write(file, user_buf, nbytes, &psi_system, PSI_CPU);
+}
+
+static ssize_t psi_cpu_cluster_write(struct file *file,
+				     const char __user *user_buf,
+				     size_t nbytes, loff_t *ppos)
+{
+	return psi_write(file, user_buf, nbytes,
+			 PDE_DATA(file_inode(file)), PSI_CPU);
 }
 
 static unsigned int psi_fop_poll(struct file *file, poll_table *wait)
@@ -1281,12 +1370,58 @@ static const struct file_operations psi_cpu_fops = {
 	.release        = psi_fop_release,
 };
 
+static const struct file_operations psi_cpu_cluster_fops = {
+	.open           = psi_cpu_cluster_open,
+	.read           = seq_read,
+	.llseek         = seq_lseek,
+	.write          = psi_cpu_cluster_write,
+	.poll           = psi_fop_poll,
+	.release        = psi_fop_release,
+};
+
+/*
+ * Create pressure/cpu_cluster<N>, one per cluster in the order of their
+ * first CPU, with the same format and trigger interface as pressure/cpu.
+ */
+static void __init psi_cluster_init(void)
+{
+	struct psi_group *group;
+	char name[32];
+	int cpu, i, nr = 0;
+
+	if (static_branch_likely(&psi_disabled))
+		return;
+
+	for_each_possible_cpu(cpu) {
+		const struct cpumask *cluster = cpu_coregroup_mask(cpu);
+
+		if (cpu != cpumask_first(cluster))
+			continue;
+
+		group = kzalloc(sizeof(*group), GFP_KERNEL);
+		if (!group)
+			return;
+
+		group->pcpu = &system_group_pcpu;
+		group->cpus = cluster;
+		group_init(group);
+
+		smp_wmb();
+		for_each_cpu(i, cluster)
+			WRITE_ONCE(psi_cluster_of[i], group);
+
+		snprintf(name, sizeof(name), "pressure/cpu_cluster%d", nr++);
+		proc_create_data(name, 0, NULL, &psi_cpu_cluster_fops, group);
+	}
+}
+
 static int __init psi_proc_init(void)
 {
 	proc_mkdir("pressure", NULL);
 	proc_create("pressure/io", 0, NULL, &psi_io_fops);
 	proc_create("pressure/memory", 0, NULL, &psi_memory_fops);
 	proc_create("pressure/cpu", 0, NULL, &psi_cpu_fops);
+	psi_cluster_init();
 	return 0;
 }
 module_init(psi_proc_init);
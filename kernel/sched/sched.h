@@ -337,6 +337,10 @@ struct task_group {
 #endif
 
 	struct cfs_bandwidth cfs_bandwidth;
+
+	/* timer slack and expiry alignment of the tasks, 0 leaves them alone */
+	u64 timer_slack_ns;
+	u64 timer_align_ns;
 };
 
 #ifdef CONFIG_FAIR_GROUP_SCHED
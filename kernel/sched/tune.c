@@ -1,6 +1,7 @@
 #include <linux/cgroup.h>
 #include <linux/err.h>
 #include <linux/kernel.h>
+#include <linux/mutex.h>
 #include <linux/percpu.h>
 #include <linux/printk.h>
 #include <linux/rcupdate.h>
@@ -11,6 +12,7 @@
 
 #include "sched.h"
 #include "tune.h"
+#include "walt.h"
 
 #ifdef CONFIG_CGROUP_SCHEDTUNE
 bool schedtune_initialized = false;
@@ -182,8 +184,23 @@ struct schedtune {
 	 * towards high performance CPUs */
 	int prefer_perf;
 
+	/* Number of CPUs of the biggest cluster reserved for tasks on that
+	 * SchedTune CGroup */
+	int reserved_cpus;
+
+	/* Idle time after which other groups may use the reserved CPUs */
+	u64 reserved_idle_ns;
+
 	/* SchedTune group balancer */
 	struct group_balancer gb;
+
+#ifdef CONFIG_SCHED_WALT
+	/* WALT demand of the group, refreshed with the group utilization */
+	unsigned long walt_demand;
+	unsigned long walt_pred_demand;
+	unsigned long walt_max_pred_demand;
+	struct cgroup_file walt_demand_file;
+#endif
 };
 
 static inline struct schedtune *css_st(struct cgroup_subsys_state *css)
@@ -581,6 +598,9 @@ int schedtune_task_boost(struct task_struct *p)
 {
 	struct schedtune *st;
 	int task_boost;
+#ifdef CONFIG_RT_MUTEXES
+	int pi_boost;
+#endif
 
 	if (!unlikely(schedtune_initialized))
 		return 0;
@@ -591,6 +611,13 @@ int schedtune_task_boost(struct task_struct *p)
 	task_boost = st->boost;
 	rcu_read_unlock();
 
+#ifdef CONFIG_RT_MUTEXES
+	/* A lock owner is boosted at least like the tasks it blocks */
+	pi_boost = READ_ONCE(p->st_pi_boost);
+	if (pi_boost > 0 && pi_boost > task_boost)
+		task_boost = pi_boost;
+#endif
+
 	return task_boost;
 }
 
@@ -608,9 +635,99 @@ int schedtune_prefer_idle(struct task_struct *p)
 	prefer_idle = st->prefer_idle;
 	rcu_read_unlock();
 
+#ifdef CONFIG_RT_MUTEXES
+	prefer_idle = max(prefer_idle, READ_ONCE(p->st_pi_prefer_idle));
+#endif
+
 	return prefer_idle;
 }
 
+/*
+ * Reserved CPUs
+ * A boost group can reserve some CPUs of the biggest cluster for its own
+ * latency sensitive tasks. Tasks of the other groups are kept away from a
+ * reserved CPU unless it has been idle for longer than reserved_idle_ns of
+ * the owner group, i.e. the owner does not seem to need it right now.
+ * CPUs are handed out from the last CPU of the cluster downwards, and at
+ * least one CPU of the cluster is always left unreserved.
+ */
+static DEFINE_MUTEX(reserved_mutex);
+static DEFINE_PER_CPU(int, reserved_owner);
+static DEFINE_PER_CPU(u64, reserved_idle_ns);
+
+static void schedtune_update_reserved(void)
+{
+	struct schedtune *st;
+	int cpu, max_cpu = 0, idx, count;
+	const struct cpumask *cluster;
+
+	lockdep_assert_held(&reserved_mutex);
+
+	for_each_possible_cpu(cpu) {
+		per_cpu(reserved_owner, cpu) = 0;
+		if (capacity_orig_of(cpu) > capacity_orig_of(max_cpu))
+			max_cpu = cpu;
+	}
+
+	cluster = cpu_coregroup_mask(max_cpu);
+	count = cpumask_weight(cluster) - 1;
+	cpu = nr_cpu_ids;
+
+	for (idx = 1; idx < BOOSTGROUPS_COUNT; idx++) {
+		int k;
+
+		st = allocated_group[idx];
+		if (!st)
+			continue;
+
+		for (k = 0; k < st->reserved_cpus && count > 0; k++, count--) {
+			do {
+				cpu--;
+			} while (!cpumask_test_cpu(cpu, cluster));
+
+			per_cpu(reserved_idle_ns, cpu) = st->reserved_idle_ns;
+			smp_wmb();
+			WRITE_ONCE(per_cpu(reserved_owner, cpu), idx);
+		}
+	}
+}
+
+/*
+ * Returns true if @cpu is reserved by a boost group other than the one of
+ * @p and has not been idle long enough to be lent to @p.
+ */
+bool schedtune_cpu_reserved(struct task_struct *p, int cpu)
+{
+	struct schedtune *st;
+	struct rq *rq = cpu_rq(cpu);
+	int owner, idx;
+	u64 idle_stamp;
+
+	owner = READ_ONCE(per_cpu(reserved_owner, cpu));
+	if (likely(!owner))
+		return false;
+
+	rcu_read_lock();
+	st = task_schedtune(p);
+	idx = st->idx;
+	rcu_read_unlock();
+
+	if (idx == owner)
+		return false;
+
+	if (!idle_cpu(cpu))
+		return true;
+
+	/* Idle since boot or since before the reservation was made */
+	idle_stamp = READ_ONCE(rq->idle_stamp);
+	if (!idle_stamp)
+		return false;
+
+	smp_rmb();
+	return sched_clock_cpu(cpu) - idle_stamp <
+			per_cpu(reserved_idle_ns, cpu);
+}
+
 #ifdef CONFIG_SCHED_EHMP
 static atomic_t kernel_prefer_perf_req[BOOSTGROUPS_COUNT];
 int kernel_prefer_perf(int grp_idx)
@@ -650,9 +767,40 @@ int schedtune_prefer_perf(struct task_struct *p)
 	prefer_perf = max(st->prefer_perf, kernel_prefer_perf(st->idx));
 	rcu_read_unlock();
 
+#ifdef CONFIG_RT_MUTEXES
+	prefer_perf = max(prefer_perf, READ_ONCE(p->st_pi_prefer_perf));
+#endif
+
 	return prefer_perf;
 }
 
+#ifdef CONFIG_RT_MUTEXES
+/*
+ * Raise what @p inherits through rt_mutex priority inheritance to the
+ * boost, prefer_idle and prefer_perf of @donor, a task blocked on a lock
+ * held by @p.  A NULL @donor drops all of it.  Since the accessors above
+ * fold the inherited values in, they propagate along a chain of owners.
+ *
+ * @p->pi_lock must be held.
+ */
+void schedtune_pi_inherit(struct task_struct *p, struct task_struct *donor)
+{
+	if (!donor) {
+		WRITE_ONCE(p->st_pi_boost, 0);
+		WRITE_ONCE(p->st_pi_prefer_idle, 0);
+		WRITE_ONCE(p->st_pi_prefer_perf, 0);
+		return;
+	}
+
+	WRITE_ONCE(p->st_pi_boost,
+		   max(p->st_pi_boost, schedtune_task_boost(donor)));
+	WRITE_ONCE(p->st_pi_prefer_idle,
+		   max(p->st_pi_prefer_idle, schedtune_prefer_idle(donor)));
+	WRITE_ONCE(p->st_pi_prefer_perf,
+		   max(p->st_pi_prefer_perf, schedtune_prefer_perf(donor)));
+}
+#endif
+
 int schedtune_need_group_balance(struct task_struct *p)
 {
 	bool balance;
@@ -714,6 +862,9 @@ static void __schedtune_group_util_update(struct schedtune *st)
 	unsigned long util_sum = 0;
 	unsigned long heaviest_util = 0;
 	unsigned int total = 0, accumulated = 0;
+#ifdef CONFIG_SCHED_WALT
+	unsigned long demand = 0, pred_demand = 0, max_pred_demand = 0;
+#endif
 
 	if (!raw_spin_trylock(&gb->lock))
 		return;
@@ -743,9 +894,28 @@ static void __schedtune_group_util_update(struct schedtune *st)
 
 		util_sum += p->se.avg.util_avg;
 		accumulated++;
+#ifdef CONFIG_SCHED_WALT
+		util = walt_task_pred_demand(p);
+		max_pred_demand = max(max_pred_demand, util);
+		pred_demand += util;
+		demand += walt_task_demand(p);
+#endif
 	}
 	css_task_iter_end(&it);
 
+#ifdef CONFIG_SCHED_WALT
+	/* Wake up pollers of walt_demand when it moved by 1/8 or more */
+	if (abs((long)pred_demand - (long)st->walt_pred_demand) >
+			(long)(st->walt_pred_demand >> 3) ||
+	    abs((long)demand - (long)st->walt_demand) >
+			(long)(st->walt_demand >> 3)) {
+		st->walt_demand = demand;
+		st->walt_pred_demand = pred_demand;
+		st->walt_max_pred_demand = max_pred_demand;
+		cgroup_file_notify(&st->walt_demand_file);
+	}
+#endif
+
 	gb->util = util_sum;
 	gb->heaviest_util = heaviest_util;
 	gb->next_update_time = now + gb->update_interval;
@@ -780,6 +950,21 @@ void schedtune_group_util_update(void)
 	rcu_read_unlock();
 }
 
+#ifdef CONFIG_SCHED_WALT
+static int walt_demand_show(struct seq_file *sf, void *v)
+{
+	struct schedtune *st = css_st(seq_css(sf));
+
+	/* The group's cluster is the one its heaviest task prefers */
+	seq_printf(sf, "demand %lu\n", st->walt_demand);
+	seq_printf(sf, "pred_demand %lu\n", st->walt_pred_demand);
+	seq_printf(sf, "cluster %d\n",
+		   walt_preferred_cluster(st->walt_max_pred_demand));
+
+	return 0;
+}
+#endif
+
 static u64
 gb_util_read(struct cgroup_subsys_state *css, struct cftype *cft)
 {
@@ -963,6 +1148,56 @@ prefer_perf_write(struct cgroup_subsys_state *css, struct cftype *cft,
 	return 0;
 }
 
+static u64
+reserved_cpus_read(struct cgroup_subsys_state *css, struct cftype *cft)
+{
+	struct schedtune *st = css_st(css);
+
+	return st->reserved_cpus;
+}
+
+static int
+reserved_cpus_write(struct cgroup_subsys_state *css, struct cftype *cft,
+	    u64 reserved_cpus)
+{
+	struct schedtune *st = css_st(css);
+
+	if (css == &root_schedtune.css || reserved_cpus >= NR_CPUS)
+		return -EINVAL;
+
+	mutex_lock(&reserved_mutex);
+	st->reserved_cpus = reserved_cpus;
+	schedtune_update_reserved();
+	mutex_unlock(&reserved_mutex);
+
+	return 0;
+}
+
+static u64
+reserved_idle_us_read(struct cgroup_subsys_state *css, struct cftype *cft)
+{
+	struct schedtune *st = css_st(css);
+
+	return div_u64(st->reserved_idle_ns, NSEC_PER_USEC);
+}
+
+static int
+reserved_idle_us_write(struct cgroup_subsys_state *css, struct cftype *cft,
+	    u64 idle_us)
+{
+	struct schedtune *st = css_st(css);
+
+	if (idle_us > USEC_PER_SEC)
+		return -EINVAL;
+
+	mutex_lock(&reserved_mutex);
+	st->reserved_idle_ns = idle_us * NSEC_PER_USEC;
+	schedtune_update_reserved();
+	mutex_unlock(&reserved_mutex);
+
+	return 0;
+}
+
 static s64
 boost_read(struct cgroup_subsys_state *css, struct cftype *cft)
 {
@@ -1024,10 +1259,27 @@ static struct cftype files[] = {
 		.read_u64 = prefer_perf_read,
 		.write_u64 = prefer_perf_write,
 	},
+	{
+		.name = "reserved_cpus",
+		.read_u64 = reserved_cpus_read,
+		.write_u64 = reserved_cpus_write,
+	},
+	{
+		.name = "reserved_idle_us",
+		.read_u64 = reserved_idle_us_read,
+		.write_u64 = reserved_idle_us_write,
+	},
 	{
 		.name = "gb_util",
 		.read_u64 = gb_util_read,
 	},
+#ifdef CONFIG_SCHED_WALT
+	{
+		.name = "walt_demand",
+		.seq_show = walt_demand_show,
+		.file_offset = offsetof(struct schedtune, walt_demand_file),
+	},
+#endif
 	{
 		.name = "gb_heaviest_ratio",
 		.read_u64 = gb_heaviest_ratio_read,
@@ -1130,6 +1382,7 @@ schedtune_css_alloc(struct cgroup_subsys_state *parent_css)
 		goto out;
 
 	schedtune_group_balancer_init(st);
+	st->reserved_idle_ns = 2 * NSEC_PER_MSEC;	/* 2ms */
 
 	/* Initialize per CPUs boost group support */
 	st->idx = idx;
@@ -1151,7 +1404,11 @@ schedtune_boostgroup_release(struct schedtune *st)
 	schedtune_boostgroup_update(st->idx, 0);
 
 	/* Keep track of allocated boost groups */
+	mutex_lock(&reserved_mutex);
 	allocated_group[st->idx] = NULL;
+	if (st->reserved_cpus)
+		schedtune_update_reserved();
+	mutex_unlock(&reserved_mutex);
 }
 
 static void
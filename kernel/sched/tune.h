@@ -25,6 +25,8 @@ int schedtune_perf_threshold(void);
 int schedtune_prefer_idle(struct task_struct *tsk);
 int schedtune_prefer_perf(struct task_struct *tsk);
 
+bool schedtune_cpu_reserved(struct task_struct *p, int cpu);
+
 void schedtune_exit_task(struct task_struct *tsk);
 
 void schedtune_enqueue_task(struct task_struct *p, int cpu);
@@ -38,6 +40,8 @@ void schedtune_dequeue_task(struct task_struct *p, int cpu);
 #define schedtune_group_util_update() do { } while (0)
 #define schedtune_need_group_balance(task) 0
 
+#define schedtune_cpu_reserved(task, cpu) false
+
 #define schedtune_exit_task(task) do { } while (0)
 
 #define schedtune_enqueue_task(task, cpu) do { } while (0)
@@ -57,6 +61,8 @@ int schedtune_accept_deltas(int nrg_delta, int cap_delta,
 #define schedtune_group_util_update() do { } while (0)
 #define schedtune_need_group_balance(task) 0
 
+#define schedtune_cpu_reserved(task, cpu) false
+
 #define schedtune_exit_task(task) do { } while (0)
 
 #define schedtune_enqueue_task(task, cpu) do { } while (0)
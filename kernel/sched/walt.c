@@ -1131,3 +1131,73 @@ void walt_init_new_task_load(struct task_struct *p)
 	for (i = 0; i < RAVG_HIST_SIZE_MAX; ++i)
 		p->ravg.sum_history[i] = init_load_windows;
 }
+
+/*
+ * Demand of @p converted to capacity units, as seen by the scheduler.
+ */
+unsigned long walt_task_demand(struct task_struct *p)
+{
+	u64 demand = READ_ONCE(p->ravg.demand);
+
+	return div_u64(demand << SCHED_CAPACITY_SHIFT, walt_ravg_window);
+}
+
+/*
+ * Predicted demand of @p for the next window in capacity units.
+ *
+ * 'demand' follows the window stats policy and reacts late to a task that is
+ * ramping up. Take the part of the current window already consumed, and a
+ * linear extrapolation of the last two windows when they are rising, into
+ * account so that the prediction leads the demand instead of lagging it.
+ */
+unsigned long walt_task_pred_demand(struct task_struct *p)
+{
+	u64 pred = READ_ONCE(p->ravg.demand);
+	u32 recent = READ_ONCE(p->ravg.sum_history[0]);
+	u32 prev = READ_ONCE(p->ravg.sum_history[1]);
+	u32 sum = READ_ONCE(p->ravg.sum);
+
+	if (recent > prev)
+		pred = max_t(u64, pred, 2 * (u64)recent - prev);
+	pred = max_t(u64, pred, sum);
+	pred = min_t(u64, pred, walt_ravg_window);
+
+	return div_u64(pred << SCHED_CAPACITY_SHIFT, walt_ravg_window);
+}
+
+/*
+ * First cpu of the lowest capacity cluster that fits @util with the
+ * capacity margin, or of the biggest cluster if none does.
+ */
+int walt_preferred_cluster(unsigned long util)
+{
+	int cpu, best = -1, max_cpu = 0;
+
+	for_each_possible_cpu(cpu) {
+		unsigned long capacity = capacity_orig_of(cpu);
+
+		if (cpu != cpumask_first(cpu_coregroup_mask(cpu)))
+			continue;
+
+		if (capacity > capacity_orig_of(max_cpu))
+			max_cpu = cpu;
+
+		if (capacity * SCHED_CAPACITY_SCALE <
+				util * capacity_margin_of(cpu))
+			continue;
+
+		if (best < 0 || capacity < capacity_orig_of(best))
+			best = cpu;
+	}
+
+	return best < 0 ? max_cpu : best;
+}
+
+void proc_walt_show_demand(struct task_struct *p, struct seq_file *m)
+{
+	unsigned long pred = walt_task_pred_demand(p);
+
+	seq_printf(m, "demand %lu\n", walt_task_demand(p));
+	seq_printf(m, "pred_demand %lu\n", pred);
+	seq_printf(m, "cluster %d\n", walt_preferred_cluster(pred));
+}
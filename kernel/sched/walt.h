@@ -37,6 +37,10 @@ void walt_account_irqtime(int cpu, struct task_struct *curr, u64 delta,
 u64 walt_irqload(int cpu);
 int walt_cpu_high_irqload(int cpu);
 
+unsigned long walt_task_demand(struct task_struct *p);
+unsigned long walt_task_pred_demand(struct task_struct *p);
+int walt_preferred_cluster(unsigned long util);
+
 #else /* CONFIG_SCHED_WALT */
 
 static inline void walt_update_task_ravg(struct task_struct *p, struct rq *rq,
@@ -1496,6 +1496,26 @@ static struct ctl_table vm_table[] = {
 		.extra1		= &zero,
 		.extra2		= &one,
 	},
+#ifdef CONFIG_COMPACTION_PROACTIVE
+	{
+		.procname	= "compaction_proactiveness",
+		.data		= &sysctl_compaction_proactiveness,
+		.maxlen		= sizeof(sysctl_compaction_proactiveness),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &zero,
+		.extra2		= &one_hundred,
+	},
+	{
+		.procname	= "compaction_proactive_budget_ms",
+		.data		= &sysctl_compaction_proactive_budget_ms,
+		.maxlen		= sizeof(sysctl_compaction_proactive_budget_ms),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &one,
+		.extra2		= &one_thousand,
+	},
+#endif
 
 #endif /* CONFIG_COMPACTION */
 	{
@@ -1540,6 +1560,14 @@ static struct ctl_table vm_table[] = {
 		.proc_handler	= proc_dointvec_minmax,
 		.extra1		= &zero,
 	},
+	{
+		.procname	= "fork_lazy_file_kb",
+		.data		= &sysctl_fork_lazy_file_kb,
+		.maxlen		= sizeof(sysctl_fork_lazy_file_kb),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &zero,
+	},
 #else
 	{
 		.procname	= "nr_trim_pages",
@@ -1600,6 +1600,43 @@ long __sched hrtimer_nanosleep_restart(struct restart_block *restart)
 	return ret;
 }
 
+#ifdef CONFIG_CGROUP_SCHED
+/*
+ * Set the expiry range of a sleep of current. If its cpu cgroup asks for
+ * an alignment, the slack is cut so that the hard expiry lands on the
+ * alignment grid whenever the grid has a point within the range: the
+ * sleeps of all the tasks sharing the grid then end with the same wakeup
+ * instead of each one waking the CPU up by itself.
+ */
+static void hrtimer_set_sleep_expires(struct hrtimer *timer, ktime_t expires,
+				      u64 slack, const enum hrtimer_mode mode)
+{
+	u64 align = current->cgroup_timer_align_ns;
+	s64 start, end;
+
+	if (align && slack) {
+		start = ktime_to_ns(expires);
+		if (mode & HRTIMER_MODE_REL)
+			start += ktime_to_ns(hrtimer_cb_get_time(timer));
+
+		if (start >= 0 && start < KTIME_MAX - (s64)slack) {
+			end = div64_u64(start + slack, align) * align;
+			if (end >= start)
+				slack = end - start;
+		}
+	}
+
+	hrtimer_set_expires_range_ns(timer, expires, slack);
+}
+#else
+static inline void hrtimer_set_sleep_expires(struct hrtimer *timer,
+					     ktime_t expires, u64 slack,
+					     const enum hrtimer_mode mode)
+{
+	hrtimer_set_expires_range_ns(timer, expires, slack);
+}
+#endif
+
 long hrtimer_nanosleep(struct timespec *rqtp, struct timespec __user *rmtp,
 		       const enum hrtimer_mode mode, const clockid_t clockid)
 {
@@ -1613,7 +1650,8 @@ long hrtimer_nanosleep(struct timespec *rqtp, struct timespec __user *rmtp,
 		slack = 0;
 
 	hrtimer_init_on_stack(&t.timer, clockid, mode);
-	hrtimer_set_expires_range_ns(&t.timer, timespec_to_ktime(*rqtp), slack);
+	hrtimer_set_sleep_expires(&t.timer, timespec_to_ktime(*rqtp), slack,
+				  mode);
 	if (do_nanosleep(&t, mode))
 		goto out;
 
@@ -1780,7 +1818,7 @@ schedule_hrtimeout_range_clock(ktime_t *expires, u64 delta,
 	}
 
 	hrtimer_init_on_stack(&t.timer, clock, mode);
-	hrtimer_set_expires_range_ns(&t.timer, *expires, delta);
+	hrtimer_set_sleep_expires(&t.timer, *expires, delta, mode);
 
 	hrtimer_init_sleeper(&t, current);
 
@@ -18,6 +18,8 @@
 #include <linux/user_namespace.h>
 #include <linux/proc_fs.h>
 #include <linux/proc_ns.h>
+#include <linux/cred.h>
+#include <linux/percpu.h>
 
 /*
  * userns count is 1 for root user, 1 for init_uts_ns,
@@ -88,6 +90,10 @@ struct hlist_head uidhash_table[UIDHASH_SZ];
  */
 static DEFINE_SPINLOCK(uidhash_lock);
 
+#ifdef CONFIG_UID_SYS_STATS
+static DEFINE_PER_CPU(struct uid_sys_acct, root_user_sys_acct);
+#endif
+
 /* root_user.__count is 1, for init task cred */
 struct user_struct root_user = {
 	.__count	= ATOMIC_INIT(1),
@@ -95,6 +101,9 @@ struct user_struct root_user = {
 	.sigpending	= ATOMIC_INIT(0),
 	.locked_shm     = 0,
 	.uid		= GLOBAL_ROOT_UID,
+#ifdef CONFIG_UID_SYS_STATS
+	.sys_acct	= &root_user_sys_acct,
+#endif
 };
 
 /*
@@ -135,6 +144,9 @@ static void free_user(struct user_struct *up, unsigned long flags)
 	spin_unlock_irqrestore(&uidhash_lock, flags);
 	key_put(up->uid_keyring);
 	key_put(up->session_keyring);
+#ifdef CONFIG_UID_SYS_STATS
+	free_percpu(up->sys_acct);
+#endif
 	kmem_cache_free(uid_cachep, up);
 }
 
@@ -185,6 +197,13 @@ struct user_struct *alloc_uid(kuid_t uid)
 
 		new->uid = uid;
 		atomic_set(&new->__count, 1);
+#ifdef CONFIG_UID_SYS_STATS
+		new->sys_acct = alloc_percpu(struct uid_sys_acct);
+		if (!new->sys_acct) {
+			kmem_cache_free(uid_cachep, new);
+			goto out_unlock;
+		}
+#endif
 
 		/*
 		 * Before adding this, check whether we raced
@@ -195,6 +214,9 @@ struct user_struct *alloc_uid(kuid_t uid)
 		if (up) {
 			key_put(new->uid_keyring);
 			key_put(new->session_keyring);
+#ifdef CONFIG_UID_SYS_STATS
+			free_percpu(new->sys_acct);
+#endif
 			kmem_cache_free(uid_cachep, new);
 		} else {
 			uid_hash_insert(new, hashent);
@@ -210,6 +232,51 @@ struct user_struct *alloc_uid(kuid_t uid)
 	return NULL;
 }
 
+#ifdef CONFIG_UID_SYS_STATS
+/* Charge cpu time or I/O of a task to the user it runs as */
+void uid_sys_acct_add(struct task_struct *tsk, enum uid_sys_acct_item item,
+		      u64 val)
+{
+	struct user_struct *up;
+
+	rcu_read_lock();
+	up = __task_cred(tsk)->user;
+	this_cpu_add(up->sys_acct->val[item], val);
+	rcu_read_unlock();
+}
+
+void uid_sys_acct_read(struct user_struct *up, struct uid_sys_acct *acct)
+{
+	struct uid_sys_acct *pcpu;
+	int cpu, i;
+
+	memset(acct, 0, sizeof(*acct));
+	for_each_possible_cpu(cpu) {
+		pcpu = per_cpu_ptr(up->sys_acct, cpu);
+		for (i = 0; i < UID_ACCT_NR; i++)
+			acct->val[i] += READ_ONCE(pcpu->val[i]);
+	}
+}
+
+/*
+ * Call fn for every user with the uidhash_lock held and interrupts
+ * disabled. fn may take a reference on the user with get_uid().
+ */
+void for_each_user_struct(void (*fn)(struct user_struct *up, void *data),
+			  void *data)
+{
+	struct user_struct *up;
+	unsigned long flags;
+	int n;
+
+	spin_lock_irqsave(&uidhash_lock, flags);
+	for (n = 0; n < UIDHASH_SZ; ++n)
+		hlist_for_each_entry(up, uidhash_table + n, uidhash_node)
+			fn(up, data);
+	spin_unlock_irqrestore(&uidhash_lock, flags);
+}
+#endif
+
 static int __init uid_cache_init(void)
 {
 	int n;
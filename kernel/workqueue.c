@@ -50,6 +50,7 @@
 #include <linux/uaccess.h>
 #include <linux/exynos-ss.h>
 #include <linux/nmi.h>
+#include <linux/topology.h>
 
 #include "workqueue_internal.h"
 
@@ -234,6 +235,9 @@ struct wq_flusher {
 
 struct wq_device;
 
+/* CPU classes of asymmetric systems, 0 is big and 1 is little */
+#define WQ_NR_CLUSTERS		2
+
 /*
  * The externally visible workqueue.  It relays the issued work items to
  * the appropriate worker_pool through its pool_workqueues.
@@ -277,6 +281,7 @@ struct workqueue_struct {
 	/* hot fields used during command issue, aligned to cacheline */
 	unsigned int		flags ____cacheline_aligned; /* WQ: WQ_* flags */
 	struct pool_workqueue __percpu *cpu_pwqs; /* I: per-cpu pwqs */
+	struct pool_workqueue __rcu *cluster_pwq_tbl[WQ_NR_CLUSTERS]; /* PWR: unbound pwqs indexed by CPU class */
 	struct pool_workqueue __rcu *numa_pwq_tbl[]; /* PWR: unbound pwqs indexed by node */
 };
 
@@ -296,6 +301,11 @@ bool wq_online;				/* can kworkers be created yet? */
 
 static bool wq_numa_enabled;		/* unbound NUMA affinity enabled */
 
+/* CPUs of each class, only valid if wq_cluster_enabled, see wq_cluster_init() */
+static cpumask_var_t wq_cluster_cpumask[WQ_NR_CLUSTERS];
+
+static bool wq_cluster_enabled;		/* asymmetric CPU classes found */
+
 /* buf for wq_update_unbound_numa_attrs(), protected by CPU hotplug exclusion */
 static struct workqueue_attrs *wq_update_unbound_numa_attrs_buf;
 
@@ -577,6 +587,32 @@ static struct pool_workqueue *unbound_pwq_by_node(struct workqueue_struct *wq,
 	return rcu_dereference_raw(wq->numa_pwq_tbl[node]);
 }
 
+/**
+ * unbound_pwq_by_cpu - return the unbound pool_workqueue for the given CPU
+ * @wq: the target workqueue
+ * @cpu: the CPU the work item is issued on
+ *
+ * Same as unbound_pwq_by_node() except that the pwq of the CPU class of
+ * @cpu is preferred if @wq follows the cluster of the submitter.
+ *
+ * Return: The unbound pool_workqueue for @cpu.
+ */
+static struct pool_workqueue *unbound_pwq_by_cpu(struct workqueue_struct *wq,
+						 int cpu)
+{
+	struct pool_workqueue *pwq;
+
+	if (wq_cluster_enabled) {
+		int cluster = cpumask_test_cpu(cpu, wq_cluster_cpumask[0]) ? 0 : 1;
+
+		pwq = rcu_dereference_raw(wq->cluster_pwq_tbl[cluster]);
+		if (pwq)
+			return pwq;
+	}
+
+	return unbound_pwq_by_node(wq, cpu_to_node(cpu));
+}
+
 static unsigned int work_color_to_flags(int color)
 {
 	return color << WORK_STRUCT_COLOR_SHIFT;
@@ -1411,7 +1447,7 @@ static void __queue_work(int cpu, struct workqueue_struct *wq,
 	if (wq->flags & WQ_UNBOUND) {
 		if (req_cpu == WORK_CPU_UNBOUND)
 			cpu = wq_select_unbound_cpu(raw_smp_processor_id());
-		pwq = unbound_pwq_by_node(wq, cpu_to_node(cpu));
+		pwq = unbound_pwq_by_cpu(wq, cpu);
 	} else {
 		if (req_cpu == WORK_CPU_UNBOUND)
 			cpu = raw_smp_processor_id();
@@ -3190,10 +3226,12 @@ static void copy_workqueue_attrs(struct workqueue_attrs *to,
 	cpumask_copy(to->cpumask, from->cpumask);
 	/*
 	 * Unlike hash and equality test, this function doesn't ignore
-	 * ->no_numa as it is used for both pool and wq attrs.  Instead,
-	 * get_unbound_pool() explicitly clears ->no_numa after copying.
+	 * ->no_numa and ->cluster as they are used for both pool and wq
+	 * attrs.  Instead, get_unbound_pool() explicitly clears them after
+	 * copying.
 	 */
 	to->no_numa = from->no_numa;
+	to->cluster = from->cluster;
 }
 
 /* hash value of the content of @attr */
@@ -3398,10 +3436,11 @@ static struct worker_pool *get_unbound_pool(const struct workqueue_attrs *attrs)
 	pool->node = target_node;
 
 	/*
-	 * no_numa isn't a worker_pool attribute, always clear it.  See
-	 * 'struct workqueue_attrs' comments for detail.
+	 * no_numa and cluster aren't worker_pool attributes, always clear
+	 * them.  See 'struct workqueue_attrs' comments for detail.
 	 */
 	pool->attrs->no_numa = false;
+	pool->attrs->cluster = WQ_CLUSTER_ANY;
 
 	if (worker_pool_assign_id(pool) < 0)
 		goto fail;
@@ -3639,6 +3678,7 @@ struct apply_wqattrs_ctx {
 	struct workqueue_attrs	*attrs;		/* attrs to apply */
 	struct list_head	list;		/* queued for batching commit */
 	struct pool_workqueue	*dfl_pwq;
+	struct pool_workqueue	*cluster_pwq[WQ_NR_CLUSTERS];
 	struct pool_workqueue	*pwq_tbl[];
 };
 
@@ -3646,10 +3686,12 @@ struct apply_wqattrs_ctx {
 static void apply_wqattrs_cleanup(struct apply_wqattrs_ctx *ctx)
 {
 	if (ctx) {
-		int node;
+		int node, i;
 
 		for_each_node(node)
 			put_pwq_unlocked(ctx->pwq_tbl[node]);
+		for (i = 0; i < WQ_NR_CLUSTERS; i++)
+			put_pwq_unlocked(ctx->cluster_pwq[i]);
 		put_pwq_unlocked(ctx->dfl_pwq);
 
 		free_workqueue_attrs(ctx->attrs);
@@ -3665,7 +3707,7 @@ apply_wqattrs_prepare(struct workqueue_struct *wq,
 {
 	struct apply_wqattrs_ctx *ctx;
 	struct workqueue_attrs *new_attrs, *tmp_attrs;
-	int node;
+	int node, i;
 
 	lockdep_assert_held(&wq_pool_mutex);
 
@@ -3687,6 +3729,18 @@ apply_wqattrs_prepare(struct workqueue_struct *wq,
 	if (unlikely(cpumask_empty(new_attrs->cpumask)))
 		cpumask_copy(new_attrs->cpumask, wq_unbound_cpumask);
 
+	/*
+	 * A big or little hint narrows the cpumask down to that CPU class
+	 * unless it would leave no CPU.
+	 */
+	if (wq_cluster_enabled && (attrs->cluster == WQ_CLUSTER_BIG ||
+				   attrs->cluster == WQ_CLUSTER_LITTLE)) {
+		i = attrs->cluster == WQ_CLUSTER_BIG ? 0 : 1;
+		if (cpumask_intersects(new_attrs->cpumask, wq_cluster_cpumask[i]))
+			cpumask_and(new_attrs->cpumask, new_attrs->cpumask,
+				    wq_cluster_cpumask[i]);
+	}
+
 	/*
 	 * We may create multiple pwqs with differing cpumasks.  Make a
 	 * copy of @new_attrs which will be modified and used to obtain
@@ -3714,6 +3768,26 @@ apply_wqattrs_prepare(struct workqueue_struct *wq,
 		}
 	}
 
+	/*
+	 * Following the submitter needs a pwq per CPU class, which takes
+	 * precedence over the NUMA ones.  A class with no CPU in the mask,
+	 * or with all of them, is served by the NUMA pwqs.  Ordered wqs
+	 * have to stay on a single pwq.
+	 */
+	if (wq_cluster_enabled && attrs->cluster == WQ_CLUSTER_SUBMITTER &&
+	    !(wq->flags & __WQ_ORDERED)) {
+		for (i = 0; i < WQ_NR_CLUSTERS; i++) {
+			if (!cpumask_and(tmp_attrs->cpumask, new_attrs->cpumask,
+					 wq_cluster_cpumask[i]) ||
+			    cpumask_equal(tmp_attrs->cpumask, new_attrs->cpumask))
+				continue;
+
+			ctx->cluster_pwq[i] = alloc_unbound_pwq(wq, tmp_attrs);
+			if (!ctx->cluster_pwq[i])
+				goto out_free;
+		}
+	}
+
 	/* save the user configured attrs and sanitize it. */
 	copy_workqueue_attrs(new_attrs, attrs);
 	cpumask_and(new_attrs->cpumask, new_attrs->cpumask, cpu_possible_mask);
@@ -3733,7 +3807,8 @@ apply_wqattrs_prepare(struct workqueue_struct *wq,
 /* set attrs and install prepared pwqs, @ctx points to old pwqs on return */
 static void apply_wqattrs_commit(struct apply_wqattrs_ctx *ctx)
 {
-	int node;
+	struct pool_workqueue *old_pwq;
+	int node, i;
 
 	/* all pwqs have been created successfully, let's install'em */
 	mutex_lock(&ctx->wq->mutex);
@@ -3745,6 +3820,15 @@ static void apply_wqattrs_commit(struct apply_wqattrs_ctx *ctx)
 		ctx->pwq_tbl[node] = numa_pwq_tbl_install(ctx->wq, node,
 							  ctx->pwq_tbl[node]);
 
+	for (i = 0; i < WQ_NR_CLUSTERS; i++) {
+		if (ctx->cluster_pwq[i])
+			link_pwq(ctx->cluster_pwq[i]);
+		old_pwq = rcu_access_pointer(ctx->wq->cluster_pwq_tbl[i]);
+		rcu_assign_pointer(ctx->wq->cluster_pwq_tbl[i],
+				   ctx->cluster_pwq[i]);
+		ctx->cluster_pwq[i] = old_pwq;
+	}
+
 	/* @dfl_pwq might not have been used, ensure it's linked */
 	link_pwq(ctx->dfl_pwq);
 	swap(ctx->wq->dfl_pwq, ctx->dfl_pwq);
@@ -3906,6 +3990,34 @@ static void wq_update_unbound_numa(struct workqueue_struct *wq, int cpu,
 	put_pwq_unlocked(old_pwq);
 }
 
+/* apply @attrs along with the cluster hint of @wq's WQ_* flags */
+static int apply_dfl_workqueue_attrs(struct workqueue_struct *wq,
+				     const struct workqueue_attrs *attrs)
+{
+	struct workqueue_attrs *tmp_attrs;
+	int ret;
+
+	if (!(wq->flags & (WQ_PREFER_BIG | WQ_PREFER_LITTLE |
+			   WQ_FOLLOW_CLUSTER)))
+		return apply_workqueue_attrs(wq, attrs);
+
+	tmp_attrs = alloc_workqueue_attrs(GFP_KERNEL);
+	if (!tmp_attrs)
+		return -ENOMEM;
+
+	copy_workqueue_attrs(tmp_attrs, attrs);
+	if (wq->flags & WQ_PREFER_BIG)
+		tmp_attrs->cluster = WQ_CLUSTER_BIG;
+	else if (wq->flags & WQ_PREFER_LITTLE)
+		tmp_attrs->cluster = WQ_CLUSTER_LITTLE;
+	else
+		tmp_attrs->cluster = WQ_CLUSTER_SUBMITTER;
+
+	ret = apply_workqueue_attrs(wq, tmp_attrs);
+	free_workqueue_attrs(tmp_attrs);
+	return ret;
+}
+
 static int alloc_and_link_pwqs(struct workqueue_struct *wq)
 {
 	bool highpri = wq->flags & WQ_HIGHPRI;
@@ -3930,14 +4042,14 @@ static int alloc_and_link_pwqs(struct workqueue_struct *wq)
 		}
 		return 0;
 	} else if (wq->flags & __WQ_ORDERED) {
-		ret = apply_workqueue_attrs(wq, ordered_wq_attrs[highpri]);
+		ret = apply_dfl_workqueue_attrs(wq, ordered_wq_attrs[highpri]);
 		/* there should only be single pwq for ordering guarantee */
 		WARN(!ret && (wq->pwqs.next != &wq->dfl_pwq->pwqs_node ||
 			      wq->pwqs.prev != &wq->dfl_pwq->pwqs_node),
 		     "ordering guarantee broken for workqueue %s\n", wq->name);
 		return ret;
 	} else {
-		return apply_workqueue_attrs(wq, unbound_std_wq_attrs[highpri]);
+		return apply_dfl_workqueue_attrs(wq, unbound_std_wq_attrs[highpri]);
 	}
 }
 
@@ -4079,7 +4191,7 @@ EXPORT_SYMBOL_GPL(__alloc_workqueue_key);
 void destroy_workqueue(struct workqueue_struct *wq)
 {
 	struct pool_workqueue *pwq;
-	int node;
+	int node, i;
 
 	/*
 	 * Remove it from sysfs first so that sanity check failure doesn't
@@ -4151,6 +4263,12 @@ void destroy_workqueue(struct workqueue_struct *wq)
 			put_pwq_unlocked(pwq);
 		}
 
+		for (i = 0; i < WQ_NR_CLUSTERS; i++) {
+			pwq = rcu_access_pointer(wq->cluster_pwq_tbl[i]);
+			RCU_INIT_POINTER(wq->cluster_pwq_tbl[i], NULL);
+			put_pwq_unlocked(pwq);
+		}
+
 		/*
 		 * Put dfl_pwq.  @wq may be freed any time after dfl_pwq is
 		 * put.  Don't access it afterwards.
@@ -4256,7 +4374,7 @@ bool workqueue_congested(int cpu, struct workqueue_struct *wq)
 	if (!(wq->flags & WQ_UNBOUND))
 		pwq = per_cpu_ptr(wq->cpu_pwqs, cpu);
 	else
-		pwq = unbound_pwq_by_node(wq, cpu_to_node(cpu));
+		pwq = unbound_pwq_by_cpu(wq, cpu);
 
 	ret = !list_empty(&pwq->delayed_works);
 	rcu_read_unlock_sched();
@@ -5224,11 +5342,62 @@ static ssize_t wq_numa_store(struct device *dev, struct device_attribute *attr,
 	return ret ?: count;
 }
 
+static const char * const wq_cluster_names[] = {
+	[WQ_CLUSTER_ANY]	= "any",
+	[WQ_CLUSTER_BIG]	= "big",
+	[WQ_CLUSTER_LITTLE]	= "little",
+	[WQ_CLUSTER_SUBMITTER]	= "submitter",
+};
+
+static ssize_t wq_cluster_show(struct device *dev,
+			       struct device_attribute *attr, char *buf)
+{
+	struct workqueue_struct *wq = dev_to_wq(dev);
+	int written;
+
+	mutex_lock(&wq->mutex);
+	written = scnprintf(buf, PAGE_SIZE, "%s\n",
+			    wq_cluster_names[wq->unbound_attrs->cluster]);
+	mutex_unlock(&wq->mutex);
+
+	return written;
+}
+
+static ssize_t wq_cluster_store(struct device *dev,
+				struct device_attribute *attr,
+				const char *buf, size_t count)
+{
+	struct workqueue_struct *wq = dev_to_wq(dev);
+	struct workqueue_attrs *attrs;
+	int i, ret = -ENOMEM;
+
+	apply_wqattrs_lock();
+
+	attrs = wq_sysfs_prep_attrs(wq);
+	if (!attrs)
+		goto out_unlock;
+
+	ret = -EINVAL;
+	for (i = 0; i < ARRAY_SIZE(wq_cluster_names); i++) {
+		if (sysfs_streq(buf, wq_cluster_names[i])) {
+			attrs->cluster = i;
+			ret = apply_workqueue_attrs_locked(wq, attrs);
+			break;
+		}
+	}
+
+out_unlock:
+	apply_wqattrs_unlock();
+	free_workqueue_attrs(attrs);
+	return ret ?: count;
+}
+
 static struct device_attribute wq_sysfs_unbound_attrs[] = {
 	__ATTR(pool_ids, 0444, wq_pool_ids_show, NULL),
 	__ATTR(nice, 0644, wq_nice_show, wq_nice_store),
 	__ATTR(cpumask, 0644, wq_cpumask_show, wq_cpumask_store),
 	__ATTR(numa, 0644, wq_numa_show, wq_numa_store),
+	__ATTR(cluster, 0644, wq_cluster_show, wq_cluster_store),
 	__ATTR_NULL,
 };
 
@@ -5526,6 +5695,65 @@ static inline void wq_watchdog_init(void) { }
 
 #endif	/* CONFIG_WQ_WATCHDOG */
 
+/*
+ * Split the possible CPUs into big and little by their capacity.  This
+ * needs the capacities of all CPUs, which are known once the boot CPUs are
+ * up, so the workqueues created before with a cluster hint get their attrs
+ * applied again here.
+ */
+static int __init wq_cluster_init(void)
+{
+#ifdef arch_scale_cpu_capacity
+	struct workqueue_struct *wq;
+	struct apply_wqattrs_ctx *ctx;
+	unsigned long cap, max_cap = 0;
+	int i, cpu;
+
+	for (i = 0; i < WQ_NR_CLUSTERS; i++)
+		BUG_ON(!zalloc_cpumask_var(&wq_cluster_cpumask[i], GFP_KERNEL));
+
+	for_each_possible_cpu(cpu)
+		max_cap = max(max_cap, arch_scale_cpu_capacity(NULL, cpu));
+
+	for_each_possible_cpu(cpu) {
+		cap = arch_scale_cpu_capacity(NULL, cpu);
+		cpumask_set_cpu(cpu, wq_cluster_cpumask[cap < max_cap]);
+	}
+
+	/* symmetric, the hints have nothing to choose from */
+	if (cpumask_empty(wq_cluster_cpumask[1]))
+		return 0;
+
+	pr_info("workqueue: big CPUs %*pbl, little CPUs %*pbl\n",
+		cpumask_pr_args(wq_cluster_cpumask[0]),
+		cpumask_pr_args(wq_cluster_cpumask[1]));
+
+	apply_wqattrs_lock();
+
+	wq_cluster_enabled = true;
+
+	list_for_each_entry(wq, &workqueues, list) {
+		if (!(wq->flags & WQ_UNBOUND) ||
+		    wq->unbound_attrs->cluster == WQ_CLUSTER_ANY)
+			continue;
+
+		ctx = apply_wqattrs_prepare(wq, wq->unbound_attrs);
+		if (!ctx) {
+			pr_warn("workqueue: allocation failed while applying the cluster hint of \"%s\"\n",
+				wq->name);
+			continue;
+		}
+
+		apply_wqattrs_commit(ctx);
+		apply_wqattrs_cleanup(ctx);
+	}
+
+	apply_wqattrs_unlock();
+#endif
+	return 0;
+}
+core_initcall(wq_cluster_init);
+
 static void __init wq_numa_init(void)
 {
 	cpumask_var_t *tbl;
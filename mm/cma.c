@@ -35,6 +35,8 @@
 #include <linux/cma.h>
 #include <linux/highmem.h>
 #include <linux/io.h>
+#include <linux/moduleparam.h>
+#include <linux/shrinker.h>
 #include <trace/events/cma.h>
 
 #include "cma.h"
@@ -92,6 +94,261 @@ static void cma_clear_bitmap(struct cma *cma, unsigned long pfn,
 	mutex_unlock(&cma->lock);
 }
 
+#ifdef CONFIG_CMA_PRECLEAR
+/*
+ * Percentage of each area the worker may keep migrated-out while the area is
+ * idle. Zero disables precleaning.
+ */
+static unsigned int cma_preclear_percent = 25;
+module_param_named(preclear_percent, cma_preclear_percent, uint, 0644);
+
+#define CMA_PRECLEAR_IDLE_MS	2000
+
+static bool cma_is_rbin(struct cma *cma)
+{
+#ifdef CONFIG_RBIN
+	return cma->is_rbin;
+#else
+	return false;
+#endif
+}
+
+static void cma_preclear_kick(struct cma *cma)
+{
+	if (!READ_ONCE(cma_preclear_percent) || !cma->preclear_bitmap)
+		return;
+
+	mod_delayed_work(system_unbound_wq, &cma->preclear_work,
+			 msecs_to_jiffies(CMA_PRECLEAR_IDLE_MS));
+}
+
+/* called with cma->lock held */
+static void cma_preclear_note_alloc(struct cma *cma, unsigned long bits)
+{
+	cma->recent_bits[cma->recent_idx] = bits;
+	cma->recent_idx = (cma->recent_idx + 1) % CMA_PRECLEAR_HISTORY;
+	cma->alloc_seq++;
+}
+
+/* called with cma->lock held */
+static unsigned long cma_preclear_target(struct cma *cma)
+{
+	unsigned long target = 0;
+	int i;
+
+	for (i = 0; i < CMA_PRECLEAR_HISTORY; i++)
+		target = max(target, cma->recent_bits[i]);
+
+	return min(target, cma_bitmap_maxno(cma) *
+		   READ_ONCE(cma_preclear_percent) / 100);
+}
+
+/*
+ * Hand out @bitmap_count bits worth of precleared pages without migrating
+ * anything. The tail of the last bit beyond @count goes back to the buddy
+ * allocator, like it would have stayed there on the slow path.
+ */
+static struct page *cma_alloc_precleared(struct cma *cma, size_t count,
+					 unsigned long bitmap_count,
+					 unsigned long mask,
+					 unsigned long offset)
+{
+	unsigned long bitmap_maxno = cma_bitmap_maxno(cma);
+	unsigned long bitmap_no, pfn, tail;
+
+	mutex_lock(&cma->lock);
+	cma_preclear_note_alloc(cma, bitmap_count);
+	if (cma->nr_precleared < bitmap_count) {
+		mutex_unlock(&cma->lock);
+		return NULL;
+	}
+
+	bitmap_no = bitmap_find_next_zero_area_off(cma->preclear_bitmap,
+			bitmap_maxno, 0, bitmap_count, mask, offset);
+	if (bitmap_no >= bitmap_maxno) {
+		mutex_unlock(&cma->lock);
+		return NULL;
+	}
+	bitmap_set(cma->preclear_bitmap, bitmap_no, bitmap_count);
+	cma->nr_precleared -= bitmap_count;
+	cma->nr_alloc_fast++;
+	mutex_unlock(&cma->lock);
+
+	pfn = cma->base_pfn + (bitmap_no << cma->order_per_bit);
+	tail = (bitmap_count << cma->order_per_bit) - count;
+	if (tail)
+		free_contig_range(pfn + count, tail);
+
+	return pfn_to_page(pfn);
+}
+
+/*
+ * Give every precleared range back to the page allocator. Returns the number
+ * of pages released.
+ */
+static unsigned long cma_preclear_drop(struct cma *cma, bool trylock)
+{
+	unsigned long bitmap_maxno = cma_bitmap_maxno(cma);
+	unsigned long start, end = 0, freed = 0;
+
+	if (trylock) {
+		if (!mutex_trylock(&cma->lock))
+			return 0;
+	} else {
+		mutex_lock(&cma->lock);
+	}
+
+	while (cma->nr_precleared) {
+		start = find_next_zero_bit(cma->preclear_bitmap,
+					   bitmap_maxno, end);
+		if (start >= bitmap_maxno)
+			break;
+		end = find_next_bit(cma->preclear_bitmap, bitmap_maxno, start);
+
+		free_contig_range(cma->base_pfn + (start << cma->order_per_bit),
+				  (end - start) << cma->order_per_bit);
+		bitmap_set(cma->preclear_bitmap, start, end - start);
+		bitmap_clear(cma->bitmap, start, end - start);
+		cma->nr_precleared -= end - start;
+		freed += (end - start) << cma->order_per_bit;
+	}
+	cma->nr_preclear_dropped += freed;
+	mutex_unlock(&cma->lock);
+
+	return freed;
+}
+
+/*
+ * Runs once the area saw no allocation or release for CMA_PRECLEAR_IDLE_MS,
+ * and migrates pageblock-sized chunks out until the target is reached. Any
+ * allocation in between ends the pass, the next idle period restarts it.
+ */
+static void cma_preclear_work(struct work_struct *work)
+{
+	struct cma *cma = container_of(to_delayed_work(work), struct cma,
+				       preclear_work);
+	unsigned long bitmap_maxno = cma_bitmap_maxno(cma);
+	unsigned long chunk, mask, offset, start = 0, seq;
+	unsigned long bitmap_no, pfn;
+	int ret;
+
+	chunk = cma_bitmap_pages_to_bits(cma, pageblock_nr_pages);
+	mask = cma_bitmap_aligned_mask(cma, pageblock_order);
+	offset = cma_bitmap_aligned_offset(cma, pageblock_order);
+
+	mutex_lock(&cma->lock);
+	seq = cma->alloc_seq;
+	while (cma->nr_precleared < cma_preclear_target(cma) &&
+	       cma->alloc_seq == seq) {
+		bitmap_no = bitmap_find_next_zero_area_off(cma->bitmap,
+				bitmap_maxno, start, chunk, mask, offset);
+		if (bitmap_no >= bitmap_maxno)
+			break;
+		bitmap_set(cma->bitmap, bitmap_no, chunk);
+		mutex_unlock(&cma->lock);
+
+		pfn = cma->base_pfn + (bitmap_no << cma->order_per_bit);
+		mutex_lock(&cma_mutex);
+		ret = alloc_contig_range(pfn, pfn + (chunk << cma->order_per_bit),
+					 MIGRATE_CMA);
+		mutex_unlock(&cma_mutex);
+
+		mutex_lock(&cma->lock);
+		if (ret) {
+			bitmap_clear(cma->bitmap, bitmap_no, chunk);
+			if (ret != -EBUSY)
+				break;
+		} else {
+			bitmap_clear(cma->preclear_bitmap, bitmap_no, chunk);
+			cma->nr_precleared += chunk;
+		}
+		start = bitmap_no + chunk;
+
+		mutex_unlock(&cma->lock);
+		cond_resched();
+		mutex_lock(&cma->lock);
+	}
+	mutex_unlock(&cma->lock);
+}
+
+static unsigned long cma_preclear_count(struct shrinker *shrink,
+					struct shrink_control *sc)
+{
+	unsigned long pages = 0;
+	int i;
+
+	for (i = 0; i < cma_area_count; i++) {
+		struct cma *cma = &cma_areas[i];
+
+		if (cma->preclear_bitmap)
+			pages += READ_ONCE(cma->nr_precleared) <<
+				 cma->order_per_bit;
+	}
+
+	return pages;
+}
+
+static unsigned long cma_preclear_scan(struct shrinker *shrink,
+				       struct shrink_control *sc)
+{
+	unsigned long freed = 0;
+	int i;
+
+	for (i = 0; i < cma_area_count && freed < sc->nr_to_scan; i++) {
+		struct cma *cma = &cma_areas[i];
+
+		if (cma->preclear_bitmap && READ_ONCE(cma->nr_precleared))
+			freed += cma_preclear_drop(cma, true);
+	}
+
+	return freed ? freed : SHRINK_STOP;
+}
+
+static struct shrinker cma_preclear_shrinker = {
+	.count_objects = cma_preclear_count,
+	.scan_objects = cma_preclear_scan,
+	.seeks = DEFAULT_SEEKS,
+};
+
+static int __init cma_preclear_init(struct cma *cma)
+{
+	int bitmap_size = BITS_TO_LONGS(cma_bitmap_maxno(cma)) * sizeof(long);
+
+	INIT_DELAYED_WORK(&cma->preclear_work, cma_preclear_work);
+	if (cma_is_rbin(cma))
+		return 0;
+
+	cma->preclear_bitmap = kmalloc(bitmap_size, GFP_KERNEL);
+	if (!cma->preclear_bitmap)
+		return -ENOMEM;
+	bitmap_fill(cma->preclear_bitmap, cma_bitmap_maxno(cma));
+
+	return 0;
+}
+#else
+static inline void cma_preclear_kick(struct cma *cma)
+{
+}
+
+static inline struct page *cma_alloc_precleared(struct cma *cma, size_t count,
+						unsigned long bitmap_count,
+						unsigned long mask,
+						unsigned long offset)
+{
+	return NULL;
+}
+
+static inline unsigned long cma_preclear_drop(struct cma *cma, bool trylock)
+{
+	return 0;
+}
+
+static inline int cma_preclear_init(struct cma *cma)
+{
+	return 0;
+}
+#endif
+
 static int __init cma_activate_area(struct cma *cma)
 {
 	int bitmap_size = BITS_TO_LONGS(cma_bitmap_maxno(cma)) * sizeof(long);
@@ -134,6 +391,10 @@ static int __init cma_activate_area(struct cma *cma)
 
 	mutex_init(&cma->lock);
 
+	if (cma_preclear_init(cma))
+		pr_warn("%s: no precleaning for area at pfn %lu\n", __func__,
+			cma->base_pfn);
+
 #ifdef CONFIG_CMA_DEBUGFS
 	INIT_HLIST_HEAD(&cma->mem_head);
 	spin_lock_init(&cma->mem_head_lock);
@@ -158,6 +419,9 @@ static int __init cma_init_reserved_areas(void)
 			return ret;
 	}
 
+#ifdef CONFIG_CMA_PRECLEAR
+	register_shrinker(&cma_preclear_shrinker);
+#endif
 	return 0;
 }
 core_initcall(cma_init_reserved_areas);
@@ -427,6 +691,16 @@ struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align)
 	if (bitmap_count > bitmap_maxno)
 		return NULL;
 
+	if (!is_rbin) {
+		page = cma_alloc_precleared(cma, count, bitmap_count, mask,
+					    offset);
+		if (page) {
+			pfn = page_to_pfn(page);
+			goto out;
+		}
+	}
+
+retry:
 	for (;;) {
 		mutex_lock(&cma->lock);
 		bitmap_no = bitmap_find_next_zero_area_off(cma->bitmap,
@@ -475,6 +749,21 @@ struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align)
 		start = bitmap_no + mask + 1;
 	}
 
+	/* precleared ranges may fragment the area, give them back and retry */
+	if (!page && !is_rbin && cma_preclear_drop(cma, false)) {
+		start = 0;
+		goto retry;
+	}
+#ifdef CONFIG_CMA_PRECLEAR
+	if (page && !is_rbin) {
+		mutex_lock(&cma->lock);
+		cma->nr_alloc_slow++;
+		mutex_unlock(&cma->lock);
+	}
+#endif
+out:
+	if (!is_rbin)
+		cma_preclear_kick(cma);
 	trace_cma_alloc(pfn, page, count, align);
 
 	pr_debug("%s(): returned %p\n", __func__, page);
@@ -509,6 +798,7 @@ bool cma_release(struct cma *cma, const struct page *pages, unsigned int count)
 
 	free_contig_range(pfn, count);
 	cma_clear_bitmap(cma, pfn, count);
+	cma_preclear_kick(cma);
 	trace_cma_release(pfn, pages, count);
 
 	return true;
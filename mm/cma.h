@@ -1,6 +1,10 @@
 #ifndef __MM_CMA_H__
 #define __MM_CMA_H__
 
+#include <linux/workqueue.h>
+
+#define CMA_PRECLEAR_HISTORY	8
+
 struct cma {
 #ifdef CONFIG_RBIN
 	bool is_rbin;
@@ -15,6 +19,21 @@ struct cma {
 	struct hlist_head mem_head;
 	spinlock_t mem_head_lock;
 #endif
+#ifdef CONFIG_CMA_PRECLEAR
+	/*
+	 * A clear bit marks a range already isolated and migrated by the
+	 * background worker: it is set in ->bitmap but not handed out yet.
+	 */
+	unsigned long	*preclear_bitmap;
+	unsigned long	nr_precleared;	/* in bits, under ->lock */
+	unsigned long	recent_bits[CMA_PRECLEAR_HISTORY];
+	unsigned int	recent_idx;
+	unsigned long	alloc_seq;
+	struct delayed_work preclear_work;
+	unsigned long	nr_alloc_fast;
+	unsigned long	nr_alloc_slow;
+	unsigned long	nr_preclear_dropped;
+#endif
 };
 
 extern struct cma cma_areas[MAX_CMA_AREAS];
@@ -69,6 +69,20 @@ static int cma_maxchunk_get(void *data, u64 *val)
 }
 DEFINE_SIMPLE_ATTRIBUTE(cma_maxchunk_fops, cma_maxchunk_get, NULL, "%llu\n");
 
+#ifdef CONFIG_CMA_PRECLEAR
+static int cma_precleared_get(void *data, u64 *val)
+{
+	struct cma *cma = data;
+
+	mutex_lock(&cma->lock);
+	*val = (u64)cma->nr_precleared << cma->order_per_bit;
+	mutex_unlock(&cma->lock);
+
+	return 0;
+}
+DEFINE_SIMPLE_ATTRIBUTE(cma_precleared_fops, cma_precleared_get, NULL, "%llu\n");
+#endif
+
 static void cma_add_to_cma_mem_list(struct cma *cma, struct cma_mem *mem)
 {
 	spin_lock(&cma->mem_head_lock);
@@ -189,6 +203,16 @@ static void cma_debugfs_add_one(struct cma *cma, int idx)
 				&cma->order_per_bit, &cma_debugfs_fops);
 	debugfs_create_file("used", S_IRUGO, tmp, cma, &cma_used_fops);
 	debugfs_create_file("maxchunk", S_IRUGO, tmp, cma, &cma_maxchunk_fops);
+#ifdef CONFIG_CMA_PRECLEAR
+	debugfs_create_file("precleared", S_IRUGO, tmp, cma,
+				&cma_precleared_fops);
+	debugfs_create_file("alloc_fast", S_IRUGO, tmp,
+				&cma->nr_alloc_fast, &cma_debugfs_fops);
+	debugfs_create_file("alloc_slow", S_IRUGO, tmp,
+				&cma->nr_alloc_slow, &cma_debugfs_fops);
+	debugfs_create_file("preclear_dropped", S_IRUGO, tmp,
+				&cma->nr_preclear_dropped, &cma_debugfs_fops);
+#endif
 
 	u32s = DIV_ROUND_UP(cma_bitmap_maxno(cma), BITS_PER_BYTE * sizeof(u32));
 	debugfs_create_u32_array("bitmap", S_IRUGO, tmp, (u32*)cma->bitmap, u32s);
@@ -1276,6 +1276,58 @@ static inline bool is_via_compact_memory(int order)
 	return order == -1;
 }
 
+#ifdef CONFIG_COMPACTION_PROACTIVE
+/*
+ * How aggressively kcompactd compacts in the background, [0, 100]; 0
+ * disables proactive compaction. Each round is limited to
+ * sysctl_compaction_proactive_budget_ms of compaction work.
+ */
+unsigned int __read_mostly sysctl_compaction_proactiveness = 20;
+unsigned int __read_mostly sysctl_compaction_proactive_budget_ms = 20;
+
+/* order-4 blocks also serve the order-2 and order-3 driver allocations */
+#define COMPACTION_PROACTIVE_ORDER	(PAGE_ALLOC_COSTLY_ORDER + 1)
+#define PROACTIVE_CHECK_INTERVAL_MSEC	500
+
+/*
+ * Fragmentation of @zone for COMPACTION_PROACTIVE_ORDER, weighted by the
+ * zone's share of the node so the zone scores add up to a node score in
+ * [0, 100].
+ */
+static unsigned int fragmentation_score_zone(struct zone *zone)
+{
+	u64 score;
+
+	score = (u64)zone->present_pages *
+		extfrag_for_order(zone, COMPACTION_PROACTIVE_ORDER);
+	return div64_ul(score, zone->zone_pgdat->node_present_pages + 1);
+}
+
+static unsigned int fragmentation_score_node(pg_data_t *pgdat)
+{
+	unsigned int score = 0;
+	int zoneid;
+
+	for (zoneid = 0; zoneid < MAX_NR_ZONES; zoneid++) {
+		struct zone *zone = &pgdat->node_zones[zoneid];
+
+		if (populated_zone(zone))
+			score += fragmentation_score_zone(zone);
+	}
+
+	return score;
+}
+
+/* compact above the high mark, until below the low mark */
+static unsigned int fragmentation_score_wmark(bool low)
+{
+	unsigned int wmark_low;
+
+	wmark_low = max(100U - sysctl_compaction_proactiveness, 5U);
+	return low ? wmark_low : min(wmark_low + 10, 100U);
+}
+#endif
+
 static enum compact_result __compact_finished(struct zone *zone, struct compact_control *cc,
 			    const int migratetype)
 {
@@ -1305,6 +1357,17 @@ static enum compact_result __compact_finished(struct zone *zone, struct compact_
 			return COMPACT_PARTIAL_SKIPPED;
 	}
 
+#ifdef CONFIG_COMPACTION_PROACTIVE
+	if (cc->proactive_compaction) {
+		if (time_after(jiffies, cc->deadline))
+			return COMPACT_PARTIAL_SKIPPED;
+		if (fragmentation_score_zone(zone) >
+				fragmentation_score_wmark(true))
+			return COMPACT_CONTINUE;
+		return COMPACT_SUCCESS;
+	}
+#endif
+
 	if (is_via_compact_memory(cc->order))
 		return COMPACT_CONTINUE;
 
@@ -1953,6 +2016,88 @@ void wakeup_kcompactd(pg_data_t *pgdat, int order, int classzone_idx)
 	wake_up_interruptible(&pgdat->kcompactd_wait);
 }
 
+#ifdef CONFIG_COMPACTION_PROACTIVE
+static bool should_proactive_compact_node(pg_data_t *pgdat)
+{
+	if (!sysctl_compaction_proactiveness)
+		return false;
+
+	/* reclaim is running, compacting now would just fight it */
+	if (pgdat->kswapd && pgdat->kswapd->state == TASK_RUNNING)
+		return false;
+
+	return fragmentation_score_node(pgdat) > fragmentation_score_wmark(false);
+}
+
+/*
+ * Compact every zone of @pgdat until its score is below the low mark or
+ * the budget is used up. Runs at the lowest priority so only otherwise idle
+ * CPU time goes into it.
+ */
+static void proactive_compact_node(pg_data_t *pgdat)
+{
+	int zoneid;
+	struct zone *zone;
+	struct compact_control cc = {
+		.order = -1,
+		.mode = MIGRATE_SYNC_LIGHT,
+		.ignore_skip_hint = true,
+		.whole_zone = true,
+		.gfp_mask = GFP_KERNEL,
+		.proactive_compaction = true,
+		.deadline = jiffies +
+			msecs_to_jiffies(sysctl_compaction_proactive_budget_ms),
+	};
+
+	set_user_nice(current, MAX_NICE);
+
+	for (zoneid = 0; zoneid < MAX_NR_ZONES; zoneid++) {
+		zone = &pgdat->node_zones[zoneid];
+		if (!populated_zone(zone))
+			continue;
+
+		cc.nr_freepages = 0;
+		cc.nr_migratepages = 0;
+		cc.zone = zone;
+		INIT_LIST_HEAD(&cc.freepages);
+		INIT_LIST_HEAD(&cc.migratepages);
+
+		compact_zone(zone, &cc);
+
+		VM_BUG_ON(!list_empty(&cc.freepages));
+		VM_BUG_ON(!list_empty(&cc.migratepages));
+
+		if (time_after(jiffies, cc.deadline) || kthread_should_stop())
+			break;
+	}
+
+	set_user_nice(current, 0);
+}
+
+/*
+ * Called each time kcompactd's wait times out; backs off for a while when
+ * a round did not lower the node's score.
+ */
+static void kcompactd_proactive(pg_data_t *pgdat, unsigned int *defer)
+{
+	unsigned int prev_score, score;
+
+	if (!should_proactive_compact_node(pgdat))
+		return;
+
+	if (*defer) {
+		(*defer)--;
+		return;
+	}
+
+	prev_score = fragmentation_score_node(pgdat);
+	proactive_compact_node(pgdat);
+	score = fragmentation_score_node(pgdat);
+
+	*defer = score < prev_score ? 0 : 1 << COMPACT_MAX_DEFER_SHIFT;
+}
+#endif
+
 /*
  * The background compaction daemon, started as a kernel thread
  * from the init process.
@@ -1961,6 +2106,9 @@ static int kcompactd(void *p)
 {
 	pg_data_t *pgdat = (pg_data_t*)p;
 	struct task_struct *tsk = current;
+#ifdef CONFIG_COMPACTION_PROACTIVE
+	unsigned int proactive_defer = 0;
+#endif
 
 	const struct cpumask *cpumask = cpumask_of_node(pgdat->node_id);
 
@@ -1976,8 +2124,17 @@ static int kcompactd(void *p)
 		unsigned long pflags;
 
 		trace_mm_compaction_kcompactd_sleep(pgdat->node_id);
+#ifdef CONFIG_COMPACTION_PROACTIVE
+		if (!wait_event_freezable_timeout(pgdat->kcompactd_wait,
+				kcompactd_work_requested(pgdat),
+				msecs_to_jiffies(PROACTIVE_CHECK_INTERVAL_MSEC))) {
+			kcompactd_proactive(pgdat, &proactive_defer);
+			continue;
+		}
+#else
 		wait_event_freezable(pgdat->kcompactd_wait,
 				kcompactd_work_requested(pgdat));
+#endif
 
 		psi_memstall_enter(&pflags);
 		kcompactd_do_work(pgdat);
@@ -0,0 +1,500 @@
+/*
+ * linux/mm/contpte.c
+ *
+ * Background collapse of anonymous memory into contiguous-PTE blocks.
+ *
+ * Large ART heaps and game arenas are mapped with 4K entries, each taking
+ * its own TLB entry. The architecture can cache an aligned block of
+ * CONT_PTES entries (64K with 4K pages) as one entry when they map one
+ * physically contiguous chunk and carry the contiguous hint.
+ *
+ * Regions marked with MADV_CONTPTE are scanned by kcontpted: every aligned
+ * block whose pages are all present, anonymous and not shared is migrated
+ * into a freshly allocated aligned chunk (unless it already is one), and
+ * the block is then folded by the architecture. Any later change to one of
+ * the entries unfolds the block again; the next scan may fold it back.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#define pr_fmt(fmt) "contpte: " fmt
+
+#include <linux/mm.h>
+#include <linux/mman.h>
+#include <linux/sched.h>
+#include <linux/kthread.h>
+#include <linux/freezer.h>
+#include <linux/slab.h>
+#include <linux/ksm.h>
+#include <linux/swap.h>
+#include <linux/migrate.h>
+#include <linux/mm_inline.h>
+#include <linux/kobject.h>
+#include <linux/sysfs.h>
+#include <linux/contpte.h>
+#include <asm/pgtable.h>
+
+#include "internal.h"
+
+struct contpte_mm_slot {
+	struct list_head list;
+	struct mm_struct *mm;
+};
+
+static LIST_HEAD(contpte_mm_list);
+static DEFINE_SPINLOCK(contpte_mm_lock);
+static DECLARE_WAIT_QUEUE_HEAD(contpte_wait);
+
+/* where the next scan continues, only used by kcontpted */
+static struct contpte_mm_slot *contpte_scan_slot;
+static unsigned long contpte_scan_address;
+
+static unsigned int contpte_sleep_millisecs = 10000;
+static unsigned int contpte_pages_to_scan = CONT_PTES * 256;
+
+static unsigned long contpte_nr_folded;
+static unsigned long contpte_nr_collapsed;
+static unsigned long contpte_nr_failed;
+static unsigned long contpte_full_scans;
+
+/* opportunistic: never reclaim or compact for a chunk */
+#define CONTPTE_GFP	((GFP_HIGHUSER_MOVABLE | __GFP_NOWARN | \
+			  __GFP_NORETRY) & ~__GFP_RECLAIM)
+
+int __contpte_enter(struct mm_struct *mm)
+{
+	struct contpte_mm_slot *slot;
+
+	slot = kmalloc(sizeof(*slot), GFP_KERNEL);
+	if (!slot)
+		return -ENOMEM;
+
+	/* __contpte_enter() must not be called twice for the same mm */
+	if (unlikely(test_and_set_bit(MMF_VM_CONTPTE, &mm->flags))) {
+		kfree(slot);
+		return 0;
+	}
+
+	slot->mm = mm;
+	atomic_inc(&mm->mm_count);
+
+	spin_lock(&contpte_mm_lock);
+	list_add_tail(&slot->list, &contpte_mm_list);
+	spin_unlock(&contpte_mm_lock);
+
+	wake_up_interruptible(&contpte_wait);
+	return 0;
+}
+
+int contpte_madvise(struct vm_area_struct *vma,
+		    unsigned long *vm_flags, int advice)
+{
+	switch (advice) {
+	case MADV_CONTPTE:
+		if (!vma_is_anonymous(vma) ||
+		    (*vm_flags & (VM_SHARED | VM_HUGETLB | VM_SPECIAL)))
+			return -EINVAL;
+		*vm_flags |= VM_CONTPTE;
+		if (!test_bit(MMF_VM_CONTPTE, &vma->vm_mm->flags))
+			return __contpte_enter(vma->vm_mm);
+		break;
+	case MADV_NOCONTPTE:
+		/* blocks already folded stay folded until they change */
+		*vm_flags &= ~VM_CONTPTE;
+		break;
+	}
+
+	return 0;
+}
+
+/* called with contpte_mm_lock held */
+static void contpte_free_slot(struct contpte_mm_slot *slot)
+{
+	list_del(&slot->list);
+	clear_bit(MMF_VM_CONTPTE, &slot->mm->flags);
+	mmdrop(slot->mm);
+	kfree(slot);
+}
+
+enum contpte_scan_result {
+	CONTPTE_NONE,		/* block cannot be folded */
+	CONTPTE_FOLD,		/* block is contiguous already */
+	CONTPTE_MIGRATE,	/* pages need to move first */
+};
+
+/*
+ * Check the block of entries at @pte, mapping @addr, and collect its pages
+ * into @pages. Called with the pte lock held.
+ */
+static enum contpte_scan_result contpte_scan_block(struct vm_area_struct *vma,
+		unsigned long addr, pte_t *pte, struct page **pages)
+{
+	bool contig = true;
+	unsigned long pfn = 0;
+	int i;
+
+	for (i = 0; i < CONT_PTES; i++, addr += PAGE_SIZE) {
+		pte_t pteval = pte[i];
+		struct page *page;
+
+		if (!pte_present(pteval) || pte_cont(pteval))
+			return CONTPTE_NONE;
+		page = vm_normal_page(vma, addr, pteval);
+		if (!page || !PageAnon(page) || PageCompound(page) ||
+		    PageKsm(page) || page_mapcount(page) != 1)
+			return CONTPTE_NONE;
+
+		if (!i)
+			pfn = page_to_pfn(page);
+		else if (page_to_pfn(page) != pfn + i)
+			contig = false;
+		pages[i] = page;
+	}
+
+	if (pfn & (CONT_PTES - 1))
+		contig = false;
+
+	return contig ? CONTPTE_FOLD : CONTPTE_MIGRATE;
+}
+
+struct contpte_target {
+	struct page **src;
+	struct page *dst;
+	unsigned long used;	/* bitmap of handed out dst pages */
+};
+
+/* each page moves to the page at its own offset in the new chunk */
+static struct page *contpte_new_page(struct page *page, unsigned long private,
+				     int **result)
+{
+	struct contpte_target *t = (struct contpte_target *)private;
+	int i;
+
+	for (i = 0; i < CONT_PTES; i++) {
+		if (t->src[i] == page) {
+			__set_bit(i, &t->used);
+			return t->dst + i;
+		}
+	}
+
+	return NULL;
+}
+
+/* not used after all, keep it for a retry or for the final free */
+static void contpte_put_new_page(struct page *page, unsigned long private)
+{
+	struct contpte_target *t = (struct contpte_target *)private;
+
+	__clear_bit(page - t->dst, &t->used);
+}
+
+static bool contpte_migrate_block(struct page **pages)
+{
+	struct contpte_target t = { .src = pages };
+	LIST_HEAD(list);
+	int i, err = 0;
+
+	t.dst = alloc_pages(CONTPTE_GFP, CONT_PTE_SHIFT);
+	if (!t.dst)
+		return false;
+	split_page(t.dst, CONT_PTE_SHIFT);
+
+	for (i = 0; i < CONT_PTES; i++) {
+		/* the reference taken under the pte lock */
+		if (!err && !isolate_lru_page(pages[i])) {
+			inc_node_page_state(pages[i], NR_ISOLATED_ANON +
+					    page_is_file_cache(pages[i]));
+			list_add_tail(&pages[i]->lru, &list);
+		} else {
+			err = -EBUSY;
+		}
+		put_page(pages[i]);
+	}
+
+	if (!err)
+		err = migrate_pages(&list, contpte_new_page,
+				    contpte_put_new_page, (unsigned long)&t,
+				    MIGRATE_SYNC_LIGHT, MR_COMPACTION);
+	if (err)
+		putback_movable_pages(&list);
+
+	for (i = 0; i < CONT_PTES; i++)
+		if (!test_bit(i, &t.used))
+			__free_page(t.dst + i);
+
+	return !err;
+}
+
+/*
+ * Try to fold the block at @addr, migrating its pages first if needed.
+ * Called with mmap_sem held for read.
+ */
+static void contpte_collapse_block(struct vm_area_struct *vma,
+				   unsigned long addr)
+{
+	struct mm_struct *mm = vma->vm_mm;
+	struct page *pages[CONT_PTES];
+	enum contpte_scan_result res;
+	spinlock_t *ptl;
+	pmd_t *pmd;
+	pte_t *pte;
+	bool folded = false;
+	int i;
+
+	pmd = mm_find_pmd(mm, addr);
+	if (!pmd)
+		return;
+
+	pte = pte_offset_map_lock(mm, pmd, addr, &ptl);
+	res = contpte_scan_block(vma, addr, pte, pages);
+	if (res == CONTPTE_FOLD)
+		folded = contpte_fold(mm, addr, pte);
+	else if (res == CONTPTE_MIGRATE)
+		for (i = 0; i < CONT_PTES; i++)
+			get_page(pages[i]);
+	pte_unmap_unlock(pte, ptl);
+
+	if (res != CONTPTE_MIGRATE)
+		goto out;
+
+	if (!contpte_migrate_block(pages)) {
+		contpte_nr_failed++;
+		return;
+	}
+
+	pte = pte_offset_map_lock(mm, pmd, addr, &ptl);
+	if (contpte_scan_block(vma, addr, pte, pages) == CONTPTE_FOLD)
+		folded = contpte_fold(mm, addr, pte);
+	pte_unmap_unlock(pte, ptl);
+	if (folded)
+		contpte_nr_collapsed++;
+out:
+	if (folded)
+		contpte_nr_folded++;
+}
+
+/*
+ * Scan up to @budget pages of the current mm. Returns the pages scanned;
+ * contpte_scan_address is left at zero once the mm is done.
+ */
+static unsigned int contpte_scan_mm(struct mm_struct *mm, unsigned int budget)
+{
+	struct vm_area_struct *vma;
+	unsigned long addr = contpte_scan_address;
+	unsigned int scanned = 0;
+
+	if (!mmget_not_zero(mm)) {
+		contpte_scan_address = 0;
+		return 0;
+	}
+
+	down_read(&mm->mmap_sem);
+	for (vma = find_vma(mm, addr); vma; vma = vma->vm_next) {
+		unsigned long end = vma->vm_end & CONT_PTE_MASK;
+
+		if (!(vma->vm_flags & VM_CONTPTE) || !vma->anon_vma)
+			continue;
+
+		addr = max(addr, vma->vm_start);
+		addr = ALIGN(addr, CONT_PTE_SIZE);
+		for (; addr < end; addr += CONT_PTE_SIZE) {
+			if (scanned >= budget || kthread_should_stop())
+				goto out;
+			contpte_collapse_block(vma, addr);
+			scanned += CONT_PTES;
+			cond_resched();
+		}
+	}
+	addr = 0;
+out:
+	up_read(&mm->mmap_sem);
+	mmput(mm);
+
+	contpte_scan_address = addr;
+	return scanned;
+}
+
+static void contpte_do_scan(void)
+{
+	unsigned int budget = READ_ONCE(contpte_pages_to_scan);
+	struct contpte_mm_slot *slot;
+
+	while (budget && !kthread_should_stop()) {
+		unsigned int scanned;
+
+		spin_lock(&contpte_mm_lock);
+		slot = contpte_scan_slot;
+		if (!slot) {
+			if (list_empty(&contpte_mm_list)) {
+				spin_unlock(&contpte_mm_lock);
+				return;
+			}
+			slot = list_first_entry(&contpte_mm_list,
+					struct contpte_mm_slot, list);
+			contpte_scan_slot = slot;
+			contpte_scan_address = 0;
+		}
+		spin_unlock(&contpte_mm_lock);
+
+		scanned = contpte_scan_mm(slot->mm, budget);
+		budget -= min(scanned, budget);
+		if (contpte_scan_address)
+			continue;
+
+		/* done with this mm, move on and drop it if it exited */
+		spin_lock(&contpte_mm_lock);
+		if (list_is_last(&slot->list, &contpte_mm_list)) {
+			contpte_scan_slot = NULL;
+			contpte_full_scans++;
+		} else {
+			contpte_scan_slot = list_next_entry(slot, list);
+		}
+		if (!atomic_read(&slot->mm->mm_users))
+			contpte_free_slot(slot);
+		slot = contpte_scan_slot;
+		spin_unlock(&contpte_mm_lock);
+
+		/* one full pass over the registered mms at most */
+		if (!slot)
+			break;
+	}
+}
+
+static int contpte_thread(void *unused)
+{
+	set_freezable();
+	set_user_nice(current, MAX_NICE);
+
+	while (!kthread_should_stop()) {
+		contpte_do_scan();
+		wait_event_freezable_timeout(contpte_wait,
+			kthread_should_stop(),
+			msecs_to_jiffies(READ_ONCE(contpte_sleep_millisecs)));
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_SYSFS
+#define CONTPTE_ATTR_RO(_name) \
+	static struct kobj_attribute _name##_attr = __ATTR_RO(_name)
+#define CONTPTE_ATTR(_name) \
+	static struct kobj_attribute _name##_attr = \
+		__ATTR(_name, 0644, _name##_show, _name##_store)
+
+static ssize_t scan_sleep_millisecs_show(struct kobject *kobj,
+					 struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", contpte_sleep_millisecs);
+}
+
+static ssize_t scan_sleep_millisecs_store(struct kobject *kobj,
+					  struct kobj_attribute *attr,
+					  const char *buf, size_t count)
+{
+	unsigned long msecs;
+	int err;
+
+	err = kstrtoul(buf, 10, &msecs);
+	if (err || msecs > UINT_MAX)
+		return -EINVAL;
+
+	contpte_sleep_millisecs = msecs;
+	wake_up_interruptible(&contpte_wait);
+
+	return count;
+}
+CONTPTE_ATTR(scan_sleep_millisecs);
+
+static ssize_t pages_to_scan_show(struct kobject *kobj,
+				  struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", contpte_pages_to_scan);
+}
+
+static ssize_t pages_to_scan_store(struct kobject *kobj,
+				   struct kobj_attribute *attr,
+				   const char *buf, size_t count)
+{
+	unsigned long nr_pages;
+	int err;
+
+	err = kstrtoul(buf, 10, &nr_pages);
+	if (err || !nr_pages || nr_pages > UINT_MAX)
+		return -EINVAL;
+
+	contpte_pages_to_scan = nr_pages;
+
+	return count;
+}
+CONTPTE_ATTR(pages_to_scan);
+
+static ssize_t pages_folded_show(struct kobject *kobj,
+				 struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", contpte_nr_folded * CONT_PTES);
+}
+CONTPTE_ATTR_RO(pages_folded);
+
+static ssize_t pages_collapsed_show(struct kobject *kobj,
+				    struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", contpte_nr_collapsed * CONT_PTES);
+}
+CONTPTE_ATTR_RO(pages_collapsed);
+
+static ssize_t collapse_failed_show(struct kobject *kobj,
+				    struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", contpte_nr_failed);
+}
+CONTPTE_ATTR_RO(collapse_failed);
+
+static ssize_t full_scans_show(struct kobject *kobj,
+			       struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", contpte_full_scans);
+}
+CONTPTE_ATTR_RO(full_scans);
+
+static struct attribute *contpte_attrs[] = {
+	&scan_sleep_millisecs_attr.attr,
+	&pages_to_scan_attr.attr,
+	&pages_folded_attr.attr,
+	&pages_collapsed_attr.attr,
+	&collapse_failed_attr.attr,
+	&full_scans_attr.attr,
+	NULL,
+};
+
+static struct attribute_group contpte_attr_group = {
+	.attrs = contpte_attrs,
+	.name = "contpte",
+};
+#endif /* CONFIG_SYSFS */
+
+static int __init contpte_init(void)
+{
+	struct task_struct *thread;
+	int err = 0;
+
+	thread = kthread_run(contpte_thread, NULL, "kcontpted");
+	if (IS_ERR(thread)) {
+		pr_err("creating kthread failed\n");
+		return PTR_ERR(thread);
+	}
+
+#ifdef CONFIG_SYSFS
+	err = sysfs_create_group(mm_kobj, &contpte_attr_group);
+	if (err) {
+		pr_err("register sysfs failed\n");
+		kthread_stop(thread);
+	}
+#endif
+
+	return err;
+}
+subsys_initcall(contpte_init);
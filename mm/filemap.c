@@ -2250,10 +2250,7 @@ static struct file *do_sync_mmap_readahead(struct vm_area_struct *vma,
 	else
 		ra_pages = ra->ra_pages;
 #endif
-	ra->start = max_t(long, 0, offset - ra_pages / 2);
-	ra->size = ra_pages;
-	ra->async_size = ra_pages / 4;
-	ra_submit(ra, mapping, file);
+	ra_pattern_readaround(file, ra, offset, ra_pages);
 	return fpin;
 }
 
@@ -2326,6 +2323,9 @@ int filemap_fault(struct vm_area_struct *vma, struct vm_fault *vmf)
 	if (offset >= size >> PAGE_SHIFT)
 		return VM_FAULT_SIGBUS;
 
+	if (!(vmf->flags & FAULT_FLAG_TRIED))
+		ra_pattern_update(file, offset);
+
 	/*
 	 * Do we have something in the page cache already?
 	 */
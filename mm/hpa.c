@@ -27,6 +27,7 @@
 #include <linux/vmalloc.h>
 #include <linux/device.h>
 #include <linux/oom.h>
+#include <linux/workqueue.h>
 
 #include "internal.h"
 
@@ -116,8 +117,12 @@ static int hpa_killer(void)
 				selected_oom_score_adj,
 				selected_tasksize * (long)(PAGE_SIZE / 1024));
 		hpa_deathpending_timeout = jiffies + HZ;
+		task_lock(selected);
 		task_set_lmk_waiting(selected);
 		send_sig(SIGKILL, selected, 0);
+		if (selected->mm)
+			memkill_track(selected->mm, selected_tasksize);
+		task_unlock(selected);
 		rem += selected_tasksize;
 	} else {
 		pr_info("HPA: no killable task\n");
@@ -225,7 +230,8 @@ static void prep_highorder_pages(unsigned long base_pfn, int order)
 		set_page_count(pfn_to_page(pfn), 0);
 }
 
-int alloc_pages_highorder(int order, struct page **pages, int nents)
+static int __alloc_pages_highorder(int order, struct page **pages, int nents,
+				   bool reclaim)
 {
 	struct zone *zone;
 	unsigned int nr_pages = 1 << order;
@@ -307,14 +313,18 @@ int alloc_pages_highorder(int order, struct page **pages, int nents)
 	if (remained) {
 		int i;
 
-		drop_slab();
-		count_vm_event(DROP_SLAB);
-		ret = hpa_killer();
-		if (ret == 0) {
-			total_scanned = 0;
-			pr_info("HPA: drop_slab and killer retry %d count\n",
-				retry_count++);
-			goto retry;
+		if (reclaim) {
+			drop_slab();
+			count_vm_event(DROP_SLAB);
+			ret = hpa_killer();
+			if (ret == 0) {
+				/* let the victim free its memory before rescanning */
+				memkill_wait(HZ);
+				total_scanned = 0;
+				pr_info("HPA: drop_slab and killer retry %d count\n",
+					retry_count++);
+				goto retry;
+			}
 		}
 
 		for (i = 0; i < (nents - remained); i++)
@@ -339,6 +349,188 @@ int free_pages_highorder(int order, struct page **pages, int nents)
 	return 0;
 }
 
+/*
+ * Reservation of high-order pages ahead of allocation.
+ *
+ * Users like the camera HAL know the amount of memory they are about to
+ * allocate well before the allocation. hpa_reserve_highorder() lets them
+ * announce it so that the free page scan and the migration run in the
+ * background. The collected chunks are linked through page->lru of the head
+ * page and handed over by alloc_pages_highorder() without scanning. Chunks
+ * not claimed before the timeout are returned to the buddy allocator.
+ *
+ * The background work never drops slab or kills processes: it is only a
+ * prediction and the real allocation still does so if it has to.
+ */
+#define HPA_RESERVE_BATCH		16
+#define HPA_RESERVE_DEFAULT_TIMEOUT	1000	/* msec */
+
+static DEFINE_SPINLOCK(hpa_reserve_lock);
+static LIST_HEAD(hpa_reserve_list);
+static int hpa_reserve_order;
+static int hpa_reserve_count;
+static int hpa_reserve_target;
+
+/* move the reserved chunks beyond @keep to @drop. hpa_reserve_lock held */
+static void hpa_reserve_trim(int keep, struct list_head *drop)
+{
+	struct page *page;
+
+	while (hpa_reserve_count > keep) {
+		page = list_last_entry(&hpa_reserve_list, struct page, lru);
+		list_move(&page->lru, drop);
+		hpa_reserve_count--;
+	}
+}
+
+static void hpa_reserve_release(struct list_head *drop, int order)
+{
+	struct page *page, *tmp;
+
+	list_for_each_entry_safe(page, tmp, drop, lru) {
+		list_del(&page->lru);
+		__free_pages(page, order);
+	}
+}
+
+static void hpa_reserve_work_fn(struct work_struct *work)
+{
+	struct page *pages[HPA_RESERVE_BATCH];
+	int order, nents, i;
+
+	for (;;) {
+		spin_lock(&hpa_reserve_lock);
+		order = hpa_reserve_order;
+		nents = min(hpa_reserve_target - hpa_reserve_count,
+			    HPA_RESERVE_BATCH);
+		spin_unlock(&hpa_reserve_lock);
+
+		if (nents <= 0)
+			break;
+
+		if (__alloc_pages_highorder(order, pages, nents, false))
+			break;
+
+		spin_lock(&hpa_reserve_lock);
+		/* the reservation may have been changed in the meantime */
+		if (order == hpa_reserve_order &&
+		    hpa_reserve_count + nents <= hpa_reserve_target) {
+			for (i = 0; i < nents; i++)
+				list_add_tail(&pages[i]->lru,
+					      &hpa_reserve_list);
+			hpa_reserve_count += nents;
+			nents = 0;
+		}
+		spin_unlock(&hpa_reserve_lock);
+
+		if (nents) {
+			free_pages_highorder(order, pages, nents);
+			break;
+		}
+	}
+}
+static DECLARE_WORK(hpa_reserve_work, hpa_reserve_work_fn);
+
+static void hpa_reserve_expire_fn(struct work_struct *work)
+{
+	LIST_HEAD(drop);
+	int order;
+
+	spin_lock(&hpa_reserve_lock);
+	order = hpa_reserve_order;
+	hpa_reserve_target = 0;
+	hpa_reserve_trim(0, &drop);
+	spin_unlock(&hpa_reserve_lock);
+
+	hpa_reserve_release(&drop, order);
+}
+static DECLARE_DELAYED_WORK(hpa_reserve_expire_work, hpa_reserve_expire_fn);
+
+/* hand over up to @nents reserved chunks of @order to @pages */
+static int hpa_reserve_take(int order, struct page **pages, int nents)
+{
+	struct page *page;
+	int taken = 0;
+
+	spin_lock(&hpa_reserve_lock);
+	if (order == hpa_reserve_order) {
+		while (taken < nents && hpa_reserve_count > 0) {
+			page = list_first_entry(&hpa_reserve_list,
+						struct page, lru);
+			list_del(&page->lru);
+			pages[taken++] = page;
+			hpa_reserve_count--;
+		}
+		/* the announced amount is consumed by this allocation */
+		hpa_reserve_target = max(hpa_reserve_target - nents, 0);
+	}
+	spin_unlock(&hpa_reserve_lock);
+
+	return taken;
+}
+
+/**
+ * hpa_reserve_highorder - prepare high-order pages for a later allocation
+ * @order:	order of the chunks to reserve
+ * @nents:	number of chunks expected to be allocated; 0 cancels
+ * @timeout_ms:	time to hold the reserved chunks; 0 selects the default
+ *
+ * Returns immediately after scheduling the reservation. A new call replaces
+ * the previous reservation and restarts its timeout.
+ */
+int hpa_reserve_highorder(int order, int nents, unsigned int timeout_ms)
+{
+	LIST_HEAD(drop);
+	int drop_order;
+
+	if (order < 0 || order >= MAX_ORDER || nents < 0)
+		return -EINVAL;
+
+	/* do not allow reserving more than a half of the scanned range */
+	if (nents > ((end_pfn - start_pfn) >> (order + 1)))
+		return -EINVAL;
+
+	if (!timeout_ms)
+		timeout_ms = HPA_RESERVE_DEFAULT_TIMEOUT;
+
+	spin_lock(&hpa_reserve_lock);
+	drop_order = hpa_reserve_order;
+	hpa_reserve_trim(order == hpa_reserve_order ? nents : 0, &drop);
+	hpa_reserve_order = order;
+	hpa_reserve_target = nents;
+	spin_unlock(&hpa_reserve_lock);
+
+	hpa_reserve_release(&drop, drop_order);
+
+	if (!nents) {
+		cancel_delayed_work(&hpa_reserve_expire_work);
+		return 0;
+	}
+
+	mod_delayed_work(system_wq, &hpa_reserve_expire_work,
+			 msecs_to_jiffies(timeout_ms));
+	queue_work(system_unbound_wq, &hpa_reserve_work);
+
+	return 0;
+}
+
+int alloc_pages_highorder(int order, struct page **pages, int nents)
+{
+	int taken;
+	int ret;
+
+	taken = hpa_reserve_take(order, pages, nents);
+	if (taken == nents)
+		return 0;
+
+	ret = __alloc_pages_highorder(order, pages + taken, nents - taken,
+				      true);
+	if (ret)
+		free_pages_highorder(order, pages, taken);
+
+	return ret;
+}
+
 static int __init init_highorder_pages_allocator(void)
 {
 	struct zone *zone;
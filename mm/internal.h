@@ -62,6 +62,35 @@ static inline unsigned long ra_submit(struct file_ra_state *ra,
 					ra->start, ra->size, ra->async_size);
 }
 
+#ifdef CONFIG_READAHEAD_PATTERN
+extern void ra_pattern_update(struct file *file, pgoff_t index);
+extern unsigned long ra_pattern_readaround(struct file *file,
+		struct file_ra_state *ra, pgoff_t offset,
+		unsigned long ra_pages);
+extern unsigned long ra_pattern_fault_around(struct file *file,
+		unsigned long nr_pages);
+#else
+static inline void ra_pattern_update(struct file *file, pgoff_t index)
+{
+}
+
+static inline unsigned long ra_pattern_readaround(struct file *file,
+		struct file_ra_state *ra, pgoff_t offset,
+		unsigned long ra_pages)
+{
+	ra->start = max_t(long, 0, offset - ra_pages / 2);
+	ra->size = ra_pages;
+	ra->async_size = ra_pages / 4;
+	return ra_submit(ra, file->f_mapping, file);
+}
+
+static inline unsigned long ra_pattern_fault_around(struct file *file,
+		unsigned long nr_pages)
+{
+	return nr_pages;
+}
+#endif
+
 /*
  * Turn a non-refcounted page (->_refcount == 0) into refcounted with
  * a count of one.
@@ -189,6 +218,10 @@ struct compact_control {
 	bool ignore_block_suitable;	/* Scan blocks considered unsuitable */
 	bool direct_compaction;		/* False from kcompactd or /proc/... */
 	bool whole_zone;		/* Whole zone should/has been scanned */
+#ifdef CONFIG_COMPACTION_PROACTIVE
+	bool proactive_compaction;	/* kcompactd proactive compaction */
+	unsigned long deadline;		/* proactive: jiffies to stop at */
+#endif
 	int order;			/* order a direct compactor needs */
 	const gfp_t gfp_mask;		/* gfp mask of a direct compactor */
 	const unsigned int alloc_flags;	/* alloc flags of a direct compactor */
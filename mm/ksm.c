@@ -98,12 +98,16 @@
  * @mm_list: link into the mm_slots list, rooted in ksm_mm_head
  * @rmap_list: head for this mm_slot's singly-linked list of rmap_items
  * @mm: the mm that this information is valid for
+ * @targeted: the mm belongs to a target process or one of its children
+ * @skipped: a targeted scan skipped the mm and took it off the unstable tree
  */
 struct mm_slot {
 	struct hlist_node link;
 	struct list_head mm_list;
 	struct rmap_item *rmap_list;
 	struct mm_struct *mm;
+	bool targeted;
+	bool skipped;
 };
 
 /**
@@ -232,6 +236,16 @@ static int ksm_nr_node_ids = 1;
 #define ksm_nr_node_ids		1
 #endif
 
+/*
+ * Targeted scanning: only scan mms of the registered target processes
+ * (the zygotes) and of their children, skip pages that are still shared
+ * with the parent since fork, as there is nothing to gain from merging
+ * them, and only scan when ksmd has its CPU to itself.
+ */
+#define KSM_MAX_TARGETS	4
+static unsigned int ksm_targeted;
+static pid_t ksm_target_tgids[KSM_MAX_TARGETS];
+
 #define KSM_RUN_STOP	0
 #define KSM_RUN_MERGE	1
 #define KSM_RUN_UNMERGE	2
@@ -355,6 +369,36 @@ static inline bool ksm_test_exit(struct mm_struct *mm)
 	return atomic_read(&mm->mm_users) == 0;
 }
 
+static bool ksm_is_target(pid_t tgid)
+{
+	int i;
+
+	for (i = 0; i < KSM_MAX_TARGETS; i++)
+		if (tgid && READ_ONCE(ksm_target_tgids[i]) == tgid)
+			return true;
+
+	return false;
+}
+
+/*
+ * An mm entering ksm is targeted if the task entering it, or that task's
+ * parent, is a target: MADV_MERGEABLE from a target or a child of one,
+ * or fork from a target or a child of one (current is the parent then).
+ */
+static bool ksm_current_targeted(void)
+{
+	bool targeted;
+
+	if (ksm_is_target(current->tgid))
+		return true;
+
+	rcu_read_lock();
+	targeted = ksm_is_target(rcu_dereference(current->real_parent)->tgid);
+	rcu_read_unlock();
+
+	return targeted;
+}
+
 /*
  * We use break_ksm to break COW on a ksm page: it's a stripped down
  *
@@ -663,6 +707,27 @@ static void remove_trailing_rmap_items(struct mm_slot *mm_slot,
 	}
 }
 
+/*
+ * A skipped mm is not rescanned before the unstable tree is reset, so the
+ * age of its unstable rmap_items would overrun: take them off it now.
+ */
+static void ksm_skip_mm_slot(struct mm_slot *slot)
+{
+	struct rmap_item *rmap_item;
+
+	if (slot->skipped)
+		return;
+
+	down_read(&slot->mm->mmap_sem);
+	for (rmap_item = slot->rmap_list; rmap_item;
+	     rmap_item = rmap_item->rmap_list)
+		if (rmap_item->address & UNSTABLE_FLAG)
+			remove_rmap_item_from_tree(rmap_item);
+	up_read(&slot->mm->mmap_sem);
+
+	slot->skipped = true;
+}
+
 /*
  * Though it's very tempting to unmerge rmap_items from stable tree rather
  * than check every pte of a given vma, the locking doesn't quite work for
@@ -1618,6 +1683,25 @@ static struct rmap_item *scan_get_next_rmap_item(struct page **page)
 	}
 
 	mm = slot->mm;
+
+	/* exiting mms are left to the cleanup below */
+	if (ksm_targeted && !slot->targeted && !ksm_test_exit(mm)) {
+		ksm_skip_mm_slot(slot);
+
+		spin_lock(&ksm_mmlist_lock);
+		ksm_scan.mm_slot = list_entry(slot->mm_list.next,
+						struct mm_slot, mm_list);
+		spin_unlock(&ksm_mmlist_lock);
+
+		slot = ksm_scan.mm_slot;
+		if (slot != &ksm_mm_head)
+			goto next_mm;
+
+		ksm_scan.seqnr++;
+		return NULL;
+	}
+	slot->skipped = false;
+
 	down_read(&mm->mmap_sem);
 	if (ksm_test_exit(mm))
 		vma = NULL;
@@ -1641,6 +1725,14 @@ static struct rmap_item *scan_get_next_rmap_item(struct page **page)
 				cond_resched();
 				continue;
 			}
+			/* not written since fork, already shared */
+			if (ksm_targeted && PageAnon(*page) &&
+			    !PageKsm(*page) && page_mapcount(*page) > 1) {
+				put_page(*page);
+				ksm_scan.address += PAGE_SIZE;
+				cond_resched();
+				continue;
+			}
 			if (PageAnon(*page)) {
 				flush_anon_page(vma, *page, ksm_scan.address);
 				flush_dcache_page(*page);
@@ -1737,6 +1829,12 @@ static int ksmd_should_run(void)
 	return (ksm_run & KSM_RUN_MERGE) && !list_empty(&ksm_mm_head.mm_list);
 }
 
+/* a targeted scan only uses CPU time nothing else wants */
+static bool ksmd_may_scan(void)
+{
+	return !ksm_targeted || single_task_running();
+}
+
 static int ksm_scan_thread(void *nothing)
 {
 	set_freezable();
@@ -1745,7 +1843,7 @@ static int ksm_scan_thread(void *nothing)
 	while (!kthread_should_stop()) {
 		mutex_lock(&ksm_thread_mutex);
 		wait_while_offlining();
-		if (ksmd_should_run())
+		if (ksmd_should_run() && ksmd_may_scan())
 			ksm_do_scan(ksm_thread_pages_to_scan);
 		mutex_unlock(&ksm_thread_mutex);
 
@@ -1821,6 +1919,8 @@ int __ksm_enter(struct mm_struct *mm)
 	/* Check ksm_run too?  Would need tighter locking */
 	needs_wakeup = list_empty(&ksm_mm_head.mm_list);
 
+	mm_slot->targeted = ksm_current_targeted();
+
 	spin_lock(&ksm_mmlist_lock);
 	insert_to_mm_slots_hash(mm, mm_slot);
 	/*
@@ -2260,6 +2360,74 @@ static ssize_t merge_across_nodes_store(struct kobject *kobj,
 KSM_ATTR(merge_across_nodes);
 #endif
 
+static ssize_t targeted_show(struct kobject *kobj,
+			     struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_targeted);
+}
+
+static ssize_t targeted_store(struct kobject *kobj,
+			      struct kobj_attribute *attr,
+			      const char *buf, size_t count)
+{
+	unsigned long targeted;
+	int err;
+
+	err = kstrtoul(buf, 10, &targeted);
+	if (err || targeted > 1)
+		return -EINVAL;
+
+	mutex_lock(&ksm_thread_mutex);
+	ksm_targeted = targeted;
+	mutex_unlock(&ksm_thread_mutex);
+
+	return count;
+}
+KSM_ATTR(targeted);
+
+static ssize_t target_tgids_show(struct kobject *kobj,
+				 struct kobj_attribute *attr, char *buf)
+{
+	ssize_t len = 0;
+	int i;
+
+	for (i = 0; i < KSM_MAX_TARGETS; i++)
+		if (ksm_target_tgids[i])
+			len += sprintf(buf + len, "%d ", ksm_target_tgids[i]);
+	if (len)
+		buf[len - 1] = '\n';
+
+	return len;
+}
+
+/*
+ * Takes up to KSM_MAX_TARGETS tgids, replacing the previous ones. Only mms
+ * entering ksm afterwards are matched against them.
+ */
+static ssize_t target_tgids_store(struct kobject *kobj,
+				  struct kobj_attribute *attr,
+				  const char *buf, size_t count)
+{
+	pid_t tgids[KSM_MAX_TARGETS] = { 0 };
+	int n, i;
+
+	n = sscanf(buf, "%d %d %d %d", &tgids[0], &tgids[1], &tgids[2],
+		   &tgids[3]);
+	if (n < 0)
+		n = 0;
+	for (i = 0; i < n; i++)
+		if (tgids[i] <= 0)
+			return -EINVAL;
+
+	mutex_lock(&ksm_thread_mutex);
+	for (i = 0; i < KSM_MAX_TARGETS; i++)
+		WRITE_ONCE(ksm_target_tgids[i], tgids[i]);
+	mutex_unlock(&ksm_thread_mutex);
+
+	return count;
+}
+KSM_ATTR(target_tgids);
+
 static ssize_t pages_shared_show(struct kobject *kobj,
 				 struct kobj_attribute *attr, char *buf)
 {
@@ -2314,6 +2482,8 @@ static struct attribute *ksm_attrs[] = {
 	&pages_unshared_attr.attr,
 	&pages_volatile_attr.attr,
 	&full_scans_attr.attr,
+	&targeted_attr.attr,
+	&target_tgids_attr.attr,
 #ifdef CONFIG_NUMA
 	&merge_across_nodes_attr.attr,
 #endif
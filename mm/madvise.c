@@ -14,6 +14,7 @@
 #include <linux/falloc.h>
 #include <linux/sched.h>
 #include <linux/ksm.h>
+#include <linux/contpte.h>
 #include <linux/fs.h>
 #include <linux/file.h>
 #include <linux/blkdev.h>
@@ -99,6 +100,12 @@ static long madvise_behavior(struct vm_area_struct *vma,
 		if (error)
 			goto out;
 		break;
+	case MADV_CONTPTE:
+	case MADV_NOCONTPTE:
+		error = contpte_madvise(vma, &new_flags, behavior);
+		if (error)
+			goto out;
+		break;
 	}
 
 	if (new_flags == vma->vm_flags) {
@@ -614,6 +621,10 @@ madvise_behavior_valid(int behavior)
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
 	case MADV_HUGEPAGE:
 	case MADV_NOHUGEPAGE:
+#endif
+#ifdef CONFIG_ANON_CONTPTE
+	case MADV_CONTPTE:
+	case MADV_NOCONTPTE:
 #endif
 	case MADV_DONTDUMP:
 	case MADV_DODUMP:
@@ -0,0 +1,150 @@
+/*
+ * linux/mm/memkill.c
+ *
+ * Tracking of memory that kernel-side killers (lowmemorykiller, HPA) are
+ * waiting to get back.
+ *
+ * A SIGKILL only frees memory once the victim has left its mm and
+ * exit_mmap() has run, which can take a while for a large or blocked
+ * victim. Killers that keep reclaiming in that window see the same
+ * shortage and kill again. Each kill records the victim's mm and the pages
+ * it is expected to free here; the entry is completed from __mmput() right
+ * after exit_mmap(), or expires after MEMKILL_TIMEOUT if the victim is
+ * stuck, so callers can account for or wait on what is still in flight.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#include <linux/mm.h>
+#include <linux/sched.h>
+#include <linux/spinlock.h>
+#include <linux/wait.h>
+#include <linux/oom.h>
+
+#define MEMKILL_MAX_INFLIGHT	8
+#define MEMKILL_TIMEOUT		HZ
+
+struct memkill_entry {
+	struct mm_struct *mm;
+	unsigned long pages;
+	unsigned long deadline;
+};
+
+static struct memkill_entry memkill_inflight[MEMKILL_MAX_INFLIGHT];
+static atomic_t memkill_nr = ATOMIC_INIT(0);
+static DEFINE_SPINLOCK(memkill_lock);
+static DECLARE_WAIT_QUEUE_HEAD(memkill_wait_queue);
+
+/* called with memkill_lock held */
+static void __memkill_clear(struct memkill_entry *e)
+{
+	/* never the last reference while the entry is live, see memkill_track */
+	mmdrop(e->mm);
+	e->mm = NULL;
+	e->pages = 0;
+	atomic_dec(&memkill_nr);
+}
+
+/*
+ * Record that @pages are expected back once @mm, the mm of a task that was
+ * just sent SIGKILL, is torn down. The caller holds task_lock of a task
+ * using @mm, so it cannot go away under us.
+ */
+void memkill_track(struct mm_struct *mm, unsigned long pages)
+{
+	struct memkill_entry *e, *victim = NULL;
+	int i;
+
+	spin_lock(&memkill_lock);
+	for (i = 0; i < MEMKILL_MAX_INFLIGHT; i++) {
+		e = &memkill_inflight[i];
+		if (e->mm == mm) {
+			/* killed twice, keep the latest estimate */
+			e->pages = pages;
+			e->deadline = jiffies + MEMKILL_TIMEOUT;
+			goto out;
+		}
+		/* prefer a free slot, else the oldest kill */
+		if (!victim || (victim->mm && (!e->mm ||
+				time_before(e->deadline, victim->deadline))))
+			victim = e;
+	}
+
+	/* full: forget the oldest kill */
+	if (victim->mm)
+		__memkill_clear(victim);
+
+	atomic_inc(&mm->mm_count);
+	victim->mm = mm;
+	victim->pages = pages;
+	victim->deadline = jiffies + MEMKILL_TIMEOUT;
+	atomic_inc(&memkill_nr);
+out:
+	spin_unlock(&memkill_lock);
+}
+
+/* called from __mmput() once the address space is gone */
+void memkill_mm_released(struct mm_struct *mm)
+{
+	bool found = false;
+	int i;
+
+	if (likely(!atomic_read(&memkill_nr)))
+		return;
+
+	spin_lock(&memkill_lock);
+	for (i = 0; i < MEMKILL_MAX_INFLIGHT; i++) {
+		if (memkill_inflight[i].mm == mm) {
+			__memkill_clear(&memkill_inflight[i]);
+			found = true;
+			break;
+		}
+	}
+	spin_unlock(&memkill_lock);
+
+	if (found)
+		wake_up_all(&memkill_wait_queue);
+}
+
+/*
+ * Pages killed tasks are still expected to free. Entries whose victim did
+ * not exit within MEMKILL_TIMEOUT are dropped, so a stuck victim does not
+ * block further kills forever.
+ */
+unsigned long memkill_pending_pages(void)
+{
+	unsigned long pages = 0;
+	int i;
+
+	if (likely(!atomic_read(&memkill_nr)))
+		return 0;
+
+	spin_lock(&memkill_lock);
+	for (i = 0; i < MEMKILL_MAX_INFLIGHT; i++) {
+		struct memkill_entry *e = &memkill_inflight[i];
+
+		if (!e->mm)
+			continue;
+		if (time_after(jiffies, e->deadline)) {
+			__memkill_clear(e);
+			continue;
+		}
+		pages += e->pages;
+	}
+	spin_unlock(&memkill_lock);
+
+	return pages;
+}
+
+/*
+ * Sleep until every tracked kill has freed its memory, or @timeout
+ * jiffies passed. Returns false on timeout.
+ */
+bool memkill_wait(long timeout)
+{
+	return wait_event_timeout(memkill_wait_queue,
+				  !memkill_pending_pages(), timeout) > 0;
+}
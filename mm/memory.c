@@ -119,6 +119,13 @@ static int __init disable_randmaps(char *s)
 }
 __setup("norandmaps", disable_randmaps);
 
+/*
+ * Fork leaves the page cache ptes of private file mappings at least this
+ * large to be faulted in by the child, copying only their anonymous ptes.
+ * 0 copies everything.
+ */
+int sysctl_fork_lazy_file_kb __read_mostly = 2048;
+
 unsigned long zero_pfn __read_mostly;
 unsigned long highest_memmap_pfn __read_mostly;
 
@@ -912,6 +919,23 @@ copy_one_pte(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 	return 0;
 }
 
+/*
+ * A private file mapping maps page cache pages read-only until they are
+ * written, and a fault in the child finds the same pages again, so only
+ * its anonymous (already written) pages need their ptes copied. Zygote
+ * forks carry large ones of those (boot image, oat files, libraries),
+ * most of which a new app never touches.
+ */
+static inline bool copy_skips_file_ptes(struct vm_area_struct *vma)
+{
+	int lazy_kb = READ_ONCE(sysctl_fork_lazy_file_kb);
+
+	return lazy_kb && vma->vm_file &&
+	       !(vma->vm_flags & (VM_SHARED | VM_HUGETLB | VM_PFNMAP |
+				  VM_MIXEDMAP)) &&
+	       vma->vm_end - vma->vm_start >= (unsigned long)lazy_kb << 10;
+}
+
 static int copy_pte_range(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 		   pmd_t *dst_pmd, pmd_t *src_pmd, struct vm_area_struct *vma,
 		   unsigned long addr, unsigned long end)
@@ -922,6 +946,8 @@ static int copy_pte_range(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 	int progress = 0;
 	int rss[NR_MM_COUNTERS];
 	swp_entry_t entry = (swp_entry_t){0};
+	bool skip_file = copy_skips_file_ptes(vma);
+	struct page *page;
 
 again:
 	init_rss_vec(rss);
@@ -951,6 +977,13 @@ static int copy_pte_range(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 			progress++;
 			continue;
 		}
+		if (skip_file && pte_present(*src_pte)) {
+			page = vm_normal_page(vma, addr, *src_pte);
+			if (page && !PageAnon(page)) {
+				progress++;
+				continue;
+			}
+		}
 		entry.val = copy_one_pte(dst_mm, src_mm, dst_pte, src_pte,
 							vma, addr, rss);
 		if (entry.val)
@@ -2659,6 +2692,9 @@ int do_swap_page(struct fault_env *fe, pte_t orig_pte)
 		mem_cgroup_commit_charge(page, memcg, false, false);
 		lru_cache_add_active_or_unevictable(page, vma);
 	}
+	/* read back from swap: reclaim picked the wrong page */
+	if (ret & VM_FAULT_MAJOR)
+		lru_note_refault_page(page);
 
 	swap_free(entry);
 	if (mem_cgroup_swap_full(page) ||
@@ -3131,6 +3167,9 @@ static int do_fault_around(struct fault_env *fe, pgoff_t start_pgoff)
 	int off, ret = 0;
 
 	nr_pages = READ_ONCE(fault_around_bytes) >> PAGE_SHIFT;
+	nr_pages = ra_pattern_fault_around(fe->vma->vm_file, nr_pages);
+	if (nr_pages <= 1)
+		return 0;
 	mask = ~(nr_pages * PAGE_SIZE - 1) & PAGE_MASK;
 
 	fe->address = max(address & mask, fe->vma->vm_start);
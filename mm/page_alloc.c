@@ -1377,6 +1377,77 @@ static void free_pcppages_bulk(struct zone *zone, int count,
 	spin_unlock(&zone->lock);
 }
 
+#ifdef CONFIG_PCP_HIGH_ORDER
+static inline struct list_head *pcp_high_list(struct per_cpu_pages *pcp,
+					unsigned int order, int migratetype)
+{
+	return &pcp->high_lists[order - 1][migratetype];
+}
+
+/*
+ * Give high-order pcp blocks back to the buddy allocator, lowest order
+ * first, until at most @keep pages are left. Called with interrupts off.
+ */
+static void free_pcp_high_bulk(struct zone *zone, struct per_cpu_pages *pcp,
+				int keep)
+{
+	bool isolated_pageblocks;
+	unsigned int order;
+	int mt;
+
+	spin_lock(&zone->lock);
+	isolated_pageblocks = has_isolate_pageblock(zone);
+
+	for (order = 1; order <= PAGE_ALLOC_COSTLY_ORDER; order++) {
+		for (mt = 0; mt < MIGRATE_PCPTYPES; mt++) {
+			struct list_head *list = pcp_high_list(pcp, order, mt);
+
+			while (pcp->high_count > keep && !list_empty(list)) {
+				struct page *page;
+				int pmt;
+
+				page = list_last_entry(list, struct page, lru);
+				list_del(&page->lru);
+				pcp->high_count -= 1 << order;
+
+				pmt = get_pcppage_migratetype(page);
+				if (unlikely(isolated_pageblocks))
+					pmt = get_pageblock_migratetype(page);
+
+				__free_one_page(page, page_to_pfn(page), zone,
+						order, pmt);
+				trace_mm_page_pcpu_drain(page, order, pmt);
+			}
+		}
+	}
+	spin_unlock(&zone->lock);
+}
+
+/* Free a prepared order-1..3 block to this CPU's list. Interrupts are off. */
+static void free_pcp_high_order(struct zone *zone, struct page *page,
+				unsigned int order, int migratetype)
+{
+	struct per_cpu_pages *pcp = &this_cpu_ptr(zone->pageset)->pcp;
+
+	set_pcppage_migratetype(page, migratetype);
+	list_add(&page->lru, pcp_high_list(pcp, order, migratetype));
+	pcp->high_count += 1 << order;
+
+	/* the lists are meant to absorb bursts, not to hold memory */
+	if (pcp->high_count > pcp->batch << 1)
+		free_pcp_high_bulk(zone, pcp, pcp->batch);
+}
+#endif
+
+static inline bool pcp_populated(struct per_cpu_pages *pcp)
+{
+#ifdef CONFIG_PCP_HIGH_ORDER
+	if (pcp->high_count)
+		return true;
+#endif
+	return pcp->count;
+}
+
 static void free_one_page(struct zone *zone,
 				struct page *page, unsigned long pfn,
 				unsigned int order,
@@ -1481,6 +1552,15 @@ static void __free_pages_ok(struct page *page, unsigned int order)
 	migratetype = get_pfnblock_migratetype(page, pfn);
 	local_irq_save(flags);
 	__count_vm_events(PGFREE, 1 << order);
+#ifdef CONFIG_PCP_HIGH_ORDER
+	/* CMA, RBIN, highatomic and isolated blocks go straight back */
+	if (order && order <= PAGE_ALLOC_COSTLY_ORDER &&
+				migratetype < MIGRATE_PCPTYPES) {
+		free_pcp_high_order(page_zone(page), page, order, migratetype);
+		local_irq_restore(flags);
+		return;
+	}
+#endif
 	free_one_page(page_zone(page), page, pfn, order, migratetype);
 	local_irq_restore(flags);
 }
@@ -2558,6 +2638,10 @@ static void drain_pages_zone(unsigned int cpu, struct zone *zone)
 		free_pcppages_bulk(zone, pcp->count, pcp);
 		pcp->count = 0;
 	}
+#ifdef CONFIG_PCP_HIGH_ORDER
+	if (pcp->high_count)
+		free_pcp_high_bulk(zone, pcp, 0);
+#endif
 	local_irq_restore(flags);
 }
 
@@ -2628,12 +2712,12 @@ void drain_all_pages(struct zone *zone)
 
 		if (zone) {
 			pcp = per_cpu_ptr(zone->pageset, cpu);
-			if (pcp->pcp.count)
+			if (pcp_populated(&pcp->pcp))
 				has_pcps = true;
 		} else {
 			for_each_populated_zone(z) {
 				pcp = per_cpu_ptr(z->pageset, cpu);
-				if (pcp->pcp.count) {
+				if (pcp_populated(&pcp->pcp)) {
 					has_pcps = true;
 					break;
 				}
@@ -2855,6 +2939,41 @@ static inline void zone_statistics(struct zone *preferred_zone, struct zone *z,
 #endif
 }
 
+#ifdef CONFIG_PCP_HIGH_ORDER
+/* Take an order-1..3 block from this CPU's list. Interrupts are off. */
+static struct page *rmqueue_pcp_high(struct zone *zone, unsigned int order,
+					int migratetype, bool cold)
+{
+	struct per_cpu_pages *pcp = &this_cpu_ptr(zone->pageset)->pcp;
+	struct list_head *list = pcp_high_list(pcp, order, migratetype);
+	struct page *page;
+
+	do {
+		if (list_empty(list)) {
+			/* refill with about half a batch worth of pages */
+			int batch = max(pcp->batch >> (order + 1), 1);
+
+			__count_vm_event(PCP_HIGH_ORDER_MISS);
+			pcp->high_count += rmqueue_bulk(zone, order, batch,
+					list, migratetype, cold) << order;
+			if (unlikely(list_empty(list)))
+				return NULL;
+		} else {
+			__count_vm_event(PCP_HIGH_ORDER_HIT);
+		}
+
+		if (cold)
+			page = list_last_entry(list, struct page, lru);
+		else
+			page = list_first_entry(list, struct page, lru);
+		list_del(&page->lru);
+		pcp->high_count -= 1 << order;
+	} while (check_new_pages(page, order));
+
+	return page;
+}
+#endif
+
 /*
  * Allocate a page from the given zone. Use pcplists for order-0 allocations.
  */
@@ -2928,6 +3047,13 @@ struct page *buffered_rmqueue(struct zone *preferred_zone,
 			}
 		} while (check_new_pcp(page));
 	}
+#ifdef CONFIG_PCP_HIGH_ORDER
+	else if (order <= PAGE_ALLOC_COSTLY_ORDER &&
+			!(alloc_flags & ALLOC_HARDER) &&
+			migratetype_rmqueue == migratetype) {
+		page = rmqueue_pcp_high(zone, order, migratetype, cold);
+	}
+#endif
 
 	if (!page) {
 		/*
@@ -5555,6 +5681,9 @@ static void pageset_init(struct per_cpu_pageset *p)
 {
 	struct per_cpu_pages *pcp;
 	int migratetype;
+#ifdef CONFIG_PCP_HIGH_ORDER
+	int order;
+#endif
 
 	memset(p, 0, sizeof(*p));
 
@@ -5562,6 +5691,12 @@ static void pageset_init(struct per_cpu_pageset *p)
 	pcp->count = 0;
 	for (migratetype = 0; migratetype < MIGRATE_PCPTYPES; migratetype++)
 		INIT_LIST_HEAD(&pcp->lists[migratetype]);
+#ifdef CONFIG_PCP_HIGH_ORDER
+	for (order = 0; order < PAGE_ALLOC_COSTLY_ORDER; order++)
+		for (migratetype = 0; migratetype < MIGRATE_PCPTYPES;
+							migratetype++)
+			INIT_LIST_HEAD(&pcp->high_lists[order][migratetype]);
+#endif
 }
 
 static void setup_pageset(struct per_cpu_pageset *p, unsigned long batch)
@@ -19,6 +19,7 @@
 #include <linux/syscalls.h>
 #include <linux/file.h>
 #include <linux/mm_inline.h>
+#include <trace/events/filemap.h>
 
 #include "internal.h"
 
@@ -563,6 +564,111 @@ page_cache_async_readahead(struct address_space *mapping,
 }
 EXPORT_SYMBOL_GPL(page_cache_async_readahead);
 
+#ifdef CONFIG_READAHEAD_PATTERN
+/*
+ * Faults of a sequential mapping land right behind the pages fault-around
+ * just mapped, so allow for that gap before calling the access strided.
+ */
+#define RA_PATTERN_SEQ_GAP	32
+#define RA_PATTERN_CONF_MAX	3
+
+/*
+ * Feed one mmap fault at @index into the per-file classifier. A new pattern
+ * has to be seen twice in a row before it replaces the current one, so a
+ * single odd fault does not flip the file between window sizes.
+ */
+void ra_pattern_update(struct file *file, pgoff_t index)
+{
+	struct file_ra_state *ra = &file->f_ra;
+	long delta = (long)(index - ra->fault_index);
+	unsigned int seen;
+
+	if (delta >= 0 && delta <= RA_PATTERN_SEQ_GAP)
+		seen = RA_PATTERN_SEQ;
+	else if (delta == ra->fault_stride)
+		seen = RA_PATTERN_STRIDED;
+	else
+		seen = RA_PATTERN_RANDOM;
+
+	ra->fault_index = index;
+	ra->fault_stride = delta;
+
+	if (seen == ra->pattern) {
+		if (ra->pattern_conf < RA_PATTERN_CONF_MAX)
+			ra->pattern_conf++;
+	} else if (ra->pattern_conf) {
+		ra->pattern_conf--;
+	} else {
+		ra->pattern = seen;
+		ra->pattern_conf = 1;
+		trace_mm_filemap_ra_pattern(file_inode(file), index, seen,
+					    delta);
+	}
+}
+
+static unsigned int ra_pattern(struct file_ra_state *ra)
+{
+	return ra->pattern_conf > 1 ? ra->pattern : RA_PATTERN_NONE;
+}
+
+/*
+ * mmap read-around of @ra_pages pages for a major fault at @offset. Without
+ * a settled pattern this is the classic window centered on the fault.
+ */
+unsigned long ra_pattern_readaround(struct file *file,
+		struct file_ra_state *ra, pgoff_t offset, unsigned long ra_pages)
+{
+	struct address_space *mapping = file->f_mapping;
+	unsigned long small = max(ra_pages / 8, 1UL);
+	long stride = ra->fault_stride;
+
+	switch (ra_pattern(ra)) {
+	case RA_PATTERN_SEQ:
+		/* nothing behind the fault will be touched again */
+		ra->start = offset;
+		ra->size = ra_pages;
+		ra->async_size = ra_pages / 2;
+		break;
+	case RA_PATTERN_STRIDED:
+		/* read the next element the stream is going to hit, too */
+		if (stride > 0)
+			__do_page_cache_readahead(mapping, file,
+					offset + stride, small, 0);
+		/* fall through */
+	case RA_PATTERN_RANDOM:
+		ra->start = max_t(long, 0, offset - small / 2);
+		ra->size = small;
+		ra->async_size = 0;
+		break;
+	default:
+		ra->start = max_t(long, 0, offset - ra_pages / 2);
+		ra->size = ra_pages;
+		ra->async_size = ra_pages / 4;
+		break;
+	}
+
+	return ra_submit(ra, mapping, file);
+}
+
+/*
+ * Number of pages do_fault_around() should map for a fault in @file, given
+ * the configured @nr_pages. Stays a power of two.
+ */
+unsigned long ra_pattern_fault_around(struct file *file, unsigned long nr_pages)
+{
+	if (!file)
+		return nr_pages;
+
+	switch (ra_pattern(&file->f_ra)) {
+	case RA_PATTERN_STRIDED:
+	case RA_PATTERN_RANDOM:
+		return nr_pages >> 2;
+	default:
+		return nr_pages;
+	}
+}
+#endif
+
 static ssize_t
 do_readahead(struct address_space *mapping, struct file *filp,
 	     pgoff_t index, unsigned long nr)
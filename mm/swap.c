@@ -259,6 +259,35 @@ static void update_page_reclaim_stat(struct lruvec *lruvec,
 		reclaim_stat->recent_rotated[file]++;
 }
 
+#ifdef CONFIG_LRU_BALANCE_REFAULT
+/*
+ * A reclaimed page of @lruvec had to come back: account it as a scanned
+ * and rotated page, the same signal get_scan_count() takes from pages
+ * found referenced on the inactive list, so the next reclaim rounds lean
+ * on the other LRU type.
+ */
+void lru_note_refault(struct lruvec *lruvec, int file)
+{
+	struct pglist_data *pgdat = lruvec_pgdat(lruvec);
+
+	spin_lock_irq(&pgdat->lru_lock);
+	update_page_reclaim_stat(lruvec, file, 1);
+	spin_unlock_irq(&pgdat->lru_lock);
+}
+
+/* @page must be charged already */
+void lru_note_refault_page(struct page *page)
+{
+	struct pglist_data *pgdat = page_pgdat(page);
+	struct lruvec *lruvec;
+
+	spin_lock_irq(&pgdat->lru_lock);
+	lruvec = mem_cgroup_page_lruvec(page, pgdat);
+	update_page_reclaim_stat(lruvec, page_is_file_cache(page), 1);
+	spin_unlock_irq(&pgdat->lru_lock);
+}
+#endif
+
 static void __activate_page(struct page *page, struct lruvec *lruvec,
 			    void *arg)
 {
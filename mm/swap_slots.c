@@ -0,0 +1,180 @@
+/*
+ * Per-cpu caches of swap slots.
+ *
+ * Every swap-out takes si->lock in get_swap_page() and again when the slot
+ * is freed. With several CPUs reclaiming into zram at once that lock is as
+ * hot as zsmalloc itself.
+ *
+ * Each CPU instead grabs SWAP_SLOTS_CACHE_SIZE slots in one go under a
+ * single si->lock hold and hands them out locally. Slots whose last
+ * reference goes away are parked on the CPU with only the SWAP_HAS_CACHE
+ * bit left in swap_map, and given back to their device in batches. Nobody
+ * references such a slot any more, so nobody can find it missing.
+ *
+ * swapoff first disables the caches and returns every slot they hold, so
+ * try_to_unuse() never waits on an entry nobody will free.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#include <linux/swap_slots.h>
+#include <linux/cpu.h>
+#include <linux/cpuhotplug.h>
+#include <linux/percpu.h>
+#include <linux/init.h>
+
+static DEFINE_PER_CPU(struct swap_slots_cache, swp_slots);
+static bool swap_slot_cache_enabled;
+/* serializes enabling against swapoff */
+static DEFINE_MUTEX(swap_slots_cache_mutex);
+
+bool swap_slots_cache_active(void)
+{
+	return READ_ONCE(swap_slot_cache_enabled);
+}
+
+/*
+ * Do not hoard slots when swap is nearly full, every CPU sitting on a
+ * batch would make the others fail early.
+ */
+static bool swap_slots_refill_ok(void)
+{
+	return get_nr_swap_pages() >=
+		(long)num_online_cpus() * SWAP_SLOTS_CACHE_SIZE * 2;
+}
+
+/*
+ * Hand out a slot from this CPU's cache, refilling it from the swap devices
+ * when empty. Returns false when the caller should allocate directly.
+ */
+bool swap_slots_alloc(swp_entry_t *entry)
+{
+	struct swap_slots_cache *cache;
+	bool ret = false;
+
+	if (!swap_slots_cache_active())
+		return false;
+
+	cache = raw_cpu_ptr(&swp_slots);
+	mutex_lock(&cache->alloc_lock);
+	/* recheck, swapoff clears the flag before draining */
+	if (!cache->nr && swap_slots_cache_active() && swap_slots_refill_ok()) {
+		cache->cur = 0;
+		cache->nr = get_swap_pages(SWAP_SLOTS_CACHE_SIZE, cache->slots);
+	}
+	if (cache->nr) {
+		*entry = cache->slots[cache->cur];
+		cache->slots[cache->cur++].val = 0;
+		cache->nr--;
+		ret = true;
+	}
+	mutex_unlock(&cache->alloc_lock);
+
+	return ret;
+}
+
+/*
+ * Park @entry, whose swap_map count is down to SWAP_HAS_CACHE, until this
+ * CPU has a batch to give back. Returns false when the caller should free
+ * it directly.
+ */
+bool swap_slots_free(swp_entry_t entry)
+{
+	struct swap_slots_cache *cache;
+
+	if (!swap_slots_cache_active())
+		return false;
+
+	cache = raw_cpu_ptr(&swp_slots);
+	spin_lock(&cache->free_lock);
+	if (!swap_slots_cache_active()) {
+		spin_unlock(&cache->free_lock);
+		return false;
+	}
+	if (cache->n_ret >= SWAP_SLOTS_CACHE_SIZE) {
+		swapcache_free_entries(cache->slots_ret, cache->n_ret);
+		cache->n_ret = 0;
+	}
+	cache->slots_ret[cache->n_ret++] = entry;
+	spin_unlock(&cache->free_lock);
+
+	return true;
+}
+
+static void drain_slots_cache_cpu(unsigned int cpu)
+{
+	struct swap_slots_cache *cache = &per_cpu(swp_slots, cpu);
+
+	mutex_lock(&cache->alloc_lock);
+	if (cache->nr) {
+		swapcache_free_entries(cache->slots + cache->cur, cache->nr);
+		cache->cur = 0;
+		cache->nr = 0;
+	}
+	mutex_unlock(&cache->alloc_lock);
+
+	spin_lock(&cache->free_lock);
+	if (cache->n_ret) {
+		swapcache_free_entries(cache->slots_ret, cache->n_ret);
+		cache->n_ret = 0;
+	}
+	spin_unlock(&cache->free_lock);
+}
+
+static int swap_slots_cpu_offline(unsigned int cpu)
+{
+	drain_slots_cache_cpu(cpu);
+	return 0;
+}
+
+/* called from swapon once the new device is usable */
+void enable_swap_slots_cache(void)
+{
+	mutex_lock(&swap_slots_cache_mutex);
+	WRITE_ONCE(swap_slot_cache_enabled, true);
+	mutex_unlock(&swap_slots_cache_mutex);
+}
+
+/*
+ * Stop caching and give every cached slot back, until
+ * reenable_swap_slots_cache_unlock(). Called by swapoff around
+ * try_to_unuse().
+ */
+void disable_swap_slots_cache_lock(void)
+{
+	unsigned int cpu;
+
+	mutex_lock(&swap_slots_cache_mutex);
+	WRITE_ONCE(swap_slot_cache_enabled, false);
+
+	for_each_possible_cpu(cpu)
+		drain_slots_cache_cpu(cpu);
+}
+
+void reenable_swap_slots_cache_unlock(void)
+{
+	if (total_swap_pages)
+		WRITE_ONCE(swap_slot_cache_enabled, true);
+	mutex_unlock(&swap_slots_cache_mutex);
+}
+
+static int __init swap_slots_cache_init(void)
+{
+	unsigned int cpu;
+	int ret;
+
+	for_each_possible_cpu(cpu) {
+		struct swap_slots_cache *cache = &per_cpu(swp_slots, cpu);
+
+		mutex_init(&cache->alloc_lock);
+		spin_lock_init(&cache->free_lock);
+	}
+
+	ret = cpuhp_setup_state_nocalls(CPUHP_AP_ONLINE_DYN, "mm/swap_slots",
+					NULL, swap_slots_cpu_offline);
+	return ret < 0 ? ret : 0;
+}
+subsys_initcall(swap_slots_cache_init);
@@ -894,6 +894,25 @@ int fragmentation_index(struct zone *zone, unsigned int order)
 	fill_contig_page_info(zone, order, &info);
 	return __fragmentation_index(order, &info);
 }
+
+#ifdef CONFIG_COMPACTION_PROACTIVE
+/*
+ * Percentage of the free memory of @zone that sits in blocks smaller than
+ * @order, 0 if nothing is free.
+ */
+unsigned int extfrag_for_order(struct zone *zone, unsigned int order)
+{
+	struct contig_page_info info;
+
+	fill_contig_page_info(zone, order, &info);
+	if (info.free_pages == 0)
+		return 0;
+
+	return div_u64((info.free_pages -
+			(info.free_blocks_suitable << order)) * 100,
+			info.free_pages);
+}
+#endif
 #endif
 
 #if defined(CONFIG_PROC_FS) || defined(CONFIG_SYSFS) || defined(CONFIG_NUMA)
@@ -995,6 +1014,10 @@ const char * const vmstat_text[] = {
 	"pgfree",
 	"pgactivate",
 	"pgdeactivate",
+#ifdef CONFIG_PCP_HIGH_ORDER
+	"pcp_high_order_hit",
+	"pcp_high_order_miss",
+#endif
 
 	"pgfault",
 	"pgmajfault",
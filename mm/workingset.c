@@ -319,6 +319,7 @@ void workingset_refault(struct page *page, void *shadow)
 	if (workingset) {
 		SetPageWorkingset(page);
 		inc_node_state(pgdat, WORKINGSET_RESTORE);
+		lru_note_refault(lruvec, 1);
 	}
 out:
 	rcu_read_unlock();
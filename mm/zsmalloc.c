@@ -56,6 +56,7 @@
 #include <linux/pagemap.h>
 #include <linux/swap.h>
 #include <linux/jiffies.h>
+#include <linux/percpu.h>
 
 #define ZSPAGE_MAGIC	0x58
 
@@ -199,6 +200,24 @@ static int zs_size_classes;
 static const int fullness_threshold_frac = 4;
 static size_t huge_class_size;
 
+#ifdef CONFIG_ZSMALLOC_PCPU_CACHE
+/*
+ * Per-cpu magazine of objects that are allocated from the class but
+ * not handed out yet. zs_malloc() pops from it and zs_free() pushes to
+ * it without touching class->lock; class->lock is only taken to refill
+ * ZS_MAG_BATCH objects at once or when a magazine overflows.
+ * zs_compact() hands every cached object back to its zspage first.
+ */
+#define ZS_MAG_SIZE	16
+#define ZS_MAG_BATCH	8
+
+struct zs_magazine {
+	spinlock_t lock;
+	unsigned int count;
+	unsigned long handles[ZS_MAG_SIZE];
+};
+#endif
+
 struct size_class {
 	spinlock_t lock;
 	struct list_head fullness_list[NR_ZS_FULLNESS];
@@ -213,6 +232,10 @@ struct size_class {
 
 	unsigned int index;
 	struct zs_size_stat stats;
+#ifdef CONFIG_ZSMALLOC_PCPU_CACHE
+	/* only set up for the hot classes, see zs_class_use_magazine() */
+	struct zs_magazine __percpu *mag;
+#endif
 };
 
 /* huge object: pages_per_zspage == 1 && maxobj_per_zspage == 1 */
@@ -1585,6 +1608,200 @@ static unsigned long obj_malloc(struct size_class *class,
  * otherwise 0.
  * Allocation requests with size > ZS_MAX_ALLOC_SIZE will fail.
  */
+#ifdef CONFIG_ZSMALLOC_PCPU_CACHE
+static void __zs_free(struct zs_pool *pool, unsigned long handle);
+
+/*
+ * Magazines are kept for the classes that take most of the compressed
+ * anonymous pages, objects between half and three quarters of a page.
+ */
+static bool zs_class_use_magazine(struct size_class *class)
+{
+	return class->objs_per_zspage > 1 &&
+		class->size >= PAGE_SIZE / 2 &&
+		class->size <= PAGE_SIZE / 4 * 3;
+}
+
+static int zs_mag_create(struct size_class *class)
+{
+	int cpu;
+
+	if (!zs_class_use_magazine(class))
+		return 0;
+
+	class->mag = alloc_percpu(struct zs_magazine);
+	if (!class->mag)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu)
+		spin_lock_init(&per_cpu_ptr(class->mag, cpu)->lock);
+
+	return 0;
+}
+
+/* Hand every cached object of @class back to its zspage. */
+static void zs_mag_drain(struct zs_pool *pool, struct size_class *class)
+{
+	unsigned long handles[ZS_MAG_SIZE];
+	unsigned int i, nr;
+	int cpu;
+
+	if (!class->mag)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct zs_magazine *mag = per_cpu_ptr(class->mag, cpu);
+
+		spin_lock(&mag->lock);
+		nr = mag->count;
+		memcpy(handles, mag->handles, nr * sizeof(handles[0]));
+		mag->count = 0;
+		spin_unlock(&mag->lock);
+
+		for (i = 0; i < nr; i++)
+			__zs_free(pool, handles[i]);
+	}
+}
+
+/* Magazines must have been drained already */
+static void zs_mag_destroy(struct size_class *class)
+{
+	free_percpu(class->mag);
+	class->mag = NULL;
+}
+
+/*
+ * Reserve up to ZS_MAG_BATCH objects from zspages that already have
+ * free space under one class->lock, and fill the local magazine with
+ * them. Returns the number of handles reserved in @handles.
+ */
+static int zs_mag_refill(struct zs_pool *pool, struct size_class *class,
+			gfp_t gfp, unsigned long *handles)
+{
+	struct zspage *zspage;
+	unsigned long obj;
+	int i, nr;
+
+	for (nr = 0; nr < ZS_MAG_BATCH; nr++) {
+		handles[nr] = cache_alloc_handle(pool, gfp);
+		if (!handles[nr])
+			break;
+	}
+	if (!nr)
+		return 0;
+
+	spin_lock(&class->lock);
+	for (i = 0; i < nr; i++) {
+		zspage = find_get_zspage(class);
+		if (!zspage)
+			break;
+		obj = obj_malloc(class, zspage, handles[i]);
+		fix_fullness_group(class, zspage);
+		record_obj(handles[i], obj);
+	}
+	spin_unlock(&class->lock);
+
+	/* The class ran out of partially used zspages */
+	while (nr > i)
+		cache_free_handle(pool, handles[--nr]);
+
+	return i;
+}
+
+static unsigned long zs_mag_alloc(struct zs_pool *pool,
+				struct size_class *class, gfp_t gfp)
+{
+	unsigned long handles[ZS_MAG_BATCH];
+	struct zs_magazine *mag;
+	unsigned long handle = 0;
+	int nr;
+
+	if (!class->mag)
+		return 0;
+
+	mag = get_cpu_ptr(class->mag);
+	spin_lock(&mag->lock);
+	if (mag->count)
+		handle = mag->handles[--mag->count];
+	spin_unlock(&mag->lock);
+	put_cpu_ptr(class->mag);
+
+	if (handle)
+		return handle;
+
+	nr = zs_mag_refill(pool, class, gfp, handles);
+	if (!nr)
+		return 0;
+
+	handle = handles[--nr];
+
+	mag = get_cpu_ptr(class->mag);
+	spin_lock(&mag->lock);
+	while (nr && mag->count < ZS_MAG_SIZE)
+		mag->handles[mag->count++] = handles[--nr];
+	spin_unlock(&mag->lock);
+	put_cpu_ptr(class->mag);
+
+	/* Raced with frees on this cpu, give the surplus back */
+	while (nr)
+		__zs_free(pool, handles[--nr]);
+
+	return handle;
+}
+
+/*
+ * Keep a freed object allocated in the local magazine for the next
+ * zs_malloc() of the same class. Returns false if the caller has to
+ * free it for real.
+ */
+static bool zs_mag_free(struct zs_pool *pool, unsigned long handle)
+{
+	struct size_class *class;
+	struct zs_magazine *mag;
+	struct zspage *zspage;
+	struct page *f_page;
+	unsigned int f_objidx;
+	enum fullness_group fullness;
+	int class_idx;
+	bool cached = false;
+
+	/* The object cannot change class, only move within it */
+	pin_tag(handle);
+	obj_to_location(handle_to_obj(handle), &f_page, &f_objidx);
+	zspage = get_zspage(f_page);
+	get_zspage_mapping(zspage, &class_idx, &fullness);
+	unpin_tag(handle);
+
+	class = pool->size_class[class_idx];
+	if (!class->mag)
+		return false;
+
+	mag = get_cpu_ptr(class->mag);
+	spin_lock(&mag->lock);
+	if (mag->count < ZS_MAG_SIZE) {
+		mag->handles[mag->count++] = handle;
+		cached = true;
+	}
+	spin_unlock(&mag->lock);
+	put_cpu_ptr(class->mag);
+
+	return cached;
+}
+#else
+static int zs_mag_create(struct size_class *class) { return 0; }
+static void zs_mag_drain(struct zs_pool *pool, struct size_class *class) {}
+static void zs_mag_destroy(struct size_class *class) {}
+static unsigned long zs_mag_alloc(struct zs_pool *pool,
+				struct size_class *class, gfp_t gfp)
+{
+	return 0;
+}
+static bool zs_mag_free(struct zs_pool *pool, unsigned long handle)
+{
+	return false;
+}
+#endif
+
 unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t gfp)
 {
 	unsigned long handle, obj;
@@ -1595,14 +1812,18 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t gfp)
 	if (unlikely(!size || size > ZS_MAX_ALLOC_SIZE))
 		return 0;
 
-	handle = cache_alloc_handle(pool, gfp);
-	if (!handle)
-		return 0;
-
 	/* extra space in chunk to keep the handle */
 	size += ZS_HANDLE_SIZE;
 	class = pool->size_class[get_size_class_index(size)];
 
+	handle = zs_mag_alloc(pool, class, gfp);
+	if (handle)
+		return handle;
+
+	handle = cache_alloc_handle(pool, gfp);
+	if (!handle)
+		return 0;
+
 	spin_lock(&class->lock);
 	zspage = find_get_zspage(class);
 	if (likely(zspage)) {
@@ -1666,7 +1887,7 @@ static void obj_free(struct size_class *class, unsigned long obj)
 	zs_stat_dec(class, OBJ_USED, 1);
 }
 
-void zs_free(struct zs_pool *pool, unsigned long handle)
+static void __zs_free(struct zs_pool *pool, unsigned long handle)
 {
 	struct zspage *zspage;
 	struct page *f_page;
@@ -1677,9 +1898,6 @@ void zs_free(struct zs_pool *pool, unsigned long handle)
 	enum fullness_group fullness;
 	bool isolated;
 
-	if (unlikely(!handle))
-		return;
-
 	pin_tag(handle);
 	obj = handle_to_obj(handle);
 	obj_to_location(obj, &f_page, &f_objidx);
@@ -1709,6 +1927,17 @@ void zs_free(struct zs_pool *pool, unsigned long handle)
 	unpin_tag(handle);
 	cache_free_handle(pool, handle);
 }
+
+void zs_free(struct zs_pool *pool, unsigned long handle)
+{
+	if (unlikely(!handle))
+		return;
+
+	if (zs_mag_free(pool, handle))
+		return;
+
+	__zs_free(pool, handle);
+}
 EXPORT_SYMBOL_GPL(zs_free);
 
 static void zs_object_copy(struct size_class *class, unsigned long dst,
@@ -2434,6 +2663,7 @@ unsigned long zs_compact(struct zs_pool *pool)
 			continue;
 		if (class->index != i)
 			continue;
+		zs_mag_drain(pool, class);
 		__zs_compact(pool, class);
 	}
 
@@ -2620,6 +2850,8 @@ struct zs_pool *zs_create_pool(const char *name)
 		class->objs_per_zspage = objs_per_zspage;
 		spin_lock_init(&class->lock);
 		pool->size_class[i] = class;
+		if (zs_mag_create(class))
+			goto err;
 		for (fullness = ZS_EMPTY; fullness < NR_ZS_FULLNESS;
 							fullness++)
 			INIT_LIST_HEAD(&class->fullness_list[fullness]);
@@ -2652,6 +2884,15 @@ void zs_destroy_pool(struct zs_pool *pool)
 	int i;
 
 	zs_unregister_shrinker(pool);
+
+	/* Give cached objects back while deferred freeing still works */
+	for (i = 0; i < zs_size_classes; i++) {
+		struct size_class *class = pool->size_class[i];
+
+		if (class && class->index == i)
+			zs_mag_drain(pool, class);
+	}
+
 	zs_unregister_migration(pool);
 	zs_pool_stat_destroy(pool);
 
@@ -2665,6 +2906,8 @@ void zs_destroy_pool(struct zs_pool *pool)
 		if (class->index != i)
 			continue;
 
+		zs_mag_destroy(class);
+
 		for (fg = ZS_EMPTY; fg < NR_ZS_FULLNESS; fg++) {
 			if (!list_empty(&class->fullness_list[fg])) {
 				pr_info("Freeing non-empty class with size %db, fullness group %d\n",
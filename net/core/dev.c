@@ -102,6 +102,7 @@
 #include <linux/stat.h>
 #include <net/dst.h>
 #include <net/dst_metadata.h>
+#include <net/rx_prof.h>
 #include <net/pkt_sched.h>
 #include <net/checksum.h>
 #include <net/xfrm.h>
@@ -3729,6 +3730,126 @@ EXPORT_SYMBOL(rps_may_expire_flow);
 
 #endif /* CONFIG_RFS_ACCEL */
 
+static DEFINE_MUTEX(rps_map_mutex);
+static DEFINE_SPINLOCK(rps_dev_flow_lock);
+
+/**
+ * netif_set_rps_map - set the CPUs an RX queue steers its packets to
+ * @queue: RX queue
+ * @mask: CPUs to steer to, only the online ones are used. An empty mask
+ *	turns RPS off for the queue.
+ *
+ * Backs the rps_cpus sysfs attribute and may be used by other kernel code
+ * that manages the receive steering of a device. May sleep.
+ */
+int netif_set_rps_map(struct netdev_rx_queue *queue,
+		      const struct cpumask *mask)
+{
+	struct rps_map *old_map, *map;
+	int cpu, i;
+
+	map = kzalloc(max_t(unsigned int,
+	    RPS_MAP_SIZE(cpumask_weight(mask)), L1_CACHE_BYTES),
+	    GFP_KERNEL);
+	if (!map)
+		return -ENOMEM;
+
+	i = 0;
+	for_each_cpu_and(cpu, mask, cpu_online_mask)
+		map->cpus[i++] = cpu;
+
+	if (i)
+		map->len = i;
+	else {
+		kfree(map);
+		map = NULL;
+	}
+
+	mutex_lock(&rps_map_mutex);
+	old_map = rcu_dereference_protected(queue->rps_map,
+					    mutex_is_locked(&rps_map_mutex));
+	rcu_assign_pointer(queue->rps_map, map);
+
+	if (map)
+		static_key_slow_inc(&rps_needed);
+	if (old_map)
+		static_key_slow_dec(&rps_needed);
+
+	mutex_unlock(&rps_map_mutex);
+
+	if (old_map)
+		kfree_rcu(old_map, rcu);
+
+	return 0;
+}
+EXPORT_SYMBOL(netif_set_rps_map);
+
+static void rps_dev_flow_table_release(struct rcu_head *rcu)
+{
+	struct rps_dev_flow_table *table = container_of(rcu,
+	    struct rps_dev_flow_table, rcu);
+	vfree(table);
+}
+
+/**
+ * netif_set_rps_flow_cnt - resize the RFS flow table of an RX queue
+ * @queue: RX queue
+ * @count: number of flows, rounded up to a power of two. Zero frees the
+ *	table.
+ *
+ * Backs the rps_flow_cnt sysfs attribute. The flows tracked so far are
+ * forgotten. May sleep.
+ */
+int netif_set_rps_flow_cnt(struct netdev_rx_queue *queue,
+			   unsigned long count)
+{
+	struct rps_dev_flow_table *table, *old_table;
+	unsigned long mask;
+
+	if (count) {
+		mask = count - 1;
+		/* mask = roundup_pow_of_two(count) - 1;
+		 * without overflows...
+		 */
+		while ((mask | (mask >> 1)) != mask)
+			mask |= (mask >> 1);
+		/* On 64 bit arches, must check mask fits in table->mask (u32),
+		 * and on 32bit arches, must check
+		 * RPS_DEV_FLOW_TABLE_SIZE(mask + 1) doesn't overflow.
+		 */
+#if BITS_PER_LONG > 32
+		if (mask > (unsigned long)(u32)mask)
+			return -EINVAL;
+#else
+		if (mask > (ULONG_MAX - RPS_DEV_FLOW_TABLE_SIZE(1))
+				/ sizeof(struct rps_dev_flow)) {
+			/* Enforce a limit to prevent overflow */
+			return -EINVAL;
+		}
+#endif
+		table = vmalloc(RPS_DEV_FLOW_TABLE_SIZE(mask + 1));
+		if (!table)
+			return -ENOMEM;
+
+		table->mask = mask;
+		for (count = 0; count <= mask; count++)
+			table->flows[count].cpu = RPS_NO_CPU;
+	} else
+		table = NULL;
+
+	spin_lock(&rps_dev_flow_lock);
+	old_table = rcu_dereference_protected(queue->rps_flow_table,
+					      lockdep_is_held(&rps_dev_flow_lock));
+	rcu_assign_pointer(queue->rps_flow_table, table);
+	spin_unlock(&rps_dev_flow_lock);
+
+	if (old_table)
+		call_rcu(&old_table->rcu, rps_dev_flow_table_release);
+
+	return 0;
+}
+EXPORT_SYMBOL(netif_set_rps_flow_cnt);
+
 /* Called from hardirq (IPI) context */
 static void rps_trigger_softirq(void *data)
 {
@@ -3858,6 +3979,7 @@ static int netif_rx_internal(struct sk_buff *skb)
 	net_timestamp_check(netdev_tstamp_prequeue, skb);
 
 	trace_netif_rx(skb);
+	rx_prof_stamp(skb, RX_PROF_STACK);
 #ifdef CONFIG_RPS
 	if (static_key_false(&rps_needed)) {
 		struct rps_dev_flow voidflow, *rflow = &voidflow;
@@ -4161,6 +4283,7 @@ static int __netif_receive_skb_core(struct sk_buff *skb, bool pfmemalloc)
 	net_timestamp_check(!netdev_tstamp_prequeue, skb);
 
 	trace_netif_receive_skb(skb);
+	rx_prof_stamp(skb, RX_PROF_CORE);
 
 	orig_dev = skb->dev;
 
@@ -4334,6 +4457,7 @@ static int netif_receive_skb_internal(struct sk_buff *skb)
 	int ret;
 
 	net_timestamp_check(netdev_tstamp_prequeue, skb);
+	rx_prof_stamp(skb, RX_PROF_STACK);
 
 	if (skb_defer_rx_timestamp(skb))
 		return NET_RX_SUCCESS;
@@ -4737,6 +4861,7 @@ gro_result_t napi_gro_receive(struct napi_struct *napi, struct sk_buff *skb)
 {
 	skb_mark_napi_id(skb, napi);
 	trace_napi_gro_receive_entry(skb);
+	rx_prof_stamp(skb, RX_PROF_STACK);
 
 	skb_gro_reset_offset(skb);
 
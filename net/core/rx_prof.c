@@ -0,0 +1,201 @@
+/*
+ * Sampling profiler of the per packet cost of the network RX path
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * Link drivers call rx_prof_start() on every received skb. When
+ * <debugfs>/rx_prof/rate is N, one in N of them carries a timestamp
+ * through the stack, refreshed at each enum rx_prof_stage it reaches.
+ * The time since the previous stage is added to a histogram of the
+ * stage on the CPU the stage ran on, so <debugfs>/rx_prof/results shows
+ * both which stage costs most per packet and which core it lands on.
+ * Writing anything to results clears it.
+ *
+ * Stamps are the low 32 bits of local_clock(), enough for stages that
+ * take less than four seconds.
+ */
+
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/percpu.h>
+#include <linux/sched.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <net/rx_prof.h>
+
+/* bucket 0 counts stages under 128ns, bucket n those under 128ns << n */
+#define RX_PROF_BUCKET_SHIFT	7
+#define RX_PROF_NR_BUCKETS	16
+
+struct rx_prof_hist {
+	u64 count;
+	u64 sum_ns;
+	u32 bucket[RX_PROF_NR_BUCKETS];
+};
+
+struct rx_prof_cpu {
+	struct rx_prof_hist hist[RX_PROF_NR_SRC][RX_PROF_NR_STAGES];
+};
+
+static const char * const rx_prof_src_name[RX_PROF_NR_SRC] = {
+	[RX_PROF_WIFI]		= "wifi",
+	[RX_PROF_MODEM]		= "modem",
+};
+
+/* named after what the time up to the stage was spent on */
+static const char * const rx_prof_stage_name[RX_PROF_NR_STAGES] = {
+	[RX_PROF_STACK]		= "driver",
+	[RX_PROF_CORE]		= "gro/backlog",
+	[RX_PROF_PREROUTING]	= "ip+prerouting",
+	[RX_PROF_LOCAL_IN]	= "route+input",
+	[RX_PROF_SOCK]		= "l4+enqueue",
+};
+
+unsigned int rx_prof_rate;
+EXPORT_SYMBOL(rx_prof_rate);
+
+static DEFINE_PER_CPU(unsigned int, rx_prof_seq);
+static DEFINE_PER_CPU(struct rx_prof_cpu, rx_prof_cpu);
+
+void __rx_prof_start(struct sk_buff *skb, enum rx_prof_src src)
+{
+	unsigned int rate = READ_ONCE(rx_prof_rate);
+
+	if (!rate || this_cpu_inc_return(rx_prof_seq) % rate)
+		return;
+
+	skb->rx_prof_src = src;
+	skb->rx_prof_stage = RX_PROF_DRIVER;
+	skb->rx_prof_stamp = (u32)local_clock();
+}
+EXPORT_SYMBOL(__rx_prof_start);
+
+void __rx_prof_stamp(struct sk_buff *skb, enum rx_prof_stage stage)
+{
+	unsigned int src = skb->rx_prof_src;
+	u32 now, delta;
+	int idx;
+
+	/* re-entered a stage already accounted, e.g. after GRO */
+	if (stage <= skb->rx_prof_stage)
+		return;
+
+	now = (u32)local_clock();
+	delta = now - skb->rx_prof_stamp;
+	idx = min_t(int, fls(delta >> RX_PROF_BUCKET_SHIFT),
+		    RX_PROF_NR_BUCKETS - 1);
+
+	this_cpu_inc(rx_prof_cpu.hist[src][stage].count);
+	this_cpu_add(rx_prof_cpu.hist[src][stage].sum_ns, delta);
+	this_cpu_inc(rx_prof_cpu.hist[src][stage].bucket[idx]);
+
+	if (stage == RX_PROF_SOCK) {
+		skb->rx_prof_src = RX_PROF_NONE;
+		return;
+	}
+	skb->rx_prof_stage = stage;
+	skb->rx_prof_stamp = now;
+}
+EXPORT_SYMBOL(__rx_prof_stamp);
+
+static void rx_prof_show_src(struct seq_file *s, unsigned int src)
+{
+	struct rx_prof_hist sum, *hist;
+	unsigned int stage, cpu, i;
+
+	seq_printf(s, "[%s]\n", rx_prof_src_name[src]);
+
+	for (stage = RX_PROF_DRIVER + 1; stage < RX_PROF_NR_STAGES; stage++) {
+		memset(&sum, 0, sizeof(sum));
+		for_each_possible_cpu(cpu) {
+			hist = &per_cpu(rx_prof_cpu, cpu).hist[src][stage];
+			sum.count += hist->count;
+			sum.sum_ns += hist->sum_ns;
+			for (i = 0; i < RX_PROF_NR_BUCKETS; i++)
+				sum.bucket[i] += hist->bucket[i];
+		}
+		if (!sum.count)
+			continue;
+
+		seq_printf(s, "  %-14s count %llu avg %llu ns\n   ",
+			   rx_prof_stage_name[stage], sum.count,
+			   div64_u64(sum.sum_ns, sum.count));
+		for (i = 0; i < RX_PROF_NR_BUCKETS - 1; i++)
+			if (sum.bucket[i])
+				seq_printf(s, " <%luns:%u",
+					   128UL << i, sum.bucket[i]);
+		if (sum.bucket[i])
+			seq_printf(s, " >=%luns:%u",
+				   128UL << (i - 1), sum.bucket[i]);
+		seq_putc(s, '\n');
+	}
+
+	seq_puts(s, "  avg ns per packet by cpu\n  cpu");
+	for (stage = RX_PROF_DRIVER + 1; stage < RX_PROF_NR_STAGES; stage++)
+		seq_printf(s, " %14s", rx_prof_stage_name[stage]);
+	seq_putc(s, '\n');
+	for_each_possible_cpu(cpu) {
+		seq_printf(s, "  %3u", cpu);
+		for (stage = RX_PROF_DRIVER + 1; stage < RX_PROF_NR_STAGES;
+		     stage++) {
+			hist = &per_cpu(rx_prof_cpu, cpu).hist[src][stage];
+			seq_printf(s, " %14llu", hist->count ?
+				   div64_u64(hist->sum_ns, hist->count) : 0);
+		}
+		seq_putc(s, '\n');
+	}
+}
+
+static int rx_prof_results_show(struct seq_file *s, void *unused)
+{
+	unsigned int src;
+
+	for (src = RX_PROF_NONE + 1; src < RX_PROF_NR_SRC; src++)
+		rx_prof_show_src(s, src);
+
+	return 0;
+}
+
+static int rx_prof_results_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, rx_prof_results_show, NULL);
+}
+
+static ssize_t rx_prof_results_write(struct file *file,
+		const char __user *ubuf, size_t count, loff_t *ppos)
+{
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(&rx_prof_cpu, cpu), 0,
+		       sizeof(struct rx_prof_cpu));
+
+	return count;
+}
+
+static const struct file_operations rx_prof_results_fops = {
+	.open		= rx_prof_results_open,
+	.read		= seq_read,
+	.write		= rx_prof_results_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init rx_prof_init(void)
+{
+	struct dentry *root;
+
+	root = debugfs_create_dir("rx_prof", NULL);
+	if (!root)
+		return -ENOMEM;
+
+	debugfs_create_u32("rate", 0644, root, &rx_prof_rate);
+	debugfs_create_file("results", 0644, root, NULL,
+			    &rx_prof_results_fops);
+
+	return 0;
+}
+late_initcall(rx_prof_init);
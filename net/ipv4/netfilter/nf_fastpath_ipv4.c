@@ -0,0 +1,500 @@
+/*
+ * Software fast path for forwarded IPv4 flows
+ *
+ * Once a forwarded TCP or UDP connection is established and its NAT
+ * bindings are set up, the decision the slow path makes for each of its
+ * packets no longer changes: same translation, same route. The first
+ * packet of each direction that made it through FORWARD and POSTROUTING
+ * records that decision here, keyed by its 5-tuple and input device.
+ * Following packets are then translated and handed to the neighbour
+ * layer right from PREROUTING, before defrag and conntrack, so they skip
+ * the conntrack lookup, the iptables tables and the routing decision.
+ *
+ * Packets still account to the conntrack entry (nf_conntrack_acct) and
+ * keep its timeout fresh. Flows go back to the slow path as soon as
+ * anything changes: TCP leaving ESTABLISHED, the conntrack entry dying, the
+ * route being invalidated or a device going down.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/hashtable.h>
+#include <linux/ip.h>
+#include <linux/jhash.h>
+#include <linux/module.h>
+#include <linux/netdevice.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter_ipv4.h>
+#include <linux/random.h>
+#include <linux/skbuff.h>
+#include <linux/tcp.h>
+#include <linux/udp.h>
+#include <net/checksum.h>
+#include <net/ip.h>
+#include <net/neighbour.h>
+#include <net/route.h>
+#include <net/netfilter/nf_conntrack.h>
+#include <net/netfilter/nf_conntrack_core.h>
+#include <net/netfilter/nf_conntrack_helper.h>
+#include <net/netfilter/nf_conntrack_seqadj.h>
+
+#define FASTPATH_HASH_BITS	12
+#define FASTPATH_GC_INTERVAL	HZ
+
+static unsigned int max_flows __read_mostly = 4096;
+module_param(max_flows, uint, 0644);
+MODULE_PARM_DESC(max_flows, "Maximum number of flows handled by the fast path");
+
+struct fastpath_flow {
+	struct hlist_node	hnode;
+	struct rcu_head		rcu;
+
+	/* what the packet looks like when it comes in */
+	const struct net_device	*indev;
+	__be32			saddr;
+	__be32			daddr;
+	__be16			sport;
+	__be16			dport;
+	u8			proto;
+	u8			dir;
+
+	/* and what it looks like when it leaves */
+	__be32			nat_saddr;
+	__be32			nat_daddr;
+	__be16			nat_sport;
+	__be16			nat_dport;
+	struct dst_entry	*dst;
+
+	struct nf_conn		*ct;
+	u32			timeout;
+};
+
+static DEFINE_HASHTABLE(fastpath_hash, FASTPATH_HASH_BITS);
+static DEFINE_SPINLOCK(fastpath_lock);
+static unsigned int fastpath_count;
+static u32 fastpath_rnd __read_mostly;
+
+static struct delayed_work fastpath_gc_work;
+
+static u32 fastpath_key(const struct net_device *indev, __be32 saddr,
+			__be32 daddr, __be16 sport, __be16 dport, u8 proto)
+{
+	return jhash_3words((__force u32)saddr, (__force u32)daddr ^ proto,
+			    ((__force u32)sport << 16) | (__force u32)dport,
+			    fastpath_rnd ^ indev->ifindex);
+}
+
+/* called under rcu_read_lock() */
+static struct fastpath_flow *fastpath_lookup(const struct net_device *indev,
+					     const struct iphdr *iph,
+					     const __be16 *ports)
+{
+	struct fastpath_flow *flow;
+	u32 key = fastpath_key(indev, iph->saddr, iph->daddr,
+			       ports[0], ports[1], iph->protocol);
+
+	hash_for_each_possible_rcu(fastpath_hash, flow, hnode, key) {
+		if (flow->indev == indev &&
+		    flow->saddr == iph->saddr && flow->daddr == iph->daddr &&
+		    flow->sport == ports[0] && flow->dport == ports[1] &&
+		    flow->proto == iph->protocol)
+			return flow;
+	}
+
+	return NULL;
+}
+
+static void fastpath_flow_free_rcu(struct rcu_head *head)
+{
+	struct fastpath_flow *flow = container_of(head, struct fastpath_flow,
+						  rcu);
+
+	dst_release(flow->dst);
+	nf_ct_put(flow->ct);
+	kfree(flow);
+}
+
+/* called with fastpath_lock held */
+static void __fastpath_flow_remove(struct fastpath_flow *flow)
+{
+	/* two cpus may have decided to drop the same flow */
+	if (hlist_unhashed(&flow->hnode))
+		return;
+
+	hash_del_rcu(&flow->hnode);
+	fastpath_count--;
+	call_rcu(&flow->rcu, fastpath_flow_free_rcu);
+}
+
+static void fastpath_flow_remove(struct fastpath_flow *flow)
+{
+	spin_lock_bh(&fastpath_lock);
+	__fastpath_flow_remove(flow);
+	spin_unlock_bh(&fastpath_lock);
+}
+
+/* Is the decision recorded for @flow still the one the slow path takes? */
+static bool fastpath_flow_valid(const struct fastpath_flow *flow)
+{
+	struct nf_conn *ct = flow->ct;
+
+	if (unlikely(nf_ct_is_dying(ct)))
+		return false;
+	if (flow->proto == IPPROTO_TCP &&
+	    READ_ONCE(ct->proto.tcp.state) != TCP_CONNTRACK_ESTABLISHED)
+		return false;
+
+	return dst_check(flow->dst, 0) != NULL;
+}
+
+static void fastpath_nat_addr(struct sk_buff *skb, struct iphdr *iph,
+			      __sum16 *check, __be32 *addr, __be32 new)
+{
+	if (*addr == new)
+		return;
+
+	if (check)
+		inet_proto_csum_replace4(check, skb, *addr, new, true);
+	csum_replace4(&iph->check, *addr, new);
+	*addr = new;
+}
+
+static void fastpath_nat_port(struct sk_buff *skb, __sum16 *check,
+			      __be16 *port, __be16 new)
+{
+	if (*port == new)
+		return;
+
+	if (check)
+		inet_proto_csum_replace2(check, skb, *port, new, false);
+	*port = new;
+}
+
+/* Same translation as nf_nat_ipv4_manip_pkt(), for both manips at once */
+static void fastpath_nat(struct sk_buff *skb, const struct fastpath_flow *flow)
+{
+	struct iphdr *iph = ip_hdr(skb);
+	__be16 *ports = (__be16 *)skb_transport_header(skb);
+	__sum16 *check = NULL;
+
+	if (iph->protocol == IPPROTO_TCP) {
+		check = &tcp_hdr(skb)->check;
+	} else {
+		struct udphdr *uh = udp_hdr(skb);
+
+		if (uh->check || skb->ip_summed == CHECKSUM_PARTIAL)
+			check = &uh->check;
+	}
+
+	fastpath_nat_addr(skb, iph, check, &iph->saddr, flow->nat_saddr);
+	fastpath_nat_addr(skb, iph, check, &iph->daddr, flow->nat_daddr);
+	fastpath_nat_port(skb, check, &ports[0], flow->nat_sport);
+	fastpath_nat_port(skb, check, &ports[1], flow->nat_dport);
+
+	if (iph->protocol == IPPROTO_UDP && check && !*check)
+		*check = CSUM_MANGLED_0;
+}
+
+static unsigned int fastpath_in(void *priv, struct sk_buff *skb,
+				const struct nf_hook_state *state)
+{
+	struct fastpath_flow *flow;
+	const struct iphdr *iph;
+	struct net_device *outdev;
+	unsigned int thoff, hdrlen, mtu;
+	__be32 nexthop;
+
+	if (skb->pkt_type != PACKET_HOST)
+		return NF_ACCEPT;
+
+	iph = ip_hdr(skb);
+	if (iph->ihl != 5 || ip_is_fragment(iph) || iph->ttl <= 1)
+		return NF_ACCEPT;
+
+	if (iph->protocol == IPPROTO_TCP)
+		hdrlen = sizeof(struct tcphdr);
+	else if (iph->protocol == IPPROTO_UDP)
+		hdrlen = sizeof(struct udphdr);
+	else
+		return NF_ACCEPT;
+
+	thoff = sizeof(*iph);
+	if (!pskb_may_pull(skb, thoff + hdrlen))
+		return NF_ACCEPT;
+
+	iph = ip_hdr(skb);
+	flow = fastpath_lookup(state->in, iph,
+			       (__be16 *)(skb_network_header(skb) + thoff));
+	if (!flow)
+		return NF_ACCEPT;
+
+	if (iph->protocol == IPPROTO_TCP) {
+		const struct tcphdr *th = (const struct tcphdr *)
+					  (skb_network_header(skb) + thoff);
+
+		/* conntrack has to see the teardown */
+		if (unlikely(th->fin || th->rst)) {
+			fastpath_flow_remove(flow);
+			return NF_ACCEPT;
+		}
+	}
+
+	if (unlikely(!fastpath_flow_valid(flow))) {
+		fastpath_flow_remove(flow);
+		return NF_ACCEPT;
+	}
+
+	/* leave fragmentation and ICMP_FRAG_NEEDED to ip_forward() */
+	mtu = dst_mtu(flow->dst);
+	if (skb->len > mtu &&
+	    (!skb_is_gso(skb) || !skb_gso_validate_mtu(skb, mtu)))
+		return NF_ACCEPT;
+
+	outdev = flow->dst->dev;
+	if (skb_ensure_writable(skb, thoff + hdrlen) ||
+	    skb_cow_head(skb, LL_RESERVED_SPACE(outdev)))
+		return NF_ACCEPT;
+
+	skb_set_transport_header(skb, thoff);
+	fastpath_nat(skb, flow);
+	ip_decrease_ttl(ip_hdr(skb));
+	skb->priority = rt_tos2priority(ip_hdr(skb)->tos);
+
+	nf_ct_refresh_acct(flow->ct, flow->dir == IP_CT_DIR_ORIGINAL ?
+			   IP_CT_ESTABLISHED : IP_CT_ESTABLISHED_REPLY,
+			   skb, flow->timeout);
+
+	/* the flow holds the route until a grace period after its removal */
+	skb_dst_drop(skb);
+	skb_dst_set_noref(skb, flow->dst);
+	skb->dev = outdev;
+
+	nexthop = rt_nexthop((struct rtable *)flow->dst, ip_hdr(skb)->daddr);
+	neigh_xmit(NEIGH_ARP_TABLE, outdev, &nexthop, skb);
+
+	return NF_STOLEN;
+}
+
+static bool fastpath_ct_offloadable(const struct nf_conn *ct)
+{
+	if (nf_ct_l3num(ct) != AF_INET)
+		return false;
+	if (!test_bit(IPS_ASSURED_BIT, &ct->status) ||
+	    (ct->status & IPS_NAT_DONE_MASK) != IPS_NAT_DONE_MASK)
+		return false;
+	/* helpers and sequence adjustment need to see every packet */
+	if (nfct_help(ct) || nfct_seqadj(ct))
+		return false;
+
+	switch (nf_ct_protonum(ct)) {
+	case IPPROTO_TCP:
+		return ct->proto.tcp.state == TCP_CONNTRACK_ESTABLISHED;
+	case IPPROTO_UDP:
+		return true;
+	}
+
+	return false;
+}
+
+static void fastpath_flow_add(struct sk_buff *skb,
+			      const struct nf_hook_state *state,
+			      struct nf_conn *ct, enum ip_conntrack_dir dir)
+{
+	const struct nf_conntrack_tuple *orig = &ct->tuplehash[dir].tuple;
+	const struct nf_conntrack_tuple *repl = &ct->tuplehash[!dir].tuple;
+	struct dst_entry *dst = skb_dst(skb);
+	struct fastpath_flow *flow, *old;
+	struct net_device *indev;
+	u32 key;
+
+	if (!dst || dst_xfrm(dst))
+		return;
+
+	indev = dev_get_by_index_rcu(state->net, skb->skb_iif);
+	if (!indev)
+		return;
+
+	key = fastpath_key(indev, orig->src.u3.ip, orig->dst.u3.ip,
+			   orig->src.u.all, orig->dst.u.all,
+			   orig->dst.protonum);
+
+	flow = kzalloc(sizeof(*flow), GFP_ATOMIC);
+	if (!flow)
+		return;
+
+	flow->indev = indev;
+	flow->saddr = orig->src.u3.ip;
+	flow->daddr = orig->dst.u3.ip;
+	flow->sport = orig->src.u.all;
+	flow->dport = orig->dst.u.all;
+	flow->proto = orig->dst.protonum;
+	flow->dir = dir;
+	/* the reply tuple, inverted, is what leaves the box */
+	flow->nat_saddr = repl->dst.u3.ip;
+	flow->nat_daddr = repl->src.u3.ip;
+	flow->nat_sport = repl->dst.u.all;
+	flow->nat_dport = repl->src.u.all;
+	flow->timeout = nf_ct_expires(ct);
+
+	spin_lock_bh(&fastpath_lock);
+	if (fastpath_count >= max_flows)
+		goto out_free;
+	hash_for_each_possible(fastpath_hash, old, hnode, key) {
+		if (old->indev == flow->indev &&
+		    old->saddr == flow->saddr && old->daddr == flow->daddr &&
+		    old->sport == flow->sport && old->dport == flow->dport &&
+		    old->proto == flow->proto)
+			goto out_free;
+	}
+
+	dst_hold(dst);
+	flow->dst = dst;
+	nf_conntrack_get(&ct->ct_general);
+	flow->ct = ct;
+	hash_add_rcu(fastpath_hash, &flow->hnode, key);
+	fastpath_count++;
+	spin_unlock_bh(&fastpath_lock);
+
+	/*
+	 * conntrack no longer sees every segment, do not let it mark the
+	 * flow invalid once it comes back to the slow path.
+	 */
+	if (flow->proto == IPPROTO_TCP) {
+		spin_lock_bh(&ct->lock);
+		ct->proto.tcp.seen[0].flags |= IP_CT_TCP_FLAG_BE_LIBERAL;
+		ct->proto.tcp.seen[1].flags |= IP_CT_TCP_FLAG_BE_LIBERAL;
+		spin_unlock_bh(&ct->lock);
+	}
+	return;
+
+out_free:
+	spin_unlock_bh(&fastpath_lock);
+	kfree(flow);
+}
+
+/*
+ * Runs after every table, right before confirmation. Anything that
+ * reaches this point was accepted by the whole forwarding path.
+ */
+static unsigned int fastpath_out(void *priv, struct sk_buff *skb,
+				 const struct nf_hook_state *state)
+{
+	enum ip_conntrack_info ctinfo;
+	struct nf_conn *ct;
+
+	if (!(IPCB(skb)->flags & IPSKB_FORWARDED))
+		return NF_ACCEPT;
+
+	ct = nf_ct_get(skb, &ctinfo);
+	if (!ct || (ctinfo != IP_CT_ESTABLISHED &&
+		    ctinfo != IP_CT_ESTABLISHED_REPLY))
+		return NF_ACCEPT;
+
+	if (fastpath_ct_offloadable(ct))
+		fastpath_flow_add(skb, state, ct, CTINFO2DIR(ctinfo));
+
+	return NF_ACCEPT;
+}
+
+static struct nf_hook_ops fastpath_ops[] __read_mostly = {
+	{
+		.hook		= fastpath_in,
+		.pf		= NFPROTO_IPV4,
+		.hooknum	= NF_INET_PRE_ROUTING,
+		.priority	= NF_IP_PRI_CONNTRACK_DEFRAG - 1,
+	},
+	{
+		.hook		= fastpath_out,
+		.pf		= NFPROTO_IPV4,
+		.hooknum	= NF_INET_POST_ROUTING,
+		.priority	= NF_IP_PRI_CONNTRACK_CONFIRM - 1,
+	},
+};
+
+/* Drop the flows matching @dev, or all of them if @dev is NULL */
+static void fastpath_flush(const struct net_device *dev)
+{
+	struct fastpath_flow *flow;
+	struct hlist_node *tmp;
+	int bkt;
+
+	spin_lock_bh(&fastpath_lock);
+	hash_for_each_safe(fastpath_hash, bkt, tmp, flow, hnode) {
+		if (!dev || flow->indev == dev || flow->dst->dev == dev)
+			__fastpath_flow_remove(flow);
+	}
+	spin_unlock_bh(&fastpath_lock);
+}
+
+/* Flows nobody sends on any more would otherwise pin their conntrack */
+static void fastpath_gc_worker(struct work_struct *work)
+{
+	struct fastpath_flow *flow;
+	struct hlist_node *tmp;
+	int bkt;
+
+	spin_lock_bh(&fastpath_lock);
+	hash_for_each_safe(fastpath_hash, bkt, tmp, flow, hnode) {
+		if (!fastpath_flow_valid(flow))
+			__fastpath_flow_remove(flow);
+	}
+	spin_unlock_bh(&fastpath_lock);
+
+	queue_delayed_work(system_power_efficient_wq, &fastpath_gc_work,
+			   FASTPATH_GC_INTERVAL);
+}
+
+static int fastpath_netdev_event(struct notifier_block *this,
+				 unsigned long event, void *ptr)
+{
+	struct net_device *dev = netdev_notifier_info_to_dev(ptr);
+
+	/* flows hold a route through @dev, which pins it */
+	if (event == NETDEV_DOWN)
+		fastpath_flush(dev);
+
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block fastpath_netdev_notifier = {
+	.notifier_call	= fastpath_netdev_event,
+};
+
+static int __init nf_fastpath_ipv4_init(void)
+{
+	int ret;
+
+	get_random_bytes(&fastpath_rnd, sizeof(fastpath_rnd));
+	INIT_DEFERRABLE_WORK(&fastpath_gc_work, fastpath_gc_worker);
+
+	ret = register_netdevice_notifier(&fastpath_netdev_notifier);
+	if (ret)
+		return ret;
+
+	ret = nf_register_hooks(fastpath_ops, ARRAY_SIZE(fastpath_ops));
+	if (ret) {
+		unregister_netdevice_notifier(&fastpath_netdev_notifier);
+		return ret;
+	}
+
+	queue_delayed_work(system_power_efficient_wq, &fastpath_gc_work,
+			   FASTPATH_GC_INTERVAL);
+	return 0;
+}
+
+static void __exit nf_fastpath_ipv4_fini(void)
+{
+	nf_unregister_hooks(fastpath_ops, ARRAY_SIZE(fastpath_ops));
+	unregister_netdevice_notifier(&fastpath_netdev_notifier);
+	cancel_delayed_work_sync(&fastpath_gc_work);
+	fastpath_flush(NULL);
+	rcu_barrier();
+}
+
+module_init(nf_fastpath_ipv4_init);
+module_exit(nf_fastpath_ipv4_fini);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Software fast path for forwarded IPv4 flows");
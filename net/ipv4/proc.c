@@ -307,6 +307,9 @@ static const struct snmp_mib snmp4_net_list[] = {
 	SNMP_MIB_ITEM("TCPMTUPFail", LINUX_MIB_TCPMTUPFAIL),
 	SNMP_MIB_ITEM("TCPMTUPSuccess", LINUX_MIB_TCPMTUPSUCCESS),
 	SNMP_MIB_ITEM("TCPWqueueTooBig", LINUX_MIB_TCPWQUEUETOOBIG),
+	SNMP_MIB_ITEM("IP6SkDstHit", LINUX_MIB_IP6SKDSTHIT),
+	SNMP_MIB_ITEM("IP6SkDstRevalidated", LINUX_MIB_IP6SKDSTREVALIDATED),
+	SNMP_MIB_ITEM("IP6SkDstMiss", LINUX_MIB_IP6SKDSTMISS),
 	SNMP_MIB_SENTINEL
 };
 
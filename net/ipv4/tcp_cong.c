@@ -14,11 +14,27 @@
 #include <linux/list.h>
 #include <linux/gfp.h>
 #include <linux/jhash.h>
+#include <linux/netdevice.h>
 #include <net/tcp.h>
 
 static DEFINE_SPINLOCK(tcp_cong_list_lock);
 static LIST_HEAD(tcp_cong_list);
 
+/* Per interface defaults, matched by name prefix on the route's device */
+#define TCP_CA_IFACE_MAX	8
+
+struct tcp_ca_iface_map {
+	struct rcu_head	rcu;
+	int		nr;
+	struct {
+		char	prefix[IFNAMSIZ];
+		u32	key;
+	} ent[TCP_CA_IFACE_MAX];
+};
+
+static struct tcp_ca_iface_map __rcu *tcp_ca_iface_map;
+static DEFINE_MUTEX(tcp_ca_iface_mutex);
+
 /* Simple linear search, don't expect many entries! */
 static struct tcp_congestion_ops *tcp_ca_find(const char *name)
 {
@@ -332,6 +348,107 @@ int tcp_set_allowed_congestion_control(char *val)
 	return ret;
 }
 
+/* Change the per interface defaults, "<ifname prefix>:<name> ..." */
+int tcp_set_iface_congestion_control(char *val)
+{
+	struct tcp_ca_iface_map *map, *old;
+	char *entry, *name;
+	bool ecn_ca;
+	int ret = 0;
+	u32 key;
+
+	map = kzalloc(sizeof(*map), GFP_USER);
+	if (!map)
+		return -ENOMEM;
+
+	while ((entry = strsep(&val, " ")) != NULL) {
+		if (!*entry)
+			continue;
+
+		name = strchr(entry, ':');
+		if (!name || name == entry || name - entry >= IFNAMSIZ ||
+		    map->nr == TCP_CA_IFACE_MAX) {
+			ret = -EINVAL;
+			goto out;
+		}
+		*name++ = '\0';
+
+		key = tcp_ca_get_key_by_name(name, &ecn_ca);
+		if (key == TCP_CA_UNSPEC) {
+			ret = -ENOENT;
+			goto out;
+		}
+
+		strlcpy(map->ent[map->nr].prefix, entry, IFNAMSIZ);
+		map->ent[map->nr].key = key;
+		map->nr++;
+	}
+
+	if (!map->nr) {
+		kfree(map);
+		map = NULL;
+	}
+
+	mutex_lock(&tcp_ca_iface_mutex);
+	old = rcu_dereference_protected(tcp_ca_iface_map,
+					lockdep_is_held(&tcp_ca_iface_mutex));
+	rcu_assign_pointer(tcp_ca_iface_map, map);
+	mutex_unlock(&tcp_ca_iface_mutex);
+
+	if (old)
+		kfree_rcu(old, rcu);
+	return 0;
+out:
+	kfree(map);
+	return ret;
+}
+
+/* Build string with the per interface defaults */
+void tcp_get_iface_congestion_control(char *buf, size_t maxlen)
+{
+	const struct tcp_ca_iface_map *map;
+	char name[TCP_CA_NAME_MAX];
+	size_t offs = 0;
+	int i;
+
+	*buf = '\0';
+	rcu_read_lock();
+	map = rcu_dereference(tcp_ca_iface_map);
+	for (i = 0; map && i < map->nr; i++) {
+		/* its module may be gone since */
+		if (!tcp_ca_get_name_by_key(map->ent[i].key, name))
+			continue;
+		offs += snprintf(buf + offs, maxlen - offs,
+				 "%s%s:%s",
+				 offs == 0 ? "" : " ", map->ent[i].prefix, name);
+	}
+	rcu_read_unlock();
+}
+
+/* Default for connections routed over @dev, TCP_CA_UNSPEC if none */
+u32 tcp_ca_iface_key(const struct net_device *dev)
+{
+	const struct tcp_ca_iface_map *map;
+	u32 key = TCP_CA_UNSPEC;
+	int i;
+
+	if (!dev || !rcu_access_pointer(tcp_ca_iface_map))
+		return key;
+
+	rcu_read_lock();
+	map = rcu_dereference(tcp_ca_iface_map);
+	for (i = 0; map && i < map->nr; i++) {
+		if (!strncmp(dev->name, map->ent[i].prefix,
+			     strlen(map->ent[i].prefix))) {
+			key = map->ent[i].key;
+			break;
+		}
+	}
+	rcu_read_unlock();
+
+	return key;
+}
+
 /* Change congestion control for socket */
 int tcp_set_congestion_control(struct sock *sk, const char *name)
 {
@@ -480,6 +480,9 @@ void tcp_ca_openreq_child(struct sock *sk, const struct dst_entry *dst)
 	u32 ca_key = dst_metric(dst, RTAX_CC_ALGO);
 	bool ca_got_dst = false;
 
+	if (ca_key == TCP_CA_UNSPEC && !icsk->icsk_ca_setsockopt)
+		ca_key = tcp_ca_iface_key(dst->dev);
+
 	if (ca_key != TCP_CA_UNSPEC) {
 		const struct tcp_congestion_ops *ca;
 
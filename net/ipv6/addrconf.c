@@ -2982,7 +2982,7 @@ static void add_addr(struct inet6_dev *idev, const struct in6_addr *addr,
 		spin_lock_bh(&ifp->lock);
 		ifp->flags &= ~IFA_F_TENTATIVE;
 		spin_unlock_bh(&ifp->lock);
-		rt_genid_bump_ipv6(dev_net(idev->dev));
+		fib6_flush_trees_saddr(dev_net(idev->dev), &ifp->addr);
 		ipv6_ifa_notify(RTM_NEWADDR, ifp);
 		in6_ifa_put(ifp);
 	}
@@ -4100,7 +4100,7 @@ static void addrconf_dad_completed(struct inet6_ifaddr *ifp, bool bump_id)
 	}
 
 	if (bump_id)
-		rt_genid_bump_ipv6(dev_net(dev));
+		fib6_flush_trees_saddr(dev_net(dev), &ifp->addr);
 
 	/* Make sure that a new temporary address will be created
 	 * before this temporary address becomes deprecated.
@@ -5580,7 +5580,7 @@ static void __ipv6_ifa_notify(int event, struct inet6_ifaddr *ifp)
 			dst_hold(&ifp->rt->dst);
 			ip6_del_rt(ifp->rt);
 		}
-		rt_genid_bump_ipv6(net);
+		fib6_flush_trees_saddr(net, &ifp->addr);
 		break;
 	}
 	atomic_inc(&net->ipv6.dev_addr_genid);
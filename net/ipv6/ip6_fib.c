@@ -109,6 +109,80 @@ enum {
 	FIB6_NO_SERNUM_CHANGE = 0,
 };
 
+/*
+ * Change log
+ * ~~~~~~~~~~
+ * Every serial number handed out is logged along with what it changed, in
+ * the slot sernum % FIB6_CHANGE_LOG_SIZE, before it is written to any node.
+ * When a cached dst fails its cookie check, fib6_changes_unrelated() tells
+ * from the log whether the changes since the cookie was taken could have
+ * changed the lookup at all. A route added for another prefix or an address
+ * added or removed elsewhere can't, and the dst may be kept.
+ */
+static void fib6_log_change(struct net *net, int sernum, u8 type,
+			    const struct in6_addr *addr, int plen)
+{
+	struct fib6_change *c;
+
+	c = &net->ipv6.fib6_changes[sernum % FIB6_CHANGE_LOG_SIZE];
+
+	write_seqlock_bh(&net->ipv6.fib6_change_lock);
+	c->sernum = sernum;
+	c->type = type;
+	c->plen = plen;
+	if (addr)
+		c->addr = *addr;
+	write_sequnlock_bh(&net->ipv6.fib6_change_lock);
+}
+
+/* for invalidations that don't go through a serial number change */
+void fib6_change_log_all(struct net *net)
+{
+	fib6_log_change(net, fib6_new_sernum(net), FIB6_CHANGE_ALL, NULL, 0);
+}
+
+/*
+ * Could the tree changes that moved a node's serial number from @from to
+ * @to have changed the route from @saddr to @daddr? Answers "no" only when
+ * each of them is still in the log.
+ */
+bool fib6_changes_unrelated(struct net *net, u32 from, u32 to,
+			    const struct in6_addr *daddr,
+			    const struct in6_addr *saddr)
+{
+	int first = (int)from + 1, last = (int)to;
+	unsigned int seq;
+	bool unrelated;
+	int sernum;
+
+	/* negative advice and serial number wraps are never unrelated */
+	if ((int)from <= 0 || last < first ||
+	    last - first >= FIB6_CHANGE_LOG_SIZE)
+		return false;
+
+	do {
+		seq = read_seqbegin(&net->ipv6.fib6_change_lock);
+		unrelated = true;
+		for (sernum = first; unrelated && sernum <= last; sernum++) {
+			const struct fib6_change *c;
+
+			c = &net->ipv6.fib6_changes[sernum % FIB6_CHANGE_LOG_SIZE];
+			if (c->sernum != sernum)
+				unrelated = false;
+			else if (c->type == FIB6_CHANGE_DST)
+				unrelated = !ipv6_prefix_equal(&c->addr, daddr,
+							       c->plen);
+			else if (c->type == FIB6_CHANGE_SRC)
+				unrelated = !ipv6_addr_any(saddr) &&
+					    !ipv6_addr_equal(&c->addr, saddr);
+			else
+				unrelated = false;
+		}
+	} while (read_seqretry(&net->ipv6.fib6_change_lock, seq));
+
+	return unrelated;
+}
+
 /*
  *	Auxiliary address test functions for the radix tree.
  *
@@ -978,6 +1052,9 @@ int fib6_add(struct fib6_node *root, struct rt6_info *rt,
 	int replace_required = 0;
 	int sernum = fib6_new_sernum(info->nl_net);
 
+	fib6_log_change(info->nl_net, sernum, FIB6_CHANGE_DST,
+			&rt->rt6i_dst.addr, rt->rt6i_dst.plen);
+
 	if (WARN_ON_ONCE((rt->dst.flags & DST_NOCACHE) &&
 			 !atomic_read(&rt->dst.__refcnt)))
 		return -EINVAL;
@@ -1750,6 +1827,16 @@ static void fib6_flush_trees(struct net *net)
 {
 	int new_sernum = fib6_new_sernum(net);
 
+	fib6_log_change(net, new_sernum, FIB6_CHANGE_ALL, NULL, 0);
+	__fib6_clean_all(net, NULL, new_sernum, NULL);
+}
+
+/* fib6_flush_trees() for a change that only matters to users of @saddr */
+void fib6_flush_trees_saddr(struct net *net, const struct in6_addr *saddr)
+{
+	int new_sernum = fib6_new_sernum(net);
+
+	fib6_log_change(net, new_sernum, FIB6_CHANGE_SRC, saddr, 128);
 	__fib6_clean_all(net, NULL, new_sernum, NULL);
 }
 
@@ -1848,6 +1935,7 @@ static int __net_init fib6_net_init(struct net *net)
 
 	spin_lock_init(&net->ipv6.fib6_gc_lock);
 	rwlock_init(&net->ipv6.fib6_walker_lock);
+	seqlock_init(&net->ipv6.fib6_change_lock);
 	INIT_LIST_HEAD(&net->ipv6.fib6_walkers);
 	setup_timer(&net->ipv6.ip6_fib_timer, fib6_gc_timer_cb, (unsigned long)net);
 
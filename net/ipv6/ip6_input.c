@@ -46,9 +46,12 @@
 #include <net/xfrm.h>
 #include <net/inet_ecn.h>
 #include <net/dst_metadata.h>
+#include <net/rx_prof.h>
 
 int ip6_rcv_finish(struct net *net, struct sock *sk, struct sk_buff *skb)
 {
+	rx_prof_stamp(skb, RX_PROF_PREROUTING);
+
 	/* if ingress device is enslaved to an L3 master device pass the
 	 * skb to its handler for processing
 	 */
@@ -235,6 +238,8 @@ static int ip6_input_finish(struct net *net, struct sock *sk, struct sk_buff *sk
 	bool raw;
 	bool have_final = false;
 
+	rx_prof_stamp(skb, RX_PROF_LOCAL_IN);
+
 	/*
 	 *	Parse extension headers
 	 */
@@ -1113,14 +1113,43 @@ EXPORT_SYMBOL_GPL(ip6_dst_lookup_flow);
  *	It returns a valid dst pointer on success, or a pointer encoded
  *	error code.
  */
+/* sk_dst_check(), giving the dst a second chance on a cookie mismatch */
+static struct dst_entry *ip6_sk_dst_get(struct sock *sk, bool *revalidated)
+{
+	struct dst_entry *dst = sk_dst_get(sk);
+
+	*revalidated = false;
+	if (dst && dst->obsolete &&
+	    !dst->ops->check(dst, inet6_sk(sk)->dst_cookie)) {
+		*revalidated = rt6_sk_dst_revalidate(sk, dst);
+		if (!*revalidated) {
+			sk_dst_reset(sk);
+			dst_release(dst);
+			return NULL;
+		}
+	}
+	return dst;
+}
+
 struct dst_entry *ip6_sk_dst_lookup_flow(struct sock *sk, struct flowi6 *fl6,
 					 const struct in6_addr *final_dst)
 {
-	struct dst_entry *dst = sk_dst_check(sk, inet6_sk(sk)->dst_cookie);
+	bool cached = !!rcu_access_pointer(sk->sk_dst_cache);
+	struct net *net = sock_net(sk);
+	struct dst_entry *dst;
+	bool revalidated;
 
+	dst = ip6_sk_dst_get(sk, &revalidated);
 	dst = ip6_sk_dst_check(sk, dst, fl6);
-	if (!dst)
+	if (dst) {
+		NET_INC_STATS(net, LINUX_MIB_IP6SKDSTHIT);
+		if (revalidated)
+			NET_INC_STATS(net, LINUX_MIB_IP6SKDSTREVALIDATED);
+	} else {
+		if (cached)
+			NET_INC_STATS(net, LINUX_MIB_IP6SKDSTMISS);
 		dst = ip6_dst_lookup_flow(sk, fl6, final_dst);
+	}
 
 	return dst;
 }
@@ -1285,6 +1314,10 @@ static int ip6_setup_cork(struct sock *sk, struct inet_cork_full *cork,
 	if (mtu < IPV6_MIN_MTU)
 		return -EINVAL;
 	cork->base.fragsize = mtu;
+	/* only udpv6_sendmsg() fills in gso_size */
+	cork->base.gso_size = sk->sk_type == SOCK_DGRAM &&
+			      sk->sk_protocol == IPPROTO_UDP ?
+			      ipc6->gso_size : 0;
 	if (dst_allfrag(rt->dst.path))
 		cork->base.flags |= IPCORK_ALLFRAG;
 	cork->base.length = 0;
@@ -1318,6 +1351,7 @@ static int __ip6_append_data(struct sock *sk,
 	struct ipv6_txoptions *opt = v6_cork->opt;
 	int csummode = CHECKSUM_NONE;
 	unsigned int maxnonfragsize, headersize;
+	bool paged;
 
 	skb = skb_peek_tail(queue);
 	if (!skb) {
@@ -1325,8 +1359,10 @@ static int __ip6_append_data(struct sock *sk,
 		dst_exthdrlen = rt->dst.header_len - rt->rt6i_nfheader_len;
 	}
 
-	mtu = cork->fragsize;
+	/* a UDP_SEGMENT datagram is split into MTU sized packets by GSO */
+	mtu = cork->gso_size ? IP6_MAX_MTU : cork->fragsize;
 	orig_mtu = mtu;
+	paged = !!cork->gso_size;
 
 	hh_len = LL_RESERVED_SPACE(rt->dst.dev);
 
@@ -1368,13 +1404,15 @@ static int __ip6_append_data(struct sock *sk,
 	}
 
 	/* CHECKSUM_PARTIAL only with no extension headers and when
-	 * we are not going to fragment
+	 * we are not going to fragment. GSO completes the checksum of
+	 * each segment in software if the device cannot.
 	 */
 	if (transhdrlen && sk->sk_protocol == IPPROTO_UDP &&
 	    headersize == sizeof(struct ipv6hdr) &&
 	    length < mtu - headersize &&
-	    !(flags & MSG_MORE) &&
-	    rt->dst.dev->features & (NETIF_F_IPV6_CSUM | NETIF_F_HW_CSUM))
+	    (cork->gso_size ||
+	     (!(flags & MSG_MORE) &&
+	      rt->dst.dev->features & (NETIF_F_IPV6_CSUM | NETIF_F_HW_CSUM))))
 		csummode = CHECKSUM_PARTIAL;
 
 	if (sk->sk_type == SOCK_DGRAM || sk->sk_type == SOCK_RAW) {
@@ -1430,6 +1468,7 @@ static int __ip6_append_data(struct sock *sk,
 			unsigned int fraglen;
 			unsigned int fraggap;
 			unsigned int alloclen;
+			unsigned int pagedlen = 0;
 alloc_new_skb:
 			/* There's no room in the current skb */
 			if (skb)
@@ -1452,11 +1491,17 @@ static int __ip6_append_data(struct sock *sk,
 
 			if (datalen > (cork->length <= mtu && !(cork->flags & IPCORK_ALLFRAG) ? mtu : maxfraglen) - fragheaderlen)
 				datalen = maxfraglen - fragheaderlen - rt->dst.trailer_len;
-			if ((flags & MSG_MORE) &&
-			    !(rt->dst.dev->features&NETIF_F_SG))
+			if (paged) {
+				/* headers go linear, the payload into page frags */
+				alloclen = min_t(int, datalen + fragheaderlen,
+						 MAX_HEADER);
+				pagedlen = datalen + fragheaderlen - alloclen;
+			} else if ((flags & MSG_MORE) &&
+				   !(rt->dst.dev->features&NETIF_F_SG)) {
 				alloclen = mtu;
-			else
+			} else {
 				alloclen = datalen + fragheaderlen;
+			}
 
 			alloclen += dst_exthdrlen;
 
@@ -1478,7 +1523,7 @@ static int __ip6_append_data(struct sock *sk,
 			 */
 			alloclen += sizeof(struct frag_hdr);
 
-			copy = datalen - transhdrlen - fraggap;
+			copy = datalen - transhdrlen - fraggap - pagedlen;
 			if (copy < 0) {
 				err = -EINVAL;
 				goto error;
@@ -1518,7 +1563,7 @@ static int __ip6_append_data(struct sock *sk,
 			/*
 			 *	Find where to start putting bytes
 			 */
-			data = skb_put(skb, fraglen);
+			data = skb_put(skb, fraglen - pagedlen);
 			skb_set_network_header(skb, exthdrlen);
 			data += fragheaderlen;
 			skb->transport_header = (skb->network_header +
@@ -1541,7 +1586,7 @@ static int __ip6_append_data(struct sock *sk,
 			}
 
 			offset += copy;
-			length -= datalen - fraggap;
+			length -= copy + transhdrlen;
 			transhdrlen = 0;
 			exthdrlen = 0;
 			dst_exthdrlen = 0;
@@ -1804,9 +1849,9 @@ struct sk_buff *ip6_make_skb(struct sock *sk,
 			     void *from, int length, int transhdrlen,
 			     struct ipcm6_cookie *ipc6, struct flowi6 *fl6,
 			     struct rt6_info *rt, unsigned int flags,
+			     struct inet_cork_full *cork,
 			     const struct sockcm_cookie *sockc)
 {
-	struct inet_cork_full cork;
 	struct inet6_cork v6_cork;
 	struct sk_buff_head queue;
 	int exthdrlen = (ipc6->opt ? ipc6->opt->opt_flen : 0);
@@ -1817,27 +1862,27 @@ struct sk_buff *ip6_make_skb(struct sock *sk,
 
 	__skb_queue_head_init(&queue);
 
-	cork.base.flags = 0;
-	cork.base.addr = 0;
-	cork.base.opt = NULL;
-	cork.base.dst = NULL;
+	cork->base.flags = 0;
+	cork->base.addr = 0;
+	cork->base.opt = NULL;
+	cork->base.dst = NULL;
 	v6_cork.opt = NULL;
-	err = ip6_setup_cork(sk, &cork, &v6_cork, ipc6, rt, fl6);
+	err = ip6_setup_cork(sk, cork, &v6_cork, ipc6, rt, fl6);
 	if (err) {
-		ip6_cork_release(&cork, &v6_cork);
+		ip6_cork_release(cork, &v6_cork);
 		return ERR_PTR(err);
 	}
 	if (ipc6->dontfrag < 0)
 		ipc6->dontfrag = inet6_sk(sk)->dontfrag;
 
-	err = __ip6_append_data(sk, fl6, &queue, &cork.base, &v6_cork,
+	err = __ip6_append_data(sk, fl6, &queue, &cork->base, &v6_cork,
 				&current->task_frag, getfrag, from,
 				length + exthdrlen, transhdrlen + exthdrlen,
 				flags, ipc6, sockc);
 	if (err) {
-		__ip6_flush_pending_frames(sk, &queue, &cork, &v6_cork);
+		__ip6_flush_pending_frames(sk, &queue, cork, &v6_cork);
 		return ERR_PTR(err);
 	}
 
-	return __ip6_make_skb(sk, &queue, &cork, &v6_cork);
+	return __ip6_make_skb(sk, &queue, cork, &v6_cork);
 }
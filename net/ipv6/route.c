@@ -1308,6 +1308,35 @@ static struct dst_entry *ip6_dst_check(struct dst_entry *dst, u32 cookie)
 		return rt6_check(rt, cookie);
 }
 
+/*
+ * The dst cached on @sk failed its cookie check. Keep it, updating the
+ * socket's cookie, if the tree changes behind that can't have changed where
+ * packets from the socket's source to its peer are routed, and the route
+ * is still valid otherwise. Only enabled by the sk_dst_revalidate sysctl.
+ */
+bool rt6_sk_dst_revalidate(struct sock *sk, struct dst_entry *dst)
+{
+	struct net *net = sock_net(sk);
+	struct ipv6_pinfo *np = inet6_sk(sk);
+	u32 cookie;
+
+	if (!net->ipv6.sysctl.ip6_rt_sk_dst_revalidate ||
+	    dst->ops != &net->ipv6.ip6_dst_ops ||
+	    ipv6_addr_any(&sk->sk_v6_daddr))
+		return false;
+
+	cookie = rt6_get_cookie((struct rt6_info *)dst);
+	if (!fib6_changes_unrelated(net, np->dst_cookie, cookie,
+				    &sk->sk_v6_daddr, &np->saddr))
+		return false;
+
+	if (!ip6_dst_check(dst, cookie))
+		return false;
+
+	np->dst_cookie = cookie;
+	return true;
+}
+
 static struct dst_entry *ip6_negative_advice(struct dst_entry *dst)
 {
 	struct rt6_info *rt = (struct rt6_info *) dst;
@@ -1342,8 +1371,10 @@ static void ip6_link_failure(struct sk_buff *skb)
 
 			rcu_read_lock();
 			fn = rcu_dereference(rt->rt6i_node);
-			if (fn && (rt->rt6i_flags & RTF_DEFAULT))
+			if (fn && (rt->rt6i_flags & RTF_DEFAULT)) {
+				fib6_change_log_all(dev_net(rt->dst.dev));
 				fn->fn_sernum = -1;
+			}
 			rcu_read_unlock();
 		}
 	}
@@ -3630,6 +3661,13 @@ struct ctl_table ipv6_route_table_template[] = {
 		.mode		=	0644,
 		.proc_handler	=	proc_dointvec_ms_jiffies,
 	},
+	{
+		.procname	=	"sk_dst_revalidate",
+		.data		=	&init_net.ipv6.sysctl.ip6_rt_sk_dst_revalidate,
+		.maxlen		=	sizeof(int),
+		.mode		=	0644,
+		.proc_handler	=	proc_dointvec,
+	},
 	{ }
 };
 
@@ -3653,6 +3691,7 @@ struct ctl_table * __net_init ipv6_route_sysctl_init(struct net *net)
 		table[7].data = &net->ipv6.sysctl.ip6_rt_mtu_expires;
 		table[8].data = &net->ipv6.sysctl.ip6_rt_min_advmss;
 		table[9].data = &net->ipv6.sysctl.ip6_rt_gc_min_interval;
+		table[10].data = &net->ipv6.sysctl.ip6_rt_sk_dst_revalidate;
 
 		/* Don't export sysctls to unprivileged users */
 		if (net->user_ns != &init_user_ns)
@@ -0,0 +1,358 @@
+/* MPTCP cost-aware scheduler
+ *
+ * Fills the subflows going over cheap interfaces (Wi-Fi) first and only
+ * spills onto the costly ones (cellular) when the cheap paths do not meet
+ * the requested throughput or latency. The estimates come from the subflows'
+ * delivery rate samples (tcp_rate.c) and from their smoothed RTT over the
+ * path's minimum RTT, which approximates the queueing delay.
+ */
+
+#include <linux/module.h>
+#include <net/mptcp.h>
+
+static char costly_ifaces[64] __read_mostly = "rmnet";
+module_param_string(costly_ifaces, costly_ifaces, sizeof(costly_ifaces), 0644);
+MODULE_PARM_DESC(costly_ifaces, "Comma separated prefixes of the interfaces that are expensive to use");
+
+static unsigned int target_kbps __read_mostly;
+module_param(target_kbps, uint, 0644);
+MODULE_PARM_DESC(target_kbps, "Spill onto costly subflows while the cheap ones deliver less than this (0 = never)");
+
+static unsigned int latency_slo_ms __read_mostly = 150;
+module_param(latency_slo_ms, uint, 0644);
+MODULE_PARM_DESC(latency_slo_ms, "Spill onto costly subflows while the cheap ones queue more than this (0 = never)");
+
+enum {
+	COSTSCHED_UNKNOWN,
+	COSTSCHED_CHEAP,
+	COSTSCHED_COSTLY,
+};
+
+struct costsched_priv {
+	u8	cost;
+};
+
+struct costsched_cb {
+	u32	spill_until;	/* keep spilling until then, in tcp_time_stamp */
+};
+
+struct costsched_stats {
+	u32	rate_kbps;	/* sum over the cheap subflows */
+	u32	qdelay_us;	/* lowest over the cheap subflows */
+	u32	srtt_us;	/* highest over the cheap subflows */
+	bool	app_limited;
+	bool	busy;		/* a cheap subflow is only waiting for room */
+};
+
+static struct costsched_priv *costsched_get_priv(const struct tcp_sock *tp)
+{
+	return (struct costsched_priv *)&tp->mptcp->mptcp_sched[0];
+}
+
+static struct costsched_cb *costsched_get_cb(const struct tcp_sock *tp)
+{
+	return (struct costsched_cb *)&tp->mpcb->mptcp_sched[0];
+}
+
+static bool costsched_dev_is_costly(const struct net_device *dev)
+{
+	const char *p = costly_ifaces;
+
+	while (*p) {
+		size_t len = strcspn(p, ",");
+
+		if (len && !strncmp(dev->name, p, len))
+			return true;
+		p += len;
+		if (*p)
+			p++;
+	}
+
+	return false;
+}
+
+/* Classified once the subflow has a route, unknown ones count as cheap */
+static u8 costsched_cost(struct sock *sk)
+{
+	struct costsched_priv *csp = costsched_get_priv(tcp_sk(sk));
+	const struct dst_entry *dst;
+
+	if (csp->cost != COSTSCHED_UNKNOWN)
+		return csp->cost;
+
+	dst = __sk_dst_get(sk);
+	if (!dst || !dst->dev)
+		return COSTSCHED_CHEAP;
+
+	csp->cost = costsched_dev_is_costly(dst->dev) ?
+		    COSTSCHED_COSTLY : COSTSCHED_CHEAP;
+	return csp->cost;
+}
+
+/* Latest delivery rate sample of the subflow */
+static u32 costsched_rate_kbps(const struct tcp_sock *tp)
+{
+	u64 rate;
+
+	if (!tp->rate_interval_us)
+		return 0;
+
+	rate = (u64)tp->rate_delivered * tp->mss_cache * 8 * USEC_PER_MSEC;
+	return div_u64(rate, tp->rate_interval_us);
+}
+
+static u32 costsched_qdelay_us(const struct tcp_sock *tp)
+{
+	u32 srtt = tp->srtt_us >> 3;
+	u32 min_rtt = tcp_min_rtt(tp);
+
+	if (min_rtt == ~0U || srtt <= min_rtt)
+		return 0;
+	return srtt - min_rtt;
+}
+
+static void costsched_account(struct costsched_stats *st,
+			      const struct tcp_sock *tp)
+{
+	st->rate_kbps += costsched_rate_kbps(tp);
+	st->qdelay_us = min(st->qdelay_us, costsched_qdelay_us(tp));
+	st->srtt_us = max(st->srtt_us, tp->srtt_us >> 3);
+	st->app_limited |= tp->rate_app_limited;
+}
+
+/*
+ * The cheap subflows are busy. Spill when they miss the throughput target
+ * or queue beyond the latency SLO, and keep spilling for one of their RTTs
+ * so that the choice does not flap with every rate sample.
+ */
+static bool costsched_should_spill(struct mptcp_cb *mpcb,
+				   const struct costsched_stats *st)
+{
+	struct costsched_cb *ccb = costsched_get_cb(tcp_sk(mpcb->meta_sk));
+	bool spill = false;
+
+	if (target_kbps && !st->app_limited && st->rate_kbps < target_kbps)
+		spill = true;
+	if (latency_slo_ms && st->qdelay_us > latency_slo_ms * USEC_PER_MSEC)
+		spill = true;
+
+	if (spill) {
+		ccb->spill_until = tcp_time_stamp +
+				   max_t(u32, usecs_to_jiffies(st->srtt_us), 1);
+		return true;
+	}
+
+	return before(tcp_time_stamp, ccb->spill_until);
+}
+
+/* Are we not allowed to reinject this skb on tp? */
+static int costsched_dont_reinject_skb(const struct tcp_sock *tp,
+				       const struct sk_buff *skb)
+{
+	return skb &&
+		mptcp_pi_to_flag(tp->mptcp->path_index) & TCP_SKB_CB(skb)->path_mask;
+}
+
+static struct sock *costsched_get_subflow(struct sock *meta_sk,
+					  struct sk_buff *skb,
+					  bool zero_wnd_test)
+{
+	struct mptcp_cb *mpcb = tcp_sk(meta_sk)->mpcb;
+	struct sock *sk, *cheapsk = NULL, *costlysk = NULL, *backupsk = NULL;
+	struct sock *usedsk = NULL;
+	struct costsched_stats st = { .qdelay_us = ~0U };
+
+	/* if there is only one subflow, bypass the scheduling function */
+	if (mpcb->cnt_subflows == 1) {
+		sk = (struct sock *)mpcb->connection_list;
+		if (!mptcp_is_available(sk, skb, zero_wnd_test))
+			sk = NULL;
+		return sk;
+	}
+
+	/* Answer data_fin on same subflow!!! */
+	if (meta_sk->sk_shutdown & RCV_SHUTDOWN &&
+	    skb && mptcp_is_data_fin(skb)) {
+		mptcp_for_each_sk(mpcb, sk) {
+			if (tcp_sk(sk)->mptcp->path_index == mpcb->dfin_path_index &&
+			    mptcp_is_available(sk, skb, zero_wnd_test))
+				return sk;
+		}
+	}
+
+	mptcp_for_each_sk(mpcb, sk) {
+		struct tcp_sock *tp = tcp_sk(sk);
+		bool cheap;
+
+		if (mptcp_is_def_unavailable(sk))
+			continue;
+
+		cheap = subflow_is_active(tp) &&
+			costsched_cost(sk) == COSTSCHED_CHEAP;
+		if (cheap)
+			costsched_account(&st, tp);
+
+		if (!mptcp_is_available(sk, skb, zero_wnd_test)) {
+			if (cheap)
+				st.busy = true;
+			continue;
+		}
+
+		if (costsched_dont_reinject_skb(tp, skb)) {
+			usedsk = sk;
+			continue;
+		}
+
+		if (subflow_is_backup(tp)) {
+			if (!backupsk || tp->srtt_us < tcp_sk(backupsk)->srtt_us)
+				backupsk = sk;
+		} else if (cheap) {
+			if (!cheapsk || tp->srtt_us < tcp_sk(cheapsk)->srtt_us)
+				cheapsk = sk;
+		} else {
+			if (!costlysk || tp->srtt_us < tcp_sk(costlysk)->srtt_us)
+				costlysk = sk;
+		}
+	}
+
+	if (cheapsk)
+		return cheapsk;
+
+	if (costlysk && (!st.busy || costsched_should_spill(mpcb, &st)))
+		return costlysk;
+
+	/* waiting for room on a cheap subflow beats using a costly one */
+	if (st.busy)
+		return NULL;
+
+	if (backupsk)
+		return backupsk;
+
+	if (usedsk) {
+		/* It has been sent on all subflows once - let's give it a
+		 * chance again by restarting its pathmask.
+		 */
+		if (skb)
+			TCP_SKB_CB(skb)->path_mask = 0;
+		return usedsk;
+	}
+
+	return NULL;
+}
+
+/* Returns the next segment to be sent from the mptcp meta-queue.
+ * (chooses the reinject queue if any segment is waiting in it, otherwise,
+ * chooses the normal write queue).
+ * Sets *@reinject to 1 if the returned segment comes from the
+ * reinject queue. Sets it to 0 if it is the regular send-head of the meta-sk.
+ */
+static struct sk_buff *__costsched_next_segment(const struct sock *meta_sk,
+						int *reinject)
+{
+	const struct mptcp_cb *mpcb = tcp_sk(meta_sk)->mpcb;
+	struct sk_buff *skb;
+
+	*reinject = 0;
+
+	/* If we are in fallback-mode, just take from the meta-send-queue */
+	if (mpcb->infinite_mapping_snd || mpcb->send_infinite_mapping)
+		return tcp_send_head(meta_sk);
+
+	skb = skb_peek(&mpcb->reinject_queue);
+
+	if (skb)
+		*reinject = 1;
+	else
+		skb = tcp_send_head(meta_sk);
+	return skb;
+}
+
+static struct sk_buff *costsched_next_segment(struct sock *meta_sk,
+					      int *reinject,
+					      struct sock **subsk,
+					      unsigned int *limit)
+{
+	struct sk_buff *skb = __costsched_next_segment(meta_sk, reinject);
+	unsigned int mss_now;
+	struct tcp_sock *subtp;
+	u16 gso_max_segs;
+	u32 max_len, max_segs, window;
+
+	/* As we set it, we have to reset it as well. */
+	*limit = 0;
+
+	if (!skb)
+		return NULL;
+
+	*subsk = costsched_get_subflow(meta_sk, skb, false);
+	if (!*subsk)
+		return NULL;
+
+	subtp = tcp_sk(*subsk);
+	mss_now = tcp_current_mss(*subsk);
+
+	if (!*reinject && unlikely(!tcp_snd_wnd_test(tcp_sk(meta_sk), skb, mss_now)))
+		return NULL;
+
+	/* No splitting required, as we will only send one single segment */
+	if (skb->len <= mss_now)
+		return skb;
+
+	/* Same as mptcp_next_segment(): limit to the cwnd/gso-size first,
+	 * then to the subflow's window.
+	 */
+	gso_max_segs = (*subsk)->sk_gso_max_segs;
+	if (!gso_max_segs) /* No gso supported on the subflow's NIC */
+		gso_max_segs = 1;
+	max_segs = min_t(unsigned int, tcp_cwnd_test(subtp, skb), gso_max_segs);
+	if (!max_segs)
+		return NULL;
+
+	max_len = mss_now * max_segs;
+	window = tcp_wnd_end(subtp) - subtp->write_seq;
+
+	if (max_len <= skb->len)
+		*limit = max_len;
+	else
+		*limit = min(skb->len, window);
+
+	return skb;
+}
+
+static void costsched_init(struct sock *sk)
+{
+	struct costsched_priv *csp = costsched_get_priv(tcp_sk(sk));
+
+	csp->cost = COSTSCHED_UNKNOWN;
+}
+
+static struct mptcp_sched_ops mptcp_sched_costaware = {
+	.get_subflow = costsched_get_subflow,
+	.next_segment = costsched_next_segment,
+	.init = costsched_init,
+	.name = "costaware",
+	.owner = THIS_MODULE,
+};
+
+static int __init costsched_register(void)
+{
+	BUILD_BUG_ON(sizeof(struct costsched_priv) > MPTCP_SCHED_SIZE);
+	BUILD_BUG_ON(sizeof(struct costsched_cb) > MPTCP_SCHED_DATA_SIZE);
+
+	if (mptcp_register_scheduler(&mptcp_sched_costaware))
+		return -1;
+
+	return 0;
+}
+
+static void costsched_unregister(void)
+{
+	mptcp_unregister_scheduler(&mptcp_sched_costaware);
+}
+
+module_init(costsched_register);
+module_exit(costsched_unregister);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Cost-aware MPTCP scheduler");
+MODULE_VERSION("0.1");
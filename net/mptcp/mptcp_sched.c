@@ -71,6 +71,10 @@ static bool mptcp_is_temp_unavailable(struct sock *sk,
 	if (test_bit(TSQ_THROTTLED, &tp->tsq_flags))
 		return true;
 
+	/* Same while the subflow waits for its pacing timer */
+	if (tcp_pacing_check(sk))
+		return true;
+
 	in_flight = tcp_packets_in_flight(tp);
 	/* Not even a single spot in the cwnd */
 	if (in_flight >= tp->snd_cwnd)
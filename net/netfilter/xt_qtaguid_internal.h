@@ -11,6 +11,7 @@
 #define __XT_QTAGUID_INTERNAL_H__
 
 #include <linux/types.h>
+#include <linux/percpu.h>
 #include <linux/rbtree.h>
 #include <linux/spinlock_types.h>
 #include <linux/workqueue.h>
@@ -197,6 +198,27 @@ static inline uint64_t dc_sum_packets(struct data_counters *counters,
 		+ counters->bpc[set][direction][IFS_PROTO_OTHER].packets;
 }
 
+/* Fold the per-cpu copies of @pcpu_counters into @counters for printing */
+static inline void dc_read_percpu(struct data_counters *counters,
+				  struct data_counters __percpu *pcpu_counters)
+{
+	int cpu, set, dir, proto;
+
+	memset(counters, 0, sizeof(*counters));
+	for_each_possible_cpu(cpu) {
+		struct data_counters *dc = per_cpu_ptr(pcpu_counters, cpu);
+
+		for (set = 0; set < IFS_MAX_COUNTER_SETS; set++)
+			for (dir = 0; dir < IFS_MAX_DIRECTIONS; dir++)
+				for (proto = 0; proto < IFS_MAX_PROTOS; proto++) {
+					counters->bpc[set][dir][proto].bytes +=
+						dc->bpc[set][dir][proto].bytes;
+					counters->bpc[set][dir][proto].packets +=
+						dc->bpc[set][dir][proto].packets;
+				}
+	}
+}
+
 
 /* Generic X based nodes used as a base for rb_tree ops */
 struct tag_node {
@@ -204,25 +226,29 @@ struct tag_node {
 	tag_t tag;
 };
 
+/*
+ * The counters are per-cpu so that the match path only has to take
+ * tag_stat_list_lock for reading. They are only summed up when printed.
+ */
 struct tag_stat {
 	struct tag_node tn;
-	struct data_counters counters;
+	struct data_counters __percpu *counters;
 	/*
 	 * If this tag is acct_tag based, we need to count against the
 	 * matching parent uid_tag.
 	 */
-	struct data_counters *parent_counters;
+	struct data_counters __percpu *parent_counters;
 };
 
 struct iface_stat {
-	struct list_head list;  /* in iface_stat_list */
+	struct list_head list;  /* in iface_stat_list, RCU for the match path */
 	char *ifname;
 	bool active;
 	/* net_dev is only valid for active iface_stat */
 	struct net_device *net_dev;
 
 	struct byte_packet_counters totals_via_dev[IFS_MAX_DIRECTIONS];
-	struct data_counters totals_via_skb;
+	struct data_counters __percpu *totals_via_skb;
 	/*
 	 * We keep the last_known, because some devices reset their counters
 	 * just before NETDEV_UP, while some will reset just before
@@ -238,7 +264,8 @@ struct iface_stat {
 	struct proc_dir_entry *proc_ptr;
 
 	struct rb_root tag_stat_tree;
-	spinlock_t tag_stat_list_lock;
+	/* Only taken for writing when an entry is added or deleted */
+	rwlock_t tag_stat_list_lock;
 };
 
 /* This is needed to create proc_dir_entries from atomic context. */
@@ -255,6 +282,9 @@ struct iface_stat_work {
  */
 struct sock_tag {
 	struct rb_node sock_node;
+	/* in sock_tag_hash, looked up under RCU by the match path */
+	struct hlist_node hash_node;
+	struct rcu_head rcu;
 	struct sock *sk;  /* Only used as a number, never dereferenced */
 	/* Used to associate with a given pid */
 	struct list_head list;   /* in proc_qtu_data.sock_tag_list */
@@ -107,6 +107,7 @@ static void update_mask_value(void __iomem *sfr,
 #define CALLIOPE_ENABLE_TIMEOUT_MS	(1000)
 #define IPC_TIMEOUT_US			(10000)
 #define BOOT_DONE_TIMEOUT_MS		(10000)
+#define VTS_PREWARM_TIMEOUT_MS		(3000)
 #define IPC_RETRY			(10)
 
 #define DMA_VOL_FACTOR_MAX_STEPS	(0xFFFFFF)
@@ -4590,6 +4591,8 @@ static void abox_system_ipc_handler(struct device *dev,
 	case ABOX_REPORT_LOG:
 		ret = abox_log_register_buffer(dev, system_msg->param1,
 				abox_addr_to_kernel_addr(data,
+				system_msg->param2),
+				abox_addr_to_phys_addr(data,
 				system_msg->param2));
 		if (ret < 0) {
 			dev_err(dev, "log buffer registration failed: %u, %u\n",
@@ -4722,7 +4725,7 @@ static void abox_playback_ipc_handler(struct device *dev,
 	switch (pcmtask_msg->msgtype) {
 	case PCM_PLTDAI_POINTER:
 		platform_data->pointer = pcmtask_msg->param.pointer;
-		snd_pcm_period_elapsed(platform_data->substream);
+		abox_platform_period_elapsed(platform_data);
 		break;
 	case PCM_PLTDAI_ACK:
 		platform_data->ack_enabled = !!pcmtask_msg->param.trigger;
@@ -4757,7 +4760,7 @@ static void abox_capture_ipc_handler(struct device *dev,
 	switch (pcmtask_msg->msgtype) {
 	case PCM_PLTDAI_POINTER:
 		platform_data->pointer = pcmtask_msg->param.pointer;
-		snd_pcm_period_elapsed(platform_data->substream);
+		abox_platform_period_elapsed(platform_data);
 		break;
 	case PCM_PLTDAI_ACK:
 		platform_data->ack_enabled = !!pcmtask_msg->param.trigger;
@@ -5833,6 +5836,45 @@ static int abox_modem_notifier(struct notifier_block *nb,
 	return NOTIFY_DONE;
 }
 
+static void abox_vts_prewarm_work_func(struct work_struct *work)
+{
+	struct delayed_work *dwork = to_delayed_work(work);
+	struct abox_data *data = container_of(dwork, struct abox_data,
+			vts_prewarm_work);
+	struct device *dev = &data->pdev->dev;
+
+	dev_dbg(dev, "%s\n", __func__);
+
+	abox_request_cpu_gear(dev, data, ABOX_CPU_GEAR_VTS, ABOX_CPU_GEAR_MIN);
+}
+
+static int abox_vts_notifier(struct notifier_block *nb,
+		unsigned long action, void *nb_data)
+{
+	struct abox_data *data = container_of(nb, struct abox_data, vts_nb);
+	struct device *dev = &data->pdev->dev;
+	struct vts_trigger_info *info = nb_data;
+
+	dev_info(dev, "%s(%lu)\n", __func__, action);
+
+	switch (action) {
+	case VTS_EVENT_TRIGGERED:
+		/*
+		 * Capture of the keyword follows shortly. Power up and boot
+		 * ABOX now instead of when userspace opens the stream. The
+		 * DAIs take their own gear requests once they start.
+		 */
+		dev_dbg(dev, "pre-roll: %u frames\n", info->frame_count);
+		abox_request_cpu_gear(dev, data, ABOX_CPU_GEAR_VTS,
+				ABOX_CPU_GEAR_MAX);
+		mod_delayed_work(system_wq, &data->vts_prewarm_work,
+				msecs_to_jiffies(VTS_PREWARM_TIMEOUT_MS));
+		break;
+	}
+
+	return NOTIFY_DONE;
+}
+
 #ifdef CONFIG_EXYNOS_ITMON
 static int abox_itmon_notifier(struct notifier_block *nb,
 		unsigned long action, void *nb_data)
@@ -5989,6 +6031,7 @@ static int samsung_abox_probe(struct platform_device *pdev)
 	INIT_WORK(&data->boot_done_work, abox_boot_done_work_func);
 	INIT_WORK(&data->l2c_work, abox_l2c_work_func);
 	INIT_DELAYED_WORK(&data->tickle_work, abox_tickle_work_func);
+	INIT_DELAYED_WORK(&data->vts_prewarm_work, abox_vts_prewarm_work_func);
 	INIT_LIST_HEAD(&data->irq_actions);
 
 	data->gear_workqueue = alloc_ordered_workqueue("abox_gear",
@@ -6212,6 +6255,9 @@ static int samsung_abox_probe(struct platform_device *pdev)
 	data->modem_nb.notifier_call = abox_modem_notifier;
 	register_modem_event_notifier(&data->modem_nb);
 
+	data->vts_nb.notifier_call = abox_vts_notifier;
+	vts_register_notifier(&data->vts_nb);
+
 #ifdef CONFIG_EXYNOS_ITMON
 	data->itmon_nb.notifier_call = abox_itmon_notifier;
 	itmon_notifier_chain_register(&data->itmon_nb);
@@ -6258,6 +6304,8 @@ static int samsung_abox_remove(struct platform_device *pdev)
 #ifndef CONFIG_PM
 	abox_runtime_suspend(dev);
 #endif
+	vts_unregister_notifier(&data->vts_nb);
+	flush_delayed_work(&data->vts_prewarm_work);
 	device_init_wakeup(dev, false);
 	destroy_workqueue(data->ipc_workqueue);
 	pm_qos_remove_request(&abox_pm_qos_aud);
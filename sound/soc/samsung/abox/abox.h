@@ -381,6 +381,7 @@
 #define ABOX_CPU_GEAR_CALL		ABOX_CPU_GEAR_CALL_VSS
 #define ABOX_CPU_GEAR_ABSOLUTE		(0xABC0ABC0)
 #define ABOX_CPU_GEAR_BOOT		(0xB00D)
+#define ABOX_CPU_GEAR_VTS		(0x7E55)
 #define ABOX_CPU_GEAR_MAX		(1)
 #define ABOX_CPU_GEAR_MIN		(12)
 #define ABOX_CPU_GEAR_DAI		0xDA100000
@@ -635,6 +636,8 @@ struct abox_data {
 	struct notifier_block pm_nb;
 	struct notifier_block modem_nb;
 	struct notifier_block itmon_nb;
+	struct notifier_block vts_nb;
+	struct delayed_work vts_prewarm_work;
 	int pm_qos_int[5];
 	int pm_qos_aud[5];
 	struct ima_client *ima_client;
@@ -670,6 +673,7 @@ struct abox_compr_data {
 	bool start;
 	bool eos;
 	bool created;
+	bool deep_buffer;
 
 	bool effect_on;
 
@@ -828,6 +832,49 @@ struct abox_platform_data {
 	enum abox_buffer_type buf_type;
 };
 
+/**
+ * check whether the stream of a rdma or wdma runs in MMAP exclusive mode
+ * @param[in]	data	pointer to abox_platform_data structure
+ * @return	true if the stream asked for no period wakeup
+ */
+static inline bool abox_platform_no_period_wakeup(
+		struct abox_platform_data *data)
+{
+	struct snd_pcm_substream *substream = data->substream;
+
+	return substream && substream->runtime &&
+			substream->runtime->no_period_wakeup;
+}
+
+/**
+ * report a period elapsed by the firmware to ALSA
+ * Streams in MMAP exclusive mode read their position from the DMA on
+ * demand, so the report is dropped for them.
+ * @param[in]	data	pointer to abox_platform_data structure
+ */
+static inline void abox_platform_period_elapsed(
+		struct abox_platform_data *data)
+{
+	if (!abox_platform_no_period_wakeup(data))
+		snd_pcm_period_elapsed(data->substream);
+}
+
+/**
+ * let a stream on the shared ION buffer run without period wakeups
+ * Only the streams whose position can be read from the DMA status qualify.
+ * @param[in]	data	pointer to abox_platform_data structure
+ * @param[in]	runtime	runtime of the stream being opened
+ */
+static inline void abox_platform_set_mmap_exclusive(
+		struct abox_platform_data *data,
+		struct snd_pcm_runtime *runtime)
+{
+	if ((data->buf_type == BUFFER_TYPE_ION) &&
+			((data->type == PLATFORM_NORMAL) ||
+			(data->type == PLATFORM_SYNC)))
+		runtime->hw.info |= SNDRV_PCM_INFO_NO_PERIOD_WAKEUP;
+}
+
 /**
  * get pointer to abox_data (internal use only)
  * @return	pointer to abox_data
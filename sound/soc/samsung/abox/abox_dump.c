@@ -478,7 +478,8 @@ void abox_dump_period_elapsed(int id, size_t pointer)
 	dev_dbg(dev, "%s[%d](%zx)\n", __func__, id, pointer);
 
 	info->pointer = pointer;
-	schedule_work(&info->auto_work);
+	if (info->auto_started)
+		schedule_work(&info->auto_work);
 	snd_pcm_period_elapsed(info->substream);
 }
 EXPORT_SYMBOL(abox_dump_period_elapsed);
@@ -10,6 +10,7 @@
  */
 /* #define DEBUG */
 #include <linux/debugfs.h>
+#include <linux/mm.h>
 #include <linux/mutex.h>
 #include <linux/vmalloc.h>
 #include <sound/samsung/abox.h>
@@ -45,8 +46,11 @@ struct abox_log_buffer_info {
 	bool file_created;
 	atomic_t opened;
 	ssize_t file_index;
+	atomic_t mmap_opened;
+	unsigned int mmap_index;
 	struct mutex lock;
 	struct ABOX_LOG_BUFFER *log_buffer;
+	phys_addr_t log_phys;
 	struct abox_log_kernel_buffer kernel_buffer;
 };
 
@@ -131,6 +135,12 @@ static void abox_log_file_save(struct device *dev,
 
 }
 
+/* A reader of the mmap file alone doesn't need the kernel buffer copy */
+static bool abox_log_mmap_only(struct abox_log_buffer_info *info)
+{
+	return atomic_read(&info->mmap_opened) && !atomic_read(&info->opened);
+}
+
 static void abox_log_flush(struct device *dev,
 		struct abox_log_buffer_info *info)
 {
@@ -150,6 +160,11 @@ static void abox_log_flush(struct device *dev,
 	if (abox_log_auto_save)
 		abox_log_file_save(dev, info);
 
+	if (abox_log_mmap_only(info)) {
+		log_buffer->index_reader = index_writer;
+		goto unlock;
+	}
+
 	if (log_buffer->index_reader > index_writer) {
 		abox_log_memcpy(info->dev, kernel_buffer,
 				log_buffer->buffer + log_buffer->index_reader,
@@ -160,6 +175,7 @@ static void abox_log_flush(struct device *dev,
 			log_buffer->buffer + log_buffer->index_reader,
 			index_writer - log_buffer->index_reader);
 	log_buffer->index_reader = index_writer;
+unlock:
 	mutex_unlock(&info->lock);
 
 	kernel_buffer->updated = true;
@@ -322,6 +338,123 @@ static const struct file_operations abox_log_fops = {
 	.owner = THIS_MODULE,
 };
 
+static int abox_log_mmap_file_open(struct inode *inode, struct file *file)
+{
+	struct abox_log_buffer_info *info = inode->i_private;
+
+	dev_dbg(info->dev, "%s\n", __func__);
+
+	if (atomic_cmpxchg(&info->mmap_opened, 0, 1))
+		return -EBUSY;
+
+	info->mmap_index = READ_ONCE(info->log_buffer->index_writer);
+	file->private_data = info;
+
+	return nonseekable_open(inode, file);
+}
+
+static int abox_log_mmap_file_release(struct inode *inode, struct file *file)
+{
+	struct abox_log_buffer_info *info = inode->i_private;
+
+	dev_dbg(info->dev, "%s\n", __func__);
+
+	atomic_cmpxchg(&info->mmap_opened, 1, 0);
+
+	return 0;
+}
+
+static bool abox_log_mmap_updated(struct abox_log_buffer_info *info)
+{
+	return READ_ONCE(info->log_buffer->index_writer) != info->mmap_index;
+}
+
+/*
+ * Waits until the firmware wrote more log, then reports the position as
+ * "<offset of the log buffer in the mapping> <index_writer> <size>".
+ */
+static ssize_t abox_log_mmap_file_read(struct file *file, char __user *buf,
+		size_t count, loff_t *ppos)
+{
+	struct abox_log_buffer_info *info = file->private_data;
+	struct ABOX_LOG_BUFFER *log_buffer = info->log_buffer;
+	unsigned int index;
+	char str[48];
+	int len, ret;
+
+	dev_dbg(info->dev, "%s(%zu)\n", __func__, count);
+
+	if (!abox_log_mmap_updated(info)) {
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+
+		ret = wait_event_interruptible(info->kernel_buffer.wq,
+				abox_log_mmap_updated(info));
+		if (ret != 0)
+			return ret;
+	}
+
+	index = READ_ONCE(log_buffer->index_writer);
+	len = scnprintf(str, sizeof(str), "%lu %u %u\n",
+			offset_in_page(info->log_phys), index,
+			log_buffer->size);
+	if (count < len)
+		return -EINVAL;
+	if (copy_to_user(buf, str, len))
+		return -EFAULT;
+
+	info->mmap_index = index;
+
+	return len;
+}
+
+static unsigned int abox_log_mmap_file_poll(struct file *file,
+		poll_table *wait)
+{
+	struct abox_log_buffer_info *info = file->private_data;
+
+	dev_dbg(info->dev, "%s\n", __func__);
+
+	poll_wait(file, &info->kernel_buffer.wq, wait);
+	return abox_log_mmap_updated(info) ? (POLLIN | POLLRDNORM) : 0;
+}
+
+/* Maps the shared log buffer, header included, read only */
+static int abox_log_mmap_file_mmap(struct file *file,
+		struct vm_area_struct *vma)
+{
+	struct abox_log_buffer_info *info = file->private_data;
+	phys_addr_t start = round_down(info->log_phys, PAGE_SIZE);
+	size_t size = PAGE_ALIGN(offset_in_page(info->log_phys) +
+			sizeof(*info->log_buffer) + info->log_buffer->size);
+	unsigned long len = vma->vm_end - vma->vm_start;
+
+	dev_dbg(info->dev, "%s(%lu)\n", __func__, len);
+
+	if (!info->log_phys)
+		return -ENODEV;
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	if (vma->vm_pgoff || len > size)
+		return -EINVAL;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_page_prot = pgprot_writecombine(vma->vm_page_prot);
+
+	return remap_pfn_range(vma, vma->vm_start, PHYS_PFN(start), len,
+			vma->vm_page_prot);
+}
+
+static const struct file_operations abox_log_mmap_fops = {
+	.open = abox_log_mmap_file_open,
+	.release = abox_log_mmap_file_release,
+	.read = abox_log_mmap_file_read,
+	.poll = abox_log_mmap_file_poll,
+	.mmap = abox_log_mmap_file_mmap,
+	.llseek = no_llseek,
+	.owner = THIS_MODULE,
+};
+
 static struct abox_log_buffer_info abox_log_buffer_info_new;
 
 void abox_log_register_buffer_work_func(struct work_struct *work)
@@ -329,15 +462,18 @@ void abox_log_register_buffer_work_func(struct work_struct *work)
 	struct device *dev;
 	int id;
 	struct ABOX_LOG_BUFFER *buffer;
+	phys_addr_t addr;
 	struct abox_log_buffer_info *info;
 	char name[16];
 
 	dev = abox_log_buffer_info_new.dev;
 	id = abox_log_buffer_info_new.id;
 	buffer = abox_log_buffer_info_new.log_buffer;
+	addr = abox_log_buffer_info_new.log_phys;
 	abox_log_buffer_info_new.dev = NULL;
 	abox_log_buffer_info_new.id = 0;
 	abox_log_buffer_info_new.log_buffer = NULL;
+	abox_log_buffer_info_new.log_phys = 0;
 
 	dev_info(dev, "%s(%d)\n", __func__, id);
 
@@ -346,24 +482,29 @@ void abox_log_register_buffer_work_func(struct work_struct *work)
 	info->id = id;
 	info->file_created = false;
 	atomic_set(&info->opened, 0);
+	atomic_set(&info->mmap_opened, 0);
 	info->kernel_buffer.buffer = vzalloc(SIZE_OF_BUFFER);
 	info->kernel_buffer.index = 0;
 	info->kernel_buffer.wrap = false;
 	init_waitqueue_head(&info->kernel_buffer.wq);
 	info->dev = dev;
 	info->log_buffer = buffer;
+	info->log_phys = addr;
 	list_add_tail(&info->list, &abox_log_list_head);
 
 	snprintf(name, sizeof(name), "log-%02d", id);
 	debugfs_create_file(name, 0664, abox_dbg_get_root_dir(), info,
 			&abox_log_fops);
+	snprintf(name, sizeof(name), "log_mmap-%02d", id);
+	debugfs_create_file(name, 0444, abox_dbg_get_root_dir(), info,
+			&abox_log_mmap_fops);
 }
 
 static DECLARE_WORK(abox_log_register_buffer_work,
 		abox_log_register_buffer_work_func);
 
 int abox_log_register_buffer(struct device *dev, int id,
-		struct ABOX_LOG_BUFFER *buffer)
+		struct ABOX_LOG_BUFFER *buffer, phys_addr_t addr)
 {
 	struct abox_log_buffer_info *info;
 
@@ -385,6 +526,7 @@ int abox_log_register_buffer(struct device *dev, int id,
 	abox_log_buffer_info_new.dev = dev;
 	abox_log_buffer_info_new.id = id;
 	abox_log_buffer_info_new.log_buffer = buffer;
+	abox_log_buffer_info_new.log_phys = addr;
 	schedule_work(&abox_log_register_buffer_work);
 
 	return 0;
@@ -434,7 +576,7 @@ static int __init samsung_abox_log_late_initcall(void)
 #ifdef TEST
 	abox_log_test_buffer = vzalloc(SZ_128);
 	abox_log_test_buffer->size = SZ_64;
-	abox_log_register_buffer(NULL, 0, abox_log_test_buffer);
+	abox_log_register_buffer(NULL, 0, abox_log_test_buffer, 0);
 	schedule_delayed_work(&abox_log_test_work, msecs_to_jiffies(1000));
 #endif
 
@@ -45,9 +45,10 @@ extern void abox_log_flush_by_id(struct device *dev, int id);
  * @param[in]	dev		pointer to abox device
  * @param[in]	id		unique buffer id
  * @param[in]	buffer		pointer to shared buffer
+ * @param[in]	addr		physical address of the shared buffer
  * @return	error code if any
  */
 extern int abox_log_register_buffer(struct device *dev, int id,
-		struct ABOX_LOG_BUFFER *buffer);
+		struct ABOX_LOG_BUFFER *buffer, phys_addr_t addr);
 
 #endif /* __SND_SOC_ABOX_LOG_H */
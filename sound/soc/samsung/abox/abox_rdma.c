@@ -132,6 +132,47 @@ static const struct snd_compr_caps abox_rdma_compr_caps = {
 	},
 };
 
+/*
+ * Deep buffer playback: the whole IOVA window of the stream is used as the
+ * compressed ring, so a few large writes carry tens of seconds of MP3/AAC,
+ * and the writer is only woken when the firmware drained the ring down to
+ * the low watermark.
+ */
+#define COMPR_DEEP_BUFFER_BYTES		(SZ_1M)
+#define COMPR_DEEP_FRAGMENT_BYTES	(SZ_256K)
+#define COMPR_DEEP_BUFFER_WM_DIV	(4)
+
+static void abox_rdma_compr_update_caps(struct abox_compr_data *data,
+		struct snd_compr_caps *caps)
+{
+	memcpy(caps, &abox_rdma_compr_caps, sizeof(*caps));
+	if (data->deep_buffer) {
+		caps->max_fragment_size = COMPR_DEEP_FRAGMENT_BYTES;
+		caps->max_fragments = COMPR_DEEP_BUFFER_BYTES /
+				COMPR_DEEP_FRAGMENT_BYTES;
+	}
+}
+
+/*
+ * In deep buffer mode, skip the fragment wakeup of the writer until there
+ * is room for a fragment and no more than the low watermark is left.
+ */
+static bool abox_rdma_compr_need_wakeup(struct abox_compr_data *data,
+		struct snd_compr_runtime *runtime)
+{
+	u64 avail, wm;
+
+	if (!data->deep_buffer || data->eos)
+		return true;
+
+	avail = data->received_total - data->copied_total;
+	wm = div_u64(runtime->buffer_size, COMPR_DEEP_BUFFER_WM_DIV);
+	if (runtime->buffer_size - wm < runtime->fragment_size)
+		wm = runtime->buffer_size - runtime->fragment_size;
+
+	return avail <= wm;
+}
+
 static void abox_rdma_mailbox_write(struct device *dev, u32 index, u32 value)
 {
 	struct regmap *regmap = dev_get_regmap(dev, NULL);
@@ -374,7 +415,8 @@ static int abox_rdma_compr_isr_handler(void *priv)
 				data->byte_offset -= runtime->buffer_size;
 			spin_unlock_irqrestore(&data->lock, flags);
 
-			snd_compr_fragment_elapsed(data->cstream);
+			if (abox_rdma_compr_need_wakeup(data, runtime))
+				snd_compr_fragment_elapsed(data->cstream);
 
 			if (!data->start &&
 				runtime->state != SNDRV_PCM_STATE_PAUSED) {
@@ -973,7 +1015,7 @@ static int abox_rdma_compr_get_caps(struct snd_compr_stream *stream,
 
 	dev_info(dev, "%s[%d]\n", __func__, id);
 
-	memcpy(caps, &abox_rdma_compr_caps, sizeof(*caps));
+	abox_rdma_compr_update_caps(&platform_data->compr_data, caps);
 
 	return 0;
 }
@@ -1266,7 +1308,7 @@ static irqreturn_t abox_rdma_irq_handler(int irq, void *dev_id,
 
 	switch (pcmtask_msg->msgtype) {
 	case PCM_PLTDAI_POINTER:
-		snd_pcm_period_elapsed(data->substream);
+		abox_platform_period_elapsed(data);
 		break;
 	default:
 		dev_warn(dev, "Unknown pcmtask message: %d\n",
@@ -1534,7 +1576,9 @@ static snd_pcm_uframes_t abox_rdma_pointer(struct snd_pcm_substream *substream)
 	u32 status = readl(data->sfr_base + ABOX_RDMA_STATUS);
 	bool progress = (status & ABOX_RDMA_PROGRESS_MASK) ? true : false;
 
-	if (data->pointer >= IOVA_RDMA_BUFFER(id)) {
+	/* streams without period wakeup get no pointer from the firmware */
+	if ((data->pointer >= IOVA_RDMA_BUFFER(id)) &&
+			!runtime->no_period_wakeup) {
 		pointer = data->pointer - IOVA_RDMA_BUFFER(id);
 	} else if (((data->type == PLATFORM_NORMAL) ||
 			(data->type == PLATFORM_SYNC)) && progress) {
@@ -1594,6 +1638,7 @@ static int abox_rdma_open(struct snd_pcm_substream *substream)
 			abox_data->cpu_gear_min);
 
 	snd_soc_set_runtime_hwparams(substream, &abox_rdma_hardware);
+	abox_platform_set_mmap_exclusive(data, substream->runtime);
 
 	data->substream = substream;
 
@@ -1842,6 +1887,9 @@ static int abox_rdma_probe(struct snd_soc_platform *platform)
 
 	if (data->type == PLATFORM_COMPRESS) {
 		struct abox_compr_data *compr_data = &data->compr_data;
+#ifdef COMPR_USE_FIXED_MEMORY
+		struct snd_compr_caps caps;
+#endif
 
 		ret = snd_soc_add_platform_controls(platform,
 				abox_rdma_compr_controls,
@@ -1851,8 +1899,9 @@ static int abox_rdma_probe(struct snd_soc_platform *platform)
 			return ret;
 		}
 #ifdef COMPR_USE_FIXED_MEMORY
-		compr_data->dma_size = abox_rdma_compr_caps.max_fragments *
-				abox_rdma_compr_caps.max_fragment_size;
+		abox_rdma_compr_update_caps(compr_data, &caps);
+		compr_data->dma_size = caps.max_fragments *
+				caps.max_fragment_size;
 		compr_data->dma_area = dmam_alloc_coherent(dev,
 				compr_data->dma_size, &compr_data->dma_addr,
 				GFP_KERNEL);
@@ -2072,6 +2121,11 @@ static int samsung_abox_rdma_probe(struct platform_device *pdev)
 		if (IS_ERR(data->mailbox))
 			return PTR_ERR(data->mailbox);
 
+		data->compr_data.deep_buffer = of_property_read_bool(np,
+				"deep_buffer");
+		if (data->compr_data.deep_buffer)
+			dev_info(dev, "deep buffer playback\n");
+
 		pm_runtime_set_autosuspend_delay(dev, 1);
 		pm_runtime_use_autosuspend(dev);
 	} else {
@@ -80,7 +80,7 @@ static irqreturn_t abox_wdma_irq_handler(int irq, void *dev_id,
 
 	switch (pcmtask_msg->msgtype) {
 	case PCM_PLTDAI_POINTER:
-		snd_pcm_period_elapsed(data->substream);
+		abox_platform_period_elapsed(data);
 		break;
 	default:
 		dev_warn(dev, "Unknown pcmtask message: %d\n",
@@ -336,7 +336,9 @@ static snd_pcm_uframes_t abox_wdma_pointer(struct snd_pcm_substream *substream)
 	u32 status = readl(data->sfr_base + ABOX_WDMA_STATUS);
 	bool progress = (status & ABOX_WDMA_PROGRESS_MASK) ? true : false;
 
-	if (data->pointer >= IOVA_WDMA_BUFFER(id)) {
+	/* streams without period wakeup get no pointer from the firmware */
+	if ((data->pointer >= IOVA_WDMA_BUFFER(id)) &&
+			!runtime->no_period_wakeup) {
 		pointer = data->pointer - IOVA_WDMA_BUFFER(id);
 	} else if (((data->type == PLATFORM_NORMAL) ||
 			(data->type == PLATFORM_SYNC)) && progress) {
@@ -396,6 +398,7 @@ static int abox_wdma_open(struct snd_pcm_substream *substream)
 			abox_data->cpu_gear_min);
 
 	snd_soc_set_runtime_hwparams(substream, &abox_wdma_hardware);
+	abox_platform_set_mmap_exclusive(data, substream->runtime);
 
 	data->substream = substream;
 
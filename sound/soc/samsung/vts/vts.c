@@ -85,6 +85,7 @@ static void update_mask_value(volatile void __iomem *sfr,
 
 /* For only external static functions */
 static struct vts_data *p_vts_data;
+static BLOCKING_NOTIFIER_HEAD(vts_notifier_list);
 static void vts_dbg_dump_fw_gpr(struct device *dev, struct vts_data *data,
 			unsigned int dbg_type);
 
@@ -621,6 +622,18 @@ volatile bool vts_is_recognitionrunning(void)
 }
 EXPORT_SYMBOL(vts_is_recognitionrunning);
 
+int vts_register_notifier(struct notifier_block *nb)
+{
+	return blocking_notifier_chain_register(&vts_notifier_list, nb);
+}
+EXPORT_SYMBOL(vts_register_notifier);
+
+int vts_unregister_notifier(struct notifier_block *nb)
+{
+	return blocking_notifier_chain_unregister(&vts_notifier_list, nb);
+}
+EXPORT_SYMBOL(vts_unregister_notifier);
+
 static struct snd_soc_dai_driver vts_dai[] = {
 	{
 		.name = "vts-tri",
@@ -1443,6 +1456,7 @@ static irqreturn_t vts_voice_triggered_handler(int irq, void *dev_id)
 	struct platform_device *pdev = dev_id;
 	struct device *dev = &pdev->dev;
 	struct vts_data *data = platform_get_drvdata(pdev);
+	struct vts_trigger_info info;
 	u32 id, score, frame_count;
 	u32 keyword_type = 1;
 	char env[100] = {0,};
@@ -1463,6 +1477,13 @@ static irqreturn_t vts_voice_triggered_handler(int irq, void *dev_id)
 		dev_info(dev, "VTS triggered: frame_count = %u\n",
 				 frame_count);
 
+		/* let the capture path warm up while userspace wakes up */
+		info.id = id;
+		info.score = score;
+		info.frame_count = frame_count;
+		blocking_notifier_call_chain(&vts_notifier_list,
+				VTS_EVENT_TRIGGERED, &info);
+
 		if (!(data->exec_mode & (0x1 << VTS_SOUND_DETECT_MODE))) {
 			keyword_type = id;
 			snprintf(env, sizeof(env),